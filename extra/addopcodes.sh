@@ -49,7 +49,6 @@ extras="            \
     SELECT_COLUMN   \
     ASTERISK        \
     SPAN            \
-    ANALYZE         \
     LINEFEED        \
     SPACE           \
     ILLEGAL         \
@@ -1,14 +1,26 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <inttypes.h>
 #include <time.h>
+#include <algorithm>
 #include <random>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <benchmark/benchmark.h>
 #include <trivia/util.h>
 
+#include "fiber.h"
+#include "key_def.h"
+#include "key_normalize.h"
+#include "memory.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "tuple.h"
+
 #define BPS_TREE_NO_DEBUG 1
 
 /* A simple test tree. */
@@ -84,6 +96,223 @@
 #undef bps_tree_key_t
 #undef BPS_INNER_CARD
 
+/*
+ * Trees of tuples, indexed like memtx tree does. The key definition is
+ * passed as the tree argument, so the same tree serves any key.
+ *
+ * Elements of the tuple_hint tree are tuples with comparison hints,
+ * like in memtx tree, so a comparison of elements with equal hints
+ * dereferences tuples placed in random memory. Elements of the
+ * tuple_nkey trees store the first bytes of the normalized key of the
+ * tuple (see key_normalize.h) inline in both leaf and inner blocks.
+ * Normalized keys are compared with memcmp(), so tuples are only
+ * dereferenced if the stored prefixes are equal. The normalized key
+ * must order the key parts like the tuple comparator does, which is
+ * true for all types except mixed doubles and decimals.
+ */
+
+/** Element of a tree of tuples with hints, like in memtx tree. */
+struct tuple_hint_elem {
+	struct tuple *tuple;
+	hint_t hint;
+
+	static tuple_hint_elem
+	create(struct tuple *tuple, struct key_def *key_def)
+	{
+		return {tuple, tuple_hint(tuple, key_def)};
+	}
+
+	static int
+	compare(const tuple_hint_elem &a, const tuple_hint_elem &b,
+		struct key_def *key_def)
+	{
+		return tuple_compare(a.tuple, a.hint, b.tuple, b.hint, key_def);
+	}
+};
+
+/** Search key of a tree of tuples with hints. */
+struct tuple_hint_key {
+	const char *key;
+	uint32_t part_count;
+	hint_t hint;
+
+	static tuple_hint_key
+	create(const char *key, uint32_t part_count, struct key_def *key_def)
+	{
+		return {key, part_count, key_hint(key, part_count, key_def)};
+	}
+
+	static int
+	compare(const tuple_hint_elem &a, const tuple_hint_key &b,
+		struct key_def *key_def)
+	{
+		return tuple_compare_with_key(a.tuple, a.hint, b.key,
+					      b.part_count, b.hint, key_def);
+	}
+};
+
+/**
+ * Element of a tree of tuples with inline normalized key prefixes.
+ * A normalized key is self-delimiting, so the prefix of a shorter key
+ * is padded with zeros.
+ */
+template<size_t prefix_size>
+struct tuple_nkey_elem {
+	struct tuple *tuple;
+	unsigned char prefix[prefix_size];
+
+	static tuple_nkey_elem
+	create(struct tuple *tuple, struct key_def *key_def)
+	{
+		struct region *region = &fiber()->gc;
+		size_t region_svp = region_used(region);
+		uint32_t size;
+		const char *nkey = tuple_normalize_key(tuple, key_def,
+						       MULTIKEY_NONE, region,
+						       &size);
+		/* The benchmark keys have no decimals, see test_find_tuple(). */
+		assert(nkey != NULL);
+		tuple_nkey_elem elem;
+		elem.tuple = tuple;
+		memset(elem.prefix, 0, prefix_size);
+		memcpy(elem.prefix, nkey, MIN(size, prefix_size));
+		region_truncate(region, region_svp);
+		return elem;
+	}
+
+	static int
+	compare(const tuple_nkey_elem &a, const tuple_nkey_elem &b,
+		struct key_def *key_def)
+	{
+		int rc = memcmp(a.prefix, b.prefix, prefix_size);
+		if (rc != 0)
+			return rc;
+		return tuple_compare(a.tuple, HINT_NONE, b.tuple, HINT_NONE,
+				     key_def);
+	}
+};
+
+/**
+ * Search key of a tree of tuples with inline normalized key prefixes.
+ * The normalized key of a partial key is a prefix of the normalized
+ * keys of matching tuples, so only its own bytes are compared.
+ */
+template<size_t prefix_size>
+struct tuple_nkey_key {
+	const char *key;
+	uint32_t part_count;
+	/** Number of bytes of the normalized key stored in the prefix. */
+	uint32_t prefix_len;
+	unsigned char prefix[prefix_size];
+
+	static tuple_nkey_key
+	create(const char *key, uint32_t part_count, struct key_def *key_def)
+	{
+		struct region *region = &fiber()->gc;
+		size_t region_svp = region_used(region);
+		uint32_t size;
+		const char *nkey = key_normalize(key, part_count, key_def,
+						 region, &size);
+		assert(nkey != NULL);
+		tuple_nkey_key k;
+		k.key = key;
+		k.part_count = part_count;
+		k.prefix_len = MIN(size, prefix_size);
+		memcpy(k.prefix, nkey, k.prefix_len);
+		region_truncate(region, region_svp);
+		return k;
+	}
+
+	static int
+	compare(const tuple_nkey_elem<prefix_size> &a, const tuple_nkey_key &b,
+		struct key_def *key_def)
+	{
+		int rc = memcmp(a.prefix, b.prefix, b.prefix_len);
+		if (rc != 0)
+			return rc;
+		return tuple_compare_with_key(a.tuple, HINT_NONE, b.key,
+					      b.part_count, HINT_NONE,
+					      key_def);
+	}
+};
+
+#define TUPLE_TREE_COMPARE(a, b, arg) ((a).compare((a), (b), (arg)))
+#define TUPLE_TREE_COMPARE_KEY(a, b, arg) ((b).compare((a), (b), (arg)))
+#define TUPLE_TREE_IS_IDENTICAL(a, b) ((a).tuple == (b).tuple)
+
+typedef tuple_hint_elem tree_tuple_hint_elem_t;
+typedef tuple_hint_key tree_tuple_hint_key_t;
+typedef tuple_nkey_elem<8> tree_tuple_nkey8_elem_t;
+typedef tuple_nkey_key<8> tree_tuple_nkey8_key_t;
+typedef tuple_nkey_elem<24> tree_tuple_nkey24_elem_t;
+typedef tuple_nkey_key<24> tree_tuple_nkey24_key_t;
+
+/* Defined to the default by the trees above. */
+#undef bps_tree_arg_t
+
+#define tree_tuple_hint_EXTENT_SIZE 8192
+#define BPS_TREE_NAME tree_tuple_hint_t
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE tree_tuple_hint_EXTENT_SIZE
+#define BPS_TREE_IS_IDENTICAL TUPLE_TREE_IS_IDENTICAL
+#define BPS_TREE_COMPARE TUPLE_TREE_COMPARE
+#define BPS_TREE_COMPARE_KEY TUPLE_TREE_COMPARE_KEY
+#define bps_tree_elem_t tree_tuple_hint_elem_t
+#define bps_tree_key_t tree_tuple_hint_key_t
+#define bps_tree_arg_t struct key_def *
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+#define tree_tuple_nkey8_EXTENT_SIZE 8192
+#define BPS_TREE_NAME tree_tuple_nkey8_t
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE tree_tuple_nkey8_EXTENT_SIZE
+#define BPS_TREE_IS_IDENTICAL TUPLE_TREE_IS_IDENTICAL
+#define BPS_TREE_COMPARE TUPLE_TREE_COMPARE
+#define BPS_TREE_COMPARE_KEY TUPLE_TREE_COMPARE_KEY
+#define bps_tree_elem_t tree_tuple_nkey8_elem_t
+#define bps_tree_key_t tree_tuple_nkey8_key_t
+#define bps_tree_arg_t struct key_def *
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+#define tree_tuple_nkey24_EXTENT_SIZE 8192
+#define BPS_TREE_NAME tree_tuple_nkey24_t
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE tree_tuple_nkey24_EXTENT_SIZE
+#define BPS_TREE_IS_IDENTICAL TUPLE_TREE_IS_IDENTICAL
+#define BPS_TREE_COMPARE TUPLE_TREE_COMPARE
+#define BPS_TREE_COMPARE_KEY TUPLE_TREE_COMPARE_KEY
+#define bps_tree_elem_t tree_tuple_nkey24_elem_t
+#define bps_tree_key_t tree_tuple_nkey24_key_t
+#define bps_tree_arg_t struct key_def *
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
 /**
  * Generate the benchmark variations required.
  */
@@ -222,6 +451,9 @@ public: \
 CREATE_TREE_CLASS(tree_i64);
 CREATE_TREE_CLASS(treecc_i64);
 CREATE_TREE_CLASS(treeic_i64);
+CREATE_TREE_CLASS(tree_tuple_hint);
+CREATE_TREE_CLASS(tree_tuple_nkey8);
+CREATE_TREE_CLASS(tree_tuple_nkey24);
 
 /**
  * Value generators to make key-independent benchmarks.
@@ -597,6 +829,152 @@ test_delete_rand(benchmark::State &state, size_t count)
 
 generate_benchmarks_size_iterations(delete_rand, 1000000);
 
+/*
+ * The following functions test lookups of random keys in the trees of
+ * tuples with string {"user<N>"} and composite {N % 16, "user<N>"}
+ * keys. The tuples are created in random order, so that their order in
+ * memory doesn't match the key order. Before the measurement the order
+ * of the tree and the result of every lookup are checked against the
+ * tuple comparator.
+ */
+
+/** Initializes the tuple library once for the tuple tree benchmarks. */
+class TupleLib {
+public:
+	static void
+	init()
+	{
+		static TupleLib instance;
+		(void)instance;
+	}
+private:
+	TupleLib()
+	{
+		memory_init();
+		fiber_init(fiber_c_invoke);
+		tuple_init(NULL);
+	}
+};
+
+template<class tree>
+static void
+test_find_tuple(benchmark::State &state, size_t count, bool is_composite)
+{
+	TupleLib::init();
+	struct key_part_def parts[2];
+	uint32_t part_count = 0;
+	if (is_composite) {
+		parts[part_count] = key_part_def_default;
+		parts[part_count].fieldno = 0;
+		parts[part_count].type = FIELD_TYPE_UNSIGNED;
+		part_count++;
+	}
+	parts[part_count] = key_part_def_default;
+	parts[part_count].fieldno = 1;
+	parts[part_count].type = FIELD_TYPE_STRING;
+	part_count++;
+	struct key_def *key_def = key_def_new(parts, part_count, 0);
+	if (key_def == NULL) {
+		fprintf(stderr, "Key definition creation has failed.\n");
+		exit(-1);
+	}
+
+	std::minstd_rand rng;
+	std::vector<size_t> ids(count);
+	for (size_t i = 0; i < count; i++)
+		ids[i] = i;
+	std::shuffle(ids.begin(), ids.end(), rng);
+	std::vector<std::string> keys_data;
+	keys_data.reserve(count);
+	std::vector<typename tree::elem_t> elems;
+	elems.reserve(count);
+	for (size_t id : ids) {
+		char str[32];
+		uint32_t len = snprintf(str, sizeof(str), "user%zu", id);
+		uint64_t group = is_composite ? id % 16 : 0;
+		char buf[64];
+		char *end = mp_encode_array(buf, 2);
+		end = mp_encode_uint(end, group);
+		end = mp_encode_str(end, str, len);
+		struct tuple *tuple = tuple_new(tuple_format_runtime, buf, end);
+		if (tuple == NULL) {
+			fprintf(stderr, "Tuple creation has failed.\n");
+			exit(-1);
+		}
+		tuple_ref(tuple);
+		elems.push_back(tree::elem_t::create(tuple, key_def));
+		/* The key is the tuple without the array header. */
+		const char *key = buf;
+		mp_decode_array(&key);
+		if (!is_composite)
+			mp_next(&key);
+		keys_data.emplace_back(key, end - key);
+	}
+	std::vector<typename tree::key_t> keys;
+	size_t key_count = std::min<size_t>(count, 1 << 16);
+	keys.reserve(key_count);
+	for (size_t i = 0; i < key_count; i++) {
+		keys.push_back(tree::key_t::create(keys_data[i].data(),
+						   part_count, key_def));
+	}
+	std::vector<struct tuple *> key_tuples;
+	for (size_t i = 0; i < key_count; i++)
+		key_tuples.push_back(elems[i].tuple);
+	std::sort(elems.begin(), elems.end(),
+		  [key_def](const typename tree::elem_t &a,
+			    const typename tree::elem_t &b) {
+			return tree::elem_t::compare(a, b, key_def) < 0;
+		  });
+	for (size_t i = 1; i < count; i++) {
+		if (tuple_compare(elems[i - 1].tuple, HINT_NONE,
+				  elems[i].tuple, HINT_NONE, key_def) >= 0) {
+			fprintf(stderr, "Tree order is broken.\n");
+			exit(-1);
+		}
+	}
+
+	typename tree::tree_t t;
+	typename tree::Allocator allocator(count);
+	tree::create(&t, key_def, allocator.alloc, allocator.free, &allocator,
+		     NULL);
+	if (tree::build(&t, elems.data(), count) == -1) {
+		fprintf(stderr, "Tree build has failed.\n");
+		exit(-1);
+	}
+	for (size_t i = 0; i < key_count; i++) {
+		typename tree::elem_t *found = tree::find(&t, keys[i]);
+		if (found == NULL || found->tuple != key_tuples[i]) {
+			fprintf(stderr, "Tree lookup has failed.\n");
+			exit(-1);
+		}
+	}
+	size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(tree::find(&t, keys[i]));
+		if (++i == keys.size())
+			i = 0;
+	}
+	tree::destroy(&t);
+	for (const auto &elem : elems)
+		tuple_unref(elem.tuple);
+	key_def_delete(key_def);
+}
+
+#define generate_benchmark_find_tuple(type, key, is_composite, size) \
+	static void \
+	type##_find_##key##_rand_size_##size(benchmark::State &state) \
+	{ \
+		test_find_tuple<type>(state, size, is_composite); \
+	} \
+	BENCHMARK(type##_find_##key##_rand_size_##size)
+
+generate_benchmark_find_tuple(tree_tuple_hint, str, false, 1000000);
+generate_benchmark_find_tuple(tree_tuple_nkey8, str, false, 1000000);
+generate_benchmark_find_tuple(tree_tuple_nkey24, str, false, 1000000);
+generate_benchmark_find_tuple(tree_tuple_hint, comp, true, 1000000);
+generate_benchmark_find_tuple(tree_tuple_nkey8, comp, true, 1000000);
+generate_benchmark_find_tuple(tree_tuple_nkey24, comp, true, 1000000);
+
 BENCHMARK_MAIN();
 
 #include "debug_warning.h"
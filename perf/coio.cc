@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+
+#include "core/coio_task.h"
+#include "core/fiber.h"
+#include "core/memory.h"
+#include "trivia/util.h"
+
+/**
+ * This suite measures the round trip of a coio task: the time it takes
+ * to pass a task to the coio thread pool and to get the fiber woken up
+ * after the task completes. The benchmark argument is the number of
+ * fibers submitting tasks concurrently.
+ */
+
+/** Number of tasks submitted by a fiber in a benchmark iteration. */
+static constexpr int calls_per_fiber = 100;
+
+static ssize_t
+noop_f(va_list ap)
+{
+	(void)ap;
+	return 0;
+}
+
+static int
+caller_f(va_list ap)
+{
+	int *active = va_arg(ap, int *);
+	for (int i = 0; i < calls_per_fiber; i++)
+		coio_call(noop_f);
+	if (--*active == 0)
+		ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+static void
+coio_call_round_trip(benchmark::State &state)
+{
+	int fiber_count = state.range(0);
+	for (MAYBE_UNUSED auto _ : state) {
+		int active = fiber_count;
+		for (int i = 0; i < fiber_count; i++) {
+			struct fiber *f = fiber_new("caller", caller_f);
+			if (f == NULL)
+				panic("failed to create a fiber");
+			fiber_start(f, &active);
+		}
+		ev_run(loop(), 0);
+	}
+	state.SetItemsProcessed(state.iterations() * fiber_count *
+				calls_per_fiber);
+}
+
+BENCHMARK(coio_call_round_trip)->Arg(1)->Arg(16)->Arg(256);
+
+int
+main(int argc, char **argv)
+{
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	coio_init();
+	coio_enable();
+
+	::benchmark::Initialize(&argc, argv);
+	if (::benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	::benchmark::RunSpecifiedBenchmarks();
+
+	coio_shutdown();
+	fiber_free();
+	memory_free();
+	return 0;
+}
+
+#include "debug_warning.h"
@@ -22,8 +22,10 @@
 //  - Search after erase;
 //  - Deletes.
 //
-// To compare numbers given by this benchmark we also run a few tests with
-// std::unordered_map at the end.
+// To compare numbers given by this benchmark we also run the same tests with
+// Swiss - an open addressing hash table with SIMD group probing that can be
+// used by a HASH index instead of Light (`layout = 'swiss'` index option),
+// and with std::unordered_map at the end.
 
 
 // Tuple size in fact does not really matter since in Tarantool we store
@@ -225,6 +227,15 @@ namespace {
 
 #include "salad/light.h"
 
+#define SWISS_NAME
+#define SWISS_DATA_TYPE const TupleRaw *
+#define SWISS_KEY_TYPE Key_t
+#define SWISS_CMP_ARG_TYPE int
+#define SWISS_EQUAL(a, b, arg) tuple_equals(a, b)
+#define SWISS_EQUAL_KEY(a, b, arg) key_equals(a, b)
+
+#include "salad/swiss.h"
+
 ////////////////////////////// Fixture /////////////////////////////////////////////////////////////////////////////////
 
 template<typename T>
@@ -543,6 +554,80 @@ class Light {
 	struct light_core ht;
 };
 
+class Swiss {
+public:
+	Swiss()
+	{
+		swiss_create(&ht, 0, light_extent_size, light_malloc_extend,
+			     light_free_extend, &extents_count, nullptr);
+	}
+	~Swiss()
+	{
+		swiss_destroy(&ht);
+	}
+
+	// Functions return smth in order to suppress "error: invalid use of void expression".
+	int
+	erase(const TupleRef &tuple)
+	{
+		swiss_delete_value(&ht, tuple.hash, tuple.tuple);
+		return 0;
+	}
+
+	int
+	insert(const TupleRef &tuple)
+	{
+		swiss_insert(&ht, tuple.hash, tuple.tuple);
+		return 0;
+	}
+
+	const TupleRaw *
+	find(const TupleRef &tuple)
+	{
+		static TupleRaw DUMMY{0};
+		uint32_t slot = swiss_find(&ht, tuple.hash, tuple.tuple);
+		if (slot != swiss_end)
+			return swiss_get(&ht, slot);
+		return &DUMMY;
+	}
+
+	uint32_t
+	find_key(const TupleRef &tuple)
+	{
+		return swiss_find_key(&ht, tuple.hash, tuple.key);
+	}
+
+	void
+	clear()
+	{
+		swiss_destroy(&ht);
+		swiss_create(&ht, 0, light_extent_size, light_malloc_extend,
+			     light_free_extend, &extents_count, nullptr);
+	}
+
+	void
+	reserve(std::size_t n)
+	{
+		swiss_reserve(&ht, n);
+	}
+
+	std::size_t
+	iter_all()
+	{
+		std::size_t processed = 0;
+		struct swiss_iterator iter;
+		swiss_iterator_begin(&ht, &iter);
+		const TupleRaw **p = nullptr;
+		while ((p = swiss_iterator_get_and_next(&ht, &iter)) != nullptr) {
+			benchmark::DoNotOptimize((*p)->data);
+			processed++;
+		}
+		return processed;
+	}
+private:
+	struct swiss_core ht;
+};
+
 using USet = std::unordered_set<TupleRef, Hash::TupleHash, TupleEqual>;
 
 class STL {
@@ -579,11 +664,15 @@ class STL {
 #define BENCHMARK_TEMPLATE_REGISTER_LIGHT(METHOD_NAME) \
 	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, Light)
 
+#define BENCHMARK_TEMPLATE_REGISTER_SWISS(METHOD_NAME) \
+	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, Swiss)
+
 #define BENCHMARK_TEMPLATE_REGISTER_STL(METHOD_NAME) \
 	BENCHMARK_TEMPLATE_REGISTER(METHOD_NAME, STL)
 
 #define BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(METHOD_NAME) \
 	BENCHMARK_TEMPLATE_REGISTER_LIGHT(METHOD_NAME); \
+	BENCHMARK_TEMPLATE_REGISTER_SWISS(METHOD_NAME); \
 	BENCHMARK_TEMPLATE_REGISTER_STL(METHOD_NAME)
 
 BENCHMARK_TEMPLATE_REGISTER_FOR_ALL_IMPLS(InsertRandValue);
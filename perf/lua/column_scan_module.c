@@ -9,14 +9,13 @@
 #include "trivia/util.h"
 #include "arrow/abi.h"
 
+#define ENABLE_ARROW 1
+
 #if defined(ENABLE_MEMCS_ENGINE)
-# define ENABLE_ARROW 1
 # define ENABLE_SCANNER 1
 #endif /* ENABLE_MEMCS_ENGINE */
 
-#if defined(ENABLE_READ_VIEW)
 static box_raw_read_view_t *rv;
-#endif /* ENABLE_READ_VIEW */
 
 static int
 sum_iterator_lua_func(struct lua_State *L)
@@ -51,7 +50,6 @@ sum_iterator_lua_func(struct lua_State *L)
 	return 1;
 }
 
-#if defined(ENABLE_READ_VIEW)
 static int
 sum_iterator_rv_lua_func(struct lua_State *L)
 {
@@ -97,7 +95,6 @@ sum_iterator_rv_lua_func(struct lua_State *L)
 	luaL_pushuint64(L, sum);
 	return 1;
 }
-#endif /* defined(ENABLE_READ_VIEW) */
 
 #if defined(ENABLE_ARROW)
 static int
@@ -184,7 +181,7 @@ sum_scanner_lua_func(struct lua_State *L)
 }
 #endif /* defined(ENABLE_SCANNER) */
 
-#if defined(ENABLE_ARROW) && defined(ENABLE_READ_VIEW)
+#if defined(ENABLE_ARROW)
 static int
 sum_arrow_rv_lua_func(struct lua_State *L)
 {
@@ -235,9 +232,9 @@ sum_arrow_rv_lua_func(struct lua_State *L)
 	luaL_pushuint64(L, sum);
 	return 1;
 }
-#endif /* defined(ENABLE_ARROW) && defined(ENABLE_READ_VIEW) */
+#endif /* defined(ENABLE_ARROW) */
 
-#if defined(ENABLE_SCANNER) && defined(ENABLE_READ_VIEW)
+#if defined(ENABLE_SCANNER)
 static int
 sum_scanner_rv_lua_func(struct lua_State *L)
 {
@@ -286,17 +283,14 @@ sum_scanner_rv_lua_func(struct lua_State *L)
 	luaL_pushuint64(L, sum);
 	return 1;
 }
-#endif /* defined(ENABLE_SCANNER) && defined(ENABLE_READ_VIEW) */
+#endif /* defined(ENABLE_SCANNER) */
 
 static int
 init_lua_func(struct lua_State *L)
 {
-#if defined(ENABLE_READ_VIEW)
 	rv = box_raw_read_view_new("test");
 	if (rv == NULL)
 		return luaT_error(L);
-#endif /* defined(ENABLE_READ_VIEW) */
-	(void)L;
 	return 0;
 }
 
@@ -306,21 +300,15 @@ luaopen_column_scan_module(struct lua_State *L)
 	static const struct luaL_Reg lib[] = {
 		{"init", init_lua_func},
 		{"sum_iterator", sum_iterator_lua_func},
-#if defined(ENABLE_READ_VIEW)
 		{"sum_iterator_rv", sum_iterator_rv_lua_func},
-#endif /* defined(ENABLE_READ_VIEW) */
 #if defined(ENABLE_ARROW)
 		{"sum_arrow", sum_arrow_lua_func},
+		{"sum_arrow_rv", sum_arrow_rv_lua_func},
 #endif /* defined(ENABLE_ARROW) */
 #if defined(ENABLE_SCANNER)
 		{"sum_scanner", sum_scanner_lua_func},
-#endif /* defined(ENABLE_SCANNER) */
-#if defined(ENABLE_ARROW) && defined(ENABLE_READ_VIEW)
-		{"sum_arrow_rv", sum_arrow_rv_lua_func},
-#endif /* defined(ENABLE_ARROW) && defined(ENABLE_READ_VIEW) */
-#if defined(ENABLE_SCANNER) && defined(ENABLE_READ_VIEW)
 		{"sum_scanner_rv", sum_scanner_rv_lua_func},
-#endif /* defined(ENABLE_SCANNER) && defined(ENABLE_READ_VIEW) */
+#endif /* defined(ENABLE_SCANNER) */
 		{NULL, NULL},
 	};
 	luaL_register(L, "column_scan_module", lib);
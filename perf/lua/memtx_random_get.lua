@@ -0,0 +1,94 @@
+--
+-- The test measures random point lookups in a large memtx space, which
+-- are dominated by TLB and cache misses, so it can be used to compare
+-- different `memtx_huge_pages` modes.
+--
+-- Output format (console):
+-- <test-case> <lookups-per-second>
+--
+
+local clock = require('clock')
+local log = require('log')
+local benchmark = require('benchmark')
+
+local USAGE = [[
+   huge_pages <string, 'off'>   - value of the memtx_huge_pages option
+   lookups <number, 1000000>    - number of lookups per test case
+   memtx_memory <number, 4GB>   - value of the memtx_memory option
+   row_count <number, 10000000> - number of rows in the test space
+
+ Being run without options, this benchmark measures the run time of random
+ get requests in tree and hash indexes of a space of 10 million rows.
+]]
+
+local params = benchmark.argparse(arg, {
+    {'huge_pages', 'string'},
+    {'lookups', 'number'},
+    {'memtx_memory', 'number'},
+    {'row_count', 'number'},
+}, USAGE)
+
+local DEFAULT_LOOKUPS = 1000 * 1000
+local DEFAULT_MEMTX_MEMORY = 4 * 1024 * 1024 * 1024
+local DEFAULT_ROW_COUNT = 10 * 1000 * 1000
+
+params.huge_pages = params.huge_pages or 'off'
+params.lookups = params.lookups or DEFAULT_LOOKUPS
+params.memtx_memory = params.memtx_memory or DEFAULT_MEMTX_MEMORY
+params.row_count = params.row_count or DEFAULT_ROW_COUNT
+
+local bench = benchmark.new(params)
+
+box.cfg({
+    log_level = 'error',
+    wal_mode = 'none',
+    memtx_memory = params.memtx_memory,
+    memtx_huge_pages = params.huge_pages,
+})
+
+log.info('Generating the test data set...')
+local s = box.schema.space.create('test')
+s:create_index('tree')
+s:create_index('hash', {type = 'hash'})
+box.begin()
+for i = 1, params.row_count do
+    s:insert({i, i})
+    if i % 1000 == 0 then
+        box.commit()
+        box.begin()
+    end
+end
+box.commit()
+
+math.randomseed(0)
+local keys = {}
+for i = 1, params.lookups do
+    keys[i] = math.random(params.row_count)
+end
+
+local function run_test(name, index)
+    collectgarbage('collect')
+    local real_time_start = clock.time()
+    local cpu_time_start = clock.proc()
+    for i = 1, params.lookups do
+        index:get(keys[i])
+    end
+    local delta_real = clock.time() - real_time_start
+    local delta_cpu = clock.proc() - cpu_time_start
+    bench:add_result(name, {
+        real_time = delta_real,
+        cpu_time = delta_cpu,
+        items = params.lookups,
+    })
+end
+
+local arena = box.stat.memtx().arena
+log.info('Arena: %d bytes, %d bytes in %s huge pages', arena.total,
+         arena.huge, arena.huge_pages)
+
+run_test('get_tree', s.index.tree)
+run_test('get_hash', s.index.hash)
+
+bench:dump_results()
+
+os.exit(0)
@@ -0,0 +1,116 @@
+--
+-- The test measures the cost of conflict checks done by the MVCC engine
+-- on insertion of new tuples while there are lots of transactions that
+-- have read gaps of the index: range scans and counts.
+--
+-- Output format (console):
+-- <test-case> <inserts-per-second>
+--
+
+local clock = require('clock')
+local fiber = require('fiber')
+local log = require('log')
+local benchmark = require('benchmark')
+
+local USAGE = [[
+   readers <number, 1000>   - number of open reading transactions
+   inserts <number, 100000> - number of inserts per test case
+
+ Being run without options, this benchmark measures the run time of
+ inserts into a space while 1000 transactions keep their read gaps.
+]]
+
+local params = benchmark.argparse(arg, {
+    {'readers', 'number'},
+    {'inserts', 'number'},
+}, USAGE)
+
+local DEFAULT_READERS = 1000
+local DEFAULT_INSERTS = 100 * 1000
+
+params.readers = params.readers or DEFAULT_READERS
+params.inserts = params.inserts or DEFAULT_INSERTS
+
+local bench = benchmark.new(params)
+
+box.cfg({
+    log_level = 'error',
+    wal_mode = 'none',
+    memtx_use_mvcc_engine = true,
+})
+
+local s = box.schema.space.create('test')
+s:create_index('pk')
+
+-- Keys of the inserted tuples go after all the keys read by the readers,
+-- so the readers don't conflict with the writer and stay open.
+local KEY_BASE = 1000 * 1000 * 1000
+
+-- Starts the given number of fibers, each of which opens a transaction,
+-- does the given read and waits until the returned condition variable
+-- is signalled.
+local function start_readers(count, read)
+    local cond = fiber.cond()
+    local started = 0
+    for i = 1, count do
+        fiber.create(function()
+            box.begin()
+            read(i)
+            started = started + 1
+            cond:wait()
+            box.rollback()
+        end)
+    end
+    assert(started == count)
+    return cond
+end
+
+local function run_test(name, read)
+    log.info('Running %s...', name)
+    s:truncate()
+    for i = 1, params.readers do
+        s:insert({i * 2})
+    end
+    local cond = start_readers(params.readers, read)
+    collectgarbage('collect')
+    local real_time_start = clock.time()
+    local cpu_time_start = clock.proc()
+    for i = 1, params.inserts do
+        s:insert({KEY_BASE + i})
+    end
+    local delta_real = clock.time() - real_time_start
+    local delta_cpu = clock.proc() - cpu_time_start
+    cond:broadcast()
+    fiber.yield()
+    bench:add_result(name, {
+        real_time = delta_real,
+        cpu_time = delta_cpu,
+        items = params.inserts,
+    })
+end
+
+-- Reads the gap after the last tuple of the index, which is checked on
+-- every insertion to the end of the index.
+local function read_range(i)
+    s:select({KEY_BASE * 2 + i}, {iterator = 'ge'})
+end
+
+-- Counts the tuples that are never matched by the inserted tuples.
+local function read_count(i)
+    s:count({i * 2}, {iterator = 'le'})
+end
+
+run_test('insert_no_readers', function() end)
+run_test('insert_range_readers', read_range)
+run_test('insert_count_readers', read_count)
+run_test('insert_mixed_readers', function(i)
+    if i % 2 == 0 then
+        read_range(i)
+    else
+        read_count(i)
+    end
+end)
+
+bench:dump_results()
+
+os.exit(0)
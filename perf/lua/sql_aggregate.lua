@@ -0,0 +1,142 @@
+--
+-- The test measures run time of SQL aggregate queries (SUM, COUNT,
+-- GROUP BY) scanning the whole table.
+--
+-- Output format (console):
+-- <test-case> <rows-per-second>
+--
+-- NOTE: Every test case has a `_row` counterpart that is not eligible
+-- for batch execution (an aggregate argument or a predicate is a trivial
+-- expression rather than a column), so the two can be compared.
+--
+
+local clock = require('clock')
+local ffi = require('ffi')
+local log = require('log')
+local benchmark = require('benchmark')
+
+local USAGE = [[
+   engine <string, 'memtx'>    - engine of the test table
+   groups <number, 1000>       - number of distinct GROUP BY keys
+   pattern <string>            - run only tests matching the pattern; it's
+                                 possible to specify more than one pattern
+                                 separated by '|', for example, 'sum|count'
+   row_count <number, 2000000> - number of rows in the test table
+   threads <number, 0>         - number of threads used to scan a memtx
+                                 table; 0 means a sequential scan
+
+ Being run without options, this benchmark measures the run time of SUM,
+ COUNT and GROUP BY queries over a memtx table of 2 million rows.
+]]
+
+local params = benchmark.argparse(arg, {
+    {'engine', 'string'},
+    {'groups', 'number'},
+    {'pattern', 'string'},
+    {'row_count', 'number'},
+    {'threads', 'number'},
+}, USAGE)
+
+local DEFAULT_ENGINE = 'memtx'
+local DEFAULT_GROUPS = 1000
+local DEFAULT_ROW_COUNT = 2000 * 1000
+
+params.engine = params.engine or DEFAULT_ENGINE
+params.groups = params.groups or DEFAULT_GROUPS
+params.row_count = params.row_count or DEFAULT_ROW_COUNT
+params.threads = params.threads or 0
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local bench = benchmark.new(params)
+
+box.cfg({log_level = 'error', wal_mode = 'none'})
+
+log.info('Generating the test data set...')
+box.execute(([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b DOUBLE, c INT)
+               WITH ENGINE = '%s';]]):format(params.engine))
+box.begin()
+for i = 1, params.row_count do
+    box.space.t:insert({i, i % 1000, ffi.cast('double', i / 3),
+                        i % params.groups})
+    if i % 1000 == 0 then
+        box.commit()
+        box.begin()
+    end
+end
+box.commit()
+
+if params.threads > 0 then
+    require('internal.tweaks').sql_parallel_scan_threads = params.threads
+    box.session.settings.sql_parallel_scan = true
+end
+
+local TESTS = {
+    {
+        name = 'sum',
+        sql = 'SELECT SUM(a), SUM(b) FROM t',
+    },
+    {
+        name = 'sum_row',
+        sql = 'SELECT SUM(a + 0), SUM(b + 0) FROM t',
+    },
+    {
+        name = 'count_where',
+        sql = 'SELECT COUNT(*) FROM t WHERE a < 500 AND b > 100',
+    },
+    {
+        name = 'count_where_row',
+        sql = 'SELECT COUNT(*) FROM t WHERE a + 0 < 500 AND b + 0 > 100',
+    },
+    {
+        name = 'avg_min_max',
+        sql = 'SELECT AVG(b), MIN(a), MAX(b) FROM t WHERE a >= 100',
+    },
+    {
+        name = 'avg_min_max_row',
+        sql = 'SELECT AVG(b + 0), MIN(a + 0), MAX(b + 0) FROM t ' ..
+              'WHERE a + 0 >= 100',
+    },
+    {
+        name = 'group_by',
+        sql = 'SELECT c, COUNT(*), SUM(a) FROM t GROUP BY c ORDER BY 2',
+    },
+}
+
+local function run_test(test)
+    local real_time_start = clock.time()
+    local cpu_time_start = clock.proc()
+    local _, err = box.execute(test.sql)
+    assert(err == nil, tostring(err))
+    local delta_real = clock.time() - real_time_start
+    local delta_cpu = clock.proc() - cpu_time_start
+    bench:add_result(test.name, {
+        real_time = delta_real,
+        cpu_time = delta_cpu,
+        items = params.row_count,
+    })
+end
+
+local function test_matches(test)
+    if not params.pattern then
+        return true
+    end
+    for _, pattern in ipairs(params.pattern) do
+        if test.name:match(pattern) then
+            return true
+        end
+    end
+    return false
+end
+
+for _, test in ipairs(TESTS) do
+    if test_matches(test) then
+        log.info('Running test %s...', test.name)
+        run_test(test)
+    end
+end
+
+bench:dump_results()
+
+os.exit(0)
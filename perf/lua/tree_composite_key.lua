@@ -0,0 +1,145 @@
+--
+-- The test measures lookups in a memtx tree index with a composite key
+-- whose first part has a low cardinality, like {tenant_id, name}.
+--
+-- Output format (console):
+-- <test-case> <lookups-per-second>
+--
+-- NOTE: Every test case is run against an index with the regular hints
+-- (`_hint1` suffix) and an index with multipart hints, i.e. with the
+-- `hint_parts = 2` option (`_hint2` suffix), so the two can be compared.
+--
+
+local clock = require('clock')
+local log = require('log')
+local benchmark = require('benchmark')
+
+local USAGE = [[
+   groups <number, 16>         - number of distinct values of the first
+                                 key part
+   lookups <number, 1000000>   - number of lookups per test case
+   pattern <string>            - run only tests matching the pattern; it's
+                                 possible to specify more than one pattern
+                                 separated by '|', for example, 'get|select'
+   row_count <number, 1000000> - number of rows in the test space
+
+ Being run without options, this benchmark measures the run time of get
+ and select requests by {unsigned, string} and {unsigned, unsigned} keys
+ with 16 distinct values of the first part in a space of 1 million rows.
+]]
+
+local params = benchmark.argparse(arg, {
+    {'groups', 'number'},
+    {'lookups', 'number'},
+    {'pattern', 'string'},
+    {'row_count', 'number'},
+}, USAGE)
+
+local DEFAULT_GROUPS = 16
+local DEFAULT_LOOKUPS = 1000 * 1000
+local DEFAULT_ROW_COUNT = 1000 * 1000
+
+params.groups = params.groups or DEFAULT_GROUPS
+params.lookups = params.lookups or DEFAULT_LOOKUPS
+params.row_count = params.row_count or DEFAULT_ROW_COUNT
+if params.pattern then
+    params.pattern = string.split(params.pattern, '|')
+end
+
+local bench = benchmark.new(params)
+
+box.cfg({log_level = 'error', wal_mode = 'none'})
+
+log.info('Generating the test data set...')
+local s = box.schema.space.create('test')
+s:create_index('pk')
+for _, hint_parts in ipairs({1, 2}) do
+    s:create_index('str_hint' .. hint_parts, {
+        parts = {{2, 'unsigned'}, {3, 'string'}},
+        hint_parts = hint_parts,
+    })
+    s:create_index('uint_hint' .. hint_parts, {
+        parts = {{2, 'unsigned'}, {4, 'unsigned'}},
+        hint_parts = hint_parts,
+    })
+end
+box.begin()
+for i = 1, params.row_count do
+    s:insert({i, i % params.groups, 'name' .. i, i})
+    if i % 1000 == 0 then
+        box.commit()
+        box.begin()
+    end
+end
+box.commit()
+
+math.randomseed(0)
+local keys = {}
+for i = 1, params.lookups do
+    local id = math.random(params.row_count)
+    keys[i] = {id % params.groups, 'name' .. id, id}
+end
+
+local TESTS = {}
+for _, hint_parts in ipairs({1, 2}) do
+    local str_index = s.index['str_hint' .. hint_parts]
+    local uint_index = s.index['uint_hint' .. hint_parts]
+    table.insert(TESTS, {
+        name = 'get_str_hint' .. hint_parts,
+        func = function(key)
+            str_index:get({key[1], key[2]})
+        end,
+    })
+    table.insert(TESTS, {
+        name = 'get_uint_hint' .. hint_parts,
+        func = function(key)
+            uint_index:get({key[1], key[3]})
+        end,
+    })
+    table.insert(TESTS, {
+        name = 'select_str_hint' .. hint_parts,
+        func = function(key)
+            str_index:select({key[1], key[2]}, {iterator = 'ge', limit = 5})
+        end,
+    })
+end
+
+local function run_test(test)
+    local func = test.func
+    collectgarbage('collect')
+    local real_time_start = clock.time()
+    local cpu_time_start = clock.proc()
+    for i = 1, params.lookups do
+        func(keys[i])
+    end
+    local delta_real = clock.time() - real_time_start
+    local delta_cpu = clock.proc() - cpu_time_start
+    bench:add_result(test.name, {
+        real_time = delta_real,
+        cpu_time = delta_cpu,
+        items = params.lookups,
+    })
+end
+
+local function test_matches(test)
+    if not params.pattern then
+        return true
+    end
+    for _, pattern in ipairs(params.pattern) do
+        if test.name:match(pattern) then
+            return true
+        end
+    end
+    return false
+end
+
+for _, test in ipairs(TESTS) do
+    if test_matches(test) then
+        log.info('Running test %s...', test.name)
+        run_test(test)
+    end
+end
+
+bench:dump_results()
+
+os.exit(0)
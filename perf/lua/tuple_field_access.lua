@@ -0,0 +1,109 @@
+--
+-- The test measures access to scalar tuple fields from Lua by field
+-- number, by field name, and by JSON path.
+--
+-- Output format (console):
+-- <test-case> <accesses-per-second>
+--
+
+local clock = require('clock')
+local benchmark = require('benchmark')
+
+local USAGE = [[
+   accesses <number, 10000000> - number of field accesses per test case
+
+ Being run without options, this benchmark measures the run time of
+ 10 million accesses to integer, double, and string tuple fields.
+]]
+
+local params = benchmark.argparse(arg, {
+    {'accesses', 'number'},
+}, USAGE)
+
+local DEFAULT_ACCESSES = 10 * 1000 * 1000
+
+params.accesses = params.accesses or DEFAULT_ACCESSES
+
+local bench = benchmark.new(params)
+
+local format = box.tuple.format.new({
+    {'id', 'unsigned'},
+    {'score', 'double'},
+    {'name', 'string'},
+    {'meta', 'map'},
+})
+local tuple = box.tuple.new({1, 1.5, 'foo', {level = 10}}, {format = format})
+
+local function run_test(name, access)
+    collectgarbage('collect')
+    local real_time_start = clock.time()
+    local cpu_time_start = clock.proc()
+    access(tuple, params.accesses)
+    local delta_real = clock.time() - real_time_start
+    local delta_cpu = clock.proc() - cpu_time_start
+    bench:add_result(name, {
+        real_time = delta_real,
+        cpu_time = delta_cpu,
+        items = params.accesses,
+    })
+end
+
+run_test('number_int', function(t, n)
+    local sum = 0
+    for _ = 1, n do
+        sum = sum + t[1]
+    end
+    return sum
+end)
+
+run_test('number_double', function(t, n)
+    local sum = 0
+    for _ = 1, n do
+        sum = sum + t[2]
+    end
+    return sum
+end)
+
+run_test('number_string', function(t, n)
+    local s
+    for _ = 1, n do
+        s = t[3]
+    end
+    return s
+end)
+
+run_test('name_int', function(t, n)
+    local sum = 0
+    for _ = 1, n do
+        sum = sum + t.id
+    end
+    return sum
+end)
+
+run_test('name_double', function(t, n)
+    local sum = 0
+    for _ = 1, n do
+        sum = sum + t.score
+    end
+    return sum
+end)
+
+run_test('name_string', function(t, n)
+    local s
+    for _ = 1, n do
+        s = t.name
+    end
+    return s
+end)
+
+run_test('path_int', function(t, n)
+    local sum = 0
+    for _ = 1, n do
+        sum = sum + t['meta.level']
+    end
+    return sum
+end)
+
+bench:dump_results()
+
+os.exit(0)
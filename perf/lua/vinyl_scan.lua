@@ -0,0 +1,130 @@
+--
+-- The test measures run time of a vinyl index full scan when the data
+-- has to be read from disk.
+--
+-- Output format (console):
+-- <test-case> <rows-per-second>
+--
+-- NOTE: The vinyl tuple cache is disabled so that every scan reads run
+-- pages. To measure scans over data that isn't in the OS page cache
+-- either, drop it before each run, e.g. `echo 3 > /proc/sys/vm/drop_caches`.
+--
+
+local clock = require('clock')
+local fio = require('fio')
+local log = require('log')
+local benchmark = require('benchmark')
+
+local USAGE = [[
+   page_size <number, 8192>    - vinyl page size
+   read_threads <number, 1>    - number of vinyl reader threads
+   row_count <number, 1000000> - number of rows in the test space
+   tuple_size <number, 100>    - size of the payload stored in each tuple
+
+ Being run without options, this benchmark measures the run time of a full
+ scan of a vinyl index stored on disk in both directions.
+]]
+
+local params = benchmark.argparse(arg, {
+    {'page_size', 'number'},
+    {'read_threads', 'number'},
+    {'row_count', 'number'},
+    {'tuple_size', 'number'},
+}, USAGE)
+
+local DEFAULT_PAGE_SIZE = 8 * 1024
+local DEFAULT_READ_THREADS = 1
+local DEFAULT_ROW_COUNT = 1000 * 1000
+local DEFAULT_TUPLE_SIZE = 100
+
+params.page_size = params.page_size or DEFAULT_PAGE_SIZE
+params.read_threads = params.read_threads or DEFAULT_READ_THREADS
+params.row_count = params.row_count or DEFAULT_ROW_COUNT
+params.tuple_size = params.tuple_size or DEFAULT_TUPLE_SIZE
+
+local bench = benchmark.new(params)
+
+local WORK_DIR = string.format(
+    'vinyl_scan,page_size=%d,row_count=%d,tuple_size=%d',
+    params.page_size, params.row_count, params.tuple_size)
+
+fio.mkdir(WORK_DIR)
+
+box.cfg({
+    work_dir = WORK_DIR,
+    log = 'tarantool.log',
+    checkpoint_count = 1,
+    vinyl_cache = 0,
+    vinyl_read_threads = params.read_threads,
+})
+
+box.once('init', function()
+    log.info('Creating the test space...')
+    local s = box.schema.space.create('test', {engine = 'vinyl'})
+    s:create_index('pk', {page_size = params.page_size})
+    log.info('Generating the test data set...')
+    local payload = string.rep('x', params.tuple_size)
+    local pct_complete = 0
+    box.begin()
+    for i = 1, params.row_count do
+        s:insert({i, payload})
+        if i % 1000 == 0 then
+            box.commit()
+            local pct = math.floor(100 * i / params.row_count)
+            if pct ~= pct_complete then
+                log.info('%d%% complete', pct)
+                pct_complete = pct
+            end
+            box.begin()
+        end
+    end
+    box.commit()
+    log.info('Dumping the data to disk...')
+    box.snapshot()
+end)
+
+local function scan(iterator)
+    local count = 0
+    for _ in box.space.test:pairs({}, {iterator = iterator}) do
+        count = count + 1
+    end
+    assert(count == params.row_count)
+end
+
+local TESTS = {
+    {
+        name = 'scan_ge',
+        func = function()
+            scan('ge')
+        end,
+    },
+    {
+        name = 'scan_le',
+        func = function()
+            scan('le')
+        end,
+    },
+}
+
+local function run_test(test)
+    local func = test.func
+    local real_time_start = clock.time()
+    local cpu_time_start = clock.proc()
+    func()
+    local delta_real = clock.time() - real_time_start
+    local delta_cpu = clock.proc() - cpu_time_start
+    bench:add_result(test.name, {
+        real_time = delta_real,
+        cpu_time = delta_cpu,
+        items = params.row_count,
+    })
+end
+
+for _, test in ipairs(TESTS) do
+    log.info('Running test %s...', test.name)
+    run_test(test)
+end
+
+bench:dump_results()
+
+os.exit(0)
@@ -125,6 +125,7 @@ class Memtx final {
 					   memtx_tuple_arena_max_size,
 					   memtx_objsize_min,
 					   /*dontdump=*/true,
+					   /*huge_pages=*/"off",
 					   memtx_granularity, "small",
 					   memtx_alloc_factor,
 					   /*threads_num=*/0,
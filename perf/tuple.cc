@@ -574,6 +574,158 @@ tuple_tuple_compare_hint(benchmark::State& state)
 
 BENCHMARK_TEMPLATE(tuple_tuple_compare_hint, FORMAT_BASIC);
 
+/**
+ * Create a key definition for FORMAT_BASIC tuples that doesn't have
+ * a pre-generated comparator:
+ * 0 - {STR nullable};
+ * 1 - {UINT, STR} with parts in reverse field order;
+ * 2 - {UINT desc, UINT}.
+ */
+static struct key_def *
+compare_key_def_new(int64_t key)
+{
+	struct key_part_def parts[2];
+	uint32_t part_count = 0;
+	for (size_t i = 0; i < lengthof(parts); i++)
+		parts[i] = key_part_def_default;
+	switch (key) {
+	case 0:
+		parts[part_count].fieldno = 1;
+		parts[part_count].is_nullable = true;
+		parts[part_count].nullable_action = ON_CONFLICT_ACTION_NONE;
+		parts[part_count++].type = FIELD_TYPE_STRING;
+		break;
+	case 1:
+		parts[part_count].fieldno = 3;
+		parts[part_count++].type = FIELD_TYPE_UNSIGNED;
+		parts[part_count].fieldno = 1;
+		parts[part_count++].type = FIELD_TYPE_STRING;
+		break;
+	case 2:
+		parts[part_count].fieldno = 0;
+		parts[part_count].sort_order = SORT_ORDER_DESC;
+		parts[part_count++].type = FIELD_TYPE_UNSIGNED;
+		parts[part_count].fieldno = 3;
+		parts[part_count++].type = FIELD_TYPE_UNSIGNED;
+		break;
+	default:
+		abort();
+	}
+	struct key_def *kd = key_def_new(parts, part_count, 0);
+	if (kd == NULL)
+		abort();
+	return kd;
+}
+
+// benchmark of tuple compare without a pre-generated comparator.
+template<data_format F>
+static void
+tuple_tuple_compare_slowpath(benchmark::State& state)
+{
+	TestTuples<F> tuples;
+	struct key_def *kd = compare_key_def_new(state.range(0));
+	size_t i = 0;
+	size_t j = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == NUM_TEST_TUPLES) {
+			total_count += i;
+			i = 0;
+		}
+		if (j >= NUM_TEST_TUPLES)
+			j -= NUM_TEST_TUPLES;
+		benchmark::DoNotOptimize(tuple_compare(tuples[i], HINT_NONE,
+						       tuples[j], HINT_NONE,
+						       kd));
+		++i;
+		j += 3;
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+	key_def_delete(kd);
+}
+
+BENCHMARK_TEMPLATE(tuple_tuple_compare_slowpath, FORMAT_BASIC)
+	->Arg(0)->Arg(1)->Arg(2);
+
+/** Hash function used by the tuple hash benchmarks. */
+enum hash_func {
+	/** key_def::tuple_hash, XXH3. */
+	HASH_FUNC_XXH3,
+	/** key_def::tuple_hash_murmur, PMurHash32. */
+	HASH_FUNC_MURMUR,
+};
+
+/**
+ * Create a key definition for FORMAT_BASIC tuples for the tuple hash
+ * benchmarks:
+ * 0 - {STR} (pre-generated hasher);
+ * 1 - {UINT, STR} (pre-generated hasher);
+ * 2 - {STR, UINT, UINT} with a gap between parts (slow path).
+ */
+static struct key_def *
+hash_key_def_new(int64_t key)
+{
+	struct key_part_def parts[3];
+	uint32_t part_count = 0;
+	for (size_t i = 0; i < lengthof(parts); i++)
+		parts[i] = key_part_def_default;
+	switch (key) {
+	case 0:
+		parts[part_count].fieldno = 1;
+		parts[part_count++].type = FIELD_TYPE_STRING;
+		break;
+	case 1:
+		parts[part_count].fieldno = 0;
+		parts[part_count++].type = FIELD_TYPE_UNSIGNED;
+		parts[part_count].fieldno = 1;
+		parts[part_count++].type = FIELD_TYPE_STRING;
+		break;
+	case 2:
+		parts[part_count].fieldno = 1;
+		parts[part_count++].type = FIELD_TYPE_STRING;
+		parts[part_count].fieldno = 3;
+		parts[part_count++].type = FIELD_TYPE_UNSIGNED;
+		parts[part_count].fieldno = 4;
+		parts[part_count++].type = FIELD_TYPE_UNSIGNED;
+		break;
+	default:
+		abort();
+	}
+	struct key_def *kd = key_def_new(parts, part_count, 0);
+	if (kd == NULL)
+		abort();
+	return kd;
+}
+
+// benchmark of tuple hash.
+template<data_format F, hash_func H>
+static void
+tuple_tuple_hash(benchmark::State& state)
+{
+	TestTuples<F> tuples;
+	struct key_def *kd = hash_key_def_new(state.range(0));
+	tuple_hash_t hash = H == HASH_FUNC_XXH3 ?
+			    kd->tuple_hash : kd->tuple_hash_murmur;
+	size_t i = 0;
+	size_t total_count = 0;
+	for (auto _ : state) {
+		if (i == NUM_TEST_TUPLES) {
+			total_count += i;
+			i = 0;
+		}
+		benchmark::DoNotOptimize(hash(tuples[i++], kd));
+	}
+	total_count += i;
+	state.SetItemsProcessed(total_count);
+	key_def_delete(kd);
+}
+
+BENCHMARK_TEMPLATE(tuple_tuple_hash, FORMAT_BASIC, HASH_FUNC_XXH3)
+	->Arg(0)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(tuple_tuple_hash, FORMAT_BASIC, HASH_FUNC_MURMUR)
+	->Arg(0)->Arg(1)->Arg(2);
+
 BENCHMARK_MAIN();
 
 #include "debug_warning.h"
@@ -230,6 +230,21 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			 "distance must be either 'euclid' or 'manhattan'");
 		return -1;
 	}
+	if (opts->layout == index_hash_layout_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "layout must be either 'chained' or 'swiss'");
+		return -1;
+	}
+	if (opts->hash_func == index_hash_func_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "hash_func must be either 'murmur' or 'xxh3'");
+		return -1;
+	}
+	if (opts->hint_parts != 1 && opts->hint_parts != 2) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 "hint_parts must be either 1 or 2");
+		return -1;
+	}
 	if (opts->page_size <= 0 || (opts->range_size > 0 &&
 				     opts->page_size > opts->range_size)) {
 		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
@@ -0,0 +1,954 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "arrow_stream.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arrow/abi.h"
+#include "diag.h"
+#include "engine.h"
+#include "error.h"
+#include "fiber.h"
+#include "fiber_cond.h"
+#include "field_def.h"
+#include "index.h"
+#include "msgpuck.h"
+#include "read_view.h"
+#include "schema.h"
+#include "small/region.h"
+#include "space.h"
+#include "space_cache.h"
+#include "trivia/util.h"
+#include "tt_pthread.h"
+#include "tt_static.h"
+
+/**
+ * Max number of record batches built by the producer thread and not
+ * consumed yet. Two batches are enough for the producer to build the next
+ * batch while the consumer is processing the previous one.
+ */
+enum { ARROW_STREAM_QUEUE_SIZE = 2 };
+
+/** A column of an Arrow stream. */
+struct arrow_stream_column {
+	/** Zero-based number of the tuple field stored in the column. */
+	uint32_t fieldno;
+	/** Type of the tuple field. */
+	enum field_type type;
+	/** Set if the field is nullable. */
+	bool is_nullable;
+	/** Arrow format string of the column. */
+	const char *format;
+	/** Column (field) name. */
+	char *name;
+};
+
+/** Private data of an Arrow stream. */
+struct arrow_stream {
+	/** Index read view to read the data from. */
+	struct index_read_view *index;
+	/**
+	 * Read view opened by box_index_arrow_stream() or NULL if the read
+	 * view is owned by the caller. Closed when the stream is released.
+	 */
+	struct read_view *rv;
+	/** Iterator type. */
+	enum iterator_type type;
+	/** Key parts (without the MsgPack array header). */
+	char *key;
+	/** Number of key parts. */
+	uint32_t part_count;
+	/** Max number of rows in a record batch. */
+	uint32_t batch_row_count;
+	/** Columns of record batches. */
+	struct arrow_stream_column *columns;
+	/** Number of columns. */
+	uint32_t column_count;
+	/** Max field number stored in a column. */
+	uint32_t fieldno_max;
+	/** Producer thread. */
+	struct cord cord;
+	/** Mutex protecting the members below. */
+	pthread_mutex_t mutex;
+	/**
+	 * Signaled when a batch is added to or removed from the queue or
+	 * the producer stops.
+	 */
+	pthread_cond_t cond;
+	/** Circular queue of record batches ready to be consumed. */
+	struct ArrowArray queue[ARROW_STREAM_QUEUE_SIZE];
+	/** Index of the first batch in the queue. */
+	uint32_t queue_head;
+	/** Number of batches in the queue. */
+	uint32_t queue_len;
+	/** Set when the producer thread stops. */
+	bool is_eof;
+	/** Set when the stream is released to stop the producer thread. */
+	bool is_cancelled;
+	/** Set if the producer thread failed. */
+	bool is_failed;
+	/** Error message returned by get_last_error. */
+	char errmsg[DIAG_ERRMSG_MAX];
+	/**
+	 * Event loop of the tx thread if the stream has been read from
+	 * the tx thread, NULL otherwise. Set by the consumer under the
+	 * mutex once the watcher below is started.
+	 */
+	struct ev_loop *tx_loop;
+	/**
+	 * Sent by the producer thread to the tx thread when a batch is
+	 * added to the queue or the producer stops.
+	 */
+	struct ev_async tx_async;
+	/** Tx fibers waiting for the next batch, see tx_async. */
+	struct fiber_cond tx_cond;
+};
+
+box_arrow_options_t *
+box_arrow_options_new(void)
+{
+	struct box_arrow_options *options = xmalloc(sizeof(*options));
+	options->batch_row_count = ARROW_STREAM_BATCH_ROW_COUNT_DEFAULT;
+	return options;
+}
+
+void
+box_arrow_options_delete(box_arrow_options_t *options)
+{
+	free(options);
+}
+
+void
+box_arrow_options_set_batch_row_count(box_arrow_options_t *options,
+				      size_t count)
+{
+	options->batch_row_count = count;
+}
+
+/**
+ * Returns the Arrow format string for a field type or NULL if the type
+ * can't be stored in an Arrow column.
+ */
+static const char *
+arrow_format_by_field_type(enum field_type type)
+{
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_UINT64:
+		return "L";
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_INT64:
+		return "l";
+	case FIELD_TYPE_NUMBER:
+	case FIELD_TYPE_DOUBLE:
+	case FIELD_TYPE_FLOAT64:
+		return "g";
+	case FIELD_TYPE_FLOAT32:
+		return "f";
+	case FIELD_TYPE_BOOLEAN:
+		return "b";
+	case FIELD_TYPE_STRING:
+		return "u";
+	case FIELD_TYPE_VARBINARY:
+		return "z";
+	case FIELD_TYPE_INT8:
+		return "c";
+	case FIELD_TYPE_UINT8:
+		return "C";
+	case FIELD_TYPE_INT16:
+		return "s";
+	case FIELD_TYPE_UINT16:
+		return "S";
+	case FIELD_TYPE_INT32:
+		return "i";
+	case FIELD_TYPE_UINT32:
+		return "I";
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * Returns the size of a value stored in the values buffer of an Arrow
+ * column or 0 if the values are stored as a bitmap (boolean) or in
+ * the data buffer (string, varbinary).
+ */
+static size_t
+arrow_stream_column_value_size(const struct arrow_stream_column *column)
+{
+	switch (column->format[0]) {
+	case 'c':
+	case 'C':
+		return 1;
+	case 's':
+	case 'S':
+		return 2;
+	case 'i':
+	case 'I':
+	case 'f':
+		return 4;
+	case 'l':
+	case 'L':
+	case 'g':
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Decodes the type, nullability and name of the given field from
+ * the space format stored in a read view (see space_def::format_data).
+ * Unlike field_def_array_decode(), doesn't access the tx thread caches
+ * so it may be called from any thread. Returns -1 and sets diag if
+ * the field isn't defined in the format.
+ */
+static int
+arrow_stream_column_decode(struct arrow_stream_column *column,
+			   const char *format_data, uint32_t fieldno)
+{
+	uint32_t field_count = 0;
+	if (format_data != NULL)
+		field_count = mp_decode_array(&format_data);
+	if (fieldno >= field_count) {
+		diag_set(ClientError, ER_NO_SUCH_FIELD_NO,
+			 fieldno + TUPLE_INDEX_BASE);
+		return -1;
+	}
+	for (uint32_t i = 0; i < fieldno; i++)
+		mp_next(&format_data);
+	column->fieldno = fieldno;
+	column->type = FIELD_TYPE_ANY;
+	column->is_nullable = false;
+	column->name = NULL;
+	uint32_t size = mp_decode_map(&format_data);
+	for (uint32_t i = 0; i < size; i++) {
+		if (mp_typeof(*format_data) != MP_STR) {
+			mp_next(&format_data);
+			mp_next(&format_data);
+			continue;
+		}
+		uint32_t len;
+		const char *key = mp_decode_str(&format_data, &len);
+		const char *str;
+		uint32_t str_len;
+		if (len == strlen("name") && memcmp(key, "name", len) == 0 &&
+		    mp_typeof(*format_data) == MP_STR) {
+			str = mp_decode_str(&format_data, &str_len);
+			column->name = xstrndup(str, str_len);
+		} else if (len == strlen("type") &&
+			   memcmp(key, "type", len) == 0 &&
+			   mp_typeof(*format_data) == MP_STR) {
+			str = mp_decode_str(&format_data, &str_len);
+			column->type = field_type_by_name(str, str_len);
+		} else if (len == strlen("is_nullable") &&
+			   memcmp(key, "is_nullable", len) == 0 &&
+			   mp_typeof(*format_data) == MP_BOOL) {
+			column->is_nullable = mp_decode_bool(&format_data);
+		} else {
+			mp_next(&format_data);
+		}
+	}
+	if (column->name == NULL)
+		column->name = xstrdup(tt_sprintf("%u", fieldno));
+	column->format = column->type == field_type_MAX ? NULL :
+			 arrow_format_by_field_type(column->type);
+	if (column->format == NULL) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream",
+			 tt_sprintf("field '%s' of type '%s'", column->name,
+				    column->type == field_type_MAX ? "unknown" :
+				    field_type_strs[column->type]));
+		free(column->name);
+		return -1;
+	}
+	return 0;
+}
+
+/** Frees a stream. The producer thread must be stopped. */
+static void
+arrow_stream_delete(struct arrow_stream *s)
+{
+	for (uint32_t i = 0; i < s->queue_len; i++) {
+		struct ArrowArray *array =
+			&s->queue[(s->queue_head + i) % ARROW_STREAM_QUEUE_SIZE];
+		array->release(array);
+	}
+	if (s->rv != NULL) {
+		read_view_close(s->rv);
+		free(s->rv);
+	}
+	for (uint32_t i = 0; i < s->column_count; i++)
+		free(s->columns[i].name);
+	free(s->columns);
+	free(s->key);
+	fiber_cond_destroy(&s->tx_cond);
+	tt_pthread_cond_destroy(&s->cond);
+	tt_pthread_mutex_destroy(&s->mutex);
+	free(s);
+}
+
+/**
+ * Private data of an Arrow array built by the stream. Buffers are
+ * allocated with malloc.
+ */
+struct arrow_array_data {
+	/** Buffers of the array. */
+	void *buffers[3];
+	/** Size of memory allocated for the data buffer (buffers[2]). */
+	size_t data_capacity;
+	/** Children of the array, pointed to by ArrowArray::children. */
+	struct ArrowArray *children;
+};
+
+/** Release callback of an Arrow array built by the stream. */
+static void
+arrow_array_release(struct ArrowArray *array)
+{
+	struct arrow_array_data *data = array->private_data;
+	/* Children could be moved out by the consumer. */
+	for (int64_t i = 0; i < array->n_children; i++) {
+		struct ArrowArray *child = array->children[i];
+		if (child->release != NULL)
+			child->release(child);
+	}
+	for (int i = 0; i < (int)lengthof(data->buffers); i++)
+		free(data->buffers[i]);
+	free(data->children);
+	free(array->children);
+	free(data);
+	array->release = NULL;
+}
+
+/** Initializes an Arrow array with no buffers and children. */
+static void
+arrow_array_create(struct ArrowArray *array)
+{
+	struct arrow_array_data *data = xcalloc(1, sizeof(*data));
+	memset(array, 0, sizeof(*array));
+	array->buffers = (const void **)data->buffers;
+	array->private_data = data;
+	array->release = arrow_array_release;
+}
+
+/**
+ * Allocates buffers of a column array for up to the given number of rows.
+ * The data buffer of a string column is allocated on demand.
+ */
+static void
+arrow_stream_column_array_create(const struct arrow_stream_column *column,
+				 struct ArrowArray *array, uint32_t row_count)
+{
+	arrow_array_create(array);
+	struct arrow_array_data *data = array->private_data;
+	size_t bitmap_size = DIV_ROUND_UP(row_count, 8);
+	if (column->is_nullable)
+		data->buffers[0] = xcalloc(bitmap_size, 1);
+	size_t value_size = arrow_stream_column_value_size(column);
+	if (value_size > 0) {
+		array->n_buffers = 2;
+		data->buffers[1] = xmalloc(value_size * row_count);
+	} else if (column->format[0] == 'b') {
+		array->n_buffers = 2;
+		data->buffers[1] = xcalloc(bitmap_size, 1);
+	} else {
+		array->n_buffers = 3;
+		int32_t *offsets = xmalloc(sizeof(int32_t) * (row_count + 1));
+		offsets[0] = 0;
+		data->buffers[1] = offsets;
+	}
+}
+
+/** Sets the error of a field value that can't be stored in a column. */
+static void
+arrow_stream_set_value_error(const struct arrow_stream_column *column,
+			     const char *field)
+{
+	const char *actual = field == NULL ? "nil" :
+			     mp_type_strs[mp_typeof(*field)];
+	diag_set(ClientError, ER_FIELD_TYPE,
+		 tt_sprintf("'%s'", column->name), column->format, actual);
+}
+
+/**
+ * Decodes a number stored in a tuple field as double. Returns -1 if
+ * the field doesn't store an integer or a floating point number.
+ */
+static int
+arrow_stream_decode_double(const char **field, double *value)
+{
+	switch (mp_typeof(**field)) {
+	case MP_UINT:
+		*value = mp_decode_uint(field);
+		return 0;
+	case MP_INT:
+		*value = mp_decode_int(field);
+		return 0;
+	case MP_FLOAT:
+		*value = mp_decode_float(field);
+		return 0;
+	case MP_DOUBLE:
+		*value = mp_decode_double(field);
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+/**
+ * Appends a tuple field to a column array. The field is NULL if it's
+ * missing in the tuple. Returns -1 and sets diag if the field value
+ * can't be stored in the column.
+ */
+static int
+arrow_stream_column_append(const struct arrow_stream_column *column,
+			   struct ArrowArray *array, const char *field)
+{
+	struct arrow_array_data *data = array->private_data;
+	int64_t row = array->length;
+	const char *pos = field;
+	if (field == NULL || mp_typeof(*field) == MP_NIL) {
+		if (!column->is_nullable) {
+			arrow_stream_set_value_error(column, field);
+			return -1;
+		}
+		array->null_count++;
+		if (array->n_buffers == 3) {
+			int32_t *offsets = data->buffers[1];
+			offsets[row + 1] = offsets[row];
+		}
+		array->length++;
+		return 0;
+	}
+	if (column->is_nullable) {
+		uint8_t *validity = data->buffers[0];
+		validity[row / 8] |= 1 << (row % 8);
+	}
+	void *values = data->buffers[1];
+	int64_t ival;
+	double dval;
+	switch (column->format[0]) {
+	case 'L':
+		if (mp_typeof(*pos) != MP_UINT)
+			goto error;
+		((uint64_t *)values)[row] = mp_decode_uint(&pos);
+		break;
+	case 'l':
+	case 'c':
+	case 'C':
+	case 's':
+	case 'S':
+	case 'i':
+	case 'I':
+		if (mp_read_int64(&pos, &ival) != 0)
+			goto error;
+		switch (column->format[0]) {
+		case 'l':
+			((int64_t *)values)[row] = ival;
+			break;
+		case 'c':
+			((int8_t *)values)[row] = ival;
+			break;
+		case 'C':
+			((uint8_t *)values)[row] = ival;
+			break;
+		case 's':
+			((int16_t *)values)[row] = ival;
+			break;
+		case 'S':
+			((uint16_t *)values)[row] = ival;
+			break;
+		case 'i':
+			((int32_t *)values)[row] = ival;
+			break;
+		case 'I':
+			((uint32_t *)values)[row] = ival;
+			break;
+		}
+		break;
+	case 'g':
+		if (arrow_stream_decode_double(&pos, &dval) != 0)
+			goto error;
+		((double *)values)[row] = dval;
+		break;
+	case 'f':
+		if (arrow_stream_decode_double(&pos, &dval) != 0)
+			goto error;
+		((float *)values)[row] = dval;
+		break;
+	case 'b':
+		if (mp_typeof(*pos) != MP_BOOL)
+			goto error;
+		if (mp_decode_bool(&pos))
+			((uint8_t *)values)[row / 8] |= 1 << (row % 8);
+		break;
+	case 'u':
+	case 'z': {
+		uint32_t len;
+		const char *str;
+		if (column->format[0] == 'u' && mp_typeof(*pos) == MP_STR)
+			str = mp_decode_str(&pos, &len);
+		else if (column->format[0] == 'z' && mp_typeof(*pos) == MP_BIN)
+			str = mp_decode_bin(&pos, &len);
+		else
+			goto error;
+		int32_t *offsets = values;
+		size_t size = offsets[row];
+		if (size + len > INT32_MAX) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Arrow stream",
+				 "record batches larger than 2 GB");
+			return -1;
+		}
+		if (size + len > data->data_capacity) {
+			data->data_capacity = MAX(data->data_capacity * 2,
+						  size + len);
+			data->buffers[2] = xrealloc(data->buffers[2],
+						    data->data_capacity);
+		}
+		memcpy((char *)data->buffers[2] + size, str, len);
+		offsets[row + 1] = size + len;
+		break;
+	}
+	default:
+		unreachable();
+	}
+	array->length++;
+	return 0;
+error:
+	arrow_stream_set_value_error(column, field);
+	return -1;
+}
+
+/**
+ * Reads the next record batch from the read view. On EOF returns a batch
+ * with no rows. Returns -1 and sets diag on error.
+ */
+static int
+arrow_stream_read_batch(struct arrow_stream *s,
+			struct index_read_view_iterator *it,
+			const char **fields, struct ArrowArray *batch)
+{
+	arrow_array_create(batch);
+	/* A struct array has a single (validity) buffer. */
+	batch->n_buffers = 1;
+	batch->n_children = s->column_count;
+	batch->children = xcalloc(s->column_count, sizeof(*batch->children));
+	struct arrow_array_data *data = batch->private_data;
+	data->children = xcalloc(s->column_count, sizeof(*data->children));
+	for (uint32_t i = 0; i < s->column_count; i++) {
+		batch->children[i] = &data->children[i];
+		arrow_stream_column_array_create(&s->columns[i],
+						 batch->children[i],
+						 s->batch_row_count);
+	}
+	struct region *region = &fiber()->gc;
+	while (batch->length < s->batch_row_count) {
+		/* Tuple data may be decompressed to the fiber region. */
+		size_t region_svp = region_used(region);
+		struct read_view_tuple tuple;
+		if (index_read_view_iterator_next_raw(it, &tuple) != 0)
+			goto fail;
+		if (tuple.data == NULL)
+			break;
+		const char *field = tuple.data;
+		uint32_t field_count = mp_decode_array(&field);
+		for (uint32_t i = 0; i <= s->fieldno_max; i++) {
+			if (i < field_count) {
+				fields[i] = field;
+				mp_next(&field);
+			} else {
+				fields[i] = NULL;
+			}
+		}
+		for (uint32_t i = 0; i < s->column_count; i++) {
+			struct arrow_stream_column *column = &s->columns[i];
+			if (arrow_stream_column_append(
+					column, batch->children[i],
+					fields[column->fieldno]) != 0)
+				goto fail;
+		}
+		region_truncate(region, region_svp);
+		batch->length++;
+	}
+	return 0;
+fail:
+	batch->release(batch);
+	return -1;
+}
+
+/**
+ * Wakes up tx fibers waiting for a batch. Must be called with
+ * the mutex locked.
+ */
+static void
+arrow_stream_notify_tx(struct arrow_stream *s)
+{
+	if (s->tx_loop != NULL)
+		ev_async_send(s->tx_loop, &s->tx_async);
+}
+
+/**
+ * Adds a record batch to the queue, waiting for the consumer if
+ * the queue is full. Returns -1 if the stream was released.
+ */
+static int
+arrow_stream_push(struct arrow_stream *s, struct ArrowArray *batch)
+{
+	tt_pthread_mutex_lock(&s->mutex);
+	while (s->queue_len == ARROW_STREAM_QUEUE_SIZE && !s->is_cancelled)
+		tt_pthread_cond_wait(&s->cond, &s->mutex);
+	bool is_cancelled = s->is_cancelled;
+	if (!is_cancelled) {
+		uint32_t i = (s->queue_head + s->queue_len) %
+			     ARROW_STREAM_QUEUE_SIZE;
+		s->queue[i] = *batch;
+		s->queue_len++;
+		tt_pthread_cond_broadcast(&s->cond);
+		arrow_stream_notify_tx(s);
+	}
+	tt_pthread_mutex_unlock(&s->mutex);
+	return is_cancelled ? -1 : 0;
+}
+
+/** Builds record batches until the read view is exhausted. */
+static int
+arrow_stream_produce(struct arrow_stream *s)
+{
+	struct index_read_view_iterator it;
+	if (index_read_view_create_iterator(s->index, s->type, s->key,
+					    s->part_count, &it) != 0)
+		return -1;
+	const char **fields = xcalloc(s->fieldno_max + 1, sizeof(*fields));
+	int rc = 0;
+	while (true) {
+		struct ArrowArray batch;
+		rc = arrow_stream_read_batch(s, &it, fields, &batch);
+		if (rc != 0)
+			break;
+		int64_t length = batch.length;
+		if (length == 0) {
+			batch.release(&batch);
+			break;
+		}
+		if (arrow_stream_push(s, &batch) != 0) {
+			batch.release(&batch);
+			break;
+		}
+		if (length < s->batch_row_count)
+			break;
+	}
+	free(fields);
+	index_read_view_iterator_destroy(&it);
+	return rc;
+}
+
+/** Producer thread function. */
+static int
+arrow_stream_producer_f(va_list ap)
+{
+	struct arrow_stream *s = va_arg(ap, struct arrow_stream *);
+	int rc = arrow_stream_produce(s);
+	tt_pthread_mutex_lock(&s->mutex);
+	if (rc != 0) {
+		s->is_failed = true;
+		strlcpy(s->errmsg, diag_last_error(diag_get())->errmsg,
+			sizeof(s->errmsg));
+	}
+	s->is_eof = true;
+	tt_pthread_cond_broadcast(&s->cond);
+	arrow_stream_notify_tx(s);
+	tt_pthread_mutex_unlock(&s->mutex);
+	/* The error is reported via the stream. */
+	diag_clear(diag_get());
+	return 0;
+}
+
+/** Waits until a batch is ready or the producer stops. */
+static void
+arrow_stream_wait(struct arrow_stream *s)
+{
+	tt_pthread_mutex_lock(&s->mutex);
+	while (s->queue_len == 0 && !s->is_eof)
+		tt_pthread_cond_wait(&s->cond, &s->mutex);
+	tt_pthread_mutex_unlock(&s->mutex);
+}
+
+/** Callback of arrow_stream::tx_async, runs in the tx thread. */
+static void
+arrow_stream_tx_async_cb(struct ev_loop *loop, struct ev_async *watcher,
+			 int events)
+{
+	(void)loop;
+	(void)events;
+	struct arrow_stream *s = watcher->data;
+	fiber_cond_broadcast(&s->tx_cond);
+}
+
+/**
+ * Waits until a batch is ready or the producer stops in the tx thread.
+ * Unlike arrow_stream_wait(), yields the calling fiber instead of
+ * blocking the thread: the producer wakes it up with tx_async.
+ */
+static void
+arrow_stream_wait_tx(struct arrow_stream *s)
+{
+	tt_pthread_mutex_lock(&s->mutex);
+	if (s->tx_loop == NULL) {
+		ev_async_init(&s->tx_async, arrow_stream_tx_async_cb);
+		s->tx_async.data = s;
+		ev_async_start(loop(), &s->tx_async);
+		s->tx_loop = loop();
+	}
+	while (s->queue_len == 0 && !s->is_eof) {
+		tt_pthread_mutex_unlock(&s->mutex);
+		/*
+		 * No wakeup can be lost: the watcher callback runs
+		 * only after the fiber yields. Cancellation is ignored,
+		 * like in coio_call().
+		 */
+		fiber_cond_wait(&s->tx_cond);
+		tt_pthread_mutex_lock(&s->mutex);
+	}
+	tt_pthread_mutex_unlock(&s->mutex);
+}
+
+/** ArrowArrayStream::get_next callback. */
+static int
+arrow_stream_get_next(struct ArrowArrayStream *stream, struct ArrowArray *out)
+{
+	struct arrow_stream *s = stream->private_data;
+	/* Don't block the tx thread event loop. */
+	if (cord_is_main())
+		arrow_stream_wait_tx(s);
+	else
+		arrow_stream_wait(s);
+	int rc = 0;
+	tt_pthread_mutex_lock(&s->mutex);
+	if (s->queue_len > 0) {
+		*out = s->queue[s->queue_head];
+		s->queue_head = (s->queue_head + 1) % ARROW_STREAM_QUEUE_SIZE;
+		s->queue_len--;
+		tt_pthread_cond_broadcast(&s->cond);
+	} else {
+		assert(s->is_eof);
+		/* The end of the stream is marked by a released array. */
+		memset(out, 0, sizeof(*out));
+		if (s->is_failed)
+			rc = EIO;
+	}
+	tt_pthread_mutex_unlock(&s->mutex);
+	return rc;
+}
+
+/** Release callback of a schema built by the stream. */
+static void
+arrow_schema_release(struct ArrowSchema *schema)
+{
+	for (int64_t i = 0; i < schema->n_children; i++) {
+		struct ArrowSchema *child = schema->children[i];
+		if (child->release != NULL)
+			child->release(child);
+	}
+	free(schema->private_data);
+	free(schema->children);
+	free((char *)schema->name);
+	schema->release = NULL;
+}
+
+/** ArrowArrayStream::get_schema callback. */
+static int
+arrow_stream_get_schema(struct ArrowArrayStream *stream,
+			struct ArrowSchema *out)
+{
+	struct arrow_stream *s = stream->private_data;
+	struct ArrowSchema *children = xcalloc(s->column_count,
+					       sizeof(*children));
+	memset(out, 0, sizeof(*out));
+	out->format = "+s";
+	out->name = xstrdup("");
+	out->n_children = s->column_count;
+	out->children = xcalloc(s->column_count, sizeof(*out->children));
+	out->private_data = children;
+	out->release = arrow_schema_release;
+	for (uint32_t i = 0; i < s->column_count; i++) {
+		struct arrow_stream_column *column = &s->columns[i];
+		struct ArrowSchema *child = &children[i];
+		child->format = column->format;
+		child->name = xstrdup(column->name);
+		if (column->is_nullable)
+			child->flags = ARROW_FLAG_NULLABLE;
+		child->release = arrow_schema_release;
+		out->children[i] = child;
+	}
+	return 0;
+}
+
+/** ArrowArrayStream::get_last_error callback. */
+static const char *
+arrow_stream_get_last_error(struct ArrowArrayStream *stream)
+{
+	struct arrow_stream *s = stream->private_data;
+	tt_pthread_mutex_lock(&s->mutex);
+	const char *errmsg = s->is_failed ? s->errmsg : NULL;
+	tt_pthread_mutex_unlock(&s->mutex);
+	return errmsg;
+}
+
+/** ArrowArrayStream::release callback. */
+static void
+arrow_stream_release(struct ArrowArrayStream *stream)
+{
+	struct arrow_stream *s = stream->private_data;
+	assert(s->rv == NULL || cord_is_main());
+	/* The watcher can only be stopped in the thread it runs in. */
+	assert(s->tx_loop == NULL || cord_is_main());
+	tt_pthread_mutex_lock(&s->mutex);
+	s->is_cancelled = true;
+	tt_pthread_cond_broadcast(&s->cond);
+	tt_pthread_mutex_unlock(&s->mutex);
+	if (cord_is_main())
+		cord_cojoin(&s->cord);
+	else
+		cord_join(&s->cord);
+	if (s->tx_loop != NULL)
+		ev_async_stop(s->tx_loop, &s->tx_async);
+	arrow_stream_delete(s);
+	stream->release = NULL;
+}
+
+int
+index_read_view_arrow_stream(struct index_read_view *index_rv,
+			     uint32_t field_count, const uint32_t *fields,
+			     const char *key, const char *key_end,
+			     const box_arrow_options_t *options,
+			     struct ArrowArrayStream *stream)
+{
+	size_t batch_row_count = options != NULL ? options->batch_row_count :
+				 ARROW_STREAM_BATCH_ROW_COUNT_DEFAULT;
+	if (batch_row_count == 0 || batch_row_count > INT32_MAX) {
+		diag_set(IllegalParams, "batch row count must be > 0 and "
+			 "<= %d", INT32_MAX);
+		return -1;
+	}
+	if (field_count == 0) {
+		diag_set(IllegalParams, "field count must be > 0");
+		return -1;
+	}
+	uint32_t part_count = mp_decode_array(&key);
+	enum iterator_type type = part_count == 0 ? ITER_ALL : ITER_EQ;
+	if (key_validate(index_rv->def, type, key, part_count) != 0)
+		return -1;
+	struct arrow_stream_column *columns = xcalloc(field_count,
+						      sizeof(*columns));
+	uint32_t fieldno_max = 0;
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (arrow_stream_column_decode(&columns[i],
+					       index_rv->space->format_data,
+					       fields[i]) != 0) {
+			for (uint32_t j = 0; j < i; j++)
+				free(columns[j].name);
+			free(columns);
+			return -1;
+		}
+		fieldno_max = MAX(fieldno_max, fields[i]);
+	}
+	struct arrow_stream *s = xcalloc(1, sizeof(*s));
+	s->index = index_rv;
+	s->type = type;
+	s->key = xmalloc(key_end - key + 1);
+	memcpy(s->key, key, key_end - key);
+	s->part_count = part_count;
+	s->batch_row_count = batch_row_count;
+	s->columns = columns;
+	s->column_count = field_count;
+	s->fieldno_max = fieldno_max;
+	tt_pthread_mutex_init(&s->mutex, NULL);
+	tt_pthread_cond_init(&s->cond, NULL);
+	fiber_cond_create(&s->tx_cond);
+	if (cord_costart(&s->cord, "arrow_stream", arrow_stream_producer_f,
+			 s) != 0) {
+		arrow_stream_delete(s);
+		return -1;
+	}
+	stream->get_schema = arrow_stream_get_schema;
+	stream->get_next = arrow_stream_get_next;
+	stream->get_last_error = arrow_stream_get_last_error;
+	stream->release = arrow_stream_release;
+	stream->private_data = s;
+	return 0;
+}
+
+/** Read view filter selecting the streamed space. */
+static bool
+arrow_stream_filter_space(struct space *space, void *arg)
+{
+	struct index *index = arg;
+	return space_index(space, index->def->iid) == index;
+}
+
+/** Read view filter selecting the streamed index. */
+static bool
+arrow_stream_filter_index(struct space *space, struct index *index,
+			  void *arg)
+{
+	(void)space;
+	return index == arg;
+}
+
+int
+box_index_arrow_stream(uint32_t space_id, uint32_t index_id,
+		       uint32_t field_count, const uint32_t *fields,
+		       const char *key, const char *key_end,
+		       const box_arrow_options_t *options,
+		       struct ArrowArrayStream *stream)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return -1;
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	struct index *index = index_find(space, index_id);
+	if (index == NULL)
+		return -1;
+	if ((space->engine->flags & ENGINE_SUPPORTS_READ_VIEW) == 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, space->engine->name,
+			 "Arrow stream");
+		return -1;
+	}
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = "arrow_stream";
+	opts.filter_space = arrow_stream_filter_space;
+	opts.filter_index = arrow_stream_filter_index;
+	opts.filter_arg = index;
+	opts.enable_field_names = true;
+	opts.enable_data_temporary_spaces = true;
+	struct read_view *rv = xmalloc(sizeof(*rv));
+	if (read_view_open(rv, &opts) != 0) {
+		free(rv);
+		return -1;
+	}
+	assert(!rlist_empty(&rv->spaces));
+	struct space_read_view *space_rv =
+		rlist_first_entry(&rv->spaces, struct space_read_view, link);
+	struct index_read_view *index_rv =
+		space_read_view_index(space_rv, index_id);
+	assert(index_rv != NULL);
+	if (index_read_view_arrow_stream(index_rv, field_count, fields,
+					 key, key_end, options, stream) != 0) {
+		read_view_close(rv);
+		free(rv);
+		return -1;
+	}
+	struct arrow_stream *s = stream->private_data;
+	s->rv = rv;
+	return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trivia/util.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/** Default max number of rows in an Arrow record batch. */
+enum { ARROW_STREAM_BATCH_ROW_COUNT_DEFAULT = 1024 };
+
+/** \cond public */
+
+struct ArrowArrayStream;
+
+/** Options of an Arrow stream. */
+typedef struct box_arrow_options box_arrow_options_t;
+
+/**
+ * Allocate Arrow stream options and set them to default values.
+ * The options must be freed with box_arrow_options_delete().
+ */
+API_EXPORT box_arrow_options_t *
+box_arrow_options_new(void);
+
+/** Free Arrow stream options. */
+API_EXPORT void
+box_arrow_options_delete(box_arrow_options_t *options);
+
+/**
+ * Set the max number of rows in a record batch returned by an Arrow
+ * stream. Must be greater than 0. Default: 1024.
+ */
+API_EXPORT void
+box_arrow_options_set_batch_row_count(box_arrow_options_t *options,
+				      size_t count);
+
+/**
+ * Create a stream of Arrow record batches (Arrow C stream interface, see
+ * https://arrow.apache.org/docs/format/CStreamInterface.html) over the
+ * given index of a space.
+ *
+ * The stream reads a consistent read view of the index opened by this
+ * function, so changes done to the space after the function returns are
+ * not visible to it. Record batches are built from the read view in
+ * a background thread so the tx thread isn't involved in scanning.
+ *
+ * Every record batch is a struct array (format "+s") which children
+ * are columns corresponding to the requested fields. The fields must be
+ * defined in the space format and have one of the following types:
+ * unsigned, integer, number, double, boolean, string, varbinary,
+ * int8..int64, uint8..uint64, float32, float64. Nullable fields have
+ * a validity bitmap.
+ *
+ * The stream may be read from any thread, but this function and
+ * the stream release callback may only be called from the tx thread.
+ * If the stream is read from the tx thread, the calling fiber yields
+ * while waiting for the next batch.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param field_count number of fields in \a fields
+ * \param fields array of fields to read (zero-based field numbers)
+ * \param key encoded key in MsgPack Array format ([part1, part2, ...]),
+ *            an empty key selects all tuples, otherwise tuples equal to
+ *            the key are selected
+ * \param key_end the end of encoded \a key
+ * \param options stream options or NULL for defaults
+ * \param[out] stream the stream
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_index_arrow_stream(uint32_t space_id, uint32_t index_id,
+		       uint32_t field_count, const uint32_t *fields,
+		       const char *key, const char *key_end,
+		       const box_arrow_options_t *options,
+		       struct ArrowArrayStream *stream);
+
+/** \endcond public */
+
+struct index_read_view;
+
+/** Arrow stream options. */
+struct box_arrow_options {
+	/** Max number of rows in a record batch. */
+	size_t batch_row_count;
+};
+
+/**
+ * Create an Arrow stream over an index read view. Like
+ * box_index_arrow_stream(), but doesn't open a read view and doesn't
+ * check access rights. Field types are taken from the space format
+ * stored in the read view so it must be opened with the
+ * read_view_opts::enable_field_names flag. The read view must stay open
+ * until the stream is released. Unlike box_index_arrow_stream(), may be
+ * called from any thread, and so may be the stream release callback
+ * unless the stream has been read from the tx thread.
+ */
+int
+index_read_view_arrow_stream(struct index_read_view *index_rv,
+			     uint32_t field_count, const uint32_t *fields,
+			     const char *key, const char *key_end,
+			     const box_arrow_options_t *options,
+			     struct ArrowArrayStream *stream);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -1104,7 +1104,9 @@ extern "C" int
 say_check_cfg(const char *log,
 	      MAYBE_UNUSED int level,
 	      int nonblock,
-	      const char *format_str)
+	      const char *format_str,
+	      bool async,
+	      const char *async_policy)
 {
 	enum say_logger_type type = SAY_LOGGER_STDERR;
 	if (log != NULL && say_parse_logger_type(&log, &type) < 0) {
@@ -1136,6 +1138,17 @@ say_check_cfg(const char *log,
 			 "the option is incompatible with file/stderr logger");
 		return -1;
 	}
+	if (say_async_policy_by_name(async_policy) == say_async_policy_MAX) {
+		diag_set(ClientError, ER_CFG, "log_async_policy",
+			 "expected 'block' or 'drop'");
+		return -1;
+	}
+	if (async &&
+	    (type == SAY_LOGGER_SYSLOG || type == SAY_LOGGER_STDERR)) {
+		diag_set(ClientError, ER_CFG, "log_async",
+			 "the option is incompatible with syslog/stderr logger");
+		return -1;
+	}
 	return 0;
 }
 
@@ -1683,6 +1696,24 @@ box_check_checkpoint_count(int checkpoint_count)
 	}
 }
 
+static void
+box_check_snap_delta_count(int snap_delta_count)
+{
+	if (snap_delta_count < 0) {
+		tnt_raise(ClientError, ER_CFG, "snap_delta_count",
+			  "the value must not be less than zero");
+	}
+}
+
+static void
+box_check_memtx_defrag_threshold(double threshold)
+{
+	if (threshold < 0 || threshold >= 1) {
+		tnt_raise(ClientError, ER_CFG, "memtx_defrag_threshold",
+			  "the value must be >= 0 and < 1");
+	}
+}
+
 static int64_t
 box_check_wal_max_size(int64_t wal_max_size)
 {
@@ -1794,6 +1825,19 @@ box_check_allocator(void)
 	return 0;
 }
 
+static int
+box_check_memtx_huge_pages(void)
+{
+	const char *huge_pages = cfg_gets("memtx_huge_pages");
+	if (STR2ENUM(tuple_arena_huge_pages, huge_pages) ==
+	    tuple_arena_huge_pages_MAX) {
+		diag_set(ClientError, ER_CFG, "memtx_huge_pages",
+			 "expected 'off', 'transparent', '2M' or '1G'");
+		return -1;
+	}
+	return 0;
+}
+
 static void
 box_check_small_alloc_options(void)
 {
@@ -1970,6 +2014,8 @@ box_check_config(void)
 	uri_destroy(&uri);
 	box_check_readahead(cfg_geti("readahead"));
 	box_check_checkpoint_count(cfg_geti("checkpoint_count"));
+	box_check_snap_delta_count(cfg_geti("snap_delta_count"));
+	box_check_memtx_defrag_threshold(cfg_getd("memtx_defrag_threshold"));
 	box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
 	if (box_check_wal_queue_max_size() < 0)
@@ -1983,6 +2029,8 @@ box_check_config(void)
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
 	if (box_check_allocator() != 0)
 		diag_raise();
+	if (box_check_memtx_huge_pages() != 0)
+		diag_raise();
 	box_check_small_alloc_options();
 	box_check_vinyl_options();
 	if (box_check_iproto_options() != 0)
@@ -3171,6 +3219,28 @@ box_set_snap_io_rate_limit(void)
 			cfg_getd("snap_io_rate_limit"));
 }
 
+void
+box_set_snap_delta_count(void)
+{
+	int snap_delta_count = cfg_geti("snap_delta_count");
+	box_check_snap_delta_count(snap_delta_count);
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snap_delta_count(memtx, snap_delta_count);
+}
+
+void
+box_set_memtx_defrag_threshold(void)
+{
+	double threshold = cfg_getd("memtx_defrag_threshold");
+	box_check_memtx_defrag_threshold(threshold);
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_defrag_set_threshold(memtx, threshold);
+}
+
 void
 box_set_memtx_memory(void)
 {
@@ -4056,6 +4126,44 @@ box_truncate(uint32_t space_id)
 	}
 }
 
+box_bulk_load_t *
+box_bulk_load_new(uint32_t space_id, size_t memory)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return NULL;
+	if (access_check_space(space, PRIV_W) != 0)
+		return NULL;
+	if (!space_is_vinyl(space)) {
+		diag_set(ClientError, ER_UNSUPPORTED, space->engine->name,
+			 "bulk load");
+		return NULL;
+	}
+	if (box_check_writable() != 0)
+		return NULL;
+	return vinyl_bulk_load_new(space, memory);
+}
+
+int
+box_bulk_load_add(box_bulk_load_t *bulk_load, const char *tuple,
+		  const char *tuple_end)
+{
+	mp_tuple_assert(tuple, tuple_end);
+	return vinyl_bulk_load_add(bulk_load, tuple, tuple_end);
+}
+
+int
+box_bulk_load_commit(box_bulk_load_t *bulk_load)
+{
+	return vinyl_bulk_load_commit(bulk_load);
+}
+
+void
+box_bulk_load_delete(box_bulk_load_t *bulk_load)
+{
+	vinyl_bulk_load_delete(bulk_load);
+}
+
 /** Update a record in _sequence_data space. */
 static int
 sequence_data_update(uint32_t seq_id, int64_t value)
@@ -5015,6 +5123,7 @@ engine_init()
 				    cfg_getd("memtx_memory"),
 				    cfg_geti("memtx_min_tuple_size"),
 				    cfg_geti("strip_core"),
+				    cfg_gets("memtx_huge_pages"),
 				    cfg_geti("slab_alloc_granularity"),
 				    cfg_gets("memtx_allocator"),
 				    cfg_getd("slab_alloc_factor"),
@@ -5023,6 +5132,8 @@ engine_init()
 	engine_register((struct engine *)memtx);
 	assert(memtx->base.id < MAX_TX_ENGINE_COUNT);
 	box_set_memtx_max_tuple_size();
+	box_set_snap_delta_count();
+	box_set_memtx_defrag_threshold();
 
 	memcs_engine_register();
 
@@ -351,6 +351,8 @@ int box_listen(void);
 void box_set_replication(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+void box_set_snap_delta_count(void);
+void box_set_memtx_defrag_threshold(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_checkpoint_count(void);
@@ -674,6 +676,63 @@ box_upsert(uint32_t space_id, uint32_t index_id, const char *tuple,
 API_EXPORT int
 box_truncate(uint32_t space_id);
 
+/** Bulk load of a vinyl space. */
+typedef struct vy_bulk_load box_bulk_load_t;
+
+/**
+ * Start bulk load into an empty vinyl space.
+ *
+ * Tuples added to a bulk load are sorted and written directly to
+ * disk, bypassing the write ahead log, so they aren't replicated.
+ * They become visible once the bulk load is committed. DML requests
+ * to the space fail until the bulk load is committed or deleted.
+ *
+ * \param space_id space identifier
+ * \param memory size of memory used for accumulating tuples before
+ *               writing them to disk, 0 means default (128 MB)
+ * \retval NULL on error (check box_error_last())
+ * \retval bulk load object otherwise
+ * \sa box_bulk_load_delete()
+ */
+API_EXPORT box_bulk_load_t *
+box_bulk_load_new(uint32_t space_id, size_t memory);
+
+/**
+ * Add a tuple to a bulk load. Tuples must be added in the
+ * ascending order of the primary key.
+ *
+ * \param bulk_load bulk load object
+ * \param tuple encoded tuple in MsgPack Array format ([ field1, field2, ...])
+ * \param tuple_end end of @a tuple
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_bulk_load_add(box_bulk_load_t *bulk_load, const char *tuple,
+		  const char *tuple_end);
+
+/**
+ * Write all tuples added to a bulk load to disk and make them
+ * visible. Waits for vinyl read views opened before the call to be
+ * closed. May not be called in a transaction. The bulk load object
+ * still has to be deleted after it.
+ *
+ * \param bulk_load bulk load object
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_bulk_load_commit(box_bulk_load_t *bulk_load);
+
+/**
+ * Delete a bulk load object. Tuples that haven't been committed
+ * are discarded.
+ *
+ * \param bulk_load bulk load object
+ */
+API_EXPORT void
+box_bulk_load_delete(box_bulk_load_t *bulk_load);
+
 /**
  * Advance a sequence.
  *
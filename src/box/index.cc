@@ -788,6 +788,9 @@ index_create(struct index *index, struct engine *engine,
 	/* Unusable until set to proper value during space creation. */
 	index->dense_id = UINT32_MAX;
 	rlist_create(&index->read_gaps);
+	rlist_create(&index->count_gaps);
+	rlist_create(&index->full_scan_gaps);
+	index->stat = NULL;
 }
 
 void
@@ -800,6 +803,7 @@ index_delete(struct index *index)
 	 * the index is primary or secondary.
 	 */
 	struct index_def *def = index->def;
+	free(index->stat);
 	memtx_tx_on_index_delete(index);
 	index->vtab->destroy(index);
 	index_def_delete(def);
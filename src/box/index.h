@@ -600,6 +600,33 @@ struct index_vtab {
 	void (*end_build)(struct index *index);
 };
 
+/**
+ * Index statistics collected by the SQL ANALYZE statement and used by
+ * the SQL planner to estimate selectivity of index scans. The object is
+ * allocated in one chunk with malloc() so that it can be freed with free().
+ */
+struct index_stat {
+	/** Number of tuples in the index at the time of collection. */
+	uint64_t tuple_count;
+	/** Number of entries in tuple_log_est minus one. */
+	uint32_t part_count;
+	/**
+	 * tuple_log_est[0] is the logarithmic estimate (10 * log2) of
+	 * tuple_count while tuple_log_est[i] is the logarithmic estimate
+	 * of the average number of tuples sharing the same first i key
+	 * parts.
+	 */
+	int16_t *tuple_log_est;
+	/** Number of entries in samples. */
+	uint32_t sample_count;
+	/**
+	 * Values of the first key part (MsgPack) of tuples picked with
+	 * reservoir sampling. Each of them represents an equal share of
+	 * the index so together they form an equi-depth histogram.
+	 */
+	const char **samples;
+};
+
 struct index {
 	/** Virtual function table. */
 	const struct index_vtab *vtab;
@@ -617,14 +644,26 @@ struct index {
 	uint32_t dense_id;
 	/**
 	 * List of gap_item's describing gap reads in the index with NULL
-	 * successor OR full scan gaps.
-	 * The first type happens when reading from empty index,
-	 * or when reading from rightmost part of ordered index (TREE).
-	 * The second type happens when a full scan was finished for
-	 * unordered index (HASH).
+	 * successor. It happens when reading from empty index, or when
+	 * reading from rightmost part of ordered index (TREE).
 	 * @sa struct gap_item_base.
 	 */
 	struct rlist read_gaps;
+	/**
+	 * List of gap_item's describing counts of tuples in the index.
+	 * Counts and full scans are stored apart from read_gaps so that
+	 * a write to the index only visits the items of the kind it checks.
+	 * @sa struct gap_item_base.
+	 */
+	struct rlist count_gaps;
+	/**
+	 * List of gap_item's describing full scans finished for unordered
+	 * index (HASH).
+	 * @sa struct gap_item_base.
+	 */
+	struct rlist full_scan_gaps;
+	/** Statistics collected by SQL ANALYZE or NULL. */
+	struct index_stat *stat;
 };
 
 /**
@@ -742,7 +781,7 @@ struct index_read_view_iterator_base {
 };
 
 /** Size of the index_read_view_iterator struct. */
-#define INDEX_READ_VIEW_ITERATOR_SIZE 72
+#define INDEX_READ_VIEW_ITERATOR_SIZE 88
 
 static_assert(sizeof(struct index_read_view_iterator_base) <=
 	      INDEX_READ_VIEW_ITERATOR_SIZE,
@@ -32,6 +32,7 @@
 #include "schema_def.h"
 #include "identifier.h"
 #include "tuple_format.h"
+#include "tuple_compare.h"
 #include "json/json.h"
 #include "fiber.h"
 #include "tt_static.h"
@@ -40,6 +41,10 @@ const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
+const char *index_hash_layout_strs[] = { "CHAINED", "SWISS" };
+
+const char *index_hash_func_strs[] = { "MURMUR", "XXH3" };
+
 const struct index_opts index_opts_default = {
 	/* .unique              = */ true,
 	/* .dimension           = */ 2,
@@ -52,6 +57,10 @@ const struct index_opts index_opts_default = {
 	/* .lsn                 = */ 0,
 	/* .func                = */ 0,
 	/* .hint                = */ INDEX_HINT_DEFAULT,
+	/* .layout              = */ INDEX_HASH_LAYOUT_CHAINED,
+	/* .hash_func           = */ INDEX_HASH_FUNC_MURMUR,
+	/* .hint_parts          = */ 1,
+	/* .key_prefix          = */ false,
 };
 
 /**
@@ -89,6 +98,12 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_DEF_LEGACY("sql"),
 	OPT_DEF_CUSTOM("hint", index_opts_parse_hint),
+	OPT_DEF_ENUM("layout", index_hash_layout, struct index_opts, layout,
+		     NULL),
+	OPT_DEF_ENUM("hash_func", index_hash_func, struct index_opts,
+		     hash_func, NULL),
+	OPT_DEF("hint_parts", OPT_UINT32, struct index_opts, hint_parts),
+	OPT_DEF("key_prefix", OPT_BOOL, struct index_opts, key_prefix),
 	OPT_END,
 };
 
@@ -128,6 +143,8 @@ index_def_new(uint32_t space_id, uint32_t iid, const char *name,
 		def->cmp_def = key_def_dup(key_def);
 		def->pk_def = key_def_dup(key_def);
 	}
+	if (opts->hint_parts > 1)
+		key_def_set_multipart_hint(def->cmp_def, true);
 	def->type = type;
 	def->space_id = space_id;
 	def->iid = iid;
@@ -66,6 +66,26 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+/** Layout of a memtx HASH index hash table. */
+enum index_hash_layout {
+	/** Chained hash table (salad/light.h). */
+	INDEX_HASH_LAYOUT_CHAINED,
+	/** Open addressing with SIMD group probing (salad/swiss.h). */
+	INDEX_HASH_LAYOUT_SWISS,
+	index_hash_layout_MAX
+};
+extern const char *index_hash_layout_strs[];
+
+/** Hash function of a memtx HASH index. */
+enum index_hash_func {
+	/** Murmur3 (third_party/PMurHash.c). */
+	INDEX_HASH_FUNC_MURMUR,
+	/** XXH3 (third_party/xxHash). */
+	INDEX_HASH_FUNC_XXH3,
+	index_hash_func_MAX
+};
+extern const char *index_hash_func_strs[];
+
 /** Index options */
 struct index_opts {
 	/**
@@ -109,6 +129,24 @@ struct index_opts {
 	 * Use hint optimization for tree index.
 	 */
 	enum index_hint_cfg hint;
+	/**
+	 * Hash table layout of memtx hash index.
+	 */
+	enum index_hash_layout layout;
+	/**
+	 * Hash function of memtx hash index.
+	 */
+	enum index_hash_func hash_func;
+	/**
+	 * Number of key parts encoded in a tuple hint of memtx tree
+	 * index, either 1 or 2.
+	 */
+	uint32_t hint_parts;
+	/**
+	 * Store prefixes of normalized keys in memtx tree index
+	 * elements, see key_normalize.h.
+	 */
+	bool key_prefix;
 };
 
 extern const struct index_opts index_opts_default;
@@ -156,6 +194,14 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
 		return o1->hint - o2->hint;
+	if (o1->layout != o2->layout)
+		return o1->layout - o2->layout;
+	if (o1->hash_func != o2->hash_func)
+		return o1->hash_func - o2->hash_func;
+	if (o1->hint_parts != o2->hint_parts)
+		return o1->hint_parts < o2->hint_parts ? -1 : 1;
+	if (o1->key_prefix != o2->key_prefix)
+		return o1->key_prefix < o2->key_prefix ? -1 : 1;
 	return 0;
 }
 
@@ -1973,6 +1973,12 @@ tx_fiber_init(struct session *session, uint64_t sync)
 	 */
 	fiber_set_session(f, session);
 	fiber_set_user(f, &session->credentials);
+	/*
+	 * Serve requests before background fibers which are
+	 * ready at the same time. Fibers created by the request
+	 * inherit the priority class.
+	 */
+	fiber_set_prio(f, FIBER_PRIO_HIGH);
 }
 
 static void
@@ -411,6 +411,10 @@ iproto_key_bit(unsigned char key)
 	 * VY_INDEX_RUN_INFO = 100
 	 * VY_INDEX_PAGE_INFO = 101
 	 * VY_RUN_ROW_INDEX = 102
+	 *
+	 * The following request is reserved for memtx delta snapshots.
+	 *
+	 * MEMTX_SNAP_SPACE_RESET = 103
 	 */								\
 									\
 	/** Non-final response type. */					\
@@ -437,6 +441,12 @@ enum iproto_type {
 	VY_INDEX_PAGE_INFO = 101,
 	/** Vinyl row index stored in .run file */
 	VY_RUN_ROW_INDEX = 102,
+	/**
+	 * Written to a memtx delta snapshot before rows of a space
+	 * that was changed since the base snapshot. Rows of the space
+	 * stored in older snapshots of the chain must be ignored.
+	 */
+	MEMTX_SNAP_SPACE_RESET = 103,
 };
 
 /** IPROTO type name by code */
@@ -480,6 +490,8 @@ iproto_type_name(uint16_t type)
 		return "PAGEINFO";
 	case VY_RUN_ROW_INDEX:
 		return "ROWINDEX";
+	case MEMTX_SNAP_SPACE_RESET:
+		return "SPACERESET";
 	default:
 		return NULL;
 	}
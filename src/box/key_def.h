@@ -192,6 +192,14 @@ struct key_def {
 	tuple_hash_t tuple_hash;
 	/** @see key_hash() */
 	key_hash_t key_hash;
+	/**
+	 * Murmur3-based variants of tuple_hash() and key_hash(). Used
+	 * by memtx hash indexes with hash_func = 'murmur' and by vinyl
+	 * bloom filters of the legacy format, which store the hashes,
+	 * so they must never change.
+	 */
+	tuple_hash_t tuple_hash_murmur;
+	key_hash_t key_hash_murmur;
 	/** @see tuple_hint() */
 	tuple_hint_t tuple_hint;
 	/** @see key_hint() */
@@ -219,6 +227,13 @@ struct key_def {
 	bool for_func_index;
 	/** True if it is unordered index key definition. */
 	bool is_unordered;
+	/**
+	 * True if tuple and key hints pack the first two key parts
+	 * instead of the first one. Used by memtx tree indexes with
+	 * the hint_parts = 2 option. The regular hints are used if
+	 * the key parts types don't allow multipart hints.
+	 */
+	bool use_multipart_hint;
 	/**
 	 * True, if some key parts can be absent in a tuple. These
 	 * fields assumed to be MP_NIL.
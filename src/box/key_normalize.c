@@ -0,0 +1,447 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "key_normalize.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "coll/coll.h"
+#include "core/datetime.h"
+#include "core/decimal.h"
+#include "key_def.h"
+#include "mp_datetime.h"
+#include "mp_decimal.h"
+#include "mp_extension_types.h"
+#include "mp_uuid.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "tuple.h"
+
+/** Class bytes, ordered like in scalar comparison. */
+enum {
+	NKEY_NIL = 0x10,
+	NKEY_BOOL,
+	NKEY_NUMBER,
+	NKEY_STR,
+	NKEY_BIN,
+	NKEY_UUID,
+	NKEY_DATETIME,
+};
+
+/** Number kinds following NKEY_NUMBER. */
+enum {
+	NKEY_NUMBER_NAN = 0x01,
+	NKEY_NUMBER_NEG_INF,
+	NKEY_NUMBER_NEG,
+	NKEY_NUMBER_ZERO,
+	NKEY_NUMBER_POS,
+	NKEY_NUMBER_POS_INF,
+};
+
+/**
+ * Max number of decimal digits in a decimal or a 64-bit integer.
+ */
+enum { NKEY_DIGITS_MAX = DECIMAL_MAX_DIGITS };
+
+/** A growing buffer allocated on a region. */
+struct nkey_buf {
+	struct region *region;
+	char *data;
+	size_t size;
+	size_t capacity;
+};
+
+static void
+nkey_buf_create(struct nkey_buf *buf, struct region *region)
+{
+	buf->region = region;
+	buf->capacity = 64;
+	buf->data = xregion_alloc(region, buf->capacity);
+	buf->size = 0;
+}
+
+/** Reserve @a size bytes at the end of the buffer and return them. */
+static char *
+nkey_buf_reserve(struct nkey_buf *buf, size_t size)
+{
+	if (buf->size + size > buf->capacity) {
+		size_t capacity = buf->capacity * 2;
+		while (buf->size + size > capacity)
+			capacity *= 2;
+		char *data = xregion_alloc(buf->region, capacity);
+		memcpy(data, buf->data, buf->size);
+		buf->data = data;
+		buf->capacity = capacity;
+	}
+	return buf->data + buf->size;
+}
+
+static void
+nkey_put(struct nkey_buf *buf, const void *data, size_t size)
+{
+	memcpy(nkey_buf_reserve(buf, size), data, size);
+	buf->size += size;
+}
+
+static void
+nkey_put_byte(struct nkey_buf *buf, uint8_t b)
+{
+	nkey_put(buf, &b, 1);
+}
+
+static void
+nkey_put_u32(struct nkey_buf *buf, uint32_t v)
+{
+	uint8_t data[4] = {v >> 24, v >> 16, v >> 8, v};
+	nkey_put(buf, data, sizeof(data));
+}
+
+static void
+nkey_put_u64(struct nkey_buf *buf, uint64_t v)
+{
+	nkey_put_u32(buf, v >> 32);
+	nkey_put_u32(buf, v);
+}
+
+/**
+ * Put a byte string terminated with 0x00 0x00. A zero byte is
+ * escaped as 0x00 0xff, so a string is less than its extensions.
+ */
+static void
+nkey_put_bytes(struct nkey_buf *buf, const char *s, uint32_t len)
+{
+	const char *end = s + len;
+	while (s < end) {
+		const char *zero = memchr(s, 0, end - s);
+		if (zero == NULL) {
+			nkey_put(buf, s, end - s);
+			break;
+		}
+		nkey_put(buf, s, zero - s);
+		nkey_put(buf, "\x00\xff", 2);
+		s = zero + 1;
+	}
+	nkey_put(buf, "\x00\x00", 2);
+}
+
+/** Put a string as an ICU sort key terminated with 0x00. */
+static void
+nkey_put_str_coll(struct nkey_buf *buf, const char *s, uint32_t len,
+		  struct coll *coll)
+{
+	if (coll->type != COLL_TYPE_ICU) {
+		nkey_put_bytes(buf, s, len);
+		return;
+	}
+	/* ICU sort keys never contain zero bytes. */
+	size_t size = 2 * (size_t)len + 16;
+	while (true) {
+		char *data = nkey_buf_reserve(buf, size + 1);
+		size_t n = coll->hint(s, len, data, size, coll);
+		if (n < size) {
+			data[n] = 0;
+			buf->size += n + 1;
+			return;
+		}
+		size *= 2;
+	}
+}
+
+/**
+ * Put a non-zero number given by its decimal digits:
+ * (-1)^is_neg * 0.<digits> * 10^exponent.
+ */
+static void
+nkey_put_digits(struct nkey_buf *buf, bool is_neg, const uint8_t *digits,
+		int count, int32_t exponent)
+{
+	assert(count > 0 && digits[0] != 0);
+	while (digits[count - 1] == 0)
+		count--;
+	nkey_put_byte(buf, is_neg ? NKEY_NUMBER_NEG : NKEY_NUMBER_POS);
+	size_t start = buf->size;
+	nkey_put_u32(buf, (uint32_t)exponent ^ 0x80000000);
+	/* Two digits per byte, a zero nibble terminates the number. */
+	for (int i = 0; i < count; i += 2) {
+		uint8_t b = (digits[i] + 1) << 4;
+		if (i + 1 < count)
+			b |= digits[i + 1] + 1;
+		nkey_put_byte(buf, b);
+	}
+	if (count % 2 == 0)
+		nkey_put_byte(buf, 0);
+	if (is_neg) {
+		for (size_t i = start; i < buf->size; i++)
+			buf->data[i] = ~buf->data[i];
+	}
+}
+
+static void
+nkey_put_uint(struct nkey_buf *buf, bool is_neg, uint64_t v)
+{
+	if (v == 0) {
+		nkey_put_byte(buf, NKEY_NUMBER_ZERO);
+		return;
+	}
+	uint8_t digits[NKEY_DIGITS_MAX];
+	int count = 0;
+	for (uint64_t t = v; t != 0; t /= 10)
+		count++;
+	for (int i = count - 1; i >= 0; i--, v /= 10)
+		digits[i] = v % 10;
+	nkey_put_digits(buf, is_neg, digits, count, count);
+}
+
+static void
+nkey_put_int(struct nkey_buf *buf, int64_t v)
+{
+	if (v >= 0)
+		nkey_put_uint(buf, false, v);
+	else
+		nkey_put_uint(buf, true, -(uint64_t)v);
+}
+
+static void
+nkey_put_double(struct nkey_buf *buf, double d)
+{
+	if (isnan(d)) {
+		uint64_t bits;
+		memcpy(&bits, &d, sizeof(bits));
+		/* A quiet NaN is greater than a signaling one. */
+		nkey_put_byte(buf, NKEY_NUMBER_NAN);
+		nkey_put_byte(buf, (bits & UINT64_C(0x8000000000000)) != 0);
+		return;
+	}
+	if (isinf(d)) {
+		nkey_put_byte(buf, d < 0 ? NKEY_NUMBER_NEG_INF :
+					   NKEY_NUMBER_POS_INF);
+		return;
+	}
+	if (d == 0) {
+		nkey_put_byte(buf, NKEY_NUMBER_ZERO);
+		return;
+	}
+	if (fabs(d) >= 0x1p64) {
+		/*
+		 * The double is an integer that may be compared with
+		 * an integer or a decimal, so encode all its digits.
+		 * printf() prints them exactly.
+		 */
+		char str[DBL_MAX_10_EXP + 2];
+		int len = snprintf(str, sizeof(str), "%.0f", fabs(d));
+		assert(len > 0 && len < (int)sizeof(str));
+		uint8_t digits[DBL_MAX_10_EXP + 1];
+		for (int i = 0; i < len; i++)
+			digits[i] = str[i] - '0';
+		nkey_put_digits(buf, d < 0, digits, len, len);
+		return;
+	}
+	if (fabs(d) >= 0x1p53) {
+		/* The double is an integer, encode it exactly. */
+		nkey_put_uint(buf, d < 0, (uint64_t)fabs(d));
+		return;
+	}
+	/* d.ddddddddddddddddde[+-]x */
+	char str[32];
+	int len = snprintf(str, sizeof(str), "%.17e", fabs(d));
+	assert(len > 0 && len < (int)sizeof(str));
+	(void)len;
+	uint8_t digits[18];
+	digits[0] = str[0] - '0';
+	for (int i = 1; i < 18; i++)
+		digits[i] = str[i + 1] - '0';
+	assert(str[19] == 'e');
+	int32_t exponent = atoi(str + 20) + 1;
+	nkey_put_digits(buf, d < 0, digits, 18, exponent);
+}
+
+static void
+nkey_put_decimal(struct nkey_buf *buf, const decimal_t *dec)
+{
+	if (decNumberIsZero(dec)) {
+		nkey_put_byte(buf, NKEY_NUMBER_ZERO);
+		return;
+	}
+	uint8_t digits[NKEY_DIGITS_MAX];
+	assert(dec->digits <= NKEY_DIGITS_MAX);
+	decNumberGetBCD(dec, digits);
+	nkey_put_digits(buf, decNumberIsNegative(dec), digits, dec->digits,
+			dec->digits + dec->exponent);
+}
+
+/** Put a double so that memcmp() order matches the numeric one. */
+static void
+nkey_put_raw_double(struct nkey_buf *buf, double d)
+{
+	uint64_t bits;
+	memcpy(&bits, &d, sizeof(bits));
+	if ((bits & (UINT64_C(1) << 63)) != 0)
+		bits = ~bits;
+	else
+		bits |= UINT64_C(1) << 63;
+	nkey_put_u64(buf, bits);
+}
+
+static void
+nkey_put_ext(struct nkey_buf *buf, const char *field)
+{
+	int8_t ext_type;
+	uint32_t len = mp_decode_extl(&field, &ext_type);
+	switch (ext_type) {
+	case MP_DECIMAL: {
+		decimal_t dec;
+		VERIFY(decimal_unpack(&field, len, &dec) != NULL);
+		nkey_put_byte(buf, NKEY_NUMBER);
+		nkey_put_decimal(buf, &dec);
+		break;
+	}
+	case MP_UUID:
+		/* Packed UUIDs are big-endian, like memcmp() wants. */
+		assert(len == UUID_PACKED_LEN);
+		nkey_put_byte(buf, NKEY_UUID);
+		nkey_put(buf, field, UUID_PACKED_LEN);
+		break;
+	case MP_DATETIME: {
+		struct datetime date;
+		VERIFY(datetime_unpack(&field, len, &date) != NULL);
+		nkey_put_byte(buf, NKEY_DATETIME);
+		nkey_put_raw_double(buf, date.epoch);
+		nkey_put_u32(buf, (uint32_t)date.nsec ^ 0x80000000);
+		break;
+	}
+	default:
+		unreachable();
+	}
+}
+
+/**
+ * Check if a key part value can be normalized. The tuple comparator
+ * compares a double with a decimal after rounding the double to 15
+ * significant digits, which isn't a total order (e.g. decimal 0.1 is
+ * equal to two different doubles), so no encoding can match it. We
+ * refuse to normalize decimals where doubles may be stored and vice
+ * versa, so two normalized keys never need such a comparison.
+ */
+static bool
+nkey_field_is_supported(const char *field, struct key_part *part)
+{
+	bool is_decimal_part = part->type == FIELD_TYPE_DECIMAL;
+	switch (mp_typeof(*field)) {
+	case MP_FLOAT:
+	case MP_DOUBLE:
+		return !is_decimal_part;
+	case MP_EXT: {
+		int8_t ext_type;
+		mp_decode_extl(&field, &ext_type);
+		return ext_type != MP_DECIMAL || is_decimal_part;
+	}
+	default:
+		return true;
+	}
+}
+
+/**
+ * Put a key part value, NULL stands for an absent field. Returns -1
+ * if the value can't be normalized, see nkey_field_is_supported().
+ */
+static int
+nkey_put_field(struct nkey_buf *buf, const char *field,
+	       struct key_part *part)
+{
+	size_t start = buf->size;
+	if (field == NULL) {
+		nkey_put_byte(buf, NKEY_NIL);
+		goto out;
+	}
+	if (!nkey_field_is_supported(field, part))
+		return -1;
+	uint32_t len;
+	switch (mp_typeof(*field)) {
+	case MP_NIL:
+		nkey_put_byte(buf, NKEY_NIL);
+		break;
+	case MP_BOOL:
+		nkey_put_byte(buf, NKEY_BOOL);
+		nkey_put_byte(buf, mp_decode_bool(&field));
+		break;
+	case MP_UINT:
+		nkey_put_byte(buf, NKEY_NUMBER);
+		nkey_put_uint(buf, false, mp_decode_uint(&field));
+		break;
+	case MP_INT:
+		nkey_put_byte(buf, NKEY_NUMBER);
+		nkey_put_int(buf, mp_decode_int(&field));
+		break;
+	case MP_FLOAT:
+		nkey_put_byte(buf, NKEY_NUMBER);
+		nkey_put_double(buf, mp_decode_float(&field));
+		break;
+	case MP_DOUBLE:
+		nkey_put_byte(buf, NKEY_NUMBER);
+		nkey_put_double(buf, mp_decode_double(&field));
+		break;
+	case MP_STR:
+		len = mp_decode_strl(&field);
+		nkey_put_byte(buf, NKEY_STR);
+		if (part->coll != NULL)
+			nkey_put_str_coll(buf, field, len, part->coll);
+		else
+			nkey_put_bytes(buf, field, len);
+		break;
+	case MP_BIN:
+		len = mp_decode_binl(&field);
+		nkey_put_byte(buf, NKEY_BIN);
+		nkey_put_bytes(buf, field, len);
+		break;
+	case MP_EXT:
+		nkey_put_ext(buf, field);
+		break;
+	default:
+		unreachable();
+	}
+out:
+	if (part->sort_order == SORT_ORDER_DESC) {
+		for (size_t i = start; i < buf->size; i++)
+			buf->data[i] = ~buf->data[i];
+	}
+	return 0;
+}
+
+char *
+tuple_normalize_key(struct tuple *tuple, struct key_def *key_def,
+		    int multikey_idx, struct region *region, uint32_t *size)
+{
+	assert(!key_def->for_func_index);
+	struct nkey_buf buf;
+	nkey_buf_create(&buf, region);
+	for (uint32_t i = 0; i < key_def->part_count; i++) {
+		struct key_part *part = &key_def->parts[i];
+		const char *field = tuple_field_by_part(tuple, part,
+							multikey_idx);
+		if (nkey_put_field(&buf, field, part) != 0)
+			return NULL;
+	}
+	*size = buf.size;
+	return buf.data;
+}
+
+char *
+key_normalize(const char *key, uint32_t part_count, struct key_def *key_def,
+	      struct region *region, uint32_t *size)
+{
+	assert(part_count <= key_def->part_count);
+	struct nkey_buf buf;
+	nkey_buf_create(&buf, region);
+	for (uint32_t i = 0; i < part_count; i++) {
+		if (nkey_put_field(&buf, key, &key_def->parts[i]) != 0)
+			return NULL;
+		mp_next(&key);
+	}
+	*size = buf.size;
+	return buf.data;
+}
@@ -0,0 +1,101 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "trivia/util.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct key_def;
+struct region;
+struct tuple;
+
+/**
+ * A normalized key is a byte string encoding of key parts such that
+ * comparing two normalized keys with memcmp() gives the same result
+ * as comparing the original tuples or keys with the key definition
+ * they were normalized with. It allows to replace per-field msgpack
+ * decoding and type dispatching with a single memcmp() where keys
+ * are compared many times: in sorting, in index pages, etc.
+ *
+ * Every key part is encoded as a class byte (nil < boolean < number <
+ * string < varbinary < uuid < datetime, like in scalar comparison)
+ * followed by a self-delimiting encoding of the value, so a normalized
+ * partial key is a prefix of the normalized key of a matching tuple.
+ * All bytes of a descending part are inverted.
+ *
+ * Numbers of any msgpack type (integers, floats, doubles, decimals)
+ * are encoded as decimal floating point numbers, so they are ordered
+ * by their values. A double less than 2^53 by absolute value is
+ * encoded with 18 significant digits, which is enough to tell any two
+ * doubles apart and to order them correctly against integers. Larger
+ * doubles are integers and are encoded with all their digits.
+ *
+ * The tuple comparator rounds a double to 15 significant digits when
+ * it compares it with a decimal, which can't be reproduced with any
+ * encoding, so a key can't be normalized if it has a decimal value in
+ * a part that isn't of the decimal type or a floating point value in
+ * a decimal part. Such keys must be compared with the comparator.
+ * Strings with a collation are encoded as their ICU sort keys. NaNs
+ * are less than any other number.
+ */
+
+/**
+ * Normalize the key of a tuple.
+ *
+ * @param tuple Tuple to extract the key from.
+ * @param key_def Key definition.
+ * @param multikey_idx Multikey index hint or MULTIKEY_NONE.
+ * @param region Region to allocate the normalized key on.
+ * @param[out] size Size of the normalized key.
+ *
+ * @retval NULL The key can't be normalized, see above. The diagnostics
+ *              area isn't set.
+ * @retval not NULL The normalized key.
+ */
+char *
+tuple_normalize_key(struct tuple *tuple, struct key_def *key_def,
+		    int multikey_idx, struct region *region, uint32_t *size);
+
+/**
+ * Normalize a msgpack key (without the array header).
+ *
+ * @param key Key parts.
+ * @param part_count Number of key parts, may be less than the number
+ *                   of key_def parts.
+ * @param key_def Key definition.
+ * @param region Region to allocate the normalized key on.
+ * @param[out] size Size of the normalized key.
+ *
+ * @retval NULL The key can't be normalized, see above. The diagnostics
+ *              area isn't set.
+ * @retval not NULL The normalized key.
+ */
+char *
+key_normalize(const char *key, uint32_t part_count, struct key_def *key_def,
+	      struct region *region, uint32_t *size);
+
+/**
+ * Compare two normalized keys. Returns 0 if one of the keys is
+ * a prefix of the other, like tuple_compare_with_key() does for
+ * partial keys.
+ */
+static inline int
+normalized_key_compare(const char *key_a, uint32_t size_a,
+		       const char *key_b, uint32_t size_b)
+{
+	return memcmp(key_a, key_b, MIN(size_a, size_b));
+}
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
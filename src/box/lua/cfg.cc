@@ -37,6 +37,7 @@
 #include "lua/utils.h"
 
 #include "box/box.h"
+#include "coio_task.h"
 #include "libeio/eio.h"
 
 extern "C" {
@@ -136,6 +137,28 @@ lbox_cfg_set_snap_io_rate_limit(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_snap_delta_count(struct lua_State *L)
+{
+	try {
+		box_set_snap_delta_count();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_defrag_threshold(struct lua_State *L)
+{
+	try {
+		box_set_memtx_defrag_threshold();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_checkpoint_count(struct lua_State *L)
 {
@@ -295,6 +318,7 @@ lbox_cfg_set_worker_pool_threads(struct lua_State *L)
 	(void) L;
 	eio_set_min_parallel(cfg_geti("worker_pool_threads"));
 	eio_set_max_parallel(cfg_geti("worker_pool_threads"));
+	coio_set_worker_count(cfg_geti("worker_pool_threads"));
 	return 0;
 }
 
@@ -501,6 +525,9 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_io_collect_interval", lbox_cfg_set_io_collect_interval},
 		{"cfg_set_too_long_threshold", lbox_cfg_set_too_long_threshold},
 		{"cfg_set_snap_io_rate_limit", lbox_cfg_set_snap_io_rate_limit},
+		{"cfg_set_snap_delta_count", lbox_cfg_set_snap_delta_count},
+		{"cfg_set_memtx_defrag_threshold",
+		 lbox_cfg_set_memtx_defrag_threshold},
 		{"cfg_set_checkpoint_count", lbox_cfg_set_checkpoint_count},
 		{"cfg_set_checkpoint_interval", lbox_cfg_set_checkpoint_interval},
 		{"cfg_set_checkpoint_wal_threshold", lbox_cfg_set_checkpoint_wal_threshold},
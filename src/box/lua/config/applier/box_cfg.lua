@@ -345,9 +345,9 @@ local function apply(config)
 
     -- Construct logger destination (box_cfg.log) and log modules.
     --
-    -- `log.nonblock`, `log.level`, `log.format`, 'log.modules'
-    -- options are marked with the `box_cfg` annotations and so
-    -- they're already added to `box_cfg`.
+    -- `log.nonblock`, `log.level`, `log.format`, 'log.modules',
+    -- `log.async`, `log.async_policy` options are marked with the
+    -- `box_cfg` annotations and so they're already added to `box_cfg`.
     local cfg_log = configdata:get('log', {use_default = true})
     box_cfg.log = log_destination(cfg_log)
 
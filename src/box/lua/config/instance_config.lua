@@ -830,6 +830,20 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'log_format',
             default = 'plain',
         }),
+        async = schema.scalar({
+            type = 'boolean',
+            box_cfg = 'log_async',
+            box_cfg_nondynamic = true,
+            default = false,
+        }),
+        async_policy = schema.enum({
+            'block',
+            'drop',
+        }, {
+            box_cfg = 'log_async_policy',
+            box_cfg_nondynamic = true,
+            default = 'drop',
+        }),
         -- box.cfg({log_modules = <...>}) replaces the previous
         -- value without any merging.
         --
@@ -1161,6 +1175,21 @@ return schema.new('instance_config', schema.record({
             box_cfg_nondynamic = true,
             default = 'small',
         }),
+        huge_pages = schema.enum({
+            'off',
+            'transparent',
+            '2M',
+            '1G',
+        }, {
+            box_cfg = 'memtx_huge_pages',
+            box_cfg_nondynamic = true,
+            default = 'off',
+        }),
+        defrag_threshold = schema.scalar({
+            type = 'number',
+            box_cfg = 'memtx_defrag_threshold',
+            default = 0,
+        }),
         slab_alloc_granularity = schema.scalar({
             type = 'integer',
             box_cfg = 'slab_alloc_granularity',
@@ -1384,6 +1413,11 @@ return schema.new('instance_config', schema.record({
             box_cfg = 'snap_io_rate_limit',
             default = box.NULL,
         }),
+        delta_count = schema.scalar({
+            type = 'integer',
+            box_cfg = 'snap_delta_count',
+            default = 0,
+        }),
     }),
     replication = schema.record({
         failover = schema.enum({
@@ -220,7 +220,6 @@ static const char *lua_sources[] = {
 	SPACE_UPGRADE_BOX_LUA_MODULES
 	AUDIT_BOX_LUA_MODULES
 	FLIGHT_RECORDER_BOX_LUA_MODULES
-	READ_VIEW_BOX_LUA_MODULES
 	SECURITY_BOX_LUA_MODULES
 	INTEGRITY_BOX_LUA_MODULES
 	"box/xlog", "xlog", xlog_lua,
@@ -94,6 +94,7 @@ local default_cfg = {
     slab_alloc_factor   = 1.05,
     iproto_threads      = 1,
     memtx_allocator     = "small",
+    memtx_huge_pages    = "off",
     work_dir            = nil,
     memtx_dir           = ".",
     wal_dir             = ".",
@@ -117,6 +118,8 @@ local default_cfg = {
     log_level           = log.cfg.level,
     log_modules         = log.cfg.modules,
     log_format          = log.cfg.format,
+    log_async           = log.cfg.async,
+    log_async_policy    = log.cfg.async_policy,
 
     audit_log           = ifdef_audit(nil),
     audit_nonblock      = ifdef_audit(true),
@@ -151,6 +154,8 @@ local default_cfg = {
     io_collect_interval = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
+    snap_delta_count    = 0,
+    memtx_defrag_threshold = 0,
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     wal_max_size        = 256 * 1024 * 1024,
@@ -295,6 +300,7 @@ local template_cfg = {
     slab_alloc_factor   = 'number',
     iproto_threads      = 'number',
     memtx_allocator     = 'string',
+    memtx_huge_pages    = 'string',
     work_dir            = 'string',
     memtx_dir            = 'string',
     wal_dir             = 'string',
@@ -317,6 +323,8 @@ local template_cfg = {
     log_level           = 'number, string',
     log_modules         = 'table',
     log_format          = 'string',
+    log_async           = 'boolean',
+    log_async_policy    = 'string',
 
     audit_log           = ifdef_audit('string'),
     audit_nonblock      = ifdef_audit('boolean'),
@@ -351,6 +359,8 @@ local template_cfg = {
     io_collect_interval = 'number',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
+    snap_delta_count    = 'number',
+    memtx_defrag_threshold = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     wal_max_size        = 'number',
@@ -489,6 +499,8 @@ local dynamic_cfg = {
     readahead               = private.cfg_set_readahead,
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
+    snap_delta_count        = private.cfg_set_snap_delta_count,
+    memtx_defrag_threshold  = private.cfg_set_memtx_defrag_threshold,
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
@@ -613,6 +625,8 @@ local dynamic_cfg_modules = {
             log_modules = true,
             log_format = true,
             log_nonblock = true,
+            log_async = true,
+            log_async_policy = true,
         },
         skip_at_load = true,
     }
@@ -674,6 +688,8 @@ end
 local dynamic_cfg_skip_at_load = {
     memtx_memory            = true,
     memtx_max_tuple_size    = true,
+    snap_delta_count        = true,
+    memtx_defrag_threshold  = true,
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
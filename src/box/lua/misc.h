@@ -65,7 +65,7 @@ lbox_index_normalize_position(lua_State *L, int idx, int space_id,
 
 /**
  * Pushes a table that contains information about the given read view to
- * the Lua stack. Used in the Tarantool EE source code.
+ * the Lua stack.
  */
 void
 lbox_push_read_view(struct lua_State *L, const struct read_view *rv);
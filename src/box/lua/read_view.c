@@ -0,0 +1,460 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "box/lua/read_view.h"
+
+#include <assert.h>
+#include <lua.h>
+#include <lauxlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "box/error.h"
+#include "box/index.h"
+#include "box/index_def.h"
+#include "box/lua/misc.h"
+#include "box/lua/tuple.h"
+#include "box/raw_read_view.h"
+#include "box/read_view.h"
+#include "box/tuple.h"
+#include "box/tuple_format.h"
+#include "diag.h"
+#include "fiber.h"
+#include "lua/utils.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "trivia/util.h"
+
+/**
+ * Read view handle pushed as userdata to Lua. The read view is closed
+ * when the handle is garbage collected.
+ */
+struct lbox_read_view {
+	/** Read view or NULL if it was closed. */
+	struct read_view *rv;
+};
+
+/**
+ * Iterator over a read view index. References the read view handle
+ * so that the read view isn't closed by GC while the iterator is alive.
+ */
+struct lbox_read_view_iterator {
+	/** Read view handle. */
+	struct lbox_read_view *handle;
+	/** Lua reference to the read view handle. */
+	int handle_ref;
+	/** Iterator key, the read view iterator points to it. */
+	char *key;
+	/** Read view iterator. */
+	struct index_read_view_iterator it;
+};
+
+static const char lbox_read_view_typename[] = "box.read_view";
+static const char lbox_read_view_iterator_typename[] = "box.read_view.iterator";
+
+static inline struct lbox_read_view *
+lbox_check_read_view(struct lua_State *L, int idx)
+{
+	return luaL_checkudata(L, idx, lbox_read_view_typename);
+}
+
+static inline struct lbox_read_view_iterator *
+lbox_check_read_view_iterator(struct lua_State *L, int idx)
+{
+	return luaL_checkudata(L, idx, lbox_read_view_iterator_typename);
+}
+
+/**
+ * Closes the read view and releases the tuple formats created for it
+ * by lbox_read_view_open().
+ */
+static void
+lbox_read_view_close_impl(struct lbox_read_view *handle)
+{
+	assert(handle->rv != NULL);
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, handle->rv) {
+		if (space_rv->format != NULL) {
+			tuple_format_unref(space_rv->format);
+			space_rv->format = NULL;
+		}
+	}
+	box_raw_read_view_delete(handle->rv);
+	handle->rv = NULL;
+}
+
+/**
+ * Returns the read view index passed as light userdata at the given stack
+ * index after the read view handle. Raises an error if the read view was
+ * closed.
+ */
+static struct index_read_view *
+lbox_read_view_check_index(struct lua_State *L, int idx)
+{
+	struct lbox_read_view *handle = lbox_check_read_view(L, idx);
+	if (handle->rv == NULL) {
+		diag_set(ClientError, ER_READ_VIEW_CLOSED);
+		luaT_error(L);
+	}
+	struct index_read_view *index_rv = lua_touserdata(L, idx + 1);
+	if (index_rv == NULL)
+		luaL_error(L, "Invalid read view index");
+	return index_rv;
+}
+
+/**
+ * Pushes a tuple created from read view data to the Lua stack.
+ * Returns 0 on success, -1 on error (diag is set).
+ */
+static int
+lbox_read_view_push_tuple(struct lua_State *L,
+			  struct index_read_view *index_rv,
+			  const struct read_view_tuple *result)
+{
+	struct tuple_format *format = index_rv->space->format;
+	assert(format != NULL);
+	struct tuple *tuple = tuple_new(format, result->data,
+					result->data + result->size);
+	if (tuple == NULL)
+		return -1;
+	luaT_pushtuple(L, tuple);
+	return 0;
+}
+
+/** Pushes a table describing a read view index to the Lua stack. */
+static void
+lbox_read_view_push_index(struct lua_State *L,
+			  struct index_read_view *index_rv)
+{
+	struct index_def *def = index_rv->def;
+	lua_newtable(L);
+	lua_pushinteger(L, def->iid);
+	lua_setfield(L, -2, "id");
+	lua_pushstring(L, def->name);
+	lua_setfield(L, -2, "name");
+	lua_pushinteger(L, def->space_id);
+	lua_setfield(L, -2, "space_id");
+	lua_pushstring(L, index_type_strs[def->type]);
+	lua_setfield(L, -2, "type");
+	lua_pushboolean(L, def->opts.is_unique);
+	lua_setfield(L, -2, "unique");
+	lua_pushlightuserdata(L, index_rv);
+	lua_setfield(L, -2, "ptr");
+}
+
+/**
+ * Opens a read view. Takes the read view name. Returns a table with
+ * the read view info (see lbox_push_read_view()), the read view handle
+ * stored in the 'handle' field, and an array of the read view spaces
+ * stored in the 'spaces' field. Each space is represented by a table
+ * with 'id', 'name', and 'indexes' fields.
+ */
+static int
+lbox_read_view_open(struct lua_State *L)
+{
+	const char *name = luaL_checkstring(L, 1);
+	struct lbox_read_view *handle = lua_newuserdata(L, sizeof(*handle));
+	handle->rv = NULL;
+	luaL_getmetatable(L, lbox_read_view_typename);
+	lua_setmetatable(L, -2);
+	struct read_view *rv = box_raw_read_view_new(name);
+	if (rv == NULL)
+		return luaT_error(L);
+	handle->rv = rv;
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, rv) {
+		struct tuple_format *format;
+		if (space_rv->format_data != NULL) {
+			format = runtime_tuple_format_new(
+				space_rv->format_data,
+				space_rv->format_data_len,
+				/*names_only=*/true);
+			if (format == NULL) {
+				lbox_read_view_close_impl(handle);
+				return luaT_error(L);
+			}
+		} else {
+			format = tuple_format_runtime;
+		}
+		tuple_format_ref(format);
+		space_rv->format = format;
+	}
+	lbox_push_read_view(L, rv);
+	lua_pushvalue(L, -2);
+	lua_setfield(L, -2, "handle");
+	lua_newtable(L);
+	int space_count = 0;
+	read_view_foreach_space(space_rv, rv) {
+		lua_newtable(L);
+		lua_pushinteger(L, space_rv->id);
+		lua_setfield(L, -2, "id");
+		lua_pushstring(L, space_rv->name);
+		lua_setfield(L, -2, "name");
+		lua_newtable(L);
+		int index_count = 0;
+		for (uint32_t i = 0; i <= space_rv->index_id_max; i++) {
+			struct index_read_view *index_rv =
+				space_rv->index_map[i];
+			if (index_rv == NULL)
+				continue;
+			lbox_read_view_push_index(L, index_rv);
+			lua_rawseti(L, -2, ++index_count);
+		}
+		lua_setfield(L, -2, "indexes");
+		lua_rawseti(L, -2, ++space_count);
+	}
+	lua_setfield(L, -2, "spaces");
+	return 1;
+}
+
+/** Closes a read view. Takes the read view handle. */
+static int
+lbox_read_view_close(struct lua_State *L)
+{
+	struct lbox_read_view *handle = lbox_check_read_view(L, 1);
+	if (handle->rv == NULL) {
+		diag_set(ClientError, ER_READ_VIEW_CLOSED);
+		return luaT_error(L);
+	}
+	lbox_read_view_close_impl(handle);
+	return 0;
+}
+
+static int
+lbox_read_view_gc(struct lua_State *L)
+{
+	struct lbox_read_view *handle = lbox_check_read_view(L, 1);
+	if (handle->rv != NULL)
+		lbox_read_view_close_impl(handle);
+	return 0;
+}
+
+/**
+ * Gets a tuple from a read view index. Takes the read view handle,
+ * the index pointer, and the key. Returns the tuple or nothing.
+ */
+static int
+lbox_read_view_get(struct lua_State *L)
+{
+	struct index_read_view *index_rv = lbox_read_view_check_index(L, 1);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 3, &key_len);
+	const char *data;
+	uint32_t size;
+	if (key == NULL ||
+	    box_raw_read_view_get(index_rv, key, key + key_len,
+				  &data, &size) != 0)
+		goto fail;
+	if (data == NULL) {
+		region_truncate(region, region_svp);
+		return 0;
+	}
+	struct read_view_tuple result = {
+		.needs_upgrade = false,
+		.data = data,
+		.size = size,
+	};
+	if (lbox_read_view_push_tuple(L, index_rv, &result) != 0)
+		goto fail;
+	region_truncate(region, region_svp);
+	return 1;
+fail:
+	region_truncate(region, region_svp);
+	return luaT_error(L);
+}
+
+/**
+ * Selects tuples from a read view index. Takes the read view handle,
+ * the index pointer, the iterator type, offset, limit, and the key.
+ * Returns an array of tuples.
+ */
+static int
+lbox_read_view_select(struct lua_State *L)
+{
+	struct index_read_view *index_rv = lbox_read_view_check_index(L, 1);
+	int type = luaL_checkinteger(L, 3);
+	uint32_t offset = luaL_checkinteger(L, 4);
+	uint32_t limit = luaL_checkinteger(L, 5);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 6, &key_len);
+	if (key == NULL)
+		goto fail;
+	box_raw_read_view_iterator_t it;
+	if (box_raw_read_view_iterator_create(&it, index_rv, type, key,
+					      key + key_len) != 0)
+		goto fail;
+	lua_newtable(L);
+	uint32_t count = 0;
+	while (count < limit) {
+		size_t svp = region_used(region);
+		const char *data;
+		uint32_t size;
+		if (box_raw_read_view_iterator_next(&it, &data, &size) != 0) {
+			box_raw_read_view_iterator_destroy(&it);
+			goto fail;
+		}
+		if (data == NULL)
+			break;
+		if (offset > 0) {
+			offset--;
+			region_truncate(region, svp);
+			continue;
+		}
+		struct read_view_tuple result = {
+			.needs_upgrade = false,
+			.data = data,
+			.size = size,
+		};
+		if (lbox_read_view_push_tuple(L, index_rv, &result) != 0) {
+			box_raw_read_view_iterator_destroy(&it);
+			goto fail;
+		}
+		lua_rawseti(L, -2, ++count);
+		region_truncate(region, svp);
+	}
+	box_raw_read_view_iterator_destroy(&it);
+	region_truncate(region, region_svp);
+	return 1;
+fail:
+	region_truncate(region, region_svp);
+	return luaT_error(L);
+}
+
+/**
+ * Creates an iterator over a read view index. Takes the read view handle,
+ * the index pointer, the iterator type, and the key. Returns the iterator.
+ */
+static int
+lbox_read_view_iterator(struct lua_State *L)
+{
+	struct index_read_view *index_rv = lbox_read_view_check_index(L, 1);
+	int type = luaL_checkinteger(L, 3);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t key_len;
+	const char *key = lbox_encode_tuple_on_gc(L, 4, &key_len);
+	if (key == NULL)
+		goto fail;
+	struct lbox_read_view_iterator *it = lua_newuserdata(L, sizeof(*it));
+	it->handle = NULL;
+	it->handle_ref = LUA_NOREF;
+	it->key = xmalloc(key_len);
+	memcpy(it->key, key, key_len);
+	luaL_getmetatable(L, lbox_read_view_iterator_typename);
+	lua_setmetatable(L, -2);
+	if (box_raw_read_view_iterator_create(
+			(box_raw_read_view_iterator_t *)&it->it, index_rv,
+			type, it->key, it->key + key_len) != 0)
+		goto fail;
+	it->handle = lbox_check_read_view(L, 1);
+	lua_pushvalue(L, 1);
+	it->handle_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	region_truncate(region, region_svp);
+	return 1;
+fail:
+	region_truncate(region, region_svp);
+	return luaT_error(L);
+}
+
+/**
+ * Fetches the next tuple from a read view iterator. Returns the tuple or
+ * nothing if the iterator is exhausted.
+ */
+static int
+lbox_read_view_iterator_next(struct lua_State *L)
+{
+	struct lbox_read_view_iterator *it =
+		lbox_check_read_view_iterator(L, 1);
+	if (it->handle == NULL)
+		return 0;
+	if (it->handle->rv == NULL) {
+		diag_set(ClientError, ER_READ_VIEW_CLOSED);
+		return luaT_error(L);
+	}
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct read_view_tuple result;
+	if (index_read_view_iterator_next_raw(&it->it, &result) != 0)
+		goto fail;
+	if (result.data == NULL) {
+		region_truncate(region, region_svp);
+		return 0;
+	}
+	if (lbox_read_view_push_tuple(L, it->it.base.index, &result) != 0)
+		goto fail;
+	region_truncate(region, region_svp);
+	return 1;
+fail:
+	region_truncate(region, region_svp);
+	return luaT_error(L);
+}
+
+static int
+lbox_read_view_iterator_gc(struct lua_State *L)
+{
+	struct lbox_read_view_iterator *it =
+		lbox_check_read_view_iterator(L, 1);
+	if (it->handle != NULL) {
+		if (it->handle->rv != NULL)
+			index_read_view_iterator_destroy(&it->it);
+		luaL_unref(L, LUA_REGISTRYINDEX, it->handle_ref);
+		it->handle = NULL;
+	}
+	free(it->key);
+	it->key = NULL;
+	return 0;
+}
+
+static int
+lbox_read_view_tostring(struct lua_State *L)
+{
+	lua_pushstring(L, lbox_read_view_typename);
+	return 1;
+}
+
+static int
+lbox_read_view_iterator_tostring(struct lua_State *L)
+{
+	lua_pushstring(L, lbox_read_view_iterator_typename);
+	return 1;
+}
+
+void
+box_lua_read_view_init(struct lua_State *L)
+{
+	static const struct luaL_Reg lbox_read_view_meta[] = {
+		{"__gc", lbox_read_view_gc},
+		{"__tostring", lbox_read_view_tostring},
+		{NULL, NULL},
+	};
+	luaL_register_type(L, lbox_read_view_typename, lbox_read_view_meta);
+
+	static const struct luaL_Reg lbox_read_view_iterator_meta[] = {
+		{"__gc", lbox_read_view_iterator_gc},
+		{"__tostring", lbox_read_view_iterator_tostring},
+		{NULL, NULL},
+	};
+	luaL_register_type(L, lbox_read_view_iterator_typename,
+			   lbox_read_view_iterator_meta);
+
+	static const struct luaL_Reg lbox_read_view_lib[] = {
+		{"open", lbox_read_view_open},
+		{"close", lbox_read_view_close},
+		{"get", lbox_read_view_get},
+		{"select", lbox_read_view_select},
+		{"iterator", lbox_read_view_iterator},
+		{"iterator_next", lbox_read_view_iterator_next},
+		{NULL, NULL},
+	};
+	luaL_findtable(L, LUA_GLOBALSINDEX, "box.internal.read_view", 0);
+	luaL_setfuncs(L, lbox_read_view_lib, 0);
+	lua_pop(L, 1);
+}
@@ -5,20 +5,16 @@
  */
 #pragma once
 
-#include "trivia/config.h"
-
-#if defined(ENABLE_READ_VIEW)
-#include "lua/read_view_impl.h"
-#else /* !defined(ENABLE_READ_VIEW) */
-
-#define READ_VIEW_BOX_LUA_MODULES
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
 
 struct lua_State;
 
-static inline void
-box_lua_read_view_init(struct lua_State *L)
-{
-	(void)L;
-}
+/** Registers the box.internal.read_view functions used by box.read_view. */
+void
+box_lua_read_view_init(struct lua_State *L);
 
-#endif /* !defined(ENABLE_READ_VIEW) */
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
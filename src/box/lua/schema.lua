@@ -101,6 +101,18 @@ ffi.cdef[[
     box_txn_savepoint_t *
     box_txn_savepoint();
 
+    typedef struct vy_bulk_load box_bulk_load_t;
+
+    box_bulk_load_t *
+    box_bulk_load_new(uint32_t space_id, size_t memory);
+    int
+    box_bulk_load_add(box_bulk_load_t *bulk_load, const char *tuple,
+                      const char *tuple_end);
+    int
+    box_bulk_load_commit(box_bulk_load_t *bulk_load);
+    void
+    box_bulk_load_delete(box_bulk_load_t *bulk_load);
+
     struct port {
         const struct port_vtab *vtab;
         char pad[74];
@@ -1561,6 +1573,10 @@ local index_options = {
     bloom_fpr = 'number',
     func = 'number, string',
     hint = 'boolean',
+    layout = 'string',
+    hash_func = 'string',
+    hint_parts = 'number',
+    key_prefix = 'boolean',
 }
 
 local function jsonpaths_from_idx_parts(parts)
@@ -1703,6 +1719,10 @@ box.schema.index.create = atomic_wrapper(function(space_id, name, options)
             bloom_fpr = options.bloom_fpr,
             func = options.func,
             hint = options.hint,
+            layout = options.layout,
+            hash_func = options.hash_func,
+            hint_parts = options.hint_parts,
+            key_prefix = options.key_prefix,
     }
     local field_type_aliases = {
         num = 'unsigned'; -- Deprecated since 1.7.2
@@ -2809,6 +2829,66 @@ space_mt.truncate = function(space)
     check_space_arg(space, 'truncate', 2)
     return internal.truncate(space.id)
 end
+
+local bulk_load_mt = {}
+bulk_load_mt.__index = bulk_load_mt
+
+local function check_bulk_load_arg(bulk_load, method, level)
+    if type(bulk_load) ~= 'table' or
+       getmetatable(bulk_load) ~= bulk_load_mt then
+        local fmt = 'Use bulk_load:%s(...) instead of bulk_load.%s(...)'
+        box.error(box.error.ILLEGAL_PARAMS, string.format(fmt, method, method),
+                  level + 1)
+    end
+    if bulk_load.cdata == nil then
+        box.error(box.error.ILLEGAL_PARAMS, 'bulk load is closed', level + 1)
+    end
+end
+
+bulk_load_mt.add = function(bulk_load, tuple)
+    check_bulk_load_arg(bulk_load, 'add', 2)
+    local ibuf = cord_ibuf_take()
+    local data, data_end = tuple_encode(ibuf, tuple, 2)
+    local nok = builtin.box_bulk_load_add(bulk_load.cdata, data,
+                                          data_end) ~= 0
+    cord_ibuf_put(ibuf)
+    if nok then
+        box.error(box.error.last(), 2)
+    end
+end
+
+bulk_load_mt.commit = function(bulk_load)
+    check_bulk_load_arg(bulk_load, 'commit', 2)
+    local nok = builtin.box_bulk_load_commit(bulk_load.cdata) ~= 0
+    bulk_load:close()
+    if nok then
+        box.error(box.error.last(), 2)
+    end
+end
+
+bulk_load_mt.close = function(bulk_load)
+    if bulk_load.cdata ~= nil then
+        builtin.box_bulk_load_delete(ffi.gc(bulk_load.cdata, nil))
+        bulk_load.cdata = nil
+    end
+end
+
+local bulk_load_options = {
+    memory = 'number',
+}
+
+space_mt.bulk_load = function(space, opts)
+    check_space_arg(space, 'bulk_load', 2)
+    opts = opts or {}
+    check_param_table(opts, bulk_load_options, 2)
+    local cdata = builtin.box_bulk_load_new(space.id, opts.memory or 0)
+    if cdata == nil then
+        box.error(box.error.last(), 2)
+    end
+    return setmetatable({
+        cdata = ffi.gc(cdata, builtin.box_bulk_load_delete),
+    }, bulk_load_mt)
+end
 space_mt.format = function(space, format)
     check_space_arg(space, 'format', 2)
     return box.schema.space.format(space.id, format)
@@ -4056,10 +4136,15 @@ function read_view_methods:info()
 end
 
 --
--- Function stub. Implemented in Tarantool EE.
+-- Closes a read view opened with box.read_view.open(). Read views that
+-- were opened by the system or by C modules can't be closed from Lua.
 --
 function box.internal.read_view_close(self, level)
-    box.error(box.error.READ_VIEW_BUSY, level + 1)
+    local handle = rawget(self, 'handle')
+    if handle == nil then
+        box.error(box.error.READ_VIEW_BUSY, level + 1)
+    end
+    internal.read_view.close(handle)
 end
 
 --
@@ -4102,11 +4187,117 @@ local read_view_mt = {
 
 box.read_view = {}
 
+local read_view_index_methods = {}
+
+--
+-- Returns the read view handle and the index read view pointer used by
+-- the read view functions implemented in C. They are stored in the index
+-- object metatable so that they aren't shown to the user.
+--
+local function read_view_index_private(index)
+    local mt = getmetatable(index)
+    return mt.handle, mt.ptr
+end
+
+function read_view_index_methods:get(key)
+    check_index_arg(self, 'get', 2)
+    local handle, ptr = read_view_index_private(self)
+    return internal.read_view.get(handle, ptr, keify(key))
+end
+
+function read_view_index_methods:select(key, opts)
+    check_index_arg(self, 'select', 2)
+    key = keify(key)
+    local iterator, offset, limit, _, after, fetch_pos =
+        check_select_opts(opts, #key == 0, 2)
+    if after ~= nil or fetch_pos then
+        box.error(box.error.UNSUPPORTED, 'Read view', 'pagination', 2)
+    end
+    local handle, ptr = read_view_index_private(self)
+    return internal.read_view.select(handle, ptr, iterator, offset, limit,
+                                     key)
+end
+
+local read_view_iterator_gen = function(param, state) -- luacheck: no unused args
+    local tuple = internal.read_view.iterator_next(state)
+    if tuple ~= nil then
+        return state, tuple -- new state, value
+    else
+        return nil
+    end
+end
+
+function read_view_index_methods:pairs(key, opts)
+    check_index_arg(self, 'pairs', 2)
+    key = keify(key)
+    local iterator, after = check_pairs_opts(opts, #key == 0, 2)
+    if after ~= nil then
+        box.error(box.error.UNSUPPORTED, 'Read view', 'pagination', 2)
+    end
+    local handle, ptr = read_view_index_private(self)
+    local state = internal.read_view.iterator(handle, ptr, iterator, key)
+    return fun.wrap(read_view_iterator_gen, nil, state)
+end
+
+local read_view_space_methods = {}
+
+function read_view_space_methods:get(key)
+    check_space_arg(self, 'get', 2)
+    return check_primary_index(self, 2):get(key)
+end
+
+function read_view_space_methods:select(key, opts)
+    check_space_arg(self, 'select', 2)
+    return check_primary_index(self, 2):select(key, opts)
+end
+
+function read_view_space_methods:pairs(key, opts)
+    check_space_arg(self, 'pairs', 2)
+    return check_primary_index(self, 2):pairs(key, opts)
+end
+
+local read_view_space_mt = {
+    __index = read_view_space_methods,
+}
+
 --
--- Function stub. Implemented in Tarantool EE.
+-- Opens a read view of all memtx spaces the current user has read access
+-- to. Changes done to the database after the read view was opened aren't
+-- visible to it. Spaces are accessible by id and name via the 'space'
+-- field, and indexes via the space 'index' field, like in box.space.
 --
-function box.read_view.open()
-    box.error(box.error.UNSUPPORTED, "Community edition", "read view", 2)
+-- Options:
+--  - 'name' - read view name, shown in box.read_view.list().
+--
+function box.read_view.open(opts)
+    check_param_table(opts, {name = 'string'}, 2)
+    local name = opts ~= nil and opts.name or 'unknown'
+    local rv = internal.read_view.open(name)
+    local spaces = {}
+    for _, s in ipairs(rv.spaces) do
+        local space = setmetatable({id = s.id, name = s.name, index = {}},
+                                   read_view_space_mt)
+        for _, i in ipairs(s.indexes) do
+            local index = setmetatable({
+                id = i.id,
+                name = i.name,
+                space_id = i.space_id,
+                type = i.type,
+                unique = i.unique,
+            }, {
+                __index = read_view_index_methods,
+                handle = rv.handle,
+                ptr = i.ptr,
+            })
+            space.index[i.id] = index
+            space.index[i.name] = index
+        end
+        spaces[s.id] = space
+        spaces[s.name] = space
+    end
+    rv.spaces = nil
+    rv.space = spaces
+    return box.internal.read_view_register(rv)
 end
 
 --
@@ -4121,8 +4312,6 @@ local read_view_registry = setmetatable({}, {__mode = 'v'})
 -- Sets a metatable for a new read view object and adds it to the registry so
 -- that it can be returned by box.read_view_list().
 --
--- Used in the Tarantool EE source code.
---
 function box.internal.read_view_register(rv)
     assert(rv.id ~= nil)
     assert(read_view_registry[rv.id] == nil)
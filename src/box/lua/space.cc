@@ -568,9 +568,32 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 		if (space_is_memtx(space) && index_def->type == TREE) {
 			lua_pushboolean(L, index_opts->hint == INDEX_HINT_ON);
 			lua_setfield(L, -2, "hint");
+			lua_pushnumber(L, index_opts->hint_parts);
+			lua_setfield(L, -2, "hint_parts");
+			lua_pushboolean(L, index_opts->key_prefix);
+			lua_setfield(L, -2, "key_prefix");
 		} else {
 			lua_pushnil(L);
 			lua_setfield(L, -2, "hint");
+			lua_pushnil(L);
+			lua_setfield(L, -2, "hint_parts");
+			lua_pushnil(L);
+			lua_setfield(L, -2, "key_prefix");
+		}
+		if (space_is_memtx(space) && index_def->type == HASH) {
+			lua_pushstring(L, index_opts->layout ==
+					  INDEX_HASH_LAYOUT_SWISS ?
+					  "swiss" : "chained");
+			lua_setfield(L, -2, "layout");
+			lua_pushstring(L, index_opts->hash_func ==
+					  INDEX_HASH_FUNC_XXH3 ?
+					  "xxh3" : "murmur");
+			lua_setfield(L, -2, "hash_func");
+		} else {
+			lua_pushnil(L);
+			lua_setfield(L, -2, "layout");
+			lua_pushnil(L);
+			lua_setfield(L, -2, "hash_func");
 		}
 
 		if (index_opts->func_id > 0) {
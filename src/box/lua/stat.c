@@ -44,6 +44,7 @@
 #include "box/vinyl.h"
 #include "box/sql.h"
 #include "box/memtx_engine.h"
+#include "coio_task.h"
 #include "info/info.h"
 #include "lua/info.h"
 #include "lua/utils.h"
@@ -326,6 +327,27 @@ lbox_stat_sql(struct lua_State *L)
 	return 1;
 }
 
+static int
+lbox_stat_coio(struct lua_State *L)
+{
+	struct coio_lane_stat stat[coio_lane_MAX];
+	coio_pool_stat(stat);
+	struct info_handler info;
+	luaT_info_handler_create(&info, L);
+	info_begin(&info);
+	for (int lane = 0; lane < coio_lane_MAX; lane++) {
+		info_table_begin(&info, coio_lane_strs[lane]);
+		info_append_int(&info, "count", stat[lane].count);
+		info_append_double(&info, "wait_total", stat[lane].wait_total);
+		info_append_double(&info, "wait_max", stat[lane].wait_max);
+		info_append_double(&info, "exec_total", stat[lane].exec_total);
+		info_append_double(&info, "exec_max", stat[lane].exec_max);
+		info_table_end(&info);
+	}
+	info_end(&info);
+	return 1;
+}
+
 static const struct luaL_Reg lbox_stat_meta [] = {
 	{"__index", lbox_stat_index},
 	{"__call",  lbox_stat_call},
@@ -367,6 +389,7 @@ box_lua_stat_init(struct lua_State *L)
 		{"vinyl", lbox_stat_vinyl},
 		{"reset", lbox_stat_reset},
 		{"sql", lbox_stat_sql},
+		{"coio", lbox_stat_coio},
 		{NULL, NULL}
 	};
 
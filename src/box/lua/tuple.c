@@ -693,6 +693,116 @@ lbox_tuple_field_by_path(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * Type of a tuple field decoded by the FFI fast path of tuple indexing,
+ * see tuple_field_ffi(). Keep in sync with tuple.lua.
+ */
+enum tuple_field_ffi_type {
+	/** The field doesn't exist. */
+	TUPLE_FIELD_FFI_NONE = 0,
+	/** MsgPack nil. */
+	TUPLE_FIELD_FFI_NIL = 1,
+	/** Boolean stored in tuple_field_ffi::num. */
+	TUPLE_FIELD_FFI_BOOL = 2,
+	/** Number stored in tuple_field_ffi::num. */
+	TUPLE_FIELD_FFI_NUMBER = 3,
+	/** String stored in tuple_field_ffi::data and tuple_field_ffi::len. */
+	TUPLE_FIELD_FFI_STRING = 4,
+	/** Any other value, tuple_field_ffi::data points to its MsgPack. */
+	TUPLE_FIELD_FFI_OTHER = 5,
+};
+
+/**
+ * Tuple field decoded by the FFI fast path of tuple indexing.
+ * Keep in sync with tuple.lua.
+ */
+struct tuple_field_ffi {
+	/** Value of a number or boolean field. */
+	double num;
+	/** Data of a string field or MsgPack of a field of other type. */
+	const char *data;
+	/** Length of a string field. */
+	uint32_t len;
+};
+
+/**
+ * Decode a scalar tuple field so that it can be converted to a Lua value
+ * without calling the Lua C API. Integers that can't be represented as
+ * a Lua number without losing precision aren't decoded, like other
+ * non-scalar values, see luaL_pushuint64().
+ */
+static int
+tuple_field_ffi_decode(const char *field, struct tuple_field_ffi *res)
+{
+	if (field == NULL)
+		return TUPLE_FIELD_FFI_NONE;
+	const char *data = field;
+	switch (mp_typeof(*data)) {
+	case MP_NIL:
+		return TUPLE_FIELD_FFI_NIL;
+	case MP_BOOL:
+		res->num = mp_decode_bool(&data);
+		return TUPLE_FIELD_FFI_BOOL;
+	case MP_UINT: {
+		uint64_t val = mp_decode_uint(&data);
+		if (val > DBL_INT_MAX)
+			break;
+		res->num = val;
+		return TUPLE_FIELD_FFI_NUMBER;
+	}
+	case MP_INT: {
+		int64_t val = mp_decode_int(&data);
+		if (val < DBL_INT_MIN || val > DBL_INT_MAX)
+			break;
+		res->num = val;
+		return TUPLE_FIELD_FFI_NUMBER;
+	}
+	case MP_FLOAT:
+		res->num = mp_decode_float(&data);
+		return TUPLE_FIELD_FFI_NUMBER;
+	case MP_DOUBLE:
+		res->num = mp_decode_double(&data);
+		return TUPLE_FIELD_FFI_NUMBER;
+	case MP_STR:
+		res->data = mp_decode_str(&data, &res->len);
+		return TUPLE_FIELD_FFI_STRING;
+	default:
+		break;
+	}
+	res->data = field;
+	return TUPLE_FIELD_FFI_OTHER;
+}
+
+/**
+ * Called from Lua via FFI to get a tuple field by a zero-based number.
+ * Decodes the field to @a res and returns its type, see
+ * enum tuple_field_ffi_type.
+ */
+int
+tuple_field_ffi(struct tuple *tuple, uint32_t fieldno,
+		struct tuple_field_ffi *res)
+{
+	return tuple_field_ffi_decode(tuple_field(tuple, fieldno), res);
+}
+
+/**
+ * Called from Lua via FFI to get a tuple field by a name or a JSON path.
+ * Decodes the field to @a res and returns its type, see
+ * enum tuple_field_ffi_type.
+ */
+int
+tuple_field_by_path_ffi(struct tuple *tuple, const char *path,
+			uint32_t path_len, struct tuple_field_ffi *res)
+{
+	if (path_len == 0)
+		return TUPLE_FIELD_FFI_NONE;
+	const char *field = tuple_field_raw_by_full_path(
+		tuple_format(tuple), tuple_data(tuple), tuple_field_map(tuple),
+		path, path_len, field_name_hash(path, path_len),
+		TUPLE_INDEX_BASE);
+	return tuple_field_ffi_decode(field, res);
+}
+
 static int
 lbox_tuple_to_string(struct lua_State *L)
 {
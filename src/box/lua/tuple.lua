@@ -62,6 +62,20 @@ box_tuple_update(box_tuple_t *tuple, const char *expr, const char *expr_end);
 
 box_tuple_t *
 box_tuple_upsert(box_tuple_t *tuple, const char *expr, const char *expr_end);
+
+struct tuple_field_ffi {
+    double num;
+    const char *data;
+    uint32_t len;
+};
+
+int
+tuple_field_ffi(box_tuple_t *tuple, uint32_t fieldno,
+                struct tuple_field_ffi *res);
+
+int
+tuple_field_by_path_ffi(box_tuple_t *tuple, const char *path,
+                        uint32_t path_len, struct tuple_field_ffi *res);
 ]]
 
 local builtin = ffi.C
@@ -314,11 +328,6 @@ end
 
 msgpackffi.on_encode(const_tuple_ref_t, tuple_to_msgpack)
 
-local function tuple_field_by_path(tuple, path)
-    tuple_check(tuple, "tuple['field_name']");
-    return internal.tuple.tuple_field_by_path(tuple, path)
-end
-
 local methods = {
     ["next"]        = tuple_next;
     ["ipairs"]      = tuple_ipairs;
@@ -344,13 +353,53 @@ end
 
 methods["__serialize"] = tuple_totable -- encode hook for msgpack/yaml/json
 
+-- Field types returned by tuple_field_ffi() and tuple_field_by_path_ffi(),
+-- see enum tuple_field_ffi_type.
+local TUPLE_FIELD_FFI_NONE = 0
+local TUPLE_FIELD_FFI_NIL = 1
+local TUPLE_FIELD_FFI_BOOL = 2
+local TUPLE_FIELD_FFI_NUMBER = 3
+local TUPLE_FIELD_FFI_STRING = 4
+
+-- Scalar tuple fields are decoded in C to this buffer and then read from
+-- it without creating intermediate Lua objects, which is fast and can be
+-- compiled by LuaJIT. The buffer is shared: the decoding never yields.
+local tuple_field_ffi = ffi.new('struct tuple_field_ffi')
+
 local tuple_field = function(tuple, field_n)
-    local field = builtin.box_tuple_field(tuple, field_n - 1)
-    if field == nil then
+    local field_type = builtin.tuple_field_ffi(tuple, field_n - 1,
+                                               tuple_field_ffi)
+    if field_type == TUPLE_FIELD_FFI_NUMBER then
+        return tuple_field_ffi.num
+    elseif field_type == TUPLE_FIELD_FFI_STRING then
+        return ffi.string(tuple_field_ffi.data, tuple_field_ffi.len)
+    elseif field_type == TUPLE_FIELD_FFI_NONE then
         return nil
+    elseif field_type == TUPLE_FIELD_FFI_NIL then
+        return msgpackffi.NULL
+    elseif field_type == TUPLE_FIELD_FFI_BOOL then
+        return tuple_field_ffi.num ~= 0
     end
     -- Use () to shrink stack to the first return value
-    return (msgpackffi.decode_unchecked(field))
+    return (msgpackffi.decode_unchecked(tuple_field_ffi.data))
+end
+
+-- Returns a tuple field by a name or a JSON path or nil if the field
+-- doesn't exist or is nil.
+local tuple_field_by_path = function(tuple, path)
+    local field_type = builtin.tuple_field_by_path_ffi(tuple, path, #path,
+                                                       tuple_field_ffi)
+    if field_type == TUPLE_FIELD_FFI_NUMBER then
+        return tuple_field_ffi.num
+    elseif field_type == TUPLE_FIELD_FFI_STRING then
+        return ffi.string(tuple_field_ffi.data, tuple_field_ffi.len)
+    elseif field_type == TUPLE_FIELD_FFI_NONE or
+           field_type == TUPLE_FIELD_FFI_NIL then
+        return nil
+    elseif field_type == TUPLE_FIELD_FFI_BOOL then
+        return tuple_field_ffi.num ~= 0
+    end
+    return internal.tuple.tuple_field_by_path(tuple, path)
 end
 
 ffi.metatype(tuple_t, {
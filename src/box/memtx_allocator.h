@@ -285,6 +285,16 @@ class MemtxAllocator {
 		::free(rv);
 	}
 
+	/** Returns true if there's at least one open tuple read view. */
+	static bool has_read_view()
+	{
+		for (int type = 0; type < memtx_tuple_rv_type_MAX; type++) {
+			if (!rlist_empty(&read_views[type]))
+				return true;
+		}
+		return false;
+	}
+
 	/**
 	 * Allocate a tuple of the given size.
 	 */
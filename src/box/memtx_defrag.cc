@@ -0,0 +1,438 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "memtx_defrag.h"
+
+#include <string.h>
+
+#include <small/slab_arena.h>
+
+#include "allocator.h"
+#include "clock.h"
+#include "diag.h"
+#include "fiber.h"
+#include "index.h"
+#include "info/info.h"
+#include "memtx_allocator.h"
+#include "memtx_engine.h"
+#include "say.h"
+#include "space.h"
+#include "space_cache.h"
+#include "trivia/util.h"
+#include "tuple.h"
+
+enum {
+	/**
+	 * Number of tuples processed between two checks of the time
+	 * spent without yielding.
+	 */
+	MEMTX_DEFRAG_BATCH_SIZE = 64,
+};
+
+/** Max time the defragmenter may run without yielding, in seconds. */
+static const double MEMTX_DEFRAG_STEP_TIME = 0.001;
+
+/** Time between two defragmentation passes, in seconds. */
+static const double MEMTX_DEFRAG_PASS_INTERVAL = 1.0;
+
+/** Function applied to each tuple of a space during a pass. */
+typedef void
+(*memtx_defrag_tuple_f)(struct memtx_engine *memtx, struct space *space,
+			struct tuple *tuple);
+
+/**
+ * Returns the index of the arena slab the tuple is allocated from or -1
+ * if it isn't allocated from the preallocated arena area (for example,
+ * large tuples are allocated with malloc).
+ */
+static inline int64_t
+memtx_defrag_tuple_slab(struct memtx_engine *memtx, struct tuple *tuple)
+{
+	struct slab_arena *arena = &memtx->arena;
+	const char *begin = (const char *)arena->arena;
+	const char *ptr = (const char *)container_of(tuple, struct memtx_tuple,
+						     base);
+	if (begin == NULL || ptr < begin || ptr >= begin + arena->prealloc)
+		return -1;
+	int64_t slab = (ptr - begin) / arena->slab_size;
+	return slab < memtx->defrag.slab_count ? slab : -1;
+}
+
+/** Returns the size of memory actually allocated for the tuple. */
+static inline size_t
+memtx_defrag_tuple_size(struct tuple *tuple)
+{
+	struct memtx_tuple *memtx_tuple = container_of(tuple, struct memtx_tuple,
+						       base);
+	size_t size = tuple_size(tuple) + offsetof(struct memtx_tuple, base);
+	struct small_alloc_info info;
+	SmallAlloc::get_alloc_info(memtx_tuple, size, &info);
+	return info.real_size;
+}
+
+/** Returns true if the arena slab is sparse and should be freed. */
+static inline bool
+memtx_defrag_slab_is_sparse(struct memtx_engine *memtx, int64_t slab)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	if (slab < 0)
+		return false;
+	size_t used = defrag->slab_used[slab];
+	return used > 0 && used < defrag->threshold * memtx->arena.slab_size;
+}
+
+/**
+ * Returns true if defragmentation can't be done right now. We don't
+ * relocate tuples while there are open read views, because the old
+ * tuple copies would be pinned by them anyway.
+ */
+static bool
+memtx_defrag_is_paused(struct memtx_engine *memtx)
+{
+	return memtx->defrag.threshold == 0 || memtx->state != MEMTX_OK ||
+	       MemtxAllocator<SmallAlloc>::has_read_view();
+}
+
+/** Returns true if tuples of the space may be relocated. */
+static bool
+memtx_defrag_space_is_eligible(struct space *space)
+{
+	if (!space_is_memtx(space) || space->index_count == 0)
+		return false;
+	/*
+	 * Building a new index or checking a new format tracks concurrent
+	 * changes with an internal on_replace trigger, which wouldn't see
+	 * the relocation.
+	 */
+	if (!rlist_empty(&space->on_replace))
+		return false;
+	if (space->upgrade != NULL || space->format->is_compressed)
+		return false;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		/* Functional keys depend on the tuple identity. */
+		if (space->index[i]->def->key_def->for_func_index)
+			return false;
+	}
+	return true;
+}
+
+/** Accounts the tuple in the arena slab usage. */
+static void
+memtx_defrag_scan_tuple(struct memtx_engine *memtx, struct space *space,
+			struct tuple *tuple)
+{
+	(void)space;
+	int64_t slab = memtx_defrag_tuple_slab(memtx, tuple);
+	if (slab >= 0)
+		memtx->defrag.slab_used[slab] += memtx_defrag_tuple_size(tuple);
+}
+
+/**
+ * Replaces the tuple with its copy in all indexes of the space if the
+ * tuple resides in a sparse slab and the copy is allocated from a better
+ * place. The tuple must be referenced by the caller.
+ */
+static void
+memtx_defrag_relocate_tuple(struct memtx_engine *memtx, struct space *space,
+			    struct tuple *old_tuple)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	/*
+	 * Only the space and the caller may reference the tuple, and it
+	 * must not be used by the transaction manager.
+	 */
+	if (old_tuple->local_refs != 2 ||
+	    tuple_has_flag(old_tuple, TUPLE_HAS_UPLOADED_REFS) ||
+	    tuple_has_flag(old_tuple, TUPLE_IS_DIRTY))
+		return;
+	int64_t old_slab = memtx_defrag_tuple_slab(memtx, old_tuple);
+	if (!memtx_defrag_slab_is_sparse(memtx, old_slab))
+		return;
+	if (memtx_index_extent_reserve(memtx,
+				       RESERVE_EXTENTS_BEFORE_REPLACE) != 0)
+		goto fail;
+	struct tuple *new_tuple;
+	new_tuple = memtx_tuple_new_raw(space->format, tuple_data(old_tuple),
+					tuple_data(old_tuple) +
+					tuple_bsize(old_tuple), false);
+	if (new_tuple == NULL)
+		goto fail;
+	tuple_ref(new_tuple);
+	int64_t new_slab;
+	new_slab = memtx_defrag_tuple_slab(memtx, new_tuple);
+	/*
+	 * The allocator prefers slabs with lower addresses so moving tuples
+	 * to lower slabs packs them at the beginning of the arena. A tuple
+	 * may move to a higher slab only if it isn't sparse so that tuples
+	 * don't bounce between sparse slabs.
+	 */
+	if (new_slab < 0 || new_slab == old_slab ||
+	    (new_slab > old_slab &&
+	     memtx_defrag_slab_is_sparse(memtx, new_slab))) {
+		/* The copy is no better placed than the original. */
+		tuple_unref(new_tuple);
+		return;
+	}
+	uint32_t i;
+	for (i = 0; i < space->index_count; i++) {
+		struct tuple *unused;
+		if (index_replace(space->index[i], old_tuple, new_tuple,
+				  i == 0 ? DUP_REPLACE : DUP_INSERT,
+				  &unused, &unused) != 0)
+			goto rollback;
+	}
+	size_t size;
+	size = memtx_defrag_tuple_size(old_tuple);
+	defrag->slab_used[old_slab] -= MIN(size, defrag->slab_used[old_slab]);
+	defrag->slab_used[new_slab] += size;
+	defrag->relocated++;
+	defrag->relocated_bytes += size;
+	/* The new tuple inherits the reference held by the space. */
+	tuple_unref(old_tuple);
+	return;
+rollback:
+	for (; i > 0; i--) {
+		struct tuple *unused;
+		struct index *index = space->index[i - 1];
+		/* Rollback must not fail. */
+		if (index_replace(index, new_tuple, old_tuple,
+				  DUP_INSERT, &unused, &unused) != 0) {
+			diag_log();
+			unreachable();
+			panic("failed to rollback change");
+		}
+	}
+	tuple_unref(new_tuple);
+fail:
+	/* Not a reason to stop: the tuple will be retried on the next pass. */
+	diag_clear(diag_get());
+}
+
+/**
+ * Yields if the defragmenter has been running for longer than
+ * MEMTX_DEFRAG_STEP_TIME. Returns false if the pass must be aborted.
+ */
+static bool
+memtx_defrag_throttle(struct memtx_engine *memtx, double *step_start)
+{
+	if (clock_monotonic() - *step_start < MEMTX_DEFRAG_STEP_TIME)
+		return true;
+	fiber_sleep(0);
+	*step_start = clock_monotonic();
+	return !fiber_is_cancelled() && !memtx_defrag_is_paused(memtx);
+}
+
+/**
+ * Applies the function to each tuple of the space, yielding periodically.
+ * Tuples are collected in batches and referenced so that the function
+ * is called for a tuple when the iterator has moved past it and doesn't
+ * pin it anymore. Returns false if the pass must be aborted.
+ */
+static bool
+memtx_defrag_foreach_tuple(struct memtx_engine *memtx, uint32_t space_id,
+			   memtx_defrag_tuple_f func, double *step_start)
+{
+	struct space *space = space_by_id(space_id);
+	if (space == NULL || !memtx_defrag_space_is_eligible(space))
+		return true;
+	struct index *pk = space->index[0];
+	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	if (it == NULL) {
+		diag_clear(diag_get());
+		return true;
+	}
+	struct tuple *batch[MEMTX_DEFRAG_BATCH_SIZE];
+	int count = 0;
+	bool is_eof = false;
+	bool is_aborted = false;
+	while (!is_eof && !is_aborted) {
+		while (count < MEMTX_DEFRAG_BATCH_SIZE) {
+			struct tuple *tuple;
+			if (iterator_next_internal(it, &tuple) != 0) {
+				diag_clear(diag_get());
+				tuple = NULL;
+			}
+			if (tuple == NULL) {
+				is_eof = true;
+				break;
+			}
+			tuple_ref(tuple);
+			batch[count++] = tuple;
+		}
+		/* The iterator may pin the last tuple, keep it for later. */
+		int done = is_eof ? count : count - 1;
+		/* The space may have been altered while we yielded. */
+		space = space_by_id(space_id);
+		bool is_valid = space != NULL && space->index_count > 0 &&
+				space->index[0] == pk &&
+				memtx_defrag_space_is_eligible(space);
+		for (int i = 0; i < done; i++) {
+			if (is_valid)
+				func(memtx, space, batch[i]);
+			tuple_unref(batch[i]);
+		}
+		if (!is_eof) {
+			batch[0] = batch[done];
+			count = 1;
+		} else {
+			count = 0;
+		}
+		if (!is_valid)
+			break;
+		is_aborted = !memtx_defrag_throttle(memtx, step_start);
+	}
+	for (int i = 0; i < count; i++)
+		tuple_unref(batch[i]);
+	iterator_delete(it);
+	return !is_aborted;
+}
+
+/** Ids of spaces processed by a defragmentation pass. */
+struct memtx_defrag_space_ids {
+	/** Array of space ids. */
+	uint32_t *ids;
+	/** Number of entries in the array. */
+	uint32_t count;
+	/** Number of allocated entries. */
+	uint32_t capacity;
+};
+
+/** Appends the id of the space to memtx_defrag_space_ids. */
+static int
+memtx_defrag_collect_space_f(struct space *space, void *arg)
+{
+	struct memtx_defrag_space_ids *spaces =
+		(struct memtx_defrag_space_ids *)arg;
+	if (!memtx_defrag_space_is_eligible(space))
+		return 0;
+	if (spaces->count == spaces->capacity) {
+		spaces->capacity = MAX(spaces->capacity * 2, 16);
+		spaces->ids = (uint32_t *)xrealloc(spaces->ids,
+						   spaces->capacity *
+						   sizeof(*spaces->ids));
+	}
+	spaces->ids[spaces->count++] = space_id(space);
+	return 0;
+}
+
+/**
+ * Does a defragmentation pass: counts the memory used by tuples in each
+ * arena slab and then relocates tuples from sparse slabs.
+ */
+static void
+memtx_defrag_run_pass(struct memtx_engine *memtx)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	struct slab_arena *arena = &memtx->arena;
+	uint32_t slab_count = arena->prealloc / arena->slab_size;
+	if (slab_count != defrag->slab_count) {
+		free(defrag->slab_used);
+		defrag->slab_used = (size_t *)xcalloc(slab_count,
+						      sizeof(size_t));
+		defrag->slab_count = slab_count;
+	} else {
+		memset(defrag->slab_used, 0, slab_count * sizeof(size_t));
+	}
+	struct memtx_defrag_space_ids spaces = {NULL, 0, 0};
+	space_foreach(memtx_defrag_collect_space_f, &spaces);
+	double step_start = clock_monotonic();
+	for (uint32_t i = 0; i < spaces.count; i++) {
+		if (!memtx_defrag_foreach_tuple(memtx, spaces.ids[i],
+						memtx_defrag_scan_tuple,
+						&step_start))
+			goto out;
+	}
+	defrag->sparse_slabs = 0;
+	for (uint32_t i = 0; i < slab_count; i++) {
+		if (memtx_defrag_slab_is_sparse(memtx, i))
+			defrag->sparse_slabs++;
+	}
+	for (uint32_t i = 0; i < spaces.count &&
+			     defrag->sparse_slabs > 0; i++) {
+		if (!memtx_defrag_foreach_tuple(memtx, spaces.ids[i],
+						memtx_defrag_relocate_tuple,
+						&step_start))
+			goto out;
+	}
+	defrag->passes++;
+out:
+	free(spaces.ids);
+}
+
+static int
+memtx_defrag_f(va_list ap)
+{
+	struct memtx_engine *memtx = va_arg(ap, struct memtx_engine *);
+	while (!fiber_is_cancelled()) {
+		if (memtx->defrag.threshold == 0) {
+			fiber_yield_timeout(TIMEOUT_INFINITY);
+			continue;
+		}
+		if (!memtx_defrag_is_paused(memtx))
+			memtx_defrag_run_pass(memtx);
+		fiber_sleep(MEMTX_DEFRAG_PASS_INTERVAL);
+	}
+	return 0;
+}
+
+int
+memtx_defrag_create(struct memtx_engine *memtx, const char *allocator)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	memset(defrag, 0, sizeof(*defrag));
+	/* The system allocator doesn't use the memtx arena. */
+	defrag->is_supported = strcmp(allocator, "small") == 0;
+	if (!defrag->is_supported)
+		return 0;
+	defrag->fiber = fiber_new_system("memtx.defrag", memtx_defrag_f);
+	if (defrag->fiber == NULL)
+		return -1;
+	fiber_set_joinable(defrag->fiber, true);
+	fiber_start(defrag->fiber, memtx);
+	return 0;
+}
+
+void
+memtx_defrag_stop(struct memtx_engine *memtx)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	if (defrag->fiber == NULL)
+		return;
+	fiber_cancel(defrag->fiber);
+	fiber_join(defrag->fiber);
+	defrag->fiber = NULL;
+}
+
+void
+memtx_defrag_destroy(struct memtx_engine *memtx)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	free(defrag->slab_used);
+	defrag->slab_used = NULL;
+	defrag->slab_count = 0;
+}
+
+void
+memtx_defrag_set_threshold(struct memtx_engine *memtx, double threshold)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	defrag->threshold = threshold;
+	if (defrag->fiber != NULL)
+		fiber_wakeup(defrag->fiber);
+}
+
+void
+memtx_defrag_stat(struct memtx_engine *memtx, struct info_handler *h)
+{
+	struct memtx_defrag *defrag = &memtx->defrag;
+	info_table_begin(h, "defrag");
+	info_append_int(h, "passes", defrag->passes);
+	info_append_int(h, "sparse_slabs", defrag->sparse_slabs);
+	info_table_begin(h, "relocated");
+	info_append_int(h, "count", defrag->relocated);
+	info_append_int(h, "bytes", defrag->relocated_bytes);
+	info_table_end(h); /* relocated */
+	info_table_end(h); /* defrag */
+}
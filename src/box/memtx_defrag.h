@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct fiber;
+struct info_handler;
+struct memtx_engine;
+
+/**
+ * Online defragmentation of the memtx tuple arena.
+ *
+ * After heavy update/delete churn, live tuples may be scattered over
+ * many arena slabs each of which is mostly empty, and the memory held
+ * by those slabs can't be reused by other size classes. The defragmenter
+ * is a background fiber that periodically scans memtx spaces, counts
+ * the memory used by tuples in each arena slab, and replaces tuples that
+ * reside in sparse slabs with their copies allocated elsewhere, so that
+ * sparse slabs get freed eventually.
+ *
+ * A tuple is relocated only if it isn't referenced by anyone but its
+ * space (so there's no Lua object, iterator or statement pointing to it)
+ * and doesn't have an MVCC story. Relocation doesn't change the data so
+ * it isn't written to WAL. The defragmenter pauses while there are open
+ * read views, because the old tuple copies can't be freed until they are
+ * closed anyway, and yields after each MEMTX_DEFRAG_STEP_TIME seconds of
+ * work so as not to block the tx thread for long.
+ */
+struct memtx_defrag {
+	/** Background fiber doing the job. */
+	struct fiber *fiber;
+	/**
+	 * Arena slabs filled with tuples less than this fraction are
+	 * considered sparse, box.cfg.memtx_defrag_threshold. Zero
+	 * disables defragmentation.
+	 */
+	double threshold;
+	/** Set if memtx tuples are allocated from the memtx slab arena. */
+	bool is_supported;
+	/**
+	 * Size of memory used by tuples in each slab of the preallocated
+	 * arena area, collected by the last scan.
+	 */
+	size_t *slab_used;
+	/** Number of entries in slab_used. */
+	uint32_t slab_count;
+	/** Number of completed defragmentation passes. */
+	int64_t passes;
+	/** Number of sparse slabs found by the last pass. */
+	int64_t sparse_slabs;
+	/** Number of relocated tuples. */
+	int64_t relocated;
+	/** Size of memory occupied by relocated tuples. */
+	int64_t relocated_bytes;
+};
+
+/**
+ * Creates the defragmenter fiber. The fiber isn't started until
+ * memtx_defrag_start() is called.
+ */
+int
+memtx_defrag_create(struct memtx_engine *memtx, const char *allocator);
+
+/** Starts the defragmenter fiber. */
+void
+memtx_defrag_start(struct memtx_engine *memtx);
+
+/** Stops the defragmenter fiber. Yields. */
+void
+memtx_defrag_stop(struct memtx_engine *memtx);
+
+/** Frees the defragmenter state. */
+void
+memtx_defrag_destroy(struct memtx_engine *memtx);
+
+/** Sets box.cfg.memtx_defrag_threshold. */
+void
+memtx_defrag_set_threshold(struct memtx_engine *memtx, double threshold);
+
+/** Appends the defragmenter statistics to box.stat.memtx(). */
+void
+memtx_defrag_stat(struct memtx_engine *memtx, struct info_handler *h);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
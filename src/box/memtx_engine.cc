@@ -205,6 +205,7 @@ memtx_engine_shutdown(struct engine *engine)
 	fiber_cancel(memtx->gc_fiber);
 	fiber_join(memtx->gc_fiber);
 	memtx->gc_fiber = NULL;
+	memtx_defrag_stop(memtx);
 }
 
 static void
@@ -247,6 +248,7 @@ memtx_engine_free(struct engine *engine)
 
 	xdir_destroy(&memtx->snap_dir);
 	tuple_format_unref(memtx->func_key_format);
+	memtx_defrag_destroy(memtx);
 	free(memtx);
 }
 
@@ -275,29 +277,166 @@ static int
 memtx_engine_recover_snapshot_row(struct xrow_header *row,
 				  enum snapshot_recovery_state *state);
 
-int
-memtx_engine_recover_snapshot(struct memtx_engine *memtx,
-			      const struct vclock *vclock)
+/**
+ * Reads the header of the snapshot with the given vclock. If it's
+ * a delta snapshot, stores the vclock of the snapshot it's based on
+ * in @a base and returns 0. If it's a full snapshot, returns 1.
+ * On error returns -1 and sets diag.
+ */
+static int
+memtx_engine_read_snap_base(struct memtx_engine *memtx,
+			    const struct vclock *vclock, struct vclock *base)
+{
+	struct xlog_cursor cursor;
+	if (xdir_open_cursor(&memtx->snap_dir, vclock_sum(vclock),
+			     &cursor) != 0)
+		return -1;
+	int rc = 1;
+	if (vclock_is_set(&cursor.meta.prev_vclock)) {
+		vclock_copy(base, &cursor.meta.prev_vclock);
+		rc = 0;
+	}
+	xlog_cursor_close(&cursor, false);
+	return rc;
+}
+
+/**
+ * Collects the chain of snapshots needed to recover the snapshot with
+ * the given vclock: the snapshot itself followed by the snapshots it's
+ * based on, down to the full snapshot. The chain is allocated with
+ * malloc() and must be freed by the caller.
+ *
+ * Returns the chain length. On error returns -1 and sets diag.
+ */
+static int
+memtx_engine_snap_chain(struct memtx_engine *memtx,
+			const struct vclock *vclock, struct vclock **chain)
+{
+	int count = 0;
+	int capacity = 0;
+	struct vclock *array = NULL;
+	struct vclock curr;
+	vclock_copy(&curr, vclock);
+	while (true) {
+		if (count == capacity) {
+			capacity = MAX(capacity * 2, 4);
+			array = (struct vclock *)xrealloc(
+				array, capacity * sizeof(*array));
+		}
+		vclock_copy(&array[count++], &curr);
+		struct vclock base;
+		int rc = memtx_engine_read_snap_base(memtx, &curr, &base);
+		if (rc < 0)
+			goto fail;
+		if (rc > 0)
+			break;
+		if (vclock_sum(&base) >= vclock_sum(&curr)) {
+			diag_set(XlogError, "%s: invalid base snapshot",
+				 xdir_format_filename(&memtx->snap_dir,
+						      vclock_sum(&curr),
+						      NONE));
+			goto fail;
+		}
+		vclock_copy(&curr, &base);
+	}
+	*chain = array;
+	return count;
+fail:
+	free(array);
+	return -1;
+}
+
+/**
+ * Decodes the id of the space a snapshot row belongs to.
+ */
+static int
+snapshot_row_space_id(struct xrow_header *row, uint32_t *space_id)
+{
+	struct request request;
+	RegionGuard region_guard(&fiber()->gc);
+	if (xrow_decode_dml(row, &request,
+			    iproto_key_bit(IPROTO_SPACE_ID)) != 0)
+		return -1;
+	*space_id = request.space_id;
+	return 0;
+}
+
+/**
+ * Checks if a row of a base snapshot of a delta snapshot chain needs to
+ * be recovered. System spaces, Raft and limbo states are always recovered
+ * from the most recent snapshot of the chain while user spaces are taken
+ * from the most recent snapshot that stores them.
+ */
+static int
+snapshot_row_is_needed(struct xrow_header *row,
+		       struct mh_i32_t *reset_space_ids, bool *is_needed)
+{
+	*is_needed = false;
+	if (row->type != IPROTO_INSERT)
+		return 0;
+	uint32_t space_id;
+	if (snapshot_row_space_id(row, &space_id) != 0)
+		return -1;
+	if (space_id_is_system(space_id))
+		return 0;
+	if (mh_i32_find(reset_space_ids, space_id, NULL) !=
+	    mh_end(reset_space_ids))
+		return 0;
+	/* The space was dropped after the snapshot was written. */
+	if (space_by_id(space_id) == NULL)
+		return 0;
+	*is_needed = true;
+	return 0;
+}
+
+/**
+ * Recovers one snapshot file of a snapshot chain.
+ *
+ * @param signature signature of the most recent snapshot of the chain
+ * @param is_base set if the file is a base of a more recent snapshot
+ * @param reset_space_ids ids of spaces stored in more recent snapshots,
+ *                        updated with spaces stored in this file
+ */
+static int
+memtx_engine_recover_snapshot_file(struct memtx_engine *memtx,
+				   const struct vclock *vclock,
+				   int64_t signature, bool is_base,
+				   struct mh_i32_t *reset_space_ids)
 {
-	/* Process existing snapshot */
-	say_info("recovery start");
-	int64_t signature = vclock_sum(vclock);
 	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    signature, NONE);
+						    vclock_sum(vclock), NONE);
 
 	say_info("recovering from `%s'", filename);
 	struct xlog_cursor cursor;
 	if (xlog_cursor_open(&cursor, filename) < 0)
 		return -1;
 
+	struct mh_i32_t *space_ids = mh_i32_new();
 	int rc;
 	struct xrow_header row;
 	uint64_t row_count = 0;
 	bool force_recovery = false;
-	enum snapshot_recovery_state state = SNAPSHOT_RECOVERY_NOT_STARTED;
+	enum snapshot_recovery_state state = is_base ?
+		DONE_RECOVERING_SYSTEM_SPACES : SNAPSHOT_RECOVERY_NOT_STARTED;
 	while ((rc = xlog_cursor_next(&cursor, &row, force_recovery)) == 0) {
 		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(&row, &state);
+		if (row.type == MEMTX_SNAP_SPACE_RESET) {
+			uint32_t space_id;
+			rc = snapshot_row_space_id(&row, &space_id);
+			if (rc != 0)
+				break;
+			mh_i32_put(space_ids, &space_id, NULL, NULL);
+			continue;
+		}
+		bool is_needed = true;
+		if (is_base) {
+			rc = snapshot_row_is_needed(&row, reset_space_ids,
+						    &is_needed);
+			if (rc != 0)
+				break;
+		}
+		if (is_needed)
+			rc = memtx_engine_recover_snapshot_row(&row, &state);
 		if (state == DONE_RECOVERING_SYSTEM_SPACES)
 			force_recovery = memtx->force_recovery;
 		if (rc < 0) {
@@ -314,6 +453,13 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 		}
 	}
 	xlog_cursor_close(&cursor, false);
+	/* Rows of these spaces must be ignored in older snapshots. */
+	mh_int_t i;
+	mh_foreach(space_ids, i) {
+		uint32_t space_id = *mh_i32_node(space_ids, i);
+		mh_i32_put(reset_space_ids, &space_id, NULL, NULL);
+	}
+	mh_i32_delete(space_ids);
 	if (rc < 0)
 		return -1;
 
@@ -341,6 +487,51 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	return 0;
 }
 
+/** Clears memtx_space::is_dirty, see memtx_engine_recover_snapshot(). */
+static int
+memtx_space_clear_dirty(struct space *space, void *arg)
+{
+	(void)arg;
+	if (space_is_memtx(space))
+		((struct memtx_space *)space)->is_dirty = false;
+	return 0;
+}
+
+int
+memtx_engine_recover_snapshot(struct memtx_engine *memtx,
+			      const struct vclock *vclock)
+{
+	/* Process existing snapshot */
+	say_info("recovery start");
+	/*
+	 * A delta snapshot is recovered along with the snapshots it's
+	 * based on, starting from the most recent one.
+	 */
+	struct vclock *chain;
+	int chain_length = memtx_engine_snap_chain(memtx, vclock, &chain);
+	if (chain_length < 0)
+		return -1;
+	struct mh_i32_t *reset_space_ids = mh_i32_new();
+	int rc = 0;
+	for (int i = 0; i < chain_length && rc == 0; i++) {
+		rc = memtx_engine_recover_snapshot_file(
+			memtx, &chain[i], vclock_sum(vclock),
+			/*is_base=*/i > 0, reset_space_ids);
+	}
+	mh_i32_delete(reset_space_ids);
+	free(chain);
+	if (rc != 0)
+		return -1;
+	/*
+	 * The recovered data is stored in the last snapshot so it
+	 * doesn't need to be written to the next delta snapshot.
+	 */
+	space_foreach(memtx_space_clear_dirty, NULL);
+	memtx->snap_chain_length = chain_length - 1;
+	memtx->snap_dirty_is_valid = true;
+	return 0;
+}
+
 static int
 memtx_engine_recover_raft(const struct xrow_header *row)
 {
@@ -818,6 +1009,19 @@ struct checkpoint {
 	 * checkpoint already exists.
 	 */
 	bool touch;
+	/**
+	 * Set if only spaces that have changed since the last snapshot
+	 * are written to the snapshot file (delta snapshot).
+	 */
+	bool is_delta;
+	/** The vclock of the snapshot the delta snapshot is based on. */
+	struct vclock base_vclock;
+	/**
+	 * Ids of spaces that have changed since the last snapshot.
+	 * Their memtx_space::is_dirty flags are cleared when the
+	 * checkpoint is started and restored if it's aborted.
+	 */
+	struct mh_i32_t *dirty_space_ids;
 };
 
 /** Space filter for checkpoint. */
@@ -883,7 +1087,7 @@ is_tuple_temporary(const char *data, uint32_t space_id,
 }
 
 static struct checkpoint *
-checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
+checkpoint_new(struct memtx_engine *memtx)
 {
 	struct checkpoint *ckpt = (struct checkpoint *)malloc(sizeof(*ckpt));
 	if (ckpt == NULL) {
@@ -902,27 +1106,104 @@ checkpoint_new(const char *snap_dirname, uint64_t snap_io_rate_limit)
 		return NULL;
 	}
 	struct xlog_opts opts = xlog_opts_default;
-	opts.rate_limit = snap_io_rate_limit;
+	opts.rate_limit = memtx->snap_io_rate_limit;
 	opts.sync_interval = SNAP_SYNC_INTERVAL;
 	opts.free_cache = true;
-	xdir_create(&ckpt->dir, snap_dirname, SNAP, &INSTANCE_UUID, &opts);
+	xdir_create(&ckpt->dir, memtx->snap_dir.dirname, SNAP,
+		    &INSTANCE_UUID, &opts);
 	xlog_clear(&ckpt->snap);
 	vclock_create(&ckpt->vclock);
 	box_raft_checkpoint_local(&ckpt->raft);
 	txn_limbo_checkpoint(&txn_limbo, &ckpt->synchro_state,
 			     &ckpt->synchro_vclock);
 	ckpt->touch = false;
+	/*
+	 * Write a delta snapshot if the changes made since the last
+	 * snapshot are tracked and the chain isn't too long yet.
+	 */
+	vclock_create(&ckpt->base_vclock);
+	ckpt->is_delta = memtx->snap_dirty_is_valid &&
+			 memtx->snap_chain_length < memtx->snap_delta_count &&
+			 xdir_last_vclock(&memtx->snap_dir,
+					  &ckpt->base_vclock) >= 0;
+	/*
+	 * Collect the spaces that have changed since the last snapshot.
+	 * The read view was opened without yielding so changes made
+	 * after this point will be written to the next snapshot.
+	 */
+	ckpt->dirty_space_ids = mh_i32_new();
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, &ckpt->rv) {
+		struct space *space = space_by_id(space_rv->id);
+		assert(space != NULL && space_is_memtx(space));
+		struct memtx_space *memtx_space = (struct memtx_space *)space;
+		if (!memtx_space->is_dirty)
+			continue;
+		memtx_space->is_dirty = false;
+		mh_i32_put(ckpt->dirty_space_ids, &space_rv->id, NULL, NULL);
+	}
 	return ckpt;
 }
 
+/**
+ * Marks spaces written to an aborted checkpoint as changed so that
+ * they are written to the next delta snapshot.
+ */
+static void
+checkpoint_restore_dirty(struct checkpoint *ckpt)
+{
+	mh_int_t i;
+	mh_foreach(ckpt->dirty_space_ids, i) {
+		uint32_t space_id = *mh_i32_node(ckpt->dirty_space_ids, i);
+		struct space *space = space_by_id(space_id);
+		if (space != NULL && space_is_memtx(space))
+			((struct memtx_space *)space)->is_dirty = true;
+	}
+}
+
+/**
+ * Returns true if the space must be written to the checkpoint.
+ * System spaces are always written.
+ */
+static bool
+checkpoint_space_is_needed(struct checkpoint *ckpt, uint32_t space_id)
+{
+	if (!ckpt->is_delta || space_id_is_system(space_id))
+		return true;
+	return mh_i32_find(ckpt->dirty_space_ids, space_id, NULL) !=
+	       mh_end(ckpt->dirty_space_ids);
+}
+
 static void
 checkpoint_delete(struct checkpoint *ckpt)
 {
 	read_view_close(&ckpt->rv);
 	xdir_destroy(&ckpt->dir);
+	mh_i32_delete(ckpt->dirty_space_ids);
 	free(ckpt);
 }
 
+/**
+ * Writes a row telling recovery to ignore rows of a space stored in
+ * older snapshots of a delta snapshot chain.
+ */
+static int
+checkpoint_write_space_reset(struct xlog *l, uint32_t space_id)
+{
+	char buf[16];
+	char *p = mp_encode_map(buf, 1);
+	p = mp_encode_uint(p, IPROTO_SPACE_ID);
+	p = mp_encode_uint(p, space_id);
+	assert((size_t)(p - buf) <= sizeof(buf));
+	struct xrow_header row;
+	memset(&row, 0, sizeof(row));
+	row.type = MEMTX_SNAP_SPACE_RESET;
+	row.bodycnt = 1;
+	row.body[0].iov_base = buf;
+	row.body[0].iov_len = p - buf;
+	return checkpoint_write_row(l, &row);
+}
+
 static int
 checkpoint_write_raft(struct xlog *l, const struct raft_request *req)
 {
@@ -1046,7 +1327,10 @@ checkpoint_f(va_list ap)
 
 	struct xlog *snap = &ckpt->snap;
 	assert(!xlog_is_open(snap));
-	if (xdir_create_xlog(&ckpt->dir, snap, &ckpt->vclock) != 0) {
+	const struct vclock *base_vclock = ckpt->is_delta ?
+					   &ckpt->base_vclock : NULL;
+	if (xdir_create_xlog_with_prev(&ckpt->dir, snap, &ckpt->vclock,
+				       base_vclock) != 0) {
 		/*
 		 * We call memtx_engine_abort_checkpoint on failure to discard
 		 * an incomplete xlog file. Clear the xlog object so that it's
@@ -1059,7 +1343,8 @@ checkpoint_f(va_list ap)
 	struct mh_i32_t *temp_space_ids;
 
 	bool is_synchro_written = false;
-	say_info("saving snapshot `%s'", snap->filename);
+	say_info("saving %ssnapshot `%s'", ckpt->is_delta ? "delta " : "",
+		 snap->filename);
 	ERROR_INJECT_WHILE(ERRINJ_SNAP_WRITE_DELAY, {
 		fiber_sleep(0.001);
 		if (fiber_is_cancelled()) {
@@ -1091,6 +1376,13 @@ checkpoint_f(va_list ap)
 				break;
 			is_synchro_written = true;
 		}
+		if (!checkpoint_space_is_needed(ckpt, space_rv->id))
+			continue;
+		if (ckpt->is_delta && !space_id_is_system(space_rv->id)) {
+			rc = checkpoint_write_space_reset(snap, space_rv->id);
+			if (rc != 0)
+				break;
+		}
 		struct index_read_view *index_rv =
 			space_read_view_index(space_rv, 0);
 		assert(index_rv != NULL);
@@ -1175,8 +1467,7 @@ memtx_engine_begin_checkpoint(struct engine *engine, bool is_scheduled)
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
 
 	assert(memtx->checkpoint == NULL);
-	memtx->checkpoint = checkpoint_new(memtx->snap_dir.dirname,
-					   memtx->snap_io_rate_limit);
+	memtx->checkpoint = checkpoint_new(memtx);
 	if (memtx->checkpoint == NULL)
 		return -1;
 	return 0;
@@ -1236,7 +1527,12 @@ memtx_engine_commit_checkpoint(struct engine *engine,
 		ERROR_INJECT_YIELD(ERRINJ_SNAP_COMMIT_DELAY);
 		coio_call(memtx_engine_commit_checkpoint_f,
 			  &memtx->checkpoint->snap);
+		if (memtx->checkpoint->is_delta)
+			memtx->snap_chain_length++;
+		else
+			memtx->snap_chain_length = 0;
 	}
+	memtx->snap_dirty_is_valid = true;
 
 	struct vclock last;
 	if (xdir_last_vclock(&memtx->snap_dir, &last) < 0 ||
@@ -1267,6 +1563,7 @@ memtx_engine_abort_checkpoint(struct engine *engine)
 	assert(!xlog_is_open(&memtx->checkpoint->snap));
 
 	coio_call(memtx_engine_abort_checkpoint_f, &memtx->checkpoint->snap);
+	checkpoint_restore_dirty(memtx->checkpoint);
 	checkpoint_delete(memtx->checkpoint);
 	memtx->checkpoint = NULL;
 }
@@ -1275,8 +1572,26 @@ static void
 memtx_engine_collect_garbage(struct engine *engine, const struct vclock *vclock)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-	xdir_collect_garbage(&memtx->snap_dir, vclock_sum(vclock),
-			     XDIR_GC_ASYNC);
+	int64_t signature = vclock_sum(vclock);
+	/*
+	 * Snapshots a delta snapshot is based on are needed for
+	 * recovery so they must not be removed.
+	 */
+	struct vclock last;
+	if (xdir_last_vclock(&memtx->snap_dir, &last) >= 0 &&
+	    vclock_sum(&last) >= signature) {
+		struct vclock *chain;
+		int chain_length = memtx_engine_snap_chain(memtx, vclock,
+							   &chain);
+		if (chain_length < 0) {
+			diag_log();
+			say_error("failed to collect snapshot garbage");
+			return;
+		}
+		signature = vclock_sum(&chain[chain_length - 1]);
+		free(chain);
+	}
+	xdir_collect_garbage(&memtx->snap_dir, signature, XDIR_GC_ASYNC);
 }
 
 static int
@@ -1284,9 +1599,19 @@ memtx_engine_backup(struct engine *engine, const struct vclock *vclock,
 		    engine_backup_cb cb, void *cb_arg)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    vclock_sum(vclock), NONE);
-	return cb(filename, cb_arg);
+	/* A delta snapshot is useless without its base snapshots. */
+	struct vclock *chain;
+	int chain_length = memtx_engine_snap_chain(memtx, vclock, &chain);
+	if (chain_length < 0)
+		return -1;
+	int rc = 0;
+	for (int i = 0; i < chain_length && rc == 0; i++) {
+		const char *filename = xdir_format_filename(
+			&memtx->snap_dir, vclock_sum(&chain[i]), NONE);
+		rc = cb(filename, cb_arg);
+	}
+	free(chain);
+	return rc;
 }
 
 struct memtx_join_ctx {
@@ -1655,7 +1980,7 @@ memtx_tuple_validate(struct tuple_format *format, struct tuple *tuple)
 struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
-		 bool dontdump, unsigned granularity,
+		 bool dontdump, const char *huge_pages, unsigned granularity,
 		 const char *allocator, float alloc_factor, int sort_threads,
 		 memtx_on_indexes_built_cb on_indexes_built)
 {
@@ -1751,6 +2076,8 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 	quota_init(&memtx->quota, tuple_arena_max_size);
 	tuple_arena_create(&memtx->arena, &memtx->quota, tuple_arena_max_size,
 			   SLAB_SIZE, dontdump, "memtx");
+	memtx->huge_pages = tuple_arena_use_huge_pages(
+		&memtx->arena, STR2ENUM(tuple_arena_huge_pages, huge_pages));
 	slab_cache_create(&memtx->slab_cache, &memtx->arena);
 	float actual_alloc_factor;
 	allocator_settings alloc_settings;
@@ -1819,6 +2146,10 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 
 	memtx->on_indexes_built_cb = on_indexes_built;
 
+	if (memtx_defrag_create(memtx, allocator) != 0) {
+		diag_log();
+		panic("failed to start memtx defragmentation");
+	}
 	fiber_start(memtx->gc_fiber, memtx);
 	return memtx;
 fail:
@@ -1889,6 +2220,12 @@ memtx_engine_stat_tx(struct memtx_engine *memtx, struct info_handler *h)
 		info_table_end(h);
 	}
 	info_table_end(h); /* tuples */
+	info_table_begin(h, "gc");
+	info_append_int(h, "steps", stats.gc_steps);
+	info_append_int(h, "collected", stats.gc_collected);
+	info_append_int(h, "lag", stats.gc_lag);
+	info_append_int(h, "steps_per_story", stats.gc_steps_per_story);
+	info_table_end(h); /* gc */
 	info_table_end(h); /* mvcc */
 	info_table_end(h); /* tx */
 }
@@ -1920,12 +2257,33 @@ memtx_engine_stat_index(struct memtx_engine *memtx, struct info_handler *h)
 	info_table_end(h); /* index */
 }
 
+/** Appends memtx arena stats to info. */
+static void
+memtx_engine_stat_arena(struct memtx_engine *memtx, struct info_handler *h)
+{
+	info_table_begin(h, "arena");
+	info_append_int(h, "total", memtx->arena.used);
+	info_append_str(h, "huge_pages",
+			tuple_arena_huge_pages_strs[memtx->huge_pages]);
+	/*
+	 * Scanning memory mappings is not free, so don't do it
+	 * if huge pages weren't requested.
+	 */
+	size_t huge = 0;
+	if (memtx->huge_pages != TUPLE_ARENA_HUGE_PAGES_OFF)
+		huge = tuple_arena_huge_pages_used(&memtx->arena);
+	info_append_int(h, "huge", huge);
+	info_table_end(h); /* arena */
+}
+
 void
 memtx_engine_stat(struct memtx_engine *memtx, struct info_handler *h)
 {
 	info_begin(h);
 	memtx_engine_stat_data(memtx, h);
 	memtx_engine_stat_index(memtx, h);
+	memtx_engine_stat_arena(memtx, h);
+	memtx_defrag_stat(memtx, h);
 	memtx_engine_stat_tx(memtx, h);
 	info_end(h);
 }
@@ -1945,6 +2303,12 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_snap_delta_count(struct memtx_engine *memtx, int count)
+{
+	memtx->snap_delta_count = count;
+}
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size)
 {
@@ -2203,6 +2567,14 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 		return true;
 	if (old_def->opts.hint != new_def->opts.hint)
 		return true;
+	if (old_def->opts.layout != new_def->opts.layout)
+		return true;
+	if (old_def->opts.hash_func != new_def->opts.hash_func)
+		return true;
+	if (old_def->opts.hint_parts != new_def->opts.hint_parts)
+		return true;
+	if (old_def->opts.key_prefix != new_def->opts.key_prefix)
+		return true;
 
 	const struct key_def *old_cmp_def, *new_cmp_def;
 	if (index_depends_on_pk(index)) {
@@ -2236,6 +2608,10 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 			return true;
 		if (old_part->sort_order != new_part->sort_order)
 			return true;
+		/* Whether a key can be normalized depends on part types. */
+		if (new_def->opts.key_prefix &&
+		    old_part->type != new_part->type)
+			return true;
 	}
 	assert(old_cmp_def->is_multikey == new_cmp_def->is_multikey);
 	return false;
@@ -42,6 +42,8 @@
 #include "xlog.h"
 #include "salad/stailq.h"
 #include "sysalloc.h"
+#include "tuple.h"
+#include "memtx_defrag.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -109,7 +111,7 @@ enum memtx_reserve_extents_num {
  * allocated for each iterator (except rtree index iterator that
  * is significantly bigger so has own pool).
  */
-#define MEMTX_ITERATOR_SIZE (184)
+#define MEMTX_ITERATOR_SIZE (224)
 
 typedef void
 (*memtx_on_indexes_built_cb)(void);
@@ -124,6 +126,23 @@ struct memtx_engine {
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * Max number of delta snapshots written in a row before a full
+	 * snapshot is written, box.cfg.snap_delta_count. A delta snapshot
+	 * stores only spaces that have changed since the previous snapshot.
+	 * Zero disables delta snapshots.
+	 */
+	int snap_delta_count;
+	/**
+	 * Number of delta snapshots in the chain of the last snapshot,
+	 * i.e. written since the last full snapshot.
+	 */
+	int snap_chain_length;
+	/**
+	 * Set if memtx_space::is_dirty flags reflect changes made since
+	 * the last snapshot so that the next snapshot may be a delta.
+	 */
+	bool snap_dirty_is_valid;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
 	/**
@@ -140,6 +159,8 @@ struct memtx_engine {
 	 * is reflected in box.slab.info(), @sa lua/slab.c.
 	 */
 	struct slab_arena arena;
+	/** Kind of pages actually backing the arena. */
+	enum tuple_arena_huge_pages huge_pages;
 	/** Slab cache for allocating tuples. */
 	struct slab_cache slab_cache;
 	/** Slab cache for allocating index extents. */
@@ -186,6 +207,8 @@ struct memtx_engine {
 	 * start.
 	 */
 	int sort_threads;
+	/** Online tuple arena defragmentation state. */
+	struct memtx_defrag defrag;
 };
 
 struct memtx_gc_task;
@@ -220,7 +243,7 @@ memtx_engine_schedule_gc(struct memtx_engine *memtx,
 struct memtx_engine *
 memtx_engine_new(const char *snap_dirname, bool force_recovery,
 		 uint64_t tuple_arena_max_size, uint32_t objsize_min,
-		 bool dontdump, unsigned granularity,
+		 bool dontdump, const char *huge_pages, unsigned granularity,
 		 const char *allocator, float alloc_factor, int threads_num,
 		 memtx_on_indexes_built_cb on_indexes_built);
 
@@ -237,6 +260,9 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
+void
+memtx_engine_set_snap_delta_count(struct memtx_engine *memtx, int count);
+
 int
 memtx_engine_set_memory(struct memtx_engine *memtx, size_t size);
 
@@ -360,15 +386,16 @@ memtx_tuple_validate(struct tuple_format *format, struct tuple *tuple);
 static inline struct memtx_engine *
 memtx_engine_new_xc(const char *snap_dirname, bool force_recovery,
 		    uint64_t tuple_arena_max_size, uint32_t objsize_min,
-		    bool dontdump, unsigned granularity,
-		    const char *allocator, float alloc_factor,
-		    int sort_threads,
+		    bool dontdump, const char *huge_pages,
+		    unsigned granularity, const char *allocator,
+		    float alloc_factor, int sort_threads,
 		    memtx_on_indexes_built_cb on_indexes_built)
 {
 	struct memtx_engine *memtx;
 	memtx = memtx_engine_new(snap_dirname, force_recovery,
 				 tuple_arena_max_size, objsize_min, dontdump,
-				 granularity, allocator, alloc_factor,
+				 huge_pages, granularity, allocator,
+				 alloc_factor,
 				 sort_threads, on_indexes_built);
 	if (memtx == NULL)
 		diag_raise();
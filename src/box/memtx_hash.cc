@@ -76,64 +76,266 @@ memtx_hash_equal_key(struct tuple *tuple, const char *key,
 #undef LIGHT_EQUAL
 #undef LIGHT_EQUAL_KEY
 
+#define SWISS_NAME _index
+#define SWISS_DATA_TYPE struct tuple *
+#define SWISS_KEY_TYPE const char *
+#define SWISS_CMP_ARG_TYPE struct key_def *
+#define SWISS_EQUAL(a, b, c) memtx_hash_equal(a, b, c)
+#define SWISS_EQUAL_KEY(a, b, c) memtx_hash_equal_key(a, b, c)
+
+#include "salad/swiss.h"
+
+#undef SWISS_NAME
+#undef SWISS_DATA_TYPE
+#undef SWISS_KEY_TYPE
+#undef SWISS_CMP_ARG_TYPE
+#undef SWISS_EQUAL
+#undef SWISS_EQUAL_KEY
+
+/**
+ * Hash table used by a memtx hash index, selected by the index layout
+ * option: light (chained) if USE_SWISS is false, swiss otherwise.
+ * Both hash tables have the same interface so the wrappers below only
+ * dispatch calls.
+ */
+template <bool USE_SWISS>
+struct memtx_hash_table;
+
+#define MEMTX_HASH_TABLE_DEFINE(prefix)						\
+	typedef struct prefix##_index_core core;				\
+	typedef struct prefix##_index_view view;				\
+	typedef struct prefix##_index_iterator iterator;			\
+	static constexpr uint32_t end = prefix##_index_end;			\
+	static void								\
+	create(core *ht, struct key_def *arg, struct memtx_engine *memtx)	\
+	{									\
+		prefix##_index_create(ht, arg, MEMTX_EXTENT_SIZE,		\
+				      memtx_index_extent_alloc,			\
+				      memtx_index_extent_free, memtx,		\
+				      &memtx->index_extent_stats);		\
+	}									\
+	static void destroy(core *ht) { prefix##_index_destroy(ht); }		\
+	static uint32_t count(core *ht) { return prefix##_index_count(ht); }	\
+	static uint32_t								\
+	find_key(const core *ht, uint32_t hash, const char *key)		\
+	{									\
+		return prefix##_index_find_key(ht, hash, key);			\
+	}									\
+	static uint32_t								\
+	insert(core *ht, uint32_t hash, struct tuple *tuple)			\
+	{									\
+		return prefix##_index_insert(ht, hash, tuple);			\
+	}									\
+	static uint32_t								\
+	replace(core *ht, uint32_t hash, struct tuple *tuple,			\
+		struct tuple **replaced)					\
+	{									\
+		return prefix##_index_replace(ht, hash, tuple, replaced);	\
+	}									\
+	static int								\
+	delete_slot(core *ht, uint32_t slot)					\
+	{									\
+		return prefix##_index_delete(ht, slot);				\
+	}									\
+	static int								\
+	delete_value(core *ht, uint32_t hash, struct tuple *tuple)		\
+	{									\
+		return prefix##_index_delete_value(ht, hash, tuple);		\
+	}									\
+	static struct tuple *							\
+	get(core *ht, uint32_t slot) { return prefix##_index_get(ht, slot); }	\
+	static uint32_t								\
+	random(const core *ht, uint32_t rnd)					\
+	{									\
+		return prefix##_index_random(ht, rnd);				\
+	}									\
+	static void								\
+	iterator_begin(const core *ht, iterator *itr)				\
+	{									\
+		prefix##_index_iterator_begin(ht, itr);				\
+	}									\
+	static void								\
+	iterator_key(const core *ht, iterator *itr, uint32_t hash,		\
+		     const char *key)						\
+	{									\
+		prefix##_index_iterator_key(ht, itr, hash, key);		\
+	}									\
+	static struct tuple **							\
+	iterator_get_and_next(const core *ht, iterator *itr)			\
+	{									\
+		return prefix##_index_iterator_get_and_next(ht, itr);		\
+	}									\
+	static void								\
+	view_create(view *v, core *ht) { prefix##_index_view_create(v, ht); }	\
+	static void								\
+	view_destroy(view *v) { prefix##_index_view_destroy(v); }		\
+	static void								\
+	view_iterator_begin(const view *v, iterator *itr)			\
+	{									\
+		prefix##_index_view_iterator_begin(v, itr);			\
+	}									\
+	static uint32_t								\
+	view_find_key(const view *v, uint32_t hash, const char *key)		\
+	{									\
+		return prefix##_index_view_find_key(v, hash, key);		\
+	}									\
+	static struct tuple *							\
+	view_get(view *v, uint32_t slot)					\
+	{									\
+		return prefix##_index_view_get(v, slot);			\
+	}									\
+	static void								\
+	view_iterator_key(const view *v, iterator *itr, uint32_t hash,		\
+			  const char *key)					\
+	{									\
+		prefix##_index_view_iterator_key(v, itr, hash, key);		\
+	}									\
+	static struct tuple **							\
+	view_iterator_get_and_next(const view *v, iterator *itr)		\
+	{									\
+		return prefix##_index_view_iterator_get_and_next(v, itr);	\
+	}
+
+template <>
+struct memtx_hash_table<false> {
+	MEMTX_HASH_TABLE_DEFINE(light)
+	static size_t
+	extent_count(const core *ht)
+	{
+		return matras_extent_count(&ht->mtable);
+	}
+	static int
+	reserve(core *ht, uint32_t size_hint)
+	{
+		/* Light grows incrementally, nothing to do. */
+		(void)ht;
+		(void)size_hint;
+		return 0;
+	}
+};
+
+template <>
+struct memtx_hash_table<true> {
+	MEMTX_HASH_TABLE_DEFINE(swiss)
+	static size_t
+	extent_count(const core *ht)
+	{
+		return swiss_index_extent_count(ht);
+	}
+	static int
+	reserve(core *ht, uint32_t size_hint)
+	{
+		return swiss_index_reserve(ht, size_hint);
+	}
+};
+
+#undef MEMTX_HASH_TABLE_DEFINE
+
+template <bool USE_SWISS>
 struct memtx_hash_index {
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
 	struct index base;
-	struct light_index_core hash_table;
+	typename hash_table_t::core hash_table;
 	struct memtx_gc_task gc_task;
-	struct light_index_iterator gc_iterator;
+	typename hash_table_t::iterator gc_iterator;
 };
 
+/** Hash a tuple with the function selected by the hash_func option. */
+static inline uint32_t
+memtx_hash_index_tuple_hash(struct index *base, struct tuple *tuple)
+{
+	struct key_def *key_def = base->def->key_def;
+	if (base->def->opts.hash_func == INDEX_HASH_FUNC_XXH3)
+		return tuple_hash(tuple, key_def);
+	return key_def->tuple_hash_murmur(tuple, key_def);
+}
+
+/**
+ * Hash a key with the function selected by the hash_func option of
+ * the given index definition.
+ */
+static inline uint32_t
+memtx_hash_key_hash(struct index_def *def, const char *key)
+{
+	struct key_def *key_def = def->key_def;
+	if (def->opts.hash_func == INDEX_HASH_FUNC_XXH3)
+		return key_hash(key, key_def);
+	return key_def->key_hash_murmur(key, key_def);
+}
+
+/** Hash a key with the function selected by the hash_func option. */
+static inline uint32_t
+memtx_hash_index_key_hash(struct index *base, const char *key)
+{
+	return memtx_hash_key_hash(base->def, key);
+}
+
 /* {{{ MemtxHash Iterators ****************************************/
 
+template <bool USE_SWISS>
 struct hash_iterator {
 	struct iterator base; /* Must be the first member. */
-	struct light_index_iterator iterator;
+	typename memtx_hash_table<USE_SWISS>::iterator iterator;
 	/** Memory pool the iterator was allocated from. */
 	struct mempool *pool;
 };
 
-static_assert(sizeof(struct hash_iterator) <= MEMTX_ITERATOR_SIZE,
+static_assert(sizeof(struct hash_iterator<false>) <= MEMTX_ITERATOR_SIZE,
+	      "sizeof(struct hash_iterator) must be less than or equal "
+	      "to MEMTX_ITERATOR_SIZE");
+static_assert(sizeof(struct hash_iterator<true>) <= MEMTX_ITERATOR_SIZE,
 	      "sizeof(struct hash_iterator) must be less than or equal "
 	      "to MEMTX_ITERATOR_SIZE");
 
+template <bool USE_SWISS>
 static void
 hash_iterator_free(struct iterator *iterator)
 {
-	assert(iterator->free == hash_iterator_free);
-	struct hash_iterator *it = (struct hash_iterator *) iterator;
+	assert(iterator->free == hash_iterator_free<USE_SWISS>);
+	struct hash_iterator<USE_SWISS> *it =
+		(struct hash_iterator<USE_SWISS> *)iterator;
 	mempool_free(it->pool, it);
 }
 
+template <bool USE_SWISS>
 static int
 hash_iterator_ge_base(struct iterator *ptr, struct tuple **ret)
 {
-	assert(ptr->free == hash_iterator_free);
-	struct hash_iterator *it = (struct hash_iterator *) ptr;
-	struct memtx_hash_index *index = (struct memtx_hash_index *)
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	assert(ptr->free == hash_iterator_free<USE_SWISS>);
+	struct hash_iterator<USE_SWISS> *it =
+		(struct hash_iterator<USE_SWISS> *)ptr;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)
 		index_weak_ref_get_index_checked(&ptr->index_ref);
-	struct tuple **res = light_index_iterator_get_and_next(&index->hash_table,
-							       &it->iterator);
+	struct tuple **res = hash_table_t::iterator_get_and_next(
+		&index->hash_table, &it->iterator);
 	*ret = res != NULL ? *res : NULL;
 	return 0;
 }
 
+template <bool USE_SWISS>
 static int
 hash_iterator_gt_base(struct iterator *ptr, struct tuple **ret)
 {
-	assert(ptr->free == hash_iterator_free);
-	struct hash_iterator *it = (struct hash_iterator *) ptr;
-	struct memtx_hash_index *index = (struct memtx_hash_index *)
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	assert(ptr->free == hash_iterator_free<USE_SWISS>);
+	struct hash_iterator<USE_SWISS> *it =
+		(struct hash_iterator<USE_SWISS> *)ptr;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)
 		index_weak_ref_get_index_checked(&ptr->index_ref);
-	struct tuple **res = light_index_iterator_get_and_next(&index->hash_table,
-							       &it->iterator);
+	struct tuple **res = hash_table_t::iterator_get_and_next(
+		&index->hash_table, &it->iterator);
 	if (res != NULL)
-		res = light_index_iterator_get_and_next(&index->hash_table,
-							&it->iterator);
+		res = hash_table_t::iterator_get_and_next(&index->hash_table,
+							  &it->iterator);
 	*ret = res != NULL ? *res : NULL;
 	return 0;
 }
 
 #define WRAP_ITERATOR_METHOD(name)						\
+template <bool USE_SWISS>							\
 static int									\
 name(struct iterator *iterator, struct tuple **ret)				\
 {										\
@@ -145,10 +347,11 @@ name(struct iterator *iterator, struct tuple **ret)				\
 	do {									\
 		int rc;								\
 		if (is_first) {							\
-			rc = name##_base(iterator, ret);			\
-			iterator->next_internal = hash_iterator_ge;		\
+			rc = name##_base<USE_SWISS>(iterator, ret);		\
+			iterator->next_internal =				\
+				hash_iterator_ge<USE_SWISS>;			\
 		} else {							\
-			rc = hash_iterator_ge_base(iterator, ret);		\
+			rc = hash_iterator_ge_base<USE_SWISS>(iterator, ret);	\
 		}								\
 		if (rc != 0 || *ret == NULL)					\
 			return rc;						\
@@ -167,12 +370,13 @@ WRAP_ITERATOR_METHOD(hash_iterator_gt);
 
 #undef WRAP_ITERATOR_METHOD
 
+template <bool USE_SWISS>
 static int
 hash_iterator_eq(struct iterator *it, struct tuple **ret)
 {
 	it->next_internal = exhausted_iterator_next;
 	/* always returns zero. */
-	hash_iterator_ge_base(it, ret);
+	hash_iterator_ge_base<USE_SWISS>(it, ret);
 	if (*ret == NULL)
 		return 0;
 	struct txn *txn = in_txn();
@@ -190,13 +394,15 @@ hash_iterator_eq(struct iterator *it, struct tuple **ret)
 
 /* {{{ MemtxHash -- implementation of all hashes. **********************/
 
+template <bool USE_SWISS>
 static void
-memtx_hash_index_free(struct memtx_hash_index *index)
+memtx_hash_index_free(struct memtx_hash_index<USE_SWISS> *index)
 {
-	light_index_destroy(&index->hash_table);
+	memtx_hash_table<USE_SWISS>::destroy(&index->hash_table);
 	free(index);
 }
 
+template <bool USE_SWISS>
 static void
 memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 {
@@ -210,14 +416,15 @@ memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 	enum { YIELD_LOOPS = 10 };
 #endif
 
-	struct memtx_hash_index *index = container_of(task,
-			struct memtx_hash_index, gc_task);
-	struct light_index_core *hash = &index->hash_table;
-	struct light_index_iterator *itr = &index->gc_iterator;
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	struct memtx_hash_index<USE_SWISS> *index = container_of(task,
+			struct memtx_hash_index<USE_SWISS>, gc_task);
+	typename hash_table_t::core *hash = &index->hash_table;
+	typename hash_table_t::iterator *itr = &index->gc_iterator;
 
 	struct tuple **res;
 	unsigned int loops = 0;
-	while ((res = light_index_iterator_get_and_next(hash, itr)) != NULL) {
+	while ((res = hash_table_t::iterator_get_and_next(hash, itr)) != NULL) {
 		tuple_unref(*res);
 		if (++loops >= YIELD_LOOPS) {
 			*done = false;
@@ -227,23 +434,32 @@ memtx_hash_index_gc_run(struct memtx_gc_task *task, bool *done)
 	*done = true;
 }
 
+template <bool USE_SWISS>
 static void
 memtx_hash_index_gc_free(struct memtx_gc_task *task)
 {
-	struct memtx_hash_index *index = container_of(task,
-			struct memtx_hash_index, gc_task);
+	struct memtx_hash_index<USE_SWISS> *index = container_of(task,
+			struct memtx_hash_index<USE_SWISS>, gc_task);
 	memtx_hash_index_free(index);
 }
 
-static const struct memtx_gc_task_vtab memtx_hash_index_gc_vtab = {
-	.run = memtx_hash_index_gc_run,
-	.free = memtx_hash_index_gc_free,
-};
+template <bool USE_SWISS>
+static const struct memtx_gc_task_vtab *
+get_memtx_hash_index_gc_vtab(void)
+{
+	static const struct memtx_gc_task_vtab vtab = {
+		.run = memtx_hash_index_gc_run<USE_SWISS>,
+		.free = memtx_hash_index_gc_free<USE_SWISS>,
+	};
+	return &vtab;
+}
 
+template <bool USE_SWISS>
 static void
 memtx_hash_index_destroy(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
 	if (base->def->iid == 0) {
 		/*
@@ -251,9 +467,9 @@ memtx_hash_index_destroy(struct index *base)
 		 * in the index, which may take a while. Schedule a
 		 * background task in order not to block tx thread.
 		 */
-		index->gc_task.vtab = &memtx_hash_index_gc_vtab;
-		light_index_iterator_begin(&index->hash_table,
-					   &index->gc_iterator);
+		index->gc_task.vtab = get_memtx_hash_index_gc_vtab<USE_SWISS>();
+		memtx_hash_table<USE_SWISS>::iterator_begin(
+			&index->hash_table, &index->gc_iterator);
 		memtx_engine_schedule_gc(memtx, &index->gc_task);
 	} else {
 		/*
@@ -264,52 +480,61 @@ memtx_hash_index_destroy(struct index *base)
 	}
 }
 
+template <bool USE_SWISS>
 static void
 memtx_hash_index_update_def(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
 	index->hash_table.common.arg = index->base.def->key_def;
 }
 
+template <bool USE_SWISS>
 static ssize_t
 memtx_hash_index_size(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
 	struct space *space = space_by_id(base->def->space_id);
 	/* Substract invisible count. */
-	return light_index_count(&index->hash_table) -
+	return memtx_hash_table<USE_SWISS>::count(&index->hash_table) -
 	       memtx_tx_index_invisible_count(in_txn(), space, base);
 }
 
+template <bool USE_SWISS>
 static ssize_t
 memtx_hash_index_bsize(struct index *base)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	return matras_extent_count(&index->hash_table.mtable) *
-					MEMTX_EXTENT_SIZE;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
+	return memtx_hash_table<USE_SWISS>::extent_count(&index->hash_table) *
+	       MEMTX_EXTENT_SIZE;
 }
 
+template <bool USE_SWISS>
 static int
 memtx_hash_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct light_index_core *hash_table = &index->hash_table;
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
+	typename hash_table_t::core *hash_table = &index->hash_table;
 	struct txn *txn = in_txn();
 	struct space *space = space_by_id(base->def->space_id);
-	if (memtx_hash_index_size(base) == 0) {
+	if (memtx_hash_index_size<USE_SWISS>(base) == 0) {
 		*result = NULL;
 		memtx_tx_track_full_scan(txn, space, base);
 		return 0;
 	}
 
 	do {
-		uint32_t k = light_index_random(hash_table, rnd++);
+		uint32_t k = hash_table_t::random(hash_table, rnd++);
 		/*
-		 * `light_index_end` is returned only in case the space is
+		 * `hash_table_t::end` is returned only in case the space is
 		 * empty.
 		 */
-		assert(k != light_index_end);
-		*result = light_index_get(hash_table, k);
+		assert(k != hash_table_t::end);
+		*result = hash_table_t::get(hash_table, k);
 		assert(*result != NULL);
 		*result = memtx_tx_tuple_clarify(txn, space, *result, base, 0);
 /********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
@@ -319,20 +544,25 @@ memtx_hash_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 	return memtx_prepare_result_tuple(space, result);
 }
 
+template <bool USE_SWISS>
 static ssize_t
 memtx_hash_index_count(struct index *base, enum iterator_type type,
 		       const char *key, uint32_t part_count)
 {
 	if (type == ITER_ALL)
-		return memtx_hash_index_size(base); /* optimization */
+		/* optimization */
+		return memtx_hash_index_size<USE_SWISS>(base);
 	return generic_index_count(base, type, key, part_count);
 }
 
+template <bool USE_SWISS>
 static int
 memtx_hash_index_get_internal(struct index *base, const char *key,
 			      uint32_t part_count, struct tuple **result)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
 
 	assert(base->def->opts.is_unique &&
 	       part_count == base->def->key_def->part_count);
@@ -341,10 +571,10 @@ memtx_hash_index_get_internal(struct index *base, const char *key,
 	struct space *space = space_by_id(base->def->space_id);
 	struct txn *txn = in_txn();
 	*result = NULL;
-	uint32_t h = key_hash(key, base->def->key_def);
-	uint32_t k = light_index_find_key(&index->hash_table, h, key);
-	if (k != light_index_end) {
-		struct tuple *tuple = light_index_get(&index->hash_table, k);
+	uint32_t h = memtx_hash_index_key_hash(base, key);
+	uint32_t k = hash_table_t::find_key(&index->hash_table, h, key);
+	if (k != hash_table_t::end) {
+		struct tuple *tuple = hash_table_t::get(&index->hash_table, k);
 		*result = memtx_tx_tuple_clarify(txn, space, tuple, base, 0);
 /********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
 		memtx_tx_story_gc();
@@ -357,44 +587,58 @@ memtx_hash_index_get_internal(struct index *base, const char *key,
 	return 0;
 }
 
+template <bool USE_SWISS>
 static int
 memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 			 struct tuple *new_tuple, enum dup_replace_mode mode,
 			 struct tuple **result, struct tuple **successor)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct light_index_core *hash_table = &index->hash_table;
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
+	typename hash_table_t::core *hash_table = &index->hash_table;
 
 	/* HASH index doesn't support ordering. */
 	*successor = NULL;
 
 	if (new_tuple) {
-		uint32_t h = tuple_hash(new_tuple, base->def->key_def);
+		uint32_t h = memtx_hash_index_tuple_hash(base, new_tuple);
 		struct tuple *dup_tuple = NULL;
-		uint32_t pos = light_index_replace(hash_table, h, new_tuple,
-						   &dup_tuple);
-		if (pos == light_index_end)
-			pos = light_index_insert(hash_table, h, new_tuple);
+		uint32_t pos = hash_table_t::replace(hash_table, h, new_tuple,
+						     &dup_tuple);
+		if (pos == hash_table_t::end)
+			pos = hash_table_t::insert(hash_table, h, new_tuple);
 
 		ERROR_INJECT(ERRINJ_HASH_INDEX_REPLACE, {
-			light_index_delete(hash_table, pos);
-			pos = light_index_end;
+			hash_table_t::delete_slot(hash_table, pos);
+			pos = hash_table_t::end;
 		});
 
-		if (pos == light_index_end) {
+		if (pos == hash_table_t::end) {
 			diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
 				 "hash_table", "key");
 			return -1;
 		}
 		if (index_check_dup(base, old_tuple, new_tuple,
 				    dup_tuple, mode) != 0) {
-			light_index_delete(hash_table, pos);
 			if (dup_tuple) {
-				uint32_t pos = light_index_insert(hash_table, h, dup_tuple);
-				if (pos == light_index_end) {
+				/*
+				 * Put the old tuple back in place: unlike
+				 * light, swiss may need to grow on insert.
+				 * The slot has already been touched so this
+				 * can't fail.
+				 */
+				struct tuple *replaced;
+				pos = hash_table_t::replace(hash_table, h,
+							    dup_tuple,
+							    &replaced);
+				if (pos == hash_table_t::end) {
 					panic("Failed to allocate memory in "
 					      "recover of int hash_table");
 				}
+				assert(replaced == new_tuple);
+			} else {
+				hash_table_t::delete_slot(hash_table, pos);
 			}
 			return -1;
 		}
@@ -406,8 +650,8 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 	}
 
 	if (old_tuple) {
-		uint32_t h = tuple_hash(old_tuple, base->def->key_def);
-		int res = light_index_delete_value(hash_table, h, old_tuple);
+		uint32_t h = memtx_hash_index_tuple_hash(base, old_tuple);
+		int res = hash_table_t::delete_value(hash_table, h, old_tuple);
 		assert(res == 0); (void) res;
 	}
 	*result = old_tuple;
@@ -415,12 +659,15 @@ memtx_hash_index_replace(struct index *base, struct tuple *old_tuple,
 }
 
 /** Implementation of create_iterator for memtx hash index. */
+template <bool USE_SWISS>
 static struct iterator *
 memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 				 const char *key, uint32_t part_count,
 				 const char *pos)
 {
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
 
 	assert(part_count == 0 || key != NULL);
@@ -429,17 +676,18 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 		return NULL;
 	}
 
-	struct hash_iterator *it = (struct hash_iterator *)
+	struct hash_iterator<USE_SWISS> *it =
+		(struct hash_iterator<USE_SWISS> *)
 		mempool_alloc(&memtx->iterator_pool);
 	if (it == NULL) {
-		diag_set(OutOfMemory, sizeof(struct hash_iterator),
+		diag_set(OutOfMemory, sizeof(struct hash_iterator<USE_SWISS>),
 			 "memtx_hash_index", "iterator");
 		return NULL;
 	}
 	iterator_create(&it->base, base);
 	it->pool = &memtx->iterator_pool;
-	it->base.free = hash_iterator_free;
-	light_index_iterator_begin(&index->hash_table, &it->iterator);
+	it->base.free = hash_iterator_free<USE_SWISS>;
+	hash_table_t::iterator_begin(&index->hash_table, &it->iterator);
 	struct space *space = index_weak_ref_get_space_checked(
 		&it->base.index_ref);
 	switch (type) {
@@ -454,12 +702,14 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 		}
 
 		if (part_count != 0) {
-			light_index_iterator_key(&index->hash_table, &it->iterator,
-					key_hash(key, base->def->key_def), key);
-			it->base.next_internal = hash_iterator_gt;
+			uint32_t h = memtx_hash_index_key_hash(base, key);
+			hash_table_t::iterator_key(&index->hash_table,
+						   &it->iterator, h, key);
+			it->base.next_internal = hash_iterator_gt<USE_SWISS>;
 		} else {
-			light_index_iterator_begin(&index->hash_table, &it->iterator);
-			it->base.next_internal = hash_iterator_ge;
+			hash_table_t::iterator_begin(&index->hash_table,
+						     &it->iterator);
+			it->base.next_internal = hash_iterator_ge<USE_SWISS>;
 		}
 		/* This iterator needs to be supported as a legacy. */
 /********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
@@ -468,18 +718,18 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 		break;
 	}
 	case ITER_ALL:
-		light_index_iterator_begin(&index->hash_table, &it->iterator);
-		it->base.next_internal = hash_iterator_ge;
+		hash_table_t::iterator_begin(&index->hash_table, &it->iterator);
+		it->base.next_internal = hash_iterator_ge<USE_SWISS>;
 /********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
 		memtx_tx_track_full_scan(in_txn(), space, &index->base);
 /*********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND END**********/
 		break;
 	case ITER_EQ:
 		assert(part_count > 0);
-		light_index_iterator_key(&index->hash_table, &it->iterator,
-				key_hash(key, base->def->key_def), key);
-		it->base.next_internal = hash_iterator_eq;
-		if (it->iterator.slotpos == light_index_end)
+		hash_table_t::iterator_key(&index->hash_table, &it->iterator,
+				memtx_hash_index_key_hash(base, key), key);
+		it->base.next_internal = hash_iterator_eq<USE_SWISS>;
+		if (it->iterator.slotpos == hash_table_t::end)
 /********MVCC TRANSACTION MANAGER STORY GARBAGE COLLECTION BOUND START*********/
 			memtx_tx_track_point(in_txn(), space,
 					     &index->base, key);
@@ -496,71 +746,102 @@ memtx_hash_index_create_iterator(struct index *base, enum iterator_type type,
 	return (struct iterator *)it;
 }
 
+template <bool USE_SWISS>
+static int
+memtx_hash_index_reserve(struct index *base, uint32_t size_hint)
+{
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
+	if (memtx_hash_table<USE_SWISS>::reserve(&index->hash_table,
+						 size_hint) != 0) {
+		diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
+			 "memtx_hash_index", "reserve");
+		return -1;
+	}
+	return 0;
+}
+
 /** Read view implementation. */
+template <bool USE_SWISS>
 struct hash_read_view {
 	/** Base class. */
 	struct index_read_view base;
 	/** Read view index. Ref counter incremented. */
-	struct memtx_hash_index *index;
-	/** Light read view. */
-	struct light_index_view view;
+	struct memtx_hash_index<USE_SWISS> *index;
+	/** Hash table read view. */
+	typename memtx_hash_table<USE_SWISS>::view view;
 	/** Used for clarifying read view tuples. */
 	struct memtx_tx_snapshot_cleaner cleaner;
 };
 
 /** Read view iterator implementation. */
+template <bool USE_SWISS>
 struct hash_read_view_iterator {
 	/** Base class. */
 	struct index_read_view_iterator_base base;
-	/** Light iterator. */
-	struct light_index_iterator iterator;
+	/** Hash table iterator. */
+	typename memtx_hash_table<USE_SWISS>::iterator iterator;
 };
 
-static_assert(sizeof(struct hash_read_view_iterator) <=
+static_assert(sizeof(struct hash_read_view_iterator<false>) <=
+	      INDEX_READ_VIEW_ITERATOR_SIZE,
+	      "sizeof(struct hash_read_view_iterator) must be less than or "
+	      "equal to INDEX_READ_VIEW_ITERATOR_SIZE");
+static_assert(sizeof(struct hash_read_view_iterator<true>) <=
 	      INDEX_READ_VIEW_ITERATOR_SIZE,
 	      "sizeof(struct hash_read_view_iterator) must be less than or "
 	      "equal to INDEX_READ_VIEW_ITERATOR_SIZE");
 
+template <bool USE_SWISS>
 static void
 hash_read_view_free(struct index_read_view *base)
 {
-	struct hash_read_view *rv = (struct hash_read_view *)base;
-	light_index_view_destroy(&rv->view);
+	struct hash_read_view<USE_SWISS> *rv =
+		(struct hash_read_view<USE_SWISS> *)base;
+	memtx_hash_table<USE_SWISS>::view_destroy(&rv->view);
 	index_unref(&rv->index->base);
 	memtx_tx_snapshot_cleaner_destroy(&rv->cleaner);
 	TRASH(rv);
 	free(rv);
 }
 
-#if defined(ENABLE_READ_VIEW)
-# include "memtx_hash_read_view.cc"
-#else /* !defined(ENABLE_READ_VIEW) */
-
+/** Implementation of get_raw index_read_view callback. */
+template <bool USE_SWISS>
 static int
-hash_read_view_get_raw(struct index_read_view *rv,
+hash_read_view_get_raw(struct index_read_view *base,
 		       const char *key, uint32_t part_count,
 		       struct read_view_tuple *result)
 {
-	(void)rv;
-	(void)key;
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	struct hash_read_view<USE_SWISS> *rv =
+		(struct hash_read_view<USE_SWISS> *)base;
+	assert(part_count == base->def->key_def->part_count);
 	(void)part_count;
-	(void)result;
-	unreachable();
-	return 0;
+	uint32_t h = memtx_hash_key_hash(base->def, key);
+	uint32_t slot = hash_table_t::view_find_key(&rv->view, h, key);
+	if (slot == hash_table_t::end) {
+		*result = read_view_tuple_none();
+		return 0;
+	}
+	struct tuple *tuple = hash_table_t::view_get(&rv->view, slot);
+	return memtx_prepare_read_view_tuple(tuple, base, &rv->cleaner,
+					     result);
 }
 
 /** Implementation of next_raw index_read_view_iterator callback. */
+template <bool USE_SWISS>
 static int
 hash_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 				 struct read_view_tuple *result)
 {
-	struct hash_read_view_iterator *it =
-		(struct hash_read_view_iterator *)iterator;
-	struct hash_read_view *rv = (struct hash_read_view *)it->base.index;
+	struct hash_read_view_iterator<USE_SWISS> *it =
+		(struct hash_read_view_iterator<USE_SWISS> *)iterator;
+	struct hash_read_view<USE_SWISS> *rv =
+		(struct hash_read_view<USE_SWISS> *)it->base.index;
 
 	while (true) {
-		struct tuple **res = light_index_view_iterator_get_and_next(
-			&rv->view, &it->iterator);
+		struct tuple **res = memtx_hash_table<USE_SWISS>::
+			view_iterator_get_and_next(&rv->view, &it->iterator);
 		if (res == NULL) {
 			*result = read_view_tuple_none();
 			return 0;
@@ -574,33 +855,95 @@ hash_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 	return 0;
 }
 
+/**
+ * Implementation of next_raw index_read_view_iterator callback
+ * for EQ iterators: returns at most one tuple. Only the slot found
+ * by the key is checked: if its tuple isn't visible in the read view,
+ * there's no matching tuple, while the following slots store tuples
+ * with other keys.
+ */
+template <bool USE_SWISS>
+static int
+hash_read_view_iterator_eq_next_raw(struct index_read_view_iterator *iterator,
+				    struct read_view_tuple *result)
+{
+	struct hash_read_view_iterator<USE_SWISS> *it =
+		(struct hash_read_view_iterator<USE_SWISS> *)iterator;
+	struct hash_read_view<USE_SWISS> *rv =
+		(struct hash_read_view<USE_SWISS> *)it->base.index;
+	iterator->base.next_raw = exhausted_index_read_view_iterator_next_raw;
+	struct tuple **res = memtx_hash_table<USE_SWISS>::
+		view_iterator_get_and_next(&rv->view, &it->iterator);
+	if (res == NULL) {
+		*result = read_view_tuple_none();
+		return 0;
+	}
+	return memtx_prepare_read_view_tuple(*res, &rv->base, &rv->cleaner,
+					     result);
+}
+
 /** Positions the iterator to the given key. */
+template <bool USE_SWISS>
 static int
-hash_read_view_iterator_start(struct hash_read_view_iterator *it,
+hash_read_view_iterator_start(struct hash_read_view_iterator<USE_SWISS> *it,
 			      enum iterator_type type,
 			      const char *key, uint32_t part_count)
 {
-	assert(type == ITER_ALL);
-	assert(key == NULL);
-	assert(part_count == 0);
-	(void)type;
-	(void)key;
-	(void)part_count;
-	struct hash_read_view *rv = (struct hash_read_view *)it->base.index;
-	it->base.next_raw = hash_read_view_iterator_next_raw;
-	light_index_view_iterator_begin(&rv->view, &it->iterator);
+	using hash_table_t = memtx_hash_table<USE_SWISS>;
+	struct hash_read_view<USE_SWISS> *rv =
+		(struct hash_read_view<USE_SWISS> *)it->base.index;
+	struct index_def *def = rv->base.def;
+	assert(part_count == 0 || key != NULL);
+	if (type == ITER_EQ && part_count == 0)
+		type = ITER_ALL;
+	switch (type) {
+	case ITER_ALL:
+		hash_table_t::view_iterator_begin(&rv->view, &it->iterator);
+		it->base.next_raw = hash_read_view_iterator_next_raw<USE_SWISS>;
+		break;
+	case ITER_GT:
+		if (part_count == 0) {
+			hash_table_t::view_iterator_begin(&rv->view,
+							  &it->iterator);
+		} else {
+			/* Skip the tuple matching the key. */
+			hash_table_t::view_iterator_key(
+				&rv->view, &it->iterator,
+				memtx_hash_key_hash(def, key), key);
+			hash_table_t::view_iterator_get_and_next(
+				&rv->view, &it->iterator);
+		}
+		it->base.next_raw = hash_read_view_iterator_next_raw<USE_SWISS>;
+		break;
+	case ITER_EQ:
+		hash_table_t::view_iterator_key(&rv->view, &it->iterator,
+						memtx_hash_key_hash(def, key),
+						key);
+		it->base.next_raw =
+			hash_read_view_iterator_eq_next_raw<USE_SWISS>;
+		break;
+	default:
+		diag_set(UnsupportedIndexFeature, def,
+			 "requested iterator type");
+		return -1;
+	}
 	return 0;
 }
 
+/**
+ * Sets the key definition used by the hash table read view for lookups.
+ * The index definition may be altered while the read view is open so
+ * we use the copy stored in the read view.
+ */
+template <bool USE_SWISS>
 static void
-hash_read_view_reset_key_def(struct hash_read_view *rv)
+hash_read_view_reset_key_def(struct hash_read_view<USE_SWISS> *rv)
 {
-	rv->view.common.arg = NULL;
+	rv->view.common.arg = rv->base.def->key_def;
 }
 
-#endif /* !defined(ENABLE_READ_VIEW) */
-
 /** Implementation of create_iterator index_read_view callback. */
+template <bool USE_SWISS>
 static int
 hash_read_view_create_iterator(struct index_read_view *base,
 			       enum iterator_type type,
@@ -612,83 +955,104 @@ hash_read_view_create_iterator(struct index_read_view *base,
 		diag_set(UnsupportedIndexFeature, base->def, "pagination");
 		return -1;
 	}
-	struct hash_read_view *rv = (struct hash_read_view *)base;
-	struct hash_read_view_iterator *it =
-		(struct hash_read_view_iterator *)iterator;
+	struct hash_read_view<USE_SWISS> *rv =
+		(struct hash_read_view<USE_SWISS> *)base;
+	struct hash_read_view_iterator<USE_SWISS> *it =
+		(struct hash_read_view_iterator<USE_SWISS> *)iterator;
 	it->base.index = base;
 	it->base.destroy = generic_index_read_view_iterator_destroy;
 	it->base.next_raw = exhausted_index_read_view_iterator_next_raw;
 	it->base.position = generic_index_read_view_iterator_position;
-	light_index_view_iterator_begin(&rv->view, &it->iterator);
+	memtx_hash_table<USE_SWISS>::view_iterator_begin(&rv->view,
+							 &it->iterator);
 	return hash_read_view_iterator_start(it, type, key, part_count);
 }
 
 /** Implementation of create_read_view index callback. */
+template <bool USE_SWISS>
 static struct index_read_view *
 memtx_hash_index_create_read_view(struct index *base)
 {
 	static const struct index_read_view_vtab vtab = {
-		.free = hash_read_view_free,
-		.get_raw = hash_read_view_get_raw,
-		.create_iterator = hash_read_view_create_iterator,
+		.free = hash_read_view_free<USE_SWISS>,
+		.get_raw = hash_read_view_get_raw<USE_SWISS>,
+		.create_iterator = hash_read_view_create_iterator<USE_SWISS>,
 	};
-	struct memtx_hash_index *index = (struct memtx_hash_index *)base;
-	struct hash_read_view *rv =
-		(struct hash_read_view *)xmalloc(sizeof(*rv));
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)base;
+	struct hash_read_view<USE_SWISS> *rv =
+		(struct hash_read_view<USE_SWISS> *)xmalloc(sizeof(*rv));
 	index_read_view_create(&rv->base, &vtab, base->def);
 	struct space *space = space_by_id(base->def->space_id);
 	assert(space != NULL);
 	memtx_tx_snapshot_cleaner_create(&rv->cleaner, space);
 	rv->index = index;
 	index_ref(base);
-	light_index_view_create(&rv->view, &index->hash_table);
+	memtx_hash_table<USE_SWISS>::view_create(&rv->view, &index->hash_table);
 	hash_read_view_reset_key_def(rv);
 	return (struct index_read_view *)rv;
 }
 
-static const struct index_vtab memtx_hash_index_vtab = {
-	/* .destroy = */ memtx_hash_index_destroy,
-	/* .commit_create = */ generic_index_commit_create,
-	/* .abort_create = */ generic_index_abort_create,
-	/* .commit_modify = */ generic_index_commit_modify,
-	/* .commit_drop = */ generic_index_commit_drop,
-	/* .update_def = */ memtx_hash_index_update_def,
-	/* .depends_on_pk = */ generic_index_depends_on_pk,
-	/* .def_change_requires_rebuild = */
-		memtx_index_def_change_requires_rebuild,
-	/* .size = */ memtx_hash_index_size,
-	/* .bsize = */ memtx_hash_index_bsize,
-	/* .min = */ generic_index_min,
-	/* .max = */ generic_index_max,
-	/* .random = */ memtx_hash_index_random,
-	/* .count = */ memtx_hash_index_count,
-	/* .get_internal = */ memtx_hash_index_get_internal,
-	/* .get = */ memtx_index_get,
-	/* .replace = */ memtx_hash_index_replace,
-	/* .create_iterator = */ memtx_hash_index_create_iterator,
-	/* .create_read_view = */ memtx_hash_index_create_read_view,
-	/* .stat = */ generic_index_stat,
-	/* .compact = */ generic_index_compact,
-	/* .reset_stat = */ generic_index_reset_stat,
-	/* .begin_build = */ generic_index_begin_build,
-	/* .reserve = */ generic_index_reserve,
-	/* .build_next = */ generic_index_build_next,
-	/* .end_build = */ generic_index_end_build,
-};
+template <bool USE_SWISS>
+static const struct index_vtab *
+get_memtx_hash_index_vtab(void)
+{
+	static const struct index_vtab vtab = {
+		/* .destroy = */ memtx_hash_index_destroy<USE_SWISS>,
+		/* .commit_create = */ generic_index_commit_create,
+		/* .abort_create = */ generic_index_abort_create,
+		/* .commit_modify = */ generic_index_commit_modify,
+		/* .commit_drop = */ generic_index_commit_drop,
+		/* .update_def = */ memtx_hash_index_update_def<USE_SWISS>,
+		/* .depends_on_pk = */ generic_index_depends_on_pk,
+		/* .def_change_requires_rebuild = */
+			memtx_index_def_change_requires_rebuild,
+		/* .size = */ memtx_hash_index_size<USE_SWISS>,
+		/* .bsize = */ memtx_hash_index_bsize<USE_SWISS>,
+		/* .min = */ generic_index_min,
+		/* .max = */ generic_index_max,
+		/* .random = */ memtx_hash_index_random<USE_SWISS>,
+		/* .count = */ memtx_hash_index_count<USE_SWISS>,
+		/* .get_internal = */
+			memtx_hash_index_get_internal<USE_SWISS>,
+		/* .get = */ memtx_index_get,
+		/* .replace = */ memtx_hash_index_replace<USE_SWISS>,
+		/* .create_iterator = */
+			memtx_hash_index_create_iterator<USE_SWISS>,
+		/* .create_read_view = */
+			memtx_hash_index_create_read_view<USE_SWISS>,
+		/* .stat = */ generic_index_stat,
+		/* .compact = */ generic_index_compact,
+		/* .reset_stat = */ generic_index_reset_stat,
+		/* .begin_build = */ generic_index_begin_build,
+		/* .reserve = */ memtx_hash_index_reserve<USE_SWISS>,
+		/* .build_next = */ generic_index_build_next,
+		/* .end_build = */ generic_index_end_build,
+	};
+	return &vtab;
+}
 
-struct index *
-memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
+template <bool USE_SWISS>
+static struct index *
+memtx_hash_index_new_tpl(struct memtx_engine *memtx, struct index_def *def)
 {
-	struct memtx_hash_index *index =
-		(struct memtx_hash_index *)xcalloc(1, sizeof(*index));
+	struct memtx_hash_index<USE_SWISS> *index =
+		(struct memtx_hash_index<USE_SWISS> *)
+		xcalloc(1, sizeof(*index));
 	index_create(&index->base, (struct engine *)memtx,
-		     &memtx_hash_index_vtab, def);
+		     get_memtx_hash_index_vtab<USE_SWISS>(), def);
 
-	light_index_create(&index->hash_table, index->base.def->key_def,
-			   MEMTX_EXTENT_SIZE, memtx_index_extent_alloc,
-			   memtx_index_extent_free, memtx,
-			   &memtx->index_extent_stats);
+	memtx_hash_table<USE_SWISS>::create(&index->hash_table,
+					    index->base.def->key_def, memtx);
 	return &index->base;
 }
 
+struct index *
+memtx_hash_index_new(struct memtx_engine *memtx, struct index_def *def)
+{
+	if (def->opts.layout == INDEX_HASH_LAYOUT_SWISS)
+		return memtx_hash_index_new_tpl<true>(memtx, def);
+	return memtx_hash_index_new_tpl<false>(memtx, def);
+}
+
 /* }}} */
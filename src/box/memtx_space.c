@@ -89,6 +89,8 @@ memtx_space_update_tuple_stat(struct space *space, struct tuple *old_tuple,
 	struct memtx_space *memtx_space = (struct memtx_space *)space;
 	struct tuple_info info, *stat;
 
+	memtx_space->is_dirty = true;
+
 	if (new_tuple != NULL) {
 		tuple_info(new_tuple, &info);
 
@@ -884,6 +886,43 @@ memtx_space_check_index_def(struct space *space, struct index_def *index_def)
 			 "hint is only reasonable with memtx tree index");
 		return -1;
 	}
+	if (index_def->type != HASH &&
+	    index_def->opts.layout != INDEX_HASH_LAYOUT_CHAINED) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "layout is only reasonable with memtx hash index");
+		return -1;
+	}
+	if (index_def->type != HASH &&
+	    index_def->opts.hash_func != INDEX_HASH_FUNC_MURMUR) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hash_func is only reasonable with memtx hash index");
+		return -1;
+	}
+	if (index_def->type != TREE && index_def->opts.hint_parts != 1) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hint_parts is only reasonable with memtx tree index");
+		return -1;
+	}
+	if (index_def->opts.key_prefix) {
+		const char *err = NULL;
+		if (index_def->type != TREE)
+			err = "key_prefix is only reasonable with memtx "
+			      "tree index";
+		else if (key_def->is_multikey)
+			err = "multikey index can't use key_prefix";
+		else if (key_def->for_func_index)
+			err = "functional index can't use key_prefix";
+		else if (index_def->opts.hint == INDEX_HINT_OFF)
+			err = "key_prefix can't be used without hint";
+		if (err != NULL) {
+			diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+				 space_name(space), err);
+			return -1;
+		}
+	}
 
 	/* Only HASH and TREE indexes check parts there. */
 	if (index_def_check_field_types(index_def, space_name(space)) != 0)
@@ -1519,5 +1558,6 @@ memtx_space_new(struct memtx_engine *memtx,
 	memset(&memtx_space->tuple_stat, 0, sizeof(memtx_space->tuple_stat));
 	memtx_space->rowid = 0;
 	memtx_space->replace = memtx_space_replace_no_keys;
+	memtx_space->is_dirty = true;
 	return (struct space *)memtx_space;
 }
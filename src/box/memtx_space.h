@@ -62,6 +62,12 @@ struct memtx_space {
 	 */
 	int (*replace)(struct space *, struct tuple *, struct tuple *,
 		       enum dup_replace_mode, struct tuple **);
+	/**
+	 * Set if the space data may have changed since the last
+	 * checkpoint. Spaces that haven't changed are not written
+	 * to delta snapshots.
+	 */
+	bool is_dirty;
 };
 
 /**
@@ -43,8 +43,28 @@
 #include "trivia/config.h"
 #include "trivia/util.h"
 #include "tt_sort.h"
+#include "key_normalize.h"
 #include <small/mempool.h>
 
+/**
+ * Kinds of memtx tree elements, used as the USE_HINT template argument.
+ * Any value but MEMTX_TREE_NO_HINT means that the elements have hints.
+ */
+enum {
+	/** Elements only point to tuples. */
+	MEMTX_TREE_NO_HINT = 0,
+	/** Elements store comparison hints, see tuple_hint(). */
+	MEMTX_TREE_HINT = 1,
+	/**
+	 * Elements store comparison hints and prefixes of normalized
+	 * keys, see the key_prefix index option and key_normalize.h.
+	 */
+	MEMTX_TREE_KEY_PREFIX = 2,
+};
+
+/** Max size of a normalized key prefix stored in a tree element. */
+enum { MEMTX_TREE_KEY_PREFIX_SIZE = 15 };
+
 /**
  * Struct that is used as a key in BPS tree definition.
  */
@@ -53,9 +73,11 @@ struct memtx_tree_key_data_common {
 	const char *key;
 	/** Number of msgpacked search fields. */
 	uint32_t part_count;
+	void set_prefix(struct key_def *) {}
+	void clear_prefix() {}
 };
 
-template <bool USE_HINT>
+template <int USE_HINT>
 struct memtx_tree_key_data;
 
 template <>
@@ -71,15 +93,47 @@ struct memtx_tree_key_data<true> : memtx_tree_key_data_common {
 	void set_hint(hint_t h) { hint = h; }
 };
 
+template <>
+struct memtx_tree_key_data<MEMTX_TREE_KEY_PREFIX> :
+	memtx_tree_key_data<true> {
+	/** Prefix of the normalized key. */
+	char prefix[MEMTX_TREE_KEY_PREFIX_SIZE];
+	/** Size of the prefix, 0 if the prefix is unknown. */
+	uint8_t prefix_len;
+	/**
+	 * Normalize the key with the given key definition and store
+	 * the prefix. Parts beyond the key definition are ignored.
+	 */
+	void set_prefix(struct key_def *key_def)
+	{
+		struct region *region = &fiber()->gc;
+		size_t region_svp = region_used(region);
+		uint32_t size;
+		const char *nkey = key_normalize(key, MIN(part_count,
+							  key_def->part_count),
+						 key_def, region, &size);
+		prefix_len = 0;
+		if (nkey != NULL) {
+			prefix_len = MIN(size, sizeof(prefix));
+			memcpy(prefix, nkey, prefix_len);
+		}
+		region_truncate(region, region_svp);
+	}
+	void clear_prefix() { prefix_len = 0; }
+};
+
 /**
  * Struct that is used as a elem in BPS tree definition.
  */
 struct memtx_tree_data_common {
 	/* Tuple that this node is represents. */
 	struct tuple *tuple;
+	void set_prefix(struct key_def *) {}
+	void copy_prefix(const struct memtx_tree_data_common *) {}
+	void clear_prefix() {}
 };
 
-template <bool USE_HINT>
+template <int USE_HINT>
 struct memtx_tree_data;
 
 template <>
@@ -95,6 +149,112 @@ struct memtx_tree_data<true> :  memtx_tree_data<false> {
 	void set_hint(hint_t h) { hint = h; }
 };
 
+/**
+ * Element of a tree that stores a prefix of the normalized key of
+ * the tuple next to the tuple pointer, so that most comparisons made
+ * on descent are resolved with memcmp() without touching the tuple.
+ * The prefix is computed with the index key definition, so that it
+ * stays valid if the tree switches between key_def and cmp_def, see
+ * memtx_tree_index_update_def(). Elements without a prefix (e.g. the
+ * last tuple fetched by an iterator) are compared with the tuple
+ * comparator.
+ */
+template <>
+struct memtx_tree_data<MEMTX_TREE_KEY_PREFIX> : memtx_tree_data<true> {
+	/** Prefix of the normalized key of the tuple. */
+	char prefix[MEMTX_TREE_KEY_PREFIX_SIZE];
+	/** Size of the prefix, 0 if the prefix is unknown. */
+	uint8_t prefix_len;
+	/** Normalize the tuple key and store the prefix. */
+	void set_prefix(struct key_def *key_def)
+	{
+		struct region *region = &fiber()->gc;
+		size_t region_svp = region_used(region);
+		uint32_t size;
+		const char *nkey = tuple_normalize_key(tuple, key_def,
+						       MULTIKEY_NONE, region,
+						       &size);
+		prefix_len = 0;
+		if (nkey != NULL) {
+			prefix_len = MIN(size, sizeof(prefix));
+			memcpy(prefix, nkey, prefix_len);
+		}
+		region_truncate(region, region_svp);
+	}
+	void copy_prefix(const struct memtx_tree_data *other)
+	{
+		prefix_len = other->prefix_len;
+		memcpy(prefix, other->prefix, prefix_len);
+	}
+	void clear_prefix() { prefix_len = 0; }
+};
+
+static_assert(sizeof(struct memtx_tree_data<MEMTX_TREE_KEY_PREFIX>) == 32,
+	      "memtx tree element with a key prefix must be 32 bytes");
+
+/** Compare two tree elements. */
+template <int USE_HINT>
+static inline int
+memtx_tree_data_compare(const struct memtx_tree_data<USE_HINT> *a,
+			const struct memtx_tree_data<USE_HINT> *b,
+			struct key_def *cmp_def)
+{
+	return tuple_compare(a->tuple, a->hint, b->tuple, b->hint, cmp_def);
+}
+
+/** Compare a tree element with a key. */
+template <int USE_HINT>
+static inline int
+memtx_tree_data_compare_with_key(const struct memtx_tree_data<USE_HINT> *a,
+				 const struct memtx_tree_key_data<USE_HINT> *b,
+				 struct key_def *cmp_def)
+{
+	return tuple_compare_with_key(a->tuple, a->hint, b->key,
+				      b->part_count, b->hint, cmp_def);
+}
+
+/**
+ * Normalized keys are ordered like the tuples, so if the known parts
+ * of the prefixes differ, they define the order. Otherwise the tuples
+ * are compared as usual.
+ */
+template <>
+inline int
+memtx_tree_data_compare<MEMTX_TREE_KEY_PREFIX>(
+	const struct memtx_tree_data<MEMTX_TREE_KEY_PREFIX> *a,
+	const struct memtx_tree_data<MEMTX_TREE_KEY_PREFIX> *b,
+	struct key_def *cmp_def)
+{
+	uint32_t len = MIN(a->prefix_len, b->prefix_len);
+	if (len > 0) {
+		int rc = memcmp(a->prefix, b->prefix, len);
+		if (rc != 0)
+			return rc;
+	}
+	return tuple_compare(a->tuple, a->hint, b->tuple, b->hint, cmp_def);
+}
+
+/**
+ * The normalized partial key is a prefix of the normalized keys of
+ * the matching tuples, so the key prefix is compared the same way.
+ */
+template <>
+inline int
+memtx_tree_data_compare_with_key<MEMTX_TREE_KEY_PREFIX>(
+	const struct memtx_tree_data<MEMTX_TREE_KEY_PREFIX> *a,
+	const struct memtx_tree_key_data<MEMTX_TREE_KEY_PREFIX> *b,
+	struct key_def *cmp_def)
+{
+	uint32_t len = MIN(a->prefix_len, b->prefix_len);
+	if (len > 0) {
+		int rc = memcmp(a->prefix, b->prefix, len);
+		if (rc != 0)
+			return rc;
+	}
+	return tuple_compare_with_key(a->tuple, a->hint, b->key,
+				      b->part_count, b->hint, cmp_def);
+}
+
 /**
  * Test whether BPS tree elements are identical i.e. represent
  * the same tuple at the same position in the tree.
@@ -114,11 +274,9 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #define BPS_TREE_NAME memtx_tree
 #define BPS_TREE_BLOCK_SIZE (512)
 #define BPS_TREE_EXTENT_SIZE MEMTX_EXTENT_SIZE
-#define BPS_TREE_COMPARE(a, b, arg)\
-	tuple_compare((&a)->tuple, (&a)->hint, (&b)->tuple, (&b)->hint, arg)
+#define BPS_TREE_COMPARE(a, b, arg) memtx_tree_data_compare(&a, &b, arg)
 #define BPS_TREE_COMPARE_KEY(a, b, arg)\
-	tuple_compare_with_key((&a)->tuple, (&a)->hint, (b)->key,\
-			       (b)->part_count, (b)->hint, arg)
+	memtx_tree_data_compare_with_key(&a, b, arg)
 #define BPS_TREE_IS_IDENTICAL(a, b) memtx_tree_data_is_equal(&a, &b)
 #define BPS_TREE_NO_DEBUG 1
 #define bps_tree_arg_t struct key_def *
@@ -143,6 +301,16 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
 
+#define BPS_TREE_NAMESPACE NS_USE_KEY_PREFIX
+#define bps_tree_elem_t struct memtx_tree_data<MEMTX_TREE_KEY_PREFIX>
+#define bps_tree_key_t struct memtx_tree_key_data<MEMTX_TREE_KEY_PREFIX> *
+
+#include "salad/bps_tree.h"
+
+#undef BPS_TREE_NAMESPACE
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+
 #undef BPS_TREE_NAME
 #undef BPS_TREE_BLOCK_SIZE
 #undef BPS_TREE_EXTENT_SIZE
@@ -154,8 +322,9 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 
 using namespace NS_NO_HINT;
 using namespace NS_USE_HINT;
+using namespace NS_USE_KEY_PREFIX;
 
-template <bool USE_HINT>
+template <int USE_HINT>
 struct memtx_tree_selector;
 
 template <>
@@ -164,10 +333,14 @@ struct memtx_tree_selector<false> : NS_NO_HINT::memtx_tree {};
 template <>
 struct memtx_tree_selector<true> : NS_USE_HINT::memtx_tree {};
 
-template <bool USE_HINT>
+template <>
+struct memtx_tree_selector<MEMTX_TREE_KEY_PREFIX> :
+	NS_USE_KEY_PREFIX::memtx_tree {};
+
+template <int USE_HINT>
 using memtx_tree_t = struct memtx_tree_selector<USE_HINT>;
 
-template <bool USE_HINT>
+template <int USE_HINT>
 struct memtx_tree_view_selector;
 
 template <>
@@ -176,10 +349,14 @@ struct memtx_tree_view_selector<false> : NS_NO_HINT::memtx_tree_view {};
 template <>
 struct memtx_tree_view_selector<true> : NS_USE_HINT::memtx_tree_view {};
 
-template <bool USE_HINT>
+template <>
+struct memtx_tree_view_selector<MEMTX_TREE_KEY_PREFIX> :
+	NS_USE_KEY_PREFIX::memtx_tree_view {};
+
+template <int USE_HINT>
 using memtx_tree_view_t = struct memtx_tree_view_selector<USE_HINT>;
 
-template <bool USE_HINT>
+template <int USE_HINT>
 struct memtx_tree_iterator_selector;
 
 template <>
@@ -192,7 +369,12 @@ struct memtx_tree_iterator_selector<true> {
 	using type = NS_USE_HINT::memtx_tree_iterator;
 };
 
-template <bool USE_HINT>
+template <>
+struct memtx_tree_iterator_selector<MEMTX_TREE_KEY_PREFIX> {
+	using type = NS_USE_KEY_PREFIX::memtx_tree_iterator;
+};
+
+template <int USE_HINT>
 using memtx_tree_iterator_t = typename memtx_tree_iterator_selector<USE_HINT>::type;
 
 static void
@@ -207,7 +389,13 @@ invalidate_tree_iterator(NS_USE_HINT::memtx_tree_iterator *itr)
 	*itr = NS_USE_HINT::memtx_tree_invalid_iterator();
 }
 
-template <bool USE_HINT>
+static void
+invalidate_tree_iterator(NS_USE_KEY_PREFIX::memtx_tree_iterator *itr)
+{
+	*itr = NS_USE_KEY_PREFIX::memtx_tree_invalid_iterator();
+}
+
+template <int USE_HINT>
 struct memtx_tree_index {
 	struct index base;
 	memtx_tree_t<USE_HINT> tree;
@@ -272,7 +460,7 @@ memtx_tree_cmp_def(TREE *tree)
 	return tree->common.arg;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 memtx_tree_qcompare(const void* a, const void *b, void *c)
 {
@@ -281,12 +469,11 @@ memtx_tree_qcompare(const void* a, const void *b, void *c)
 	const struct memtx_tree_data<USE_HINT> *data_b =
 		(struct memtx_tree_data<USE_HINT> *)b;
 	struct key_def *key_def = (struct key_def *)c;
-	return tuple_compare(data_a->tuple, data_a->hint, data_b->tuple,
-			     data_b->hint, key_def);
+	return memtx_tree_data_compare(data_a, data_b, key_def);
 }
 
 /* {{{ MemtxTree Iterators ****************************************/
-template <bool USE_HINT>
+template <int USE_HINT>
 struct tree_iterator {
 	struct iterator base;
 
@@ -340,9 +527,13 @@ static_assert(sizeof(struct tree_iterator<false>) <= MEMTX_ITERATOR_SIZE,
 static_assert(sizeof(struct tree_iterator<true>) <= MEMTX_ITERATOR_SIZE,
 	      "sizeof(struct tree_iterator<true>) must be less than or equal "
 	      "to MEMTX_ITERATOR_SIZE");
+static_assert(sizeof(struct tree_iterator<MEMTX_TREE_KEY_PREFIX>) <=
+	      MEMTX_ITERATOR_SIZE,
+	      "sizeof(struct tree_iterator<MEMTX_TREE_KEY_PREFIX>) must be "
+	      "less than or equal to MEMTX_ITERATOR_SIZE");
 
 /** Set last fetched tuple. */
-template <bool USE_HINT>
+template <int USE_HINT>
 static inline void
 tree_iterator_set_last_tuple(struct tree_iterator<USE_HINT> *it,
 			     struct tuple *tuple)
@@ -355,7 +546,7 @@ tree_iterator_set_last_tuple(struct tree_iterator<USE_HINT> *it,
 }
 
 /** Set hint of last fetched tuple. */
-template <bool USE_HINT>
+template <int USE_HINT>
 static inline void
 tree_iterator_set_last_hint(struct tree_iterator<USE_HINT> *it, hint_t hint)
 {
@@ -379,7 +570,7 @@ tree_iterator_set_last_hint(struct tree_iterator<USE_HINT> *it, hint_t hint)
  * Prerequisites: last is not NULL and last->tuple is not NULL.
  * Use set_last_tuple and set_last_hint manually to free occupied resources.
  */
-template <bool USE_HINT>
+template <int USE_HINT>
 static inline void
 tree_iterator_set_last(struct tree_iterator<USE_HINT> *it,
 		       struct memtx_tree_data<USE_HINT> *last)
@@ -387,13 +578,14 @@ tree_iterator_set_last(struct tree_iterator<USE_HINT> *it,
 	assert(last != NULL && last->tuple != NULL);
 	tree_iterator_set_last_tuple(it, last->tuple);
 	tree_iterator_set_last_hint(it, last->hint);
+	it->last.copy_prefix(last);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 tree_iterator_free(struct iterator *iterator);
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static inline struct tree_iterator<USE_HINT> *
 get_tree_iterator(struct iterator *it)
 {
@@ -401,7 +593,7 @@ get_tree_iterator(struct iterator *it)
 	return (struct tree_iterator<USE_HINT> *) it;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 tree_iterator_free(struct iterator *iterator)
 {
@@ -417,7 +609,7 @@ tree_iterator_free(struct iterator *iterator)
  * If the iterator's underlying tuple does not match its last tuple, it needs
  * to be repositioned.
  */
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 tree_iterator_prev_reposition(struct tree_iterator<USE_HINT> *iterator,
 			      struct memtx_tree_index<USE_HINT> *index)
@@ -440,7 +632,7 @@ tree_iterator_prev_reposition(struct tree_iterator<USE_HINT> *iterator,
 	assert(exact || in_txn() == NULL || !memtx_tx_manager_use_mvcc_engine);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 tree_iterator_next_base(struct iterator *iterator, struct tuple **ret)
 {
@@ -485,7 +677,7 @@ tree_iterator_next_base(struct iterator *iterator, struct tuple **ret)
 	return 0;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 tree_iterator_prev_base(struct iterator *iterator, struct tuple **ret)
 {
@@ -533,7 +725,7 @@ tree_iterator_prev_base(struct iterator *iterator, struct tuple **ret)
 	return 0;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 tree_iterator_next_equal_base(struct iterator *iterator, struct tuple **ret)
 {
@@ -594,7 +786,7 @@ tree_iterator_next_equal_base(struct iterator *iterator, struct tuple **ret)
 	return 0;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 tree_iterator_prev_equal_base(struct iterator *iterator, struct tuple **ret)
 {
@@ -658,7 +850,7 @@ tree_iterator_prev_equal_base(struct iterator *iterator, struct tuple **ret)
 }
 
 #define WRAP_ITERATOR_METHOD(name)						\
-template <bool USE_HINT>							\
+template <int USE_HINT>							\
 static int									\
 name(struct iterator *iterator, struct tuple **ret)				\
 {										\
@@ -679,7 +871,7 @@ WRAP_ITERATOR_METHOD(tree_iterator_prev_equal);
 
 #undef WRAP_ITERATOR_METHOD
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 tree_iterator_set_next_method(struct tree_iterator<USE_HINT> *it)
 {
@@ -718,7 +910,7 @@ tree_iterator_set_next_method(struct tree_iterator<USE_HINT> *it)
  * @retval true if @a start_data and @a type are ready for search.
  * @retval false if the iteration must be stopped without an error.
  */
-template <bool USE_HINT>
+template <int USE_HINT>
 static bool
 prepare_start_prefix_iterator(struct memtx_tree_key_data<USE_HINT> *start_data,
 			      enum iterator_type *type, struct key_def *cmp_def,
@@ -770,6 +962,7 @@ prepare_start_prefix_iterator(struct memtx_tree_key_data<USE_HINT> *start_data,
 	if (USE_HINT)
 		start_data->set_hint(key_hint(start_data->key,
 					      start_data->part_count, cmp_def));
+	start_data->clear_prefix();
 	return true;
 }
 
@@ -792,7 +985,7 @@ prepare_start_prefix_iterator(struct memtx_tree_key_data<USE_HINT> *start_data,
  * @retval true on success;
  * @retval false if the iteration must be stopped without an error.
  */
-template<bool USE_HINT>
+template<int USE_HINT>
 static bool
 memtx_tree_lookup(memtx_tree_t<USE_HINT> *tree,
 		  struct memtx_tree_key_data<USE_HINT> *start_data,
@@ -893,7 +1086,7 @@ memtx_tree_lookup(memtx_tree_t<USE_HINT> *tree,
 	return true;
 }
 
-template<bool USE_HINT>
+template<int USE_HINT>
 static int
 tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 {
@@ -996,7 +1189,7 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 
 /* {{{ MemtxTree  **********************************************************/
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_free(struct memtx_tree_index<USE_HINT> *index)
 {
@@ -1005,7 +1198,7 @@ memtx_tree_index_free(struct memtx_tree_index<USE_HINT> *index)
 	free(index);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_gc_run(struct memtx_gc_task *task, bool *done)
 {
@@ -1042,7 +1235,7 @@ memtx_tree_index_gc_run(struct memtx_gc_task *task, bool *done)
 	*done = true;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_gc_free(struct memtx_gc_task *task)
 {
@@ -1051,7 +1244,7 @@ memtx_tree_index_gc_free(struct memtx_gc_task *task)
 	memtx_tree_index_free(index);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static struct memtx_gc_task_vtab * get_memtx_tree_index_gc_vtab()
 {
 	static memtx_gc_task_vtab tab =
@@ -1062,7 +1255,7 @@ static struct memtx_gc_task_vtab * get_memtx_tree_index_gc_vtab()
 	return &tab;
 };
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_destroy(struct index *base)
 {
@@ -1091,7 +1284,7 @@ memtx_tree_index_destroy(struct index *base)
 	}
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_update_def(struct index *base)
 {
@@ -1117,7 +1310,7 @@ memtx_tree_index_depends_on_pk(struct index *base)
 	return !def->opts.is_unique || def->key_def->is_nullable;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static ssize_t
 memtx_tree_index_size(struct index *base)
 {
@@ -1129,7 +1322,7 @@ memtx_tree_index_size(struct index *base)
 	       memtx_tx_index_invisible_count(in_txn(), space, base);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static ssize_t
 memtx_tree_index_bsize(struct index *base)
 {
@@ -1138,7 +1331,7 @@ memtx_tree_index_bsize(struct index *base)
 	return memtx_tree_mem_used(&index->tree);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 memtx_tree_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 {
@@ -1167,12 +1360,13 @@ memtx_tree_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 	return memtx_prepare_result_tuple(space, result);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static ssize_t
 memtx_tree_index_count(struct index *base, enum iterator_type type,
 		       const char *key, uint32_t part_count)
 {
-	assert((base->def->opts.hint == INDEX_HINT_ON) == USE_HINT);
+	assert((base->def->opts.hint == INDEX_HINT_ON) ==
+	       (USE_HINT != MEMTX_TREE_NO_HINT));
 
 	struct region *region = &fiber()->gc;
 	RegionGuard region_guard(region);
@@ -1190,6 +1384,7 @@ memtx_tree_index_count(struct index *base, enum iterator_type type,
 	start_data.part_count = part_count;
 	if (USE_HINT)
 		start_data.set_hint(key_hint(key, part_count, cmp_def));
+	start_data.set_prefix(base->def->key_def);
 	struct memtx_tree_key_data<USE_HINT> null_after_data = {};
 	memtx_tree_iterator_t<USE_HINT> unused;
 	size_t begin_offset;
@@ -1288,7 +1483,7 @@ memtx_tree_index_count(struct index *base, enum iterator_type type,
 	return full_count - invisible_count;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 memtx_tree_index_get_internal(struct index *base, const char *key,
 			      uint32_t part_count, struct tuple **result)
@@ -1305,6 +1500,7 @@ memtx_tree_index_get_internal(struct index *base, const char *key,
 	key_data.part_count = part_count;
 	if (USE_HINT)
 		key_data.set_hint(key_hint(key, part_count, cmp_def));
+	key_data.set_prefix(base->def->key_def);
 	struct memtx_tree_data<USE_HINT> *res =
 		memtx_tree_find(&index->tree, &key_data);
 	if (res == NULL) {
@@ -1328,7 +1524,7 @@ memtx_tree_index_get_internal(struct index *base, const char *key,
 /**
  * Implementation of iterator position for general and multikey indexes.
  */
-template <bool USE_HINT, bool IS_MULTIKEY>
+template <int USE_HINT, bool IS_MULTIKEY>
 static inline int
 tree_iterator_position_impl(struct memtx_tree_data<USE_HINT> *last,
 			    struct index_def *def,
@@ -1355,7 +1551,7 @@ tree_iterator_position_impl(struct memtx_tree_data<USE_HINT> *last,
 /**
  * Implementation of iterator position for general and multikey indexes.
  */
-template <bool USE_HINT, bool IS_MULTIKEY>
+template <int USE_HINT, bool IS_MULTIKEY>
 static int
 tree_iterator_position(struct iterator *it, const char **pos, uint32_t *size)
 {
@@ -1428,7 +1624,7 @@ tree_iterator_position_func(struct iterator *it, const char **pos,
 						pos, size);
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 			 struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -1444,6 +1640,7 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 		new_data.tuple = new_tuple;
 		if (USE_HINT)
 			new_data.set_hint(tuple_hint(new_tuple, cmp_def));
+		new_data.set_prefix(key_def);
 		struct memtx_tree_data<USE_HINT> dup_data, suc_data;
 		dup_data.tuple = suc_data.tuple = NULL;
 
@@ -1475,6 +1672,7 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 		old_data.tuple = old_tuple;
 		if (USE_HINT)
 			old_data.set_hint(tuple_hint(old_tuple, cmp_def));
+		old_data.set_prefix(key_def);
 		memtx_tree_delete(&index->tree, old_data);
 		*result = old_tuple;
 	} else {
@@ -1873,7 +2071,7 @@ memtx_tree_func_index_replace(struct index *base, struct tuple *old_tuple,
 	return rc;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static struct iterator *
 memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 				 const char *key, uint32_t part_count,
@@ -1918,10 +2116,12 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 	it->key_data.part_count = part_count;
 	if (USE_HINT)
 		it->key_data.set_hint(key_hint(key, part_count, cmp_def));
+	it->key_data.set_prefix(base->def->key_def);
 	invalidate_tree_iterator(&it->tree_iterator);
 	it->last.tuple = NULL;
 	if (USE_HINT)
 		it->last.set_hint(HINT_NONE);
+	it->last.clear_prefix();
 	it->last_func_key = NULL;
 	if (pos != NULL) {
 		it->after_data.key = pos;
@@ -1932,10 +2132,11 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 		it->after_data.key = NULL;
 		it->after_data.part_count = 0;
 	}
+	it->after_data.clear_prefix();
 	return (struct iterator *)it;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_begin_build(struct index *base)
 {
@@ -1945,7 +2146,7 @@ memtx_tree_index_begin_build(struct index *base)
 	(void)index;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 memtx_tree_index_reserve(struct index *base, uint32_t size_hint)
 {
@@ -1966,7 +2167,7 @@ memtx_tree_index_reserve(struct index *base, uint32_t size_hint)
 	return 0;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 /** Initialize the next element of the index build_array. */
 static int
 memtx_tree_index_build_array_append(struct memtx_tree_index<USE_HINT> *index,
@@ -2002,10 +2203,11 @@ memtx_tree_index_build_array_append(struct memtx_tree_index<USE_HINT> *index,
 	elem->tuple = tuple;
 	if (USE_HINT)
 		elem->set_hint(hint);
+	elem->set_prefix(index->base.def->key_def);
 	return 0;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
 {
@@ -2082,7 +2284,7 @@ memtx_tree_func_index_build_next(struct index *base, struct tuple *tuple)
  * of equal tuples (in terms of index's cmp_def and have same
  * tuple pointer). The build_array is expected to be sorted.
  */
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_build_array_deduplicate(
 	struct memtx_tree_index<USE_HINT> *index)
@@ -2118,7 +2320,7 @@ memtx_tree_index_build_array_deduplicate(
 	index->build_array_size = w_idx + 1;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 memtx_tree_index_end_build(struct index *base)
 {
@@ -2149,7 +2351,7 @@ memtx_tree_index_end_build(struct index *base)
 }
 
 /** Read view implementation. */
-template <bool USE_HINT>
+template <int USE_HINT>
 struct tree_read_view {
 	/** Base class. */
 	struct index_read_view base;
@@ -2162,7 +2364,7 @@ struct tree_read_view {
 };
 
 /** Read view iterator implementation. */
-template <bool USE_HINT>
+template <int USE_HINT>
 struct tree_read_view_iterator {
 	/** Base class. */
 	struct index_read_view_iterator_base base;
@@ -2186,8 +2388,12 @@ static_assert(sizeof(struct tree_read_view_iterator<true>) <=
 	      INDEX_READ_VIEW_ITERATOR_SIZE,
 	      "sizeof(struct tree_read_view_iterator<true>) must be less than "
 	      "or equal to INDEX_READ_VIEW_ITERATOR_SIZE");
+static_assert(sizeof(struct tree_read_view_iterator<MEMTX_TREE_KEY_PREFIX>) <=
+	      INDEX_READ_VIEW_ITERATOR_SIZE,
+	      "sizeof(struct tree_read_view_iterator<MEMTX_TREE_KEY_PREFIX>) "
+	      "must be less than or equal to INDEX_READ_VIEW_ITERATOR_SIZE");
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static void
 tree_read_view_free(struct index_read_view *base)
 {
@@ -2200,26 +2406,41 @@ tree_read_view_free(struct index_read_view *base)
 	free(rv);
 }
 
-#if defined(ENABLE_READ_VIEW)
-# include "memtx_tree_read_view.cc"
-#else /* !defined(ENABLE_READ_VIEW) */
-
-template <bool USE_HINT>
+/** Implementation of get_raw index_read_view callback. */
+template <int USE_HINT>
 static int
-tree_read_view_get_raw(struct index_read_view *rv,
+tree_read_view_get_raw(struct index_read_view *base,
 		       const char *key, uint32_t part_count,
 		       struct read_view_tuple *result)
 {
-	(void)rv;
-	(void)key;
-	(void)part_count;
-	(void)result;
-	unreachable();
-	return 0;
+	struct tree_read_view<USE_HINT> *rv =
+		(struct tree_read_view<USE_HINT> *)base;
+	assert(base->def->opts.is_unique &&
+	       part_count == base->def->key_def->part_count);
+	struct memtx_tree_key_data<USE_HINT> key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	if (USE_HINT)
+		key_data.set_hint(key_hint(key, part_count,
+					   base->def->cmp_def));
+	key_data.set_prefix(base->def->key_def);
+	struct memtx_tree_data<USE_HINT> *res =
+		memtx_tree_view_find(&rv->tree_view, &key_data);
+	if (res == NULL) {
+		*result = read_view_tuple_none();
+		return 0;
+	}
+	return memtx_prepare_read_view_tuple(res->tuple, base, &rv->cleaner,
+					     result);
 }
 
-/** Implementation of next_raw index_read_view_iterator callback. */
-template <bool USE_HINT>
+/**
+ * Implementation of next_raw index_read_view_iterator callback.
+ * IS_REVERSE is set for LT, LE and REQ iterators. IS_EQ is set for
+ * EQ and REQ iterators, which stop at the first tuple that doesn't
+ * match the key.
+ */
+template <int USE_HINT, bool IS_REVERSE, bool IS_EQ>
 static int
 tree_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 				 struct read_view_tuple *result)
@@ -2233,14 +2454,24 @@ tree_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 		struct memtx_tree_data<USE_HINT> *res =
 			memtx_tree_view_iterator_get_elem(&rv->tree_view,
 							  &it->tree_iterator);
-
-		if (res == NULL) {
+		/* Use user key def to save a few loops. */
+		if (res == NULL ||
+		    (IS_EQ && tuple_compare_with_key(
+				res->tuple, res->hint, it->key_data.key,
+				it->key_data.part_count, it->key_data.hint,
+				rv->base.def->key_def) != 0)) {
+			it->base.next_raw =
+				exhausted_index_read_view_iterator_next_raw;
 			*result = read_view_tuple_none();
 			return 0;
 		}
-
-		memtx_tree_view_iterator_next(&rv->tree_view,
-					      &it->tree_iterator);
+		it->last = res;
+		if (IS_REVERSE)
+			memtx_tree_view_iterator_prev(&rv->tree_view,
+						      &it->tree_iterator);
+		else
+			memtx_tree_view_iterator_next(&rv->tree_view,
+						      &it->tree_iterator);
 		if (memtx_prepare_read_view_tuple(res->tuple, &rv->base,
 						  &rv->cleaner, result) != 0)
 			return -1;
@@ -2249,42 +2480,126 @@ tree_read_view_iterator_next_raw(struct index_read_view_iterator *iterator,
 	}
 }
 
-/** Positions the iterator to the given key. */
-template <bool USE_HINT>
+/**
+ * Positions the iterator to the given key or right after the given
+ * position. Works like memtx_tree_lookup() on the tree read view.
+ */
+template <int USE_HINT>
 static int
 tree_read_view_iterator_start(struct tree_read_view_iterator<USE_HINT> *it,
 			      enum iterator_type type,
 			      const char *key, uint32_t part_count,
 			      const char *pos)
 {
-	assert(type == ITER_ALL);
-	assert(key == NULL);
-	assert(part_count == 0);
-	assert(pos == NULL);
-	(void)type;
-	(void)key;
-	(void)part_count;
-	(void)pos;
 	struct tree_read_view<USE_HINT> *rv =
 		(struct tree_read_view<USE_HINT> *)it->base.index;
-	it->base.next_raw = tree_read_view_iterator_next_raw<USE_HINT>;
-	it->tree_iterator = memtx_tree_view_first(&rv->tree_view);
+	memtx_tree_view_t<USE_HINT> *view = &rv->tree_view;
+	struct index_def *def = rv->base.def;
+	struct key_def *cmp_def = def->cmp_def;
+	if (canonicalize_lookup(def, &type, &key, part_count) != 0)
+		return -1;
+	it->key_data.key = key;
+	it->key_data.part_count = part_count;
+	if (USE_HINT)
+		it->key_data.set_hint(key_hint(key, part_count, cmp_def));
+	it->key_data.set_prefix(def->key_def);
+
+	struct region *region = &fiber()->gc;
+	RegionGuard region_guard(region);
+	struct memtx_tree_key_data<USE_HINT> start_data = it->key_data;
+	/*
+	 * Since iteration with equality iterators returns first found tuple,
+	 * we need to choose between lower bound and upper bound for EQ and
+	 * REQ to start iteration after the given position. Range iterators
+	 * are simply changed to their equivalents with inequality.
+	 */
+	bool skip_equal_tuple = pos != NULL;
+	if (skip_equal_tuple) {
+		start_data.key = pos;
+		start_data.part_count = cmp_def->part_count;
+		if (USE_HINT)
+			start_data.set_hint(HINT_NONE);
+		start_data.clear_prefix();
+		if (type != ITER_EQ && type != ITER_REQ) {
+			type = iterator_type_is_reverse(type) ?
+			       ITER_LT : ITER_GT;
+		}
+	} else if (type == ITER_NP || type == ITER_PP) {
+		if (!prepare_start_prefix_iterator(&start_data, &type,
+						   cmp_def, region))
+			return 0;
+	}
+
+	bool is_reverse = iterator_type_is_reverse(type);
+	if (start_data.key == NULL) {
+		assert(type == ITER_GE || type == ITER_LE);
+		it->tree_iterator = is_reverse ? memtx_tree_view_last(view) :
+				    memtx_tree_view_first(view);
+	} else {
+		/* See the comment in memtx_tree_lookup(). */
+		bool need_lower_bound = type == ITER_EQ || type == ITER_GE ||
+					type == ITER_LT;
+		if (skip_equal_tuple && (type == ITER_EQ || type == ITER_REQ))
+			need_lower_bound = !need_lower_bound;
+		bool unused;
+		if (need_lower_bound) {
+			it->tree_iterator = memtx_tree_view_lower_bound(
+				view, &start_data, &unused);
+		} else {
+			it->tree_iterator = memtx_tree_view_upper_bound(
+				view, &start_data, &unused);
+		}
+		/*
+		 * The lookup found a position to the right of the target
+		 * one for reverse iterators. Note that a step back from
+		 * an invalid iterator moves it to the last element.
+		 */
+		if (is_reverse)
+			memtx_tree_view_iterator_prev(view, &it->tree_iterator);
+	}
+
+	switch (type) {
+	case ITER_EQ:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, false, true>;
+		break;
+	case ITER_REQ:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, true, true>;
+		break;
+	case ITER_GE:
+	case ITER_GT:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, false, false>;
+		break;
+	case ITER_LE:
+	case ITER_LT:
+		it->base.next_raw =
+			tree_read_view_iterator_next_raw<USE_HINT, true, false>;
+		break;
+	default:
+		unreachable();
+	}
 	return 0;
 }
 
-template <bool USE_HINT>
+/**
+ * Sets the key definition used by the tree read view for lookups.
+ * We can't use the one of the index because it may be altered while
+ * the read view is open so we use the copy of the index definition
+ * stored in the read view.
+ */
+template <int USE_HINT>
 static void
 tree_read_view_reset_key_def(struct tree_read_view<USE_HINT> *rv)
 {
-	rv->tree_view.common.arg = NULL;
+	rv->tree_view.common.arg = rv->base.def->cmp_def;
 }
 
-#endif /* !defined(ENABLE_READ_VIEW) */
-
 /**
  * Implementation of iterator position for general and multikey read views.
  */
-template <bool USE_HINT, bool IS_MULTIKEY>
+template <int USE_HINT, bool IS_MULTIKEY>
 static int
 tree_read_view_iterator_position(struct index_read_view_iterator *it,
 				 const char **pos, uint32_t *size)
@@ -2310,7 +2625,7 @@ tree_read_view_iterator_position_func(struct index_read_view_iterator *it,
 }
 
 /** Implementation of create_iterator index_read_view callback. */
-template <bool USE_HINT>
+template <int USE_HINT>
 static int
 tree_read_view_create_iterator(struct index_read_view *base,
 			       enum iterator_type type,
@@ -2336,13 +2651,14 @@ tree_read_view_create_iterator(struct index_read_view *base,
 	it->key_data.part_count = 0;
 	if (USE_HINT)
 		it->key_data.set_hint(HINT_NONE);
+	it->key_data.clear_prefix();
 	it->last = NULL;
 	invalidate_tree_iterator(&it->tree_iterator);
 	return tree_read_view_iterator_start(it, type, key, part_count, pos);
 }
 
 /** Implementation of create_read_view index callback. */
-template <bool USE_HINT>
+template <int USE_HINT>
 static struct index_read_view *
 memtx_tree_index_create_read_view(struct index *base)
 {
@@ -2418,14 +2734,18 @@ enum memtx_tree_vtab_type {
 
 /**
  * Get index vtab by @a TYPE and @a USE_HINT, template version.
- * USE_HINT == false is only allowed for general index type.
+ * USE_HINT == MEMTX_TREE_NO_HINT and USE_HINT == MEMTX_TREE_KEY_PREFIX
+ * are only allowed for general index type.
  */
-template <memtx_tree_vtab_type TYPE, bool USE_HINT = true>
+template <memtx_tree_vtab_type TYPE, int USE_HINT = MEMTX_TREE_HINT>
 static const struct index_vtab *
 get_memtx_tree_index_vtab(void)
 {
 	static_assert(USE_HINT || TYPE == MEMTX_TREE_VTAB_GENERAL,
 		      "Multikey and func indexes must use hints");
+	static_assert(USE_HINT != MEMTX_TREE_KEY_PREFIX ||
+		      TYPE == MEMTX_TREE_VTAB_GENERAL,
+		      "Multikey and func indexes can't store key prefixes");
 
 	if (TYPE == MEMTX_TREE_VTAB_DISABLED)
 		return &memtx_tree_disabled_index_vtab;
@@ -2470,7 +2790,7 @@ get_memtx_tree_index_vtab(void)
 	return &vtab;
 }
 
-template <bool USE_HINT>
+template <int USE_HINT>
 static struct index *
 memtx_tree_index_new_tpl(struct memtx_engine *memtx, struct index_def *def,
 			 const struct index_vtab *vtab)
@@ -2509,6 +2829,11 @@ memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def)
 	} else if (def->key_def->is_multikey) {
 		vtab = get_memtx_tree_index_vtab<MEMTX_TREE_VTAB_MULTIKEY>();
 		use_hint = true;
+	} else if (def->opts.hint == INDEX_HINT_ON && def->opts.key_prefix) {
+		vtab = get_memtx_tree_index_vtab
+			<MEMTX_TREE_VTAB_GENERAL, MEMTX_TREE_KEY_PREFIX>();
+		return memtx_tree_index_new_tpl<MEMTX_TREE_KEY_PREFIX>(
+			memtx, def, vtab);
 	} else if (def->opts.hint == INDEX_HINT_ON) {
 		vtab = get_memtx_tree_index_vtab
 			<MEMTX_TREE_VTAB_GENERAL, true>();
@@ -215,13 +215,13 @@ enum gap_item_type {
 	 * A transaction has completed a count of tuples matching a key and
 	 * iterator. After that any consequent delete or insert of any tuple
 	 * matching the key+iterator pair must lead to a conflict. Such an
-	 * item will be stored in index->read_gaps.
+	 * item will be stored in index->count_gaps.
 	 */
 	GAP_COUNT,
 	/**
 	 * A transaction completed a full scan of unordered index. After that
 	 * any consequent write to any new place of the index must lead to
-	 * conflict. Such an item will be store in index->read_gaps.
+	 * conflict. Such an item will be stored in index->full_scan_gaps.
 	 */
 	GAP_FULL_SCAN,
 };
@@ -234,7 +234,10 @@ enum gap_item_type {
 struct gap_item_base {
 	/** Type of gap record. */
 	enum gap_item_type type;
-	/** A link in memtx_story_link::read_gaps OR index::read_gaps. */
+	/**
+	 * A link in memtx_story_link::read_gaps OR one of index::read_gaps,
+	 * index::count_gaps, index::full_scan_gaps depending on the type.
+	 */
 	struct rlist in_read_gaps;
 	/** Link in txn->gap_list. */
 	struct rlist in_gap_list;
@@ -592,15 +595,33 @@ struct tx_manager
 	struct rlist all_txs;
 	/** Accumulated number of GC steps that should be done. */
 	size_t must_do_gc_steps;
+	/**
+	 * Number of GC steps that is added to must_do_gc_steps per creation
+	 * of a new story. Adapts to the share of garbage the GC finds, so
+	 * that the GC catches up quickly under high write rates and doesn't
+	 * waste time crawling live stories otherwise.
+	 */
+	size_t gc_steps_per_story;
+	/** Number of stories visited by the GC in the current pass. */
+	size_t gc_pass_visited;
+	/** Total number of GC steps done. */
+	size_t gc_steps;
+	/** Total number of stories deleted by the GC. */
+	size_t gc_collected;
 };
 
 enum {
 	/**
-	 * Number of iterations that is allowed for TX manager to do for
-	 * searching and deleting no more used memtx_tx_stories per creation of
-	 * a new story.
+	 * Minimal number of iterations that is allowed for TX manager to do
+	 * for searching and deleting no more used memtx_tx_stories per
+	 * creation of a new story.
 	 */
-		TX_MANAGER_GC_STEPS_SIZE = 2,
+	TX_MANAGER_GC_STEPS_SIZE = 2,
+	/**
+	 * Maximal number of GC iterations per creation of a new story,
+	 * used when most of the visited stories turn out to be garbage.
+	 */
+	TX_MANAGER_GC_STEPS_SIZE_MAX = 64,
 };
 
 /** That's a definition, see declaration for description. */
@@ -637,6 +658,10 @@ memtx_tx_manager_init()
 	rlist_create(&txm.all_txs);
 	txm.traverse_all_stories = &txm.all_stories;
 	txm.must_do_gc_steps = 0;
+	txm.gc_steps_per_story = TX_MANAGER_GC_STEPS_SIZE;
+	txm.gc_pass_visited = 0;
+	txm.gc_steps = 0;
+	txm.gc_collected = 0;
 	memset(&txm.story_stats, 0, sizeof(txm.story_stats));
 }
 
@@ -657,10 +682,21 @@ void
 memtx_tx_statistics_collect(struct memtx_tx_statistics *stats)
 {
 	memset(stats, 0, sizeof(*stats));
+	size_t story_count = 0;
 	for (size_t i = 0; i < MEMTX_TX_STORY_STATUS_MAX; ++i) {
 		stats->stories[i] = txm.story_stats[i];
 		stats->retained_tuples[i] = txm.retained_tuple_stats[i];
+		story_count += txm.story_stats[i].count;
 	}
+	stats->gc_steps = txm.gc_steps;
+	stats->gc_collected = txm.gc_collected;
+	stats->gc_steps_per_story = txm.gc_steps_per_story;
+	/*
+	 * Stories deleted not by the GC may have been visited already,
+	 * so the lag is an estimate.
+	 */
+	if (story_count > txm.gc_pass_visited)
+		stats->gc_lag = story_count - txm.gc_pass_visited;
 	if (rlist_empty(&txm.all_txs)) {
 		return;
 	}
@@ -949,7 +985,7 @@ memtx_tx_unref_from_primary(struct memtx_story *story)
 static struct memtx_story *
 memtx_tx_story_new(struct space *space, struct tuple *tuple)
 {
-	txm.must_do_gc_steps += TX_MANAGER_GC_STEPS_SIZE;
+	txm.must_do_gc_steps += txm.gc_steps_per_story;
 	assert(!tuple_has_flag(tuple, TUPLE_IS_DIRTY));
 	uint32_t index_count = space->index_count;
 	assert(index_count < BOX_INDEX_MAX);
@@ -1548,38 +1584,46 @@ memtx_tx_story_full_unlink_story_gc_step(struct memtx_story *story)
 	}
 }
 
+/**
+ * Lowest read view PSN: stories changed by transactions with greater or
+ * equal PSN may be visible to some read view.
+ * Default value is txn_next_psn because if it is not so some stories
+ * (stories produced by last txn at least) will be marked as potentially
+ * in read view even though there are no txns in read view.
+ */
+static int64_t
+memtx_tx_lowest_rv_psn(void)
+{
+	if (rlist_empty(&txm.read_view_txs))
+		return txn_next_psn;
+	struct txn *txn = rlist_first_entry(&txm.read_view_txs, struct txn,
+					    in_read_view_txs);
+	assert(txn->rv_psn != 0);
+	return txn->rv_psn;
+}
+
 /**
  * Run one step of a crawler that traverses all stories and removes no more
- * used stories.
+ * used stories. The lowest read view PSN doesn't change while the GC runs,
+ * so it's computed once per batch of steps by the caller.
+ * Returns true if a story was deleted.
  */
-void
-memtx_tx_story_gc_step()
+static bool
+memtx_tx_story_gc_step_impl(int64_t lowest_rv_psn)
 {
+	txm.gc_steps++;
 	if (txm.traverse_all_stories == &txm.all_stories) {
 		/* We came to the head of the list. */
 		txm.traverse_all_stories = txm.traverse_all_stories->next;
-		return;
-	}
-
-	/*
-	 * Lowest read view PSN.
-	 * Default value is txn_next_psn because if it is not so some
-	 * stories (stories produced by last txn at least) will be marked as
-	 * potentially in read view even though there are no txns in read view.
-	 */
-	int64_t lowest_rv_psn = txn_next_psn;
-	if (!rlist_empty(&txm.read_view_txs)) {
-		struct txn *txn =
-			rlist_first_entry(&txm.read_view_txs, struct txn,
-					  in_read_view_txs);
-		assert(txn->rv_psn != 0);
-		lowest_rv_psn = txn->rv_psn;
+		txm.gc_pass_visited = 0;
+		return false;
 	}
 
 	struct memtx_story *story =
 		rlist_entry(txm.traverse_all_stories, struct memtx_story,
 			    in_all_stories);
 	txm.traverse_all_stories = txm.traverse_all_stories->next;
+	txm.gc_pass_visited++;
 
 	/**
 	 * The order in which conditions are checked is important,
@@ -1589,13 +1633,13 @@ memtx_tx_story_gc_step()
 	    !rlist_empty(&story->reader_list)) {
 		memtx_tx_story_set_status(story, MEMTX_TX_STORY_USED);
 		/* The story is used directly by some transactions. */
-		return;
+		return false;
 	}
 	if (story->add_psn >= lowest_rv_psn ||
 	    story->del_psn >= lowest_rv_psn) {
 		memtx_tx_story_set_status(story, MEMTX_TX_STORY_READ_VIEW);
 		/* The story can be used by a read view. */
-		return;
+		return false;
 	}
 	for (uint32_t i = 0; i < story->index_count; i++) {
 		struct memtx_story_link *link = &story->link[i];
@@ -1612,7 +1656,7 @@ memtx_tx_story_gc_step()
 			if (link->older_story != NULL) {
 				memtx_tx_story_set_status(story,
 							  MEMTX_TX_STORY_USED);
-				return;
+				return false;
 			}
 		} else if (i > 0 && link->newer_story->add_stmt != NULL) {
 			/*
@@ -1622,27 +1666,53 @@ memtx_tx_story_gc_step()
 			 */
 			memtx_tx_story_set_status(story,
 						  MEMTX_TX_STORY_USED);
-			return;
+			return false;
 		}
 		if (!rlist_empty(&link->read_gaps)) {
 			memtx_tx_story_set_status(story,
 						  MEMTX_TX_STORY_TRACK_GAP);
 			/* The story is used for gap tracking. */
-			return;
+			return false;
 		}
 	}
 
 	/* Unlink and delete the story */
 	memtx_tx_story_full_unlink_story_gc_step(story);
 	memtx_tx_story_delete(story);
+	txm.gc_pass_visited--;
+	txm.gc_collected++;
+	return true;
+}
+
+void
+memtx_tx_story_gc_step()
+{
+	memtx_tx_story_gc_step_impl(memtx_tx_lowest_rv_psn());
 }
 
 void
 memtx_tx_story_gc()
 {
-	for (size_t i = 0; i < txm.must_do_gc_steps; i++)
-		memtx_tx_story_gc_step();
+	size_t steps = txm.must_do_gc_steps;
+	if (steps == 0)
+		return;
 	txm.must_do_gc_steps = 0;
+	int64_t lowest_rv_psn = memtx_tx_lowest_rv_psn();
+	size_t collected = 0;
+	for (size_t i = 0; i < steps; i++)
+		collected += memtx_tx_story_gc_step_impl(lowest_rv_psn);
+	/*
+	 * If most of the visited stories are garbage, the GC is lagging
+	 * behind the writers: speed it up. If little garbage is left, it
+	 * has caught up: slow it down towards the minimum.
+	 */
+	if (collected * 2 > steps) {
+		txm.gc_steps_per_story = MIN(txm.gc_steps_per_story * 2,
+					     TX_MANAGER_GC_STEPS_SIZE_MAX);
+	} else if (collected * 4 < steps) {
+		txm.gc_steps_per_story = MAX(txm.gc_steps_per_story / 2,
+					     TX_MANAGER_GC_STEPS_SIZE);
+	}
 }
 
 /**
@@ -1853,10 +1923,9 @@ memtx_tx_handle_counted_write(struct space *space, struct memtx_story *story,
 	struct index *index = space->index[ind];
 
 	struct gap_item_base *item_base, *tmp;
-	rlist_foreach_entry_safe(item_base, &index->read_gaps,
+	rlist_foreach_entry_safe(item_base, &index->count_gaps,
 				 in_read_gaps, tmp) {
-		if (item_base->type != GAP_COUNT)
-			continue;
+		assert(item_base->type == GAP_COUNT);
 		struct count_gap_item *item =
 			(struct count_gap_item *)item_base;
 
@@ -1990,10 +2059,9 @@ memtx_tx_handle_gap_write(struct space *space, struct memtx_story *story,
 	struct tuple *tuple = story->tuple;
 	struct index *index = space->index[ind];
 	struct gap_item_base *item_base, *tmp;
-	rlist_foreach_entry_safe(item_base, &index->read_gaps,
+	rlist_foreach_entry_safe(item_base, &index->full_scan_gaps,
 				 in_read_gaps, tmp) {
-		if (item_base->type != GAP_FULL_SCAN)
-			continue;
+		assert(item_base->type == GAP_FULL_SCAN);
 		memtx_tx_track_story_gap(item_base->txn, story, ind);
 	}
 	if (successor != NULL && !tuple_has_flag(successor, TUPLE_IS_DIRTY))
@@ -2007,6 +2075,10 @@ memtx_tx_handle_gap_write(struct space *space, struct memtx_story *story,
 		list = &succ_story->link[ind].read_gaps;
 		assert(list->next != NULL && list->prev != NULL);
 	}
+	struct key_def *def = index->def->key_def;
+	hint_t kh = HINT_NONE;
+	if (!rlist_empty(list))
+		kh = def->tuple_hint(tuple, def);
 	rlist_foreach_entry_safe(item_base, list, in_read_gaps, tmp) {
 		if (item_base->type != GAP_NEARBY)
 			continue;
@@ -2014,10 +2086,8 @@ memtx_tx_handle_gap_write(struct space *space, struct memtx_story *story,
 			(struct nearby_gap_item *)item_base;
 		int cmp = 0;
 		if (item->key != NULL) {
-			struct key_def *def = index->def->key_def;
 			hint_t oh =
 				def->key_hint(item->key, item->part_count, def);
-			hint_t kh = def->tuple_hint(tuple, def);
 			cmp = def->tuple_compare_with_key(tuple, kh, item->key,
 							  item->part_count, oh,
 							  def);
@@ -3072,16 +3142,26 @@ memtx_tx_delete_gap(struct gap_item_base *item)
 	memtx_tx_mempool_free(item->txn, pool, item);
 }
 
-void
-memtx_tx_on_index_delete(struct index *index)
+/**
+ * Destroy and free all gap items of the given list.
+ */
+static void
+memtx_tx_delete_gap_list(struct rlist *list)
 {
-	while (!rlist_empty(&index->read_gaps)) {
+	while (!rlist_empty(list)) {
 		struct gap_item_base *item =
-			rlist_first_entry(&index->read_gaps,
-					  struct gap_item_base,
+			rlist_first_entry(list, struct gap_item_base,
 					  in_read_gaps);
 		memtx_tx_delete_gap(item);
 	}
+}
+
+void
+memtx_tx_on_index_delete(struct index *index)
+{
+	memtx_tx_delete_gap_list(&index->read_gaps);
+	memtx_tx_delete_gap_list(&index->count_gaps);
+	memtx_tx_delete_gap_list(&index->full_scan_gaps);
 	memtx_tx_story_gc();
 }
 
@@ -3105,16 +3185,8 @@ memtx_tx_on_space_delete(struct space *space)
 		if (story->del_stmt != NULL)
 			memtx_tx_history_remove_stmt(story->del_stmt);
 		memtx_tx_story_full_unlink_on_space_delete(story);
-		for (uint32_t i = 0; i < story->index_count; i++) {
-			struct rlist *read_gaps = &story->link[i].read_gaps;
-			while (!rlist_empty(&story->link[i].read_gaps)) {
-				struct gap_item_base *item =
-					rlist_first_entry(read_gaps,
-							  struct gap_item_base,
-							  in_read_gaps);
-				memtx_tx_delete_gap(item);
-			}
-		}
+		for (uint32_t i = 0; i < story->index_count; i++)
+			memtx_tx_delete_gap_list(&story->link[i].read_gaps);
 		memtx_tx_story_delete(story);
 	}
 }
@@ -3433,7 +3505,7 @@ memtx_tx_track_count_slow(struct txn *txn, struct space *space,
 	if (txn != NULL && txn->status == TXN_INPROGRESS) {
 		struct count_gap_item *item =
 			memtx_tx_count_gap_item_new(txn, type, key, part_count);
-		rlist_add(&index->read_gaps, &item->base.in_read_gaps);
+		rlist_add(&index->count_gaps, &item->base.in_read_gaps);
 	}
 
 	/*
@@ -3485,7 +3557,7 @@ memtx_tx_track_full_scan_slow(struct txn *txn, struct index *index)
 		return;
 
 	struct full_scan_gap_item *item = memtx_tx_full_scan_gap_item_new(txn);
-	rlist_add(&index->read_gaps, &item->base.in_read_gaps);
+	rlist_add(&index->full_scan_gaps, &item->base.in_read_gaps);
 	memtx_tx_story_gc();
 }
 
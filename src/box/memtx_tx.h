@@ -132,6 +132,17 @@ struct memtx_tx_statistics {
 	size_t tx_max[TX_ALLOC_TYPE_MAX];
 	/* Number of txns registered in memtx transaction manager. */
 	size_t txn_count;
+	/* Total number of story garbage collector steps. */
+	size_t gc_steps;
+	/* Total number of stories deleted by the garbage collector. */
+	size_t gc_collected;
+	/*
+	 * Number of stories the garbage collector hasn't visited yet in
+	 * the current pass over all stories (estimate).
+	 */
+	size_t gc_lag;
+	/* Current number of garbage collector steps per new story. */
+	size_t gc_steps_per_story;
 };
 
 /**
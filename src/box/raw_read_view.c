@@ -0,0 +1,194 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "raw_read_view.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arrow_stream.h"
+#include "diag.h"
+#include "error.h"
+#include "index.h"
+#include "msgpuck.h"
+#include "read_view.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "tt_static.h"
+
+static_assert(sizeof(struct box_raw_read_view_iterator) ==
+	      sizeof(struct index_read_view_iterator),
+	      "sizeof(struct box_raw_read_view_iterator) must be equal to "
+	      "sizeof(struct index_read_view_iterator)");
+
+/**
+ * Space filter of a raw read view: skips spaces the current user doesn't
+ * have read access to.
+ */
+static bool
+raw_read_view_filter_space(struct space *space, void *arg)
+{
+	(void)arg;
+	if (access_check_space(space, PRIV_R) != 0) {
+		diag_clear(diag_get());
+		return false;
+	}
+	return true;
+}
+
+box_raw_read_view_t *
+box_raw_read_view_new(const char *name)
+{
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = name;
+	opts.filter_space = raw_read_view_filter_space;
+	opts.enable_field_names = true;
+	opts.enable_data_temporary_spaces = true;
+	struct read_view *rv = xmalloc(sizeof(*rv));
+	if (read_view_open(rv, &opts) != 0) {
+		free(rv);
+		return NULL;
+	}
+	return rv;
+}
+
+void
+box_raw_read_view_delete(box_raw_read_view_t *rv)
+{
+	read_view_close(rv);
+	free(rv);
+}
+
+box_raw_read_view_space_t *
+box_raw_read_view_space_by_id(box_raw_read_view_t *rv, uint32_t space_id)
+{
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, rv) {
+		if (space_rv->id == space_id)
+			return space_rv;
+	}
+	diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(space_id));
+	return NULL;
+}
+
+box_raw_read_view_space_t *
+box_raw_read_view_space_by_name(box_raw_read_view_t *rv,
+				const char *name, uint32_t len)
+{
+	struct space_read_view *space_rv;
+	read_view_foreach_space(space_rv, rv) {
+		if (strlen(space_rv->name) == len &&
+		    memcmp(space_rv->name, name, len) == 0)
+			return space_rv;
+	}
+	diag_set(ClientError, ER_NO_SUCH_SPACE, tt_cstr(name, len));
+	return NULL;
+}
+
+box_raw_read_view_index_t *
+box_raw_read_view_index_by_id(box_raw_read_view_space_t *space,
+			      uint32_t index_id)
+{
+	struct index_read_view *index_rv = space_read_view_index(space,
+								 index_id);
+	if (index_rv == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_INDEX_ID, index_id,
+			 space->name);
+		return NULL;
+	}
+	return index_rv;
+}
+
+box_raw_read_view_index_t *
+box_raw_read_view_index_by_name(box_raw_read_view_space_t *space,
+				const char *name, uint32_t len)
+{
+	for (uint32_t i = 0; i <= space->index_id_max; i++) {
+		struct index_read_view *index_rv = space->index_map[i];
+		if (index_rv != NULL &&
+		    strlen(index_rv->def->name) == len &&
+		    memcmp(index_rv->def->name, name, len) == 0)
+			return index_rv;
+	}
+	diag_set(ClientError, ER_NO_SUCH_INDEX_NAME, tt_cstr(name, len),
+		 space->name);
+	return NULL;
+}
+
+int
+box_raw_read_view_get(box_raw_read_view_index_t *index,
+		      const char *key, const char *key_end,
+		      const char **data, uint32_t *size)
+{
+	assert(key != NULL && key_end != NULL);
+	mp_tuple_assert(key, key_end);
+	(void)key_end;
+	uint32_t part_count = mp_decode_array(&key);
+	if (exact_key_validate(index->def, key, part_count) != 0)
+		return -1;
+	struct read_view_tuple result;
+	if (index_read_view_get_raw(index, key, part_count, &result) != 0)
+		return -1;
+	*data = result.data;
+	*size = result.size;
+	return 0;
+}
+
+int
+box_raw_read_view_iterator_create(box_raw_read_view_iterator_t *iter,
+				  box_raw_read_view_index_t *index,
+				  int type, const char *key,
+				  const char *key_end)
+{
+	assert(key != NULL && key_end != NULL);
+	mp_tuple_assert(key, key_end);
+	(void)key_end;
+	if (type < 0 || type >= iterator_type_MAX) {
+		diag_set(IllegalParams, "Invalid iterator type");
+		return -1;
+	}
+	uint32_t part_count = mp_decode_array(&key);
+	if (key_validate(index->def, type, key, part_count) != 0)
+		return -1;
+	return index_read_view_create_iterator(
+		index, type, key, part_count,
+		(struct index_read_view_iterator *)iter);
+}
+
+int
+box_raw_read_view_iterator_next(box_raw_read_view_iterator_t *iter,
+				const char **data, uint32_t *size)
+{
+	struct read_view_tuple result;
+	if (index_read_view_iterator_next_raw(
+			(struct index_read_view_iterator *)iter, &result) != 0)
+		return -1;
+	*data = result.data;
+	*size = result.size;
+	return 0;
+}
+
+void
+box_raw_read_view_iterator_destroy(box_raw_read_view_iterator_t *iter)
+{
+	index_read_view_iterator_destroy(
+		(struct index_read_view_iterator *)iter);
+}
+
+int
+box_raw_read_view_arrow_stream(box_raw_read_view_index_t *index,
+			       uint32_t field_count, const uint32_t *fields,
+			       const char *key, const char *key_end,
+			       const box_arrow_options_t *options,
+			       struct ArrowArrayStream *stream)
+{
+	return index_read_view_arrow_stream(index, field_count, fields,
+					    key, key_end, options, stream);
+}
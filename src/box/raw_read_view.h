@@ -0,0 +1,185 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arrow_stream.h"
+#include "trivia/util.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/** \cond public */
+
+struct ArrowArrayStream;
+struct read_view;
+struct space_read_view;
+struct index_read_view;
+
+/**
+ * Raw database read view.
+ *
+ * A read view is a frozen image of the database at the time it was opened:
+ * changes done after that are not visible to it. The read view doesn't hold
+ * any transaction so it doesn't pin MVCC stories and doesn't block the tx
+ * thread. Tuples are returned as raw MsgPack data.
+ *
+ * A read view may only be opened and closed in the tx thread, but all the
+ * other functions may also be called from other threads that have a fiber
+ * (for example, from a coio thread, see coio_call()), so the data may be
+ * processed without blocking tx. Note that the tuple data returned by
+ * the functions may be allocated on the fiber region (for example, if
+ * a tuple is compressed) so the caller is supposed to truncate the region
+ * (see box_region_truncate()) after using the data.
+ */
+typedef struct read_view box_raw_read_view_t;
+
+/** Space of a raw read view. */
+typedef struct space_read_view box_raw_read_view_space_t;
+
+/** Index of a raw read view space. */
+typedef struct index_read_view box_raw_read_view_index_t;
+
+/**
+ * Iterator over a raw read view index. An opaque structure of a fixed
+ * size so that it can be declared on stack.
+ */
+typedef struct box_raw_read_view_iterator {
+	/** Implementation dependent content. */
+	uint64_t data[9];
+} box_raw_read_view_iterator_t;
+
+/**
+ * Open a raw read view of all spaces of engines that support read views
+ * (memtx) the current user has read access to. May only be called from
+ * the tx thread.
+ *
+ * \param name read view name, shown in box.read_view.list()
+ * \retval NULL on error (check box_error_last())
+ * \retval read view on success
+ */
+API_EXPORT box_raw_read_view_t *
+box_raw_read_view_new(const char *name);
+
+/**
+ * Close a raw read view. May only be called from the tx thread after
+ * all iterators and Arrow streams over the read view are destroyed.
+ */
+API_EXPORT void
+box_raw_read_view_delete(box_raw_read_view_t *rv);
+
+/**
+ * Look up a read view space by id.
+ *
+ * \retval NULL if not found (check box_error_last())
+ * \retval space on success
+ */
+API_EXPORT box_raw_read_view_space_t *
+box_raw_read_view_space_by_id(box_raw_read_view_t *rv, uint32_t space_id);
+
+/**
+ * Look up a read view space by name.
+ *
+ * \retval NULL if not found (check box_error_last())
+ * \retval space on success
+ */
+API_EXPORT box_raw_read_view_space_t *
+box_raw_read_view_space_by_name(box_raw_read_view_t *rv,
+				const char *name, uint32_t len);
+
+/**
+ * Look up a read view index by id.
+ *
+ * \retval NULL if not found (check box_error_last())
+ * \retval index on success
+ */
+API_EXPORT box_raw_read_view_index_t *
+box_raw_read_view_index_by_id(box_raw_read_view_space_t *space,
+			      uint32_t index_id);
+
+/**
+ * Look up a read view index by name.
+ *
+ * \retval NULL if not found (check box_error_last())
+ * \retval index on success
+ */
+API_EXPORT box_raw_read_view_index_t *
+box_raw_read_view_index_by_name(box_raw_read_view_space_t *space,
+				const char *name, uint32_t len);
+
+/**
+ * Get a tuple from a unique read view index by a full key.
+ *
+ * \param index read view index
+ * \param key encoded key in MsgPack Array format ([part1, part2, ...])
+ * \param key_end the end of encoded \a key
+ * \param[out] data tuple data or NULL if not found
+ * \param[out] size tuple data size
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_raw_read_view_get(box_raw_read_view_index_t *index,
+		      const char *key, const char *key_end,
+		      const char **data, uint32_t *size);
+
+/**
+ * Create an iterator over a read view index. The key must stay valid
+ * until the iterator is destroyed.
+ *
+ * \param iter iterator to initialize
+ * \param index read view index
+ * \param type iterator type, see enum iterator_type
+ * \param key encoded key in MsgPack Array format ([part1, part2, ...])
+ * \param key_end the end of encoded \a key
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_raw_read_view_iterator_create(box_raw_read_view_iterator_t *iter,
+				  box_raw_read_view_index_t *index,
+				  int type, const char *key,
+				  const char *key_end);
+
+/**
+ * Fetch the next tuple from a read view iterator.
+ *
+ * \param iter iterator
+ * \param[out] data tuple data or NULL if the iterator is exhausted
+ * \param[out] size tuple data size
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ */
+API_EXPORT int
+box_raw_read_view_iterator_next(box_raw_read_view_iterator_t *iter,
+				const char **data, uint32_t *size);
+
+/** Destroy a read view iterator. */
+API_EXPORT void
+box_raw_read_view_iterator_destroy(box_raw_read_view_iterator_t *iter);
+
+/**
+ * Create a stream of Arrow record batches over a read view index.
+ * See box_index_arrow_stream() for the description of the arguments.
+ * Unlike box_index_arrow_stream(), this function and the stream release
+ * callback may be called from any thread. The read view must stay open
+ * until the stream is released.
+ */
+API_EXPORT int
+box_raw_read_view_arrow_stream(box_raw_read_view_index_t *index,
+			       uint32_t field_count, const uint32_t *fields,
+			       const char *key, const char *key_end,
+			       const box_arrow_options_t *options,
+			       struct ArrowArrayStream *stream);
+
+/** \endcond public */
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
@@ -46,6 +46,7 @@ enum {
 	SESSION_SETTING_SQL_DEFAULT_ENGINE = SESSION_SETTING_SQL_BEGIN,
 	SESSION_SETTING_SQL_FULL_COLUMN_NAMES,
 	SESSION_SETTING_SQL_FULL_METADATA,
+	SESSION_SETTING_SQL_PARALLEL_SCAN,
 	SESSION_SETTING_SQL_PARSER_DEBUG,
 	SESSION_SETTING_SQL_RECURSIVE_TRIGGERS,
 	SESSION_SETTING_SQL_REVERSE_UNORDERED_SELECTS,
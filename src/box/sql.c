@@ -1358,6 +1358,22 @@ sql_space_tuple_log_count(struct space *space)
 	return sqlLogEst(pk->vtab->size(pk));
 }
 
+const struct index_stat *
+sql_index_stat(const struct index_def *idx_def)
+{
+	struct space *space = space_by_id(idx_def->space_id);
+	if (space == NULL)
+		return NULL;
+	struct index *index = space_index(space, idx_def->iid);
+	if (index == NULL || index->stat == NULL)
+		return NULL;
+	/* Ephemeral definitions, e.g. fake_autoindex, have no statistics. */
+	if (strcmp(index->def->name, idx_def->name) != 0 ||
+	    index->stat->part_count != idx_def->key_def->part_count)
+		return NULL;
+	return index->stat;
+}
+
 int16_t
 index_field_tuple_est(const struct index_def *idx_def, uint32_t field)
 {
@@ -1375,6 +1391,9 @@ index_field_tuple_est(const struct index_def *idx_def, uint32_t field)
 	if (field == idx_def->key_def->part_count &&
 	    idx_def->opts.is_unique)
 		return 0;
+	const struct index_stat *stat = sql_index_stat(idx_def);
+	if (stat != NULL)
+		return stat->tuple_log_est[field];
 	return default_tuple_est[field + 1 >= 6 ? 6 : field];
 }
 
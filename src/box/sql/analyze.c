@@ -0,0 +1,348 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include "sqlInt.h"
+#include "box/index.h"
+#include "box/sql_stmt_cache.h"
+#include "box/schema.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "box/txn.h"
+#include "core/random.h"
+
+/**
+ * Max number of first key part values kept in the histogram of an index.
+ * Each of them represents about 1/INDEX_STAT_SAMPLE_COUNT of the index.
+ */
+enum { INDEX_STAT_SAMPLE_COUNT = 128 };
+
+/** State of statistics collection for one index. */
+struct index_stat_collector {
+	/** Definition of the analyzed index. */
+	struct index_def *def;
+	/** Number of tuples seen so far. */
+	uint64_t tuple_count;
+	/**
+	 * distinct[i] is the number of distinct values of the first i + 1
+	 * key parts seen so far. Valid only for ordered indexes.
+	 */
+	uint64_t *distinct;
+	/** Key of the previous tuple without MsgPack array header. */
+	char *prev_key;
+	/** Size of the prev_key buffer. */
+	size_t prev_key_size;
+	/** Reservoir of the first key part values. */
+	char *samples[INDEX_STAT_SAMPLE_COUNT];
+	/** Sizes of the values stored in samples. */
+	uint32_t sample_sizes[INDEX_STAT_SAMPLE_COUNT];
+	/** Number of used entries in samples. */
+	uint32_t sample_count;
+};
+
+static int
+index_stat_collector_create(struct index_stat_collector *c,
+			    struct index_def *def)
+{
+	memset(c, 0, sizeof(*c));
+	c->def = def;
+	c->distinct = calloc(def->key_def->part_count, sizeof(*c->distinct));
+	if (c->distinct == NULL) {
+		diag_set(OutOfMemory,
+			 def->key_def->part_count * sizeof(*c->distinct),
+			 "calloc", "distinct");
+		return -1;
+	}
+	return 0;
+}
+
+static void
+index_stat_collector_destroy(struct index_stat_collector *c)
+{
+	for (uint32_t i = 0; i < c->sample_count; i++)
+		free(c->samples[i]);
+	free(c->prev_key);
+	free(c->distinct);
+}
+
+/**
+ * Store the first part of the given key in the reservoir. The reservoir
+ * is filled with the first INDEX_STAT_SAMPLE_COUNT keys, then the i-th
+ * key replaces a random reservoir entry with probability
+ * INDEX_STAT_SAMPLE_COUNT / i so that every key has the same chance of
+ * getting to the histogram.
+ */
+static int
+index_stat_collector_sample(struct index_stat_collector *c, const char *key)
+{
+	uint32_t slot;
+	if (c->sample_count < INDEX_STAT_SAMPLE_COUNT) {
+		slot = c->sample_count;
+	} else {
+		int64_t rnd = pseudo_random_in_range(0, c->tuple_count - 1);
+		if (rnd >= INDEX_STAT_SAMPLE_COUNT)
+			return 0;
+		slot = rnd;
+	}
+	const char *key_end = key;
+	mp_next(&key_end);
+	uint32_t size = key_end - key;
+	char *sample = realloc(slot < c->sample_count ?
+			       c->samples[slot] : NULL, size);
+	if (sample == NULL) {
+		diag_set(OutOfMemory, size, "realloc", "sample");
+		return -1;
+	}
+	memcpy(sample, key, size);
+	c->samples[slot] = sample;
+	c->sample_sizes[slot] = size;
+	if (slot == c->sample_count)
+		c->sample_count++;
+	return 0;
+}
+
+/** Account a tuple key (without MsgPack array header) in statistics. */
+static int
+index_stat_collector_add(struct index_stat_collector *c, const char *key,
+			 const char *key_end)
+{
+	struct key_def *key_def = c->def->key_def;
+	uint32_t part_count = key_def->part_count;
+	c->tuple_count++;
+	if (c->def->type == TREE) {
+		/*
+		 * Tuples come in the index order so a new value of a key
+		 * prefix starts at the first key part differing from the
+		 * previous tuple.
+		 */
+		uint32_t diff = 0;
+		if (c->tuple_count > 1) {
+			for (diff = 0; diff < part_count; diff++) {
+				if (key_compare(key, diff + 1, HINT_NONE,
+						c->prev_key, diff + 1,
+						HINT_NONE, key_def) != 0)
+					break;
+			}
+		}
+		for (uint32_t i = diff; i < part_count; i++)
+			c->distinct[i]++;
+		size_t size = key_end - key;
+		if (size > c->prev_key_size) {
+			char *buf = realloc(c->prev_key, size);
+			if (buf == NULL) {
+				diag_set(OutOfMemory, size, "realloc",
+					 "prev_key");
+				return -1;
+			}
+			c->prev_key = buf;
+			c->prev_key_size = size;
+		}
+		memcpy(c->prev_key, key, size);
+	}
+	return index_stat_collector_sample(c, key);
+}
+
+/** Build the index statistics object out of the collected data. */
+static struct index_stat *
+index_stat_collector_finish(struct index_stat_collector *c)
+{
+	struct key_def *key_def = c->def->key_def;
+	uint32_t part_count = key_def->part_count;
+	/* Histograms make sense only for range scans. */
+	uint32_t sample_count = c->def->type == TREE ? c->sample_count : 0;
+	size_t samples_size = 0;
+	for (uint32_t i = 0; i < sample_count; i++)
+		samples_size += c->sample_sizes[i];
+	size_t size = sizeof(struct index_stat) +
+		      sample_count * sizeof(const char *) +
+		      (part_count + 1) * sizeof(int16_t) + samples_size;
+	struct index_stat *stat = malloc(size);
+	if (stat == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "struct index_stat");
+		return NULL;
+	}
+	stat->tuple_count = c->tuple_count;
+	stat->part_count = part_count;
+	stat->sample_count = sample_count;
+	stat->samples = (const char **)(stat + 1);
+	stat->tuple_log_est = (int16_t *)(stat->samples + sample_count);
+	char *data = (char *)(stat->tuple_log_est + part_count + 1);
+	for (uint32_t i = 0; i < sample_count; i++) {
+		memcpy(data, c->samples[i], c->sample_sizes[i]);
+		stat->samples[i] = data;
+		data += c->sample_sizes[i];
+	}
+	stat->tuple_log_est[0] = sqlLogEst(c->tuple_count);
+	for (uint32_t i = 1; i <= part_count; i++) {
+		uint64_t distinct = c->distinct[i - 1];
+		if (c->def->type != TREE) {
+			/*
+			 * We can't count distinct key prefixes of
+			 * an unordered index so fall back on defaults.
+			 */
+			if (i == part_count && c->def->opts.is_unique)
+				distinct = c->tuple_count;
+			else
+				distinct = 0;
+		}
+		int16_t est;
+		if (distinct == 0)
+			est = default_tuple_est[i + 1 >= 6 ? 6 : i];
+		else
+			est = sqlLogEst((c->tuple_count + distinct - 1) /
+					distinct);
+		/* Estimates must not grow with the number of key parts. */
+		if (est > stat->tuple_log_est[i - 1])
+			est = stat->tuple_log_est[i - 1];
+		stat->tuple_log_est[i] = est;
+	}
+	return stat;
+}
+
+/**
+ * Scan the given index, collect its statistics and attach them to it.
+ * The caller must hold a reference to the index.
+ */
+static int
+sql_analyze_index(struct space *space, struct index *index)
+{
+	struct index_def *def = index->def;
+	if (def->key_def->is_multikey || def->key_def->for_func_index)
+		return 0;
+	struct txn *txn = NULL;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+		return -1;
+	struct iterator *it = index_create_iterator(index, ITER_ALL, NULL, 0);
+	txn_end_ro_stmt(txn, &svp);
+	if (it == NULL)
+		return -1;
+	struct index_stat_collector c;
+	if (index_stat_collector_create(&c, def) != 0) {
+		iterator_delete(it);
+		return -1;
+	}
+	struct region *region = &fiber()->gc;
+	int rc = 0;
+	struct tuple *tuple;
+	while ((rc = iterator_next(it, &tuple)) == 0 && tuple != NULL) {
+		size_t region_svp = region_used(region);
+		uint32_t key_size;
+		const char *key = tuple_extract_key(tuple, def->key_def,
+						    MULTIKEY_NONE, &key_size);
+		if (key == NULL) {
+			rc = -1;
+			break;
+		}
+		const char *key_end = key + key_size;
+		mp_decode_array(&key);
+		rc = index_stat_collector_add(&c, key, key_end);
+		region_truncate(region, region_svp);
+		if (rc != 0)
+			break;
+	}
+	iterator_delete(it);
+	if (rc == 0) {
+		struct index_stat *stat = index_stat_collector_finish(&c);
+		if (stat != NULL) {
+			free(index->stat);
+			index->stat = stat;
+		} else {
+			rc = -1;
+		}
+	}
+	index_stat_collector_destroy(&c);
+	return rc;
+}
+
+/**
+ * Analyze all indexes of the given space. If @a skip_unreadable is
+ * set, a space the current user can't read is silently skipped.
+ */
+static int
+sql_analyze_space_impl(uint32_t space_id, bool skip_unreadable)
+{
+	struct space *space = space_by_id(space_id);
+	if (space == NULL)
+		return 0;
+	if (access_check_space(space, PRIV_R) != 0) {
+		if (!skip_unreadable)
+			return -1;
+		diag_clear(diag_get());
+		return 0;
+	}
+	uint32_t index_count = space->index_count;
+	struct index **indexes = xregion_alloc_array(&fiber()->gc,
+						     struct index *,
+						     index_count);
+	/* Analysis of a vinyl index may yield so pin all indexes. */
+	for (uint32_t i = 0; i < index_count; i++) {
+		indexes[i] = space->index[i];
+		index_ref(indexes[i]);
+	}
+	int rc = 0;
+	for (uint32_t i = 0; i < index_count && rc == 0; i++) {
+		/* Don't touch indexes of a space dropped on yield. */
+		if (space_by_id(space_id) != space)
+			break;
+		rc = sql_analyze_index(space, indexes[i]);
+	}
+	for (uint32_t i = 0; i < index_count; i++)
+		index_unref(indexes[i]);
+	/* Cached statements were planned with the old statistics. */
+	sql_plan_cache_flush();
+	return rc;
+}
+
+int
+sql_analyze_space(uint32_t space_id)
+{
+	return sql_analyze_space_impl(space_id, false);
+}
+
+/** Callback for space_foreach() collecting ids of user spaces. */
+static int
+sql_analyze_collect_space_id(struct space *space, void *data)
+{
+	if (space_is_system(space) || space->index_count == 0)
+		return 0;
+	struct region *region = &fiber()->gc;
+	uint32_t *id = xregion_alloc_object(region, uint32_t);
+	*id = space->def->id;
+	(*(uint32_t *)data)++;
+	return 0;
+}
+
+int
+sql_analyze_all(void)
+{
+	struct region *region = &fiber()->gc;
+	uint32_t count = 0;
+	size_t used = region_used(region);
+	space_foreach(sql_analyze_collect_space_id, &count);
+	uint32_t *ids = xregion_join(region, region_used(region) - used);
+	for (uint32_t i = 0; i < count; i++) {
+		if (sql_analyze_space_impl(ids[i], true) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+void
+sql_emit_analyze(struct Parse *parse, struct Token *name)
+{
+	uint32_t space_id = 0;
+	if (name != NULL) {
+		struct space *space = sql_space_by_token(name);
+		if (space == NULL) {
+			const char *name_str = sql_tt_name_from_token(name);
+			diag_set(ClientError, ER_NO_SUCH_SPACE, name_str);
+			parse->is_aborted = true;
+			return;
+		}
+		space_id = space->def->id;
+	}
+	struct Vdbe *v = sqlGetVdbe(parse);
+	sqlVdbeAddOp1(v, OP_Analyze, space_id);
+}
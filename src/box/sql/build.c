@@ -3574,6 +3574,8 @@ static struct sql_option_metadata sql_session_opts[] = {
 	{FIELD_TYPE_BOOLEAN, SQL_FullColNames},
 	/** SESSION_SETTING_SQL_FULL_METADATA */
 	{FIELD_TYPE_BOOLEAN, SQL_FullMetadata},
+	/** SESSION_SETTING_SQL_PARALLEL_SCAN */
+	{FIELD_TYPE_BOOLEAN, SQL_ParallelScan},
 	/** SESSION_SETTING_SQL_PARSER_DEBUG */
 	{FIELD_TYPE_BOOLEAN, SQL_SqlTrace | PARSER_TRACE_FLAG},
 	/** SESSION_SETTING_SQL_RECURSIVE_TRIGGERS */
@@ -50,6 +50,8 @@ struct port_sql {
 	/**
 	 * There's no need in clean-up in case of PREPARE request:
 	 * statement remains in cache and will be deleted later.
+	 * Otherwise the statement is put to the plan cache or
+	 * finalized, see sql_plan_cache_put().
 	 */
 	bool do_finalize;
 };
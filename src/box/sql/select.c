@@ -1623,6 +1623,23 @@ sql_key_info_new(uint32_t part_count)
 	return key_info;
 }
 
+struct sql_key_info *
+sql_key_info_new_from_key_def(const struct key_def *key_def,
+			      uint32_t part_count)
+{
+	assert(part_count <= key_def->part_count);
+	struct sql_key_info *key_info = sql_key_info_new(part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		const struct key_part *src = &key_def->parts[i];
+		struct key_part_def *part = &key_info->parts[i];
+		part->type = src->type;
+		part->coll_id = src->coll_id;
+		part->is_nullable = key_part_is_nullable(src);
+		part->sort_order = src->sort_order;
+	}
+	return key_info;
+}
+
 struct sql_key_info *
 sql_key_info_ref(struct sql_key_info *key_info)
 {
@@ -1719,6 +1736,20 @@ explainTempTable(Parse * pParse, const char *zUsage)
 	}
 }
 
+/**
+ * Same as explainTempTable() but the caption is "USE HASH TABLE FOR xxx".
+ */
+static void
+explainHashTable(struct Parse *parse, const char *usage)
+{
+	if (parse->explain == 2) {
+		struct Vdbe *v = parse->pVdbe;
+		char *msg = sqlMPrintf("USE HASH TABLE FOR %s", usage);
+		sqlVdbeAddOp4(v, OP_Explain, parse->iSelectId, 0, 0, msg,
+			      P4_DYNAMIC);
+	}
+}
+
 /*
  * Unless an "EXPLAIN QUERY PLAN" command is being processed, this function
  * is a no-op. Otherwise, it adds a single row of output to the EQP result,
@@ -4492,6 +4523,285 @@ is_simple_count(struct Select *select, struct AggInfo *agg_info)
 	return space;
 }
 
+enum {
+	/** Max number of predicates of a batch plan. */
+	SQL_BATCH_MAX_FILTERS = 16,
+	/** Max number of aggregate functions of a batch plan. */
+	SQL_BATCH_MAX_AGGS = 16,
+};
+
+/** Return true if the field of the space is of a numeric type. */
+static bool
+batch_field_is_numeric(const struct space *space, uint32_t fieldno)
+{
+	enum field_type type = space->def->fields[fieldno].type;
+	return type == FIELD_TYPE_INTEGER || type == FIELD_TYPE_UNSIGNED ||
+	       type == FIELD_TYPE_DOUBLE || type == FIELD_TYPE_NUMBER;
+}
+
+/**
+ * Return true if the field of the space is the first part of an index,
+ * so a predicate on it is better served with an index lookup.
+ */
+static bool
+batch_field_is_indexed(const struct space *space, uint32_t fieldno)
+{
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct key_def *key_def = space->index[i]->def->key_def;
+		if (!key_def->for_func_index &&
+		    key_def->parts[0].fieldno == fieldno)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Add predicates of the WHERE clause to a batch plan. The clause must be
+ * a conjunction of "column <op> number" terms where the column is numeric
+ * and not indexed. Return false if it is not the case.
+ */
+static bool
+batch_plan_add_filters(struct sql_batch_plan *plan, const struct space *space,
+		       int cursor, struct Expr *expr, struct Expr **values)
+{
+	if (expr->op == TK_AND) {
+		return batch_plan_add_filters(plan, space, cursor,
+					      expr->pLeft, values) &&
+		       batch_plan_add_filters(plan, space, cursor,
+					      expr->pRight, values);
+	}
+	int op = expr->op;
+	if (op != TK_EQ && op != TK_NE && op != TK_LT && op != TK_LE &&
+	    op != TK_GT && op != TK_GE)
+		return false;
+	struct Expr *column = expr->pLeft;
+	struct Expr *value = expr->pRight;
+	if (column->op != TK_COLUMN_REF) {
+		SWAP(column, value);
+		if (op == TK_LT)
+			op = TK_GT;
+		else if (op == TK_LE)
+			op = TK_GE;
+		else if (op == TK_GT)
+			op = TK_LT;
+		else if (op == TK_GE)
+			op = TK_LE;
+	}
+	if (column->op != TK_COLUMN_REF || column->iTable != cursor)
+		return false;
+	struct Expr *literal = value->op == TK_UMINUS ? value->pLeft : value;
+	if (literal->op != TK_INTEGER && literal->op != TK_FLOAT &&
+	    literal->op != TK_DECIMAL)
+		return false;
+	if (!batch_field_is_numeric(space, column->iColumn) ||
+	    batch_field_is_indexed(space, column->iColumn))
+		return false;
+	if (plan->filter_count == SQL_BATCH_MAX_FILTERS)
+		return false;
+	struct sql_batch_filter *filter = &plan->filters[plan->filter_count];
+	/* Field numbers are replaced with column indexes later. */
+	filter->column = column->iColumn;
+	filter->op = op;
+	values[plan->filter_count++] = value;
+	return true;
+}
+
+/**
+ * Walker callback looking for table columns outside of aggregate
+ * functions and for subqueries.
+ */
+static int
+batch_plan_check_expr(struct Walker *walker, struct Expr *expr)
+{
+	if (expr->op == TK_AGG_FUNCTION)
+		return WRC_Prune;
+	if (expr->op == TK_AGG_COLUMN || expr->op == TK_COLUMN_REF) {
+		walker->eCode = 1;
+		return WRC_Abort;
+	}
+	return WRC_Continue;
+}
+
+/** Walker callback for subqueries. */
+static int
+batch_plan_check_select(struct Walker *walker, struct Select *select)
+{
+	(void)select;
+	walker->eCode = 1;
+	return WRC_Abort;
+}
+
+/** Add aggregate functions to a batch plan. */
+static bool
+batch_plan_add_aggs(struct sql_batch_plan *plan, const struct space *space,
+		    int cursor, const struct AggInfo *agg_info)
+{
+	static const char *names[] = {
+		[SQL_BATCH_AGG_COUNT] = "COUNT",
+		[SQL_BATCH_AGG_SUM] = "SUM",
+		[SQL_BATCH_AGG_TOTAL] = "TOTAL",
+		[SQL_BATCH_AGG_AVG] = "AVG",
+		[SQL_BATCH_AGG_MIN] = "MIN",
+		[SQL_BATCH_AGG_MAX] = "MAX",
+	};
+	if (agg_info->nFunc == 0 || agg_info->nFunc > SQL_BATCH_MAX_AGGS)
+		return false;
+	for (int i = 0; i < agg_info->nFunc; i++) {
+		const struct AggInfo_func *f = &agg_info->aFunc[i];
+		if (f->iDistinct >= 0 ||
+		    f->func->def->language != FUNC_LANGUAGE_SQL_BUILTIN)
+			return false;
+		struct sql_batch_agg *agg = &plan->aggs[plan->agg_count++];
+		uint32_t type;
+		for (type = 0; type < lengthof(names); type++) {
+			if (strcmp(f->func->def->name, names[type]) == 0)
+				break;
+		}
+		if (type == lengthof(names))
+			return false;
+		agg->type = type;
+		agg->reg = f->iMem;
+		const struct ExprList *args = f->pExpr->x.pList;
+		if (args == NULL || args->nExpr == 0) {
+			agg->column = -1;
+			continue;
+		}
+		const struct Expr *arg = args->a[0].pExpr;
+		if (args->nExpr != 1 || arg->op != TK_AGG_COLUMN ||
+		    arg->iTable != cursor ||
+		    !batch_field_is_numeric(space, arg->iColumn))
+			return false;
+		/*
+		 * A single MIN() or MAX() of an indexed column reads just
+		 * one tuple, see minMaxQuery().
+		 */
+		if ((type == SQL_BATCH_AGG_MIN || type == SQL_BATCH_AGG_MAX) &&
+		    agg_info->nFunc == 1 &&
+		    batch_field_is_indexed(space, arg->iColumn))
+			return false;
+		/* Field numbers are replaced with column indexes later. */
+		agg->column = arg->iColumn;
+	}
+	return true;
+}
+
+/** Add a field to the sorted set of fields decoded by a batch plan. */
+static void
+batch_plan_add_column(struct sql_batch_plan *plan, uint32_t fieldno)
+{
+	uint32_t i = plan->column_count;
+	while (i > 0 && plan->fieldno[i - 1] > fieldno)
+		i--;
+	if (i > 0 && plan->fieldno[i - 1] == fieldno)
+		return;
+	memmove(&plan->fieldno[i + 1], &plan->fieldno[i],
+		(plan->column_count - i) * sizeof(plan->fieldno[0]));
+	plan->fieldno[i] = fieldno;
+	plan->column_count++;
+}
+
+/** Return the index of a field in the set of decoded fields. */
+static uint32_t
+batch_plan_column(const struct sql_batch_plan *plan, uint32_t fieldno)
+{
+	uint32_t i = 0;
+	while (plan->fieldno[i] != fieldno)
+		i++;
+	assert(i < plan->column_count);
+	return i;
+}
+
+/** Replace field numbers in a batch plan with column indexes. */
+static void
+batch_plan_build_columns(struct sql_batch_plan *plan)
+{
+	for (uint32_t i = 0; i < plan->filter_count; i++)
+		batch_plan_add_column(plan, plan->filters[i].column);
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		if (plan->aggs[i].column >= 0)
+			batch_plan_add_column(plan, plan->aggs[i].column);
+	}
+	for (uint32_t i = 0; i < plan->filter_count; i++) {
+		struct sql_batch_filter *filter = &plan->filters[i];
+		filter->column = batch_plan_column(plan, filter->column);
+	}
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		struct sql_batch_agg *agg = &plan->aggs[i];
+		if (agg->column >= 0)
+			agg->column = batch_plan_column(plan, agg->column);
+	}
+}
+
+/**
+ * Try to compile an aggregate query without GROUP BY to a single
+ * OP_BatchAggregate instruction, see sql_batch_aggregate(). This is
+ * possible if the query reads a single space which has to be scanned
+ * in full, the WHERE clause consists of simple numeric predicates and
+ * all aggregate functions are COUNT(), SUM(), TOTAL(), AVG(), MIN() or
+ * MAX() of numeric columns. Return false if the query is not eligible.
+ */
+static bool
+select_emit_batch_aggregate(struct Parse *parse, struct Select *select,
+			    struct AggInfo *agg_info)
+{
+	if (!OptimizationEnabled(SQL_BatchAgg))
+		return false;
+	struct SrcList *src_list = select->pSrc;
+	if (src_list->nSrc != 1 || src_list->a[0].pSelect != NULL)
+		return false;
+	struct SrcList_item *src = &src_list->a[0];
+	struct space *space = src->space;
+	assert(space != NULL && !space->def->opts.is_view);
+	if (space->index_count == 0 || src->fg.isIndexedBy)
+		return false;
+	/* Let the WHERE code raise an error if full scans are disallowed. */
+	if (src->fg.disallow_scan && (parse->sql_flags & SQL_SeqScan) == 0)
+		return false;
+	struct Walker walker;
+	memset(&walker, 0, sizeof(walker));
+	walker.xExprCallback = batch_plan_check_expr;
+	walker.xSelectCallback = batch_plan_check_select;
+	sqlWalkExprList(&walker, select->pEList);
+	sqlWalkExpr(&walker, select->pHaving);
+	sqlWalkExprList(&walker, select->pOrderBy);
+	if (walker.eCode != 0)
+		return false;
+	size_t size = sizeof(struct sql_batch_plan) +
+		      SQL_BATCH_MAX_FILTERS * sizeof(struct sql_batch_filter) +
+		      SQL_BATCH_MAX_AGGS * sizeof(struct sql_batch_agg) +
+		      (SQL_BATCH_MAX_FILTERS + SQL_BATCH_MAX_AGGS) *
+		      sizeof(uint32_t);
+	struct sql_batch_plan *plan = sql_xmalloc0(size);
+	plan->space_id = space->def->id;
+	plan->filters = (struct sql_batch_filter *)(plan + 1);
+	plan->aggs = (struct sql_batch_agg *)(plan->filters +
+					       SQL_BATCH_MAX_FILTERS);
+	plan->fieldno = (uint32_t *)(plan->aggs + SQL_BATCH_MAX_AGGS);
+	struct Expr *values[SQL_BATCH_MAX_FILTERS];
+	if ((select->pWhere != NULL &&
+	     !batch_plan_add_filters(plan, space, src->iCursor,
+				     select->pWhere, values)) ||
+	    !batch_plan_add_aggs(plan, space, src->iCursor, agg_info)) {
+		sql_xfree(plan);
+		return false;
+	}
+	batch_plan_build_columns(plan);
+	struct Vdbe *v = parse->pVdbe;
+	for (uint32_t i = 0; i < plan->filter_count; i++) {
+		plan->filters[i].reg = ++parse->nMem;
+		sqlExprCode(parse, values[i], plan->filters[i].reg);
+	}
+	if (parse->explain == 2) {
+		char *msg = sqlMPrintf("SCAN TABLE %s USING BATCH AGGREGATION",
+				       space->def->name);
+		sqlVdbeAddOp4(v, OP_Explain, parse->iSelectId, 0, 0, msg,
+			      P4_DYNAMIC);
+	}
+	sqlVdbeAddOp4(v, OP_BatchAggregate, 0, 0, 0, (char *)plan,
+		      P4_BATCHPLAN);
+	return true;
+}
+
 /*
  * If the source-list item passed as an argument was augmented with an
  * INDEXED BY clause, then try to locate the specified index. If there
@@ -6080,6 +6390,8 @@ sqlSelect(Parse * pParse,		/* The parser context */
 			int addrSortingIdx;	/* The OP_OpenEphemeral for the sorting index */
 			int addrReset;	/* Subroutine for resetting the accumulator */
 			int regReset;	/* Return address register for reset subroutine */
+			/* Rows are grouped with a hash table, not sorted. */
+			bool use_hash = false;
 
 			/* If there is a GROUP BY clause we might need a sorting index to
 			 * implement it.  Allocate that sorting index now.  If it turns out
@@ -6144,12 +6456,28 @@ sqlSelect(Parse * pParse,		/* The parser context */
 				int regRecord;
 				int nCol;
 				int nGroupBy;
-
-				explainTempTable(pParse,
-						 (sDistinct.isTnct
-						  && (p->
-						      selFlags & SF_Distinct) ==
-						  0) ? "DISTINCT" : "GROUP BY");
+				const char *usage = (sDistinct.isTnct &&
+						     (p->selFlags &
+						      SF_Distinct) == 0) ?
+						    "DISTINCT" : "GROUP BY";
+				/*
+				 * If the result is going to be sorted by
+				 * a different ORDER BY anyway, the groups may
+				 * come in any order, so it is enough to put
+				 * the rows into a hash table instead of
+				 * sorting them.
+				 */
+				use_hash = sSort.pOrderBy != NULL &&
+					   (orderByGrp == 0 ||
+					    !OptimizationEnabled(
+						SQL_GroupByOrder));
+				if (use_hash) {
+					explainHashTable(pParse, usage);
+					sqlVdbeChangeOpcode(v, addrSortingIdx,
+							    OP_HashOpen);
+				} else {
+					explainTempTable(pParse, usage);
+				}
 
 				groupBySort = 1;
 				nGroupBy = pGroupBy->nExpr;
@@ -6180,7 +6508,8 @@ sqlSelect(Parse * pParse,		/* The parser context */
 				regRecord = sqlGetTempReg(pParse);
 				sqlVdbeAddOp3(v, OP_MakeRecord, regBase,
 						  nCol, regRecord);
-				sqlVdbeAddOp2(v, OP_SorterInsert,
+				sqlVdbeAddOp2(v, use_hash ? OP_HashInsert :
+						  OP_SorterInsert,
 						  sAggInfo.sortingIdx,
 						  regRecord);
 				sqlReleaseTempReg(pParse, regRecord);
@@ -6191,7 +6520,8 @@ sqlSelect(Parse * pParse,		/* The parser context */
 				sortOut = sqlGetTempReg(pParse);
 				sqlVdbeAddOp3(v, OP_OpenPseudo, sortPTab,
 						  sortOut, nCol);
-				sqlVdbeAddOp2(v, OP_SorterSort,
+				sqlVdbeAddOp2(v, use_hash ? OP_HashSort :
+						  OP_SorterSort,
 						  sAggInfo.sortingIdx, addrEnd);
 				VdbeComment((v, "GROUP BY sort"));
 				sAggInfo.useSortingIdx = 1;
@@ -6223,7 +6553,8 @@ sqlSelect(Parse * pParse,		/* The parser context */
 			addrTopOfLoop = sqlVdbeCurrentAddr(v);
 			sqlExprCacheClear(pParse);
 			if (groupBySort) {
-				sqlVdbeAddOp3(v, OP_SorterData,
+				sqlVdbeAddOp3(v, use_hash ? OP_HashData :
+						  OP_SorterData,
 						  sAggInfo.sortingIdx, sortOut,
 						  sortPTab);
 			}
@@ -6276,7 +6607,8 @@ sqlSelect(Parse * pParse,		/* The parser context */
 			/* End of the loop
 			 */
 			if (groupBySort) {
-				sqlVdbeAddOp2(v, OP_SorterNext,
+				sqlVdbeAddOp2(v, use_hash ? OP_HashNext :
+						  OP_SorterNext,
 						  sAggInfo.sortingIdx,
 						  addrTopOfLoop);
 			} else {
@@ -6365,8 +6697,13 @@ sqlSelect(Parse * pParse,		/* The parser context */
 						  sAggInfo.aFunc[0].iMem);
 				sqlVdbeAddOp1(v, OP_Close, cursor);
 				explain_simple_count(pParse, space->def->name);
-			} else
-			{
+			} else if (select_emit_batch_aggregate(pParse, p,
+							       &sAggInfo)) {
+				/*
+				 * The whole scan and aggregation is done by
+				 * a single OP_BatchAggregate instruction.
+				 */
+			} else {
 				/* Check if the query is of one of the following forms:
 				 *
 				 *   SELECT min(x) FROM ...
@@ -410,6 +410,10 @@ sql_column_span(struct Vdbe *v, int n);
 uint64_t
 sql_stmt_schema_version(const struct Vdbe *stmt);
 
+/** Return session SQL flags the statement was compiled with. */
+uint32_t
+sql_stmt_flags(const struct Vdbe *stmt);
+
 int
 sql_initialize(void);
 
@@ -1002,6 +1006,8 @@ struct sql {
 					 */
 enum {
 	SQL_SeqScan = 0x00000008,
+	/** Scan memtx spaces in several threads where possible. */
+	SQL_ParallelScan = 0x00000010,
 	SQL_DEFAULT_FLAGS = SQL_EnableTrigger | SQL_AutoIndex |
 			    SQL_RecTriggers | SQL_SeqScan,
 };
@@ -1018,6 +1024,7 @@ enum {
 #define SQL_SubqCoroutine  0x0100	/* Evaluate subqueries as coroutines */
 #define SQL_Transitive     0x0200	/* Transitive constraints */
 #define SQL_OmitNoopJoin   0x0400	/* Omit unused tables in joins */
+#define SQL_BatchAgg       0x0800	/* Batch execution of aggregates */
 #define SQL_AllOpts        0xffff	/* All optimizations */
 
 /*
@@ -1218,6 +1225,16 @@ struct UnpackedRecord {
 int16_t
 index_field_tuple_est(const struct index_def *idx, uint32_t field);
 
+/** Default estimates used if an index has no statistics. */
+extern const int16_t default_tuple_est[];
+
+/**
+ * Return statistics collected by ANALYZE for the index with
+ * the given definition or NULL if there are none.
+ */
+const struct index_stat *
+sql_index_stat(const struct index_def *idx_def);
+
 #ifdef DEFAULT_TUPLE_COUNT
 #undef DEFAULT_TUPLE_COUNT
 #endif
@@ -2673,6 +2690,99 @@ sql_emit_show_create_table_all(struct Parse *parse);
 void
 sql_show_create_table(uint32_t space_id, struct Mem *ret, struct Mem *err);
 
+/**
+ * Emit VDBE instructions for "ANALYZE table_name;" statement or, if @a name
+ * is NULL, for "ANALYZE;" statement.
+ */
+void
+sql_emit_analyze(struct Parse *parse, struct Token *name);
+
+/**
+ * Collect statistics of all indexes of the space with the given ID: the
+ * number of distinct values of each key prefix and a histogram of the first
+ * key part built with reservoir sampling. The statistics are attached to
+ * the indexes and used by the planner to estimate selectivity.
+ */
+int
+sql_analyze_space(uint32_t space_id);
+
+/**
+ * Collect statistics of all indexes of all user spaces. Spaces the
+ * current user can't read are skipped.
+ */
+int
+sql_analyze_all(void);
+
+/** Aggregate functions supported by the batch execution mode. */
+enum sql_batch_agg_type {
+	SQL_BATCH_AGG_COUNT,
+	SQL_BATCH_AGG_SUM,
+	SQL_BATCH_AGG_TOTAL,
+	SQL_BATCH_AGG_AVG,
+	SQL_BATCH_AGG_MIN,
+	SQL_BATCH_AGG_MAX,
+};
+
+/** Predicate "column <op> reg[reg]" of a batch plan. */
+struct sql_batch_filter {
+	/** Index of the column in sql_batch_plan::fieldno. */
+	uint32_t column;
+	/** TK_EQ, TK_NE, TK_LT, TK_LE, TK_GT or TK_GE. */
+	int op;
+	/** Register holding the numeric value to compare with. */
+	int reg;
+};
+
+/** Aggregate function of a batch plan. */
+struct sql_batch_agg {
+	enum sql_batch_agg_type type;
+	/**
+	 * Index of the argument column in sql_batch_plan::fieldno or -1
+	 * for COUNT(*).
+	 */
+	int column;
+	/** Register the result is written to. */
+	int reg;
+};
+
+/**
+ * Plan of a full scan of a space that feeds rows matching a conjunction
+ * of simple predicates into a set of aggregate functions. Instead of
+ * interpreting the scan loop row by row, the plan is executed in batches:
+ * the needed columns of a batch of tuples are decoded into typed vectors
+ * and predicates and aggregates are evaluated over the vectors in tight
+ * loops. The plan is allocated as a single chunk and owned by the VDBE
+ * instruction executing it.
+ */
+struct sql_batch_plan {
+	/** ID of the scanned space. */
+	uint32_t space_id;
+	/** Number of decoded columns. */
+	uint32_t column_count;
+	/** Field numbers of decoded columns in ascending order. */
+	uint32_t *fieldno;
+	/** Number of predicates. */
+	uint32_t filter_count;
+	/** Predicates, all of which a row must satisfy. */
+	struct sql_batch_filter *filters;
+	/** Number of aggregate functions. */
+	uint32_t agg_count;
+	/** Aggregate functions. */
+	struct sql_batch_agg *aggs;
+};
+
+/**
+ * Execute a batch plan. Values compared with are taken from and results
+ * of aggregate functions are written to the given VDBE registers. The
+ * results are the same as the ones the row-at-a-time loop would produce.
+ * If is_parallel is set, a large memtx space is scanned by several threads
+ * over a read view, in which case results of SUM(), AVG() and TOTAL() of
+ * floating point values may differ from the sequential ones in rounding.
+ */
+int
+sql_batch_aggregate(const struct sql_batch_plan *plan, struct Mem *regs,
+		    bool is_parallel);
+
 /**
  * Return true if given column is part of primary key.
  * If field number is less than 63, corresponding bit
@@ -4155,6 +4265,15 @@ rename_trigger(char const *sql_stmt, char const *table_name, bool *is_quoted);
 ssize_t
 sql_index_tuple_size(struct space *space, struct index *idx);
 
+/**
+ * Create a key_info object out of the first @a part_count parts of the
+ * given key definition. Unlike the source, the i-th part of the new
+ * key refers to the i-th field.
+ */
+struct sql_key_info *
+sql_key_info_new_from_key_def(const struct key_def *key_def,
+			      uint32_t part_count);
+
 /**
  * Increment the reference counter of a key_info object.
  */
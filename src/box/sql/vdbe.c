@@ -1917,6 +1917,11 @@ case OP_Column: {
 			} else {
 				goto op_column_out;
 			}
+		} else if (pC->eCurType == CURTYPE_HASH) {
+			const char *data;
+			uint32_t size;
+			sql_hash_table_data(pC->uc.hash_table, &data, &size);
+			vdbe_field_ref_prepare_data(&pC->field_ref, data, size);
 		} else {
 			pCrsr = pC->uc.pCursor;
 			assert(pC->eCurType==CURTYPE_TARANTOOL);
@@ -1930,7 +1935,8 @@ case OP_Column: {
 		pC->cacheStatus = p->cacheCtr;
 	}
 	assert(pC->eCurType == CURTYPE_TARANTOOL ||
-	       pC->eCurType == CURTYPE_PSEUDO);
+	       pC->eCurType == CURTYPE_PSEUDO ||
+	       pC->eCurType == CURTYPE_HASH);
 	struct Mem *default_val_mem =
 		pOp->p4type == P4_MEM ? pOp->p4.pMem : NULL;
 	if (vdbe_field_ref_fetch(&pC->field_ref, p2, pDest) != 0)
@@ -2139,6 +2145,30 @@ case OP_Count: {         /* out2 */
 	break;
 }
 
+/**
+ * Opcode: BatchAggregate * * * P4 *
+ *
+ * Scan the space of the batch plan P4 in batches, filter the rows and
+ * compute the aggregate functions of the plan. Values used by the filters
+ * are taken from and the results of the aggregate functions are written to
+ * registers referenced by the plan. If the sql_parallel_scan session setting
+ * was on when the statement was prepared, a memtx space may be scanned by
+ * several threads.
+ */
+case OP_BatchAggregate: {
+	assert(pOp->p4type == P4_BATCHPLAN);
+	if (box_schema_version() != p->schema_ver) {
+		p->expired = 1;
+		diag_set(ClientError, ER_SQL_EXECUTE, "schema version has "\
+			 "changed: need to re-compile SQL statement");
+		goto abort_due_to_error;
+	}
+	if (sql_batch_aggregate(pOp->p4.batch_plan, aMem,
+				(p->sql_flags & SQL_ParallelScan) != 0) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
 /**
  * Opcode: CreateForeignKey P1 * * P4 *
  *
@@ -2535,6 +2565,35 @@ case OP_SorterOpen: {
 	break;
 }
 
+/**
+ * Opcode: HashOpen P1 P2 * P4 *
+ *
+ * Open cursor P1 on a new hash table of records consisting of P2
+ * fields. P4 is the key info describing the first fields of records
+ * forming the hash key. The hash table is used by hash joins and hash
+ * aggregation instead of an ephemeral index or a sorter.
+ */
+case OP_HashOpen: {
+	assert(pOp->p1 >= 0);
+	assert(pOp->p2 > 0);
+	assert(pOp->p4type == P4_KEYINFO);
+	struct key_def *def = sql_key_info_to_key_def(pOp->p4.key_info);
+	if (def == NULL)
+		goto abort_due_to_error;
+	struct sql_hash_table *ht = sql_hash_table_new(def, pOp->p2);
+	if (ht == NULL)
+		goto abort_due_to_error;
+	struct VdbeCursor *cursor = allocateCursor(p, pOp->p1, pOp->p2,
+						   CURTYPE_HASH);
+	if (cursor == NULL) {
+		sql_hash_table_delete(ht);
+		goto abort_due_to_error;
+	}
+	cursor->nullRow = 1;
+	cursor->uc.hash_table = ht;
+	break;
+}
+
 /* Opcode: SequenceTest P1 P2 * * *
  * Synopsis: if (cursor[P1].ctr++) pc = P2
  *
@@ -3172,6 +3231,29 @@ case OP_SorterData: {
 	break;
 }
 
+/**
+ * Opcode: HashData P1 P2 P3 * *
+ * Synopsis: r[P2]=data
+ *
+ * Write into register P2 the record hash table cursor P1 points to.
+ * Then clear the column header cache on cursor P3. This opcode works
+ * like OP_SorterData.
+ */
+case OP_HashData: {
+	pOut = vdbe_prepare_null_out(p, pOp->p2);
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cursor = p->apCsr[pOp->p1];
+	assert(cursor->eCurType == CURTYPE_HASH);
+	assert(cursor->nullRow == 0);
+	const char *data;
+	uint32_t size;
+	sql_hash_table_data(cursor->uc.hash_table, &data, &size);
+	if (mem_copy_bin(pOut, data, size) != 0)
+		goto abort_due_to_error;
+	p->apCsr[pOp->p3]->cacheStatus = CACHE_STALE;
+	break;
+}
+
 /* Opcode: RowData P1 P2 * * P5
  * Synopsis: r[P2]=data
  *
@@ -3330,6 +3412,61 @@ case OP_Last: {        /* jump */
  * regression tests can determine whether or not the optimizer is
  * correctly optimizing out sorts.
  */
+/**
+ * Opcode: HashSort P1 P2 * * *
+ *
+ * Position hash table cursor P1 at the first record. Subsequent
+ * OP_HashNext opcodes return all records of the hash table so that
+ * records with equal keys go one after another. If the hash table is
+ * empty, jump to P2.
+ */
+case OP_HashSort: {        /* jump */
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cursor = p->apCsr[pOp->p1];
+	assert(cursor->eCurType == CURTYPE_HASH);
+	int res;
+	if (sql_hash_table_rewind(cursor->uc.hash_table, &res) != 0)
+		goto abort_due_to_error;
+	cursor->cacheStatus = CACHE_STALE;
+	cursor->nullRow = (u8)res;
+	if (res != 0)
+		goto jump_to_p2;
+	break;
+}
+
+/**
+ * Opcode: HashSeek P1 P2 P3 P4 *
+ * Synopsis: key=r[P3@P4]
+ *
+ * Position hash table cursor P1 at the first record whose key is equal
+ * to the P4 registers starting at P3. Subsequent OP_HashNext opcodes
+ * return only records with this key. If there are no such records,
+ * jump to P2.
+ */
+case OP_HashSeek: {        /* jump */
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	assert(pOp->p4type == P4_INT32);
+	struct VdbeCursor *cursor = p->apCsr[pOp->p1];
+	assert(cursor->eCurType == CURTYPE_HASH);
+	struct region *region = &fiber()->gc;
+	size_t svp = region_used(region);
+	uint32_t key_size;
+	char *key = mem_encode_array(&aMem[pOp->p3], pOp->p4.i, &key_size,
+				     region);
+	if (key == NULL)
+		goto abort_due_to_error;
+	int res;
+	rc = sql_hash_table_seek(cursor->uc.hash_table, key, key_size, &res);
+	region_truncate(region, svp);
+	if (rc != 0)
+		goto abort_due_to_error;
+	cursor->cacheStatus = CACHE_STALE;
+	cursor->nullRow = (u8)res;
+	if (res != 0)
+		goto jump_to_p2;
+	break;
+}
+
 case OP_SorterSort:    /* jump */
 case OP_Sort: {        /* jump */
 #ifdef SQL_TEST
@@ -3449,6 +3586,11 @@ case OP_Rewind: {        /* jump */
  * invoked.  This opcode advances the cursor to the next sorted
  * record, or jumps to P2 if there are no more sorted records.
  */
+/* Opcode: HashNext P1 P2 * * *
+ *
+ * This opcode works just like OP_Next except that P1 must be a
+ * hash table cursor positioned with OP_HashSort or OP_HashSeek.
+ */
 case OP_SorterNext: {  /* jump */
 	VdbeCursor *pC;
 	int res;
@@ -3459,6 +3601,12 @@ case OP_SorterNext: {  /* jump */
 	if (sqlVdbeSorterNext(pC, &res) != 0)
 		goto abort_due_to_error;
 	goto next_tail;
+case OP_HashNext:      /* jump */
+	pC = p->apCsr[pOp->p1];
+	assert(pC->eCurType == CURTYPE_HASH);
+	if (sql_hash_table_next(pC->uc.hash_table, &res) != 0)
+		goto abort_due_to_error;
+	goto next_tail;
 case OP_PrevIfOpen:    /* jump */
 case OP_NextIfOpen:    /* jump */
 	if (p->apCsr[pOp->p1]==0) break;
@@ -3521,6 +3669,25 @@ case OP_SorterInsert: {      /* in2 */
 	break;
 }
 
+/**
+ * Opcode: HashInsert P1 P2 * * *
+ * Synopsis: key=r[P2]
+ *
+ * Register P2 holds a record made using the MakeRecord instruction.
+ * This opcode inserts the record into hash table cursor P1.
+ */
+case OP_HashInsert: {
+	assert(pOp->p1 >= 0 && pOp->p1 < p->nCursor);
+	struct VdbeCursor *cursor = p->apCsr[pOp->p1];
+	assert(cursor != NULL && cursor->eCurType == CURTYPE_HASH);
+	pIn2 = &aMem[pOp->p2];
+	assert(mem_is_bin(pIn2));
+	if (sql_hash_table_insert(cursor->uc.hash_table, pIn2->z,
+				  pIn2->n) != 0)
+		goto abort_due_to_error;
+	break;
+}
+
 /* Opcode: IdxInsert P1 P2 P3 * P5
  * Synopsis: key=r[P1]
  *
@@ -4461,6 +4628,19 @@ case OP_ShowCreateTable: {
 	break;
 }
 
+/**
+ * Opcode: Analyze P1 * * * *
+ *
+ * Collect statistics of indexes of the space with ID P1 or, if P1 is 0,
+ * of all user spaces. The statistics are used by the planner.
+ */
+case OP_Analyze: {
+	int rc = pOp->p1 != 0 ? sql_analyze_space(pOp->p1) : sql_analyze_all();
+	if (rc != 0)
+		goto abort_due_to_error;
+	break;
+}
+
 /* Opcode: Noop * * * * *
  *
  * Do nothing.  This instruction is often useful as a jump
@@ -97,6 +97,8 @@ struct VdbeOp {
 		struct sql_space_info *space_info;
 		/** P4 contains address of decimal. */
 		decimal_t *dec;
+		/** Used when p4type is P4_BATCHPLAN. */
+		struct sql_batch_plan *batch_plan;
 	} p4;
 #ifdef SQL_ENABLE_EXPLAIN_COMMENTS
 	char *zComment;		/* Comment to improve readability */
@@ -141,6 +143,8 @@ struct SubProgram {
 #define P4_BOOL     (-17)	/* P4 is a bool value */
 #define P4_PTR      (-18)	/* P4 is a generic pointer */
 #define P4_KEYINFO  (-19)       /* P4 is a pointer to sql_key_info structure. */
+/** P4 is a pointer to sql_batch_plan allocated with sql_xmalloc(). */
+#define P4_BATCHPLAN (-20)
 
 /* Error message codes for OP_Halt */
 #define P5_ConstraintNotNull 1
@@ -56,10 +56,14 @@ typedef unsigned Bool;
 /* Opaque type used by code in vdbesort.c */
 typedef struct VdbeSorter VdbeSorter;
 
+/* Opaque type used by code in vdbehash.c */
+struct sql_hash_table;
+
 /* Types of VDBE cursors */
 #define CURTYPE_TARANTOOL   0
 #define CURTYPE_SORTER      1
 #define CURTYPE_PSEUDO      2
+#define CURTYPE_HASH        3
 
 /*
  * A VdbeCursor is an superclass (a wrapper) for various cursor objects:
@@ -68,6 +72,7 @@ typedef struct VdbeSorter VdbeSorter;
  *          -  On either an ephemeral or ordinary space
  *      * A sorter
  *      * A one-row "pseudotable" stored in a single register
+ *      * A hash table
  */
 typedef struct VdbeCursor VdbeCursor;
 struct VdbeCursor {
@@ -99,6 +104,8 @@ struct VdbeCursor {
 		BtCursor *pCursor;	/* CURTYPE_TARANTOOL */
 		int pseudoTableReg;	/* CURTYPE_PSEUDO. Reg holding content. */
 		VdbeSorter *pSorter;	/* CURTYPE_SORTER. Sorter object */
+		/** CURTYPE_HASH. Hash table object. */
+		struct sql_hash_table *hash_table;
 	} uc;
 	/** Info about keys needed by index cursors. */
 	struct key_def *key_def;
@@ -378,6 +385,55 @@ int sqlVdbeSorterRewind(const VdbeCursor *, int *);
 int sqlVdbeSorterWrite(const VdbeCursor *, Mem *);
 int sqlVdbeSorterCompare(const VdbeCursor *, Mem *, int, int *);
 
+/**
+ * Create a hash table of records consisting of @a field_count fields,
+ * the first key_def->part_count of which form the key. The i-th key part
+ * must refer to the i-th field.
+ *
+ * @retval NULL on error, diag message is set.
+ */
+struct sql_hash_table *
+sql_hash_table_new(const struct key_def *key_def, uint32_t field_count);
+
+/** Free a hash table and all its records. */
+void
+sql_hash_table_delete(struct sql_hash_table *ht);
+
+/**
+ * Insert a record made by OP_MakeRecord into a hash table. If the table
+ * runs out of its memory limit, it is spilled to an ephemeral space.
+ */
+int
+sql_hash_table_insert(struct sql_hash_table *ht, const char *data,
+		      uint32_t size);
+
+/**
+ * Position a hash table cursor at the first record. Subsequent calls to
+ * sql_hash_table_next() return all records so that records with equal
+ * keys go one after another. @a eof is set if the table is empty.
+ */
+int
+sql_hash_table_rewind(struct sql_hash_table *ht, int *eof);
+
+/**
+ * Position a hash table cursor at the first record having the given key,
+ * which is a MsgPack array of the key values. Subsequent calls
+ * to sql_hash_table_next() return only records with this key. @a eof is
+ * set if there are no such records.
+ */
+int
+sql_hash_table_seek(struct sql_hash_table *ht, const char *key,
+		    uint32_t key_size, int *eof);
+
+/** Advance a hash table cursor. @a eof is set if there are no more rows. */
+int
+sql_hash_table_next(struct sql_hash_table *ht, int *eof);
+
+/** Get the record a hash table cursor is positioned at. */
+void
+sql_hash_table_data(struct sql_hash_table *ht, const char **data,
+		    uint32_t *size);
+
 int sqlVdbeMemTranslate(Mem *, u8);
 #ifdef SQL_DEBUG
 void sqlVdbePrintSql(Vdbe *);
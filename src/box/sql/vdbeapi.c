@@ -224,6 +224,12 @@ sql_stmt_schema_version(const struct Vdbe *v)
 	return v->schema_ver;
 }
 
+uint32_t
+sql_stmt_flags(const struct Vdbe *v)
+{
+	return v->sql_flags;
+}
+
 static size_t
 sql_metadata_size(const struct sql_column_metadata *metadata)
 {
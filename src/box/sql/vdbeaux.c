@@ -583,7 +583,8 @@ freeP4(int p4type, void *p4)
 	case P4_INT64:
 	case P4_UINT64:
 	case P4_DYNAMIC:
-	case P4_INTARRAY:{
+	case P4_INTARRAY:
+	case P4_BATCHPLAN:{
 			sql_xfree(p4);
 			break;
 		}
@@ -1039,6 +1040,13 @@ displayP4(Op * pOp, char *zTemp, int nTemp)
 			sqlXPrintf(&x, "program");
 			break;
 		}
+	case P4_BATCHPLAN:{
+			struct sql_batch_plan *plan = pOp->p4.batch_plan;
+			sqlXPrintf(&x, "batch(space=%u,filters=%u,aggs=%u)",
+				   plan->space_id, plan->filter_count,
+				   plan->agg_count);
+			break;
+		}
 	case P4_ADVANCE:{
 			zTemp[0] = 0;
 			break;
@@ -1482,6 +1490,9 @@ sqlVdbeFreeCursor(struct VdbeCursor *pCx)
 		sql_cursor_close(pCx->uc.pCursor);
 			break;
 		}
+	case CURTYPE_HASH:
+		sql_hash_table_delete(pCx->uc.hash_table);
+		break;
 	}
 }
 
@@ -0,0 +1,1055 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+/*
+ * This file implements batch execution of aggregate queries of the form
+ *
+ *   SELECT agg(x), ... FROM t WHERE x <op> <number> AND ...
+ *
+ * that are compiled to a single OP_BatchAggregate instruction instead of
+ * a row-at-a-time scan loop. Tuples of the primary index are fetched in
+ * batches of SQL_BATCH_SIZE. The columns needed by the query are decoded
+ * from each tuple in a single pass into typed vectors, one vector per
+ * column. Predicates narrow a selection vector of row numbers down, then
+ * aggregate functions consume the selected values.
+ *
+ * Integers fitting in int64_t and doubles are processed in place. All
+ * other values (unsigned integers greater than INT64_MAX and decimals)
+ * are converted to MEMs and handled with the same functions the row path
+ * uses, so the results including the result types and errors are exactly
+ * the same as the ones produced by the regular aggregate functions.
+ *
+ * If the sql_parallel_scan session setting is on, a memtx space is scanned
+ * by several threads. The primary key range is split into subranges using
+ * random samples of the primary index, then every thread aggregates its
+ * subrange of a read view of the space. Partial results are merged in the
+ * primary key order so that MIN() and MAX() return the same values as a
+ * sequential scan does.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+#include "box/engine.h"
+#include "box/index.h"
+#include "box/read_view.h"
+#include "box/schema.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "box/txn.h"
+#include "core/random.h"
+#include "qsort_arg.h"
+#include "tweaks.h"
+
+enum {
+	/** Number of tuples processed at once. */
+	SQL_BATCH_SIZE = 1024,
+	/** Max number of threads used by a parallel scan. */
+	SQL_PARALLEL_THREADS_MAX = 32,
+	/** Min number of tuples per thread worth a parallel scan. */
+	SQL_PARALLEL_MIN_ROWS = 16 * SQL_BATCH_SIZE,
+	/** Number of primary key samples taken per thread. */
+	SQL_PARALLEL_OVERSAMPLE = 64,
+};
+
+/** Number of threads used by a parallel scan. */
+static int sql_parallel_scan_threads = 4;
+TWEAK_INT(sql_parallel_scan_threads);
+
+/** Type of a decoded value. */
+enum sql_batch_value_type {
+	/** NULL or a missing field. */
+	SQL_BATCH_NULL,
+	/** An integer fitting in int64_t. */
+	SQL_BATCH_INT,
+	/** A floating point number. */
+	SQL_BATCH_DOUBLE,
+	/** Any other value. */
+	SQL_BATCH_OTHER,
+};
+
+/** A decoded value. */
+union sql_batch_value {
+	/** Value of SQL_BATCH_INT type. */
+	int64_t i;
+	/** Value of SQL_BATCH_DOUBLE type. */
+	double d;
+	/** MsgPack of a SQL_BATCH_OTHER value stored in a tuple. */
+	const char *mp;
+};
+
+/** Values of one column of a batch. */
+struct sql_batch_column {
+	/** Types of values, enum sql_batch_value_type. */
+	uint8_t type[SQL_BATCH_SIZE];
+	/** Values. */
+	union sql_batch_value value[SQL_BATCH_SIZE];
+};
+
+/** A batch of tuples. */
+struct sql_batch {
+	/**
+	 * Tuples of the batch, referenced. Not used if the batch is filled
+	 * from a read view.
+	 */
+	struct tuple *tuples[SQL_BATCH_SIZE];
+	/** Number of tuples in the batch. */
+	uint32_t size;
+	/** Numbers of rows satisfying the predicates checked so far. */
+	uint16_t sel[SQL_BATCH_SIZE];
+	/** Number of entries in sel. */
+	uint32_t sel_count;
+	/** Decoded columns, see sql_batch_plan::fieldno. */
+	struct sql_batch_column columns[];
+};
+
+/**
+ * A value a column is compared with: a predicate operand or the current
+ * value of MIN() and MAX().
+ */
+struct sql_batch_operand {
+	/** Type of the value, enum sql_batch_value_type. */
+	uint8_t type;
+	/** The value unless its type is SQL_BATCH_OTHER. */
+	union sql_batch_value value;
+	/** The value if its type is SQL_BATCH_OTHER. */
+	struct Mem mem;
+};
+
+/** State of an aggregate function. */
+struct sql_batch_acc {
+	/**
+	 * Type of the accumulated value, enum sql_batch_value_type. Values
+	 * of type SQL_BATCH_OTHER are accumulated in the operand MEM.
+	 */
+	struct sql_batch_operand value;
+	/** Number of values accumulated. */
+	uint64_t count;
+};
+
+static_assert(SQL_BATCH_SIZE <= UINT16_MAX + 1,
+	      "row numbers must fit in sql_batch::sel");
+
+/** Decode a MsgPack value stored in a tuple. */
+static inline void
+sql_batch_decode_value(const char *data, uint8_t *type,
+		       union sql_batch_value *value)
+{
+	const char *mp = data;
+	switch (mp_typeof(*data)) {
+	case MP_NIL:
+		*type = SQL_BATCH_NULL;
+		return;
+	case MP_UINT: {
+		uint64_t u = mp_decode_uint(&data);
+		if (u <= INT64_MAX) {
+			*type = SQL_BATCH_INT;
+			value->i = u;
+			return;
+		}
+		break;
+	}
+	case MP_INT:
+		*type = SQL_BATCH_INT;
+		value->i = mp_decode_int(&data);
+		return;
+	case MP_FLOAT:
+		*type = SQL_BATCH_DOUBLE;
+		value->d = mp_decode_float(&data);
+		return;
+	case MP_DOUBLE:
+		*type = SQL_BATCH_DOUBLE;
+		value->d = mp_decode_double(&data);
+		return;
+	default:
+		break;
+	}
+	*type = SQL_BATCH_OTHER;
+	value->mp = mp;
+}
+
+/** Allocate a batch for a plan. */
+static struct sql_batch *
+sql_batch_new(const struct sql_batch_plan *plan)
+{
+	size_t size = sizeof(struct sql_batch) +
+		      plan->column_count * sizeof(struct sql_batch_column);
+	struct sql_batch *batch = malloc(size);
+	if (batch == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "struct sql_batch");
+		return NULL;
+	}
+	batch->size = 0;
+	return batch;
+}
+
+/**
+ * Append tuple data to a batch and decode the needed fields. Fields are
+ * decoded in a single pass over the tuple data.
+ */
+static void
+sql_batch_add_data(struct sql_batch *batch, const struct sql_batch_plan *plan,
+		   const char *data)
+{
+	uint32_t row = batch->size++;
+	uint32_t field_count = mp_decode_array(&data);
+	uint32_t fieldno = 0;
+	for (uint32_t i = 0; i < plan->column_count; i++) {
+		struct sql_batch_column *column = &batch->columns[i];
+		if (plan->fieldno[i] >= field_count) {
+			column->type[row] = SQL_BATCH_NULL;
+			continue;
+		}
+		for (; fieldno < plan->fieldno[i]; fieldno++)
+			mp_next(&data);
+		sql_batch_decode_value(data, &column->type[row],
+				       &column->value[row]);
+	}
+}
+
+/** Append a tuple to a batch and reference it. */
+static void
+sql_batch_add(struct sql_batch *batch, const struct sql_batch_plan *plan,
+	      struct tuple *tuple)
+{
+	tuple_ref(tuple);
+	batch->tuples[batch->size] = tuple;
+	sql_batch_add_data(batch, plan, tuple_data(tuple));
+}
+
+/** Unreference tuples of a batch and make it empty. */
+static void
+sql_batch_reset(struct sql_batch *batch)
+{
+	for (uint32_t i = 0; i < batch->size; i++)
+		tuple_unref(batch->tuples[i]);
+	batch->size = 0;
+}
+
+/** Convert a decoded value to an ephemeral MEM. */
+static void
+sql_batch_value_to_mem(uint8_t type, const union sql_batch_value *value,
+		       struct Mem *mem)
+{
+	switch (type) {
+	case SQL_BATCH_NULL:
+		mem_set_null(mem);
+		break;
+	case SQL_BATCH_INT:
+		mem_set_int(mem, value->i, value->i < 0);
+		break;
+	case SQL_BATCH_DOUBLE:
+		mem_set_double(mem, value->d);
+		break;
+	default: {
+		assert(type == SQL_BATCH_OTHER);
+		uint32_t len;
+		int rc = mem_from_mp_ephemeral(mem, value->mp, &len);
+		assert(rc == 0);
+		(void)rc;
+		break;
+	}
+	}
+}
+
+/** Convert an operand to an ephemeral MEM. */
+static const struct Mem *
+sql_batch_operand_to_mem(const struct sql_batch_operand *op, struct Mem *mem)
+{
+	if (op->type == SQL_BATCH_OTHER)
+		return &op->mem;
+	sql_batch_value_to_mem(op->type, &op->value, mem);
+	return mem;
+}
+
+/** Set an operand to a copy of a decoded value. */
+static int
+sql_batch_operand_set(struct sql_batch_operand *op, uint8_t type,
+		      const union sql_batch_value *value)
+{
+	op->type = type;
+	if (type != SQL_BATCH_OTHER) {
+		op->value = *value;
+		return 0;
+	}
+	uint32_t len;
+	return mem_from_mp(&op->mem, value->mp, &len);
+}
+
+/** Comparison of a non-NULL decoded value with an operand, slow path. */
+static int
+sql_batch_cmp_slow(uint8_t type, const union sql_batch_value *value,
+		   const struct sql_batch_operand *op)
+{
+	struct Mem a, b;
+	mem_create(&a);
+	mem_create(&b);
+	sql_batch_value_to_mem(type, value, &a);
+	return mem_cmp_scalar(&a, sql_batch_operand_to_mem(op, &b), NULL);
+}
+
+/**
+ * Compare a non-NULL decoded value with a non-NULL operand the same way
+ * mem_cmp_scalar() does. Return -1, 0 or 1.
+ */
+static inline int
+sql_batch_cmp(uint8_t type, const union sql_batch_value *value,
+	      const struct sql_batch_operand *op)
+{
+	int cmp;
+	if (type == SQL_BATCH_INT && op->type == SQL_BATCH_INT)
+		return COMPARE_RESULT(value->i, op->value.i);
+	if (type == SQL_BATCH_DOUBLE && op->type == SQL_BATCH_DOUBLE)
+		return COMPARE_RESULT(value->d, op->value.d);
+	if (type == SQL_BATCH_DOUBLE && op->type == SQL_BATCH_INT)
+		cmp = double_compare_int64(value->d, op->value.i, 1);
+	else if (type == SQL_BATCH_INT && op->type == SQL_BATCH_DOUBLE)
+		cmp = double_compare_int64(op->value.d, value->i, -1);
+	else
+		cmp = sql_batch_cmp_slow(type, value, op);
+	return (cmp > 0) - (cmp < 0);
+}
+
+/**
+ * Return the mask of comparison results satisfying a comparison operator:
+ * bit 0 stands for "less", bit 1 for "equal" and bit 2 for "greater".
+ */
+static uint32_t
+sql_batch_op_mask(int op)
+{
+	switch (op) {
+	case TK_EQ:
+		return 2;
+	case TK_NE:
+		return 5;
+	case TK_LT:
+		return 1;
+	case TK_LE:
+		return 3;
+	case TK_GT:
+		return 4;
+	default:
+		assert(op == TK_GE);
+		return 6;
+	}
+}
+
+/** Remove rows not satisfying a predicate from the selection vector. */
+static void
+sql_batch_filter(struct sql_batch *batch, const struct sql_batch_column *column,
+		 int op, const struct sql_batch_operand *operand)
+{
+	if (operand->type == SQL_BATCH_NULL) {
+		batch->sel_count = 0;
+		return;
+	}
+	uint32_t mask = sql_batch_op_mask(op);
+	uint32_t count = 0;
+	if (operand->type == SQL_BATCH_INT) {
+		/* The most common case: an integer column. */
+		int64_t rhs = operand->value.i;
+		for (uint32_t k = 0; k < batch->sel_count; k++) {
+			uint16_t row = batch->sel[k];
+			uint8_t type = column->type[row];
+			int cmp;
+			if (type == SQL_BATCH_INT) {
+				cmp = COMPARE_RESULT(column->value[row].i, rhs);
+			} else if (type == SQL_BATCH_NULL) {
+				continue;
+			} else {
+				cmp = sql_batch_cmp(type, &column->value[row],
+						    operand);
+			}
+			batch->sel[count] = row;
+			count += (mask >> (cmp + 1)) & 1;
+		}
+	} else {
+		for (uint32_t k = 0; k < batch->sel_count; k++) {
+			uint16_t row = batch->sel[k];
+			uint8_t type = column->type[row];
+			if (type == SQL_BATCH_NULL)
+				continue;
+			int cmp = sql_batch_cmp(type, &column->value[row],
+						operand);
+			batch->sel[count] = row;
+			count += (mask >> (cmp + 1)) & 1;
+		}
+	}
+	batch->sel_count = count;
+}
+
+/** Fall back on mem_add() for the rest of a sum. */
+static int
+sql_batch_sum_slow(struct sql_batch_operand *sum, uint8_t type,
+		   const union sql_batch_value *value)
+{
+	if (sum->type != SQL_BATCH_OTHER) {
+		sql_batch_value_to_mem(sum->type, &sum->value, &sum->mem);
+		sum->type = SQL_BATCH_OTHER;
+	}
+	struct Mem mem;
+	mem_create(&mem);
+	sql_batch_value_to_mem(type, value, &mem);
+	return mem_add(&sum->mem, &mem, &sum->mem);
+}
+
+/**
+ * Add a non-NULL value to a sum. The sum follows the rules of mem_add():
+ * it stays integer until a double is met or the int64_t range is exceeded.
+ */
+static inline int
+sql_batch_sum_add(struct sql_batch_operand *sum, uint8_t type,
+		  const union sql_batch_value *value)
+{
+	int64_t res;
+	switch (sum->type) {
+	case SQL_BATCH_NULL:
+		return sql_batch_operand_set(sum, type, value);
+	case SQL_BATCH_INT:
+		if (type == SQL_BATCH_INT &&
+		    !__builtin_add_overflow(sum->value.i, value->i, &res)) {
+			sum->value.i = res;
+			return 0;
+		}
+		if (type == SQL_BATCH_DOUBLE) {
+			sum->type = SQL_BATCH_DOUBLE;
+			sum->value.d = (double)sum->value.i + value->d;
+			return 0;
+		}
+		break;
+	case SQL_BATCH_DOUBLE:
+		if (type == SQL_BATCH_DOUBLE) {
+			sum->value.d += value->d;
+			return 0;
+		}
+		if (type == SQL_BATCH_INT) {
+			sum->value.d += (double)value->i;
+			return 0;
+		}
+		break;
+	default:
+		break;
+	}
+	return sql_batch_sum_slow(sum, type, value);
+}
+
+/** Add values of a column to a sum. */
+static int
+sql_batch_sum(struct sql_batch_acc *acc, const struct sql_batch *batch,
+	      const struct sql_batch_column *column)
+{
+	for (uint32_t k = 0; k < batch->sel_count; k++) {
+		uint16_t row = batch->sel[k];
+		uint8_t type = column->type[row];
+		if (type == SQL_BATCH_NULL)
+			continue;
+		acc->count++;
+		if (sql_batch_sum_add(&acc->value, type,
+				      &column->value[row]) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** Add values of a column to a TOTAL() which is always a double. */
+static int
+sql_batch_total(struct sql_batch_acc *acc, const struct sql_batch *batch,
+		const struct sql_batch_column *column)
+{
+	double total = acc->value.value.d;
+	for (uint32_t k = 0; k < batch->sel_count; k++) {
+		uint16_t row = batch->sel[k];
+		uint8_t type = column->type[row];
+		if (type == SQL_BATCH_DOUBLE) {
+			total += column->value[row].d;
+		} else if (type == SQL_BATCH_INT) {
+			total += (double)column->value[row].i;
+		} else if (type == SQL_BATCH_OTHER) {
+			struct Mem a, b;
+			mem_create(&a);
+			mem_create(&b);
+			mem_set_double(&a, total);
+			sql_batch_value_to_mem(type, &column->value[row], &b);
+			if (mem_add(&a, &b, &a) != 0)
+				return -1;
+			total = a.u.r;
+		} else {
+			continue;
+		}
+		acc->count++;
+	}
+	acc->value.value.d = total;
+	return 0;
+}
+
+/** Count non-NULL values of a column. */
+static void
+sql_batch_count(struct sql_batch_acc *acc, const struct sql_batch *batch,
+		const struct sql_batch_column *column)
+{
+	uint64_t count = 0;
+	for (uint32_t k = 0; k < batch->sel_count; k++)
+		count += column->type[batch->sel[k]] != SQL_BATCH_NULL;
+	acc->count += count;
+}
+
+/** Find the minimum or the maximum of values of a column. */
+static int
+sql_batch_minmax(struct sql_batch_acc *acc, const struct sql_batch *batch,
+		 const struct sql_batch_column *column, bool is_max)
+{
+	struct sql_batch_operand *best = &acc->value;
+	for (uint32_t k = 0; k < batch->sel_count; k++) {
+		uint16_t row = batch->sel[k];
+		uint8_t type = column->type[row];
+		const union sql_batch_value *value = &column->value[row];
+		if (type == SQL_BATCH_NULL)
+			continue;
+		if (best->type != SQL_BATCH_NULL) {
+			int cmp = sql_batch_cmp(type, value, best);
+			if (is_max ? cmp <= 0 : cmp >= 0)
+				continue;
+		}
+		if (sql_batch_operand_set(best, type, value) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** Feed the selected rows of a batch to an aggregate function. */
+static int
+sql_batch_agg_step(const struct sql_batch_agg *agg, struct sql_batch_acc *acc,
+		   const struct sql_batch *batch)
+{
+	if (agg->column < 0) {
+		assert(agg->type == SQL_BATCH_AGG_COUNT);
+		acc->count += batch->sel_count;
+		return 0;
+	}
+	const struct sql_batch_column *column = &batch->columns[agg->column];
+	switch (agg->type) {
+	case SQL_BATCH_AGG_COUNT:
+		sql_batch_count(acc, batch, column);
+		return 0;
+	case SQL_BATCH_AGG_SUM:
+	case SQL_BATCH_AGG_AVG:
+		return sql_batch_sum(acc, batch, column);
+	case SQL_BATCH_AGG_TOTAL:
+		return sql_batch_total(acc, batch, column);
+	case SQL_BATCH_AGG_MIN:
+		return sql_batch_minmax(acc, batch, column, false);
+	case SQL_BATCH_AGG_MAX:
+		return sql_batch_minmax(acc, batch, column, true);
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+/** Write the result of an aggregate function to a register. */
+static int
+sql_batch_agg_finalize(const struct sql_batch_agg *agg,
+		       struct sql_batch_acc *acc, struct Mem *result)
+{
+	struct Mem mem;
+	switch (agg->type) {
+	case SQL_BATCH_AGG_COUNT:
+		mem_set_uint(result, acc->count);
+		return 0;
+	case SQL_BATCH_AGG_TOTAL:
+		mem_set_double(result, acc->value.value.d);
+		return 0;
+	case SQL_BATCH_AGG_AVG: {
+		if (acc->count == 0) {
+			mem_set_null(result);
+			return 0;
+		}
+		struct Mem count;
+		mem_create(&mem);
+		mem_create(&count);
+		mem_set_uint(&count, acc->count);
+		return mem_div(sql_batch_operand_to_mem(&acc->value, &mem),
+			       &count, result);
+	}
+	default:
+		mem_create(&mem);
+		return mem_copy(result,
+				sql_batch_operand_to_mem(&acc->value, &mem));
+	}
+}
+
+/** Create the state of an aggregate function. */
+static void
+sql_batch_acc_create(const struct sql_batch_agg *agg, struct sql_batch_acc *acc)
+{
+	acc->count = 0;
+	mem_create(&acc->value.mem);
+	if (agg->type == SQL_BATCH_AGG_TOTAL) {
+		acc->value.type = SQL_BATCH_DOUBLE;
+		acc->value.value.d = 0.0;
+	} else {
+		acc->value.type = SQL_BATCH_NULL;
+	}
+}
+
+/** Copy an operand. */
+static int
+sql_batch_operand_copy(struct sql_batch_operand *dst,
+		       const struct sql_batch_operand *src)
+{
+	dst->type = src->type;
+	if (src->type != SQL_BATCH_OTHER) {
+		dst->value = src->value;
+		return 0;
+	}
+	return mem_copy(&dst->mem, &src->mem);
+}
+
+/**
+ * Merge the state of an aggregate function computed over a range of the
+ * primary key into the state computed over the preceding ranges.
+ */
+static int
+sql_batch_acc_merge(const struct sql_batch_agg *agg, struct sql_batch_acc *acc,
+		    const struct sql_batch_acc *part)
+{
+	struct sql_batch_operand *value = &acc->value;
+	const struct sql_batch_operand *part_value = &part->value;
+	acc->count += part->count;
+	switch (agg->type) {
+	case SQL_BATCH_AGG_COUNT:
+		return 0;
+	case SQL_BATCH_AGG_TOTAL:
+		value->value.d += part_value->value.d;
+		return 0;
+	case SQL_BATCH_AGG_SUM:
+	case SQL_BATCH_AGG_AVG:
+		if (part_value->type == SQL_BATCH_NULL)
+			return 0;
+		if (value->type == SQL_BATCH_NULL)
+			return sql_batch_operand_copy(value, part_value);
+		if (part_value->type != SQL_BATCH_OTHER) {
+			return sql_batch_sum_add(value, part_value->type,
+						 &part_value->value);
+		}
+		if (value->type != SQL_BATCH_OTHER) {
+			sql_batch_value_to_mem(value->type, &value->value,
+					       &value->mem);
+			value->type = SQL_BATCH_OTHER;
+		}
+		return mem_add(&value->mem, &part_value->mem, &value->mem);
+	case SQL_BATCH_AGG_MIN:
+	case SQL_BATCH_AGG_MAX: {
+		if (part_value->type == SQL_BATCH_NULL)
+			return 0;
+		if (value->type != SQL_BATCH_NULL) {
+			struct Mem a, b;
+			mem_create(&a);
+			mem_create(&b);
+			int cmp = mem_cmp_scalar(
+				sql_batch_operand_to_mem(part_value, &a),
+				sql_batch_operand_to_mem(value, &b), NULL);
+			if (agg->type == SQL_BATCH_AGG_MAX ? cmp <= 0 :
+							     cmp >= 0)
+				return 0;
+		}
+		return sql_batch_operand_copy(value, part_value);
+	}
+	default:
+		unreachable();
+	}
+	return 0;
+}
+
+/** Apply the predicates to a batch and feed the result to the aggregates. */
+static int
+sql_batch_process(const struct sql_batch_plan *plan, struct sql_batch *batch,
+		  const struct sql_batch_operand *operands,
+		  struct sql_batch_acc *accs)
+{
+	batch->sel_count = batch->size;
+	for (uint32_t i = 0; i < batch->size; i++)
+		batch->sel[i] = i;
+	for (uint32_t i = 0; i < plan->filter_count; i++) {
+		const struct sql_batch_filter *filter = &plan->filters[i];
+		sql_batch_filter(batch, &batch->columns[filter->column],
+				 filter->op, &operands[i]);
+	}
+	for (uint32_t i = 0; i < plan->agg_count; i++) {
+		if (sql_batch_agg_step(&plan->aggs[i], &accs[i], batch) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** Scan an iterator in batches and feed them to the aggregates. */
+static int
+sql_batch_scan(const struct sql_batch_plan *plan, struct iterator *it,
+	       struct sql_batch *batch,
+	       const struct sql_batch_operand *operands,
+	       struct sql_batch_acc *accs)
+{
+	bool eof = false;
+	while (!eof) {
+		struct tuple *tuple;
+		while (batch->size < SQL_BATCH_SIZE) {
+			if (iterator_next(it, &tuple) != 0)
+				return -1;
+			if (tuple == NULL) {
+				eof = true;
+				break;
+			}
+			sql_batch_add(batch, plan, tuple);
+		}
+		if (sql_batch_process(plan, batch, operands, accs) != 0)
+			return -1;
+		sql_batch_reset(batch);
+	}
+	return 0;
+}
+
+/** Scan the primary index of a space in the tx thread. */
+static int
+sql_batch_scan_space(const struct sql_batch_plan *plan, struct space *space,
+		     struct index *pk, const struct sql_batch_operand *operands,
+		     struct sql_batch_acc *accs)
+{
+	struct sql_batch *batch = sql_batch_new(plan);
+	if (batch == NULL)
+		return -1;
+	/* A vinyl scan may yield so pin the index. */
+	index_ref(pk);
+	int rc = -1;
+	struct iterator *it;
+	struct txn *txn = NULL;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+		goto out;
+	it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	txn_end_ro_stmt(txn, &svp);
+	if (it == NULL)
+		goto out;
+	rc = sql_batch_scan(plan, it, batch, operands, accs);
+	sql_batch_reset(batch);
+	iterator_delete(it);
+out:
+	index_unref(pk);
+	free(batch);
+	return rc;
+}
+
+/** A thread scanning a range of the primary key of a read view. */
+struct sql_batch_worker {
+	/** Thread of the worker. */
+	struct cord cord;
+	/** Set if the thread was started. */
+	bool is_started;
+	/** Query plan. */
+	const struct sql_batch_plan *plan;
+	/** Predicate operands, see sql_batch_plan::filters. */
+	const struct sql_batch_operand *operands;
+	/** Primary index read view. */
+	struct index_read_view *index;
+	/**
+	 * The first key of the range (inclusive, MsgPack array) or NULL
+	 * if the range is unbounded from the left.
+	 */
+	const char *begin_key;
+	/**
+	 * The last key of the range (exclusive, MsgPack array) or NULL
+	 * if the range is unbounded from the right.
+	 */
+	const char *end_key;
+	/** Batch used by the worker. */
+	struct sql_batch *batch;
+	/** States of the aggregate functions over the range. */
+	struct sql_batch_acc *accs;
+};
+
+/** Check if tuple data stored in a read view is past the worker range. */
+static bool
+sql_batch_worker_is_past_end(struct sql_batch_worker *worker,
+			     const struct read_view_tuple *tuple)
+{
+	if (worker->end_key == NULL)
+		return false;
+	struct key_def *key_def = worker->index->def->key_def;
+	uint32_t size;
+	const char *key = tuple_extract_key_raw_to_region(
+		tuple->data, tuple->data + tuple->size, key_def,
+		MULTIKEY_NONE, &size, &fiber()->gc);
+	uint32_t part_count = mp_decode_array(&key);
+	const char *end_key = worker->end_key;
+	uint32_t end_part_count = mp_decode_array(&end_key);
+	return key_compare(key, part_count, HINT_NONE,
+			   end_key, end_part_count, HINT_NONE, key_def) >= 0;
+}
+
+/** Worker thread function. */
+static int
+sql_batch_worker_f(va_list ap)
+{
+	struct sql_batch_worker *worker = va_arg(ap, struct sql_batch_worker *);
+	const struct sql_batch_plan *plan = worker->plan;
+	struct sql_batch *batch = worker->batch;
+	struct region *region = &fiber()->gc;
+	const char *key = worker->begin_key;
+	uint32_t part_count = key != NULL ? mp_decode_array(&key) : 0;
+	struct index_read_view_iterator it;
+	if (index_read_view_create_iterator(worker->index, ITER_GE, key,
+					    part_count, &it) != 0)
+		return -1;
+	int rc = 0;
+	bool eof = false;
+	while (!eof && rc == 0) {
+		/* Tuple data may be decompressed to the fiber region. */
+		size_t region_svp = region_used(region);
+		while (batch->size < SQL_BATCH_SIZE) {
+			struct read_view_tuple tuple;
+			if (index_read_view_iterator_next_raw(&it,
+							      &tuple) != 0) {
+				rc = -1;
+				break;
+			}
+			if (tuple.data == NULL ||
+			    sql_batch_worker_is_past_end(worker, &tuple)) {
+				eof = true;
+				break;
+			}
+			sql_batch_add_data(batch, plan, tuple.data);
+		}
+		if (rc == 0)
+			rc = sql_batch_process(plan, batch, worker->operands,
+					       worker->accs);
+		batch->size = 0;
+		region_truncate(region, region_svp);
+	}
+	index_read_view_iterator_destroy(&it);
+	return rc;
+}
+
+/** Compare primary keys, used for sorting samples. */
+static int
+sql_batch_key_cmp(const void *a, const void *b, void *arg)
+{
+	struct key_def *key_def = arg;
+	const char *key_a = *(const char **)a;
+	const char *key_b = *(const char **)b;
+	uint32_t part_count_a = mp_decode_array(&key_a);
+	uint32_t part_count_b = mp_decode_array(&key_b);
+	return key_compare(key_a, part_count_a, HINT_NONE,
+			   key_b, part_count_b, HINT_NONE, key_def);
+}
+
+/**
+ * Split the primary key into ranges containing roughly the same number
+ * of tuples. The split keys are taken from a sorted set of random samples
+ * and allocated on the fiber region. Return the number of split keys,
+ * which is less than the number of ranges requested if the samples have
+ * too few distinct keys.
+ */
+static int
+sql_batch_split(struct index *pk, uint32_t range_count, const char **keys)
+{
+	struct key_def *key_def = pk->def->key_def;
+	uint32_t sample_count = range_count * SQL_PARALLEL_OVERSAMPLE;
+	const char **samples = xregion_alloc_array(&fiber()->gc, const char *,
+						   sample_count);
+	for (uint32_t i = 0; i < sample_count; i++) {
+		struct tuple *tuple;
+		uint32_t rnd = pseudo_random_in_range(0, UINT32_MAX);
+		if (index_random(pk, rnd, &tuple) != 0)
+			return -1;
+		if (tuple == NULL)
+			return 0;
+		uint32_t size;
+		samples[i] = tuple_extract_key(tuple, key_def, MULTIKEY_NONE,
+					       &size);
+	}
+	qsort_arg(samples, sample_count, sizeof(*samples), sql_batch_key_cmp,
+		  key_def);
+	int count = 0;
+	for (uint32_t i = 1; i < range_count; i++) {
+		const char *key = samples[i * SQL_PARALLEL_OVERSAMPLE];
+		if (count > 0 &&
+		    sql_batch_key_cmp(&keys[count - 1], &key, key_def) == 0)
+			continue;
+		keys[count++] = key;
+	}
+	return count;
+}
+
+/** Read view filter selecting the scanned space. */
+static bool
+sql_batch_read_view_filter_space(struct space *space, void *arg)
+{
+	return space_id(space) == *(uint32_t *)arg;
+}
+
+/** Read view filter selecting the primary index. */
+static bool
+sql_batch_read_view_filter_index(struct space *space, struct index *index,
+				 void *arg)
+{
+	(void)space;
+	(void)arg;
+	return index->def->iid == 0;
+}
+
+/**
+ * Scan the primary index of a memtx space in several threads. The tx
+ * thread yields while waiting for the workers.
+ */
+static int
+sql_batch_scan_parallel(const struct sql_batch_plan *plan,
+			struct space *space, struct index *pk,
+			uint32_t thread_count,
+			const struct sql_batch_operand *operands,
+			struct sql_batch_acc *accs)
+{
+	const char **keys = xregion_alloc_array(&fiber()->gc, const char *,
+						thread_count);
+	int key_count = sql_batch_split(pk, thread_count, keys);
+	if (key_count < 0)
+		return -1;
+	uint32_t worker_count = key_count + 1;
+	uint32_t id = space_id(space);
+	struct read_view_opts opts;
+	read_view_opts_create(&opts);
+	opts.name = "sql";
+	opts.filter_space = sql_batch_read_view_filter_space;
+	opts.filter_index = sql_batch_read_view_filter_index;
+	opts.filter_arg = &id;
+	opts.enable_data_temporary_spaces = true;
+	struct read_view rv;
+	if (read_view_open(&rv, &opts) != 0)
+		return -1;
+	struct space_read_view *space_rv =
+		rlist_first_entry(&rv.spaces, struct space_read_view, link);
+	assert(!rlist_empty(&rv.spaces) && space_rv->id == id);
+	struct sql_batch_worker *workers =
+		xcalloc(worker_count, sizeof(*workers));
+	int rc = 0;
+	for (uint32_t i = 0; i < worker_count; i++) {
+		struct sql_batch_worker *worker = &workers[i];
+		worker->plan = plan;
+		worker->operands = operands;
+		worker->index = space_read_view_index(space_rv, 0);
+		worker->begin_key = i > 0 ? keys[i - 1] : NULL;
+		worker->end_key = i < worker_count - 1 ? keys[i] : NULL;
+		worker->accs = xregion_alloc_array(&fiber()->gc,
+						   struct sql_batch_acc,
+						   plan->agg_count);
+		for (uint32_t j = 0; j < plan->agg_count; j++)
+			sql_batch_acc_create(&plan->aggs[j], &worker->accs[j]);
+		worker->batch = sql_batch_new(plan);
+		if (worker->batch == NULL ||
+		    cord_costart(&worker->cord, "sql.worker",
+				 sql_batch_worker_f, worker) != 0) {
+			rc = -1;
+			break;
+		}
+		worker->is_started = true;
+	}
+	for (uint32_t i = 0; i < worker_count; i++) {
+		struct sql_batch_worker *worker = &workers[i];
+		if (worker->is_started && cord_cojoin(&worker->cord) != 0)
+			rc = -1;
+	}
+	/* Merge partial results in the primary key order. */
+	for (uint32_t i = 0; i < worker_count && rc == 0; i++) {
+		for (uint32_t j = 0; j < plan->agg_count && rc == 0; j++) {
+			rc = sql_batch_acc_merge(&plan->aggs[j], &accs[j],
+						 &workers[i].accs[j]);
+		}
+	}
+	for (uint32_t i = 0; i < worker_count; i++) {
+		struct sql_batch_worker *worker = &workers[i];
+		free(worker->batch);
+		if (worker->accs == NULL)
+			continue;
+		for (uint32_t j = 0; j < plan->agg_count; j++)
+			mem_destroy(&worker->accs[j].value.mem);
+	}
+	free(workers);
+	read_view_close(&rv);
+	return rc;
+}
+
+/**
+ * Return the number of threads to scan a space with. A parallel scan
+ * requires a read view, so it isn't used for vinyl spaces and in active
+ * transactions, which changes wouldn't be visible to it.
+ */
+static uint32_t
+sql_batch_thread_count(struct space *space, struct index *pk)
+{
+	if ((space->engine->flags & ENGINE_SUPPORTS_READ_VIEW) == 0 ||
+	    pk->def->type != TREE || in_txn() != NULL)
+		return 1;
+	ssize_t size = index_size(pk);
+	if (size < 0)
+		return 1;
+	int64_t count = MIN(sql_parallel_scan_threads,
+			    SQL_PARALLEL_THREADS_MAX);
+	count = MIN(count, size / SQL_PARALLEL_MIN_ROWS);
+	return MAX(count, 1);
+}
+
+int
+sql_batch_aggregate(const struct sql_batch_plan *plan, struct Mem *regs,
+		    bool is_parallel)
+{
+	struct space *space = space_by_id(plan->space_id);
+	assert(space != NULL);
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	struct index *pk = space_index(space, 0);
+	assert(pk != NULL);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	struct sql_batch_operand *operands =
+		xregion_alloc_array(region, struct sql_batch_operand,
+				    plan->filter_count);
+	for (uint32_t i = 0; i < plan->filter_count; i++) {
+		struct Mem *mem = &regs[plan->filters[i].reg];
+		struct sql_batch_operand *op = &operands[i];
+		mem_create(&op->mem);
+		if (mem_is_null(mem)) {
+			op->type = SQL_BATCH_NULL;
+		} else if (mem->type == MEM_TYPE_INT ||
+			   (mem->type == MEM_TYPE_UINT &&
+			    mem->u.u <= INT64_MAX)) {
+			op->type = SQL_BATCH_INT;
+			op->value.i = mem->u.i;
+		} else if (mem->type == MEM_TYPE_DOUBLE) {
+			op->type = SQL_BATCH_DOUBLE;
+			op->value.d = mem->u.r;
+		} else {
+			op->type = SQL_BATCH_OTHER;
+			mem_copy_as_ephemeral(&op->mem, mem);
+		}
+	}
+	struct sql_batch_acc *accs =
+		xregion_alloc_array(region, struct sql_batch_acc,
+				    plan->agg_count);
+	for (uint32_t i = 0; i < plan->agg_count; i++)
+		sql_batch_acc_create(&plan->aggs[i], &accs[i]);
+	uint32_t thread_count = is_parallel ?
+				sql_batch_thread_count(space, pk) : 1;
+	int rc;
+	if (thread_count > 1) {
+		rc = sql_batch_scan_parallel(plan, space, pk, thread_count,
+					     operands, accs);
+	} else {
+		rc = sql_batch_scan_space(plan, space, pk, operands, accs);
+	}
+	for (uint32_t i = 0; i < plan->agg_count && rc == 0; i++) {
+		rc = sql_batch_agg_finalize(&plan->aggs[i], &accs[i],
+					    &regs[plan->aggs[i].reg]);
+	}
+	for (uint32_t i = 0; i < plan->agg_count; i++)
+		mem_destroy(&accs[i].value.mem);
+	region_truncate(region, region_svp);
+	return rc;
+}
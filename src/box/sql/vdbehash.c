@@ -0,0 +1,615 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+/*
+ * This file contains the hash table used by VDBE cursors of type
+ * CURTYPE_HASH. It serves two purposes:
+ *
+ *  - hash join: the inner table of a join that has no suitable index
+ *    is loaded into the hash table once and then probed by the equality
+ *    key built from the outer row (OP_HashSeek + OP_HashNext);
+ *
+ *  - hash aggregation: rows of a GROUP BY are loaded into the hash table
+ *    and then read back with equal keys adjacent to each other
+ *    (OP_HashSort + OP_HashNext), which is all the aggregation loop needs,
+ *    so the O(N log N) sort is replaced with an O(N) grouping.
+ *
+ * Records are built by OP_MakeRecord; their first key_def->part_count
+ * fields form the key. Records are copied to an arena and linked into
+ * per-key chains, one chain head per distinct key. The heads are kept
+ * in an open hash and in a list ordered by the first appearance of the
+ * key.
+ *
+ * When the table outgrows its memory limit, all records are moved to
+ * an ephemeral space with the key fields followed by an auto-increment
+ * row id as the primary key. Since the ephemeral space is ordered, all
+ * operations keep working, only lookups become logarithmic.
+ */
+#include "sqlInt.h"
+#include "mem.h"
+#include "vdbeInt.h"
+#include "tarantoolInt.h"
+#include "box/index.h"
+#include "box/space.h"
+#include "box/tuple.h"
+#include "coll/coll.h"
+#include "core/decimal.h"
+#include "core/mp_datetime.h"
+#include "core/mp_extension_types.h"
+#include "errinj.h"
+#include <PMurHash.h>
+#include <float.h>
+#include <math.h>
+
+enum {
+	/** Memory a hash table may use before it is spilled. */
+	SQL_HASH_TABLE_MEMORY_LIMIT = 64 * 1024 * 1024,
+	/** Initial number of buckets. Must be a power of two. */
+	SQL_HASH_TABLE_MIN_BUCKETS = 64,
+	/** Seed of the key hash function. */
+	SQL_HASH_SEED = 13,
+};
+
+/** A record stored in a hash table. */
+struct sql_hash_entry {
+	/** Next head of a chain in the same bucket. */
+	struct sql_hash_entry *next_in_bucket;
+	/** Next head in the order of the first key appearance. */
+	struct sql_hash_entry *next_group;
+	/** Next record with the same key. */
+	struct sql_hash_entry *next_dup;
+	/** Last record with the same key. Valid for chain heads only. */
+	struct sql_hash_entry *last_dup;
+	/** Hash of the key. */
+	uint32_t hash;
+	/** Size of the record. */
+	uint32_t size;
+	/** The record, MsgPack array. */
+	char data[0];
+};
+
+struct sql_hash_table {
+	/** Definition of the key, the i-th part refers to the i-th field. */
+	struct key_def *key_def;
+	/** Number of fields in records. */
+	uint32_t field_count;
+	/** Arena the records are allocated from. */
+	struct region arena;
+	/** Open hash of the chain heads, NULL if spilled. */
+	struct sql_hash_entry **buckets;
+	/** Number of buckets, a power of two. */
+	uint32_t bucket_count;
+	/** Number of distinct keys. */
+	uint32_t group_count;
+	/** First and last chain heads in the order of appearance. */
+	struct sql_hash_entry *first_group;
+	struct sql_hash_entry *last_group;
+	/** Head of the chain the cursor is positioned at. */
+	struct sql_hash_entry *group;
+	/** Record the cursor is positioned at. */
+	struct sql_hash_entry *entry;
+	/** Set if the cursor iterates over one key only. */
+	bool is_seek;
+	/** Max memory the in-memory table may use. */
+	size_t memory_limit;
+	/** Ephemeral space the records were spilled to, or NULL. */
+	struct space *space;
+	/** Iterator over the ephemeral space. */
+	struct iterator *it;
+	/** Tuple the ephemeral space iterator is positioned at. */
+	struct tuple *tuple;
+	/** Next row id of the ephemeral space. */
+	uint64_t rowid;
+	/** Buffer for the search key of the ephemeral space iterator. */
+	char *key;
+	/** Size of the key buffer. */
+	size_t key_size;
+};
+
+/*
+ * Numbers of different types are equal if key_compare() says so:
+ * integers and doubles are compared exactly, and so are integers and
+ * decimals, while a double is equal to a decimal if the double rounded
+ * to DBL_DIG significant digits is (see decimal_from_double()). Since
+ * the relation isn't transitive, all numbers linked by it must hash
+ * the same:
+ *
+ *  - a double is hashed as the double rounded to DBL_DIG digits;
+ *  - an integer or a decimal that is equal to a double (it's exactly
+ *    representable as a double or has at most DBL_DIG significant
+ *    digits) is hashed as that double;
+ *  - other integers and decimals are only equal to numbers of the same
+ *    value, so they are hashed as their significant digits and
+ *    the exponent.
+ */
+
+/** Feed a double rounded to DBL_DIG significant digits to the hash. */
+static void
+sql_hash_double(double value, uint32_t *ph, uint32_t *pcarry)
+{
+	if (value == 0) {
+		value = 0;
+	} else if (isnan(value)) {
+		value = NAN;
+	} else if (isfinite(value)) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%.*g", DBL_DIG, value);
+		value = strtod(buf, NULL);
+	}
+	PMurHash32_Process(ph, pcarry, &value, sizeof(value));
+}
+
+/** Check if an integer is exactly representable as a double. */
+static inline bool
+sql_hash_uint_is_double(uint64_t value)
+{
+	return value == 0 || value >> __builtin_ctzll(value) < (1ULL << 53);
+}
+
+/**
+ * Feed a non-zero number given by its significant digits (the last
+ * one isn't zero) and the exponent to the hash.
+ */
+static void
+sql_hash_digits(bool is_neg, const uint8_t *digits, uint32_t count,
+		int32_t exponent, uint32_t *ph, uint32_t *pcarry)
+{
+	assert(count > 0 && digits[count - 1] != 0);
+	if (count <= DBL_DIG) {
+		char buf[DECIMAL_MAX_STR_LEN + 1];
+		char *pos = buf;
+		if (is_neg)
+			*pos++ = '-';
+		for (uint32_t i = 0; i < count; i++)
+			*pos++ = '0' + digits[i];
+		snprintf(pos, buf + sizeof(buf) - pos, "e%d", (int)exponent);
+		sql_hash_double(strtod(buf, NULL), ph, pcarry);
+		return;
+	}
+	if (exponent >= 0 && count + exponent <= 20) {
+		uint64_t value = 0;
+		bool overflow = false;
+		for (uint32_t i = 0; i < count + exponent; i++) {
+			uint8_t digit = i < count ? digits[i] : 0;
+			overflow |= __builtin_mul_overflow(value, 10, &value);
+			overflow |= __builtin_add_overflow(value, digit, &value);
+		}
+		if (!overflow && sql_hash_uint_is_double(value)) {
+			double d = (double)value;
+			sql_hash_double(is_neg ? -d : d, ph, pcarry);
+			return;
+		}
+	}
+	uint8_t sign = is_neg;
+	PMurHash32_Process(ph, pcarry, &sign, sizeof(sign));
+	PMurHash32_Process(ph, pcarry, &exponent, sizeof(exponent));
+	PMurHash32_Process(ph, pcarry, digits, count);
+}
+
+/** Feed a decimal to the hash. */
+static void
+sql_hash_decimal(const decimal_t *dec, uint32_t *ph, uint32_t *pcarry)
+{
+	if (decNumberIsZero(dec)) {
+		sql_hash_double(0, ph, pcarry);
+		return;
+	}
+	uint8_t digits[DECIMAL_MAX_DIGITS];
+	decNumberGetBCD(dec, digits);
+	uint32_t count = dec->digits;
+	int32_t exponent = dec->exponent;
+	for (; digits[count - 1] == 0; count--)
+		exponent++;
+	sql_hash_digits(decNumberIsNegative(dec), digits, count, exponent,
+			ph, pcarry);
+}
+
+/** Feed an integer given by its sign and absolute value to the hash. */
+static void
+sql_hash_uint(bool is_neg, uint64_t value, uint32_t *ph, uint32_t *pcarry)
+{
+	if (sql_hash_uint_is_double(value)) {
+		double d = (double)value;
+		sql_hash_double(is_neg ? -d : d, ph, pcarry);
+		return;
+	}
+	uint8_t digits[20];
+	uint32_t count = 0;
+	int32_t exponent = 0;
+	for (; value % 10 == 0; value /= 10)
+		exponent++;
+	for (; value != 0; value /= 10)
+		digits[count++] = value % 10;
+	for (uint32_t i = 0; i < count / 2; i++)
+		SWAP(digits[i], digits[count - 1 - i]);
+	sql_hash_digits(is_neg, digits, count, exponent, ph, pcarry);
+}
+
+/** Feed a field to the hash and advance the field pointer. */
+static void
+sql_hash_field(const char **field, struct coll *coll, uint32_t *ph,
+	       uint32_t *pcarry)
+{
+	const char *f = *field;
+	uint32_t len;
+	switch (mp_typeof(*f)) {
+	case MP_UINT:
+		sql_hash_uint(false, mp_decode_uint(field), ph, pcarry);
+		return;
+	case MP_INT: {
+		int64_t value = mp_decode_int(field);
+		sql_hash_uint(value < 0, value < 0 ? -(uint64_t)value : value,
+			      ph, pcarry);
+		return;
+	}
+	case MP_FLOAT:
+		sql_hash_double(mp_decode_float(field), ph, pcarry);
+		return;
+	case MP_DOUBLE:
+		sql_hash_double(mp_decode_double(field), ph, pcarry);
+		return;
+	case MP_STR: {
+		const char *str = mp_decode_str(field, &len);
+		if (coll != NULL)
+			coll->hash(str, len, ph, pcarry, coll);
+		else
+			PMurHash32_Process(ph, pcarry, str, len);
+		return;
+	}
+	case MP_BIN: {
+		const char *bin = mp_decode_bin(field, &len);
+		PMurHash32_Process(ph, pcarry, bin, len);
+		return;
+	}
+	case MP_EXT: {
+		int8_t type;
+		const char *ext = mp_decode_ext(field, &type, &len);
+		if (type == MP_DECIMAL) {
+			decimal_t dec;
+			if (decimal_unpack(&ext, len, &dec) == NULL)
+				unreachable();
+			sql_hash_decimal(&dec, ph, pcarry);
+		} else if (type == MP_DATETIME) {
+			/*
+			 * Datetimes are compared by the moment of time,
+			 * regardless of the time zone.
+			 */
+			struct datetime dt;
+			if (datetime_unpack(&ext, len, &dt) == NULL)
+				unreachable();
+			sql_hash_double(dt.epoch, ph, pcarry);
+			PMurHash32_Process(ph, pcarry, &dt.nsec,
+					   sizeof(dt.nsec));
+		} else {
+			PMurHash32_Process(ph, pcarry, &type, sizeof(type));
+			PMurHash32_Process(ph, pcarry, ext, len);
+		}
+		return;
+	}
+	default:
+		mp_next(field);
+		PMurHash32_Process(ph, pcarry, f, *field - f);
+		return;
+	}
+}
+
+/** Hash the key of a record or a search key without the array header. */
+static uint32_t
+sql_hash_key(struct key_def *key_def, const char *key)
+{
+	uint32_t h = SQL_HASH_SEED;
+	uint32_t carry = 0;
+	const char *end = key;
+	for (uint32_t i = 0; i < key_def->part_count; i++)
+		sql_hash_field(&end, key_def->parts[i].coll, &h, &carry);
+	return PMurHash32_Result(h, carry, end - key);
+}
+
+/** Return the fields of a record following the array header. */
+static inline const char *
+sql_hash_record_fields(const char *data)
+{
+	mp_decode_array(&data);
+	return data;
+}
+
+/** Find the chain head of the given key. */
+static struct sql_hash_entry *
+sql_hash_table_find(struct sql_hash_table *ht, const char *key,
+		    uint32_t hash)
+{
+	struct key_def *key_def = ht->key_def;
+	uint32_t part_count = key_def->part_count;
+	struct sql_hash_entry *e = ht->buckets[hash & (ht->bucket_count - 1)];
+	for (; e != NULL; e = e->next_in_bucket) {
+		if (e->hash != hash)
+			continue;
+		if (key_compare(sql_hash_record_fields(e->data), part_count,
+				HINT_NONE, key, part_count, HINT_NONE,
+				key_def) == 0)
+			return e;
+	}
+	return NULL;
+}
+
+/** Size of the memory used by the in-memory table. */
+static size_t
+sql_hash_table_memory(struct sql_hash_table *ht)
+{
+	return region_used(&ht->arena) +
+	       ht->bucket_count * sizeof(ht->buckets[0]);
+}
+
+/** Double the number of buckets. */
+static int
+sql_hash_table_grow(struct sql_hash_table *ht)
+{
+	uint32_t count = ht->bucket_count * 2;
+	struct sql_hash_entry **buckets = calloc(count, sizeof(buckets[0]));
+	if (buckets == NULL) {
+		diag_set(OutOfMemory, count * sizeof(buckets[0]), "calloc",
+			 "buckets");
+		return -1;
+	}
+	for (struct sql_hash_entry *e = ht->first_group; e != NULL;
+	     e = e->next_group) {
+		struct sql_hash_entry **b = &buckets[e->hash & (count - 1)];
+		e->next_in_bucket = *b;
+		*b = e;
+	}
+	free(ht->buckets);
+	ht->buckets = buckets;
+	ht->bucket_count = count;
+	return 0;
+}
+
+/** Insert a record into the ephemeral space appending a row id to it. */
+static int
+sql_hash_table_spill_record(struct sql_hash_table *ht, const char *data,
+			    uint32_t size)
+{
+	const char *fields = data;
+	uint32_t field_count = mp_decode_array(&fields);
+	assert(field_count == ht->field_count);
+	uint32_t fields_size = data + size - fields;
+	struct region *region = &fiber()->gc;
+	size_t svp = region_used(region);
+	size_t tuple_size = mp_sizeof_array(field_count + 1) + fields_size +
+			    mp_sizeof_uint(ht->rowid);
+	char *tuple = xregion_alloc(region, tuple_size);
+	char *pos = mp_encode_array(tuple, field_count + 1);
+	memcpy(pos, fields, fields_size);
+	pos = mp_encode_uint(pos + fields_size, ht->rowid++);
+	assert(pos == tuple + tuple_size);
+	int rc = tarantoolsqlEphemeralInsert(ht->space, tuple, pos);
+	region_truncate(region, svp);
+	return rc;
+}
+
+/** Move all records to an ephemeral space and free the arena. */
+static int
+sql_hash_table_spill(struct sql_hash_table *ht)
+{
+	struct key_def *key_def = ht->key_def;
+	uint32_t part_count = key_def->part_count;
+	struct sql_space_info *info =
+		sql_space_info_new(ht->field_count + 1, part_count + 1);
+	for (uint32_t i = 0; i < ht->field_count; i++)
+		info->types[i] = FIELD_TYPE_ANY;
+	for (uint32_t i = 0; i < part_count; i++) {
+		info->types[i] = FIELD_TYPE_SCALAR;
+		info->coll_ids[i] = key_def->parts[i].coll_id;
+	}
+	info->types[ht->field_count] = FIELD_TYPE_UNSIGNED;
+	info->parts[part_count] = ht->field_count;
+	ht->space = sql_ephemeral_space_new(info);
+	sql_xfree(info);
+	if (ht->space == NULL)
+		return -1;
+	for (struct sql_hash_entry *g = ht->first_group; g != NULL;
+	     g = g->next_group) {
+		for (struct sql_hash_entry *e = g; e != NULL; e = e->next_dup) {
+			if (sql_hash_table_spill_record(ht, e->data,
+							e->size) != 0)
+				return -1;
+		}
+	}
+	free(ht->buckets);
+	ht->buckets = NULL;
+	ht->bucket_count = 0;
+	ht->first_group = ht->last_group = NULL;
+	region_free(&ht->arena);
+	return 0;
+}
+
+struct sql_hash_table *
+sql_hash_table_new(const struct key_def *key_def, uint32_t field_count)
+{
+	uint32_t part_count = key_def->part_count;
+	assert(part_count > 0 && part_count <= field_count);
+	/*
+	 * Keys may contain NULLs regardless of the key types, and the
+	 * order of keys doesn't matter. Keys are compared as scalars,
+	 * like in the ephemeral space the table is spilled to, so that
+	 * equal keys have equal hashes, see sql_hash_field().
+	 */
+	struct region *region = &fiber()->gc;
+	size_t svp = region_used(region);
+	struct key_part_def *parts =
+		xregion_alloc_array(region, struct key_part_def, part_count);
+	key_def_dump_parts(key_def, parts, region);
+	for (uint32_t i = 0; i < part_count; i++) {
+		parts[i].is_nullable = true;
+		parts[i].nullable_action = ON_CONFLICT_ACTION_NONE;
+		parts[i].sort_order = SORT_ORDER_ASC;
+		parts[i].type = FIELD_TYPE_SCALAR;
+	}
+	struct key_def *ht_key_def = key_def_new(parts, part_count, 0);
+	region_truncate(region, svp);
+	if (ht_key_def == NULL)
+		return NULL;
+	struct sql_hash_table *ht = xcalloc(1, sizeof(*ht));
+	ht->key_def = ht_key_def;
+	ht->field_count = field_count;
+	ht->bucket_count = SQL_HASH_TABLE_MIN_BUCKETS;
+	ht->buckets = xcalloc(ht->bucket_count, sizeof(ht->buckets[0]));
+	ht->memory_limit = SQL_HASH_TABLE_MEMORY_LIMIT;
+	struct errinj *inj = errinj(ERRINJ_SQL_HASH_TABLE_MEMORY, ERRINJ_INT);
+	if (inj != NULL && inj->iparam >= 0)
+		ht->memory_limit = inj->iparam;
+	region_create(&ht->arena, &cord()->slabc);
+	return ht;
+}
+
+void
+sql_hash_table_delete(struct sql_hash_table *ht)
+{
+	if (ht->it != NULL)
+		iterator_delete(ht->it);
+	if (ht->space != NULL)
+		space_delete(ht->space);
+	free(ht->key);
+	free(ht->buckets);
+	region_destroy(&ht->arena);
+	key_def_delete(ht->key_def);
+	free(ht);
+}
+
+int
+sql_hash_table_insert(struct sql_hash_table *ht, const char *data,
+		      uint32_t size)
+{
+	if (ht->space == NULL &&
+	    sql_hash_table_memory(ht) + size > ht->memory_limit &&
+	    sql_hash_table_spill(ht) != 0)
+		return -1;
+	if (ht->space != NULL)
+		return sql_hash_table_spill_record(ht, data, size);
+	struct sql_hash_entry *entry;
+	size_t entry_size = sizeof(*entry) + size;
+	entry = region_aligned_alloc(&ht->arena, entry_size, alignof(*entry));
+	if (entry == NULL) {
+		diag_set(OutOfMemory, entry_size, "region_aligned_alloc",
+			 "entry");
+		return -1;
+	}
+	memcpy(entry->data, data, size);
+	entry->size = size;
+	entry->next_dup = NULL;
+	const char *key = sql_hash_record_fields(entry->data);
+	entry->hash = sql_hash_key(ht->key_def, key);
+	struct sql_hash_entry *head = sql_hash_table_find(ht, key, entry->hash);
+	if (head != NULL) {
+		head->last_dup->next_dup = entry;
+		head->last_dup = entry;
+		return 0;
+	}
+	struct sql_hash_entry **b =
+		&ht->buckets[entry->hash & (ht->bucket_count - 1)];
+	entry->next_in_bucket = *b;
+	*b = entry;
+	entry->last_dup = entry;
+	entry->next_group = NULL;
+	if (ht->last_group != NULL)
+		ht->last_group->next_group = entry;
+	else
+		ht->first_group = entry;
+	ht->last_group = entry;
+	if (++ht->group_count > ht->bucket_count)
+		return sql_hash_table_grow(ht);
+	return 0;
+}
+
+/** Advance the ephemeral space iterator. */
+static int
+sql_hash_table_iterator_next(struct sql_hash_table *ht, int *eof)
+{
+	if (iterator_next(ht->it, &ht->tuple) != 0)
+		return -1;
+	*eof = ht->tuple == NULL;
+	return 0;
+}
+
+/** Open an iterator over the ephemeral space and fetch the first tuple. */
+static int
+sql_hash_table_iterator_open(struct sql_hash_table *ht, enum iterator_type type,
+			     const char *key, uint32_t part_count, int *eof)
+{
+	if (ht->it != NULL)
+		iterator_delete(ht->it);
+	ht->tuple = NULL;
+	ht->it = index_create_iterator(ht->space->index[0], type, key,
+				       part_count);
+	if (ht->it == NULL)
+		return -1;
+	return sql_hash_table_iterator_next(ht, eof);
+}
+
+int
+sql_hash_table_rewind(struct sql_hash_table *ht, int *eof)
+{
+	ht->is_seek = false;
+	if (ht->space != NULL) {
+		return sql_hash_table_iterator_open(ht, ITER_ALL, NULL, 0,
+						    eof);
+	}
+	ht->group = ht->entry = ht->first_group;
+	*eof = ht->entry == NULL;
+	return 0;
+}
+
+int
+sql_hash_table_seek(struct sql_hash_table *ht, const char *key,
+		    uint32_t key_size, int *eof)
+{
+	ht->is_seek = true;
+	uint32_t part_count = ht->key_def->part_count;
+	if (ht->space != NULL) {
+		/* The iterator refers to the key, so keep a copy of it. */
+		if (key_size > ht->key_size) {
+			ht->key = xrealloc(ht->key, key_size);
+			ht->key_size = key_size;
+		}
+		memcpy(ht->key, key, key_size);
+		return sql_hash_table_iterator_open(ht, ITER_EQ, ht->key,
+						    part_count, eof);
+	}
+	key = sql_hash_record_fields(key);
+	uint32_t hash = sql_hash_key(ht->key_def, key);
+	ht->group = ht->entry = sql_hash_table_find(ht, key, hash);
+	*eof = ht->entry == NULL;
+	return 0;
+}
+
+int
+sql_hash_table_next(struct sql_hash_table *ht, int *eof)
+{
+	if (ht->space != NULL)
+		return sql_hash_table_iterator_next(ht, eof);
+	assert(ht->entry != NULL);
+	if (ht->entry->next_dup != NULL) {
+		ht->entry = ht->entry->next_dup;
+	} else if (!ht->is_seek) {
+		ht->group = ht->entry = ht->group->next_group;
+	} else {
+		ht->entry = NULL;
+	}
+	*eof = ht->entry == NULL;
+	return 0;
+}
+
+void
+sql_hash_table_data(struct sql_hash_table *ht, const char **data,
+		    uint32_t *size)
+{
+	if (ht->space != NULL) {
+		assert(ht->tuple != NULL);
+		*data = tuple_data_range(ht->tuple, size);
+		return;
+	}
+	assert(ht->entry != NULL);
+	*data = ht->entry->data;
+	*size = ht->entry->size;
+}
@@ -44,6 +44,7 @@
 #include "vdbeInt.h"
 #include "whereInt.h"
 #include "box/coll_id_cache.h"
+#include "box/index.h"
 #include "box/schema.h"
 
 /** Increase the memory allocation for p->aLTerm[] to be at least n. */
@@ -713,40 +714,47 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
 }
 
 /**
- * Generate a code that will create a tuple, which is supposed to be inserted
- * in the ephemeral index space. The created tuple consists of rowid and
- * fields described in the index key description.
+ * Generate a code that will create a record, which is supposed to be inserted
+ * in the hash table of an automatic index, and insert it. The created record
+ * consists of fields described in the index key description. Rows having NULL
+ * in any of the first @a key_count fields are skipped since they can't match
+ * an equality constraint.
  *
  * @param parse Parsing context.
  * @param key_def The index key description.
+ * @param key_count Number of the index parts used for the lookup.
  * @param cursor Cursor of source space from which values for tuple are fetched.
- * @param reg_out Register to contain the created tuple.
- * @param reg_eph Register holding pointer to ephemeral index.
+ * @param hash_cursor Cursor of the hash table.
  */
 static void
-vdbe_emit_ephemeral_index_tuple(struct Parse *parse,
-				const struct key_def *key_def, int cursor,
-				int reg_out, int reg_eph)
+vdbe_emit_hash_index_insert(struct Parse *parse, const struct key_def *key_def,
+			    uint32_t key_count, int cursor, int hash_cursor)
 {
-	assert(reg_out != 0);
 	struct Vdbe *v = parse->pVdbe;
 	int col_cnt = key_def->part_count;
-	int reg_base = sqlGetTempRange(parse, col_cnt + 1);
+	int reg_base = sqlGetTempRange(parse, col_cnt);
+	int reg_record = sqlGetTempReg(parse);
+	int label_skip = sqlVdbeMakeLabel(v);
 	for (int j = 0; j < col_cnt; j++) {
 		uint32_t tabl_col = key_def->parts[j].fieldno;
 		sqlVdbeAddOp3(v, OP_Column, cursor, tabl_col, reg_base + j);
+		if ((uint32_t)j < key_count &&
+		    key_part_is_nullable(&key_def->parts[j]))
+			sqlVdbeAddOp2(v, OP_IsNull, reg_base + j, label_skip);
 	}
-	sqlVdbeAddOp2(v, OP_NextIdEphemeral, reg_eph, reg_base + col_cnt);
-	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, col_cnt + 1, reg_out);
-	sqlReleaseTempRange(parse, reg_base, col_cnt + 1);
+	sqlVdbeAddOp3(v, OP_MakeRecord, reg_base, col_cnt, reg_record);
+	sqlVdbeAddOp2(v, OP_HashInsert, hash_cursor, reg_record);
+	sqlVdbeResolveLabel(v, label_skip);
+	sqlReleaseTempReg(parse, reg_record);
+	sqlReleaseTempRange(parse, reg_base, col_cnt);
 }
 
 /*
- * Generate code to construct the ephemeral space that contains all used in
+ * Generate code to construct the hash table that contains all used in
  * query fields of one of the tables that participate in the query. The source
- * table is determined by query planner. This ephemeral space will be known as
- * an "ephemeral index". The PK definition of ephemeral index contains all of
- * its fields. Also, this functions set up the WhereLevel object pLevel so
+ * table is determined by query planner. This hash table will be known as
+ * an "ephemeral index". Its key consists of the fields constrained by the
+ * equality terms. Also, this functions set up the WhereLevel object pLevel so
  * that the code generator makes use of ephemeral index.
  */
 static void
@@ -762,7 +770,6 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	Vdbe *v;		/* Prepared statement under construction */
 	int addrInit;		/* Address of the initialization bypass jump */
 	int addrTop;		/* Top of the index fill loop */
-	int regRecord;		/* Register holding an index record */
 	int n;			/* Column counter */
 	int i;			/* Loop counter */
 	int mxBitCol;		/* Maximum column in pSrc->colUsed */
@@ -906,15 +913,17 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	}
 	pLoop->index_def = idx_def;
 
-	/* Create the automatic index */
+	/*
+	 * Create the automatic index. It is a hash table so that it is built
+	 * in linear time and each lookup costs O(1), which turns the nested
+	 * loop into a hash join.
+	 */
 	assert(pLevel->iIdxCur >= 0);
 	pLevel->iIdxCur = pParse->nTab++;
-	struct sql_space_info *info = sql_space_info_new_from_index_def(idx_def,
-									true);
-	int reg_eph = sqlGetTempReg(pParse);
-	sqlVdbeAddOp4(v, OP_OpenTEphemeral, reg_eph, 0, 0, (char *)info,
-		      P4_DYNAMIC);
-	sqlVdbeAddOp3(v, OP_IteratorOpen, pLevel->iIdxCur, 0, reg_eph);
+	struct sql_key_info *key_info =
+		sql_key_info_new_from_key_def(idx_def->key_def, pLoop->nEq);
+	sqlVdbeAddOp4(v, OP_HashOpen, pLevel->iIdxCur, nKeyCol, 0,
+		      (char *)key_info, P4_KEYINFO);
 	VdbeComment((v, "for %s", space->def->name));
 
 	/* Fill the automatic index with content */
@@ -922,15 +931,11 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
 	assert(pWC->pWInfo->pTabList->a[pLevel->iFrom].fg.viaCoroutine == 0);
 	int cursor = pLevel->iTabCur;
 	addrTop = sqlVdbeAddOp1(v, OP_Rewind, cursor);
-	regRecord = sqlGetTempReg(pParse);
-	vdbe_emit_ephemeral_index_tuple(pParse, idx_def->key_def, cursor,
-					regRecord, reg_eph);
-	sqlVdbeAddOp2(v, OP_IdxInsert, regRecord, reg_eph);
+	vdbe_emit_hash_index_insert(pParse, idx_def->key_def, pLoop->nEq,
+				    cursor, pLevel->iIdxCur);
 	sqlVdbeAddOp2(v, OP_Next, cursor, addrTop + 1);
 	sqlVdbeChangeP5(v, SQL_STMTSTATUS_AUTOINDEX);
 	sqlVdbeJumpHere(v, addrTop);
-	sqlReleaseTempReg(pParse, regRecord);
-	sqlReleaseTempReg(pParse, reg_eph);
 	sqlExprCachePop(pParse);
 
 	/* Jump here when skipping the initialization */
@@ -963,6 +968,142 @@ whereRangeAdjust(WhereTerm * pTerm, LogEst nNew)
 	return nRet;
 }
 
+/**
+ * Set @a mem to the value of a literal used as a range bound. Return false
+ * if the expression isn't a numeric or string literal, i.e. its value isn't
+ * known at compile time.
+ */
+static bool
+where_literal_to_mem(struct Expr *expr, struct Mem *mem)
+{
+	expr = sqlExprSkipCollate(expr);
+	bool is_neg = false;
+	if (expr->op == TK_UMINUS) {
+		is_neg = true;
+		expr = expr->pLeft;
+	}
+	switch (expr->op) {
+	case TK_INTEGER: {
+		int64_t value;
+		if (ExprHasProperty(expr, EP_IntValue)) {
+			value = expr->u.iValue;
+		} else {
+			const char *z = expr->u.zToken;
+			bool unused;
+			if (z[0] == '0' && (z[1] == 'x' || z[1] == 'X'))
+				return false;
+			if (sql_atoi64(z, &value, &unused, strlen(z)) != 0 ||
+			    (uint64_t)value > INT64_MAX)
+				return false;
+		}
+		is_neg = is_neg && value != 0;
+		mem_set_int(mem, is_neg ? -value : value, is_neg);
+		return true;
+	}
+	case TK_FLOAT: {
+		double value;
+		const char *z = expr->u.zToken;
+		sqlAtoF(z, &value, sqlStrlen30(z));
+		mem_set_double(mem, is_neg ? -value : value);
+		return true;
+	}
+	case TK_STRING:
+		if (is_neg)
+			return false;
+		mem_set_str0_static(mem, expr->u.zToken);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Check if the first key part value stored in a histogram sample satisfies
+ * the given range constraint.
+ */
+static bool
+where_sample_is_in_range(const char *sample, const struct Mem *bound,
+			 u16 op, const struct coll *coll)
+{
+	int cmp;
+	if (mem_cmp_msgpack(bound, &sample, &cmp, coll) != 0) {
+		diag_clear(diag_get());
+		return true;
+	}
+	switch (op) {
+	case WO_GT:
+		return cmp < 0;
+	case WO_GE:
+		return cmp <= 0;
+	case WO_LT:
+		return cmp > 0;
+	default:
+		assert(op == WO_LE);
+		return cmp >= 0;
+	}
+}
+
+/**
+ * Estimate the share of the index covered by a range scan on the first
+ * key part using the histogram collected by ANALYZE. On success, set
+ * @a est to the logarithmic estimate of the number of rows visited by the
+ * scan and return 0. If there's no histogram or the bounds aren't known
+ * at compile time, return -1.
+ */
+static int
+whereRangeHistogramEst(struct WhereTerm *pLower, struct WhereTerm *pUpper,
+		       struct WhereLoop *pLoop, LogEst *est)
+{
+	struct index_def *def = pLoop->index_def;
+	if (def == NULL || pLoop->nEq != 0 || pLoop->nBtm > 1 ||
+	    pLoop->nTop > 1)
+		return -1;
+	const struct index_stat *stat = sql_index_stat(def);
+	if (stat == NULL || stat->sample_count == 0)
+		return -1;
+	struct WhereTerm *terms[2] = {pLower, pUpper};
+	struct Mem bounds[2];
+	u16 ops[2];
+	int count = 0;
+	for (int i = 0; i < 2; i++) {
+		if (terms[i] == NULL)
+			continue;
+		/* An explicit likelihood() takes precedence. */
+		if (terms[i]->truthProb <= 0)
+			return -1;
+		mem_create(&bounds[count]);
+		if (!where_literal_to_mem(terms[i]->pExpr->pRight,
+					  &bounds[count]))
+			return -1;
+		ops[count] = terms[i]->eOperator & (WO_GT | WO_GE |
+						     WO_LT | WO_LE);
+		count++;
+	}
+	assert(count > 0);
+	struct key_part *part = &def->key_def->parts[0];
+	uint32_t matched = 0;
+	for (uint32_t i = 0; i < stat->sample_count; i++) {
+		bool is_in_range = true;
+		for (int j = 0; j < count && is_in_range; j++) {
+			is_in_range = where_sample_is_in_range(
+				stat->samples[i], &bounds[j], ops[j],
+				part->coll);
+		}
+		if (is_in_range)
+			matched++;
+	}
+	/*
+	 * TUNING: if no sample falls into the range, assume that it covers
+	 * a half of a histogram bucket.
+	 */
+	if (matched == 0)
+		*est = pLoop->nOut - sqlLogEst(stat->sample_count) - 10;
+	else
+		*est = pLoop->nOut + sqlLogEst(matched) -
+		       sqlLogEst(stat->sample_count);
+	return 0;
+}
+
 /*
  * This function is used to estimate the number of rows that will be visited
  * by scanning an index for a range of values. The range may have an upper
@@ -998,10 +1139,12 @@ whereRangeAdjust(WhereTerm * pTerm, LogEst nNew)
  * rows in the index. Assuming no error occurs, *pnOut is adjusted (reduced)
  * to account for the range constraints pLower and pUpper.
  *
- * In the absence of _sql_stat4 ANALYZE data, or if such data cannot be
- * used, a single range inequality reduces the search space by a factor of 4.
- * and a pair of constraints (x>? AND x<?) reduces the expected number of
- * rows visited by a factor of 64.
+ * If ANALYZE has built a histogram for the index and the range is on the
+ * first key part and bounded by literals, the estimate is the share of
+ * histogram samples falling into the range. Otherwise, a single range
+ * inequality reduces the search space by a factor of 4. and a pair of
+ * constraints (x>? AND x<?) reduces the expected number of rows visited by
+ * a factor of 64.
  */
 static int
 whereRangeScanEst(struct WhereTerm *pLower, struct WhereTerm *pUpper,
@@ -1011,6 +1154,14 @@ whereRangeScanEst(struct WhereTerm *pLower, struct WhereTerm *pUpper,
 	int nOut = pLoop->nOut;
 	LogEst nNew;
 	assert(pUpper == 0 || (pUpper->wtFlags & TERM_VNULL) == 0);
+	if (whereRangeHistogramEst(pLower, pUpper, pLoop, &nNew) == 0) {
+		if (nNew < 10)
+			nNew = 10;
+		if (nNew < nOut)
+			nOut = nNew;
+		pLoop->nOut = (LogEst) nOut;
+		return rc;
+	}
 	nNew = whereRangeAdjust(pLower, nOut);
 	nNew = whereRangeAdjust(pUpper, nNew);
 
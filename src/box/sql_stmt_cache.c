@@ -34,10 +34,16 @@
 #include "error.h"
 #include "execute.h"
 #include "diag.h"
+#include "fiber.h"
 #include "info/info.h"
+#include "schema.h"
+#include "session.h"
+#include "sql/sqlInt.h"
 
 static struct sql_stmt_cache sql_stmt_cache;
 
+static struct sql_plan_cache sql_plan_cache;
+
 void
 sql_stmt_cache_init(void)
 {
@@ -45,6 +51,12 @@ sql_stmt_cache_init(void)
 	sql_stmt_cache.mem_quota = 0;
 	sql_stmt_cache.mem_used = 0;
 	rlist_create(&sql_stmt_cache.gc_queue);
+	sql_plan_cache.hash = mh_strnptr_new();
+	sql_plan_cache.in_use = mh_i64ptr_new();
+	sql_plan_cache.mem_used = 0;
+	rlist_create(&sql_plan_cache.lru);
+	sql_plan_cache.hits = 0;
+	sql_plan_cache.misses = 0;
 }
 
 void
@@ -59,9 +71,224 @@ sql_stmt_cache_stat(struct info_handler *h)
 		entry_count++;
 	info_append_int(h, "stmt_count", entry_count);
 	info_table_end(h);
+	info_table_begin(h, "plan_cache");
+	info_append_int(h, "size", sql_plan_cache.mem_used);
+	info_append_int(h, "stmt_count", mh_size(sql_plan_cache.hash));
+	info_append_int(h, "hits", sql_plan_cache.hits);
+	info_append_int(h, "misses", sql_plan_cache.misses);
+	info_table_end(h);
 	info_end(h);
 }
 
+/** Remove an entry from the plan cache and delete it. */
+static void
+sql_plan_cache_delete(struct plan_cache_entry *entry)
+{
+	struct sql_plan_cache *cache = &sql_plan_cache;
+	mh_int_t i = mh_strnptr_find_str(cache->hash, entry->key,
+					 entry->key_len);
+	assert(i != mh_end(cache->hash));
+	mh_strnptr_del(cache->hash, i, NULL);
+	rlist_del(&entry->in_lru);
+	cache->mem_used -= entry->size;
+	sql_stmt_finalize(entry->stmt);
+	TRASH(entry);
+	free(entry);
+}
+
+/**
+ * Evict the least recently used statements from the plan cache until
+ * an entry of the given size fits in the memory limit. Return false if
+ * it doesn't fit even if the plan cache is empty.
+ */
+static bool
+sql_plan_cache_evict(size_t size)
+{
+	struct sql_plan_cache *cache = &sql_plan_cache;
+	while (sql_stmt_cache.mem_used + cache->mem_used + size >
+	       sql_stmt_cache.mem_quota) {
+		if (rlist_empty(&cache->lru))
+			return false;
+		sql_plan_cache_delete(rlist_last_entry(&cache->lru,
+						       struct plan_cache_entry,
+						       in_lru));
+	}
+	return true;
+}
+
+/**
+ * Build the plan cache key of SQL text compiled with the given session
+ * SQL flags on the fiber region. The key consists of the flags and the
+ * text with whitespace and comments replaced with single spaces, so the
+ * same key means the same sequence of tokens. Return NULL if the text
+ * can't be tokenized.
+ */
+static char *
+sql_plan_cache_key(const char *sql, uint32_t len, uint32_t sql_flags,
+		   uint32_t *key_len)
+{
+	if (memchr(sql, '\0', len) != NULL)
+		return NULL;
+	struct region *region = &fiber()->gc;
+	/* The tokenizer needs a null-terminated string. */
+	char *str = xregion_alloc(region, len + 1);
+	memcpy(str, sql, len);
+	str[len] = '\0';
+	char *key = xregion_alloc(region, sizeof(sql_flags) + len);
+	memcpy(key, &sql_flags, sizeof(sql_flags));
+	char *pos = key + sizeof(sql_flags);
+	bool need_space = false;
+	for (uint32_t i = 0; i < len;) {
+		int type;
+		bool unused;
+		int n = sql_token(&str[i], &type, &unused);
+		if (type == TK_ILLEGAL)
+			return NULL;
+		if (type == TK_SPACE || type == TK_LINEFEED) {
+			need_space = pos != key + sizeof(sql_flags);
+		} else {
+			if (need_space)
+				*pos++ = ' ';
+			need_space = false;
+			memcpy(pos, &str[i], n);
+			pos += n;
+		}
+		i += n;
+	}
+	*key_len = pos - key;
+	return key;
+}
+
+struct Vdbe *
+sql_plan_cache_get(const char *sql, uint32_t len)
+{
+	struct sql_plan_cache *cache = &sql_plan_cache;
+	if (sql_stmt_cache.mem_quota == 0)
+		return NULL;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t key_len;
+	const char *key = sql_plan_cache_key(sql, len,
+					     current_session()->sql_flags,
+					     &key_len);
+	struct plan_cache_entry *entry = NULL;
+	if (key != NULL) {
+		mh_int_t i = mh_strnptr_find_str(cache->hash, key, key_len);
+		if (i != mh_end(cache->hash))
+			entry = mh_strnptr_node(cache->hash, i)->val;
+	}
+	region_truncate(region, region_svp);
+	if (entry != NULL &&
+	    sql_stmt_schema_version(entry->stmt) != box_schema_version()) {
+		sql_plan_cache_delete(entry);
+		entry = NULL;
+	}
+	if (entry == NULL) {
+		cache->misses++;
+		return NULL;
+	}
+	cache->hits++;
+	mh_int_t i = mh_strnptr_find_str(cache->hash, entry->key,
+					 entry->key_len);
+	mh_strnptr_del(cache->hash, i, NULL);
+	rlist_del(&entry->in_lru);
+	cache->mem_used -= entry->size;
+	struct mh_i64ptr_node_t node = {(uintptr_t)entry->stmt, entry};
+	mh_i64ptr_put(cache->in_use, &node, NULL, NULL);
+	return entry->stmt;
+}
+
+/** Allocate a plan cache entry for a statement not taken from the cache. */
+static struct plan_cache_entry *
+sql_plan_cache_entry_new(struct Vdbe *stmt)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	const char *sql_str = sql_stmt_query_str(stmt);
+	uint32_t key_len;
+	const char *key = sql_plan_cache_key(sql_str, strlen(sql_str),
+					     sql_stmt_flags(stmt), &key_len);
+	struct plan_cache_entry *entry = NULL;
+	if (key != NULL) {
+		entry = xmalloc(sizeof(*entry) + key_len);
+		entry->stmt = stmt;
+		entry->is_stale = false;
+		entry->key_len = key_len;
+		memcpy(entry->key, key, key_len);
+		entry->size = sizeof(*entry) + key_len +
+			      sql_stmt_est_size(stmt);
+	}
+	region_truncate(region, region_svp);
+	return entry;
+}
+
+/**
+ * Add an entry to the plan cache. Return false if there's already an
+ * entry with the same key or the entry doesn't fit in the memory limit.
+ */
+static bool
+sql_plan_cache_insert(struct plan_cache_entry *entry)
+{
+	struct sql_plan_cache *cache = &sql_plan_cache;
+	/* Another fiber may have cached the same statement meanwhile. */
+	if (mh_strnptr_find_str(cache->hash, entry->key,
+				entry->key_len) != mh_end(cache->hash))
+		return false;
+	if (!sql_plan_cache_evict(entry->size))
+		return false;
+	struct mh_strnptr_node_t node = {
+		entry->key, entry->key_len,
+		mh_strn_hash(entry->key, entry->key_len), entry,
+	};
+	mh_strnptr_put(cache->hash, &node, NULL, NULL);
+	rlist_add_entry(&cache->lru, entry, in_lru);
+	cache->mem_used += entry->size;
+	return true;
+}
+
+void
+sql_plan_cache_put(struct Vdbe *stmt)
+{
+	struct sql_plan_cache *cache = &sql_plan_cache;
+	sql_stmt_reset(stmt);
+	sql_unbind(stmt);
+	sql_reset_autoinc_id_list(stmt);
+	struct plan_cache_entry *entry = NULL;
+	mh_int_t i = mh_i64ptr_find(cache->in_use, (uintptr_t)stmt, NULL);
+	if (i != mh_end(cache->in_use)) {
+		entry = mh_i64ptr_node(cache->in_use, i)->val;
+		mh_i64ptr_del(cache->in_use, i, NULL);
+	}
+	/* Statements that changed the schema are never reused. */
+	if (sql_stmt_schema_version(stmt) == box_schema_version() &&
+	    sql_stmt_cache.mem_quota > 0 &&
+	    (entry == NULL || !entry->is_stale)) {
+		if (entry == NULL)
+			entry = sql_plan_cache_entry_new(stmt);
+		if (entry != NULL && sql_plan_cache_insert(entry))
+			return;
+	}
+	free(entry);
+	sql_stmt_finalize(stmt);
+}
+
+void
+sql_plan_cache_flush(void)
+{
+	struct sql_plan_cache *cache = &sql_plan_cache;
+	while (!rlist_empty(&cache->lru)) {
+		sql_plan_cache_delete(rlist_first_entry(&cache->lru,
+							struct plan_cache_entry,
+							in_lru));
+	}
+	mh_int_t i;
+	mh_foreach(cache->in_use, i) {
+		struct plan_cache_entry *entry =
+			mh_i64ptr_node(cache->in_use, i)->val;
+		entry->is_stale = true;
+	}
+}
+
 static size_t
 sql_cache_entry_sizeof(struct Vdbe *stmt)
 {
@@ -248,6 +475,10 @@ sql_stmt_cache_insert(struct Vdbe *stmt)
 			"active statements or increase SQL cache size.");
 		return -1;
 	}
+	/* Make room for the statement at the expense of the plan cache. */
+	bool is_evicted = sql_plan_cache_evict(new_entry_size);
+	assert(is_evicted);
+	(void)is_evicted;
 	struct mh_i32ptr_t *hash = cache->hash;
 	struct stmt_cache_entry *entry = sql_cache_entry_new(stmt);
 	if (entry == NULL)
@@ -284,5 +515,6 @@ sql_stmt_cache_set_size(size_t size)
 		return -1;
 	}
 	sql_stmt_cache.mem_quota = size;
+	sql_plan_cache_evict(0);
 	return 0;
 }
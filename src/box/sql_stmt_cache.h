@@ -30,6 +30,7 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -40,6 +41,7 @@ extern "C" {
 #endif
 
 struct mh_i64ptr_t;
+struct mh_strnptr_t;
 struct info_handler;
 
 struct stmt_cache_entry {
@@ -83,6 +85,50 @@ struct sql_stmt_cache {
 	struct stmt_cache_entry *last_found;
 };
 
+struct plan_cache_entry {
+	/** Compiled statement. */
+	struct Vdbe *stmt;
+	/** Link in sql_plan_cache::lru. */
+	struct rlist in_lru;
+	/** Size of memory accounted in sql_plan_cache::mem_used. */
+	size_t size;
+	/**
+	 * Set if the cache was flushed while the statement was taken
+	 * for execution, so it mustn't be put back.
+	 */
+	bool is_stale;
+	/** Length of the key. */
+	uint32_t key_len;
+	/** Cache key, see sql_plan_cache_get(). Not null-terminated. */
+	char key[0];
+};
+
+/**
+ * Global cache of statements compiled to execute SQL text passed to
+ * box.execute() or IPROTO_EXECUTE. Unlike prepared statements, cached
+ * statements aren't referenced by sessions and are evicted in the LRU
+ * order. The cache shares the sql_cache_size memory limit with prepared
+ * statements, which have priority: cached statements are evicted to
+ * make room for a prepared statement.
+ */
+struct sql_plan_cache {
+	/** Size of memory currently occupied by cached statements. */
+	size_t mem_used;
+	/** Cache key -> struct plan_cache_entry hash. */
+	struct mh_strnptr_t *hash;
+	/** Cached statements, the most recently used first. */
+	struct rlist lru;
+	/**
+	 * Statements taken from the cache for execution:
+	 * struct Vdbe -> struct plan_cache_entry hash.
+	 */
+	struct mh_i64ptr_t *in_use;
+	/** Number of lookups that found a statement in the cache. */
+	uint64_t hits;
+	/** Number of lookups that didn't. */
+	uint64_t misses;
+};
+
 /**
  * Initialize global cache for prepared statements. Called once
  * during database setup (in sql_init()).
@@ -146,6 +192,31 @@ sql_stmt_cache_find(uint32_t stmt_id);
 int
 sql_stmt_cache_set_size(size_t size);
 
+/**
+ * Find a statement compiled from SQL text equal to the given one up to
+ * whitespace and comments with the current session SQL settings. The
+ * statement is taken out of the cache for the time of execution and
+ * should be returned with sql_plan_cache_put(). Return NULL if there's
+ * no such statement.
+ */
+struct Vdbe *
+sql_plan_cache_get(const char *sql, uint32_t len);
+
+/**
+ * Reset a statement executed by sql_prepare_and_execute() and put it to
+ * the plan cache. The statement is finalized if it can't be cached.
+ */
+void
+sql_plan_cache_put(struct Vdbe *stmt);
+
+/**
+ * Drop all statements from the plan cache, e.g. because they were
+ * planned with outdated index statistics. Statements being executed
+ * are dropped when they are put back.
+ */
+void
+sql_plan_cache_flush(void);
+
 #if defined(__cplusplus)
 } /* extern "C" { */
 #endif
@@ -30,6 +30,16 @@
  */
 #include "tuple.h"
 
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif /* defined(__linux__) */
+
 #include "trivia/util.h"
 #include "memory.h"
 #include "fiber.h"
@@ -37,6 +47,7 @@
 #include "small/small.h"
 #include "xrow_update.h"
 #include "coll_id_cache.h"
+#include "tt_strerror.h"
 
 static struct mempool tuple_iterator_pool;
 static struct small_alloc runtime_alloc;
@@ -428,6 +439,155 @@ tuple_arena_destroy(struct slab_arena *arena)
 	slab_arena_destroy(arena);
 }
 
+const char *tuple_arena_huge_pages_strs[] = {
+	[TUPLE_ARENA_HUGE_PAGES_OFF] = "off",
+	[TUPLE_ARENA_HUGE_PAGES_TRANSPARENT] = "transparent",
+	[TUPLE_ARENA_HUGE_PAGES_2M] = "2M",
+	[TUPLE_ARENA_HUGE_PAGES_1G] = "1G",
+	[tuple_arena_huge_pages_MAX] = NULL,
+};
+
+#if defined(__linux__)
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+/**
+ * Prefer the NUMA node of the calling thread for the given memory
+ * area. It's no-op if the kernel doesn't support NUMA.
+ */
+static void
+tuple_arena_bind_local_node(void *ptr, size_t size)
+{
+	unsigned cpu, node;
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0)
+		return;
+	unsigned long nodemask[16] = {0};
+	if (node >= sizeof(nodemask) * CHAR_BIT)
+		return;
+	nodemask[node / (sizeof(nodemask[0]) * CHAR_BIT)] |=
+		1UL << (node % (sizeof(nodemask[0]) * CHAR_BIT));
+	if (syscall(SYS_mbind, ptr, size, MPOL_PREFERRED, nodemask,
+		    sizeof(nodemask) * CHAR_BIT, 0) != 0) {
+		say_verbose("failed to bind the tuple arena to NUMA node %u: %s",
+			    node, tt_strerror(errno));
+		return;
+	}
+	say_info("tuple arena is bound to NUMA node %u", node);
+}
+
+/**
+ * Map an area of explicit huge pages aligned to the given
+ * alignment. Returns NULL if there aren't enough huge pages.
+ */
+static void *
+tuple_arena_map_huge_pages(size_t size, size_t page_size, size_t align)
+{
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+	flags |= (page_size == (1ULL << 30) ? 30 : 21) << MAP_HUGE_SHIFT;
+	/* A huge page aligned area may need trimming. */
+	size_t extra = align > page_size ? align - page_size : 0;
+	char *map = mmap(NULL, size + extra, PROT_READ | PROT_WRITE, flags,
+			 -1, 0);
+	if (map == MAP_FAILED)
+		return NULL;
+	char *ptr = (char *)small_align((uintptr_t)map, align);
+	if (ptr > map)
+		munmap(map, ptr - map);
+	if (map + size + extra > ptr + size)
+		munmap(ptr + size, map + size + extra - (ptr + size));
+	return ptr;
+}
+
+enum tuple_arena_huge_pages
+tuple_arena_use_huge_pages(struct slab_arena *arena,
+			   enum tuple_arena_huge_pages huge_pages)
+{
+	assert(arena->used == 0);
+	if (huge_pages == TUPLE_ARENA_HUGE_PAGES_OFF || arena->prealloc == 0)
+		return TUPLE_ARENA_HUGE_PAGES_OFF;
+	if (huge_pages != TUPLE_ARENA_HUGE_PAGES_TRANSPARENT) {
+		size_t page_size = huge_pages == TUPLE_ARENA_HUGE_PAGES_1G ?
+				   1ULL << 30 : 2ULL << 20;
+		size_t size = small_align(arena->prealloc, page_size);
+		void *ptr = tuple_arena_map_huge_pages(size, page_size,
+						       arena->slab_size);
+		if (ptr != NULL) {
+			/* The area is not used yet, just replace it. */
+			munmap(arena->arena, arena->prealloc);
+			arena->arena = ptr;
+			arena->prealloc = size;
+			if ((arena->flags & SLAB_ARENA_DONTDUMP) != 0)
+				(void)madvise(ptr, size, MADV_DONTDUMP);
+			tuple_arena_bind_local_node(ptr, size);
+			say_info("tuple arena is backed by %s huge pages",
+				 tuple_arena_huge_pages_strs[huge_pages]);
+			return huge_pages;
+		}
+		say_warn("failed to map %zu bytes of %s huge pages: %s, "
+			 "falling back to transparent huge pages", size,
+			 tuple_arena_huge_pages_strs[huge_pages],
+			 tt_strerror(errno));
+	}
+	if (madvise(arena->arena, arena->prealloc, MADV_HUGEPAGE) != 0) {
+		say_warn("failed to enable transparent huge pages for "
+			 "the tuple arena: %s", tt_strerror(errno));
+		return TUPLE_ARENA_HUGE_PAGES_OFF;
+	}
+	tuple_arena_bind_local_node(arena->arena, arena->prealloc);
+	say_info("tuple arena is backed by transparent huge pages");
+	return TUPLE_ARENA_HUGE_PAGES_TRANSPARENT;
+}
+
+size_t
+tuple_arena_huge_pages_used(struct slab_arena *arena)
+{
+	uintptr_t begin = (uintptr_t)arena->arena;
+	uintptr_t end = begin + MIN(arena->used, arena->prealloc);
+	FILE *f = fopen("/proc/self/smaps", "r");
+	if (f == NULL)
+		return 0;
+	size_t total = 0;
+	bool in_arena = false;
+	char line[256];
+	while (fgets(line, sizeof(line), f) != NULL) {
+		uintptr_t vma_begin, vma_end;
+		size_t kb;
+		if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " ",
+			   &vma_begin, &vma_end) == 2) {
+			in_arena = vma_begin < end && vma_end > begin;
+		} else if (in_arena &&
+			   (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1 ||
+			    sscanf(line, "Private_Hugetlb: %zu kB", &kb) == 1)) {
+			total += kb * 1024;
+		}
+	}
+	fclose(f);
+	return MIN(total, end - begin);
+}
+
+#else /* !defined(__linux__) */
+
+enum tuple_arena_huge_pages
+tuple_arena_use_huge_pages(struct slab_arena *arena,
+			   enum tuple_arena_huge_pages huge_pages)
+{
+	(void)arena;
+	if (huge_pages != TUPLE_ARENA_HUGE_PAGES_OFF)
+		say_warn("huge pages are not supported on this platform");
+	return TUPLE_ARENA_HUGE_PAGES_OFF;
+}
+
+size_t
+tuple_arena_huge_pages_used(struct slab_arena *arena)
+{
+	(void)arena;
+	return 0;
+}
+
+#endif /* !defined(__linux__) */
+
 void
 tuple_free(void)
 {
@@ -75,6 +75,43 @@ tuple_arena_create(struct slab_arena *arena, struct quota *quota,
 void
 tuple_arena_destroy(struct slab_arena *arena);
 
+/** Kinds of pages backing a tuple arena. */
+enum tuple_arena_huge_pages {
+	/** Regular pages. */
+	TUPLE_ARENA_HUGE_PAGES_OFF,
+	/** Transparent huge pages, see madvise(MADV_HUGEPAGE). */
+	TUPLE_ARENA_HUGE_PAGES_TRANSPARENT,
+	/** Explicit 2 MB huge pages, see mmap(MAP_HUGETLB). */
+	TUPLE_ARENA_HUGE_PAGES_2M,
+	/** Explicit 1 GB huge pages, see mmap(MAP_HUGETLB). */
+	TUPLE_ARENA_HUGE_PAGES_1G,
+	tuple_arena_huge_pages_MAX,
+};
+
+extern const char *tuple_arena_huge_pages_strs[];
+
+/**
+ * Back the preallocated area of a tuple arena with huge pages to
+ * reduce TLB misses on random memory access. Must be called right
+ * after tuple_arena_create(), before any slab is allocated.
+ *
+ * If there are not enough reserved explicit huge pages, the arena
+ * falls back to transparent huge pages. Huge pages are preferably
+ * allocated on the NUMA node of the calling thread.
+ *
+ * @return The kind of pages actually backing the arena.
+ */
+enum tuple_arena_huge_pages
+tuple_arena_use_huge_pages(struct slab_arena *arena,
+			   enum tuple_arena_huge_pages huge_pages);
+
+/**
+ * Return the number of bytes of the used part of a tuple arena
+ * that are backed by huge pages.
+ */
+size_t
+tuple_arena_huge_pages_used(struct slab_arena *arena);
+
 /**
  * Creates a new format for standalone tuples.
  * Tuples created with the new format are allocated from the runtime arena.
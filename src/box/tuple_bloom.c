@@ -209,7 +209,8 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 
 	if (bloom->is_legacy) {
 		return bloom_maybe_has(&bloom->parts[0],
-				       tuple_hash(tuple, key_def));
+				       key_def->tuple_hash_murmur(tuple,
+								  key_def));
 	}
 
 	assert(bloom->part_count == key_def->part_count);
@@ -238,7 +239,7 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 		if (part_count < key_def->part_count)
 			return true;
 		return bloom_maybe_has(&bloom->parts[0],
-				       key_hash(key, key_def));
+				       key_def->key_hash_murmur(key, key_def));
 	}
 
 	assert(part_count <= key_def->part_count);
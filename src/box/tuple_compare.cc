@@ -2106,6 +2106,256 @@ tuple_hint_stub(struct tuple *tuple, struct key_def *key_def)
 	return HINT_NONE;
 }
 
+/*
+ * Multipart hints.
+ *
+ * A multipart hint packs compact 32-bit hints of the first two key
+ * parts into one hint_t:
+ *
+ *      <-- part 1 hint (32 bits) --> <-- part 2 hint (32 bits) -->
+ *
+ * The compact hint of the first part is "exact" if no two unequal
+ * values can have it. The second part is encoded only if the first
+ * part hint is exact, otherwise the lower bits are zero. Therefore
+ * if two multipart hints differ, their upper halves either differ,
+ * too, or are equal and exact, which means that the first parts are
+ * equal and the second part hints define the order.
+ *
+ * Only boolean and integer first parts are supported, because their
+ * compact hints are exact for all values but huge ones. This is what
+ * composite indexes with a low-cardinality first part (status, tenant
+ * id) look like. The second part may be boolean, integer, string or
+ * varbinary. The maximal value of the first part hint is never used,
+ * so a multipart hint can't be equal to HINT_NONE.
+ *
+ * A key hint is HINT_NONE unless the key has at least two parts,
+ * since a partial key is equal to tuples with any second part.
+ */
+#define HINT32_NIL		0
+/** Hint of all integers less than the exact range. */
+#define HINT32_INT_LOW		1
+/** Hint of all integers greater than the exact range. */
+#define HINT32_INT_HIGH		(UINT32_MAX - 1)
+/** Integers in [HINT32_INT_MIN, HINT32_INT_MAX] have exact hints. */
+#define HINT32_INT_MIN		(INT32_MIN + 2)
+#define HINT32_INT_MAX		(INT32_MAX - 2)
+
+static inline uint32_t
+hint32_int(int64_t i, bool *is_exact)
+{
+	*is_exact = i >= HINT32_INT_MIN && i <= HINT32_INT_MAX;
+	if (i < HINT32_INT_MIN)
+		return HINT32_INT_LOW;
+	if (i > HINT32_INT_MAX)
+		return HINT32_INT_HIGH;
+	return (uint32_t)(i - INT32_MIN);
+}
+
+static inline uint32_t
+hint32_uint(uint64_t u, bool *is_exact)
+{
+	if (u > HINT32_INT_MAX) {
+		*is_exact = false;
+		return HINT32_INT_HIGH;
+	}
+	return hint32_int(u, is_exact);
+}
+
+static inline uint32_t
+hint32_bool(bool b)
+{
+	return b ? 3 : 2;
+}
+
+static inline uint32_t
+hint32_str(const char *s, uint32_t len)
+{
+	uint32_t val = 0;
+	for (uint32_t i = 0; i < sizeof(val); i++) {
+		val <<= CHAR_BIT;
+		if (i < len)
+			val |= (unsigned char)s[i];
+	}
+	return val;
+}
+
+/** Compact hint of the first key part. */
+template <enum field_type type, bool is_nullable>
+static inline uint32_t
+field_hint32(const char *field, bool *is_exact)
+{
+	*is_exact = true;
+	if (is_nullable && (field == NULL || mp_typeof(*field) == MP_NIL))
+		return HINT32_NIL;
+	switch (type) {
+	case FIELD_TYPE_BOOLEAN:
+		return hint32_bool(mp_decode_bool(&field));
+	case FIELD_TYPE_UNSIGNED:
+		return hint32_uint(mp_decode_uint(&field), is_exact);
+	case FIELD_TYPE_INTEGER:
+		if (mp_typeof(*field) == MP_UINT)
+			return hint32_uint(mp_decode_uint(&field), is_exact);
+		return hint32_int(mp_decode_int(&field), is_exact);
+	default:
+		unreachable();
+	}
+	return HINT32_NIL;
+}
+
+/** Compact hint of the second key part. */
+static inline uint32_t
+key_part_hint32(struct key_part *part, const char *field)
+{
+	if (field == NULL || mp_typeof(*field) == MP_NIL)
+		return HINT32_NIL;
+	bool unused;
+	uint32_t len;
+	switch (mp_typeof(*field)) {
+	case MP_BOOL:
+		return hint32_bool(mp_decode_bool(&field));
+	case MP_UINT:
+		return hint32_uint(mp_decode_uint(&field), &unused);
+	case MP_INT:
+		return hint32_int(mp_decode_int(&field), &unused);
+	case MP_STR:
+		len = mp_decode_strl(&field);
+		if (part->coll != NULL) {
+			char buf[sizeof(uint32_t)];
+			len = part->coll->hint(field, len, buf, sizeof(buf),
+					       part->coll);
+			return hint32_str(buf, len);
+		}
+		return hint32_str(field, len);
+	case MP_BIN:
+		len = mp_decode_binl(&field);
+		return hint32_str(field, len);
+	default:
+		unreachable();
+	}
+	return HINT32_NIL;
+}
+
+template<enum field_type type, bool is_nullable, bool has_desc_parts>
+static inline hint_t
+multipart_hint(const char *field1, const char *field2,
+	       struct key_def *key_def)
+{
+	bool is_exact;
+	uint32_t h1 = field_hint32<type, is_nullable>(field1, &is_exact);
+	uint32_t h2 = 0;
+	if (is_exact)
+		h2 = key_part_hint32(&key_def->parts[1], field2);
+	if (has_desc_parts) {
+		if (key_def->parts[0].sort_order == SORT_ORDER_DESC)
+			h1 = HINT32_INT_HIGH - h1;
+		if (is_exact &&
+		    key_def->parts[1].sort_order == SORT_ORDER_DESC)
+			h2 = UINT32_MAX - h2;
+	}
+	return (hint_t)h1 << 32 | h2;
+}
+
+template<enum field_type type, bool is_nullable, bool has_desc_parts>
+static hint_t
+key_hint_multipart(const char *key, uint32_t part_count,
+		   struct key_def *key_def)
+{
+	assert(!key_def->is_multikey);
+	if (part_count < 2)
+		return HINT_NONE;
+	const char *field2 = key;
+	mp_next(&field2);
+	return multipart_hint<type, is_nullable, has_desc_parts>(key, field2,
+								 key_def);
+}
+
+template<enum field_type type, bool is_nullable, bool has_desc_parts>
+static hint_t
+tuple_hint_multipart(struct tuple *tuple, struct key_def *key_def)
+{
+	assert(!key_def->is_multikey);
+	const char *field1 = tuple_field_by_part(tuple, &key_def->parts[0],
+						 MULTIKEY_NONE);
+	const char *field2 = tuple_field_by_part(tuple, &key_def->parts[1],
+						 MULTIKEY_NONE);
+	return multipart_hint<type, is_nullable, has_desc_parts>(field1, field2,
+								 key_def);
+}
+
+template<enum field_type type, bool is_nullable>
+static void
+key_def_set_multipart_hint_func(struct key_def *def)
+{
+	if (key_def_has_desc_parts(def)) {
+		def->key_hint = key_hint_multipart<type, is_nullable, true>;
+		def->tuple_hint = tuple_hint_multipart<type, is_nullable, true>;
+	} else {
+		def->key_hint = key_hint_multipart<type, is_nullable, false>;
+		def->tuple_hint =
+			tuple_hint_multipart<type, is_nullable, false>;
+	}
+}
+
+template<enum field_type type>
+static void
+key_def_set_multipart_hint_func(struct key_def *def)
+{
+	if (key_part_is_nullable(def->parts))
+		key_def_set_multipart_hint_func<type, true>(def);
+	else
+		key_def_set_multipart_hint_func<type, false>(def);
+}
+
+/**
+ * Set multipart hint functions if the key_def parts allow it.
+ * Returns false if the regular hints must be used instead.
+ */
+static bool
+key_def_set_multipart_hint_func(struct key_def *def)
+{
+	if (def->part_count < 2)
+		return false;
+	switch (def->parts[1].type) {
+	case FIELD_TYPE_BOOLEAN:
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_UINT8:
+	case FIELD_TYPE_UINT16:
+	case FIELD_TYPE_UINT32:
+	case FIELD_TYPE_UINT64:
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_INT8:
+	case FIELD_TYPE_INT16:
+	case FIELD_TYPE_INT32:
+	case FIELD_TYPE_INT64:
+	case FIELD_TYPE_STRING:
+	case FIELD_TYPE_VARBINARY:
+		break;
+	default:
+		return false;
+	}
+	switch (def->parts[0].type) {
+	case FIELD_TYPE_BOOLEAN:
+		key_def_set_multipart_hint_func<FIELD_TYPE_BOOLEAN>(def);
+		return true;
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_UINT8:
+	case FIELD_TYPE_UINT16:
+	case FIELD_TYPE_UINT32:
+	case FIELD_TYPE_UINT64:
+		key_def_set_multipart_hint_func<FIELD_TYPE_UNSIGNED>(def);
+		return true;
+	case FIELD_TYPE_INTEGER:
+	case FIELD_TYPE_INT8:
+	case FIELD_TYPE_INT16:
+	case FIELD_TYPE_INT32:
+	case FIELD_TYPE_INT64:
+		key_def_set_multipart_hint_func<FIELD_TYPE_INTEGER>(def);
+		return true;
+	default:
+		return false;
+	}
+}
+
 template<enum field_type type, bool is_nullable, bool has_desc_parts>
 static void
 key_def_set_hint_func(struct key_def *def)
@@ -2142,6 +2392,8 @@ key_def_set_hint_func(struct key_def *def)
 		def->tuple_hint = tuple_hint_stub;
 		return;
 	}
+	if (def->use_multipart_hint && key_def_set_multipart_hint_func(def))
+		return;
 	switch (def->parts->type) {
 	case FIELD_TYPE_BOOLEAN:
 		key_def_set_hint_func<FIELD_TYPE_BOOLEAN>(def);
@@ -2409,3 +2661,10 @@ key_def_set_compare_func(struct key_def *def)
 	}
 	key_def_set_hint_func(def);
 }
+
+void
+key_def_set_multipart_hint(struct key_def *def, bool value)
+{
+	def->use_multipart_hint = value;
+	key_def_set_hint_func(def);
+}
@@ -30,6 +30,7 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include <stdbool.h>
 #include <stdint.h>
 
 #if defined(__cplusplus)
@@ -96,6 +97,13 @@ hint_cmp(hint_t hint_a, hint_t hint_b)
 void
 key_def_set_compare_func(struct key_def *def);
 
+/**
+ * Enable or disable multipart hints for the key_def and update its
+ * hint functions accordingly. See key_def::use_multipart_hint.
+ */
+void
+key_def_set_multipart_hint(struct key_def *def, bool value);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
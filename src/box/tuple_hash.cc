@@ -35,13 +35,23 @@
 #include "coll/coll.h"
 #include <math.h>
 
-/* Tuple and key hasher */
-namespace {
+#define XXH_INLINE_ALL
+#include "xxhash.h"
 
 enum {
 	HASH_SEED = 13U
 };
 
+static uint32_t
+tuple_hash_null(uint32_t *ph1, uint32_t *pcarry);
+
+static uint64_t
+tuple_hash_field_xxh3(uint64_t h, const char **field,
+		      enum field_type type, struct coll *coll);
+
+/* Tuple and key hasher */
+namespace {
+
 template <int TYPE>
 static inline uint32_t
 field_hash(uint32_t *ph, uint32_t *pcarry, const char **field)
@@ -92,117 +102,170 @@ field_hash<FIELD_TYPE_STRING>(uint32_t *ph, uint32_t *pcarry,
 	return size;
 }
 
-template <int TYPE, int ...MORE_TYPES> struct KeyFieldHash {};
+/** XXH3 counterpart of field_hash(): hashes the same bytes. */
+template <int TYPE>
+static inline void
+field_hash_xxh3(uint64_t *ph, const char **field)
+{
+	static_assert(TYPE != FIELD_TYPE_STRING, "See field_hash().");
+	static_assert(TYPE != FIELD_TYPE_DOUBLE, "See field_hash().");
+	const char *f = *field;
+	mp_next(field);
+	*ph = XXH3_64bits_withSeed(f, *field - f, *ph);
+}
+
+template <>
+inline void
+field_hash_xxh3<FIELD_TYPE_STRING>(uint64_t *ph, const char **field)
+{
+	uint32_t size;
+	const char *f = mp_decode_str(field, &size);
+	*ph = XXH3_64bits_withSeed(f, size, *ph);
+}
+
+/**
+ * Running Murmur3 hash, see key_def::tuple_hash_murmur.
+ */
+struct MurmurHasher {
+	uint32_t h = HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
 
-template <int TYPE, int TYPE2, int ...MORE_TYPES>
-struct KeyFieldHash<TYPE, TYPE2, MORE_TYPES...> {
-	static void hash(uint32_t *ph, uint32_t *pcarry,
-			 const char **pfield, uint32_t *ptotal_size)
+	template <int TYPE>
+	void field(const char **pfield)
+	{
+		total_size += field_hash<TYPE>(&h, &carry, pfield);
+	}
+	void field(const char **pfield, enum field_type type,
+		   struct coll *coll)
 	{
-		*ptotal_size += field_hash<TYPE>(ph, pcarry, pfield);
-		KeyFieldHash<TYPE2, MORE_TYPES...>::
-			hash(ph, pcarry, pfield, ptotal_size);
+		total_size += tuple_hash_field(&h, &carry, pfield, type, coll);
+	}
+	void null()
+	{
+		total_size += tuple_hash_null(&h, &carry);
+	}
+	uint32_t result()
+	{
+		return PMurHash32_Result(h, carry, total_size);
 	}
 };
 
-template <int TYPE>
-struct KeyFieldHash<TYPE> {
-	static void hash(uint32_t *ph, uint32_t *pcarry,
-			 const char **pfield, uint32_t *ptotal_size)
+/**
+ * Running XXH3 hash: every field is hashed with the hash of the
+ * previous fields used as the seed. Unlike PMurHash32, XXH3 reads
+ * short inputs with a few unaligned loads instead of a byte loop.
+ */
+struct Xxh3Hasher {
+	uint64_t h = HASH_SEED;
+
+	template <int TYPE>
+	void field(const char **pfield)
+	{
+		field_hash_xxh3<TYPE>(&h, pfield);
+	}
+	void field(const char **pfield, enum field_type type,
+		   struct coll *coll)
 	{
-		*ptotal_size += field_hash<TYPE>(ph, pcarry, pfield);
+		h = tuple_hash_field_xxh3(h, pfield, type, coll);
+	}
+	void null()
+	{
+		const char null = 0xc0;
+		h = XXH3_64bits_withSeed(&null, 1, h);
+	}
+	uint32_t result()
+	{
+		return (uint32_t)(h ^ (h >> 32));
 	}
 };
 
-template <int TYPE, int ...MORE_TYPES>
-struct KeyHash {
-	static uint32_t hash(const char *key, struct key_def *)
+template <class Hasher, int ...TYPES> struct FieldHash {};
+
+template <class Hasher, int TYPE, int ...MORE_TYPES>
+struct FieldHash<Hasher, TYPE, MORE_TYPES...> {
+	static void hash(Hasher *hasher, const char **pfield)
 	{
-		uint32_t h = HASH_SEED;
-		uint32_t carry = 0;
-		uint32_t total_size = 0;
-		KeyFieldHash<TYPE, MORE_TYPES...>::hash(&h, &carry, &key,
-							&total_size);
-		return PMurHash32_Result(h, carry, total_size);
+		hasher->template field<TYPE>(pfield);
+		FieldHash<Hasher, MORE_TYPES...>::hash(hasher, pfield);
 	}
 };
 
-template <>
-struct KeyHash<FIELD_TYPE_UNSIGNED> {
-	static uint32_t hash(const char *key, struct key_def *key_def)
+template <class Hasher>
+struct FieldHash<Hasher> {
+	static void hash(Hasher *, const char **)
 	{
-		uint64_t val = mp_decode_uint(&key);
-		(void) key_def;
-		if (likely(val <= UINT32_MAX))
-			return val;
-		return ((uint32_t)((val)>>33^(val)^(val)<<11));
 	}
 };
 
-template <int TYPE, int ...MORE_TYPES> struct TupleFieldHash { };
+static inline uint32_t
+unsigned_hash(uint64_t val)
+{
+	if (likely(val <= UINT32_MAX))
+		return val;
+	return ((uint32_t)((val)>>33^(val)^(val)<<11));
+}
 
-template <int TYPE, int TYPE2, int ...MORE_TYPES>
-struct TupleFieldHash<TYPE, TYPE2, MORE_TYPES...> {
-	static void hash(const char **pfield, uint32_t *ph, uint32_t *pcarry,
-			 uint32_t *ptotal_size)
+template <class Hasher, int TYPE, int ...MORE_TYPES>
+struct KeyHash {
+	static uint32_t hash(const char *key, struct key_def *)
 	{
-		*ptotal_size += field_hash<TYPE>(ph, pcarry, pfield);
-		TupleFieldHash<TYPE2, MORE_TYPES...>::
-			hash(pfield, ph, pcarry, ptotal_size);
+		Hasher hasher;
+		FieldHash<Hasher, TYPE, MORE_TYPES...>::hash(&hasher, &key);
+		return hasher.result();
 	}
 };
 
-template <int TYPE>
-struct TupleFieldHash<TYPE> {
-	static void hash(const char **pfield, uint32_t *ph, uint32_t *pcarry,
-			 uint32_t *ptotal_size)
+template <class Hasher>
+struct KeyHash<Hasher, FIELD_TYPE_UNSIGNED> {
+	static uint32_t hash(const char *key, struct key_def *key_def)
 	{
-		*ptotal_size += field_hash<TYPE>(ph, pcarry, pfield);
+		(void) key_def;
+		return unsigned_hash(mp_decode_uint(&key));
 	}
 };
 
-template <int TYPE, int ...MORE_TYPES>
+template <class Hasher, int TYPE, int ...MORE_TYPES>
 struct TupleHash
 {
 	static uint32_t hash(struct tuple *tuple, struct key_def *key_def)
 	{
 		assert(!key_def->is_multikey);
-		uint32_t h = HASH_SEED;
-		uint32_t carry = 0;
-		uint32_t total_size = 0;
+		Hasher hasher;
 		const char *field = tuple_field_by_part(tuple,
 						key_def->parts,
 						MULTIKEY_NONE);
-		TupleFieldHash<TYPE, MORE_TYPES...>::
-			hash(&field, &h, &carry, &total_size);
-		return PMurHash32_Result(h, carry, total_size);
+		FieldHash<Hasher, TYPE, MORE_TYPES...>::hash(&hasher, &field);
+		return hasher.result();
 	}
 };
 
-template <>
-struct TupleHash<FIELD_TYPE_UNSIGNED> {
+template <class Hasher>
+struct TupleHash<Hasher, FIELD_TYPE_UNSIGNED> {
 	static uint32_t	hash(struct tuple *tuple, struct key_def *key_def)
 	{
 		assert(!key_def->is_multikey);
 		const char *field = tuple_field_by_part(tuple,
 						key_def->parts,
 						MULTIKEY_NONE);
-		uint64_t val = mp_decode_uint(&field);
-		if (likely(val <= UINT32_MAX))
-			return val;
-		return ((uint32_t)((val)>>33^(val)^(val)<<11));
+		return unsigned_hash(mp_decode_uint(&field));
 	}
 };
 
 }; /* namespace { */
 
 #define HASHER(...) \
-	{ KeyHash<__VA_ARGS__>::hash, TupleHash<__VA_ARGS__>::hash, \
+	{ KeyHash<Xxh3Hasher, __VA_ARGS__>::hash, \
+	  TupleHash<Xxh3Hasher, __VA_ARGS__>::hash, \
+	  KeyHash<MurmurHasher, __VA_ARGS__>::hash, \
+	  TupleHash<MurmurHasher, __VA_ARGS__>::hash, \
 		{ __VA_ARGS__, UINT32_MAX } },
 
 struct hasher_signature {
 	key_hash_t kf;
 	tuple_hash_t tf;
+	key_hash_t murmur_kf;
+	tuple_hash_t murmur_tf;
 	uint32_t p[64];
 };
 
@@ -228,13 +291,33 @@ static const hasher_signature hash_arr[] = {
 
 #undef HASHER
 
-template <bool has_optional_parts, bool has_json_paths>
+template <class Hasher, bool has_optional_parts, bool has_json_paths>
 uint32_t
 tuple_hash_slowpath(struct tuple *tuple, struct key_def *key_def);
 
+template <class Hasher>
 static uint32_t
 key_hash_slowpath(const char *key, struct key_def *key_def);
 
+template <class Hasher>
+static void
+key_def_set_hash_slowpath(struct key_def *key_def, tuple_hash_t *tuple_hash,
+			  key_hash_t *key_hash)
+{
+	if (key_def->has_optional_parts) {
+		if (key_def->has_json_paths)
+			*tuple_hash = tuple_hash_slowpath<Hasher, true, true>;
+		else
+			*tuple_hash = tuple_hash_slowpath<Hasher, true, false>;
+	} else {
+		if (key_def->has_json_paths)
+			*tuple_hash = tuple_hash_slowpath<Hasher, false, true>;
+		else
+			*tuple_hash = tuple_hash_slowpath<Hasher, false, false>;
+	}
+	*key_hash = key_hash_slowpath<Hasher>;
+}
+
 void
 key_def_set_hash_func(struct key_def *key_def) {
 	if (key_def->is_nullable || key_def->has_json_paths)
@@ -266,33 +349,31 @@ key_def_set_hash_func(struct key_def *key_def) {
 		if (i == key_def->part_count && hash_arr[k].p[i] == UINT32_MAX){
 			key_def->tuple_hash = hash_arr[k].tf;
 			key_def->key_hash = hash_arr[k].kf;
+			key_def->tuple_hash_murmur = hash_arr[k].murmur_tf;
+			key_def->key_hash_murmur = hash_arr[k].murmur_kf;
 			return;
 		}
 	}
 
 slowpath:
-	if (key_def->has_optional_parts) {
-		if (key_def->has_json_paths)
-			key_def->tuple_hash = tuple_hash_slowpath<true, true>;
-		else
-			key_def->tuple_hash = tuple_hash_slowpath<true, false>;
-	} else {
-		if (key_def->has_json_paths)
-			key_def->tuple_hash = tuple_hash_slowpath<false, true>;
-		else
-			key_def->tuple_hash = tuple_hash_slowpath<false, false>;
-	}
-	key_def->key_hash = key_hash_slowpath;
+	key_def_set_hash_slowpath<Xxh3Hasher>(key_def, &key_def->tuple_hash,
+					      &key_def->key_hash);
+	key_def_set_hash_slowpath<MurmurHasher>(key_def,
+						&key_def->tuple_hash_murmur,
+						&key_def->key_hash_murmur);
 }
 
-uint32_t
-tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
-		 enum field_type type, struct coll *coll)
+/**
+ * Get the bytes representing a field for hashing and advance @a field
+ * past it. @a buf must be big enough to store MP_INT/MP_UINT/MP_DOUBLE.
+ * Strings with a collation are hashed by the collation and must not
+ * get here.
+ */
+static inline const char *
+field_hash_data(const char **field, enum field_type type, char *buf,
+		uint32_t *size)
 {
-	char buf[9]; /* enough to store MP_INT/MP_UINT/MP_DOUBLE */
 	const char *f = *field;
-	uint32_t size;
-
 	/*
 	 * MsgPack values of double key field are casted to double, encoded
 	 * as msgpack double and hashed. This assures the same value being
@@ -316,10 +397,9 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 		if (mp_read_double_lossy(field, &value) == -1)
 			unreachable();
 		char *double_msgpack_end = mp_encode_double(buf, value);
-		size = double_msgpack_end - buf;
-		assert(size <= sizeof(buf));
-		PMurHash32_Process(ph1, pcarry, buf, size);
-		return size;
+		*size = double_msgpack_end - buf;
+		assert(*size <= 9);
+		return buf;
 	}
 
 	switch (mp_typeof(**field)) {
@@ -330,9 +410,7 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 		 * with old third-party MsgPack (spec-old.md) implementations.
 		 * \sa https://github.com/tarantool/tarantool/issues/522
 		 */
-		f = mp_decode_str(field, &size);
-		if (coll != NULL)
-			return coll->hash(f, size, ph1, pcarry, coll);
+		f = mp_decode_str(field, size);
 		break;
 	case MP_FLOAT:
 	case MP_DOUBLE: {
@@ -348,7 +426,7 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 			     mp_decode_double(field);
 		if (!isfinite(val) || modf(val, &iptr) != 0 ||
 		    val < -exp2(63) || val >= exp2(64)) {
-			size = *field - f;
+			*size = *field - f;
 			break;
 		}
 		char *data;
@@ -356,14 +434,14 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 			data = mp_encode_uint(buf, (uint64_t)val);
 		else
 			data = mp_encode_int(buf, (int64_t)val);
-		size = data - buf;
-		assert(size <= sizeof(buf));
+		*size = data - buf;
+		assert(*size <= 9);
 		f = buf;
 		break;
 	}
 	default:
 		mp_next(field);
-		size = *field - f;  /* calculate the size of field */
+		*size = *field - f;  /* calculate the size of field */
 		/*
 		 * (!) All other fields hashed **including** MsgPack format
 		 * identifier (e.g. 0xcc). This was done **intentionally**
@@ -374,12 +452,50 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 		 */
 		break;
 	}
-	assert(size < INT32_MAX);
+	assert(*size < INT32_MAX);
+	return f;
+}
+
+uint32_t
+tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
+		 enum field_type type, struct coll *coll)
+{
+	char buf[9]; /* enough to store MP_INT/MP_UINT/MP_DOUBLE */
+	uint32_t size;
+	if (coll != NULL && mp_typeof(**field) == MP_STR) {
+		const char *f = mp_decode_str(field, &size);
+		return coll->hash(f, size, ph1, pcarry, coll);
+	}
+	const char *f = field_hash_data(field, type, buf, &size);
 	PMurHash32_Process(ph1, pcarry, f, size);
 	return size;
 }
 
-static inline uint32_t
+static uint64_t
+tuple_hash_field_xxh3(uint64_t h, const char **field,
+		      enum field_type type, struct coll *coll)
+{
+	char buf[9]; /* enough to store MP_INT/MP_UINT/MP_DOUBLE */
+	uint32_t size;
+	if (coll != NULL && mp_typeof(**field) == MP_STR) {
+		/*
+		 * Collations can only feed a Murmur3 hash, so hash
+		 * its result: equal strings must have equal hashes
+		 * in terms of the collation rather than bytes.
+		 */
+		const char *f = mp_decode_str(field, &size);
+		uint32_t coll_h = HASH_SEED;
+		uint32_t carry = 0;
+		uint32_t total_size = coll->hash(f, size, &coll_h, &carry,
+						 coll);
+		coll_h = PMurHash32_Result(coll_h, carry, total_size);
+		return XXH3_64bits_withSeed(&coll_h, sizeof(coll_h), h);
+	}
+	const char *f = field_hash_data(field, type, buf, &size);
+	return XXH3_64bits_withSeed(f, size, h);
+}
+
+static uint32_t
 tuple_hash_null(uint32_t *ph1, uint32_t *pcarry)
 {
 	assert(mp_sizeof_nil() == 1);
@@ -398,7 +514,7 @@ tuple_hash_key_part(uint32_t *ph1, uint32_t *pcarry, struct tuple *tuple,
 	return tuple_hash_field(ph1, pcarry, &field, part->type, part->coll);
 }
 
-template <bool has_optional_parts, bool has_json_paths>
+template <class Hasher, bool has_optional_parts, bool has_json_paths>
 uint32_t
 tuple_hash_slowpath(struct tuple *tuple, struct key_def *key_def)
 {
@@ -406,9 +522,7 @@ tuple_hash_slowpath(struct tuple *tuple, struct key_def *key_def)
 	assert(has_optional_parts == key_def->has_optional_parts);
 	assert(!key_def->is_multikey);
 	assert(!key_def->for_func_index);
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
-	uint32_t total_size = 0;
+	Hasher hasher;
 	uint32_t prev_fieldno = key_def->parts[0].fieldno;
 	struct tuple_format *format = tuple_format(tuple);
 	const char *tuple_raw = tuple_data(tuple);
@@ -423,11 +537,10 @@ tuple_hash_slowpath(struct tuple *tuple, struct key_def *key_def)
 	}
 	const char *end = (char *)tuple + tuple_size(tuple);
 	if (has_optional_parts && field == NULL) {
-		total_size += tuple_hash_null(&h, &carry);
+		hasher.null();
 	} else {
-		total_size += tuple_hash_field(&h, &carry, &field,
-					       key_def->parts[0].type,
-					       key_def->parts[0].coll);
+		hasher.field(&field, key_def->parts[0].type,
+			     key_def->parts[0].coll);
 	}
 	for (uint32_t part_id = 1; part_id < key_def->part_count; part_id++) {
 		/* If parts of key_def are not sequential we need to call
@@ -446,31 +559,23 @@ tuple_hash_slowpath(struct tuple *tuple, struct key_def *key_def)
 			}
 		}
 		if (has_optional_parts && (field == NULL || field >= end)) {
-			total_size += tuple_hash_null(&h, &carry);
+			hasher.null();
 		} else {
-			total_size +=
-				tuple_hash_field(&h, &carry, &field,
-						 key_def->parts[part_id].type,
-						 key_def->parts[part_id].coll);
+			hasher.field(&field, key_def->parts[part_id].type,
+				     key_def->parts[part_id].coll);
 		}
 		prev_fieldno = key_def->parts[part_id].fieldno;
 	}
-
-	return PMurHash32_Result(h, carry, total_size);
+	return hasher.result();
 }
 
+template <class Hasher>
 static uint32_t
 key_hash_slowpath(const char *key, struct key_def *key_def)
 {
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
-	uint32_t total_size = 0;
-
+	Hasher hasher;
 	for (struct key_part *part = key_def->parts;
-	     part < key_def->parts + key_def->part_count; part++) {
-		total_size += tuple_hash_field(&h, &carry, &key, part->type,
-					       part->coll);
-	}
-
-	return PMurHash32_Result(h, carry, total_size);
+	     part < key_def->parts + key_def->part_count; part++)
+		hasher.field(&key, part->type, part->coll);
+	return hasher.result();
 }
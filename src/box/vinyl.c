@@ -71,6 +71,7 @@
 #include "column_mask.h"
 #include "trigger.h"
 #include "wal.h" /* wal_mode() */
+#include "qsort_arg.h"
 
 /**
  * Yield after iterating over this many objects (e.g. ranges).
@@ -678,6 +679,30 @@ vinyl_space_check_index_def(struct space *space, struct index_def *index_def)
 			 "hint is only reasonable with memtx tree index");
 		return -1;
 	}
+	if (index_def->opts.layout != INDEX_HASH_LAYOUT_CHAINED) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "layout is only reasonable with memtx hash index");
+		return -1;
+	}
+	if (index_def->opts.hash_func != INDEX_HASH_FUNC_MURMUR) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hash_func is only reasonable with memtx hash index");
+		return -1;
+	}
+	if (index_def->opts.hint_parts != 1) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "hint_parts is only reasonable with memtx tree index");
+		return -1;
+	}
+	if (index_def->opts.key_prefix) {
+		diag_set(ClientError, ER_MODIFY_INDEX, index_def->name,
+			 space_name(space),
+			 "key_prefix is only reasonable with memtx tree index");
+		return -1;
+	}
 
 	struct key_def *key_def = index_def->key_def;
 
@@ -4446,6 +4471,647 @@ vinyl_space_build_index(struct space *src_space, struct index *new_index,
 
 /* }}} Index build */
 
+/* {{{ Bulk load */
+
+/**
+ * Default size of memory used for accumulating tuples before
+ * writing them to disk.
+ */
+enum { VY_BULK_LOAD_MEMORY_DEFAULT = 128 * 1024 * 1024 };
+
+/** Bulk load state of an LSM tree. */
+struct vy_bulk_load_lsm {
+	/** LSM tree to load data to (referenced). */
+	struct vy_lsm *lsm;
+	/** Statements accumulated for the next run (referenced). */
+	struct vy_entry *entries;
+	/** Number of statements in the entries array. */
+	size_t entry_count;
+	/** Capacity of the entries array. */
+	size_t entry_capacity;
+	/** Run that is being written. */
+	struct vy_run *new_run;
+	/** Runs written so far, not committed to vylog yet. */
+	struct vy_run **runs;
+	/** Number of runs in the runs array. */
+	int run_count;
+	/** Fiber writing new_run. */
+	struct fiber *writer;
+	/**
+	 * Copies of the LSM tree key definitions used by coio threads
+	 * while new_run is written: the originals may be updated in
+	 * place by the tx thread on alter, see vinyl_index_update_def().
+	 */
+	struct key_def *cmp_def;
+	struct key_def *key_def;
+	/** Page size of new_run, copied for the same reason. */
+	int64_t page_size;
+	/** Bloom filter false positive rate of new_run. */
+	double bloom_fpr;
+};
+
+struct vy_bulk_load {
+	/** Vinyl environment. */
+	struct vy_env *env;
+	/** Space to load data to. */
+	struct space *space;
+	/** Bulk load state of each index of the space. */
+	struct vy_bulk_load_lsm *lsms;
+	/** Number of indexes in the space. */
+	uint32_t lsm_count;
+	/** LSN assigned to all loaded statements. */
+	int64_t lsn;
+	/** Last statement added to the primary index (referenced). */
+	struct vy_entry last;
+	/** Max size of memory used for accumulating statements. */
+	size_t memory_limit;
+	/** Size of memory used for accumulated statements. */
+	size_t memory_used;
+	/** Set if a unique secondary index needs to be loaded. */
+	bool has_unique_secondary;
+	/** Trigger that fails DML requests during bulk load. */
+	struct trigger on_replace;
+};
+
+/**
+ * on_replace trigger installed on a space during bulk load.
+ * Bulk load assumes that the space stays empty until it's
+ * committed so concurrent DML requests are not allowed.
+ */
+static int
+vy_bulk_load_on_replace(struct trigger *trigger, void *event)
+{
+	(void)trigger;
+	(void)event;
+	diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+		 "DML on a space that is being bulk loaded");
+	return -1;
+}
+
+/**
+ * Check that a space can be (still) bulk loaded: it's empty,
+ * hasn't been altered or dropped, and vinyl is online.
+ */
+static int
+vy_bulk_load_check_space(struct vy_bulk_load *bl)
+{
+	if (bl->env->status != VINYL_ONLINE) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "bulk load during recovery");
+		return -1;
+	}
+	struct space *space = space_by_id(space_id(bl->space));
+	if (space != bl->space || space->index_count != bl->lsm_count) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "altering a space that is being bulk loaded");
+		return -1;
+	}
+	struct trigger *trigger;
+	rlist_foreach_entry(trigger, &space->on_replace, link) {
+		if (trigger->run == vy_bulk_load_on_replace &&
+		    trigger != &bl->on_replace) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+				 "concurrent bulk loads into the same space");
+			return -1;
+		}
+	}
+	for (uint32_t i = 0; i < bl->lsm_count; i++) {
+		struct vy_lsm *lsm = bl->lsms[i].lsm;
+		if (lsm->is_dropped || vy_lsm(space->index[i]) != lsm) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+				 "altering a space that is being bulk loaded");
+			return -1;
+		}
+		if (!vy_lsm_is_empty(lsm) || lsm->run_count > 0 ||
+		    !rlist_empty(&lsm->sealed)) {
+			diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+				 "bulk load into a non-empty space");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+struct vy_bulk_load *
+vinyl_bulk_load_new(struct space *space, size_t memory)
+{
+	assert(space_is_vinyl(space));
+	struct vy_env *env = vy_env(space->engine);
+	if (space->index_count == 0) {
+		diag_set(ClientError, ER_NO_SUCH_INDEX_ID, 0,
+			 space_name(space));
+		return NULL;
+	}
+	struct vy_bulk_load *bl = xcalloc(1, sizeof(*bl));
+	bl->env = env;
+	bl->space = space;
+	bl->lsm_count = space->index_count;
+	bl->lsms = xcalloc(bl->lsm_count, sizeof(*bl->lsms));
+	bl->last = vy_entry_none();
+	bl->memory_limit = memory > 0 ? memory : VY_BULK_LOAD_MEMORY_DEFAULT;
+	trigger_create(&bl->on_replace, vy_bulk_load_on_replace, NULL, NULL);
+	for (uint32_t i = 0; i < bl->lsm_count; i++) {
+		struct vy_lsm *lsm = vy_lsm(space->index[i]);
+		vy_lsm_ref(lsm);
+		bl->lsms[i].lsm = lsm;
+		if (i > 0 && lsm->opts.is_unique)
+			bl->has_unique_secondary = true;
+	}
+	if (vy_bulk_load_check_space(bl) != 0) {
+		vinyl_bulk_load_delete(bl);
+		return NULL;
+	}
+	/*
+	 * Statements written to the space after the bulk load will
+	 * have greater LSNs and so will be replayed from WAL on
+	 * recovery. Read views that would see the loaded statements
+	 * are waited for on commit, see vy_bulk_load_wait_read_views().
+	 */
+	bl->lsn = env->xm->lsn;
+	trigger_add(&space->on_replace, &bl->on_replace);
+	return bl;
+}
+
+/** Unreference statements accumulated for an LSM tree. */
+static void
+vy_bulk_load_lsm_reset(struct vy_bulk_load_lsm *bl_lsm)
+{
+	for (size_t i = 0; i < bl_lsm->entry_count; i++)
+		tuple_unref(bl_lsm->entries[i].stmt);
+	bl_lsm->entry_count = 0;
+}
+
+/**
+ * Free a run that was written by bulk load but hasn't been
+ * committed and log it as dropped.
+ */
+static void
+vy_bulk_load_discard_run(struct vy_run *run)
+{
+	int64_t run_id = run->id;
+	vy_run_unref(run);
+	vy_log_tx_begin();
+	vy_log_drop_run(run_id, 0);
+	vy_log_tx_try_commit();
+}
+
+void
+vinyl_bulk_load_delete(struct vy_bulk_load *bl)
+{
+	trigger_clear(&bl->on_replace);
+	if (bl->last.stmt != NULL)
+		tuple_unref(bl->last.stmt);
+	for (uint32_t i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		assert(bl_lsm->new_run == NULL);
+		assert(bl_lsm->writer == NULL);
+		vy_bulk_load_lsm_reset(bl_lsm);
+		for (int j = 0; j < bl_lsm->run_count; j++)
+			vy_bulk_load_discard_run(bl_lsm->runs[j]);
+		free(bl_lsm->entries);
+		free(bl_lsm->runs);
+		vy_lsm_unref(bl_lsm->lsm);
+	}
+	free(bl->lsms);
+	free(bl);
+}
+
+/** Append a statement to the array accumulated for an LSM tree. */
+static void
+vy_bulk_load_lsm_append(struct vy_bulk_load_lsm *bl_lsm,
+			struct vy_entry entry)
+{
+	if (bl_lsm->entry_count == bl_lsm->entry_capacity) {
+		size_t capacity = MAX(2 * bl_lsm->entry_capacity, 1024);
+		bl_lsm->entries = xrealloc(bl_lsm->entries,
+					   capacity * sizeof(*bl_lsm->entries));
+		bl_lsm->entry_capacity = capacity;
+	}
+	tuple_ref(entry.stmt);
+	bl_lsm->entries[bl_lsm->entry_count++] = entry;
+}
+
+/** qsort_arg() comparator for statements of an LSM tree. */
+static int
+vy_bulk_load_entry_cmp(const void *a, const void *b, void *arg)
+{
+	return vy_entry_compare(*(const struct vy_entry *)a,
+				*(const struct vy_entry *)b,
+				(struct key_def *)arg);
+}
+
+/**
+ * Sort statements accumulated for a secondary index.
+ * Runs in a coio thread.
+ */
+static ssize_t
+vy_bulk_load_sort_f(va_list ap)
+{
+	struct vy_bulk_load_lsm *bl_lsm = va_arg(ap, struct vy_bulk_load_lsm *);
+	qsort_arg(bl_lsm->entries, bl_lsm->entry_count,
+		  sizeof(*bl_lsm->entries), vy_bulk_load_entry_cmp,
+		  bl_lsm->cmp_def);
+	return 0;
+}
+
+/**
+ * Check that sorted statements of a unique secondary index
+ * don't have duplicate keys.
+ */
+static int
+vy_bulk_load_check_unique(struct vy_bulk_load_lsm *bl_lsm)
+{
+	struct vy_lsm *lsm = bl_lsm->lsm;
+	struct key_def *key_def = bl_lsm->key_def;
+	for (size_t i = 1; i < bl_lsm->entry_count; i++) {
+		struct vy_entry prev = bl_lsm->entries[i - 1];
+		struct vy_entry curr = bl_lsm->entries[i];
+		if (vy_entry_compare(prev, curr, key_def) != 0)
+			continue;
+		int multikey_idx = key_def->is_multikey ?
+				   (int)curr.hint : MULTIKEY_NONE;
+		if (key_def->is_nullable &&
+		    tuple_key_contains_null(curr.stmt, key_def, multikey_idx))
+			continue;
+		diag_set(ClientError, ER_TUPLE_FOUND, lsm->base.def->name,
+			 lsm->base.def->space_name, tuple_str(prev.stmt),
+			 tuple_str(curr.stmt), prev.stmt, curr.stmt);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Write sorted statements accumulated for an LSM tree to a new
+ * run. Runs in a coio thread.
+ */
+static ssize_t
+vy_bulk_load_write_run_f(va_list ap)
+{
+	struct vy_bulk_load_lsm *bl_lsm = va_arg(ap, struct vy_bulk_load_lsm *);
+	struct vy_lsm *lsm = bl_lsm->lsm;
+	struct vy_run_writer writer;
+	if (vy_run_writer_create(&writer, bl_lsm->new_run, lsm->env->path,
+				 lsm->space_id, lsm->index_id,
+				 bl_lsm->cmp_def, bl_lsm->key_def,
+				 bl_lsm->page_size, bl_lsm->bloom_fpr,
+				 false) != 0)
+		return -1;
+	for (size_t i = 0; i < bl_lsm->entry_count; i++) {
+		if (vy_run_writer_append_stmt(&writer,
+					      bl_lsm->entries[i]) != 0) {
+			vy_run_writer_abort(&writer);
+			return -1;
+		}
+	}
+	return vy_run_writer_commit(&writer);
+}
+
+/**
+ * Fiber function that writes a run of an LSM tree. Statements of
+ * the primary index are sorted by the user while statements of
+ * secondary indexes are sorted in a coio thread.
+ */
+static int
+vy_bulk_load_writer_f(va_list ap)
+{
+	struct vy_bulk_load_lsm *bl_lsm = va_arg(ap, struct vy_bulk_load_lsm *);
+	struct vy_lsm *lsm = bl_lsm->lsm;
+	bl_lsm->cmp_def = key_def_dup(lsm->cmp_def);
+	bl_lsm->key_def = key_def_dup(lsm->key_def);
+	bl_lsm->page_size = lsm->opts.page_size;
+	bl_lsm->bloom_fpr = lsm->opts.bloom_fpr;
+	int rc = 0;
+	if (lsm->index_id > 0) {
+		if (coio_call(vy_bulk_load_sort_f, bl_lsm) != 0 ||
+		    (lsm->opts.is_unique &&
+		     vy_bulk_load_check_unique(bl_lsm) != 0))
+			rc = -1;
+	}
+	if (rc == 0 && coio_call(vy_bulk_load_write_run_f, bl_lsm) != 0)
+		rc = -1;
+	key_def_delete(bl_lsm->cmp_def);
+	key_def_delete(bl_lsm->key_def);
+	bl_lsm->cmp_def = NULL;
+	bl_lsm->key_def = NULL;
+	return rc;
+}
+
+/**
+ * Write statements accumulated for all indexes of the space to
+ * new runs. Runs of different indexes are sorted and written in
+ * parallel by coio threads.
+ */
+static int
+vy_bulk_load_flush(struct vy_bulk_load *bl)
+{
+	if (bl->lsms[0].entry_count == 0)
+		return 0;
+	if (bl->has_unique_secondary && bl->lsms[0].run_count > 0) {
+		/*
+		 * Unique constraints are checked within a run so
+		 * all statements must be written to one run.
+		 */
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "bulk load of data exceeding the memory limit "
+			 "into a space with unique secondary indexes");
+		return -1;
+	}
+	uint32_t i;
+	int rc = 0;
+	bool is_prepared = false;
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		bl_lsm->new_run = vy_run_new(&bl->env->run_env,
+					     vy_log_next_id());
+		if (bl_lsm->new_run == NULL) {
+			rc = -1;
+			break;
+		}
+		bl_lsm->new_run->dump_lsn = bl->lsn;
+		bl_lsm->new_run->dump_count = 1;
+	}
+	if (rc == 0) {
+		vy_log_tx_begin();
+		for (i = 0; i < bl->lsm_count; i++) {
+			struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+			vy_log_prepare_run(bl_lsm->lsm->id,
+					   bl_lsm->new_run->id);
+		}
+		if (vy_log_tx_commit() != 0)
+			rc = -1;
+		else
+			is_prepared = true;
+	}
+	if (rc != 0)
+		goto out;
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		bl_lsm->writer = fiber_new_system("vinyl.bulk_load",
+						  vy_bulk_load_writer_f);
+		if (bl_lsm->writer == NULL) {
+			rc = -1;
+			break;
+		}
+		fiber_set_joinable(bl_lsm->writer, true);
+		fiber_start(bl_lsm->writer, bl_lsm);
+	}
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		if (bl_lsm->writer == NULL)
+			break;
+		if (fiber_join(bl_lsm->writer) != 0)
+			rc = -1;
+		bl_lsm->writer = NULL;
+	}
+out:
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		vy_bulk_load_lsm_reset(bl_lsm);
+		struct vy_run *run = bl_lsm->new_run;
+		bl_lsm->new_run = NULL;
+		if (run == NULL)
+			continue;
+		if (rc != 0) {
+			if (is_prepared)
+				vy_bulk_load_discard_run(run);
+			else
+				vy_run_unref(run);
+			continue;
+		}
+		bl_lsm->runs = xrealloc(bl_lsm->runs, (bl_lsm->run_count + 1) *
+					sizeof(*bl_lsm->runs));
+		bl_lsm->runs[bl_lsm->run_count++] = run;
+	}
+	bl->memory_used = 0;
+	return rc;
+}
+
+int
+vinyl_bulk_load_add(struct vy_bulk_load *bl, const char *data,
+		    const char *data_end)
+{
+	struct vy_lsm *pk = bl->lsms[0].lsm;
+	if (tuple_validate_raw(pk->mem_format, data) != 0) {
+		error_set_space(diag_last_error(diag_get()), bl->space->def);
+		return -1;
+	}
+	struct tuple *stmt = vy_stmt_new_insert(pk->mem_format, data,
+						data_end);
+	if (stmt == NULL)
+		return -1;
+	vy_stmt_set_lsn(stmt, bl->lsn);
+	struct vy_entry entry;
+	entry.stmt = stmt;
+	entry.hint = vy_stmt_hint(stmt, pk->cmp_def);
+	if (bl->last.stmt != NULL) {
+		int cmp = vy_entry_compare(bl->last, entry, pk->cmp_def);
+		if (cmp == 0) {
+			diag_set(ClientError, ER_TUPLE_FOUND,
+				 pk->base.def->name, pk->base.def->space_name,
+				 tuple_str(bl->last.stmt), tuple_str(stmt),
+				 bl->last.stmt, stmt);
+		} else if (cmp > 0) {
+			diag_set(ClientError, ER_ILLEGAL_PARAMS,
+				 "bulk load tuples must be sorted "
+				 "by primary key");
+		}
+		if (cmp >= 0) {
+			tuple_unref(stmt);
+			return -1;
+		}
+		tuple_unref(bl->last.stmt);
+	}
+	bl->last = entry;
+	vy_bulk_load_lsm_append(&bl->lsms[0], entry);
+	bl->memory_used += tuple_size(stmt) + sizeof(entry);
+	for (uint32_t i = 1; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		struct vy_entry secondary;
+		vy_stmt_foreach_entry(secondary, stmt, bl_lsm->lsm->cmp_def) {
+			vy_bulk_load_lsm_append(bl_lsm, secondary);
+			bl->memory_used += sizeof(secondary);
+		}
+	}
+	if (bl->memory_used >= bl->memory_limit)
+		return vy_bulk_load_flush(bl);
+	return 0;
+}
+
+/**
+ * Check if there's a read view that would see the loaded
+ * statements. Such a read view was opened before the bulk
+ * load was committed so it must see the space empty.
+ */
+static bool
+vy_bulk_load_has_read_views(struct vy_bulk_load *bl)
+{
+	struct vy_tx_manager *xm = bl->env->xm;
+	if (rlist_empty(&xm->read_views))
+		return false;
+	/* Read views are sorted by vlsn. */
+	struct vy_read_view *rv = rlist_last_entry(&xm->read_views,
+						   struct vy_read_view,
+						   in_read_views);
+	return rv->vlsn >= bl->lsn;
+}
+
+/**
+ * Wait until all read views that would see the loaded statements
+ * are closed. We can't assign the loaded statements an LSN greater
+ * than vlsn of all read views because it may be used by the next
+ * WAL write.
+ *
+ * @retval 0 success
+ * @retval -1 the fiber was cancelled while waiting
+ */
+static int
+vy_bulk_load_wait_read_views(struct vy_bulk_load *bl)
+{
+	struct vy_tx_manager *xm = bl->env->xm;
+	while (vy_bulk_load_has_read_views(bl)) {
+		if (fiber_cond_wait(&xm->read_view_cond) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/** A slice of a run loaded to a range. */
+struct vy_bulk_load_slice {
+	/** LSM tree the slice belongs to. */
+	struct vy_lsm *lsm;
+	/** Range to add the slice to. */
+	struct vy_range *range;
+	/** New slice. */
+	struct vy_slice *slice;
+};
+
+int
+vinyl_bulk_load_commit(struct vy_bulk_load *bl)
+{
+	if (in_txn() != NULL) {
+		/* The transaction may hold a read view we'd wait for. */
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "bulk load commit in a transaction");
+		return -1;
+	}
+	if (vy_bulk_load_flush(bl) != 0)
+		return -1;
+	if (vy_bulk_load_wait_read_views(bl) != 0)
+		return -1;
+	if (vy_bulk_load_check_space(bl) != 0)
+		return -1;
+	/*
+	 * Slice the new runs by ranges. An empty LSM tree usually
+	 * has a single range, but it may have more if it used to
+	 * store data.
+	 */
+	int slice_count = 0;
+	uint32_t i;
+	int j;
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_lsm *lsm = bl->lsms[i].lsm;
+		slice_count += bl->lsms[i].run_count * lsm->range_count;
+	}
+	struct vy_bulk_load_slice *slices =
+		xcalloc(MAX(slice_count, 1), sizeof(*slices));
+	int rc = -1;
+	struct vy_range *range, *begin_range, *end_range;
+	int n = 0;
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		struct vy_lsm *lsm = bl_lsm->lsm;
+		for (j = 0; j < bl_lsm->run_count; j++) {
+			struct vy_run *run = bl_lsm->runs[j];
+			if (vy_lsm_find_range_intersection(
+					lsm, run->info.min_key,
+					run->info.max_key,
+					&begin_range, &end_range) != 0)
+				goto out;
+			for (range = begin_range; range != end_range;
+			     range = vy_range_tree_next(&lsm->range_tree,
+							range)) {
+				assert(n < slice_count);
+				struct vy_slice *slice = vy_slice_new(
+					vy_log_next_id(), run, range->begin,
+					range->end, lsm->cmp_def);
+				if (slice == NULL)
+					goto out;
+				slices[n].lsm = lsm;
+				slices[n].range = range;
+				slices[n].slice = slice;
+				n++;
+			}
+		}
+	}
+	/* Log all new runs and slices in one transaction. */
+	vy_log_tx_begin();
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		for (j = 0; j < bl_lsm->run_count; j++) {
+			struct vy_run *run = bl_lsm->runs[j];
+			vy_log_create_run(bl_lsm->lsm->id, run->id,
+					  bl->lsn, /*dump_count=*/1);
+		}
+	}
+	for (j = 0; j < n; j++) {
+		struct vy_slice *slice = slices[j].slice;
+		vy_log_insert_slice(slices[j].range->id, slice->run->id,
+				    slice->id,
+				    tuple_data_or_null(slice->begin.stmt),
+				    tuple_data_or_null(slice->end.stmt));
+	}
+	if (vy_log_tx_commit() != 0)
+		goto out;
+	/*
+	 * vy_log_tx_commit() yields, but DML requests are blocked
+	 * by the on_replace trigger so the LSM trees stay empty.
+	 * If they are dropped meanwhile, the new runs will be
+	 * deleted by garbage collection along with them.
+	 *
+	 * A read view may have been opened while we yielded. The
+	 * runs are already logged so we can't fail anymore: wait
+	 * for it to be closed ignoring fiber cancellation.
+	 */
+	while (vy_bulk_load_wait_read_views(bl) != 0)
+		diag_clear(diag_get());
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_bulk_load_lsm *bl_lsm = &bl->lsms[i];
+		for (j = 0; j < bl_lsm->run_count; j++) {
+			struct vy_run *run = bl_lsm->runs[j];
+			vy_lsm_add_run(bl_lsm->lsm, run);
+			/* Drop the reference, slices hold their own. */
+			vy_run_unref(run);
+		}
+		bl_lsm->run_count = 0;
+	}
+	for (j = 0; j < n; j++) {
+		struct vy_lsm *lsm = slices[j].lsm;
+		range = slices[j].range;
+		vy_lsm_unacct_range(lsm, range);
+		vy_range_add_slice(range, slices[j].slice);
+		vy_range_update_compaction_priority(range, &lsm->opts);
+		vy_range_update_dumps_per_compaction(range);
+		vy_lsm_acct_range(lsm, range);
+		slices[j].slice = NULL;
+	}
+	for (i = 0; i < bl->lsm_count; i++) {
+		struct vy_lsm *lsm = bl->lsms[i].lsm;
+		vy_range_heap_update_all(&lsm->range_heap);
+		vy_scheduler_update_lsm(&bl->env->scheduler, lsm);
+	}
+	rc = 0;
+out:
+	for (j = 0; j < n; j++) {
+		if (slices[j].slice != NULL)
+			vy_slice_delete(slices[j].slice);
+	}
+	free(slices);
+	return rc;
+}
+
+/* }}} Bulk load */
+
 /* {{{ Deferred DELETE handling */
 
 static int
@@ -40,6 +40,8 @@ extern "C" {
 
 struct info_handler;
 struct engine;
+struct space;
+struct vy_bulk_load;
 
 struct engine *
 vinyl_engine_new(const char *dir, size_t memory,
@@ -88,6 +90,42 @@ vinyl_engine_set_too_long_threshold(struct engine *engine,
 void
 vinyl_engine_set_snap_io_rate_limit(struct engine *engine, double limit);
 
+/**
+ * Start bulk load into an empty vinyl space. Tuples added to the
+ * bulk load are written directly to run files bypassing WAL and
+ * memory level. They become visible once the bulk load is committed.
+ * While the bulk load is in progress, DML requests to the space fail.
+ *
+ * @memory is the size of memory used for accumulating tuples before
+ * writing them to disk (0 means default). If the space has unique
+ * secondary indexes, all tuples must fit in @memory.
+ *
+ * Returns NULL and sets diag on error.
+ */
+struct vy_bulk_load *
+vinyl_bulk_load_new(struct space *space, size_t memory);
+
+/**
+ * Add a tuple to a bulk load. Tuples must be added in the order of
+ * the primary key. Returns -1 and sets diag on error.
+ */
+int
+vinyl_bulk_load_add(struct vy_bulk_load *bl, const char *data,
+		    const char *data_end);
+
+/**
+ * Write all added tuples to disk and make them visible.
+ * Returns -1 and sets diag on error.
+ */
+int
+vinyl_bulk_load_commit(struct vy_bulk_load *bl);
+
+/**
+ * Free a bulk load. Tuples that haven't been committed are discarded.
+ */
+void
+vinyl_bulk_load_delete(struct vy_bulk_load *bl);
+
 #ifdef __cplusplus
 } /* extern "C" */
 
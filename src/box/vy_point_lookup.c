@@ -150,24 +150,13 @@ vy_point_lookup_scan_mems(struct vy_lsm *lsm, struct vy_tx *tx,
  * Add found statements to the history list up to terminal statement.
  */
 static int
-vy_point_lookup_scan_slice(struct vy_lsm *lsm, struct vy_slice *slice,
-			   const struct vy_read_view **rv, struct vy_entry key,
+vy_point_lookup_scan_slice(struct vy_lsm *lsm, struct vy_run_iterator *run_itr,
 			   struct vy_history *history)
 {
-	/*
-	 * The format of the statement must be exactly the space
-	 * format with the same identifier to fully match the
-	 * format in vy_mem.
-	 */
-	struct vy_run_iterator run_itr;
-	vy_run_iterator_open(&run_itr, &lsm->stat.disk.iterator, slice,
-			     ITER_EQ, key, rv, lsm->cmp_def, lsm->key_def,
-			     lsm->disk_format);
 	struct vy_history slice_history;
 	vy_history_create(&slice_history, &lsm->env->history_node_pool);
-	int rc = vy_run_iterator_next(&run_itr, &slice_history);
+	int rc = vy_run_iterator_next(run_itr, &slice_history);
 	vy_history_splice(history, &slice_history);
-	vy_run_iterator_close(&run_itr);
 	return rc;
 }
 
@@ -176,6 +165,13 @@ vy_point_lookup_scan_slice(struct vy_lsm *lsm, struct vy_slice *slice,
  * Add found statements to the history list up to terminal statement.
  * All slices are pinned before first slice scan, so it's guaranteed
  * that complete history from runs will be extracted.
+ *
+ * Disk reads are submitted to all slices which bloom filters may
+ * contain the key at once, before scanning the newest slice, so
+ * that a bloom filter false positive in a newer run doesn't add
+ * up to the latency of the read from an older one. Reads that
+ * turn out to be unnecessary, because a terminal statement is
+ * found in a newer slice, are abandoned.
  */
 static int
 vy_point_lookup_scan_slices(struct vy_lsm *lsm, const struct vy_read_view **rv,
@@ -191,19 +187,33 @@ vy_point_lookup_scan_slices(struct vy_lsm *lsm, const struct vy_read_view **rv,
 	struct vy_slice **slices =
 		xregion_alloc_array(&fiber()->gc, typeof(slices[0]),
 				    slice_count);
+	struct vy_run_iterator *run_itrs =
+		xregion_alloc_array(&fiber()->gc, typeof(run_itrs[0]),
+				    slice_count);
 	int i = 0;
 	struct vy_slice *slice;
 	rlist_foreach_entry(slice, &range->slices, in_range) {
 		vy_slice_pin(slice);
-		slices[i++] = slice;
+		slices[i] = slice;
+		/*
+		 * The format of the statement must be exactly the space
+		 * format with the same identifier to fully match the
+		 * format in vy_mem.
+		 */
+		vy_run_iterator_open(&run_itrs[i], &lsm->stat.disk.iterator,
+				     slice, ITER_EQ, key, rv, lsm->cmp_def,
+				     lsm->key_def, lsm->disk_format);
+		vy_run_iterator_prefetch(&run_itrs[i]);
+		i++;
 	}
 	assert(i == slice_count);
 	ERROR_INJECT_YIELD(ERRINJ_VY_POINT_LOOKUP_DELAY);
 	int rc = 0;
 	for (i = 0; i < slice_count; i++) {
 		if (rc == 0 && !vy_history_is_terminal(history))
-			rc = vy_point_lookup_scan_slice(lsm, slices[i],
-							rv, key, history);
+			rc = vy_point_lookup_scan_slice(lsm, &run_itrs[i],
+							history);
+		vy_run_iterator_close(&run_itrs[i]);
 		vy_slice_unpin(slices[i]);
 	}
 	region_truncate(&fiber()->gc, region_svp);
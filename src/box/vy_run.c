@@ -74,6 +74,9 @@ const char *vy_file_suffix[] = {
 /* sync run and index files very 16 MB */
 #define VY_RUN_SYNC_INTERVAL (1 << 24)
 
+/* max number of pages a run iterator may read ahead */
+#define VY_RUN_READ_AHEAD_MAX 8
+
 /**
  * We read runs in background threads so as not to stall tx.
  * This structure represents such a thread.
@@ -109,6 +112,20 @@ struct vy_page_read_task {
 	bool equal_found;
 	/** [out] resulting vinyl page */
 	struct vy_page *page;
+	/** Link in vy_run_iterator::read_ahead (read-ahead only). */
+	struct rlist in_read_ahead;
+	/** Number of the page to read (read-ahead only). */
+	uint32_t page_no;
+	/** Set when a read-ahead task is back in tx. */
+	bool is_complete;
+	/**
+	 * Set if the iterator that submitted the read-ahead task
+	 * doesn't need the page anymore, in which case the task
+	 * is freed as soon as it is back in tx.
+	 */
+	bool is_abandoned;
+	/** Fiber waiting for a read-ahead task to complete. */
+	struct fiber *waiter;
 };
 
 /** Destructor for env->zdctx_key thread-local variable */
@@ -214,6 +231,18 @@ vy_run_env_enable_coio(struct vy_run_env *env)
 	vy_run_env_start_readers(env);
 }
 
+/**
+ * Pick a reader thread to process the next read request.
+ */
+static struct vy_run_reader *
+vy_run_env_next_reader(struct vy_run_env *env)
+{
+	assert(env->reader_pool != NULL);
+	struct vy_run_reader *reader = &env->reader_pool[env->next_reader++];
+	env->next_reader %= env->reader_pool_size;
+	return reader;
+}
+
 /**
  * Execute a task on behalf of a reader thread.
  */
@@ -226,9 +255,7 @@ vy_run_env_coio_call(struct vy_run_env *env, struct cbus_call_msg *msg,
 		return func(msg);
 
 	/* Pick a reader thread. */
-	struct vy_run_reader *reader;
-	reader = &env->reader_pool[env->next_reader++];
-	env->next_reader %= env->reader_pool_size;
+	struct vy_run_reader *reader = vy_run_env_next_reader(env);
 
 	/* Post the task to the reader thread. */
 	if (cbus_call(&reader->reader_pipe, &reader->tx_pipe, msg, func) != 0)
@@ -825,12 +852,50 @@ vy_page_find_key(struct vy_page *page, struct vy_entry key,
 	return 0;
 }
 
+/** Free a page read task submitted for read-ahead. */
+static void
+vy_page_read_task_delete(struct vy_page_read_task *task)
+{
+	struct vy_run_env *env = task->run->env;
+	if (task->page != NULL)
+		vy_page_delete(task->page);
+	diag_destroy(&task->base.diag);
+	vy_run_unref(task->run);
+	mempool_free(&env->read_task_pool, task);
+}
+
+/**
+ * Unlink a read-ahead task from the iterator and free it.
+ * If the read is still in progress, the task is freed upon
+ * completion.
+ */
+static void
+vy_page_read_task_discard(struct vy_page_read_task *task)
+{
+	rlist_del_entry(task, in_read_ahead);
+	if (task->is_complete)
+		vy_page_read_task_delete(task);
+	else
+		task->is_abandoned = true;
+}
+
+/** Drop all pages read ahead by an iterator. */
+static void
+vy_run_iterator_discard_read_ahead(struct vy_run_iterator *itr)
+{
+	struct vy_page_read_task *task, *tmp;
+	rlist_foreach_entry_safe(task, &itr->read_ahead, in_read_ahead, tmp)
+		vy_page_read_task_discard(task);
+	itr->read_ahead_window = 0;
+}
+
 /**
  * End iteration and free cached data.
  */
 static void
 vy_run_iterator_stop(struct vy_run_iterator *itr)
 {
+	vy_run_iterator_discard_read_ahead(itr);
 	if (itr->curr.stmt != NULL) {
 		tuple_unref(itr->curr.stmt);
 		itr->curr = vy_entry_none();
@@ -998,46 +1063,192 @@ vy_page_read_cb(struct cbus_call_msg *base)
 }
 
 /**
- * Read a page from disk given its number.
- * The function caches two most recently read pages.
+ * Called in tx when a read-ahead task returns from a reader thread.
+ */
+static int
+vy_page_read_ahead_cb(struct cbus_call_msg *base)
+{
+	struct vy_page_read_task *task = (struct vy_page_read_task *)base;
+	if (task->is_abandoned) {
+		vy_page_read_task_delete(task);
+		return 0;
+	}
+	task->is_complete = true;
+	if (task->waiter != NULL)
+		fiber_wakeup(task->waiter);
+	return 0;
+}
+
+/**
+ * Submit a read of the given page to a reader thread without
+ * waiting for it to complete. The task is linked to the iterator
+ * read-ahead list and picked up by vy_run_iterator_load_page().
  *
  * @retval 0 success
- * @retval -1 critical error
+ * @retval -1 out of memory
  */
-static NODISCARD int
-vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
-			  struct vy_entry key, enum iterator_type iterator_type,
-			  struct vy_page **result, uint32_t *pos_in_page,
-			  bool *equal_found)
+static int
+vy_run_iterator_submit_read_ahead(struct vy_run_iterator *itr,
+				  uint32_t page_no)
 {
-	struct vy_slice *slice = itr->slice;
-	struct vy_run_env *env = slice->run->env;
+	struct vy_run *run = itr->slice->run;
+	struct vy_run_env *env = run->env;
+	struct vy_page_info *page_info = vy_run_page_info(run, page_no);
+	struct vy_page *page = vy_page_new(page_info);
+	if (page == NULL)
+		return -1;
+	struct vy_page_read_task *task = mempool_alloc(&env->read_task_pool);
+	if (task == NULL) {
+		diag_set(OutOfMemory, sizeof(*task),
+			 "mempool", "vy_page_read_task");
+		vy_page_delete(page);
+		return -1;
+	}
+	/*
+	 * The task may outlive the iterator and the slice so it
+	 * must hold a reference to the run to keep the file open.
+	 */
+	vy_run_ref(run);
+	task->run = run;
+	task->page_info = page_info;
+	task->page = page;
+	task->key = vy_entry_none();
+	task->iterator_type = ITER_GE;
+	task->cmp_def = NULL;
+	task->format = NULL;
+	task->pos_in_page = 0;
+	task->equal_found = false;
+	task->page_no = page_no;
+	task->is_complete = false;
+	task->is_abandoned = false;
+	task->waiter = NULL;
+	rlist_add_tail_entry(&itr->read_ahead, task, in_read_ahead);
+
+	struct vy_run_reader *reader = vy_run_env_next_reader(env);
+	cbus_call_async(&reader->reader_pipe, &reader->tx_pipe, &task->base,
+			vy_page_read_cb, vy_page_read_ahead_cb);
+	return 0;
+}
 
-	/* Check cache */
-	struct vy_page *page = NULL;
-	if (itr->curr_page != NULL &&
-	    itr->curr_page->page_no == page_no) {
-		page = itr->curr_page;
-	} else if (itr->prev_page != NULL &&
-		   itr->prev_page->page_no == page_no) {
-		SWAP(itr->prev_page, itr->curr_page);
-		page = itr->curr_page;
+/** Find a read-ahead task for the given page. */
+static struct vy_page_read_task *
+vy_run_iterator_find_read_ahead(struct vy_run_iterator *itr,
+				uint32_t page_no)
+{
+	struct vy_page_read_task *task;
+	rlist_foreach_entry(task, &itr->read_ahead, in_read_ahead) {
+		if (task->page_no == page_no)
+			return task;
 	}
-	if (page != NULL) {
-		if (key.stmt != NULL &&
-		    vy_page_find_key(page, key, itr->cmp_def,
-				     itr->format, iterator_type,
-				     pos_in_page, equal_found) != 0)
-			return -1;
-		*result = page;
+	return NULL;
+}
+
+/**
+ * Look up a page in the iterator read-ahead list. If the page
+ * is there, wait for the read to complete and take the page.
+ * Sets @a result to NULL if the page wasn't read ahead or the
+ * read failed, in which case the caller should read the page
+ * synchronously (and get a proper error if the failure wasn't
+ * transient).
+ *
+ * @retval 0 success
+ * @retval -1 the fiber was cancelled while waiting
+ */
+static NODISCARD int
+vy_run_iterator_take_read_ahead(struct vy_run_iterator *itr,
+				uint32_t page_no, struct vy_page **result)
+{
+	*result = NULL;
+	struct vy_page_read_task *task =
+		vy_run_iterator_find_read_ahead(itr, page_no);
+	if (task == NULL)
 		return 0;
+	while (!task->is_complete) {
+		task->waiter = fiber();
+		fiber_yield();
+	}
+	task->waiter = NULL;
+	rlist_del_entry(task, in_read_ahead);
+	if (task->base.rc == 0) {
+		*result = task->page;
+		task->page = NULL;
 	}
+	vy_page_read_task_delete(task);
+	if (fiber_is_cancelled()) {
+		if (*result != NULL)
+			vy_page_delete(*result);
+		*result = NULL;
+		diag_set(FiberIsCancelled);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Update the read-ahead window after the iterator loaded the page
+ * with the given number and submit reads of the pages following
+ * it in the iteration direction that haven't been requested yet.
+ * Pages that fell out of the window are dropped.
+ *
+ * @param is_sequential  Set if the previously loaded page
+ *                       immediately precedes the given one.
+ */
+static void
+vy_run_iterator_read_ahead(struct vy_run_iterator *itr, uint32_t page_no,
+			   bool is_sequential)
+{
+	struct vy_slice *slice = itr->slice;
+	if (slice->run->env->reader_pool == NULL)
+		return; /* blocking I/O, see vy_run_env_coio_call() */
+	if (!is_sequential) {
+		itr->read_ahead_window = 0;
+		return;
+	}
+	itr->read_ahead_window = MIN(MAX(2 * itr->read_ahead_window, 1U),
+				     (uint32_t)VY_RUN_READ_AHEAD_MAX);
+
+	int dir = iterator_direction(itr->iterator_type);
+	int64_t window = itr->read_ahead_window;
+	struct vy_page_read_task *task, *tmp;
+	rlist_foreach_entry_safe(task, &itr->read_ahead, in_read_ahead, tmp) {
+		int64_t dist = ((int64_t)task->page_no - page_no) * dir;
+		if (dist <= 0 || dist > window)
+			vy_page_read_task_discard(task);
+	}
+	for (int64_t i = 1; i <= window; i++) {
+		int64_t next = (int64_t)page_no + i * dir;
+		if (next < slice->first_page_no || next > slice->last_page_no)
+			break;
+		if (vy_run_iterator_find_read_ahead(itr, next) != NULL)
+			continue;
+		/* Read-ahead is best-effort, ignore memory errors. */
+		if (vy_run_iterator_submit_read_ahead(itr, next) != 0) {
+			diag_clear(diag_get());
+			break;
+		}
+	}
+}
+
+/**
+ * Read a page from disk waiting for a reader thread to complete.
+ * If @a key is set, also look it up in the page, see
+ * vy_page_find_key().
+ *
+ * @retval not NULL loaded page
+ * @retval NULL read error or out of memory
+ */
+static struct vy_page *
+vy_run_iterator_read_page(struct vy_run_iterator *itr,
+			  struct vy_page_info *page_info, struct vy_entry key,
+			  enum iterator_type iterator_type,
+			  uint32_t *pos_in_page, bool *equal_found)
+{
+	struct vy_run_env *env = itr->slice->run->env;
 
 	/* Allocate buffers */
-	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
-	page = vy_page_new(page_info);
+	struct vy_page *page = vy_page_new(page_info);
 	if (page == NULL)
-		return -1;
+		return NULL;
 
 	/* Read page data from the disk */
 	struct vy_page_read_task *task = mempool_alloc(&env->read_task_pool);
@@ -1045,9 +1256,9 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		diag_set(OutOfMemory, sizeof(*task),
 			 "mempool", "vy_page_read_task");
 		vy_page_delete(page);
-		return -1;
+		return NULL;
 	}
-	task->run = slice->run;
+	task->run = itr->slice->run;
 	task->page_info = page_info;
 	task->page = page;
 	task->key = key;
@@ -1065,7 +1276,72 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	mempool_free(&env->read_task_pool, task);
 	if (rc != 0) {
 		vy_page_delete(page);
+		return NULL;
+	}
+	return page;
+}
+
+/**
+ * Read a page from disk given its number.
+ * The function caches two most recently read pages.
+ * Pages following the loaded one may be read ahead in
+ * background, see vy_run_iterator_read_ahead().
+ *
+ * @retval 0 success
+ * @retval -1 critical error
+ */
+static NODISCARD int
+vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
+			  struct vy_entry key, enum iterator_type iterator_type,
+			  struct vy_page **result, uint32_t *pos_in_page,
+			  bool *equal_found)
+{
+	struct vy_slice *slice = itr->slice;
+
+	/* Check cache */
+	struct vy_page *page = NULL;
+	if (itr->curr_page != NULL &&
+	    itr->curr_page->page_no == page_no) {
+		page = itr->curr_page;
+	} else if (itr->prev_page != NULL &&
+		   itr->prev_page->page_no == page_no) {
+		SWAP(itr->prev_page, itr->curr_page);
+		page = itr->curr_page;
+	}
+	if (page != NULL) {
+		if (key.stmt != NULL &&
+		    vy_page_find_key(page, key, itr->cmp_def,
+				     itr->format, iterator_type,
+				     pos_in_page, equal_found) != 0)
+			return -1;
+		*result = page;
+		return 0;
+	}
+
+	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
+	bool is_sequential = itr->curr_page != NULL &&
+			     (int64_t)page_no - itr->curr_page->page_no ==
+			     iterator_direction(itr->iterator_type);
+
+	/* Check pages read ahead */
+	if (vy_run_iterator_take_read_ahead(itr, page_no, &page) != 0)
 		return -1;
+	if (page != NULL) {
+		*pos_in_page = 0;
+		*equal_found = false;
+		if (key.stmt != NULL &&
+		    vy_page_find_key(page, key, itr->cmp_def,
+				     itr->format, iterator_type,
+				     pos_in_page, equal_found) != 0) {
+			vy_page_delete(page);
+			return -1;
+		}
+	} else {
+		page = vy_run_iterator_read_page(itr, page_info, key,
+						 iterator_type, pos_in_page,
+						 equal_found);
+		if (page == NULL)
+			return -1;
 	}
 
 	/* Update cache */
@@ -1081,6 +1357,8 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	itr->stat->read.bytes_compressed += page_info->size;
 	itr->stat->read.pages++;
 
+	vy_run_iterator_read_ahead(itr, page_no, is_sequential);
+
 	*result = page;
 	return 0;
 }
@@ -1485,6 +1763,8 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	itr->curr_pos.page_no = slice->run->info.page_count;
 	itr->curr_page = NULL;
 	itr->prev_page = NULL;
+	rlist_create(&itr->read_ahead);
+	itr->read_ahead_window = 0;
 	itr->search_started = false;
 
 	/*
@@ -1498,6 +1778,40 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	tuple_format_ref(format);
 }
 
+void
+vy_run_iterator_prefetch(struct vy_run_iterator *itr)
+{
+	struct vy_slice *slice = itr->slice;
+	struct vy_run *run = slice->run;
+	struct key_def *cmp_def = itr->cmp_def;
+	struct vy_entry key = itr->key;
+
+	assert(!itr->search_started);
+	assert(itr->iterator_type == ITER_EQ);
+	if (run->env->reader_pool == NULL)
+		return; /* blocking I/O, see vy_run_env_coio_call() */
+	if (vy_run_is_empty(run) || vy_stmt_is_empty_key(key.stmt))
+		return;
+	/* Same checks as in vy_run_iterator_seek(). */
+	struct tuple_bloom *bloom = run->info.bloom;
+	if (bloom != NULL && !vy_bloom_maybe_has(bloom, key, itr->key_def))
+		return;
+	if (slice->begin.stmt != NULL &&
+	    vy_entry_compare(key, slice->begin, cmp_def) < 0)
+		return;
+	if (slice->end.stmt != NULL &&
+	    vy_entry_compare(key, slice->end, cmp_def) >= 0)
+		return;
+	bool unused;
+	uint32_t page_no = vy_page_index_find_page(run, key, cmp_def,
+						   ITER_EQ, &unused);
+	if (page_no >= run->info.page_count)
+		return;
+	/* Prefetching is best-effort, ignore memory errors. */
+	if (vy_run_iterator_submit_read_ahead(itr, page_no) != 0)
+		diag_clear(diag_get());
+}
+
 /**
  * Advance a run iterator to the newest statement for the next key.
  * The statement is returned in @ret (NULL if EOF).
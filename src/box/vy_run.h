@@ -284,6 +284,20 @@ struct vy_run_iterator {
 	 */
 	struct vy_page *curr_page;
 	struct vy_page *prev_page;
+	/**
+	 * Pages requested from reader threads in advance, linked
+	 * by vy_page_read_task::in_read_ahead. When the iterator
+	 * switches to the next page in the iteration direction,
+	 * it submits reads of the following pages so that a long
+	 * range scan doesn't stall on every page boundary.
+	 */
+	struct rlist read_ahead;
+	/**
+	 * Number of pages to read ahead. Doubles on each sequential
+	 * page switch, up to VY_RUN_READ_AHEAD_MAX, and drops to 0
+	 * on a random jump so point lookups never read ahead.
+	 */
+	uint32_t read_ahead_window;
 	/** Is false until first .._get or .._next_.. method is called */
 	bool search_started;
 };
@@ -539,6 +553,17 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 		     struct key_def *cmp_def, struct key_def *key_def,
 		     struct tuple_format *format);
 
+/**
+ * Submit a read of the page that may contain the search key of
+ * an ITER_EQ iterator to a reader thread without waiting for it
+ * to complete. The page is picked up by the first call to
+ * vy_run_iterator_next(). Does nothing if the bloom filter says
+ * the key isn't in the run. Used to issue disk reads to several
+ * runs concurrently.
+ */
+void
+vy_run_iterator_prefetch(struct vy_run_iterator *itr);
+
 /**
  * Advance a run iterator to the next key.
  * The key history is returned in @history (empty if EOF).
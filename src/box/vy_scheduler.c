@@ -572,7 +572,7 @@ vy_scheduler_add_lsm(struct vy_scheduler *scheduler, struct vy_lsm *lsm)
 	return 0;
 }
 
-static void
+void
 vy_scheduler_update_lsm(struct vy_scheduler *scheduler, struct vy_lsm *lsm)
 {
 	assert(! heap_node_is_stray(&lsm->in_dump));
@@ -214,6 +214,14 @@ vy_scheduler_reset_stat(struct vy_scheduler *scheduler);
 int
 vy_scheduler_add_lsm(struct vy_scheduler *, struct vy_lsm *);
 
+/**
+ * Update the position of an LSM tree in scheduler dump/compaction
+ * queues. Needs to be called whenever the LSM tree's data set is
+ * changed outside the scheduler.
+ */
+void
+vy_scheduler_update_lsm(struct vy_scheduler *scheduler, struct vy_lsm *lsm);
+
 /**
  * Trigger dump of all currently existing in-memory trees.
  */
@@ -111,6 +111,7 @@ vy_tx_manager_new(void)
 	rlist_create(&xm->writers);
 	rlist_create(&xm->prepared);
 	rlist_create(&xm->read_views);
+	fiber_cond_create(&xm->read_view_cond);
 	vy_global_read_view_create((struct vy_read_view *)&xm->global_read_view,
 				   INT64_MAX);
 	xm->p_global_read_view = &xm->global_read_view;
@@ -131,6 +132,7 @@ vy_tx_manager_new(void)
 void
 vy_tx_manager_delete(struct vy_tx_manager *xm)
 {
+	fiber_cond_destroy(&xm->read_view_cond);
 	mempool_destroy(&xm->read_view_mempool);
 	mempool_destroy(&xm->read_interval_mempool);
 	mempool_destroy(&xm->txv_mempool);
@@ -220,6 +222,7 @@ vy_tx_manager_destroy_read_view(struct vy_tx_manager *xm,
 	if (--rv->refs == 0) {
 		rlist_del_entry(rv, in_read_views);
 		mempool_free(&xm->read_view_mempool, rv);
+		fiber_cond_broadcast(&xm->read_view_cond);
 	}
 }
 
@@ -39,6 +39,7 @@
 #include <small/rb.h>
 #include <small/rlist.h>
 
+#include "fiber_cond.h"
 #include "iterator_type.h"
 #include "salad/stailq.h"
 #include "trivia/util.h"
@@ -257,6 +258,8 @@ struct vy_tx_manager {
 	 * The list of TXs with a read view in order of vlsn.
 	 */
 	struct rlist read_views;
+	/** Broadcast when a read view is destroyed. */
+	struct fiber_cond read_view_cond;
 	/**
 	 * Global read view - all prepared transactions are
 	 * visible in this view. The global read view
@@ -1026,10 +1026,6 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock)
 {
-	int64_t signature = vclock_sum(vclock);
-	assert(signature >= 0);
-	assert(!tt_uuid_is_nil(dir->instance_uuid));
-
 	/*
 	 * For WAL dir: store vclock of the previous xlog file
 	 * to check for gaps on recovery.
@@ -1037,6 +1033,17 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	const struct vclock *prev_vclock = NULL;
 	if (dir->type == XLOG && !vclockset_empty(&dir->index))
 		prev_vclock = vclockset_last(&dir->index);
+	return xdir_create_xlog_with_prev(dir, xlog, vclock, prev_vclock);
+}
+
+int
+xdir_create_xlog_with_prev(struct xdir *dir, struct xlog *xlog,
+			   const struct vclock *vclock,
+			   const struct vclock *prev_vclock)
+{
+	int64_t signature = vclock_sum(vclock);
+	assert(signature >= 0);
+	assert(!tt_uuid_is_nil(dir->instance_uuid));
 
 	struct xlog_meta meta;
 	xlog_meta_create(&meta, dir->filetype, dir->instance_uuid,
@@ -2254,6 +2261,7 @@ xlog_remove_file_async(const char *filename, unsigned flags)
 	assert(grp_alloc_size(&all) == 0);
 	coio_task_create(&task->base, xlog_remove_file_cb,
 			 xlog_remove_file_done_cb);
+	task->base.lane = COIO_LANE_BULK;
 	coio_task_post(&task->base);
 	return true;
 }
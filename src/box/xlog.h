@@ -482,6 +482,16 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * Same as xdir_create_xlog(), but stores @prev_vclock in the file
+ * header. Used for creating delta snapshots, which refer to the
+ * snapshot they are based on.
+ */
+int
+xdir_create_xlog_with_prev(struct xdir *dir, struct xlog *xlog,
+			   const struct vclock *vclock,
+			   const struct vclock *prev_vclock);
+
 /**
  * Create new xlog writer based on fd.
  * @param fd            file descriptor
@@ -38,13 +38,31 @@
 #include <netdb.h>
 #include <sys/socket.h>
 
+#include "clock.h"
 #include "fiber.h"
+#include "tt_pthread.h"
+#include <pmatomic.h>
 #include <tarantool_ev.h>
 
 /*
- * Asynchronous IO Tasks (libeio wrapper).
- * ---------------------------------------
+ * Asynchronous IO Tasks.
+ * ----------------------
  *
+ * Coio tasks (coio_task_execute(), coio_call()) are executed by
+ * the coio thread pool. Every worker thread of the pool owns
+ * a queue per priority lane. A submitted task is pushed to the
+ * queue of one of the workers in round-robin. A worker takes tasks
+ * from the head of its own queues and, when they are empty, steals
+ * tasks from the tails of the queues of other workers, so a long
+ * task never holds up tasks queued behind it while other workers
+ * are idle. Higher priority lanes are always scanned first.
+ *
+ * A complete task is pushed to the completion queue of the cord
+ * that submitted it and the cord is notified with an async event.
+ * The async event handler invokes completion callbacks of the
+ * tasks in the cord thread.
+ *
+ * File I/O requests (see coio_file.c) are executed by libeio.
  * libeio request processing is designed in edge-trigger
  * manner, when libeio is ready to process some requests it
  * calls coio_poller callback.
@@ -70,10 +88,64 @@ struct coio_manager {
 	ev_loop *loop;
 	ev_idle coio_idle;
 	ev_async coio_async;
+	/** Notifies the cord about complete coio tasks. */
+	ev_async done_async;
+	/** Complete coio tasks, protected by the mutex. */
+	struct rlist done;
+	pthread_mutex_t mutex;
 };
 
 static __thread struct coio_manager coio_manager;
 
+const char *coio_lane_strs[] = {
+	[COIO_LANE_HIGH] = "high",
+	[COIO_LANE_NORMAL] = "normal",
+	[COIO_LANE_BULK] = "bulk",
+};
+
+/** A thread of the coio thread pool. */
+struct coio_worker {
+	/** Index of the worker in coio_pool::workers. */
+	int id;
+	/** Set if the thread was started and wasn't joined. */
+	bool is_started;
+	/** Set by the thread before it exits, see coio_pool::mutex. */
+	bool is_exiting;
+	struct cord cord;
+	/** Queues of submitted tasks, protected by the mutex. */
+	struct rlist queue[coio_lane_MAX];
+	/** Latency statistics, protected by the mutex. */
+	struct coio_lane_stat stat[coio_lane_MAX];
+	pthread_mutex_t mutex;
+};
+
+/** The coio thread pool. */
+static struct coio_pool {
+	/** Workers, allocated on demand. */
+	struct coio_worker *workers[COIO_WORKER_COUNT_MAX];
+	/**
+	 * Number of workers that may run tasks. Workers with
+	 * greater indexes exit once they have nothing to do.
+	 */
+	int worker_count;
+	/**
+	 * Number of allocated workers. Tasks are stolen from
+	 * all of them, including exiting ones.
+	 */
+	int worker_alloc_count;
+	/** Number of queued tasks per lane. */
+	int pending[coio_lane_MAX];
+	/** Number of workers running bulk tasks. */
+	int bulk_running;
+	/** Index of the worker to push the next task to. */
+	unsigned next_worker;
+	/** Number of workers waiting on the cond. */
+	int idle_count;
+	/** Protects worker start and stop and idle workers. */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+} coio_pool;
+
 static void
 coio_idle_cb(ev_loop *loop, struct ev_idle *w, int events)
 {
@@ -126,11 +198,311 @@ coio_on_stop(void *data)
 	return 0;
 }
 
+/**
+ * Completion callback of a coio task, invoked in the cord that
+ * submitted the task.
+ */
+static void
+coio_task_complete(struct coio_task *task)
+{
+	if (task->fiber == NULL) {
+		/*
+		 * Timed out or detached, free the resources.
+		 * NOTE: coio_call() tasks are never detached.
+		 */
+		if (task->timeout_cb != NULL)
+			task->timeout_cb(task);
+		return;
+	}
+	task->complete = 1;
+	fiber_wakeup(task->fiber);
+}
+
+static void
+coio_done_async_cb(ev_loop *loop, struct ev_async *w, int events)
+{
+	(void)loop;
+	(void)events;
+	struct coio_manager *manager = w->data;
+	RLIST_HEAD(done);
+	tt_pthread_mutex_lock(&manager->mutex);
+	rlist_splice(&done, &manager->done);
+	tt_pthread_mutex_unlock(&manager->mutex);
+	struct coio_task *task, *tmp;
+	rlist_foreach_entry_safe(task, &done, in_queue, tmp)
+		coio_task_complete(task);
+}
+
+/** Pass a complete task to the cord that submitted it. */
+static void
+coio_manager_push(struct coio_manager *manager, struct coio_task *task)
+{
+	tt_pthread_mutex_lock(&manager->mutex);
+	/* The cord is already notified if the queue isn't empty. */
+	bool notify = rlist_empty(&manager->done);
+	rlist_add_tail_entry(&manager->done, task, in_queue);
+	tt_pthread_mutex_unlock(&manager->mutex);
+	if (notify)
+		ev_async_send(manager->loop, &manager->done_async);
+}
+
+/** Max number of workers that may run bulk tasks at once. */
+static inline int
+coio_pool_bulk_max(void)
+{
+	return MAX(pm_atomic_load(&coio_pool.worker_count) - 1, 1);
+}
+
+/**
+ * Pop a task of the given lane from a worker queue: from the head
+ * if it's the own queue of the worker, from the tail otherwise.
+ */
+static struct coio_task *
+coio_worker_pop(struct coio_worker *worker, enum coio_lane lane,
+		bool is_own)
+{
+	struct coio_task *task = NULL;
+	tt_pthread_mutex_lock(&worker->mutex);
+	struct rlist *queue = &worker->queue[lane];
+	if (!rlist_empty(queue)) {
+		if (is_own)
+			task = rlist_shift_entry(queue, struct coio_task,
+						 in_queue);
+		else
+			task = rlist_shift_tail_entry(queue, struct coio_task,
+						      in_queue);
+		pm_atomic_fetch_sub(&coio_pool.pending[lane], 1);
+	}
+	tt_pthread_mutex_unlock(&worker->mutex);
+	return task;
+}
+
+/** Take a task to run, from the own queues or from other workers. */
+static struct coio_task *
+coio_worker_take(struct coio_worker *worker)
+{
+	/* An excess worker leaves its tasks to others. */
+	if (worker->id >= pm_atomic_load(&coio_pool.worker_count))
+		return NULL;
+	int worker_count = pm_atomic_load(&coio_pool.worker_alloc_count);
+	for (int lane = 0; lane < coio_lane_MAX; lane++) {
+		if (pm_atomic_load(&coio_pool.pending[lane]) == 0)
+			continue;
+		if (lane == COIO_LANE_BULK &&
+		    pm_atomic_fetch_add(&coio_pool.bulk_running, 1) >=
+		    coio_pool_bulk_max()) {
+			pm_atomic_fetch_sub(&coio_pool.bulk_running, 1);
+			continue;
+		}
+		for (int i = 0; i < worker_count; i++) {
+			struct coio_worker *victim =
+				coio_pool.workers[(worker->id + i) %
+						  worker_count];
+			struct coio_task *task =
+				coio_worker_pop(victim, lane, i == 0);
+			if (task != NULL)
+				return task;
+		}
+		if (lane == COIO_LANE_BULK)
+			pm_atomic_fetch_sub(&coio_pool.bulk_running, 1);
+	}
+	return NULL;
+}
+
+/** Check if an idle worker has to wait for new tasks. */
+static bool
+coio_worker_has_nothing_to_do(void)
+{
+	for (int lane = 0; lane < COIO_LANE_BULK; lane++) {
+		if (pm_atomic_load(&coio_pool.pending[lane]) > 0)
+			return false;
+	}
+	return pm_atomic_load(&coio_pool.pending[COIO_LANE_BULK]) == 0 ||
+	       pm_atomic_load(&coio_pool.bulk_running) >=
+	       coio_pool_bulk_max();
+}
+
+/** Wake up an idle worker, if any. */
+static void
+coio_pool_wakeup(void)
+{
+	tt_pthread_mutex_lock(&coio_pool.mutex);
+	if (coio_pool.idle_count > 0)
+		tt_pthread_cond_signal(&coio_pool.cond);
+	tt_pthread_mutex_unlock(&coio_pool.mutex);
+}
+
+/** Run a task and pass it to the cord that submitted it. */
+static void
+coio_worker_run(struct coio_worker *worker, struct coio_task *task)
+{
+	enum coio_lane lane = task->lane;
+	struct coio_manager *manager = task->manager;
+	double start_time = clock_monotonic();
+	double wait = start_time - task->submit_time;
+	task->run(task);
+	double exec = clock_monotonic() - start_time;
+
+	/* Account the task before its owner learns it's complete. */
+	tt_pthread_mutex_lock(&worker->mutex);
+	struct coio_lane_stat *stat = &worker->stat[lane];
+	stat->count++;
+	stat->wait_total += wait;
+	stat->wait_max = MAX(stat->wait_max, wait);
+	stat->exec_total += exec;
+	stat->exec_max = MAX(stat->exec_max, exec);
+	tt_pthread_mutex_unlock(&worker->mutex);
+
+	/* The task may be freed by its owner from now on. */
+	coio_manager_push(manager, task);
+
+	if (lane == COIO_LANE_BULK) {
+		pm_atomic_fetch_sub(&coio_pool.bulk_running, 1);
+		/* A bulk task may wait for a free slot. */
+		if (pm_atomic_load(&coio_pool.pending[COIO_LANE_BULK]) > 0)
+			coio_pool_wakeup();
+	}
+}
+
+static void *
+coio_worker_f(void *arg)
+{
+	struct coio_worker *worker = arg;
+	while (true) {
+		struct coio_task *task = coio_worker_take(worker);
+		if (task != NULL) {
+			coio_worker_run(worker, task);
+			fiber_check_gc();
+			continue;
+		}
+		tt_pthread_mutex_lock(&coio_pool.mutex);
+		if (worker->id >= coio_pool.worker_count) {
+			worker->is_exiting = true;
+			tt_pthread_mutex_unlock(&coio_pool.mutex);
+			break;
+		}
+		/*
+		 * Submitters push a task before they check for idle
+		 * workers under the mutex, so the task can't be
+		 * missed.
+		 */
+		if (coio_worker_has_nothing_to_do()) {
+			coio_pool.idle_count++;
+			tt_pthread_cond_wait(&coio_pool.cond, &coio_pool.mutex);
+			coio_pool.idle_count--;
+		}
+		tt_pthread_mutex_unlock(&coio_pool.mutex);
+	}
+	return NULL;
+}
+
+/**
+ * Start threads of the workers up to coio_pool::worker_count.
+ * Must be called under coio_pool::mutex.
+ */
+static void
+coio_pool_start_workers(void)
+{
+	for (int i = 0; i < coio_pool.worker_count; i++) {
+		struct coio_worker *worker = coio_pool.workers[i];
+		if (worker == NULL) {
+			worker = xcalloc(1, sizeof(*worker));
+			worker->id = i;
+			for (int lane = 0; lane < coio_lane_MAX; lane++)
+				rlist_create(&worker->queue[lane]);
+			tt_pthread_mutex_init(&worker->mutex, NULL);
+			coio_pool.workers[i] = worker;
+			pm_atomic_store(&coio_pool.worker_alloc_count, i + 1);
+		}
+		if (worker->is_started && !worker->is_exiting)
+			continue;
+		if (worker->is_started) {
+			/* The thread exits without taking the mutex. */
+			if (cord_join(&worker->cord) != 0)
+				diag_log();
+			worker->is_started = false;
+		}
+		worker->is_exiting = false;
+		if (cord_start(&worker->cord, "coio", coio_worker_f,
+			       worker) != 0)
+			panic("failed to start a coio worker thread");
+		worker->is_started = true;
+	}
+}
+
+void
+coio_set_worker_count(int count)
+{
+	count = MIN(MAX(count, 0), COIO_WORKER_COUNT_MAX);
+	tt_pthread_mutex_lock(&coio_pool.mutex);
+	bool is_running = coio_pool.workers[0] != NULL &&
+			  coio_pool.workers[0]->is_started;
+	pm_atomic_store(&coio_pool.worker_count, count);
+	if (is_running)
+		coio_pool_start_workers();
+	/* Let excess workers exit. */
+	tt_pthread_cond_broadcast(&coio_pool.cond);
+	tt_pthread_mutex_unlock(&coio_pool.mutex);
+}
+
+/** Push a task to a worker queue. */
+static void
+coio_pool_submit(struct coio_task *task)
+{
+	assert(coio_manager.loop != NULL);
+	task->manager = &coio_manager;
+	task->submit_time = clock_monotonic();
+	tt_pthread_mutex_lock(&coio_pool.mutex);
+	if (coio_pool.worker_count > 0 &&
+	    (coio_pool.workers[0] == NULL ||
+	     !coio_pool.workers[0]->is_started))
+		coio_pool_start_workers();
+	int worker_count = MAX(coio_pool.worker_count, 1);
+	struct coio_worker *worker =
+		coio_pool.workers[coio_pool.next_worker++ % worker_count];
+	tt_pthread_mutex_unlock(&coio_pool.mutex);
+	if (worker == NULL) {
+		/* The pool is shut down. */
+		return;
+	}
+
+	tt_pthread_mutex_lock(&worker->mutex);
+	rlist_add_tail_entry(&worker->queue[task->lane], task, in_queue);
+	pm_atomic_fetch_add(&coio_pool.pending[task->lane], 1);
+	tt_pthread_mutex_unlock(&worker->mutex);
+	coio_pool_wakeup();
+}
+
+void
+coio_pool_stat(struct coio_lane_stat stat[coio_lane_MAX])
+{
+	memset(stat, 0, sizeof(*stat) * coio_lane_MAX);
+	int worker_count = pm_atomic_load(&coio_pool.worker_alloc_count);
+	for (int i = 0; i < worker_count; i++) {
+		struct coio_worker *worker = coio_pool.workers[i];
+		tt_pthread_mutex_lock(&worker->mutex);
+		for (int lane = 0; lane < coio_lane_MAX; lane++) {
+			struct coio_lane_stat *s = &worker->stat[lane];
+			stat[lane].count += s->count;
+			stat[lane].wait_total += s->wait_total;
+			stat[lane].wait_max = MAX(stat[lane].wait_max,
+						  s->wait_max);
+			stat[lane].exec_total += s->exec_total;
+			stat[lane].exec_max = MAX(stat[lane].exec_max,
+						  s->exec_max);
+		}
+		tt_pthread_mutex_unlock(&worker->mutex);
+	}
+}
+
 void
 coio_init(void)
 {
 	eio_set_thread_on_start(coio_on_start, NULL);
 	eio_set_thread_on_stop(coio_on_stop, NULL);
+	tt_pthread_mutex_init(&coio_pool.mutex, NULL);
+	tt_pthread_cond_init(&coio_pool.cond, NULL);
+	coio_pool.worker_count = COIO_WORKER_COUNT_DEFAULT;
 }
 
 /**
@@ -148,57 +520,40 @@ coio_enable(void)
 	ev_async_init(&coio_manager.coio_async, coio_async_cb);
 
 	ev_async_start(loop(), &coio_manager.coio_async);
+
+	rlist_create(&coio_manager.done);
+	tt_pthread_mutex_init(&coio_manager.mutex, NULL);
+	ev_async_init(&coio_manager.done_async, coio_done_async_cb);
+	coio_manager.done_async.data = &coio_manager;
+	ev_async_start(loop(), &coio_manager.done_async);
 }
 
 void
 coio_shutdown(void)
 {
 	eio_set_max_parallel(0);
-}
-
-static void
-coio_on_feed(eio_req *req)
-{
-	struct coio_task *task = (struct coio_task *) req;
-	req->result = task->task_cb(task);
-	if (req->result)
-		diag_move(diag_get(), &task->diag);
-	fiber_check_gc();
-}
-
-/**
- * A callback invoked by eio_poll when associated
- * eio_request is complete.
- */
-static int
-coio_on_finish(eio_req *req)
-{
-	struct coio_task *task = (struct coio_task *) req;
-	if (task->fiber == NULL) {
-		/*
-		 * Timed out. Resources will be freed by coio_on_destroy.
-		 * NOTE: it is not safe to run timeout_cb handler here.
-		 */
-		return 0;
+	coio_set_worker_count(0);
+	/* Wait for the workers to complete running tasks. */
+	tt_pthread_mutex_lock(&coio_pool.mutex);
+	for (int i = 0; i < coio_pool.worker_alloc_count; i++) {
+		struct coio_worker *worker = coio_pool.workers[i];
+		if (worker->is_started) {
+			tt_pthread_mutex_unlock(&coio_pool.mutex);
+			if (cord_join(&worker->cord) != 0)
+				diag_log();
+			tt_pthread_mutex_lock(&coio_pool.mutex);
+			worker->is_started = false;
+		}
 	}
-
-	task->complete = 1;
-	/* Reset on_timeout hook - resources will be freed by coio_task user */
-	task->base.destroy = NULL;
-	fiber_wakeup(task->fiber);
-	return 0;
+	tt_pthread_mutex_unlock(&coio_pool.mutex);
 }
 
-/*
- * Free resources on timeout.
- */
 static void
-coio_on_destroy(eio_req *req)
+coio_on_feed(struct coio_task *task)
 {
-	struct coio_task *task = (struct coio_task *) req;
-	assert(task->fiber == NULL && task->complete == 0);
-	if (task->timeout_cb != NULL)
-		task->timeout_cb(task);
+	task->result = task->task_cb(task);
+	if (task->result)
+		diag_move(diag_get(), &task->diag);
 }
 
 void
@@ -207,13 +562,12 @@ coio_task_create(struct coio_task *task,
 {
 	assert(func != NULL && on_timeout != NULL);
 
-	/* from eio.c: REQ() definition */
-	memset(&task->base, 0, sizeof(task->base));
-	task->base.type = EIO_CUSTOM;
-	task->base.feed = coio_on_feed;
-	task->base.finish = coio_on_finish;
-	task->base.destroy = coio_on_destroy;
-	/* task->base.pri = 0; */
+	rlist_create(&task->in_queue);
+	task->run = coio_on_feed;
+	task->manager = NULL;
+	task->lane = COIO_LANE_NORMAL;
+	task->submit_time = 0;
+	task->result = 0;
 
 	task->fiber = fiber();
 	task->task_cb = func;
@@ -231,19 +585,20 @@ coio_task_destroy(struct coio_task *task)
 void
 coio_task_post(struct coio_task *task)
 {
-	assert(task->base.type == EIO_CUSTOM);
+	assert(task->run == coio_on_feed);
 	assert(task->fiber == fiber());
-	eio_submit(&task->base);
+	/* Completion is handled in this thread, so it's safe. */
+	coio_pool_submit(task);
 	task->fiber = NULL;
 }
 
 int
 coio_task_execute(struct coio_task *task, double timeout)
 {
-	assert(task->base.type == EIO_CUSTOM);
+	assert(task->run == coio_on_feed);
 	assert(task->fiber == fiber());
 
-	eio_submit(&task->base);
+	coio_pool_submit(task);
 	fiber_yield_timeout(timeout);
 	if (!task->complete) {
 		/* timed out or cancelled. */
@@ -258,11 +613,10 @@ coio_task_execute(struct coio_task *task, double timeout)
 }
 
 static void
-coio_on_call(eio_req *req)
+coio_on_call(struct coio_task *task)
 {
-	struct coio_task *task = (struct coio_task *) req;
-	req->result = task->call_cb(task->ap);
-	if (req->result)
+	task->result = task->call_cb(task->ap);
+	if (task->result)
 		diag_move(diag_get(), &task->diag);
 }
 
@@ -272,12 +626,9 @@ coio_call(ssize_t (*func)(va_list ap), ...)
 	struct coio_task *task = (struct coio_task *) calloc(1, sizeof(*task));
 	if (task == NULL)
 		return -1; /* errno = ENOMEM */
-	/* from eio.c: REQ() definition */
-	task->base.type = EIO_CUSTOM;
-	task->base.feed = coio_on_call;
-	task->base.finish = coio_on_finish;
-	/* task->base.destroy = NULL; */
-	/* task->base.pri = 0; */
+	rlist_create(&task->in_queue);
+	task->run = coio_on_call;
+	task->lane = COIO_LANE_NORMAL;
 
 	task->fiber = fiber();
 	task->call_cb = func;
@@ -285,14 +636,14 @@ coio_call(ssize_t (*func)(va_list ap), ...)
 	diag_create(&task->diag);
 
 	va_start(task->ap, func);
-	eio_submit(&task->base);
+	coio_pool_submit(task);
 
 	do {
 		fiber_yield();
 	} while (task->complete == 0);
 	va_end(task->ap);
 
-	ssize_t result = task->base.result;
+	ssize_t result = task->result;
 	int save_errno = errno;
 	if (result)
 		diag_move(&task->diag, diag_get());
@@ -316,7 +667,7 @@ struct async_getaddrinfo_task {
 
 /*
  * Resolver function, run in separate thread by
- * coio (libeio).
+ * coio.
 */
 static int
 getaddrinfo_cb(struct coio_task *ptr)
@@ -372,6 +723,8 @@ coio_getaddrinfo(const char *host, const char *port,
 	}
 
 	coio_task_create(&task->base, getaddrinfo_cb, getaddrinfo_free_cb);
+	/* Name resolution is usually on the path of a client request. */
+	task->base.lane = COIO_LANE_HIGH;
 
 	/*
 	 * getaddrinfo() on osx upto osx 10.8 crashes when AI_NUMERICSERV is
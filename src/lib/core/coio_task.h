@@ -35,25 +35,80 @@
 
 #include <sys/types.h> /* ssize_t */
 #include <stdarg.h>
+#include <stdint.h>
 
 #include <tarantool_eio.h>
 #include "diag.h"
+#include "small/rlist.h"
 
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
 
 /**
- * Asynchronous IO Tasks (libeio wrapper)
+ * Asynchronous IO Tasks
  *
  * Yield the current fiber until a created task is complete.
+ * Tasks are executed by the coio thread pool, file I/O requests
+ * (see coio_file.h) are executed by the libeio thread pool.
  */
 
 void coio_init(void);
 void coio_enable(void);
 void coio_shutdown(void);
 
+/** Default number of threads in the coio thread pool. */
+enum { COIO_WORKER_COUNT_DEFAULT = 4 };
+
+/** Max number of threads in the coio thread pool. */
+enum { COIO_WORKER_COUNT_MAX = 1000 };
+
+/**
+ * Set the number of threads in the coio thread pool. Threads are
+ * started lazily, on the first task submission.
+ */
+void
+coio_set_worker_count(int count);
+
+/**
+ * Priority lanes of the coio thread pool. A worker thread takes
+ * a task from a lower priority lane only if all higher priority
+ * lanes are empty. Besides, bulk tasks never occupy all threads
+ * of the pool, so there's always a thread to run a task from
+ * a higher priority lane.
+ */
+enum coio_lane {
+	/** Latency-sensitive tasks, e.g. name resolution. */
+	COIO_LANE_HIGH,
+	/** The default lane. */
+	COIO_LANE_NORMAL,
+	/** Long-running background tasks, e.g. file removal. */
+	COIO_LANE_BULK,
+	coio_lane_MAX,
+};
+
+extern const char *coio_lane_strs[];
+
+/** Latency statistics of a coio thread pool lane. */
+struct coio_lane_stat {
+	/** Number of executed tasks. */
+	uint64_t count;
+	/** Total time tasks spent in the queue, in seconds. */
+	double wait_total;
+	/** Max time a task spent in the queue, in seconds. */
+	double wait_max;
+	/** Total time of task execution, in seconds. */
+	double exec_total;
+	/** Max time of a task execution, in seconds. */
+	double exec_max;
+};
+
+/** Get latency statistics of all coio thread pool lanes. */
+void
+coio_pool_stat(struct coio_lane_stat stat[coio_lane_MAX]);
+
 struct coio_task;
+struct coio_manager;
 
 typedef ssize_t (*coio_call_cb)(va_list ap);
 typedef int (*coio_task_cb)(struct coio_task *task); /* like eio_req */
@@ -62,7 +117,18 @@ typedef int (*coio_task_cb)(struct coio_task *task); /* like eio_req */
  * A single task context.
  */
 struct coio_task {
-	struct eio_req base; /* eio_task - must be first */
+	/** Link in a worker queue or in a completion queue. */
+	struct rlist in_queue;
+	/** Runs the task callback in a worker thread. */
+	void (*run)(struct coio_task *task);
+	/** Manager of the cord that submitted the task. */
+	struct coio_manager *manager;
+	/** Priority lane, COIO_LANE_NORMAL by default. */
+	enum coio_lane lane;
+	/** Time of the task submission. */
+	double submit_time;
+	/** Result of the task callback. */
+	ssize_t result;
 	/**
 	 * The calling fiber. When set to NULL, the task is
 	 * detached - its resources are freed eventually, and such
@@ -90,8 +156,11 @@ struct coio_task {
  * Create coio_task.
  *
  * @param task coio task
- * @param func a callback to execute in EIO thread pool.
+ * @param func a callback to execute in the coio thread pool.
  * @param on_timeout a callback to execute on timeout
+ *
+ * The task is executed in COIO_LANE_NORMAL, set task->lane before
+ * submission to change that.
  */
 void
 coio_task_create(struct coio_task *task, coio_task_cb func,
@@ -111,7 +180,7 @@ coio_task_destroy(struct coio_task *task);
  * @param task coio task.
  * @param timeout timeout in seconds.
  * @retval 0  the task completed successfully. Check the result
- *            code in task->base.result and free the task.
+ *            code in task->result and free the task.
  * @retval -1 timeout or the waiting fiber was cancelled (check diag);
  *            the caller should not free the task, it
  *            will be freed when it's finished in the timeout
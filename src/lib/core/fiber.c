@@ -303,6 +303,23 @@ clock_set_on_csw(struct fiber *caller)
 	clock_stat_add_delta(&caller->clock_stat, delta);
 }
 
+/**
+ * Account the time a fiber spent in a ready queue before it was run.
+ */
+static inline void
+fiber_sched_stat_on_call(struct cord *cord, struct fiber *f)
+{
+	if (f->ready_time == 0)
+		return;
+	struct fiber_sched_stat *stat = &cord->sched_stat[f->prio];
+	uint64_t delay = clock_monotonic64() - f->ready_time;
+	f->ready_time = 0;
+	stat->count++;
+	stat->delay_total += delay;
+	if (delay > stat->delay_max)
+		stat->delay_max = delay;
+}
+
 /*
  * Defines a handler to be executed on exit from cord's thread func,
  * accessible via cord()->on_exit (normally NULL). It is used to
@@ -321,6 +338,11 @@ struct cord_on_exit {
 static const struct cord_on_exit cord_on_exit_sentinel = { NULL, NULL };
 #define CORD_ON_EXIT_WONT_RUN (&cord_on_exit_sentinel)
 
+const char *fiber_prio_strs[] = {"high", "normal", "low"};
+
+static_assert(lengthof(fiber_prio_strs) == fiber_prio_MAX,
+	      "Each fiber priority class must have a name");
+
 static struct cord main_cord;
 __thread struct cord *cord_ptr = NULL;
 pthread_t main_thread_id;
@@ -504,6 +526,7 @@ fiber_call_impl(struct fiber *callee)
 	caller->flags &= ~FIBER_IS_RUNNING;
 	cord->fiber = callee;
 	callee->flags = (callee->flags & ~FIBER_IS_READY) | FIBER_IS_RUNNING;
+	fiber_sched_stat_on_call(cord, callee);
 
 	if (cord_is_main())
 		cord_reset_slice(callee);
@@ -545,6 +568,35 @@ fiber_start(struct fiber *callee, ...)
 	va_end(callee->f_data);
 }
 
+/** True if there are fibers in the cord's ready queues. */
+static inline bool
+cord_has_ready(struct cord *cord)
+{
+	for (int i = 0; i < fiber_prio_MAX; i++) {
+		if (!rlist_empty(&cord->ready[i].deadline) ||
+		    !rlist_empty(&cord->ready[i].fifo))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Move a fiber to its position in a list of fibers sorted by
+ * deadline. Deadlines are usually set in the order the fibers are
+ * woken up so the lookup starts from the tail.
+ */
+static void
+fiber_ready_queue_add_deadline(struct fiber_ready_queue *queue,
+			       struct fiber *f)
+{
+	rlist_del(&f->state);
+	struct rlist *pos = queue->deadline.prev;
+	while (pos != &queue->deadline &&
+	       rlist_entry(pos, struct fiber, state)->deadline > f->deadline)
+		pos = pos->prev;
+	rlist_add(pos, &f->state);
+}
+
 static void
 fiber_make_ready(struct fiber *f)
 {
@@ -563,7 +615,7 @@ fiber_make_ready(struct fiber *f)
 	 */
 	assert((f->flags & (FIBER_IS_DEAD | FIBER_IS_READY)) == 0);
 	struct cord *cord = cord();
-	if (rlist_empty(&cord->ready)) {
+	if (!cord_has_ready(cord)) {
 		/*
 		 * ev_feed_event(EV_CUSTOM) gets scheduled in the
 		 * same event loop iteration, and we rely on this
@@ -576,13 +628,20 @@ fiber_make_ready(struct fiber *f)
 	/**
 	 * Removes the fiber from whatever wait list it is on.
 	 *
-	 * It's critical that the newly scheduled fiber is
-	 * added to the tail of the list, to preserve correct
-	 * transaction commit order after a successful WAL write.
-	 * (see tx_schedule_queue() in box/wal.c)
+	 * Fibers are run in the order they are woken up only within
+	 * a priority class and only if they have no deadline, so no
+	 * code may rely on the wakeup order across fibers in general.
+	 * In particular, transactions are committed by the journal
+	 * completion callbacks in tx_schedule_queue() (box/wal.c)
+	 * before their fibers are resumed.
 	 */
-	rlist_move_tail_entry(&cord->ready, f, state);
+	struct fiber_ready_queue *queue = &cord->ready[f->prio];
+	if (f->deadline == TIMEOUT_INFINITY)
+		rlist_move_tail_entry(&queue->fifo, f, state);
+	else
+		fiber_ready_queue_add_deadline(queue, f);
 	f->flags |= FIBER_IS_READY;
+	f->ready_time = fiber_top_enabled ? clock_monotonic64() : 0;
 }
 
 void
@@ -853,6 +912,7 @@ fiber_yield_impl(MAYBE_UNUSED bool will_switch_back)
 	caller->flags &= ~FIBER_IS_RUNNING;
 	cord->fiber = callee;
 	callee->flags = (callee->flags & ~FIBER_IS_READY) | FIBER_IS_RUNNING;
+	fiber_sched_stat_on_call(cord, callee);
 
 	ASAN_START_SWITCH_FIBER(asan_state, will_switch_back, callee->stack,
 				callee->stack_size);
@@ -987,7 +1047,13 @@ fiber_schedule_wakeup(ev_loop *loop, ev_async *watcher, int revents)
 	(void) revents;
 	struct cord *cord = cord();
 	fiber_check_gc();
-	fiber_schedule_list(&cord->ready);
+	/* Run higher priority classes and earlier deadlines first. */
+	RLIST_HEAD(ready);
+	for (int i = 0; i < fiber_prio_MAX; i++) {
+		rlist_splice_tail(&ready, &cord->ready[i].deadline);
+		rlist_splice_tail(&ready, &cord->ready[i].fifo);
+	}
+	fiber_schedule_list(&ready);
 }
 
 static void
@@ -1597,6 +1663,9 @@ fiber_new_ex(const char *name, const struct fiber_attr *fiber_attr,
 	fiber_set_name(fiber, name);
 	register_fid(fiber);
 	fiber->max_slice = zero_slice;
+	fiber->prio = fiber()->prio;
+	fiber->deadline = TIMEOUT_INFINITY;
+	fiber->ready_time = 0;
 	fiber->csw = 0;
 #ifdef ENABLE_BACKTRACE
 	fiber->parent_bt = NULL;
@@ -1691,7 +1760,10 @@ fiber_delete_all(struct cord *cord)
 	cord_collect_garbage(cord);
 	cord_delete_fibers_in_list(cord, &cord->alive);
 	cord_delete_fibers_in_list(cord, &cord->dead);
-	cord_delete_fibers_in_list(cord, &cord->ready);
+	for (int i = 0; i < fiber_prio_MAX; i++) {
+		cord_delete_fibers_in_list(cord, &cord->ready[i].deadline);
+		cord_delete_fibers_in_list(cord, &cord->ready[i].fifo);
+	}
 }
 
 static void
@@ -1849,7 +1921,11 @@ cord_create(struct cord *cord, const char *name)
 	mempool_create(&cord->fiber_mempool, &cord->slabc,
 		       sizeof(struct fiber));
 	rlist_create(&cord->alive);
-	rlist_create(&cord->ready);
+	for (int i = 0; i < fiber_prio_MAX; i++) {
+		rlist_create(&cord->ready[i].deadline);
+		rlist_create(&cord->ready[i].fifo);
+	}
+	memset(cord->sched_stat, 0, sizeof(cord->sched_stat));
 	rlist_create(&cord->dead);
 	cord->garbage = NULL;
 	cord->fiber_registry = mh_i64ptr_new();
@@ -1868,6 +1944,8 @@ cord_create(struct cord *cord, const char *name)
 	cord->fiber = &cord->sched;
 	cord->sched.flags = FIBER_IS_RUNNING | FIBER_IS_SYSTEM;
 	cord->sched.max_slice = zero_slice;
+	cord->sched.prio = FIBER_PRIO_NORMAL;
+	cord->sched.deadline = TIMEOUT_INFINITY;
 	cord->max_slice = default_slice;
 
 	cord->next_fid = FIBER_ID_MAX_RESERVED + 1;
@@ -138,7 +138,7 @@ enum {
 	 */
 	FIBER_IS_JOINABLE	= 1 << 1,
 	/**
-	 * The fiber is in cord->ready list or in
+	 * The fiber is in a cord->ready queue or in
 	 * a call chain created by fiber_schedule_list().
 	 * The flag is set to help fiber_wakeup() avoid
 	 * double wakeup of an already scheduled fiber.
@@ -620,6 +620,24 @@ struct fiber_slice {
 	double err;
 };
 
+/**
+ * Fiber scheduling priority class. Ready fibers of a higher class
+ * are run before ready fibers of a lower one in a scheduler round.
+ * A new fiber inherits the class of the fiber which created it.
+ */
+enum fiber_prio {
+	/** Latency-critical work, e.g. iproto requests. */
+	FIBER_PRIO_HIGH,
+	/** The default class. */
+	FIBER_PRIO_NORMAL,
+	/** Background work, e.g. batch jobs. */
+	FIBER_PRIO_LOW,
+	fiber_prio_MAX,
+};
+
+/** Fiber priority class names, see enum fiber_prio. */
+extern const char *fiber_prio_strs[];
+
 struct fiber {
 	coro_context ctx;
 	/** Coro stack slab. */
@@ -674,8 +692,21 @@ struct fiber {
 	struct clock_stat clock_stat;
 	/** Link in cord->alive or cord->dead list. */
 	struct rlist link;
-	/** Link in cord->ready list. */
+	/** Link in a cord->ready queue. */
 	struct rlist state;
+	/** Scheduling priority class. */
+	enum fiber_prio prio;
+	/**
+	 * Scheduling deadline in ev_monotonic_now() time or
+	 * TIMEOUT_INFINITY. Ready fibers of a priority class that
+	 * have a deadline are run before the others, earliest first.
+	 */
+	double deadline;
+	/**
+	 * Time when the fiber was put to a ready queue, used to
+	 * collect scheduling delay statistics. Zero if unknown.
+	 */
+	uint64_t ready_time;
 
 	/** Triggers invoked before this fiber yields. Must not throw. */
 	struct rlist on_yield;
@@ -775,6 +806,28 @@ fiber_on_stop(struct fiber *f);
 
 struct cord_on_exit;
 
+/** Ready fibers of a priority class. */
+struct fiber_ready_queue {
+	/** Fibers with a deadline, sorted by the deadline. */
+	struct rlist deadline;
+	/** Fibers without a deadline, in the wakeup order. */
+	struct rlist fifo;
+};
+
+/**
+ * Scheduling statistics of a fiber priority class. Collected only
+ * while fiber.top is enabled so as not to read the clock on every
+ * wakeup otherwise.
+ */
+struct fiber_sched_stat {
+	/** Number of times a ready fiber of the class was run. */
+	uint64_t count;
+	/** Total time fibers spent in the ready queue, nanoseconds. */
+	uint64_t delay_total;
+	/** Max time a fiber spent in the ready queue, nanoseconds. */
+	uint64_t delay_max;
+};
+
 /**
  * @brief An independent execution unit that can be managed by a separate OS
  * thread. Each cord consists of fibers to implement cooperative multitasking
@@ -797,8 +850,10 @@ struct cord {
 	struct mh_i64ptr_t *fiber_registry;
 	/** All fibers */
 	struct rlist alive;
-	/** Fibers, ready for execution */
-	struct rlist ready;
+	/** Fibers ready for execution, by priority class. */
+	struct fiber_ready_queue ready[fiber_prio_MAX];
+	/** Scheduling statistics, by priority class. */
+	struct fiber_sched_stat sched_stat[fiber_prio_MAX];
 	/** A cache of dead fibers for reuse */
 	struct rlist dead;
 	/**
@@ -1250,6 +1305,27 @@ fiber_lua_state(struct fiber *f);
 void
 fiber_set_system(struct fiber *f, bool yesno);
 
+/**
+ * Set the scheduling priority class of a fiber. Takes effect on
+ * the next wakeup of the fiber.
+ */
+static inline void
+fiber_set_prio(struct fiber *f, enum fiber_prio prio)
+{
+	assert(prio < fiber_prio_MAX);
+	f->prio = prio;
+}
+
+/**
+ * Set the scheduling deadline of a fiber, TIMEOUT_INFINITY to
+ * drop it. Takes effect on the next wakeup of the fiber.
+ */
+static inline void
+fiber_set_deadline(struct fiber *f, double deadline)
+{
+	f->deadline = deadline;
+}
+
 /**
  * Turn managed shutdown on for system fiber. See FIBER_MANAGED_SHUTDOWN.
  * It is should be used after fiber creation. Using it during shutdown does not
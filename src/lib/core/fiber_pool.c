@@ -75,6 +75,9 @@ fiber_pool_f(va_list ap)
 		 * visible lifecycle.
 		 */
 		fiber_on_stop(f);
+		/* The next message must not inherit scheduling options. */
+		fiber_set_prio(f, FIBER_PRIO_NORMAL);
+		fiber_set_deadline(f, TIMEOUT_INFINITY);
 	}
 	/** Put the current fiber into a fiber cache. */
 	if (!fiber_is_cancelled() && (msg != NULL ||
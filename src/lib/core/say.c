@@ -33,14 +33,19 @@
 #include "errinj.h"
 #include "tt_static.h"
 #include "tt_strerror.h"
+#include "tt_pthread.h"
+#include "pmatomic.h"
 
 #include <errno.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <syslog.h>
@@ -671,6 +676,7 @@ log_create(struct log *log, const char *init_str, int nonblock)
 	log->path = NULL;
 	log->format_func = say_format_plain;
 	log->level = S_INFO;
+	log->is_async = false;
 	log->rotating_threads = 0;
 	tt_pthread_mutex_init(&log->rotate_mutex, NULL);
 	tt_pthread_cond_init(&log->rotate_cond, NULL);
@@ -724,9 +730,15 @@ say_logger_initialized(void)
 	return log_default == &log_std;
 }
 
+static int
+say_async_start(enum say_async_policy policy);
+
+static void
+say_async_stop(void);
+
 void
 say_logger_init(const char *init_str, int level, int nonblock,
-		const char *format)
+		const char *format, const char *async_policy)
 {
 	/*
 	 * The logger may be early configured
@@ -759,6 +771,15 @@ say_logger_init(const char *init_str, int level, int nonblock,
 	log_pid = log_default->pid;
 	say_set_log_format(say_format_by_name(format));
 
+	if (async_policy != NULL && (log_std.type == SAY_LOGGER_FILE ||
+				     log_std.type == SAY_LOGGER_PIPE)) {
+		enum say_async_policy policy =
+			say_async_policy_by_name(async_policy);
+		assert(policy != say_async_policy_MAX);
+		if (say_async_start(policy) != 0)
+			goto fail;
+		pm_atomic_store(&log_std.is_async, true);
+	}
 	return;
 fail:
 	diag_log();
@@ -802,8 +823,11 @@ say_set_background(void)
 void
 say_logger_free(void)
 {
-	if (say_logger_initialized())
-		log_destroy(&log_std);
+	if (!say_logger_initialized())
+		return;
+	if (log_std.is_async)
+		say_async_stop();
+	log_destroy(&log_std);
 }
 
 /** {{{ Formatters */
@@ -1169,6 +1193,425 @@ write_to_syslog(struct log *log, int total)
 
 /** Loggers }}} */
 
+/** {{{ Asynchronous logger */
+
+/**
+ * Size of the ring buffer of a thread writing to the asynchronous
+ * logger. Must be a power of two greater than SAY_BUF_LEN_MAX.
+ */
+enum { SAY_RING_SIZE = 128 * 1024 };
+
+/** Max number of lines written by the logger thread at once. */
+enum { SAY_ASYNC_BATCH = 64 };
+
+/** Ring record length that means "wrap to the ring start". */
+static const uint32_t SAY_RING_WRAP = UINT32_MAX;
+
+static const char *say_async_policy_strs[] = {
+	[SAY_ASYNC_BLOCK] = "block",
+	[SAY_ASYNC_DROP] = "drop",
+	[say_async_policy_MAX] = "unknown"
+};
+
+enum say_async_policy
+say_async_policy_by_name(const char *policy)
+{
+	return STR2ENUM(say_async_policy, policy);
+}
+
+/**
+ * A lock-free single-producer single-consumer ring of formatted
+ * log lines. Every thread writing to the asynchronous logger owns
+ * a ring, the logger thread consumes all rings. A record is a
+ * 32-bit length followed by the line, aligned to 4 bytes.
+ */
+struct say_ring {
+	/** Write position, advanced by the owner thread only. */
+	uint64_t head;
+	/** Number of lines pushed by the owner thread. */
+	uint64_t pushed;
+	/** Number of lines dropped by the owner thread. */
+	uint64_t dropped;
+	/** Read position, advanced by the logger thread only. */
+	uint64_t tail;
+	/** Number of lines written by the logger thread. */
+	uint64_t written;
+	/** Number of dropped lines the logger thread reported. */
+	uint64_t dropped_reported;
+	/**
+	 * Set when the owner thread exits. The logger thread
+	 * frees the ring once it is drained.
+	 */
+	bool is_orphan;
+	/** Link in say_async::rings. */
+	struct rlist in_rings;
+	char data[SAY_RING_SIZE];
+};
+
+/** State of the asynchronous logger. */
+static struct say_async {
+	/** The logger thread. */
+	struct cord cord;
+	/** What to do when a ring is full. */
+	enum say_async_policy policy;
+	/** Rings of all threads, protected by the mutex. */
+	struct rlist rings;
+	/** Stats of freed rings, protected by the mutex. */
+	struct say_async_stat freed_stat;
+	pthread_mutex_t mutex;
+	/**
+	 * Serializes consumers of the rings: the logger thread and
+	 * a thread writing a fatal line. Held while writing lines,
+	 * unlike the mutex. Only a holder may remove rings.
+	 */
+	pthread_mutex_t flush_mutex;
+	/** Signalled to wake up the logger thread. */
+	pthread_cond_t cond;
+	/** Set while the logger thread waits on the cond. */
+	bool is_sleeping;
+	/** Set to make the logger thread drain rings and exit. */
+	bool is_stopping;
+	/** Key to detect owner thread exit, see say_ring::is_orphan. */
+	pthread_key_t ring_key;
+} say_async;
+
+/** Ring of the current thread or NULL if not created yet. */
+static __thread struct say_ring *say_ring;
+
+/**
+ * Set in the logger thread: the lines it logs itself are written
+ * synchronously.
+ */
+static __thread bool say_ring_bypass;
+
+static inline uint32_t
+say_ring_record_size(uint32_t len)
+{
+	return (sizeof(uint32_t) + len + sizeof(uint32_t) - 1) &
+	       ~(sizeof(uint32_t) - 1);
+}
+
+/** Destructor of say_async::ring_key, runs on thread exit. */
+static void
+say_ring_orphan(void *arg)
+{
+	struct say_ring *ring = arg;
+	pm_atomic_store(&ring->is_orphan, true);
+}
+
+/** Get the ring of the current thread, create it if needed. */
+static struct say_ring *
+say_ring_get(void)
+{
+	if (say_ring != NULL)
+		return say_ring;
+	struct say_ring *ring = malloc(sizeof(*ring));
+	if (ring == NULL)
+		return NULL;
+	memset(ring, 0, offsetof(struct say_ring, data));
+	tt_pthread_mutex_lock(&say_async.mutex);
+	rlist_add_tail_entry(&say_async.rings, ring, in_rings);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+	tt_pthread_setspecific(say_async.ring_key, ring);
+	say_ring = ring;
+	return ring;
+}
+
+/**
+ * Push a line to a ring. Returns false if there's not enough
+ * space in the ring.
+ */
+static bool
+say_ring_push(struct say_ring *ring, const char *buf, uint32_t len)
+{
+	assert(len < SAY_BUF_LEN_MAX);
+	uint32_t size = say_ring_record_size(len);
+	uint64_t head = ring->head;
+	uint64_t tail = pm_atomic_load_explicit(&ring->tail,
+						pm_memory_order_acquire);
+	uint32_t offset = head % SAY_RING_SIZE;
+	uint32_t skip = 0;
+	if (offset + size > SAY_RING_SIZE)
+		skip = SAY_RING_SIZE - offset;
+	if (head + skip + size - tail > SAY_RING_SIZE)
+		return false;
+	if (skip > 0) {
+		memcpy(ring->data + offset, &SAY_RING_WRAP, sizeof(uint32_t));
+		head += skip;
+		offset = 0;
+	}
+	memcpy(ring->data + offset, &len, sizeof(uint32_t));
+	memcpy(ring->data + offset + sizeof(uint32_t), buf, len);
+	pm_atomic_store(&ring->pushed, ring->pushed + 1);
+	pm_atomic_store_explicit(&ring->head, head + size,
+				 pm_memory_order_release);
+	return true;
+}
+
+/** Wake up the logger thread if it is sleeping. */
+static void
+say_async_wakeup(bool force)
+{
+	if (!force && !pm_atomic_load(&say_async.is_sleeping))
+		return;
+	tt_pthread_mutex_lock(&say_async.mutex);
+	tt_pthread_cond_signal(&say_async.cond);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+}
+
+/**
+ * Pass a formatted line to the logger thread. Returns false if
+ * the line must be written synchronously.
+ */
+static bool
+say_async_push(const char *buf, int total)
+{
+	if (say_ring_bypass)
+		return false;
+	struct say_ring *ring = say_ring_get();
+	if (ring == NULL)
+		return false;
+	uint32_t len = MIN(total, SAY_BUF_LEN_MAX - 1);
+	while (!say_ring_push(ring, buf, len)) {
+		if (say_async.policy == SAY_ASYNC_DROP) {
+			pm_atomic_store(&ring->dropped, ring->dropped + 1);
+			return true;
+		}
+		say_async_wakeup(true);
+		usleep(100);
+	}
+	say_async_wakeup(false);
+	return true;
+}
+
+/** Write all the given buffers, retrying on partial writes. */
+static void
+say_async_writev(int fd, struct iovec *iov, int iovcnt)
+{
+	while (iovcnt > 0) {
+		ssize_t r = writev(fd, iov, iovcnt);
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				usleep(1000);
+				continue;
+			}
+			/* Nothing to do with it, drop the batch. */
+			return;
+		}
+		while (iovcnt > 0 && (size_t)r >= iov->iov_len) {
+			r -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + r;
+			iov->iov_len -= r;
+		}
+	}
+}
+
+/**
+ * Write out all lines of a ring in batches. Returns the number of
+ * written lines.
+ */
+static uint64_t
+say_ring_flush(struct say_ring *ring, int fd)
+{
+	struct iovec iov[SAY_ASYNC_BATCH];
+	uint64_t head = pm_atomic_load_explicit(&ring->head,
+						pm_memory_order_acquire);
+	uint64_t tail = ring->tail;
+	uint64_t count = 0;
+	while (tail < head) {
+		int iovcnt = 0;
+		while (tail < head && iovcnt < SAY_ASYNC_BATCH) {
+			uint32_t offset = tail % SAY_RING_SIZE;
+			uint32_t len;
+			memcpy(&len, ring->data + offset, sizeof(uint32_t));
+			if (len == SAY_RING_WRAP) {
+				tail += SAY_RING_SIZE - offset;
+				continue;
+			}
+			iov[iovcnt].iov_base = ring->data + offset +
+					       sizeof(uint32_t);
+			iov[iovcnt].iov_len = len;
+			iovcnt++;
+			tail += say_ring_record_size(len);
+		}
+		say_async_writev(fd, iov, iovcnt);
+		count += iovcnt;
+		pm_atomic_store(&ring->written, ring->written + iovcnt);
+		pm_atomic_store_explicit(&ring->tail, tail,
+					 pm_memory_order_release);
+	}
+	return count;
+}
+
+/**
+ * Write out lines of all rings and free drained rings of exited
+ * threads. Returns the number of written lines, the number of
+ * newly dropped lines is returned in @a dropped.
+ */
+static uint64_t
+say_async_flush_rings(uint64_t *dropped)
+{
+	uint64_t count = 0;
+	*dropped = 0;
+	int fd = log_std.fd;
+	tt_pthread_mutex_lock(&say_async.flush_mutex);
+	/*
+	 * The mutex is taken only to walk the list, which may be
+	 * appended concurrently, so that writing lines doesn't block
+	 * threads creating rings or reading stats.
+	 */
+	tt_pthread_mutex_lock(&say_async.mutex);
+	struct say_ring *ring = rlist_first_entry(&say_async.rings,
+						  struct say_ring, in_rings);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+	while (&ring->in_rings != &say_async.rings) {
+		/* Check before flush to not miss the last lines. */
+		bool is_orphan = pm_atomic_load(&ring->is_orphan);
+		count += say_ring_flush(ring, fd);
+		uint64_t ring_dropped = pm_atomic_load(&ring->dropped);
+		*dropped += ring_dropped - ring->dropped_reported;
+		ring->dropped_reported = ring_dropped;
+		tt_pthread_mutex_lock(&say_async.mutex);
+		struct say_ring *next = rlist_next_entry(ring, in_rings);
+		if (is_orphan) {
+			say_async.freed_stat.written += ring->written;
+			say_async.freed_stat.dropped += ring_dropped;
+			rlist_del_entry(ring, in_rings);
+			free(ring);
+		}
+		tt_pthread_mutex_unlock(&say_async.mutex);
+		ring = next;
+	}
+	tt_pthread_mutex_unlock(&say_async.flush_mutex);
+	return count;
+}
+
+/**
+ * Write out lines of all rings and report dropped lines. Returns
+ * the number of written lines.
+ */
+static uint64_t
+say_async_flush(void)
+{
+	uint64_t dropped;
+	uint64_t count = say_async_flush_rings(&dropped);
+	if (dropped > 0)
+		say_warn("%llu log lines were dropped because "
+			 "the log queue was full", (long long unsigned)dropped);
+	return count;
+}
+
+/** True if any ring has lines to write. */
+static bool
+say_async_has_pending(void)
+{
+	struct say_ring *ring;
+	rlist_foreach_entry(ring, &say_async.rings, in_rings) {
+		if (pm_atomic_load(&ring->head) !=
+		    pm_atomic_load(&ring->tail))
+			return true;
+	}
+	return false;
+}
+
+/** Logger thread function. */
+static void *
+say_async_f(void *arg)
+{
+	(void)arg;
+	say_ring_bypass = true;
+	while (true) {
+		bool is_stopping = pm_atomic_load(&say_async.is_stopping);
+		if (say_async_flush() > 0)
+			continue;
+		if (is_stopping)
+			break;
+		tt_pthread_mutex_lock(&say_async.mutex);
+		pm_atomic_store(&say_async.is_sleeping, true);
+		if (!say_async_has_pending() &&
+		    !pm_atomic_load(&say_async.is_stopping)) {
+			/*
+			 * The timeout is a safety net: producers
+			 * signal the cond when they see the flag.
+			 */
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_sec += 1;
+			tt_pthread_cond_timedwait(&say_async.cond,
+						  &say_async.mutex, &ts);
+		}
+		pm_atomic_store(&say_async.is_sleeping, false);
+		tt_pthread_mutex_unlock(&say_async.mutex);
+	}
+	return NULL;
+}
+
+/** Start the logger thread. */
+static int
+say_async_start(enum say_async_policy policy)
+{
+	say_async.policy = policy;
+	rlist_create(&say_async.rings);
+	memset(&say_async.freed_stat, 0, sizeof(say_async.freed_stat));
+	say_async.is_sleeping = false;
+	say_async.is_stopping = false;
+	tt_pthread_mutex_init(&say_async.mutex, NULL);
+	tt_pthread_mutex_init(&say_async.flush_mutex, NULL);
+	tt_pthread_cond_init(&say_async.cond, NULL);
+	tt_pthread_key_create(&say_async.ring_key, say_ring_orphan);
+	if (cord_start(&say_async.cord, "logger", say_async_f, NULL) != 0) {
+		tt_pthread_key_delete(say_async.ring_key);
+		tt_pthread_cond_destroy(&say_async.cond);
+		tt_pthread_mutex_destroy(&say_async.flush_mutex);
+		tt_pthread_mutex_destroy(&say_async.mutex);
+		return -1;
+	}
+	return 0;
+}
+
+/** Write out all queued lines and stop the logger thread. */
+static void
+say_async_stop(void)
+{
+	/* New lines are written synchronously from now on. */
+	pm_atomic_store(&log_std.is_async, false);
+	pm_atomic_store(&say_async.is_stopping, true);
+	say_async_wakeup(true);
+	if (cord_join(&say_async.cord) != 0)
+		diag_log();
+	/*
+	 * Rings of alive threads are not freed since the threads
+	 * may still refer to them.
+	 */
+}
+
+void
+say_async_stat(struct say_async_stat *stat)
+{
+	memset(stat, 0, sizeof(*stat));
+	if (!pm_atomic_load(&log_std.is_async))
+		return;
+	tt_pthread_mutex_lock(&say_async.mutex);
+	*stat = say_async.freed_stat;
+	struct say_ring *ring;
+	rlist_foreach_entry(ring, &say_async.rings, in_rings) {
+		uint64_t pushed = pm_atomic_load(&ring->pushed);
+		uint64_t written = pm_atomic_load(&ring->written);
+		stat->queued += pushed - written;
+		stat->written += written;
+		stat->dropped += pm_atomic_load(&ring->dropped);
+	}
+	tt_pthread_mutex_unlock(&say_async.mutex);
+}
+
+/** Asynchronous logger }}} */
+
 /*
  * Init string parser(s)
  */
@@ -1372,6 +1815,19 @@ log_vsay(struct log *log, int level, bool check_level, const char *module,
 	switch (log->type) {
 	case SAY_LOGGER_FILE:
 	case SAY_LOGGER_PIPE:
+		if (pm_atomic_load(&log->is_async)) {
+			if (level != S_FATAL && say_async_push(say_buf, total))
+				break;
+			/*
+			 * A fatal line is written synchronously, since
+			 * the process is going to die, but after the
+			 * queued lines. The dropped lines aren't
+			 * reported so as not to overwrite say_buf.
+			 */
+			uint64_t dropped;
+			if (level == S_FATAL && !say_ring_bypass)
+				say_async_flush_rings(&dropped);
+		}
 		write_to_file(log, total);
 		break;
 	case SAY_LOGGER_STDERR:
@@ -96,6 +96,44 @@ say_log_level_is_enabled(int level)
 
 extern enum say_format log_format;
 
+/**
+ * What the asynchronous logger does with a log line when the ring
+ * buffer of the writing thread is full.
+ */
+enum say_async_policy {
+	/** Wait until the logger thread frees some space. */
+	SAY_ASYNC_BLOCK,
+	/** Drop the line and count it in say_async_stat::dropped. */
+	SAY_ASYNC_DROP,
+	say_async_policy_MAX
+};
+
+/**
+ * Return asynchronous logger policy by name.
+ *
+ * @retval say_async_policy_MAX on error
+ * @retval say_async_policy otherwise
+ */
+enum say_async_policy
+say_async_policy_by_name(const char *policy);
+
+/** Statistics of the asynchronous logger. */
+struct say_async_stat {
+	/** Lines waiting in ring buffers to be written. */
+	uint64_t queued;
+	/** Lines written by the logger thread. */
+	uint64_t written;
+	/** Lines dropped because a ring buffer was full. */
+	uint64_t dropped;
+};
+
+/**
+ * Get statistics of the asynchronous logger. All counters are
+ * zero if the default logger is synchronous.
+ */
+void
+say_async_stat(struct say_async_stat *stat);
+
 enum say_syslog_server_type {
 	SAY_SYSLOG_DEFAULT,
 	SAY_SYSLOG_UNIX,
@@ -174,6 +212,12 @@ struct log {
 	 */
 	char *path;
 	bool nonblock;
+	/**
+	 * Set if lines are written by the logger thread, see
+	 * say_logger_init(). Only the default logger can be
+	 * asynchronous.
+	 */
+	bool is_async;
 	log_format_func_t format_func;
 	/** pid of the process if logging to pipe. */
 	pid_t pid;
@@ -316,11 +360,19 @@ struct ev_signal;
 void
 say_logrotate(struct ev_loop *, struct ev_signal *, int /* revents */);
 
-/** Init default logger. */
+/**
+ * Init default logger.
+ *
+ * If @a async_policy is not NULL, log lines are formatted into
+ * a per-thread ring buffer and written by a dedicated logger
+ * thread, so a slow disk doesn't stall the threads that log.
+ * The policy ("block" or "drop") tells what to do when the ring
+ * buffer is full. Only file and pipe loggers can be asynchronous.
+ */
 void
 say_logger_init(const char *init_str,
 		int log_level, int nonblock,
-		const char *log_format);
+		const char *log_format, const char *async_policy);
 
 /**
  * Turn on background mode for logger. Should be called after say_logger_init.
@@ -0,0 +1,1332 @@
+/*
+ * *No header guard*: the header is allowed to be included twice
+ * with different sets of defines.
+ */
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright 2010-2024, Tarantool AUTHORS, please see AUTHORS file.
+ */
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "small/matras.h"
+
+/**
+ * Open addressing hash table with Swiss table style layout.
+ *
+ * Slots are organized in groups of SWISS_GROUP_SIZE. Every group stores
+ * an array of control bytes, an array of full hashes and an array of
+ * values. A control byte is either SWISS_CTRL_EMPTY, SWISS_CTRL_DELETED
+ * or the 7 lowest bits of the hash of the value stored in the slot.
+ * A lookup compares the control bytes of a whole group against the hash
+ * fingerprint at once (with SSE2 if available), then compares the full
+ * hashes of matching slots, and only calls the comparison function for
+ * slots which hashes are equal, so values (tuples) are dereferenced
+ * only on a real match. Groups are probed quadratically until a group
+ * with an empty slot is found.
+ *
+ * The table is stored in matras, one group per block, so that it
+ * supports frozen read views like light does. Unlike light, the table
+ * is grown by rehashing all values into a new matras twice as large.
+ * Matras that are still used by read views are kept alive until the
+ * last read view is destroyed. Rehashing doesn't call the comparison
+ * function and is done incrementally so that an insertion never takes
+ * time proportional to the table size:
+ *
+ *  1. When the number of free slots drops to the number of groups, the
+ *     groups of the new matras start to be allocated, SWISS_REHASH_STEP
+ *     groups on each insertion. Values are still inserted to the old
+ *     matras meanwhile.
+ *  2. Once all the new groups are allocated, the new matras becomes the
+ *     current one and new values are inserted to it. The values of the
+ *     old matras are moved to the new one, SWISS_REHASH_STEP groups on
+ *     each insertion. Lookups check both matras meanwhile.
+ *
+ * The old matras isn't modified by moving values out of it so that
+ * the probe sequences going through moved groups stay intact; values
+ * of moved groups are ignored instead.
+ *
+ * The interface is the same as the one of light.h.
+ */
+
+#ifndef SWISS_NAME
+#error "SWISS_NAME must be defined"
+#endif
+
+/**
+ * Data type that hash table holds.
+ */
+#ifndef SWISS_DATA_TYPE
+#error "SWISS_DATA_TYPE must be defined"
+#endif
+
+/**
+ * Data type that used to for finding values.
+ */
+#ifndef SWISS_KEY_TYPE
+#error "SWISS_KEY_TYPE must be defined"
+#endif
+
+/**
+ * Type of optional third parameter of comparing function.
+ * If not needed, simply use #define SWISS_CMP_ARG_TYPE int
+ */
+#ifndef SWISS_CMP_ARG_TYPE
+#error "SWISS_CMP_ARG_TYPE must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value1, value2 and
+ * optional value that stored in hash table struct.
+ */
+#ifndef SWISS_EQUAL
+#error "SWISS_EQUAL must be defined"
+#endif
+
+/**
+ * Data comparing function. Takes 3 parameters - value, key and
+ * optional value that stored in hash table struct.
+ */
+#ifndef SWISS_EQUAL_KEY
+#error "SWISS_EQUAL_KEY must be defined"
+#endif
+
+#ifndef SWISS_GROUP_DEFINED
+#define SWISS_GROUP_DEFINED
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+enum {
+	/** Number of slots in a group. */
+	SWISS_GROUP_SIZE = 16,
+	/** Control byte of an empty slot. */
+	SWISS_CTRL_EMPTY = 0x80,
+	/** Control byte of a deleted slot (tombstone). */
+	SWISS_CTRL_DELETED = 0xFE,
+	/** Number of hash bits stored in a control byte. */
+	SWISS_CTRL_HASH_BITS = 7,
+	/**
+	 * Number of groups allocated or moved on each insertion while
+	 * the table is being rehashed. The growth threshold guarantees
+	 * that a rehash is complete before the table runs out of free
+	 * slots if this is at least 2.
+	 */
+	SWISS_REHASH_STEP = 2,
+};
+
+/** Control byte of a slot storing a value with the given hash. */
+static inline uint8_t
+swiss_ctrl_hash(uint32_t hash)
+{
+	return hash & ((1 << SWISS_CTRL_HASH_BITS) - 1);
+}
+
+/**
+ * Returns a bit mask of the group slots which control bytes are equal
+ * to @a ctrl_byte.
+ */
+static inline uint32_t
+swiss_group_match(const uint8_t *ctrl, uint8_t ctrl_byte)
+{
+#if defined(__SSE2__)
+	__m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(group,
+						_mm_set1_epi8(ctrl_byte)));
+#else
+	uint32_t mask = 0;
+	for (int i = 0; i < SWISS_GROUP_SIZE; i++)
+		mask |= (uint32_t)(ctrl[i] == ctrl_byte) << i;
+	return mask;
+#endif
+}
+
+/**
+ * Returns a bit mask of the group slots that don't store a value.
+ * Both SWISS_CTRL_EMPTY and SWISS_CTRL_DELETED have the high bit set.
+ */
+static inline uint32_t
+swiss_group_match_free(const uint8_t *ctrl)
+{
+#if defined(__SSE2__)
+	__m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+	return _mm_movemask_epi8(group);
+#else
+	uint32_t mask = 0;
+	for (int i = 0; i < SWISS_GROUP_SIZE; i++)
+		mask |= (uint32_t)(ctrl[i] >> 7) << i;
+	return mask;
+#endif
+}
+
+/** Returns a bit mask of the group slots that store a value. */
+static inline uint32_t
+swiss_group_match_full(const uint8_t *ctrl)
+{
+	return ~swiss_group_match_free(ctrl) & ((1 << SWISS_GROUP_SIZE) - 1);
+}
+
+/** Returns a bit mask of the empty group slots. */
+static inline uint32_t
+swiss_group_match_empty(const uint8_t *ctrl)
+{
+	return swiss_group_match(ctrl, SWISS_CTRL_EMPTY);
+}
+
+/** Group of a slot. */
+static inline uint32_t
+swiss_slot_group(uint32_t slot)
+{
+	return slot / SWISS_GROUP_SIZE;
+}
+
+/** Position of a slot in its group. */
+static inline uint32_t
+swiss_slot_pos(uint32_t slot)
+{
+	return slot % SWISS_GROUP_SIZE;
+}
+
+#endif /* SWISS_GROUP_DEFINED */
+
+/**
+ * Tools for name substitution:
+ */
+#ifndef CONCAT4
+#define CONCAT4_R(a, b, c, d) a##b##c##d
+#define CONCAT4(a, b, c, d) CONCAT4_R(a, b, c, d)
+#endif
+
+#ifdef _
+#error '_' must be undefinded!
+#endif
+#define SWISS(name) CONCAT4(swiss, SWISS_NAME, _, name)
+
+/**
+ * Group of slots, stored in one matras block.
+ */
+struct SWISS(group) {
+	/** Control bytes, see swiss_ctrl_hash(). */
+	uint8_t ctrl[SWISS_GROUP_SIZE];
+	/** Full hashes of stored values. */
+	uint32_t hash[SWISS_GROUP_SIZE];
+	/** Stored values. */
+	SWISS_DATA_TYPE value[SWISS_GROUP_SIZE];
+};
+
+/**
+ * Matras storing groups of a hash table. Shared by the hash table and
+ * read views created while the hash table used it.
+ */
+struct SWISS(storage) {
+	/** Dynamic storage for groups. */
+	struct matras mtable;
+	/** Number of references: the hash table and its read views. */
+	uint32_t refs;
+};
+
+/**
+ * Common fields used by both a hash table and a hash table view
+ */
+struct SWISS(common) {
+	/** Number of values in hash table. */
+	uint32_t count;
+	/** Number of groups, power of two or zero. */
+	uint32_t group_count;
+	/** Additional parameter for data comparison. */
+	SWISS_CMP_ARG_TYPE arg;
+	/** Group storage, NULL if group_count is zero. */
+	struct SWISS(storage) *storage;
+	/** Version of matras memory for MVCC. */
+	struct matras_view *view;
+	/**
+	 * Storage which values are being moved to the current one by
+	 * a rehash or NULL. Slots of the old storage are numbered after
+	 * the slots of the current one.
+	 */
+	struct SWISS(storage) *old_storage;
+	/** Number of groups in the old storage. */
+	uint32_t old_group_count;
+	/**
+	 * Number of groups of the old storage which values have been
+	 * moved to the current storage.
+	 */
+	uint32_t rehash_pos;
+	/** Version of the old storage matras memory for MVCC. */
+	struct matras_view *old_view;
+};
+
+/**
+ * Main struct for holding hash table
+ */
+struct SWISS(core) {
+	/** Hash table implementation. */
+	struct SWISS(common) common;
+	/**
+	 * Number of empty slots that can be used before the table has to
+	 * be rehashed to keep the load factor not greater than 7/8.
+	 */
+	uint32_t growth_left;
+	/** Number of deleted slots (tombstones). */
+	uint32_t deleted_count;
+	/** Head matras view. */
+	struct matras_view view;
+	/** Head matras view of the old storage. */
+	struct matras_view old_view;
+	/**
+	 * Storage being allocated by a rehash or NULL. It becomes
+	 * the current storage once all its groups are allocated.
+	 */
+	struct SWISS(storage) *new_storage;
+	/** Number of groups of the new storage. */
+	uint32_t new_group_count;
+	/** Number of groups of the new storage allocated so far. */
+	uint32_t new_alloc_count;
+	/** Arguments passed to matras_create() on rehash. */
+	size_t extent_size;
+	matras_alloc_func extent_alloc_func;
+	matras_free_func extent_free_func;
+	void *alloc_ctx;
+	struct matras_stats *alloc_stats;
+};
+
+/**
+ * Hash table view - frozen snapshot of a hash table
+ */
+struct SWISS(view) {
+	/** Hash table implementation. */
+	struct SWISS(common) common;
+	/** Version of matras memory for MVCC. */
+	struct matras_view view;
+	/** Version of the old storage matras memory for MVCC. */
+	struct matras_view old_view;
+};
+
+/**
+ * Iterator, for iterating all values in hash_table.
+ * It also may be used for restoring one value by key.
+ */
+struct SWISS(iterator) {
+	/** Current position in the table (ID of the current slot). */
+	uint32_t slotpos;
+};
+
+/**
+ * Special result of swiss_find that means that nothing was found
+ * Must be greater than possible hash table size
+ */
+static const uint32_t SWISS(end) = 0xFFFFFFFF;
+
+/** Size of a matras block storing a group, power of two. */
+static inline uint32_t
+SWISS(block_size)(void)
+{
+	uint32_t size = sizeof(struct SWISS(group));
+	return 1u << (32 - __builtin_clz(size - 1));
+}
+
+/** Total number of slots in the current storage of a hash table. */
+static inline uint32_t
+SWISS(capacity)(const struct SWISS(common) *ht)
+{
+	return ht->group_count * SWISS_GROUP_SIZE;
+}
+
+/** Total number of slots in both storages of a hash table. */
+static inline uint32_t
+SWISS(slot_count)(const struct SWISS(common) *ht)
+{
+	return (ht->group_count + ht->old_group_count) * SWISS_GROUP_SIZE;
+}
+
+/** Group that starts the probe sequence for the given hash. */
+static inline uint32_t
+SWISS(probe_start)(uint32_t group_count, uint32_t hash)
+{
+	return (hash >> SWISS_CTRL_HASH_BITS) & (group_count - 1);
+}
+
+/**
+ * Next group in the probe sequence. Triangular numbers visit every
+ * group exactly once if the number of groups is a power of two.
+ */
+static inline uint32_t
+SWISS(probe_next)(uint32_t group_count, uint32_t group, uint32_t step)
+{
+	return (group + step) & (group_count - 1);
+}
+
+/**
+ * Get a group of the current or the old storage for read.
+ */
+static inline struct SWISS(group) *
+SWISS(get_group)(const struct SWISS(common) *ht, bool is_old, uint32_t group)
+{
+	if (is_old) {
+		return (struct SWISS(group) *)matras_view_get(
+			&ht->old_storage->mtable, ht->old_view, group);
+	}
+	return (struct SWISS(group) *)matras_view_get(&ht->storage->mtable,
+						      ht->view, group);
+}
+
+/**
+ * Get a group of the current or the old storage for update.
+ */
+static inline struct SWISS(group) *
+SWISS(touch_group)(struct SWISS(common) *ht, bool is_old, uint32_t group)
+{
+	if (is_old) {
+		assert(!matras_is_read_view_created(ht->old_view));
+		return (struct SWISS(group) *)matras_touch(
+			&ht->old_storage->mtable, group);
+	}
+	assert(!matras_is_read_view_created(ht->view));
+	return (struct SWISS(group) *)matras_touch(&ht->storage->mtable,
+						   group);
+}
+
+/** Get the group storing the given slot for read. */
+static inline struct SWISS(group) *
+SWISS(get_slot_group)(const struct SWISS(common) *ht, uint32_t slot)
+{
+	uint32_t capacity = SWISS(capacity)(ht);
+	if (slot < capacity)
+		return SWISS(get_group)(ht, false, swiss_slot_group(slot));
+	return SWISS(get_group)(ht, true, swiss_slot_group(slot - capacity));
+}
+
+static inline void
+SWISS(storage_unref)(struct SWISS(storage) *storage)
+{
+	assert(storage->refs > 0);
+	if (--storage->refs == 0) {
+		matras_destroy(&storage->mtable);
+		free(storage);
+	}
+}
+
+/**
+ * @brief Hash table construction. Fills struct swiss members.
+ * @param ht - pointer to a hash table struct
+ * @param arg - optional parameter to save for comparing function
+ * @param extent_size - size of allocating memory blocks
+ * @param extent_alloc_func - memory blocks allocation function
+ * @param extent_free_func - memory blocks allocation function
+ * @param alloc_ctx - argument passed to memory block allocator
+ * @param alloc_stats - optional extent allocator statistics
+ */
+static inline void
+SWISS(create)(struct SWISS(core) *htab, SWISS_CMP_ARG_TYPE arg,
+	      size_t extent_size, matras_alloc_func extent_alloc_func,
+	      matras_free_func extent_free_func, void *alloc_ctx,
+	      struct matras_stats *alloc_stats)
+{
+	struct SWISS(common) *ht = &htab->common;
+	assert(extent_size >= SWISS(block_size)());
+	ht->count = 0;
+	ht->group_count = 0;
+	ht->arg = arg;
+	ht->storage = NULL;
+	ht->view = &htab->view;
+	ht->old_storage = NULL;
+	ht->old_group_count = 0;
+	ht->rehash_pos = 0;
+	ht->old_view = &htab->old_view;
+	htab->growth_left = 0;
+	htab->deleted_count = 0;
+	htab->new_storage = NULL;
+	htab->new_group_count = 0;
+	htab->new_alloc_count = 0;
+	htab->extent_size = extent_size;
+	htab->extent_alloc_func = extent_alloc_func;
+	htab->extent_free_func = extent_free_func;
+	htab->alloc_ctx = alloc_ctx;
+	htab->alloc_stats = alloc_stats;
+	matras_head_read_view(&htab->view);
+	matras_head_read_view(&htab->old_view);
+}
+
+/**
+ * @brief Hash table destruction. Frees all allocated memory
+ * that isn't used by read views.
+ * @param ht - pointer to a hash table struct
+ */
+static inline void
+SWISS(destroy)(struct SWISS(core) *htab)
+{
+	if (htab->common.storage != NULL)
+		SWISS(storage_unref)(htab->common.storage);
+	if (htab->common.old_storage != NULL)
+		SWISS(storage_unref)(htab->common.old_storage);
+	if (htab->new_storage != NULL)
+		SWISS(storage_unref)(htab->new_storage);
+}
+
+/**
+ * @brief Hash table view construction.
+ *  All following hash table updates will not apply to the view.
+ * @param v - pointer to a hash table view struct
+ * @param ht - pointer to a hash table struct
+ */
+static inline void
+SWISS(view_create)(struct SWISS(view) *v, struct SWISS(core) *htab)
+{
+	v->common = htab->common;
+	v->common.view = &v->view;
+	v->common.old_view = &v->old_view;
+	if (v->common.storage != NULL) {
+		v->common.storage->refs++;
+		matras_create_read_view(&v->common.storage->mtable, &v->view);
+	} else {
+		matras_head_read_view(&v->view);
+	}
+	if (v->common.old_storage != NULL) {
+		v->common.old_storage->refs++;
+		matras_create_read_view(&v->common.old_storage->mtable,
+					&v->old_view);
+	} else {
+		matras_head_read_view(&v->old_view);
+	}
+}
+
+/**
+ * @brief Hash table view destruction.
+ * @param v - pointer to a hash table view struct
+ */
+static inline void
+SWISS(view_destroy)(struct SWISS(view) *v)
+{
+	struct SWISS(storage) *storage = v->common.storage;
+	if (storage != NULL) {
+		matras_destroy_read_view(&storage->mtable, &v->view);
+		SWISS(storage_unref)(storage);
+	}
+	storage = v->common.old_storage;
+	if (storage != NULL) {
+		matras_destroy_read_view(&storage->mtable, &v->old_view);
+		SWISS(storage_unref)(storage);
+	}
+}
+
+/**
+ * @brief Number of records stored in hash table
+ * @param ht - pointer to a hash table struct
+ * @return number of records
+ */
+static inline uint32_t
+SWISS(count)(struct SWISS(core) *htab)
+{
+	return htab->common.count;
+}
+
+/**
+ * @brief Number of records stored in hash table view
+ * @param v - pointer to a hash table view struct
+ * @return number of records
+ */
+static inline uint32_t
+SWISS(view_count)(struct SWISS(view) *v)
+{
+	return v->common.count;
+}
+
+/**
+ * @brief Number of matras extents used by hash table
+ * @param ht - pointer to a hash table struct
+ * @return number of extents
+ */
+static inline size_t
+SWISS(extent_count)(const struct SWISS(core) *htab)
+{
+	size_t count = 0;
+	if (htab->common.storage != NULL)
+		count += matras_extent_count(&htab->common.storage->mtable);
+	if (htab->common.old_storage != NULL)
+		count += matras_extent_count(&htab->common.old_storage->mtable);
+	if (htab->new_storage != NULL)
+		count += matras_extent_count(&htab->new_storage->mtable);
+	return count;
+}
+
+/**
+ * Find a record with given hash and value in the current or the old
+ * storage. Values of the old storage groups that have been moved to
+ * the current storage are skipped.
+ * Returns the slot in the storage or swiss_end if nothing found.
+ */
+static inline uint32_t
+SWISS(find_in)(const struct SWISS(common) *ht, bool is_old, uint32_t hash,
+	       SWISS_DATA_TYPE value)
+{
+	uint32_t group_count = is_old ? ht->old_group_count : ht->group_count;
+	uint32_t moved_count = is_old ? ht->rehash_pos : 0;
+	uint8_t ctrl_byte = swiss_ctrl_hash(hash);
+	uint32_t group_id = SWISS(probe_start)(group_count, hash);
+	for (uint32_t step = 1; ; step++) {
+		assert(step <= group_count);
+		struct SWISS(group) *group =
+			SWISS(get_group)(ht, is_old, group_id);
+		uint32_t mask = group_id >= moved_count ?
+				swiss_group_match(group->ctrl, ctrl_byte) : 0;
+		while (mask != 0) {
+			uint32_t i = __builtin_ctz(mask);
+			if (group->hash[i] == hash &&
+			    SWISS_EQUAL((group->value[i]), (value), (ht->arg)))
+				return group_id * SWISS_GROUP_SIZE + i;
+			mask &= mask - 1;
+		}
+		if (swiss_group_match_empty(group->ctrl) != 0)
+			return SWISS(end);
+		group_id = SWISS(probe_next)(group_count, group_id, step);
+	}
+}
+
+/**
+ * @brief Find a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param data - value to find
+ * @return integer ID of found record or swiss_end if nothing found
+ */
+static inline uint32_t
+SWISS(find_impl)(const struct SWISS(common) *ht, uint32_t hash,
+		 SWISS_DATA_TYPE value)
+{
+	if (ht->count == 0)
+		return SWISS(end);
+	uint32_t slot = SWISS(find_in)(ht, false, hash, value);
+	if (slot != SWISS(end) || ht->old_storage == NULL)
+		return slot;
+	slot = SWISS(find_in)(ht, true, hash, value);
+	if (slot == SWISS(end))
+		return slot;
+	return SWISS(capacity)(ht) + slot;
+}
+
+static inline uint32_t
+SWISS(find)(const struct SWISS(core) *ht, uint32_t hash,
+	    SWISS_DATA_TYPE value)
+{
+	return SWISS(find_impl)(&ht->common, hash, value);
+}
+
+static inline uint32_t
+SWISS(view_find)(const struct SWISS(view) *v, uint32_t hash,
+		 SWISS_DATA_TYPE value)
+{
+	return SWISS(find_impl)(&v->common, hash, value);
+}
+
+/**
+ * Find a record with given hash and key in the current or the old
+ * storage, see SWISS(find_in).
+ */
+static inline uint32_t
+SWISS(find_key_in)(const struct SWISS(common) *ht, bool is_old,
+		   uint32_t hash, SWISS_KEY_TYPE key)
+{
+	uint32_t group_count = is_old ? ht->old_group_count : ht->group_count;
+	uint32_t moved_count = is_old ? ht->rehash_pos : 0;
+	uint8_t ctrl_byte = swiss_ctrl_hash(hash);
+	uint32_t group_id = SWISS(probe_start)(group_count, hash);
+	for (uint32_t step = 1; ; step++) {
+		assert(step <= group_count);
+		struct SWISS(group) *group =
+			SWISS(get_group)(ht, is_old, group_id);
+		uint32_t mask = group_id >= moved_count ?
+				swiss_group_match(group->ctrl, ctrl_byte) : 0;
+		while (mask != 0) {
+			uint32_t i = __builtin_ctz(mask);
+			if (group->hash[i] == hash &&
+			    SWISS_EQUAL_KEY((group->value[i]), (key),
+					    (ht->arg)))
+				return group_id * SWISS_GROUP_SIZE + i;
+			mask &= mask - 1;
+		}
+		if (swiss_group_match_empty(group->ctrl) != 0)
+			return SWISS(end);
+		group_id = SWISS(probe_next)(group_count, group_id, step);
+	}
+}
+
+/**
+ * @brief Find a record with given hash and key
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param data - key to find
+ * @return integer ID of found record or swiss_end if nothing found
+ */
+static inline uint32_t
+SWISS(find_key_impl)(const struct SWISS(common) *ht, uint32_t hash,
+		     SWISS_KEY_TYPE key)
+{
+	if (ht->count == 0)
+		return SWISS(end);
+	uint32_t slot = SWISS(find_key_in)(ht, false, hash, key);
+	if (slot != SWISS(end) || ht->old_storage == NULL)
+		return slot;
+	slot = SWISS(find_key_in)(ht, true, hash, key);
+	if (slot == SWISS(end))
+		return slot;
+	return SWISS(capacity)(ht) + slot;
+}
+
+static inline uint32_t
+SWISS(find_key)(const struct SWISS(core) *ht, uint32_t hash,
+		SWISS_KEY_TYPE key)
+{
+	return SWISS(find_key_impl)(&ht->common, hash, key);
+}
+
+static inline uint32_t
+SWISS(view_find_key)(const struct SWISS(view) *v, uint32_t hash,
+		     SWISS_KEY_TYPE key)
+{
+	return SWISS(find_key_impl)(&v->common, hash, key);
+}
+
+/**
+ * Find a slot of the current storage for a new value with the given
+ * hash: the first empty or deleted slot in the probe sequence.
+ */
+static inline uint32_t
+SWISS(find_free_slot)(const struct SWISS(common) *ht, uint32_t hash)
+{
+	uint32_t group_id = SWISS(probe_start)(ht->group_count, hash);
+	for (uint32_t step = 1; ; step++) {
+		assert(step <= ht->group_count);
+		struct SWISS(group) *group =
+			SWISS(get_group)(ht, false, group_id);
+		uint32_t mask = swiss_group_match_free(group->ctrl);
+		if (mask != 0)
+			return group_id * SWISS_GROUP_SIZE + __builtin_ctz(mask);
+		group_id = SWISS(probe_next)(ht->group_count, group_id, step);
+	}
+}
+
+/** Returns true if the hash table is being rehashed. */
+static inline bool
+SWISS(is_rehashing)(const struct SWISS(core) *htab)
+{
+	return htab->new_storage != NULL || htab->common.old_storage != NULL;
+}
+
+/**
+ * Start rehashing the table into a new storage with the given number
+ * of groups. The table must not be being rehashed.
+ * Returns 0 on success, -1 on memory allocation error.
+ */
+static inline int
+SWISS(rehash_start)(struct SWISS(core) *htab, uint32_t group_count)
+{
+	assert(!SWISS(is_rehashing)(htab));
+	assert((group_count & (group_count - 1)) == 0);
+	assert(group_count * SWISS_GROUP_SIZE / 8 * 7 >= htab->common.count);
+	struct SWISS(storage) *storage =
+		(struct SWISS(storage) *)malloc(sizeof(*storage));
+	if (storage == NULL)
+		return -1;
+	storage->refs = 1;
+	matras_create(&storage->mtable, htab->extent_size,
+		      SWISS(block_size)(), htab->extent_alloc_func,
+		      htab->extent_free_func, htab->alloc_ctx,
+		      htab->alloc_stats);
+	htab->new_storage = storage;
+	htab->new_group_count = group_count;
+	htab->new_alloc_count = 0;
+	return 0;
+}
+
+/**
+ * Allocate up to @a step groups of the new storage. Once all of them
+ * are allocated, make it the current storage and start moving values
+ * from the previous one.
+ * Returns 0 on success, -1 on memory allocation error.
+ */
+static inline int
+SWISS(rehash_alloc_groups)(struct SWISS(core) *htab, uint32_t step)
+{
+	struct SWISS(common) *ht = &htab->common;
+	struct SWISS(storage) *storage = htab->new_storage;
+	for (; step > 0 && htab->new_alloc_count < htab->new_group_count;
+	     step--) {
+		uint32_t id;
+		struct SWISS(group) *group = (struct SWISS(group) *)
+			matras_alloc(&storage->mtable, &id);
+		if (group == NULL)
+			return -1;
+		assert(id == htab->new_alloc_count);
+		memset(group->ctrl, SWISS_CTRL_EMPTY, sizeof(group->ctrl));
+		htab->new_alloc_count++;
+	}
+	if (htab->new_alloc_count < htab->new_group_count)
+		return 0;
+	assert(ht->old_storage == NULL);
+	if (ht->storage != NULL) {
+		ht->old_storage = ht->storage;
+		ht->old_group_count = ht->group_count;
+		ht->rehash_pos = 0;
+	}
+	ht->storage = storage;
+	ht->group_count = htab->new_group_count;
+	htab->new_storage = NULL;
+	htab->new_group_count = 0;
+	htab->new_alloc_count = 0;
+	/* Free slots are reserved for all values of the old storage. */
+	htab->growth_left = ht->group_count * SWISS_GROUP_SIZE / 8 * 7 -
+			    ht->count;
+	htab->deleted_count = 0;
+	return 0;
+}
+
+/**
+ * Move all values of the next group of the old storage to the current
+ * storage. Full hashes are stored in groups so values aren't compared
+ * or dereferenced. The old storage isn't modified. Once all its groups
+ * are moved, it's released; it's freed unless it's used by a read view.
+ * Returns 0 on success, -1 on memory allocation error, in which case
+ * the group is left in the old storage.
+ */
+static inline int
+SWISS(rehash_move_group)(struct SWISS(core) *htab)
+{
+	struct SWISS(common) *ht = &htab->common;
+	assert(ht->rehash_pos < ht->old_group_count);
+	struct SWISS(group) *src = SWISS(get_group)(ht, true, ht->rehash_pos);
+	/* Slots taken in the current storage and their old control bytes. */
+	uint32_t moved[SWISS_GROUP_SIZE];
+	uint8_t moved_ctrl[SWISS_GROUP_SIZE];
+	uint32_t moved_count = 0;
+	uint32_t mask = swiss_group_match_full(src->ctrl);
+	while (mask != 0) {
+		uint32_t j = __builtin_ctz(mask);
+		uint32_t hash = src->hash[j];
+		uint32_t slot = SWISS(find_free_slot)(ht, hash);
+		struct SWISS(group) *dst =
+			SWISS(touch_group)(ht, false, swiss_slot_group(slot));
+		if (dst == NULL)
+			goto rollback;
+		uint32_t pos = swiss_slot_pos(slot);
+		moved[moved_count] = slot;
+		moved_ctrl[moved_count] = dst->ctrl[pos];
+		moved_count++;
+		/* Free slots are reserved for moved values in advance. */
+		if (dst->ctrl[pos] == SWISS_CTRL_DELETED) {
+			assert(htab->deleted_count > 0);
+			htab->deleted_count--;
+		}
+		dst->ctrl[pos] = src->ctrl[j];
+		dst->hash[pos] = hash;
+		dst->value[pos] = src->value[j];
+		mask &= mask - 1;
+	}
+	if (++ht->rehash_pos == ht->old_group_count) {
+		SWISS(storage_unref)(ht->old_storage);
+		ht->old_storage = NULL;
+		ht->old_group_count = 0;
+		ht->rehash_pos = 0;
+	}
+	return 0;
+rollback:
+	/* The groups are already touched so it can't fail. */
+	while (moved_count > 0) {
+		moved_count--;
+		uint32_t slot = moved[moved_count];
+		struct SWISS(group) *dst =
+			SWISS(touch_group)(ht, false, swiss_slot_group(slot));
+		assert(dst != NULL);
+		dst->ctrl[swiss_slot_pos(slot)] = moved_ctrl[moved_count];
+		if (moved_ctrl[moved_count] == SWISS_CTRL_DELETED)
+			htab->deleted_count++;
+	}
+	return -1;
+}
+
+/**
+ * Do a step of the rehash: allocate or move up to @a step groups.
+ * Returns 0 on success, -1 on memory allocation error.
+ */
+static inline int
+SWISS(rehash_step)(struct SWISS(core) *htab, uint32_t step)
+{
+	assert(SWISS(is_rehashing)(htab));
+	if (htab->new_storage != NULL)
+		return SWISS(rehash_alloc_groups)(htab, step);
+	for (; step > 0 && htab->common.old_storage != NULL; step--) {
+		if (SWISS(rehash_move_group)(htab) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Complete the rehash in progress, if any.
+ * Returns 0 on success, -1 on memory allocation error.
+ */
+static inline int
+SWISS(rehash_finish)(struct SWISS(core) *htab)
+{
+	while (SWISS(is_rehashing)(htab)) {
+		if (SWISS(rehash_step)(htab, UINT32_MAX) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Number of groups of the storage to rehash the table to in order to
+ * make room for more values: twice as many groups unless tombstones
+ * take most of the slots, in which case the size stays the same.
+ * Returns 0 if the table can't grow anymore.
+ */
+static inline uint32_t
+SWISS(grow_group_count)(const struct SWISS(core) *htab)
+{
+	const struct SWISS(common) *ht = &htab->common;
+	uint32_t group_count = ht->group_count;
+	if (group_count == 0)
+		group_count = 1;
+	else if (ht->count >= SWISS(capacity)(ht) / 16 * 7)
+		group_count *= 2;
+	/* Slots of both storages must fit in a slot ID. */
+	if (group_count > SWISS(end) / SWISS_GROUP_SIZE / 2)
+		return 0;
+	return group_count;
+}
+
+/**
+ * Make room for one more value when the table runs out of free slots:
+ * complete the rehash in progress or rehash the table right away.
+ * Normally, the table is rehashed in steps before it happens.
+ * Returns 0 on success, -1 on memory allocation error.
+ */
+static inline int
+SWISS(grow)(struct SWISS(core) *htab)
+{
+	if (SWISS(rehash_finish)(htab) != 0)
+		return -1;
+	if (htab->growth_left > 0)
+		return 0;
+	uint32_t group_count = SWISS(grow_group_count)(htab);
+	if (group_count == 0)
+		return -1;
+	if (SWISS(rehash_start)(htab, group_count) != 0)
+		return -1;
+	return SWISS(rehash_finish)(htab);
+}
+
+/**
+ * @brief Reserve space for the given number of values so that they can
+ * be inserted without rehashing. Completes the rehash in progress and
+ * rehashes the table right away if needed.
+ * @param ht - pointer to a hash table struct
+ * @param count - expected number of values
+ * @return 0 if ok, -1 on memory error
+ */
+static inline int
+SWISS(reserve)(struct SWISS(core) *htab, uint32_t count)
+{
+	struct SWISS(common) *ht = &htab->common;
+	if (SWISS(rehash_finish)(htab) != 0)
+		return -1;
+	if (count <= ht->count + htab->growth_left)
+		return 0;
+	uint32_t group_count = ht->group_count > 0 ? ht->group_count : 1;
+	while (group_count * SWISS_GROUP_SIZE / 8 * 7 < count) {
+		if (group_count > SWISS(end) / SWISS_GROUP_SIZE / 4)
+			return -1;
+		group_count *= 2;
+	}
+	if (SWISS(rehash_start)(htab, group_count) != 0)
+		return -1;
+	return SWISS(rehash_finish)(htab);
+}
+
+/**
+ * @brief Insert a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to insert
+ * @param data - value to insert
+ * @return integer ID of inserted record or swiss_end if failed
+ */
+static inline uint32_t
+SWISS(insert)(struct SWISS(core) *htab, uint32_t hash, SWISS_DATA_TYPE value)
+{
+	struct SWISS(common) *ht = &htab->common;
+	/*
+	 * Start rehashing when the number of free slots drops to the
+	 * number of groups, which leaves enough insertions to allocate
+	 * a storage twice as large and move the values to it in steps.
+	 * The steps are best-effort: memory errors are ignored until
+	 * the table runs out of free slots.
+	 */
+	if (!SWISS(is_rehashing)(htab) && ht->group_count > 0 &&
+	    htab->growth_left <= ht->group_count) {
+		uint32_t group_count = SWISS(grow_group_count)(htab);
+		if (group_count != 0)
+			(void)SWISS(rehash_start)(htab, group_count);
+	}
+	if (SWISS(is_rehashing)(htab))
+		(void)SWISS(rehash_step)(htab, SWISS_REHASH_STEP);
+	uint32_t slot = SWISS(end);
+	struct SWISS(group) *group = NULL;
+	if (ht->group_count > 0) {
+		slot = SWISS(find_free_slot)(ht, hash);
+		group = SWISS(get_group)(ht, false, swiss_slot_group(slot));
+	}
+	if (slot == SWISS(end) ||
+	    (group->ctrl[swiss_slot_pos(slot)] == SWISS_CTRL_EMPTY &&
+	     htab->growth_left == 0)) {
+		if (SWISS(grow)(htab) != 0)
+			return SWISS(end);
+		slot = SWISS(find_free_slot)(ht, hash);
+	}
+	group = SWISS(touch_group)(ht, false, swiss_slot_group(slot));
+	if (group == NULL)
+		return SWISS(end);
+	uint32_t pos = swiss_slot_pos(slot);
+	if (group->ctrl[pos] == SWISS_CTRL_EMPTY) {
+		assert(htab->growth_left > 0);
+		htab->growth_left--;
+	} else {
+		assert(group->ctrl[pos] == SWISS_CTRL_DELETED);
+		assert(htab->deleted_count > 0);
+		htab->deleted_count--;
+	}
+	group->ctrl[pos] = swiss_ctrl_hash(hash);
+	group->hash[pos] = hash;
+	group->value[pos] = value;
+	ht->count++;
+	return slot;
+}
+
+/**
+ * Get a group storing the given slot for update, see SWISS(touch_group).
+ * Sets @a pos to the position of the slot in the group.
+ */
+static inline struct SWISS(group) *
+SWISS(touch_slot_group)(struct SWISS(common) *ht, uint32_t slot,
+			uint32_t *pos)
+{
+	uint32_t capacity = SWISS(capacity)(ht);
+	*pos = swiss_slot_pos(slot);
+	if (slot < capacity)
+		return SWISS(touch_group)(ht, false, swiss_slot_group(slot));
+	return SWISS(touch_group)(ht, true,
+				  swiss_slot_group(slot - capacity));
+}
+
+/**
+ * @brief Replace a record with given hash and value
+ * @param ht - pointer to a hash table struct
+ * @param hash - hash to find
+ * @param data - value to find and replace
+ * @param replaced - pointer to a value that was stored in table before replace
+ * @return integer ID of found record or swiss_end if nothing found
+ */
+static inline uint32_t
+SWISS(replace)(struct SWISS(core) *htab, uint32_t hash,
+	       SWISS_DATA_TYPE value, SWISS_DATA_TYPE *replaced)
+{
+	struct SWISS(common) *ht = &htab->common;
+	uint32_t slot = SWISS(find_impl)(ht, hash, value);
+	if (slot == SWISS(end))
+		return SWISS(end);
+	uint32_t pos;
+	struct SWISS(group) *group = SWISS(touch_slot_group)(ht, slot, &pos);
+	if (group == NULL)
+		return SWISS(end);
+	*replaced = group->value[pos];
+	group->value[pos] = value;
+	return slot;
+}
+
+/**
+ * @brief Delete a record from a hash table by given record ID
+ * @param ht - pointer to a hash table struct
+ * @param slotpos - ID of an record. See SWISS(find) for details.
+ * @return 0 if ok, -1 on memory error (only with read views)
+ */
+static inline int
+SWISS(delete)(struct SWISS(core) *htab, uint32_t slot)
+{
+	struct SWISS(common) *ht = &htab->common;
+	assert(slot < SWISS(slot_count)(ht));
+	uint32_t pos;
+	struct SWISS(group) *group = SWISS(touch_slot_group)(ht, slot, &pos);
+	if (group == NULL)
+		return -1;
+	assert(group->ctrl[pos] < SWISS_CTRL_EMPTY);
+	if (slot >= SWISS(capacity)(ht)) {
+		/*
+		 * Nothing is inserted to the old storage so a tombstone
+		 * is never reused. The slot reserved for the value in
+		 * the current storage is freed.
+		 */
+		assert(swiss_slot_group(slot - SWISS(capacity)(ht)) >=
+		       ht->rehash_pos);
+		group->ctrl[pos] = SWISS_CTRL_DELETED;
+		htab->growth_left++;
+	} else if (swiss_group_match_empty(group->ctrl) != 0) {
+		/*
+		 * A group that has an empty slot has never been full so
+		 * no probe sequence goes past it and the slot may be
+		 * marked empty. Otherwise a lookup must continue past
+		 * the slot.
+		 */
+		group->ctrl[pos] = SWISS_CTRL_EMPTY;
+		htab->growth_left++;
+	} else {
+		group->ctrl[pos] = SWISS_CTRL_DELETED;
+		htab->deleted_count++;
+	}
+	ht->count--;
+	return 0;
+}
+
+/**
+ * @brief Delete a record from a hash table by that value and its hash.
+ * @param ht - pointer to a hash table struct
+ * @param slotpos - ID of an record. See SWISS(find) for details.
+ * @return 0 if ok, 1 if not found or -1 on memory error
+ * (only with read views)
+ */
+static inline int
+SWISS(delete_value)(struct SWISS(core) *htab, uint32_t hash,
+		    SWISS_DATA_TYPE value)
+{
+	uint32_t slot = SWISS(find_impl)(&htab->common, hash, value);
+	if (slot == SWISS(end))
+		return 1; /* not found */
+	return SWISS(delete)(htab, slot);
+}
+
+/**
+ * @brief Get a value from a desired position
+ * @param ht - pointer to a hash table struct
+ * @param slotpos - ID of an record
+ */
+static inline SWISS_DATA_TYPE
+SWISS(get_impl)(const struct SWISS(common) *ht, uint32_t slotpos)
+{
+	assert(slotpos < SWISS(slot_count)(ht));
+	struct SWISS(group) *group = SWISS(get_slot_group)(ht, slotpos);
+	uint32_t pos = swiss_slot_pos(slotpos);
+	assert(group->ctrl[pos] < SWISS_CTRL_EMPTY);
+	return group->value[pos];
+}
+
+static inline SWISS_DATA_TYPE
+SWISS(get)(struct SWISS(core) *ht, uint32_t slotpos)
+{
+	return SWISS(get_impl)(&ht->common, slotpos);
+}
+
+static inline SWISS_DATA_TYPE
+SWISS(view_get)(struct SWISS(view) *v, uint32_t slotpos)
+{
+	return SWISS(get_impl)(&v->common, slotpos);
+}
+
+/**
+ * Find the first slot storing a value starting from the given one.
+ * Returns swiss_end if there's no such slot.
+ */
+static inline uint32_t
+SWISS(next_slot)(const struct SWISS(common) *ht, uint32_t slot)
+{
+	uint32_t capacity = SWISS(capacity)(ht);
+	uint32_t moved_end = capacity + ht->rehash_pos * SWISS_GROUP_SIZE;
+	uint32_t slot_count = SWISS(slot_count)(ht);
+	while (slot < slot_count) {
+		if (slot >= capacity && slot < moved_end) {
+			/* The values were moved to the current storage. */
+			slot = moved_end;
+			continue;
+		}
+		struct SWISS(group) *group = SWISS(get_slot_group)(ht, slot);
+		uint32_t mask = swiss_group_match_full(group->ctrl);
+		mask &= ~((1u << swiss_slot_pos(slot)) - 1);
+		uint32_t group_start = slot - swiss_slot_pos(slot);
+		if (mask != 0)
+			return group_start + __builtin_ctz(mask);
+		slot = group_start + SWISS_GROUP_SIZE;
+	}
+	return SWISS(end);
+}
+
+/**
+ * @brief Get a random record
+ * @param htab - pointer to a hash table struct
+ * @param rnd - some random value
+ * @return integer ID of random record or swiss_end if table is empty
+ */
+static inline uint32_t
+SWISS(random)(const struct SWISS(core) *htab, uint32_t rnd)
+{
+	const struct SWISS(common) *ht = &htab->common;
+	if (ht->count == 0)
+		return SWISS(end);
+	uint32_t slot = SWISS(next_slot)(ht, rnd % SWISS(slot_count)(ht));
+	if (slot == SWISS(end))
+		slot = SWISS(next_slot)(ht, 0);
+	assert(slot != SWISS(end));
+	return slot;
+}
+
+/**
+ * @brief Set iterator to the beginning of hash table
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ */
+static inline void
+SWISS(iterator_begin)(const struct SWISS(core) *ht,
+		      struct SWISS(iterator) *itr)
+{
+	(void)ht;
+	itr->slotpos = 0;
+}
+
+static inline void
+SWISS(view_iterator_begin)(const struct SWISS(view) *v,
+			   struct SWISS(iterator) *itr)
+{
+	(void)v;
+	itr->slotpos = 0;
+}
+
+/**
+ * @brief Set iterator to position determined by key
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @param hash - hash to find
+ * @param data - key to find
+ */
+static inline void
+SWISS(iterator_key)(const struct SWISS(core) *ht, struct SWISS(iterator) *itr,
+		    uint32_t hash, SWISS_KEY_TYPE data)
+{
+	itr->slotpos = SWISS(find_key_impl)(&ht->common, hash, data);
+}
+
+static inline void
+SWISS(view_iterator_key)(const struct SWISS(view) *v,
+			 struct SWISS(iterator) *itr, uint32_t hash,
+			 SWISS_KEY_TYPE data)
+{
+	itr->slotpos = SWISS(find_key_impl)(&v->common, hash, data);
+}
+
+/**
+ * @brief Get the value that iterator currently points to
+ * @param ht - pointer to a hash table struct
+ * @param itr - iterator to set
+ * @return poiner to the value or NULL if iteration is complete
+ */
+static inline SWISS_DATA_TYPE *
+SWISS(iterator_get_and_next_impl)(const struct SWISS(common) *ht,
+				  struct SWISS(iterator) *itr)
+{
+	uint32_t slot = SWISS(next_slot)(ht, itr->slotpos);
+	if (slot == SWISS(end)) {
+		itr->slotpos = SWISS(end);
+		return NULL;
+	}
+	itr->slotpos = slot + 1;
+	return &SWISS(get_slot_group)(ht, slot)->value[swiss_slot_pos(slot)];
+}
+
+static inline SWISS_DATA_TYPE *
+SWISS(iterator_get_and_next)(const struct SWISS(core) *ht,
+			     struct SWISS(iterator) *itr)
+{
+	return SWISS(iterator_get_and_next_impl)(&ht->common, itr);
+}
+
+static inline SWISS_DATA_TYPE *
+SWISS(view_iterator_get_and_next)(const struct SWISS(view) *v,
+				  struct SWISS(iterator) *itr)
+{
+	return SWISS(iterator_get_and_next_impl)(&v->common, itr);
+}
+
+/*
+ * Selfcheck of the internal state of hash table. Used only for debugging.
+ * That means that you should not use this function.
+ * If return not zero, something went terribly wrong.
+ */
+static inline int
+SWISS(selfcheck)(const struct SWISS(core) *htab)
+{
+	const struct SWISS(common) *ht = &htab->common;
+	int res = 0;
+	if (ht->group_count == 0)
+		return ht->count == 0 && ht->old_storage == NULL ? 0 : 1;
+	if ((ht->group_count & (ht->group_count - 1)) != 0 ||
+	    (ht->old_group_count & (ht->old_group_count - 1)) != 0)
+		res |= 2; /* group count isn't a power of two */
+	uint32_t count = 0;
+	uint32_t old_count = 0;
+	uint32_t empty_count = 0;
+	uint32_t deleted_count = 0;
+	for (int is_old = 0; is_old <= 1; is_old++) {
+		uint32_t group_count = is_old ? ht->old_group_count :
+				       ht->group_count;
+		uint32_t moved_count = is_old ? ht->rehash_pos : 0;
+		for (uint32_t i = moved_count; i < group_count; i++) {
+			struct SWISS(group) *group =
+				SWISS(get_group)(ht, is_old, i);
+			for (uint32_t j = 0; j < SWISS_GROUP_SIZE; j++) {
+				uint8_t ctrl = group->ctrl[j];
+				if (ctrl == SWISS_CTRL_EMPTY) {
+					if (!is_old)
+						empty_count++;
+					continue;
+				}
+				if (ctrl == SWISS_CTRL_DELETED) {
+					if (!is_old)
+						deleted_count++;
+					continue;
+				}
+				count++;
+				if (is_old)
+					old_count++;
+				if (ctrl != swiss_ctrl_hash(group->hash[j]))
+					res |= 4; /* wrong control byte */
+				/* Check that the value is reachable. */
+				uint32_t hash = group->hash[j];
+				uint32_t group_id =
+					SWISS(probe_start)(group_count, hash);
+				for (uint32_t step = 1; group_id != i; step++) {
+					struct SWISS(group) *g =
+						SWISS(get_group)(ht, is_old,
+								 group_id);
+					if (swiss_group_match_empty(g->ctrl)) {
+						res |= 8; /* unreachable */
+						break;
+					}
+					group_id = SWISS(probe_next)(
+						group_count, group_id, step);
+				}
+			}
+		}
+	}
+	if (count != ht->count)
+		res |= 16;
+	if (deleted_count != htab->deleted_count)
+		res |= 32;
+	/* Free slots are reserved for values of the old storage. */
+	if (empty_count < htab->growth_left + old_count)
+		res |= 64;
+	if (empty_count == 0)
+		res |= 128;
+	return res;
+}
+
+#undef SWISS
@@ -912,6 +912,82 @@ lbox_fiber_set_joinable(struct lua_State *L)
 	return 0;
 }
 
+/**
+ * Get the scheduling priority class of a fiber or set it if
+ * the class name is passed.
+ */
+static int
+lbox_fiber_priority(struct lua_State *L)
+{
+	if (lua_gettop(L) != 1 && lua_gettop(L) != 2) {
+		diag_set(IllegalParams,
+			 "fiber.priority(id[, priority]): bad arguments");
+		luaT_error(L);
+	}
+	struct fiber *fiber = lbox_checkfiber(L, 1);
+	if (lua_gettop(L) == 1) {
+		lua_pushstring(L, fiber_prio_strs[fiber->prio]);
+		return 1;
+	}
+	const char *name = lua_tostring(L, 2);
+	enum fiber_prio prio = name == NULL ? fiber_prio_MAX :
+			       STR2ENUM(fiber_prio, name);
+	if (prio == fiber_prio_MAX) {
+		diag_set(IllegalParams, "fiber.priority(): priority must be "
+			 "'high', 'normal' or 'low'");
+		luaT_error(L);
+	}
+	fiber_set_prio(fiber, prio);
+	return 0;
+}
+
+/**
+ * Set the scheduling deadline of a fiber to the given timeout
+ * from now or drop it if the timeout is nil.
+ */
+static int
+lbox_fiber_set_deadline(struct lua_State *L)
+{
+	if (lua_gettop(L) != 2 ||
+	    (!lua_isnil(L, 2) && lua_type(L, 2) != LUA_TNUMBER)) {
+		diag_set(IllegalParams,
+			 "fiber.set_deadline(id, timeout): bad arguments");
+		luaT_error(L);
+	}
+	struct fiber *fiber = lbox_checkfiber(L, 1);
+	double deadline = TIMEOUT_INFINITY;
+	if (!lua_isnil(L, 2))
+		deadline = ev_monotonic_now(loop()) + lua_tonumber(L, 2);
+	fiber_set_deadline(fiber, deadline);
+	return 0;
+}
+
+/**
+ * Push scheduling statistics of the current cord by fiber
+ * priority class. Delays are in seconds.
+ */
+static int
+lbox_fiber_sched_stat(struct lua_State *L)
+{
+	lua_newtable(L);
+	for (int i = 0; i < fiber_prio_MAX; i++) {
+		struct fiber_sched_stat *stat = &cord()->sched_stat[i];
+		lua_pushstring(L, fiber_prio_strs[i]);
+		lua_newtable(L);
+		lua_pushliteral(L, "count");
+		luaL_pushuint64(L, stat->count);
+		lua_settable(L, -3);
+		lua_pushliteral(L, "delay");
+		lua_pushnumber(L, stat->delay_total / (double)FIBER_TIME_RES);
+		lua_settable(L, -3);
+		lua_pushliteral(L, "delay_max");
+		lua_pushnumber(L, stat->delay_max / (double)FIBER_TIME_RES);
+		lua_settable(L, -3);
+		lua_settable(L, -3);
+	}
+	return 1;
+}
+
 /**
  * Alternative to fiber.sleep(infinite) which does not participate
  * in an event loop at all until an explicit wakeup. This is less
@@ -1062,6 +1138,8 @@ static const struct luaL_Reg lbox_fiber_meta [] = {
 	{"join", lbox_fiber_join},
 	{"set_joinable", lbox_fiber_set_joinable},
 	{"set_max_slice", lbox_fiber_set_max_slice},
+	{"priority", lbox_fiber_priority},
+	{"set_deadline", lbox_fiber_set_deadline},
 	{"wakeup", lbox_fiber_wakeup},
 	{"__index", lbox_fiber_index},
 	{NULL, NULL}
@@ -1072,6 +1150,7 @@ static const struct luaL_Reg fiberlib[] = {
 	{"top", lbox_fiber_top},
 	{"top_enable", lbox_fiber_top_enable},
 	{"top_disable", lbox_fiber_top_disable},
+	{"sched_stat", lbox_fiber_sched_stat},
 #ifdef ENABLE_BACKTRACE
 	{"parent_backtrace_enable", lbox_fiber_parent_backtrace_enable},
 	{"parent_backtrace_disable", lbox_fiber_parent_backtrace_disable},
@@ -15,11 +15,22 @@ ffi.cdef[[
     say_check_cfg(const char *log,
                   int level,
                   int nonblock,
-                  const char *format);
+                  const char *format,
+                  bool async,
+                  const char *async_policy);
 
     extern void
     say_logger_init(const char *init_str, int level, int nonblock,
-                    const char *format);
+                    const char *format, const char *async_policy);
+
+    struct say_async_stat {
+        uint64_t queued;
+        uint64_t written;
+        uint64_t dropped;
+    };
+
+    void
+    say_async_stat(struct say_async_stat *stat);
 
     extern bool
     say_logger_initialized(void);
@@ -126,6 +137,8 @@ local default_cfg = {
     level           = S_INFO,
     modules         = nil,
     format          = fmt_num2str[ffi.C.SF_PLAIN],
+    async           = false,
+    async_policy    = 'drop',
 }
 
 local log_cfg = table.copy(default_cfg)
@@ -139,6 +152,8 @@ local log2box_keys = {
     ['level']           = 'log_level',
     ['modules']         = 'log_modules',
     ['format']          = 'log_format',
+    ['async']           = 'log_async',
+    ['async_policy']    = 'log_async_policy',
 }
 
 -- Return level as a number, level must be valid.
@@ -327,6 +342,8 @@ local option_types = {
     level = 'number, string',
     modules = 'table',
     format = 'string',
+    async = 'boolean',
+    async_policy = 'string',
 }
 
 local log_initialized = false
@@ -343,6 +360,8 @@ local function log_C_cfg(cfg)
         nonblock = -1
     end
     cfg_C.nonblock = nonblock
+    -- NULL policy means the logger is synchronous.
+    cfg_C.async_policy = cfg.async and cfg.async_policy or nil
     return cfg_C
 end
 
@@ -390,11 +409,18 @@ local function log_check_cfg(cfg)
         if log_cfg.nonblock ~= cfg.nonblock then
             box.error(box.error.RELOAD_CFG, 'log_nonblock');
         end
+        if log_cfg.async ~= cfg.async then
+            box.error(box.error.RELOAD_CFG, 'log_async');
+        end
+        if log_cfg.async_policy ~= cfg.async_policy then
+            box.error(box.error.RELOAD_CFG, 'log_async_policy');
+        end
     end
 
     local cfg_C = log_C_cfg(cfg)
     if ffi.C.say_check_cfg(cfg_C.log, cfg_C.level,
-                           cfg_C.nonblock, cfg_C.format) ~= 0 then
+                           cfg_C.nonblock, cfg_C.format,
+                           cfg.async, cfg.async_policy) ~= 0 then
         box.error()
     end
 end
@@ -451,7 +477,7 @@ local function log_configure(self, cfg, box_api)
     log_check_cfg(cfg)
     local cfg_C = log_C_cfg(cfg)
     ffi.C.say_logger_init(cfg_C.log, cfg_C.level,
-                          cfg_C.nonblock, cfg_C.format)
+                          cfg_C.nonblock, cfg_C.format, cfg_C.async_policy)
     log_initialized = true
 
     for o in pairs(option_types) do
@@ -460,8 +486,20 @@ local function log_configure(self, cfg, box_api)
 
     box_cfg_update()
 
-    log_debug("log.cfg({log=%s, level=%s, nonblock=%s, format=%s})",
-              cfg.log, cfg.level, cfg.nonblock, cfg.format)
+    log_debug("log.cfg({log=%s, level=%s, nonblock=%s, format=%s, " ..
+              "async=%s, async_policy=%s})", cfg.log, cfg.level,
+              cfg.nonblock, cfg.format, cfg.async, cfg.async_policy)
+end
+
+-- Statistics of the asynchronous logger.
+local function log_stat()
+    local stat = ffi.new('struct say_async_stat')
+    ffi.C.say_async_stat(stat)
+    return {
+        queued = tonumber(stat.queued),
+        written = tonumber(stat.written),
+        dropped = tonumber(stat.dropped),
+    }
 end
 
 local compat_warning_said = false
@@ -514,6 +552,7 @@ log_main = {
     pid = log_pid,
     level = set_log_level,
     log_format = set_log_format,
+    stat = log_stat,
     cfg = setmetatable(log_cfg, {
         __call = function(self, cfg) log_configure(self, cfg, false) end,
     }),
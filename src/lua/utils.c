@@ -529,13 +529,6 @@ luaL_tointeger_strict(struct lua_State *L, int idx, int *value)
 	return true;
 }
 
-/*
- * Maximum integer that doesn't lose precision on tostring() conversion.
- * Lua uses sprintf("%.14g") to format its numbers, see gh-1279.
- */
-#define DBL_INT_MAX (1e14 - 1)
-#define DBL_INT_MIN (-1e14 + 1)
-
 void
 luaL_pushuint64(struct lua_State *L, uint64_t val)
 {
@@ -375,6 +375,13 @@ luaL_tolstring_strict(struct lua_State *L, int idx, size_t *len_ptr);
 bool
 luaL_tointeger_strict(struct lua_State *L, int idx, int *value);
 
+/*
+ * Maximum integer that doesn't lose precision on tostring() conversion.
+ * Lua uses sprintf("%.14g") to format its numbers, see gh-1279.
+ */
+#define DBL_INT_MAX (1e14 - 1)
+#define DBL_INT_MIN (-1e14 + 1)
+
 /** \cond public */
 
 /**
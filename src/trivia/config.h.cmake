@@ -290,7 +290,6 @@
 #cmakedefine ENABLE_FEEDBACK_DAEMON 1
 #cmakedefine ENABLE_WAL_EXT 1
 #cmakedefine ENABLE_RETENTION_PERIOD 1
-#cmakedefine ENABLE_READ_VIEW 1
 #cmakedefine ENABLE_SECURITY 1
 #cmakedefine ENABLE_MEMCS_ENGINE 1
 #cmakedefine ENABLE_COMPRESS_MODULE 1
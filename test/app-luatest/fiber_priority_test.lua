@@ -0,0 +1,88 @@
+local fiber = require('fiber')
+local t = require('luatest')
+
+local g = t.group()
+
+g.after_each(function()
+    fiber.top_disable()
+end)
+
+g.test_priority_order = function()
+    local order = {}
+    local fibers = {}
+    local function worker(name)
+        fiber.stall()
+        table.insert(order, name)
+    end
+    -- Name, priority class, deadline timeout.
+    local specs = {
+        {'low1', 'low'},
+        {'normal1', 'normal'},
+        {'high1', 'high'},
+        {'low2', 'low', 10},
+        {'normal2', 'normal'},
+        {'high2', 'high', 20},
+        {'high3', 'high', 10},
+        {'normal3', 'normal', 5},
+    }
+    for _, spec in ipairs(specs) do
+        local f = fiber.new(worker, spec[1])
+        f:set_joinable(true)
+        table.insert(fibers, f)
+    end
+    -- Let the workers stall.
+    fiber.yield()
+    for i, spec in ipairs(specs) do
+        fibers[i]:priority(spec[2])
+        fibers[i]:set_deadline(spec[3])
+        t.assert_equals(fibers[i]:priority(), spec[2])
+    end
+    for _, f in ipairs(fibers) do
+        f:wakeup()
+    end
+    for _, f in ipairs(fibers) do
+        f:join()
+    end
+    t.assert_equals(order, {'high3', 'high2', 'high1', 'normal3',
+                            'normal1', 'normal2', 'low2', 'low1'})
+end
+
+g.test_priority_inheritance = function()
+    local self = fiber.self()
+    t.assert_equals(self:priority(), 'normal')
+    self:priority('low')
+    local f = fiber.new(function() end)
+    t.assert_equals(f:priority(), 'low')
+    self:priority('normal')
+    t.assert_equals(fiber.new(function() end):priority(), 'normal')
+end
+
+g.test_sched_stat = function()
+    local classes = {}
+    for class in pairs(fiber.sched_stat()) do
+        table.insert(classes, class)
+    end
+    t.assert_items_equals(classes, {'high', 'normal', 'low'})
+    fiber.top_enable()
+    local count = fiber.sched_stat().low.count
+    local f = fiber.new(fiber.stall)
+    f:set_joinable(true)
+    fiber.yield()
+    f:priority('low')
+    f:wakeup()
+    f:join()
+    local stat = fiber.sched_stat().low
+    t.assert_ge(stat.count, count + 1)
+    t.assert_ge(stat.delay_max, 0)
+    t.assert_ge(stat.delay, stat.delay_max)
+end
+
+g.test_errors = function()
+    local f = fiber.self()
+    t.assert_error_msg_content_equals(
+        "fiber.priority(): priority must be 'high', 'normal' or 'low'",
+        f.priority, f, 'foo')
+    t.assert_error_msg_content_equals(
+        "fiber.set_deadline(id, timeout): bad arguments",
+        f.set_deadline, f, 'foo')
+end
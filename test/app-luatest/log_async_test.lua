@@ -0,0 +1,58 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new({
+        box_cfg = {log_async = true, log_async_policy = 'block'},
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_log = function(cg)
+    cg.server:exec(function()
+        local log = require('log')
+        t.assert_equals(box.cfg.log_async, true)
+        t.assert_equals(box.cfg.log_async_policy, 'block')
+        for i = 1, 1000 do
+            log.info('async line %d', i)
+        end
+        t.helpers.retrying({}, function()
+            t.assert_equals(log.stat().queued, 0)
+        end)
+        local stat = log.stat()
+        t.assert_ge(stat.written, 1000)
+        t.assert_equals(stat.dropped, 0)
+    end)
+    t.assert(cg.server:grep_log('async line 999'))
+    t.assert(cg.server:grep_log('async line 1000'))
+end
+
+g.test_reload = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "Can't set option 'log_async' dynamically",
+            box.cfg, {log_async = false})
+        t.assert_error_msg_equals(
+            "Can't set option 'log_async_policy' dynamically",
+            box.cfg, {log_async_policy = 'drop'})
+    end)
+end
+
+g.test_invalid_cfg = function()
+    local log = require('log')
+    t.assert_error_msg_equals(
+        "Incorrect value for option 'log_async': " ..
+        "the option is incompatible with syslog/stderr logger",
+        log.cfg, {async = true})
+    t.assert_error_msg_equals(
+        "Incorrect value for option 'log_async_policy': " ..
+        "expected 'block' or 'drop'",
+        log.cfg, {async_policy = 'foo'})
+    t.assert_equals(log.stat(), {queued = 0, written = 0, dropped = 0})
+end
@@ -0,0 +1,166 @@
+#include <lua.h>
+#include <lauxlib.h>
+#include <module.h>
+#include <msgpuck.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "arrow/abi.h"
+
+/** Pushes a value of an Arrow column to the Lua stack. */
+static void
+push_value(struct lua_State *L, const struct ArrowSchema *schema,
+	   const struct ArrowArray *array, int64_t i)
+{
+	const uint8_t *validity = array->buffers[0];
+	if (validity != NULL && (validity[i / 8] & (1 << (i % 8))) == 0) {
+		luaL_pushnull(L);
+		return;
+	}
+	const void *values = array->buffers[1];
+	switch (schema->format[0]) {
+	case 'L':
+		luaL_pushuint64(L, ((const uint64_t *)values)[i]);
+		break;
+	case 'l':
+		luaL_pushint64(L, ((const int64_t *)values)[i]);
+		break;
+	case 'c':
+		lua_pushinteger(L, ((const int8_t *)values)[i]);
+		break;
+	case 'C':
+		lua_pushinteger(L, ((const uint8_t *)values)[i]);
+		break;
+	case 's':
+		lua_pushinteger(L, ((const int16_t *)values)[i]);
+		break;
+	case 'S':
+		lua_pushinteger(L, ((const uint16_t *)values)[i]);
+		break;
+	case 'i':
+		lua_pushinteger(L, ((const int32_t *)values)[i]);
+		break;
+	case 'I':
+		lua_pushinteger(L, ((const uint32_t *)values)[i]);
+		break;
+	case 'g':
+		lua_pushnumber(L, ((const double *)values)[i]);
+		break;
+	case 'f':
+		lua_pushnumber(L, ((const float *)values)[i]);
+		break;
+	case 'b':
+		lua_pushboolean(L, (((const uint8_t *)values)[i / 8] &
+				    (1 << (i % 8))) != 0);
+		break;
+	case 'u':
+	case 'z': {
+		const int32_t *offsets = values;
+		const char *data = array->buffers[2];
+		lua_pushlstring(L, data + offsets[i],
+				offsets[i + 1] - offsets[i]);
+		break;
+	}
+	default:
+		luaL_error(L, "unexpected format '%s'", schema->format);
+	}
+}
+
+/**
+ * read(space_id, index_id, fields, key, batch_row_count) reads
+ * the given zero-based fields of an index with the Arrow stream API
+ * and returns {schema = {{name, format, nullable}...},
+ * batches = {{column1, column2, ...}...}}.
+ */
+static int
+lua_read(struct lua_State *L)
+{
+	uint32_t space_id = luaL_checkinteger(L, 1);
+	uint32_t index_id = luaL_checkinteger(L, 2);
+	luaL_checktype(L, 3, LUA_TTABLE);
+	luaL_checktype(L, 4, LUA_TTABLE);
+	uint32_t batch_row_count = luaL_checkinteger(L, 5);
+	uint32_t fields[16];
+	uint32_t field_count = lua_objlen(L, 3);
+	if (field_count > sizeof(fields) / sizeof(fields[0]))
+		return luaL_error(L, "too many fields");
+	for (uint32_t i = 0; i < field_count; i++) {
+		lua_rawgeti(L, 3, i + 1);
+		fields[i] = lua_tointeger(L, -1);
+		lua_pop(L, 1);
+	}
+	char key[128];
+	uint32_t part_count = lua_objlen(L, 4);
+	if (part_count > 8)
+		return luaL_error(L, "too many key parts");
+	char *key_end = mp_encode_array(key, part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		lua_rawgeti(L, 4, i + 1);
+		key_end = mp_encode_uint(key_end, lua_tointeger(L, -1));
+		lua_pop(L, 1);
+	}
+	box_arrow_options_t *options = box_arrow_options_new();
+	box_arrow_options_set_batch_row_count(options, batch_row_count);
+	struct ArrowArrayStream stream;
+	int rc = box_index_arrow_stream(space_id, index_id, field_count,
+					fields, key, key_end, options, &stream);
+	box_arrow_options_delete(options);
+	if (rc != 0)
+		return luaT_error(L);
+	struct ArrowSchema schema;
+	stream.get_schema(&stream, &schema);
+	lua_newtable(L);
+	lua_newtable(L);
+	for (int64_t i = 0; i < schema.n_children; i++) {
+		struct ArrowSchema *child = schema.children[i];
+		lua_newtable(L);
+		lua_pushstring(L, child->name);
+		lua_rawseti(L, -2, 1);
+		lua_pushstring(L, child->format);
+		lua_rawseti(L, -2, 2);
+		lua_pushboolean(L, (child->flags & ARROW_FLAG_NULLABLE) != 0);
+		lua_rawseti(L, -2, 3);
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_setfield(L, -2, "schema");
+	lua_newtable(L);
+	int batch_count = 0;
+	while (true) {
+		struct ArrowArray array;
+		rc = stream.get_next(&stream, &array);
+		if (rc != 0 || array.release == NULL)
+			break;
+		lua_newtable(L);
+		for (int64_t i = 0; i < array.n_children; i++) {
+			struct ArrowArray *child = array.children[i];
+			lua_newtable(L);
+			for (int64_t j = 0; j < child->length; j++) {
+				push_value(L, schema.children[i], child, j);
+				lua_rawseti(L, -2, j + 1);
+			}
+			lua_rawseti(L, -2, i + 1);
+		}
+		lua_rawseti(L, -2, ++batch_count);
+		array.release(&array);
+	}
+	lua_setfield(L, -2, "batches");
+	schema.release(&schema);
+	if (rc != 0) {
+		lua_pushstring(L, stream.get_last_error(&stream));
+		stream.release(&stream);
+		return lua_error(L);
+	}
+	stream.release(&stream);
+	return 1;
+}
+
+LUA_API int
+luaopen_arrow_stream_lib(struct lua_State *L)
+{
+	static const struct luaL_Reg lib[] = {
+		{"read", lua_read},
+		{NULL, NULL},
+	};
+	luaL_register(L, "arrow_stream_lib", lib);
+	return 1;
+}
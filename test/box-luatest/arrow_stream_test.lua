@@ -0,0 +1,130 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        package.cpath = ('%s/test/box-luatest/?.%s;%s'):format(
+            os.getenv('BUILDDIR'), jit.os == 'OSX' and 'dylib' or 'so',
+            package.cpath)
+        local s = box.schema.space.create('test', {format = {
+            {'id', 'unsigned'},
+            {'grp', 'unsigned'},
+            {'i', 'integer', is_nullable = true},
+            {'d', 'double'},
+            {'b', 'boolean'},
+            {'s', 'string', is_nullable = true},
+            {'i8', 'int8'},
+            {'f32', 'float32'},
+            {'m', 'map', is_nullable = true},
+        }})
+        s:create_index('pk')
+        s:create_index('grp', {parts = {'grp'}, unique = false})
+        local ffi = require('ffi')
+        for i = 1, 10 do
+            s:insert({i, i % 2, i % 3 == 0 and box.NULL or -i,
+                      ffi.cast('double', i / 2), i % 2 == 0,
+                      i % 4 == 0 and box.NULL or 'str' .. i, -i,
+                      ffi.cast('float', i * 2)})
+        end
+        box.schema.space.create('vinyl', {engine = 'vinyl'})
+        box.space.vinyl:create_index('pk')
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_read = function(cg)
+    cg.server:exec(function()
+        local lib = require('arrow_stream_lib')
+        local s = box.space.test
+        local res = lib.read(s.id, 0, {0, 2, 3, 4, 5, 6, 7}, {}, 4)
+        t.assert_equals(res.schema, {
+            {'id', 'L', false},
+            {'i', 'l', true},
+            {'d', 'g', false},
+            {'b', 'b', false},
+            {'s', 'u', true},
+            {'i8', 'c', false},
+            {'f32', 'f', false},
+        })
+        t.assert_equals(#res.batches, 3)
+        local rows = {}
+        for _, batch in ipairs(res.batches) do
+            t.assert_le(#batch[1], 4)
+            for i = 1, #batch[1] do
+                local row = {}
+                for j = 1, #batch do
+                    row[j] = batch[j][i]
+                end
+                table.insert(rows, row)
+            end
+        end
+        local expected = {}
+        for _, tuple in s:pairs() do
+            table.insert(expected, {tuple[1], tuple[3], tuple[4], tuple[5],
+                                    tuple[6], tuple[7], tuple[8]})
+        end
+        t.assert_equals(rows, expected)
+    end)
+end
+
+g.test_key = function(cg)
+    cg.server:exec(function()
+        local lib = require('arrow_stream_lib')
+        local s = box.space.test
+        local res = lib.read(s.id, 1, {0}, {1}, 100)
+        t.assert_equals(res.batches, {{{1, 3, 5, 7, 9}}})
+        res = lib.read(s.id, 0, {0}, {100}, 100)
+        t.assert_equals(res.batches, {})
+    end)
+end
+
+g.test_read_view = function(cg)
+    cg.server:exec(function()
+        local lib = require('arrow_stream_lib')
+        local s = box.space.test
+        local fiber = require('fiber')
+        local f = fiber.new(lib.read, s.id, 0, {0}, {}, 1)
+        f:set_joinable(true)
+        -- Let the fiber create the stream and wait for the first batch.
+        fiber.yield()
+        -- Changes done after the stream was created aren't visible.
+        s:replace(s:get(1):update({{'=', 1, 100}}))
+        s:delete(2)
+        local ok, res = f:join()
+        t.assert(ok)
+        t.assert_equals(#res.batches, 10)
+        t.assert_equals(res.batches[2], {{2}})
+        s:delete(100)
+        local ffi = require('ffi')
+        s:replace({2, 0, -2, ffi.cast('double', 1), true, 'str2', -2,
+                   ffi.cast('float', 4)})
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local lib = require('arrow_stream_lib')
+        local s = box.space.test
+        t.assert_error_msg_equals("Space '1000000' does not exist",
+                                  lib.read, 1000000, 0, {0}, {}, 1)
+        t.assert_error_msg_equals("No index #10 is defined in space 'test'",
+                                  lib.read, s.id, 10, {0}, {}, 1)
+        t.assert_error_msg_equals("Field 10 was not found in the tuple",
+                                  lib.read, s.id, 0, {9}, {}, 1)
+        t.assert_error_msg_equals(
+            "Arrow stream does not support field 'm' of type 'map'",
+            lib.read, s.id, 0, {8}, {}, 1)
+        t.assert_error_msg_equals(
+            "batch row count must be > 0 and <= 2147483647",
+            lib.read, s.id, 0, {0}, {}, 0)
+        t.assert_error_msg_equals("vinyl does not support Arrow stream",
+                                  lib.read, box.space.vinyl.id, 0, {0}, {}, 1)
+    end)
+end
@@ -0,0 +1,41 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.test_coio_stat = function(cg)
+    cg.server:exec(function()
+        local digest = require('digest')
+        local socket = require('socket')
+
+        local stat1 = box.stat.coio()
+        for _, lane in ipairs({'high', 'normal', 'bulk'}) do
+            local s = stat1[lane]
+            t.assert_type(s, 'table', lane)
+            t.assert_ge(s.count, 0, lane)
+            t.assert_ge(s.wait_total, 0, lane)
+            t.assert_ge(s.wait_total, s.wait_max, lane)
+            t.assert_ge(s.exec_total, 0, lane)
+            t.assert_ge(s.exec_total, s.exec_max, lane)
+        end
+
+        -- Name resolution is run in the high lane.
+        socket.getaddrinfo('localhost', 0)
+        -- Password hashing is run in the normal lane.
+        digest.pbkdf2('password', 'salt')
+
+        local stat2 = box.stat.coio()
+        t.assert_ge(stat2.high.count, stat1.high.count + 1)
+        t.assert_ge(stat2.normal.count, stat1.normal.count + 1)
+        t.assert_gt(stat2.normal.exec_total, stat1.normal.exec_total)
+    end)
+end
@@ -20,6 +20,16 @@ local SIZE_OF_NEARBY_GAP_TRACKER = 88
 
 local current_stat = {}
 
+-- Returns memtx tx statistics without the garbage collector counters,
+-- which change on every statement.
+local function tx_stat(server)
+    return server:exec(function()
+        local stat = box.stat.memtx.tx()
+        stat.mvcc.gc = nil
+        return stat
+    end)
+end
+
 local function table_apply_change(table, related_changes)
     for k, v in pairs(related_changes) do
         if type(v) ~= 'table' then
@@ -50,7 +60,7 @@ local function tx_gc(server, steps, related_changes)
     if related_changes then
         table_apply_change(current_stat, related_changes)
     end
-    t.assert_equals(server:eval('return box.stat.memtx.tx()'), current_stat)
+    t.assert_equals(tx_stat(server), current_stat)
 end
 
 local function tx_step(server, txn_name, op, related_changes)
@@ -58,7 +68,7 @@ local function tx_step(server, txn_name, op, related_changes)
     if related_changes then
         table_apply_change(current_stat, related_changes)
     end
-    t.assert_equals(server:eval('return box.stat.memtx.tx()'), current_stat)
+    t.assert_equals(tx_stat(server), current_stat)
 end
 
 g.before_each(function()
@@ -74,7 +84,7 @@ g.before_each(function()
     -- Clear txm before test
     g.server:eval('box.internal.memtx_tx_gc(100)')
     -- CREATING CURRENT STAT
-    current_stat = g.server:eval('return box.stat.memtx.tx()')
+    current_stat = tx_stat(g.server)
     -- Check if txm use no memory
     t.assert(table_values_are_zeros(current_stat))
 end)
@@ -234,7 +244,7 @@ g.test_read_view = function()
     g.server:eval('s:replace{1, 1}')
     g.server:eval('s:replace{2, 1}')
     g.server:eval('box.internal.memtx_tx_gc(10)')
-    t.assert(table_values_are_zeros(g.server:eval('return box.stat.memtx.tx()')))
+    t.assert(table_values_are_zeros(tx_stat(g.server)))
     g.server:eval('tx1("s:get(1)")')
     g.server:eval('tx2("s:replace{1, 2}")')
     g.server:eval('tx2("s:replace{2, 2}")')
@@ -281,7 +291,7 @@ g.test_read_view_with_empty_space = function()
     g.server:eval('s:replace{1, 1}')
     g.server:eval('s:replace{2, 1}')
     g.server:eval('box.internal.memtx_tx_gc(10)')
-    t.assert(table_values_are_zeros(g.server:eval('return box.stat.memtx.tx()')))
+    t.assert(table_values_are_zeros(tx_stat(g.server)))
     g.server:eval('tx1("s:get(1)")')
     g.server:eval('tx2("s:delete(1)")')
     g.server:eval('tx2("s:delete(2)")')
@@ -359,7 +369,7 @@ g.test_conflict = function()
     g.server:eval('tx1 = txn_proxy.new()')
     g.server:eval('tx2 = txn_proxy.new()')
     g.server:eval('box.internal.memtx_tx_gc(10)')
-    local stat = g.server:eval('return box.stat.memtx.tx()')
+    local stat = tx_stat(g.server)
     t.assert(table_values_are_zeros(stat))
 
     -- Test that monitoring shows hole point tracker.
@@ -482,3 +492,23 @@ g.test_gh_8448_box_stat_memtx_func = function()
         t.assert_equals(box.stat.memtx().tx, box.stat.memtx.tx())
     end)
 end
+
+g.test_gc_stat = function()
+    g.server:exec(function()
+        local s = box.space.test
+        local gc = box.stat.memtx.tx().mvcc.gc
+        t.assert_equals(gc.lag, 0)
+        s:replace{1, 1}
+        box.begin()
+        s:replace{2, 2}
+        local new_gc = box.stat.memtx.tx().mvcc.gc
+        t.assert_gt(new_gc.steps, gc.steps)
+        box.commit()
+        box.internal.memtx_tx_gc(100)
+        gc = box.stat.memtx.tx().mvcc.gc
+        t.assert_ge(gc.steps, new_gc.steps + 100)
+        -- The story of the committed transaction must be collected.
+        t.assert_gt(gc.collected, new_gc.collected)
+        t.assert_equals(gc.lag, 0)
+    end)
+end
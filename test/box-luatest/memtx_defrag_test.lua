@@ -0,0 +1,82 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.cfg({memtx_defrag_threshold = 0})
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_defrag_threshold, 0)
+        local stat = box.stat.memtx().defrag
+        t.assert_equals(stat.passes, 0)
+        t.assert_equals(stat.relocated, {count = 0, bytes = 0})
+        for _, v in ipairs({-0.1, 1, 2}) do
+            t.assert_error_msg_equals(
+                "Incorrect value for option 'memtx_defrag_threshold': " ..
+                "the value must be >= 0 and < 1",
+                box.cfg, {memtx_defrag_threshold = v})
+        end
+        box.cfg({memtx_defrag_threshold = 0.5})
+        t.assert_equals(box.cfg.memtx_defrag_threshold, 0.5)
+    end)
+end
+
+g.test_defrag = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {{2, 'string'}}})
+        s:create_index('hash', {type = 'hash', parts = {{3, 'unsigned'}}})
+        local padding = string.rep('x', 200)
+        box.begin()
+        for i = 1, 100000 do
+            s:insert({i, 'k' .. i, i * 2, padding})
+        end
+        box.commit()
+        -- Leave only every 10th tuple so that all slabs become sparse.
+        box.begin()
+        for i = 1, 100000 do
+            if i % 10 ~= 0 then
+                s:delete(i)
+            end
+        end
+        box.commit()
+        -- A tuple referenced from Lua must stay in place.
+        local pinned = s:get(10)
+        box.cfg({memtx_defrag_threshold = 0.5})
+        t.helpers.retrying({timeout = 60}, function()
+            local stat = box.stat.memtx().defrag
+            t.assert_gt(stat.passes, 0)
+            t.assert_gt(stat.relocated.count, 0)
+            t.assert_gt(stat.relocated.bytes, 0)
+        end)
+        box.cfg({memtx_defrag_threshold = 0})
+        t.assert(pinned == s:get(10))
+        t.assert_equals(s:count(), 10000)
+        for i = 10, 100000, 10 do
+            local tuple = {i, 'k' .. i, i * 2, padding}
+            t.assert_equals(s:get(i), tuple)
+            t.assert_equals(s.index.sk:get('k' .. i), tuple)
+            t.assert_equals(s.index.hash:get(i * 2), tuple)
+        end
+        t.assert_equals(s.index.sk:count(), 10000)
+        t.assert_equals(s.index.hash:count(), 10000)
+    end)
+end
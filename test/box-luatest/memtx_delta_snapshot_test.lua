@@ -0,0 +1,137 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_each(function(cg)
+    cg.server = server:new({
+        box_cfg = {
+            snap_delta_count = 2,
+            checkpoint_count = 1,
+        },
+    })
+    cg.server:start()
+end)
+
+g.after_each(function(cg)
+    cg.server:drop()
+end)
+
+local function snap_files(cg)
+    return cg.server:exec(function()
+        local fio = require('fio')
+        local files = fio.glob(fio.pathjoin(box.cfg.memtx_dir, '*.snap'))
+        table.sort(files)
+        return files
+    end)
+end
+
+local function is_delta(path)
+    local f = fio.open(path)
+    local header = f:read(512)
+    f:close()
+    return header:find('PrevVClock:') ~= nil
+end
+
+g.test_delta_snapshot = function(cg)
+    cg.server:exec(function()
+        local s1 = box.schema.space.create('test1')
+        s1:create_index('pk')
+        local s2 = box.schema.space.create('test2')
+        s2:create_index('pk')
+        local s3 = box.schema.space.create('test3')
+        s3:create_index('pk')
+        for i = 1, 100 do
+            s1:insert({i, 'a'})
+            s2:insert({i, 'b'})
+            s3:insert({i, 'c'})
+        end
+        -- Full snapshot.
+        box.snapshot()
+        -- Delta snapshot #1: only test2 has changed.
+        s2:replace({1, 'bb'})
+        s2:delete({2})
+        box.snapshot()
+        -- Delta snapshot #2: test3 is truncated, test4 is created.
+        s3:truncate()
+        local s4 = box.schema.space.create('test4')
+        s4:create_index('pk')
+        s4:insert({1, 'd'})
+        box.snapshot()
+    end)
+    local files = snap_files(cg)
+    t.assert_equals(#files, 3)
+    t.assert_not(is_delta(files[1]))
+    t.assert(is_delta(files[2]))
+    t.assert(is_delta(files[3]))
+    -- Delta snapshots don't store spaces that haven't changed.
+    t.assert_lt(fio.stat(files[2]).size, fio.stat(files[1]).size)
+
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.space.test1:count(), 100)
+        t.assert_equals(box.space.test1:get(1), {1, 'a'})
+        t.assert_equals(box.space.test2:count(), 99)
+        t.assert_equals(box.space.test2:get(1), {1, 'bb'})
+        t.assert_equals(box.space.test2:get(2), nil)
+        t.assert_equals(box.space.test3:count(), 0)
+        t.assert_equals(box.space.test4:select(), {{1, 'd'}})
+        -- The chain is full so the next snapshot is full.
+        box.space.test1:insert({101, 'a'})
+        box.snapshot()
+    end)
+    files = snap_files(cg)
+    -- Old snapshots were collected.
+    t.assert_equals(#files, 1)
+    t.assert_not(is_delta(files[1]))
+
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.space.test1:count(), 101)
+        t.assert_equals(box.space.test2:count(), 99)
+        t.assert_equals(box.space.test3:count(), 0)
+        t.assert_equals(box.space.test4:count(), 1)
+    end)
+end
+
+g.test_drop_space = function(cg)
+    cg.server:exec(function()
+        local s1 = box.schema.space.create('test1')
+        s1:create_index('pk')
+        s1:insert({1})
+        local s2 = box.schema.space.create('test2')
+        s2:create_index('pk')
+        s2:insert({2})
+        box.snapshot()
+        -- Recreate the space with the same id.
+        local id = s1.id
+        s1:drop()
+        s1 = box.schema.space.create('test1', {id = id})
+        s1:create_index('pk')
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        t.assert_equals(box.space.test1:select(), {})
+        t.assert_equals(box.space.test2:select(), {{2}})
+    end)
+end
+
+g.test_cfg = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_content_equals(
+            "Incorrect value for option 'snap_delta_count': " ..
+            "the value must not be less than zero",
+            box.cfg, {snap_delta_count = -1})
+        box.cfg({snap_delta_count = 0})
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        box.snapshot()
+        s:insert({1})
+        box.snapshot()
+    end)
+    local files = snap_files(cg)
+    t.assert_equals(#files, 1)
+    t.assert_not(is_delta(files[1]))
+end
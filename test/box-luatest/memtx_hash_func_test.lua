@@ -0,0 +1,118 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({layout = {'chained', 'swiss'}}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_xxh3 = function(cg)
+    cg.server:exec(function(layout)
+        local s = box.schema.space.create('test')
+        local function hash_index(name, parts)
+            return s:create_index(name, {type = 'hash', parts = parts,
+                                         layout = layout,
+                                         hash_func = 'xxh3'})
+        end
+        -- Pre-generated hashers.
+        hash_index('pk', {{1, 'unsigned'}})
+        hash_index('s', {{2, 'string'}})
+        hash_index('us', {{1, 'unsigned'}, {2, 'string'}})
+        -- Slow path: collation, double, scalar, non-sequential parts,
+        -- JSON path.
+        hash_index('ci', {{2, 'string', collation = 'unicode_ci'}})
+        hash_index('d', {{3, 'double'}})
+        hash_index('sc', {{4, 'scalar'}, {1, 'unsigned'}})
+        hash_index('n', {{5, 'unsigned'}, {1, 'unsigned'}})
+        hash_index('j', {{6, 'unsigned', path = 'a'}})
+        t.assert_equals(s.index.pk.hash_func, 'xxh3')
+        local ffi = require('ffi')
+        for i = 1, 1000 do
+            s:insert({i, 'S' .. i, ffi.cast('double', i / 2),
+                      i % 2 == 0 and i / 2 or tostring(i),
+                      i % 3, {a = i}})
+        end
+        for i = 1, 1000, 7 do
+            local tuple = s:get(i)
+            t.assert_equals(tuple[1], i)
+            t.assert_equals(s.index.s:get('S' .. i), tuple)
+            t.assert_equals(s.index.us:get({i, 'S' .. i}), tuple)
+            t.assert_equals(s.index.ci:get('s' .. i), tuple)
+            t.assert_equals(s.index.d:get(i / 2), tuple)
+            t.assert_equals(s.index.sc:get({tuple[4], i}), tuple)
+            t.assert_equals(s.index.n:get({tuple[5], i}), tuple)
+            t.assert_equals(s.index.j:get(i), tuple)
+        end
+        -- Floating point keys match integer values and vice versa.
+        t.assert_equals(s.index.sc:get({ffi.cast('double', 1), 2}), s:get(2))
+        t.assert_equals(s.index.d:get(1), s:get(2))
+        t.assert_equals(s.index.ci:get('s1001'), nil)
+        t.assert_error_msg_contains(
+            'Duplicate key exists in unique index "ci"', s.insert, s,
+            {1001, 's1', ffi.cast('double', 0), 0, 0, {a = 1001}})
+        box.snapshot()
+    end, {cg.params.layout})
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.pk.hash_func, 'xxh3')
+        t.assert_equals(s.index.s:get('S500')[1], 500)
+        t.assert_equals(s.index.ci:get('s500')[1], 500)
+        t.assert_equals(s.index.n:get({2, 500})[1], 500)
+    end)
+end
+
+g.test_alter_hash_func = function(cg)
+    cg.server:exec(function(layout)
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash', layout = layout})
+        s:create_index('sk', {type = 'hash', parts = {2, 'string'},
+                              layout = layout})
+        t.assert_equals(s.index.sk.hash_func, 'murmur')
+        for i = 1, 100 do
+            s:insert({i, tostring(i)})
+        end
+        s.index.sk:alter({hash_func = 'xxh3'})
+        t.assert_equals(s.index.sk.hash_func, 'xxh3')
+        t.assert_equals(s.index.sk:count(), 100)
+        t.assert_equals(s.index.sk:get('50'), {50, '50'})
+        s.index.sk:alter({hash_func = 'murmur'})
+        t.assert_equals(s.index.sk.hash_func, 'murmur')
+        t.assert_equals(s.index.sk:get('50'), {50, '50'})
+    end, {cg.params.layout})
+end
+
+g.test_hash_func_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_error_msg_content_equals(
+            "Wrong index options: hash_func must be either 'murmur' " ..
+            "or 'xxh3'", s.create_index, s, 'pk',
+            {type = 'hash', hash_func = 'foo'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "hash_func is only reasonable with memtx hash index",
+            s.create_index, s, 'pk', {type = 'tree', hash_func = 'xxh3'})
+        s:drop()
+        s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "hash_func is only reasonable with memtx hash index",
+            s.create_index, s, 'pk', {hash_func = 'xxh3'})
+        t.assert_equals(s:create_index('pk').hash_func, nil)
+    end)
+end
@@ -0,0 +1,110 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_swiss_layout = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash', layout = 'swiss'})
+        s:create_index('sk', {type = 'hash', parts = {2, 'string'},
+                              layout = 'swiss'})
+        t.assert_equals(s.index.pk.layout, 'swiss')
+        t.assert_equals(s.index.sk.layout, 'swiss')
+        for i = 1, 10000 do
+            s:insert({i, tostring(i)})
+        end
+        t.assert_equals(s:count(), 10000)
+        t.assert_equals(s.index.sk:count(), 10000)
+        t.assert_gt(s.index.pk:bsize(), 0)
+        t.assert_equals(s:get(5000), {5000, '5000'})
+        t.assert_equals(s.index.sk:get('5000'), {5000, '5000'})
+        t.assert_equals(s:get(10001), nil)
+        t.assert_error_msg_contains('Duplicate key exists',
+                                    s.insert, s, {1, 'x'})
+        t.assert_error_msg_contains('Duplicate key exists',
+                                    s.insert, s, {10001, '1'})
+        t.assert_equals(s:get(1), {1, '1'})
+        t.assert_equals(s.index.sk:get('x'), nil)
+        for i = 1, 10000, 2 do
+            s:delete({i})
+        end
+        for i = 2, 10000, 2 do
+            s:replace({i, 'new' .. i})
+        end
+        t.assert_equals(s:count(), 5000)
+        t.assert_equals(s:get(1), nil)
+        t.assert_equals(s:get(2), {2, 'new2'})
+        t.assert_equals(s.index.sk:get('2'), nil)
+        t.assert_equals(s.index.sk:get('new2'), {2, 'new2'})
+        t.assert_equals(#s:select({}, {iterator = 'all'}), 5000)
+        t.assert_equals(s:select({4}, {iterator = 'eq'}), {{4, 'new4'}})
+        t.assert_not_equals(s.index.pk:random(123), nil)
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s.index.pk.layout, 'swiss')
+        t.assert_equals(s:count(), 5000)
+        t.assert_equals(s.index.sk:count(), 5000)
+        t.assert_equals(s:get(2), {2, 'new2'})
+        t.assert_equals(s.index.sk:get('new10000'), {10000, 'new10000'})
+    end)
+end
+
+g.test_alter_layout = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {type = 'hash'})
+        t.assert_equals(s.index.pk.layout, 'chained')
+        for i = 1, 100 do
+            s:insert({i})
+        end
+        s.index.pk:alter({layout = 'swiss'})
+        t.assert_equals(s.index.pk.layout, 'swiss')
+        t.assert_equals(s:count(), 100)
+        t.assert_equals(s:get(50), {50})
+        s.index.pk:alter({layout = 'chained'})
+        t.assert_equals(s.index.pk.layout, 'chained')
+        t.assert_equals(s:count(), 100)
+    end)
+end
+
+g.test_layout_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_error_msg_content_equals(
+            "Wrong index options: layout must be either 'chained' " ..
+            "or 'swiss'", s.create_index, s, 'pk',
+            {type = 'hash', layout = 'foo'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "layout is only reasonable with memtx hash index",
+            s.create_index, s, 'pk', {type = 'tree', layout = 'swiss'})
+        s:drop()
+        s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "layout is only reasonable with memtx hash index",
+            s.create_index, s, 'pk', {layout = 'swiss'})
+        t.assert_equals(s:create_index('pk').layout, nil)
+    end)
+end
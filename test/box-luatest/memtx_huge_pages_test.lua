@@ -0,0 +1,69 @@
+local fio = require('fio')
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.after_each(function(cg)
+    if cg.server ~= nil then
+        cg.server:drop()
+        cg.server = nil
+    end
+end)
+
+g.test_default = function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_huge_pages, 'off')
+        local stat = box.stat.memtx().arena
+        t.assert_equals(stat.huge_pages, 'off')
+        t.assert_equals(stat.huge, 0)
+        t.assert_gt(stat.total, 0)
+    end)
+end
+
+g.test_transparent = function(cg)
+    cg.server = server:new({box_cfg = {memtx_huge_pages = 'transparent'}})
+    cg.server:start()
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_huge_pages, 'transparent')
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        for i = 1, 10000 do
+            s:insert({i, string.rep('x', 100)})
+        end
+        local stat = box.stat.memtx().arena
+        -- Transparent huge pages may be disabled in the system.
+        t.assert_items_include({'transparent', 'off'}, {stat.huge_pages})
+        t.assert_ge(stat.huge, 0)
+        t.assert_le(stat.huge, stat.total)
+        t.assert_error_msg_equals(
+            "Can't set option 'memtx_huge_pages' dynamically",
+            box.cfg, {memtx_huge_pages = 'off'})
+    end)
+end
+
+g.test_hugetlb_fallback = function(cg)
+    -- Preallocated hugetlb pages are unlikely to be available in a test
+    -- environment, but the instance must start in any case.
+    cg.server = server:new({box_cfg = {memtx_huge_pages = '1G'}})
+    cg.server:start()
+    cg.server:exec(function()
+        t.assert_equals(box.cfg.memtx_huge_pages, '1G')
+        t.assert_items_include({'1G', 'transparent', 'off'},
+                               {box.stat.memtx().arena.huge_pages})
+    end)
+end
+
+g.test_invalid = function(cg)
+    cg.server = server:new({box_cfg = {memtx_huge_pages = 'foo'}})
+    cg.server:start({wait_until_ready = false})
+    local log = fio.pathjoin(cg.server.workdir, cg.server.alias .. '.log')
+    t.helpers.retrying({}, function()
+        t.assert(cg.server:grep_log(
+            "Incorrect value for option 'memtx_huge_pages': " ..
+            "expected 'off', 'transparent', '2M' or '1G'", nil,
+            {filename = log}))
+    end)
+end
@@ -0,0 +1,190 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_key_prefix = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local function create_pair(name, parts, opts)
+            opts = opts or {}
+            opts.parts = parts
+            opts.unique = opts.unique or false
+            s:create_index(name .. '_ref', opts)
+            opts.key_prefix = true
+            s:create_index(name, opts)
+        end
+        create_pair('s', {{3, 'string'}})
+        create_pair('us', {{2, 'unsigned'}, {3, 'string'}})
+        create_pair('ci', {{3, 'string', collation = 'unicode_ci'},
+                           {4, 'integer', sort_order = 'desc'}})
+        create_pair('uniq', {{1, 'unsigned'}, {3, 'string'}},
+                    {unique = true})
+        create_pair('nd', {{5, 'number', is_nullable = true},
+                           {3, 'string', sort_order = 'desc'}})
+        -- Decimals can't be normalized in a scalar part, such tuples
+        -- are compared with the comparator.
+        create_pair('sc', {{6, 'scalar'}, {2, 'unsigned'}})
+        local decimal = require('decimal')
+        local ffi = require('ffi')
+        -- Strings share prefixes longer than the stored ones.
+        local prefix = string.rep('a', 20)
+        local values = {0, 1, -1, 2^31, -2^31, 2^53, 1.5, -0.5,
+                        9223372036854775807LL, -9223372036854775807LL - 1}
+        local scalars = {true, false, 1, -1.5, decimal.new('1.25'),
+                         decimal.new('-3'), 'abc', 'ABC', prefix .. 'b',
+                         ffi.cast('double', 2)}
+        for i = 1, 1000 do
+            local str = i % 3 == 0 and prefix .. tostring(i % 17) or
+                        i % 3 == 1 and string.upper(tostring(i % 13)) or
+                        tostring(i % 13)
+            s:insert({i, i % 5, str, i % 7 - 3,
+                      i % 4 ~= 0 and values[i % #values + 1] or box.NULL,
+                      scalars[i % #scalars + 1]})
+        end
+        local names = {'s', 'us', 'ci', 'uniq', 'nd', 'sc'}
+        local function check()
+            for _, name in ipairs(names) do
+                local idx = s.index[name]
+                local ref = s.index[name .. '_ref']
+                t.assert_equals(idx.key_prefix, true)
+                t.assert_equals(ref.key_prefix, false)
+                t.assert_equals(idx:select(), ref:select(), name)
+                t.assert_equals(idx:count(), ref:count(), name)
+                local key_def = require('key_def').new(idx.parts)
+                for _, tuple in ipairs(ref:select({}, {limit = 100})) do
+                    local key = key_def:extract_key(tuple):totable()
+                    t.assert_equals(idx:count(key), ref:count(key), name)
+                    for _, it in ipairs({'EQ', 'REQ', 'GE', 'GT',
+                                         'LE', 'LT'}) do
+                        local opts = {iterator = it, limit = 5}
+                        t.assert_equals(idx:select(key, opts),
+                                        ref:select(key, opts), name)
+                        t.assert_equals(idx:select({key[1]}, opts),
+                                        ref:select({key[1]}, opts), name)
+                        opts.after = tuple
+                        opts.fetch_pos = true
+                        t.assert_equals({idx:select({}, opts)},
+                                        {ref:select({}, opts)}, name)
+                    end
+                end
+            end
+        end
+        check()
+        for i = 1, 1000, 3 do
+            s:update(i, {{'=', 3, prefix .. tostring(i % 5)}, {'+', 2, 1}})
+        end
+        for i = 2, 1000, 7 do
+            s:delete(i)
+        end
+        check()
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        for _, name in ipairs({'s', 'us', 'ci', 'uniq', 'nd', 'sc'}) do
+            t.assert_equals(s.index[name].key_prefix, true)
+            t.assert_equals(s.index[name]:select(),
+                            s.index[name .. '_ref']:select(), name)
+        end
+    end)
+end
+
+g.test_key_prefix_iterator_stability = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        s:create_index('sk', {parts = {{2, 'string'}}, unique = false,
+                              key_prefix = true})
+        local prefix = string.rep('x', 20)
+        for i = 1, 100 do
+            s:insert({i, prefix .. string.format('%03d', i)})
+        end
+        local result = {}
+        for _, tuple in s.index.sk:pairs() do
+            table.insert(result, tuple[1])
+            -- Insert tuples before and after the iterator position.
+            if tuple[1] <= 100 then
+                s:insert({tuple[1] + 1000, prefix .. '000'})
+                s:insert({tuple[1] + 2000, prefix .. '999'})
+            end
+        end
+        t.assert_equals(#result, 200)
+        t.assert_equals(s.index.sk:count(), 300)
+    end)
+end
+
+g.test_alter_key_prefix = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {parts = {{1, 'string'}, {2, 'unsigned'}}})
+        for i = 1, 100 do
+            s:insert({'key' .. i % 3, i})
+        end
+        s.index.pk:alter({key_prefix = true})
+        t.assert_equals(s.index.pk.key_prefix, true)
+        t.assert_equals(s:get({'key1', 10}), {'key1', 10})
+        t.assert_equals(#s:select({'key2'}), 33)
+        t.assert_equals(s:select({'key1', 50}, {iterator = 'LT', limit = 2}),
+                        {{'key1', 49}, {'key1', 46}})
+        s.index.pk:alter({key_prefix = false})
+        t.assert_equals(s.index.pk.key_prefix, false)
+        t.assert_equals(s:get({'key1', 10}), {'key1', 10})
+    end)
+end
+
+g.test_key_prefix_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "key_prefix is only reasonable with memtx tree index",
+            s.create_index, s, 'pk', {type = 'hash', key_prefix = true})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "key_prefix can't be used without hint",
+            s.create_index, s, 'pk', {hint = false, key_prefix = true})
+        s:create_index('pk')
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'sk' in space 'test': " ..
+            "multikey index can't use key_prefix",
+            s.create_index, s, 'sk', {parts = {{'[2][*]', 'unsigned'}},
+                                      key_prefix = true})
+        box.schema.func.create('test', {
+            body = 'function(tuple) return {tuple[1]} end',
+            is_deterministic = true, is_sandboxed = true,
+        })
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'sk' in space 'test': " ..
+            "functional index can't use key_prefix",
+            s.create_index, s, 'sk', {func = 'test', key_prefix = true,
+                                      parts = {{1, 'unsigned'}}})
+        box.schema.func.drop('test')
+        s:drop()
+        s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "key_prefix is only reasonable with memtx tree index",
+            s.create_index, s, 'pk', {key_prefix = true})
+        t.assert_equals(s:create_index('pk').key_prefix, nil)
+    end)
+end
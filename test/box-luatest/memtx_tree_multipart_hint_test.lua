@@ -0,0 +1,143 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+    end)
+end)
+
+g.test_multipart_hint = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+        local function create_pair(name, parts, opts)
+            opts = opts or {}
+            opts.parts = parts
+            opts.unique = false
+            s:create_index(name .. '_ref', opts)
+            opts.hint_parts = 2
+            s:create_index(name, opts)
+        end
+        create_pair('us', {{2, 'unsigned'}, {3, 'string'}})
+        create_pair('ii', {{4, 'integer', sort_order = 'desc'},
+                           {2, 'unsigned'}})
+        create_pair('bs', {{5, 'boolean'},
+                           {3, 'string', collation = 'unicode_ci'}})
+        create_pair('nv', {{6, 'integer', is_nullable = true},
+                           {7, 'varbinary', is_nullable = true,
+                            sort_order = 'desc'}})
+        -- The second part is the primary key.
+        create_pair('u', {{2, 'unsigned'}})
+        -- Unsupported types fall back on the regular hints.
+        create_pair('ds', {{8, 'double'}, {3, 'string'}})
+        local ffi = require('ffi')
+        local varbinary = require('varbinary')
+        -- Values around the bounds of the exact hint range.
+        local values = {0, 1, 2, -1, -2, 2^31 - 3, 2^31 - 2, 2^31 - 1, 2^31,
+                        -2^31 + 2, -2^31 + 1, -2^31, -2^31 - 1, 2^40, -2^40,
+                        9223372036854775807LL, -9223372036854775807LL - 1}
+        for i = 1, 1000 do
+            local v = values[i % #values + 1]
+            s:insert({i, i % 5 == 0 and 2^32 + i % 3 or i % 3,
+                      string.rep('x', i % 7) .. tostring(i % 11),
+                      v, i % 2 == 0,
+                      i % 4 ~= 0 and v or box.NULL,
+                      i % 6 ~= 0 and varbinary.new(string.char(i % 256,
+                                                               i % 3))
+                                 or box.NULL,
+                      ffi.cast('double', i % 10)})
+        end
+        local names = {'us', 'ii', 'bs', 'nv', 'u', 'ds'}
+        local function check()
+            for _, name in ipairs(names) do
+                local idx = s.index[name]
+                local ref = s.index[name .. '_ref']
+                t.assert_equals(idx.hint_parts, 2)
+                t.assert_equals(ref.hint_parts, 1)
+                t.assert_equals(idx:select(), ref:select(), name)
+                local key_def = require('key_def').new(idx.parts)
+                for _, tuple in ipairs(ref:select({}, {limit = 100})) do
+                    local key = key_def:extract_key(tuple):totable()
+                    for _, it in ipairs({'EQ', 'REQ', 'GE', 'GT',
+                                         'LE', 'LT'}) do
+                        local opts = {iterator = it, limit = 5}
+                        t.assert_equals(idx:select(key, opts),
+                                        ref:select(key, opts), name)
+                        t.assert_equals(idx:select({key[1]}, opts),
+                                        ref:select({key[1]}, opts), name)
+                    end
+                end
+            end
+        end
+        check()
+        for i = 1, 1000, 3 do
+            s:update(i, {{'=', 3, tostring(i % 5)}, {'+', 2, 1}})
+        end
+        check()
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        for _, name in ipairs({'us', 'ii', 'bs', 'nv', 'u', 'ds'}) do
+            t.assert_equals(s.index[name].hint_parts, 2)
+            t.assert_equals(s.index[name]:select(),
+                            s.index[name .. '_ref']:select(), name)
+        end
+    end)
+end
+
+g.test_alter_hint_parts = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk', {parts = {{1, 'unsigned'}, {2, 'unsigned'}}})
+        for i = 1, 100 do
+            s:insert({i % 3, i})
+        end
+        s.index.pk:alter({hint_parts = 2})
+        t.assert_equals(s.index.pk.hint_parts, 2)
+        t.assert_equals(s:get({1, 10}), {1, 10})
+        t.assert_equals(#s:select({2}), 33)
+        t.assert_equals(s:select({1, 50}, {iterator = 'LT', limit = 2}),
+                        {{1, 49}, {1, 46}})
+        s.index.pk:alter({hint_parts = 1})
+        t.assert_equals(s.index.pk.hint_parts, 1)
+        t.assert_equals(s:get({1, 10}), {1, 10})
+    end)
+end
+
+g.test_hint_parts_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        t.assert_error_msg_content_equals(
+            "Wrong index options: hint_parts must be either 1 or 2",
+            s.create_index, s, 'pk', {hint_parts = 3})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "hint_parts is only reasonable with memtx tree index",
+            s.create_index, s, 'pk', {type = 'hash', hint_parts = 2})
+        t.assert_equals(s:create_index('pk', {type = 'hash'}).hint_parts,
+                        nil)
+        s:drop()
+        s = box.schema.space.create('test', {engine = 'vinyl'})
+        t.assert_error_msg_content_equals(
+            "Can't create or modify index 'pk' in space 'test': " ..
+            "hint_parts is only reasonable with memtx tree index",
+            s.create_index, s, 'pk', {hint_parts = 2})
+        t.assert_equals(s:create_index('pk').hint_parts, nil)
+    end)
+end
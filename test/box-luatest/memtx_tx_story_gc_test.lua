@@ -0,0 +1,84 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new{box_cfg = {memtx_use_mvcc_engine = true}}
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test')
+        s:create_index('pk')
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.space.test:drop()
+        box.internal.memtx_tx_gc(1000)
+    end)
+end)
+
+-- Checks that the story garbage collector speeds up when it finds a lot
+-- of garbage and slows down once it has caught up.
+g.test_adaptive_gc = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.space.test
+
+        local function gc_stat()
+            return box.stat.memtx.tx().mvcc.gc
+        end
+
+        for i = 1, 100 do
+            s:replace{i, 0}
+        end
+        box.internal.memtx_tx_gc(1000)
+        local stat1 = gc_stat()
+        t.assert_equals(stat1.lag, 0)
+        t.assert_equals(stat1.steps_per_story, 2)
+
+        -- Open a read view, so stories can't be deleted.
+        local ch = fiber.channel()
+        local reader = fiber.new(function()
+            box.begin()
+            s:select()
+            ch:get()
+            box.commit()
+        end)
+        reader:set_joinable(true)
+        fiber.yield()
+        for i = 1, 100 do
+            s:replace{i, 1}
+        end
+        local stat2 = gc_stat()
+        t.assert_gt(stat2.steps, stat1.steps)
+        t.assert_equals(stat2.collected, stat1.collected)
+        -- There's no garbage, so the GC runs at the minimal speed.
+        t.assert_equals(stat2.steps_per_story, 2)
+
+        -- Close the read view: all the stories become garbage.
+        ch:put(true)
+        t.assert_equals({reader:join()}, {true})
+        local peak = 0
+        for i = 1, 1000 do
+            s:replace{1000 + i}
+            peak = math.max(peak, gc_stat().steps_per_story)
+        end
+        local stat3 = gc_stat()
+        t.assert_gt(stat3.steps, stat2.steps)
+        t.assert_gt(stat3.collected, stat2.collected)
+        -- The GC sped up to collect the garbage...
+        t.assert_gt(peak, 2)
+        -- ...and slowed down after it had caught up.
+        t.assert_lt(stat3.steps_per_story, peak)
+        t.assert_lt(stat3.lag, 10)
+    end)
+end
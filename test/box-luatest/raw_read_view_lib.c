@@ -0,0 +1,153 @@
+#include <lua.h>
+#include <lauxlib.h>
+#include <module.h>
+#include <msgpuck.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+/** Read view opened by open(). */
+static box_raw_read_view_t *rv;
+
+/** open(name) opens a raw read view. */
+static int
+lua_open(struct lua_State *L)
+{
+	if (rv != NULL)
+		return luaL_error(L, "read view is already open");
+	rv = box_raw_read_view_new(luaL_checkstring(L, 1));
+	if (rv == NULL)
+		return luaT_error(L);
+	return 0;
+}
+
+/** close() closes the read view opened by open(). */
+static int
+lua_close(struct lua_State *L)
+{
+	if (rv == NULL)
+		return luaL_error(L, "read view isn't open");
+	box_raw_read_view_delete(rv);
+	rv = NULL;
+	return 0;
+}
+
+/** Sums the given field of tuples returned by a read view iterator. */
+static ssize_t
+sum_f(va_list ap)
+{
+	box_raw_read_view_index_t *index =
+		va_arg(ap, box_raw_read_view_index_t *);
+	int type = va_arg(ap, int);
+	const char *key = va_arg(ap, const char *);
+	const char *key_end = va_arg(ap, const char *);
+	uint32_t field_no = va_arg(ap, uint32_t);
+	uint64_t *sum = va_arg(ap, uint64_t *);
+	box_raw_read_view_iterator_t iter;
+	if (box_raw_read_view_iterator_create(&iter, index, type,
+					      key, key_end) != 0)
+		return -1;
+	int rc = 0;
+	*sum = 0;
+	while (true) {
+		const char *data;
+		uint32_t size;
+		rc = box_raw_read_view_iterator_next(&iter, &data, &size);
+		if (rc != 0 || data == NULL)
+			break;
+		uint32_t field_count = mp_decode_array(&data);
+		if (field_count <= field_no) {
+			rc = box_error_raise(ER_PROC_LUA, "no such field");
+			break;
+		}
+		for (uint32_t i = 0; i < field_no; i++)
+			mp_next(&data);
+		*sum += mp_decode_uint(&data);
+	}
+	box_raw_read_view_iterator_destroy(&iter);
+	return rc;
+}
+
+/**
+ * sum(space_name, index_name, iterator_type, key, field_no) sums
+ * the given zero-based unsigned field of tuples selected from the read
+ * view opened by open(). The read view is iterated in a coio thread.
+ */
+static int
+lua_sum(struct lua_State *L)
+{
+	if (rv == NULL)
+		return luaL_error(L, "read view isn't open");
+	size_t space_name_len, index_name_len;
+	const char *space_name = luaL_checklstring(L, 1, &space_name_len);
+	const char *index_name = luaL_checklstring(L, 2, &index_name_len);
+	int type = luaL_checkinteger(L, 3);
+	luaL_checktype(L, 4, LUA_TTABLE);
+	uint32_t field_no = luaL_checkinteger(L, 5);
+	char key[128];
+	uint32_t part_count = lua_objlen(L, 4);
+	if (part_count > 8)
+		return luaL_error(L, "too many key parts");
+	char *key_end = mp_encode_array(key, part_count);
+	for (uint32_t i = 0; i < part_count; i++) {
+		lua_rawgeti(L, 4, i + 1);
+		key_end = mp_encode_uint(key_end, lua_tointeger(L, -1));
+		lua_pop(L, 1);
+	}
+	box_raw_read_view_space_t *space = box_raw_read_view_space_by_name(
+		rv, space_name, space_name_len);
+	if (space == NULL)
+		return luaT_error(L);
+	box_raw_read_view_index_t *index = box_raw_read_view_index_by_name(
+		space, index_name, index_name_len);
+	if (index == NULL)
+		return luaT_error(L);
+	uint64_t sum;
+	if (coio_call(sum_f, index, type, key, key_end, field_no, &sum) != 0)
+		return luaT_error(L);
+	luaL_pushuint64(L, sum);
+	return 1;
+}
+
+/** get(space_id, index_id, key) returns a raw tuple as a string. */
+static int
+lua_get(struct lua_State *L)
+{
+	if (rv == NULL)
+		return luaL_error(L, "read view isn't open");
+	uint32_t space_id = luaL_checkinteger(L, 1);
+	uint32_t index_id = luaL_checkinteger(L, 2);
+	uint32_t k = luaL_checkinteger(L, 3);
+	char key[16];
+	char *key_end = mp_encode_array(key, 1);
+	key_end = mp_encode_uint(key_end, k);
+	box_raw_read_view_space_t *space =
+		box_raw_read_view_space_by_id(rv, space_id);
+	if (space == NULL)
+		return luaT_error(L);
+	box_raw_read_view_index_t *index =
+		box_raw_read_view_index_by_id(space, index_id);
+	if (index == NULL)
+		return luaT_error(L);
+	const char *data;
+	uint32_t size;
+	if (box_raw_read_view_get(index, key, key_end, &data, &size) != 0)
+		return luaT_error(L);
+	if (data == NULL)
+		return 0;
+	lua_pushlstring(L, data, size);
+	return 1;
+}
+
+LUA_API int
+luaopen_raw_read_view_lib(struct lua_State *L)
+{
+	static const struct luaL_Reg lib[] = {
+		{"open", lua_open},
+		{"close", lua_close},
+		{"sum", lua_sum},
+		{"get", lua_get},
+		{NULL, NULL},
+	};
+	luaL_register(L, "raw_read_view_lib", lib);
+	return 1;
+}
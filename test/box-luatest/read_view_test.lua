@@ -6,17 +6,239 @@ local g = t.group()
 g.before_all(function(cg)
     cg.server = server:new({alias = 'master'})
     cg.server:start()
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {
+            format = {{'id', 'unsigned'}, {'grp', 'unsigned'},
+                      {'val', 'unsigned'}},
+        })
+        s:create_index('pk')
+        s:create_index('grp', {parts = {'grp'}, unique = false})
+        s:create_index('hash', {type = 'hash', parts = {'val'}})
+        for i = 1, 10 do
+            s:insert({i, i % 3, i * 10})
+        end
+    end)
 end)
 
 g.after_all(function(cg)
-    cg.server:stop()
+    cg.server:drop()
 end)
 
-g.test_read_view = function(cg)
-    t.tarantool.skip_if_enterprise()
+g.after_each(function(cg)
     cg.server:exec(function()
+        for _, rv in ipairs(box.read_view.list()) do
+            if not rv.is_system and rv.status == 'open' then
+                rv:close()
+            end
+        end
+        collectgarbage('collect')
+    end)
+end)
+
+g.test_open = function(cg)
+    cg.server:exec(function()
+        t.assert_error_msg_equals(
+            "options should be a table",
+            box.read_view.open, 'foo')
         t.assert_error_msg_equals(
-            "Community edition does not support read view",
-            function() box.read_view.open() end)
+            "unexpected option 'foo'",
+            box.read_view.open, {foo = 'bar'})
+        t.assert_error_msg_equals(
+            "options parameter 'name' should be of type string",
+            box.read_view.open, {name = 123})
+        local rv = box.read_view.open({name = 'test'})
+        t.assert_equals(rv.name, 'test')
+        t.assert_equals(rv.is_system, false)
+        t.assert_equals(rv.status, 'open')
+        t.assert_equals(rv.vclock, box.info.vclock)
+        t.assert_equals(rv.signature, box.info.signature)
+        t.assert_is(box.read_view.list()[#box.read_view.list()], rv)
+        t.assert_equals(box.read_view.open().name, 'unknown')
+        t.assert_is(rv.space.test, rv.space[box.space.test.id])
+        t.assert_is(rv.space.test.index.pk, rv.space.test.index[0])
+        t.assert_equals(rv.space.test.index.grp.unique, false)
+        t.assert_equals(rv.space.test.index.hash.type, 'HASH')
+        t.assert_is_not(rv.space._space, nil)
+    end)
+end
+
+g.test_read = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        local s = rv.space.test
+        t.assert_equals(s:get(5), {5, 2, 50})
+        t.assert_equals(s:get({5}).val, 50)
+        t.assert_equals(s:get(100), nil)
+        t.assert_equals(s.index.hash:get(30), {3, 0, 30})
+        t.assert_equals(s:select({}, {limit = 2}), {{1, 1, 10}, {2, 2, 20}})
+        t.assert_equals(s:select({8}, {iterator = 'ge'}),
+                        {{8, 2, 80}, {9, 0, 90}, {10, 1, 100}})
+        t.assert_equals(s:select({3}, {iterator = 'lt'}),
+                        {{2, 2, 20}, {1, 1, 10}})
+        t.assert_equals(s:select({}, {iterator = 'le', offset = 8}),
+                        {{2, 2, 20}, {1, 1, 10}})
+        t.assert_equals(s.index.grp:select(0),
+                        {{3, 0, 30}, {6, 0, 60}, {9, 0, 90}})
+        t.assert_equals(s.index.grp:select(1, {iterator = 'req'}),
+                        {{10, 1, 100}, {7, 1, 70}, {4, 1, 40},
+                         {1, 1, 10}})
+        t.assert_equals(s.index.hash:select(50), {{5, 2, 50}})
+        t.assert_equals(#s.index.hash:select(), 10)
+        local res = {}
+        for _, tuple in s.index.grp:pairs(2, {iterator = 'gt'}) do
+            table.insert(res, tuple.id)
+        end
+        t.assert_equals(res, {})
+        for _, tuple in s.index.grp:pairs(1, {iterator = 'ge'}) do
+            table.insert(res, tuple.id)
+        end
+        t.assert_equals(res, {1, 4, 7, 10, 2, 5, 8})
+        res = {}
+        for _, tuple in s:pairs({}, {iterator = 'le'}) do
+            table.insert(res, tuple.id)
+        end
+        t.assert_equals(res, {10, 9, 8, 7, 6, 5, 4, 3, 2, 1})
+    end)
+end
+
+g.test_isolation = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        box.space.test:replace({1, 1, 1000})
+        box.space.test:delete({2})
+        box.space.test:insert({11, 2, 110})
+        local s = rv.space.test
+        t.assert_equals(s:get(1), {1, 1, 10})
+        t.assert_equals(s:get(2), {2, 2, 20})
+        t.assert_equals(s:get(11), nil)
+        t.assert_equals(s.index.hash:get(1000), nil)
+        t.assert_equals(#s:select(), 10)
+        box.space.test:replace({1, 1, 10})
+        box.space.test:insert({2, 2, 20})
+        box.space.test:delete({11})
+    end)
+end
+
+g.test_close = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        local s = rv.space.test
+        local gen, param, state = s:pairs()
+        t.assert_equals(select(2, gen(param, state)), {1, 1, 10})
+        rv:close()
+        t.assert_equals(rv.status, 'closed')
+        t.assert_error_msg_equals("The read view is closed", rv.close, rv)
+        t.assert_error_msg_equals("The read view is closed", s.get, s, 1)
+        t.assert_error_msg_equals("The read view is closed", s.select, s)
+        t.assert_error_msg_equals("The read view is closed", s.pairs, s)
+        t.assert_error_msg_equals("The read view is closed",
+                                  gen, param, state)
+    end)
+end
+
+g.test_gc = function(cg)
+    cg.server:exec(function()
+        local count = #box.read_view.list()
+        box.read_view.open()
+        t.assert_equals(#box.read_view.list(), count + 1)
+        collectgarbage('collect')
+        t.assert_equals(#box.read_view.list(), count)
+    end)
+end
+
+g.test_errors = function(cg)
+    cg.server:exec(function()
+        local rv = box.read_view.open()
+        local s = rv.space.test
+        t.assert_error_msg_equals(
+            "Use index:get(...) instead of index.get(...)", s.index.pk.get)
+        t.assert_error_msg_equals(
+            "Use space:select(...) instead of space.select(...)", s.select)
+        t.assert_error_msg_equals(
+            "Get() doesn't support partial keys and non-unique indexes",
+            s.index.grp.get, s.index.grp, 1)
+        t.assert_error_msg_equals(
+            "Invalid key part count in an exact match (expected 1, got 2)",
+            s.get, s, {1, 2})
+        t.assert_error_msg_equals(
+            string.format("Index 'hash' (HASH) of space 'test' (%d) " ..
+                          "does not support requested iterator type",
+                          box.space.test.id),
+            s.index.hash.select, s.index.hash, 10, {iterator = 'ge'})
+        t.assert_error_msg_equals(
+            "Read view does not support pagination",
+            s.select, s, {}, {after = {1}})
+    end)
+end
+
+g.test_c_api = function(cg)
+    cg.server:exec(function()
+        local msgpack = require('msgpack')
+        package.cpath = ('%s/test/box-luatest/?.%s;%s'):format(
+            os.getenv('BUILDDIR'), jit.os == 'OSX' and 'dylib' or 'so',
+            package.cpath)
+        local lib = require('raw_read_view_lib')
+        lib.open('c_api')
+        t.assert_equals(box.read_view.list()[#box.read_view.list()].name,
+                        'c_api')
+        box.space.test:replace({1, 1, 1000})
+        t.assert_equals(lib.sum('test', 'pk', box.index.ALL, {}, 2), 550)
+        t.assert_equals(lib.sum('test', 'grp', box.index.EQ, {1}, 0), 22)
+        t.assert_equals(lib.sum('test', 'pk', box.index.LT, {4}, 2), 60)
+        t.assert_equals(msgpack.decode(lib.get(box.space.test.id, 0, 1)),
+                        {1, 1, 10})
+        t.assert_equals(lib.get(box.space.test.id, 0, 100), nil)
+        t.assert_error_msg_equals("Space 'foo' does not exist",
+                                  lib.sum, 'foo', 'pk', box.index.ALL, {}, 0)
+        t.assert_error_msg_equals(
+            "No index 'foo' is defined in space 'test'",
+            lib.sum, 'test', 'foo', box.index.ALL, {}, 0)
+        local rv = box.read_view.list()[#box.read_view.list()]
+        t.assert_error_msg_equals("The read view is busy", rv.close, rv)
+        lib.close()
+        box.space.test:replace({1, 1, 10})
+    end)
+end
+
+local g_mvcc = t.group('read_view_mvcc')
+
+g_mvcc.before_all(function(cg)
+    cg.server = server:new({box_cfg = {memtx_use_mvcc_engine = true}})
+    cg.server:start()
+end)
+
+g_mvcc.after_all(function(cg)
+    cg.server:drop()
+end)
+
+-- A tuple that isn't visible in a read view must not make a hash index
+-- EQ lookup return another tuple.
+g_mvcc.test_hash_eq_invisible = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.create_space('test')
+        s:create_index('pk', {type = 'hash'})
+        for i = 1, 10 do
+            s:insert({i})
+        end
+        local ch = fiber.channel()
+        local f = fiber.new(function()
+            box.begin()
+            s:insert({100})
+            ch:get()
+            box.rollback()
+        end)
+        f:set_joinable(true)
+        fiber.yield()
+        local rv = box.read_view.open()
+        local rv_s = rv.space.test
+        t.assert_equals(rv_s:get(100), nil)
+        t.assert_equals(rv_s:select(100), {})
+        t.assert_equals(rv_s:select(5), {{5}})
+        t.assert_equals(#rv_s:select(), 10)
+        ch:put(true)
+        f:join()
+        rv:close()
+        s:drop()
     end)
 end
@@ -0,0 +1,63 @@
+local decimal = require('decimal')
+local uuid = require('uuid')
+local t = require('luatest')
+
+local g = t.group()
+
+g.test_field_types = function()
+    local u = uuid.new()
+    local tuple = box.tuple.new({
+        1, -1, 1e13, -1e13, 1.5, 'foo', '', true, false, box.NULL,
+        {1, 2}, {a = 1}, decimal.new('1.1'), u,
+        18446744073709551615ULL, -9223372036854775807LL,
+    })
+    t.assert_equals(tuple[1], 1)
+    t.assert_equals(tuple[2], -1)
+    t.assert_equals(tuple[3], 1e13)
+    t.assert_equals(tuple[4], -1e13)
+    t.assert_equals(tuple[5], 1.5)
+    t.assert_equals(tuple[6], 'foo')
+    t.assert_equals(tuple[7], '')
+    t.assert_is(tuple[8], true)
+    t.assert_is(tuple[9], false)
+    t.assert_equals(type(tuple[10]), 'cdata')
+    t.assert_equals(tuple[10], box.NULL)
+    t.assert_equals(tuple[11], {1, 2})
+    t.assert_equals(tuple[12], {a = 1})
+    t.assert_equals(tuple[13], decimal.new('1.1'))
+    t.assert_equals(tuple[14], u)
+    t.assert_equals(tuple[15], 18446744073709551615ULL)
+    t.assert_equals(tuple[16], -9223372036854775807LL)
+    t.assert_equals(tuple[17], nil)
+    t.assert_equals(tuple[0], nil)
+end
+
+g.test_field_by_name = function()
+    local format = box.tuple.format.new({
+        {'id', 'unsigned'},
+        {'score', 'double'},
+        {'name', 'string'},
+        {'flag', 'boolean', is_nullable = true},
+        {'meta', 'map', is_nullable = true},
+        {'bsize', 'unsigned', is_nullable = true},
+    })
+    local tuple = box.tuple.new({1, 1.5, 'foo', true, {a = {1, 2}}},
+                                {format = format})
+    t.assert_equals(tuple.id, 1)
+    t.assert_equals(tuple.score, 1.5)
+    t.assert_equals(tuple.name, 'foo')
+    t.assert_is(tuple.flag, true)
+    t.assert_equals(tuple.meta, {a = {1, 2}})
+    t.assert_equals(tuple['meta.a'], {1, 2})
+    t.assert_equals(tuple['meta.a[2]'], 2)
+    t.assert_equals(tuple['[3]'], 'foo')
+    t.assert_equals(tuple['meta.b'], nil)
+    t.assert_equals(tuple.foo, nil)
+    t.assert_equals(tuple[''], nil)
+    -- Missing fields don't hide tuple methods.
+    t.assert_equals(tuple:bsize(), box.tuple.bsize(tuple))
+    tuple = box.tuple.new({1, 1.5, 'foo', box.NULL, box.NULL, 10},
+                          {format = format})
+    t.assert_equals(tuple.flag, nil)
+    t.assert_equals(tuple.bsize, 10)
+end
@@ -171,6 +171,8 @@ g.test_defaults = function()
             nonblock = false,
             level = 5,
             format = 'plain',
+            async = false,
+            async_policy = 'drop',
         },
         snapshot = {
             dir = 'var/lib/{{ instance_name }}',
@@ -180,6 +182,7 @@ g.test_defaults = function()
             },
             count = 2,
             snap_io_rate_limit = box.NULL,
+            delta_count = 0,
         },
         iproto = {
             advertise = {
@@ -253,6 +256,8 @@ g.test_defaults = function()
         memtx = {
             memory = 268435456,
             allocator = 'small',
+            huge_pages = 'off',
+            defrag_threshold = 0,
             slab_alloc_granularity = 8,
             slab_alloc_factor = 1.05,
             min_tuple_size = 16,
@@ -258,6 +258,8 @@ g.test_log = function()
             nonblock = true,
             level = 'debug',
             format = 'json',
+            async = true,
+            async_policy = 'block',
             modules = {
                 seven = 'debug',
             },
@@ -296,6 +298,8 @@ g.test_log = function()
         nonblock = false,
         level = 5,
         format = 'plain',
+        async = false,
+        async_policy = 'drop',
     }
     local res = instance_config:apply_default({}).log
     t.assert_equals(res, exp)
@@ -958,6 +962,8 @@ g.test_memtx = function()
         memtx = {
             memory = 1,
             allocator = 'small',
+            huge_pages = '2M',
+            defrag_threshold = 0.5,
             slab_alloc_granularity = 1,
             slab_alloc_factor = 1,
             min_tuple_size = 1,
@@ -971,6 +977,8 @@ g.test_memtx = function()
     local exp = {
         memory = 268435456,
         allocator = 'small',
+        huge_pages = 'off',
+        defrag_threshold = 0,
         slab_alloc_granularity = 8,
         slab_alloc_factor = 1.05,
         min_tuple_size = 16,
@@ -1095,6 +1103,7 @@ g.test_snapshot = function()
             },
             count = 1,
             snap_io_rate_limit = 1,
+            delta_count = 3,
         },
     }
     instance_config:validate(iconfig)
@@ -1108,6 +1117,7 @@ g.test_snapshot = function()
         },
         count = 2,
         snap_io_rate_limit = box.NULL,
+        delta_count = 0,
     }
     local res = instance_config:apply_default({}).snapshot
     t.assert_equals(res, exp)
@@ -0,0 +1,115 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({engine = {'memtx', 'vinyl'}}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function(engine)
+        box.execute(([[CREATE TABLE t (id INT PRIMARY KEY, a INT, b INT)
+                       WITH ENGINE = '%s';]]):format(engine))
+        box.execute([[CREATE INDEX ia ON t(a);]])
+        box.execute([[CREATE INDEX ib ON t(b);]])
+        -- Column a is skewed: almost all rows have a = 0.
+        box.begin()
+        for i = 1, 1000 do
+            box.space.t:insert({i, i > 990 and i or 0, i})
+        end
+        box.commit()
+    end, {cg.params.engine})
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+    end)
+end)
+
+local function query_plan(cg, sql)
+    return cg.server:exec(function(sql)
+        local res, err = box.execute('EXPLAIN QUERY PLAN ' .. sql)
+        t.assert_equals(err, nil)
+        return res.rows[1][4]
+    end, {sql})
+end
+
+g.test_analyze_eq = function(cg)
+    local sql = [[SELECT id FROM t WHERE a = 0 AND b = 5;]]
+    cg.server:exec(function()
+        local _, err = box.execute([[ANALYZE t;]])
+        t.assert_equals(err, nil)
+    end)
+    t.assert_str_contains(query_plan(cg, sql), 'USING INDEX ib (b=?)')
+    t.assert_equals(cg.server:exec(function(sql)
+        return box.execute(sql).rows
+    end, {sql}), {})
+end
+
+g.test_analyze_range = function(cg)
+    local sql = [[SELECT id FROM t WHERE a > 500 AND b > 5;]]
+    cg.server:exec(function()
+        local _, err = box.execute([[ANALYZE;]])
+        t.assert_equals(err, nil)
+    end)
+    t.assert_str_contains(query_plan(cg, sql), 'USING INDEX ia (a>?)')
+    t.assert_equals(cg.server:exec(function(sql)
+        return #box.execute(sql).rows
+    end, {sql}), 10)
+end
+
+g.test_analyze_errors = function(cg)
+    cg.server:exec(function()
+        local _, err = box.execute([[ANALYZE no_such_table;]])
+        t.assert_equals(err.message, "Space 'no_such_table' does not exist")
+        box.schema.user.create('test_user')
+        box.session.su('test_user', function()
+            _, err = box.execute([[ANALYZE t;]])
+        end)
+        box.schema.user.drop('test_user')
+        t.assert_str_contains(err.message,
+                              "Read access to space 't' is denied")
+    end)
+end
+
+-- ANALYZE of all spaces skips spaces the user can't read.
+g.test_analyze_all_unreadable = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY);]])
+        box.schema.user.create('test_user')
+        box.schema.user.grant('test_user', 'read', 'space', 't')
+        local err
+        box.session.su('test_user', function()
+            _, err = box.execute([[ANALYZE;]])
+        end)
+        box.schema.user.drop('test_user')
+        box.execute([[DROP TABLE t2;]])
+        t.assert_equals(err, nil)
+    end)
+    local sql = [[SELECT id FROM t WHERE a > 500 AND b > 5;]]
+    t.assert_str_contains(query_plan(cg, sql), 'USING INDEX ia (a>?)')
+end
+
+-- Statements cached before ANALYZE aren't reused after it.
+g.test_analyze_plan_cache = function(cg)
+    local sql = [[SELECT id FROM t WHERE a = 0 AND b = 5;]]
+    query_plan(cg, sql)
+    local misses = cg.server:exec(function()
+        local misses = box.info.sql().plan_cache.misses
+        local _, err = box.execute([[ANALYZE t;]])
+        t.assert_equals(err, nil)
+        return misses
+    end)
+    t.assert_str_contains(query_plan(cg, sql), 'USING INDEX ib (b=?)')
+    cg.server:exec(function(misses)
+        -- ANALYZE and the query weren't found in the cache.
+        t.assert_equals(box.info.sql().plan_cache.misses, misses + 2)
+    end, {misses})
+end
@@ -0,0 +1,194 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group(nil, t.helpers.matrix({engine = {'memtx', 'vinyl'}}))
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function(engine)
+        box.execute(([[CREATE TABLE t (id INT PRIMARY KEY, i INT, u UNSIGNED,
+                                       d DOUBLE, n NUMBER, s STRING)
+                       WITH ENGINE = '%s';]]):format(engine))
+        box.execute([[CREATE INDEX ts ON t(s);]])
+        local decimal = require('decimal')
+        local ffi = require('ffi')
+        box.begin()
+        for id = 1, 5000 do
+            local n
+            if id % 7 == 0 then
+                n = id + 0.5
+            elseif id % 11 == 0 then
+                n = decimal.new(id) / 4
+            elseif id % 13 ~= 0 then
+                n = id
+            end
+            box.space.t:insert({id, id % 10 ~= 0 and id - 2500 or nil,
+                                id, ffi.cast('double', id / 8), n,
+                                tostring(id)})
+        end
+        box.commit()
+    end, {cg.params.engine})
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function query_plan(cg, sql)
+    return cg.server:exec(function(sql)
+        local res, err = box.execute('EXPLAIN QUERY PLAN ' .. sql)
+        t.assert_equals(err, nil)
+        return res.rows[1][4]
+    end, {sql})
+end
+
+-- Every query is paired with one that is not eligible for batch
+-- execution and must return exactly the same result.
+local queries = {
+    {[[SELECT COUNT(*), COUNT(i), SUM(i), TOTAL(i), AVG(i), MIN(i), MAX(i)
+       FROM t;]],
+     [[SELECT COUNT(*), COUNT(i + 0), SUM(i + 0), TOTAL(i + 0), AVG(i + 0),
+       MIN(i + 0), MAX(i + 0) FROM t;]]},
+    {[[SELECT SUM(d), AVG(d), MIN(d), MAX(d) FROM t WHERE d > 10;]],
+     [[SELECT SUM(d + 0), AVG(d + 0), MIN(d + 0), MAX(d + 0) FROM t
+       WHERE d + 0 > 10;]]},
+    {[[SELECT SUM(n), AVG(n), TOTAL(n), MIN(n), MAX(n), COUNT(n) FROM t
+       WHERE n >= 100.5 AND n < 4000 AND i != 0;]],
+     [[SELECT SUM(n + 0), AVG(n + 0), TOTAL(n + 0), MIN(n + 0), MAX(n + 0),
+       COUNT(n + 0) FROM t WHERE n + 0 >= 100.5 AND n + 0 < 4000
+       AND i + 0 != 0;]]},
+    {[[SELECT COUNT(*), SUM(u) FROM t WHERE 100 < i AND u <= 3000;]],
+     [[SELECT COUNT(*), SUM(u + 0) FROM t WHERE 100 < i + 0
+       AND u + 0 <= 3000;]]},
+    {[[SELECT COUNT(*), SUM(i) FROM t WHERE i = -1.5;]],
+     [[SELECT COUNT(*), SUM(i + 0) FROM t WHERE i + 0 = -1.5;]]},
+}
+
+g.test_batch_aggregate = function(cg)
+    for _, q in ipairs(queries) do
+        t.assert_str_contains(query_plan(cg, q[1]), 'USING BATCH AGGREGATION')
+        t.assert_not_str_contains(query_plan(cg, q[2]), 'BATCH')
+        cg.server:exec(function(batch_sql, row_sql)
+            local res, err = box.execute(batch_sql)
+            t.assert_equals(err, nil)
+            t.assert_equals(res.rows, box.execute(row_sql).rows)
+        end, q)
+    end
+end
+
+g.test_batch_aggregate_not_eligible = function(cg)
+    -- Indexed column, bare column, GROUP BY, DISTINCT and non-numeric
+    -- columns fall back on the regular loop.
+    local sqls = {
+        [[SELECT SUM(i) FROM t WHERE id > 10;]],
+        [[SELECT SUM(i), u FROM t;]],
+        [[SELECT SUM(i) FROM t GROUP BY u;]],
+        [[SELECT SUM(DISTINCT i) FROM t;]],
+        [[SELECT COUNT(s) FROM t;]],
+        [[SELECT SUM(i) FROM t WHERE i > ?;]],
+    }
+    for _, sql in ipairs(sqls) do
+        t.assert_not_str_contains(query_plan(cg, sql), 'BATCH')
+    end
+end
+
+g.test_batch_aggregate_empty = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT COUNT(*), SUM(i), TOTAL(i), AVG(i), MIN(i)
+                      FROM t WHERE i > 1000000;]]
+        t.assert_equals(box.execute(sql).rows, {{0, nil, 0, nil, nil}})
+    end)
+end
+
+g.test_batch_aggregate_overflow = function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, a INT);]])
+        box.space.t2:insert({1, 9223372036854775807LL})
+        box.space.t2:insert({2, 9223372036854775807LL})
+        local res = box.execute([[SELECT SUM(a) FROM t2;]])
+        t.assert_equals(res.rows, {{18446744073709551614ULL}})
+        box.space.t2:insert({3, 9223372036854775807LL})
+        local _, err = box.execute([[SELECT SUM(a) FROM t2;]])
+        t.assert_equals(err.message,
+                        'Failed to execute SQL statement: ' ..
+                        'integer is overflowed')
+        box.execute([[DROP TABLE t2;]])
+    end)
+end
+
+g.test_batch_aggregate_access = function(cg)
+    cg.server:exec(function()
+        box.schema.user.create('test_user')
+        local err
+        box.session.su('test_user', function()
+            _, err = box.execute([[SELECT SUM(i) FROM t;]])
+        end)
+        box.schema.user.drop('test_user')
+        t.assert_str_contains(err.message,
+                              "Read access to space 't' is denied")
+    end)
+end
+
+local g_parallel = t.group('parallel')
+
+g_parallel.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, i INT, d DOUBLE,
+                                      n NUMBER);]])
+        local decimal = require('decimal')
+        local ffi = require('ffi')
+        box.begin()
+        for id = 1, 100000 do
+            local n = id % 3 == 0 and decimal.new(id) / 4 or id
+            box.space.t:insert({id, id % 10 ~= 0 and id % 777 - 300 or nil,
+                                ffi.cast('double', id / 8), n})
+            if id % 1000 == 0 then
+                box.commit()
+                box.begin()
+            end
+        end
+        box.commit()
+    end)
+end)
+
+g_parallel.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g_parallel.test_parallel_scan = function(cg)
+    cg.server:exec(function()
+        local tweaks = require('internal.tweaks')
+        local sqls = {
+            [[SELECT COUNT(*), COUNT(i), SUM(i), TOTAL(i), AVG(i), MIN(i),
+              MAX(i) FROM t;]],
+            [[SELECT SUM(d), AVG(d), MIN(d), MAX(d) FROM t WHERE i > 10;]],
+            [[SELECT SUM(n), AVG(n), MIN(n), MAX(n) FROM t
+              WHERE n < 10000 AND d >= 100;]],
+            [[SELECT COUNT(*), SUM(i) FROM t WHERE i > 1000;]],
+        }
+        local expected = {}
+        for k, sql in ipairs(sqls) do
+            expected[k] = box.execute(sql).rows
+        end
+        box.session.settings.sql_parallel_scan = true
+        for _, threads in ipairs({2, 3, 4, 8}) do
+            tweaks.sql_parallel_scan_threads = threads
+            for k, sql in ipairs(sqls) do
+                local res, err = box.execute(sql)
+                t.assert_equals(err, nil)
+                t.assert_equals(res.rows, expected[k], sql)
+            end
+        end
+        -- Changes made by the current transaction must be visible.
+        box.begin()
+        box.space.t:insert({100001, 1000000, 1, 1})
+        t.assert_equals(box.execute([[SELECT MAX(i) FROM t;]]).rows,
+                        {{1000000}})
+        box.rollback()
+        box.session.settings.sql_parallel_scan = false
+        tweaks.sql_parallel_scan_threads = 4
+    end)
+end
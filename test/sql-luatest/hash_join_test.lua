@@ -0,0 +1,166 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t1 (id INT PRIMARY KEY, a INT);]])
+        box.execute([[CREATE TABLE t2 (id INT PRIMARY KEY, b INT, c INT);]])
+        box.begin()
+        for i = 1, 200 do
+            box.space.t1:insert({i, i})
+        end
+        -- Enough rows for the planner to build an automatic index.
+        for i = 1, 10240 do
+            box.space.t2:insert({i, i % 100 ~= 0 and i % 100 or nil, i})
+        end
+        box.commit()
+    end)
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+local function query_plan(cg, sql)
+    return cg.server:exec(function(sql)
+        local res, err = box.execute('EXPLAIN QUERY PLAN ' .. sql)
+        t.assert_equals(err, nil)
+        local plan = {}
+        for _, row in ipairs(res.rows) do
+            table.insert(plan, row[4])
+        end
+        return table.concat(plan, '\n')
+    end, {sql})
+end
+
+local join_sql = [[SELECT COUNT(*), SUM(c) FROM t1 JOIN t2 ON a = b;]]
+local group_sql = [[SELECT b, COUNT(*) FROM t2 GROUP BY b
+                   ORDER BY 2 DESC, 1 LIMIT 3;]]
+
+local function check_results(cg)
+    cg.server:exec(function(join_sql, group_sql)
+        local count, sum = 0, 0
+        for i = 1, 10240 do
+            if i % 100 ~= 0 then
+                count = count + 1
+                sum = sum + i
+            end
+        end
+        t.assert_equals(box.execute(join_sql).rows, {{count, sum}})
+        t.assert_equals(box.execute(group_sql).rows,
+                        {{1, 103}, {2, 103}, {3, 103}})
+        local sql = [[SELECT COUNT(*) FROM t2 WHERE b IS NULL
+                      GROUP BY b ORDER BY 1;]]
+        t.assert_equals(box.execute(sql).rows, {{102}})
+    end, {join_sql, group_sql})
+end
+
+g.test_hash_join = function(cg)
+    t.assert_str_contains(query_plan(cg, join_sql), 'EPHEMERAL HASH INDEX')
+    check_results(cg)
+end
+
+g.test_hash_group_by = function(cg)
+    t.assert_str_contains(query_plan(cg, group_sql),
+                          'USE HASH TABLE FOR GROUP BY')
+    -- Groups are sorted if the output isn't reordered by ORDER BY.
+    local sql = [[SELECT b, COUNT(*) FROM t2 GROUP BY b ORDER BY b;]]
+    t.assert_str_contains(query_plan(cg, sql), 'USE TEMP B-TREE FOR GROUP BY')
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t3 (id INT PRIMARY KEY, s STRING,
+                                       n NUMBER);]])
+        box.space.t3:insert({1, 'a', 1})
+        box.space.t3:insert({2, 'A', 1.0})
+        box.space.t3:insert({3, 'b', 1.5})
+        box.space.t3:insert({4, 'B', require('decimal').new(1)})
+        local res = box.execute([[SELECT COUNT(*) FROM t3
+                                  GROUP BY s COLLATE "unicode_ci"
+                                  ORDER BY 1;]])
+        t.assert_equals(res.rows, {{2}, {2}})
+        res = box.execute([[SELECT COUNT(*) FROM t3 GROUP BY n ORDER BY 1;]])
+        t.assert_equals(res.rows, {{1}, {3}})
+        box.execute([[DROP TABLE t3;]])
+    end)
+end
+
+g.test_hash_spill = function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server:exec(function()
+        box.error.injection.set('ERRINJ_SQL_HASH_TABLE_MEMORY', 1024)
+    end)
+    check_results(cg)
+    cg.server:exec(function()
+        box.error.injection.set('ERRINJ_SQL_HASH_TABLE_MEMORY', -1)
+    end)
+end
+
+-- Numbers of different types that compare equal must get into the same
+-- chain of the hash table.
+g.test_hash_join_mixed_numbers = function(cg)
+    cg.server:exec(function()
+        local ffi = require('ffi')
+        local decimal = require('decimal')
+        box.execute([[CREATE TABLE t4 (id INT PRIMARY KEY, n NUMBER);]])
+        box.execute([[CREATE TABLE t5 (id INT PRIMARY KEY, n NUMBER);]])
+        box.space.t4:insert({1, decimal.new('0.3')})
+        box.space.t4:insert({2, decimal.new('0.1')})
+        box.space.t4:insert({3, 1152921504606846976ULL})
+        box.space.t4:insert({4, decimal.new('1152921504606846976')})
+        box.space.t4:insert({5, 1.5})
+        box.space.t4:insert({6, decimal.new('0.30000000000000004')})
+        box.begin()
+        for i = 1, 10240 do
+            box.space.t5:insert({i, i + 1000000})
+        end
+        -- The double is equal to 0.3 rounded to 15 digits.
+        box.space.t5:insert({20001, 0.1 + 0.2})
+        box.space.t5:insert({20002, ffi.new('double', 2^60)})
+        box.space.t5:insert({20003, 1152921504606846976ULL})
+        box.space.t5:insert({20004, decimal.new('1.50')})
+        box.space.t5:insert({20005, decimal.new('0.30000000000000004')})
+        box.commit()
+    end)
+    local sql = [[SELECT t4.id, t5.id FROM t4 JOIN t5 ON t4.n = t5.n
+                  ORDER BY 1, 2;]]
+    t.assert_str_contains(query_plan(cg, sql), 'EPHEMERAL HASH INDEX')
+    cg.server:exec(function(sql)
+        t.assert_equals(box.execute(sql).rows, {
+            {1, 20001}, {3, 20002}, {3, 20003}, {4, 20003}, {5, 20004},
+            {6, 20005},
+        })
+        box.execute([[DROP TABLE t4;]])
+        box.execute([[DROP TABLE t5;]])
+    end, {sql})
+end
+
+-- Datetimes are equal if they denote the same moment in any time zone.
+g.test_hash_join_datetime = function(cg)
+    cg.server:exec(function()
+        local datetime = require('datetime')
+        box.execute([[CREATE TABLE t4 (id INT PRIMARY KEY, d DATETIME);]])
+        box.execute([[CREATE TABLE t5 (id INT PRIMARY KEY, d DATETIME);]])
+        box.space.t4:insert({1, datetime.new({year = 2024, hour = 3,
+                                              tzoffset = 180})})
+        box.space.t4:insert({2, datetime.new({year = 2024, hour = 3})})
+        box.begin()
+        for i = 1, 10240 do
+            box.space.t5:insert({i, datetime.new({timestamp = i})})
+        end
+        box.space.t5:insert({20001, datetime.new({year = 2024})})
+        box.space.t5:insert({20002, datetime.new({year = 2024, hour = 1,
+                                                  tzoffset = -120})})
+        box.commit()
+    end)
+    local sql = [[SELECT t4.id, t5.id FROM t4 JOIN t5 ON t4.d = t5.d
+                  ORDER BY 1, 2;]]
+    t.assert_str_contains(query_plan(cg, sql), 'EPHEMERAL HASH INDEX')
+    cg.server:exec(function(sql)
+        t.assert_equals(box.execute(sql).rows, {{1, 20001}, {2, 20002}})
+        box.execute([[DROP TABLE t4;]])
+        box.execute([[DROP TABLE t5;]])
+    end, {sql})
+end
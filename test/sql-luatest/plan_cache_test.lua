@@ -0,0 +1,96 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.before_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[CREATE TABLE t (id INT PRIMARY KEY, a INT);]])
+        box.execute([[INSERT INTO t VALUES (1, 10), (2, 20), (3, 30);]])
+    end)
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        box.execute([[DROP TABLE IF EXISTS t;]])
+        box.cfg{sql_cache_size = 5 * 1024 * 1024}
+        box.session.settings.sql_full_column_names = false
+    end)
+end)
+
+g.test_plan_cache_hit = function(cg)
+    cg.server:exec(function()
+        local function stat()
+            return box.info.sql().plan_cache
+        end
+        local sql = [[SELECT a FROM t WHERE id = ?;]]
+        t.assert_equals(box.execute(sql, {1}).rows, {{10}})
+        local hits = stat().hits
+        local misses = stat().misses
+        t.assert_equals(box.execute(sql, {2}).rows, {{20}})
+        t.assert_equals(stat().hits, hits + 1)
+        -- Whitespace and comments don't matter.
+        local res = box.execute([[SELECT  a
+                                  FROM t /* comment */ WHERE id = ?; -- id
+                                  ]], {3})
+        t.assert_equals(res.rows, {{30}})
+        t.assert_equals(stat().hits, hits + 2)
+        t.assert_equals(stat().misses, misses)
+        -- Literals and letter case do.
+        box.execute([[SELECT a FROM t WHERE id = 1;]])
+        box.execute([[select a from t where id = ?;]], {1})
+        t.assert_equals(stat().hits, hits + 2)
+        t.assert_equals(stat().misses, misses + 2)
+        t.assert_gt(stat().stmt_count, 0)
+        t.assert_gt(stat().size, 0)
+        -- Statements compiled with other session settings aren't reused.
+        box.session.settings.sql_full_column_names = true
+        res = box.execute(sql, {1})
+        t.assert_equals(res.metadata[1].name, 'T.A')
+        t.assert_equals(stat().misses, misses + 3)
+    end)
+end
+
+g.test_plan_cache_schema_change = function(cg)
+    cg.server:exec(function()
+        local sql = [[SELECT * FROM t WHERE id = 1;]]
+        t.assert_equals(box.execute(sql).rows, {{1, 10}})
+        t.assert_equals(box.execute(sql).rows, {{1, 10}})
+        box.execute([[ALTER TABLE t ADD COLUMN b INT;]])
+        local misses = box.info.sql().plan_cache.misses
+        t.assert_equals(box.execute(sql).rows, {{1, 10, nil}})
+        t.assert_equals(box.info.sql().plan_cache.misses, misses + 1)
+        box.execute([[DROP TABLE t;]])
+        local _, err = box.execute(sql)
+        t.assert_equals(err.message, "Space 'T' does not exist")
+    end)
+end
+
+g.test_plan_cache_memory_limit = function(cg)
+    cg.server:exec(function()
+        for i = 1, 100 do
+            box.execute(('SELECT a + %d FROM t;'):format(i))
+        end
+        box.cfg{sql_cache_size = 10000}
+        t.assert_le(box.info.sql().plan_cache.size, 10000)
+        -- Prepared statements have priority over the plan cache.
+        local stmt = box.prepare([[SELECT a, id FROM t;]])
+        t.assert_le(box.info.sql().cache.size +
+                    box.info.sql().plan_cache.size, 10000)
+        box.unprepare(stmt.stmt_id)
+        box.cfg{sql_cache_size = 0}
+        t.assert_equals(box.info.sql().plan_cache.size, 0)
+        t.assert_equals(box.info.sql().plan_cache.stmt_count, 0)
+        box.execute([[SELECT a FROM t;]])
+        t.assert_equals(box.info.sql().plan_cache.stmt_count, 0)
+    end)
+end
@@ -192,7 +192,7 @@ test:do_execsql_test(
         EXPLAIN QUERY PLAN SELECT count(b) FROM t1;
     ]], {
         -- <4.1>
-        0, 0, 0, "SCAN TABLE T1"
+        0, 0, 0, "SCAN TABLE T1 USING BATCH AGGREGATION"
         -- </4.1>
     })
 
@@ -215,7 +215,7 @@ test:do_execsql_test(
         EXPLAIN QUERY PLAN SELECT count(b) FROM t1;
     ]], {
         -- <4.3>
-        0, 0, 0, "SCAN TABLE T1"
+        0, 0, 0, "SCAN TABLE T1 USING BATCH AGGREGATION"
         -- </4.3>
     })
 
@@ -244,7 +244,7 @@ test:do_execsql_test(
         SELECT count(b) FROM t1;
     ]], {
         -- <5.1>
-        0, 0, 0, "SCAN TABLE T1"
+        0, 0, 0, "SCAN TABLE T1 USING BATCH AGGREGATION"
         -- </5.1>
     })
 
@@ -267,7 +267,7 @@ test:do_execsql_test(
         EXPLAIN QUERY PLAN SELECT count(b) FROM t1;
     ]], {
         -- <5.3>
-        0, 0, 0, "SCAN TABLE T1"
+        0, 0, 0, "SCAN TABLE T1 USING BATCH AGGREGATION"
         -- </5.3>
     })
 
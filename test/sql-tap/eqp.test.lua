@@ -187,7 +187,7 @@ test:do_execsql_test(
 test:do_eqp_test("2.2.1",
     "SELECT DISTINCT MIN(X), MAX(X) FROM T1 GROUP BY X ORDER BY 1", {
     {0, 0, 0, "SCAN TABLE T1 (~1048576 rows)"},
-    {0, 0, 0, "USE TEMP B-TREE FOR GROUP BY"},
+    {0, 0, 0, "USE HASH TABLE FOR GROUP BY"},
     {0, 0, 0, "USE TEMP B-TREE FOR DISTINCT"},
     {0, 0, 0, "USE TEMP B-TREE FOR ORDER BY"},
 })
@@ -227,7 +227,7 @@ test:do_eqp_test("2.3.2", "SELECT MIN(X) FROM T2", {
     {0, 0, 0, "SEARCH TABLE T2 USING COVERING INDEX T2I1 (~1048576 rows)"},
 })
 test:do_eqp_test("2.3.3", "SELECT MIN(X), MAX(X) FROM T2", {
-    {0, 0, 0, "SCAN TABLE T2 (~1048576 rows)"},
+    {0, 0, 0, "SCAN TABLE T2 USING BATCH AGGREGATION"},
 })
 test:do_eqp_test("2.4.1", "SELECT * FROM T1 WHERE IDT1=?", {
     {0, 0, 0, "SEARCH TABLE T1 USING PRIMARY KEY (IDT1=?) (~1 row)"},
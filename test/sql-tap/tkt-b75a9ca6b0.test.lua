@@ -41,6 +41,7 @@ test:do_execsql_test(
 local idxscan = {0, 0, 0, "SCAN TABLE t1 USING COVERING INDEX i1 (~1048576 rows)"}
 local tblscan = {0, 0, 0, "SCAN TABLE t1 (~1048576 rows)"}
 local grpsort = {0, 0, 0, "USE TEMP B-TREE FOR GROUP BY"}
+local grphash = {0, 0, 0, "USE HASH TABLE FOR GROUP BY"}
 local sort = {0, 0, 0, "USE TEMP B-TREE FOR ORDER BY"}
 local eqps = {
     {"SELECT x,y FROM t1 GROUP BY x, y ORDER BY x,y", {1, 3,  2, 2,  3, 1}, {idxscan}},
@@ -52,7 +53,7 @@ local eqps = {
     {"SELECT x,y FROM t1 GROUP BY y ORDER BY y", {3, 1, 2, 2, 1, 3}, {tblscan, grpsort}},
     -- idxscan->tblscan after reorderind indexes list
     -- but it does not matter (because it does full scan)
-    {"SELECT x,y FROM t1 GROUP BY y ORDER BY x", {1, 3, 2, 2, 3, 1}, {tblscan, grpsort, sort}},
+    {"SELECT x,y FROM t1 GROUP BY y ORDER BY x", {1, 3, 2, 2, 3, 1}, {tblscan, grphash, sort}},
     {"SELECT x,y FROM t1 GROUP BY x, y ORDER BY x, y DESC", {1, 3, 2, 2, 3, 1}, {idxscan, sort}},
     {"SELECT x,y FROM t1 GROUP BY x, y ORDER BY x DESC, y DESC", {3, 1, 2, 2, 1, 3}, {idxscan, sort}},
     {"SELECT x,y FROM t1 GROUP BY x, y ORDER BY x ASC, y ASC", {1, 3, 2, 2, 3, 1}, {idxscan}},
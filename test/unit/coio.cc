@@ -7,6 +7,7 @@
 #include "iostream.h"
 
 #include <fcntl.h>
+#include <pmatomic.h>
 #include <sys/uio.h>
 #include <sys/wait.h>
 #include <sys/errno.h>
@@ -280,6 +281,153 @@ read_write_test(void)
 	footer();
 }
 
+/** Set when the task blocking the coio worker is running. */
+static bool blocker_is_running;
+/** Set to let the task blocking the coio worker finish. */
+static bool blocker_is_released;
+
+static ssize_t
+blocker_f(va_list ap)
+{
+	(void)ap;
+	pm_atomic_store(&blocker_is_running, true);
+	while (!pm_atomic_load(&blocker_is_released))
+		usleep(1000);
+	return 0;
+}
+
+static int
+blocker_fiber_f(va_list ap)
+{
+	(void)ap;
+	return coio_call(blocker_f);
+}
+
+/** Lanes of tasks in the order they were run by the coio worker. */
+static enum coio_lane lane_order[coio_lane_MAX];
+static int lane_order_len;
+
+static int
+lane_task_cb(struct coio_task *task)
+{
+	/* There's only one worker, no need to synchronize. */
+	lane_order[lane_order_len++] = task->lane;
+	return 0;
+}
+
+static int
+lane_task_timeout_cb(struct coio_task *task)
+{
+	(void)task;
+	unreachable();
+	return 0;
+}
+
+static int
+lane_fiber_f(va_list ap)
+{
+	enum coio_lane lane = (enum coio_lane)va_arg(ap, int);
+	struct coio_task task;
+	coio_task_create(&task, lane_task_cb, lane_task_timeout_cb);
+	task.lane = lane;
+	int rc = coio_task_execute(&task, TIMEOUT_INFINITY);
+	coio_task_destroy(&task);
+	return rc;
+}
+
+static void
+test_lanes(void)
+{
+	header();
+	plan(5);
+
+	struct coio_lane_stat stat_before[coio_lane_MAX];
+	coio_pool_stat(stat_before);
+
+	coio_set_worker_count(1);
+	/* Occupy the only worker while tasks are queued. */
+	struct fiber *blocker = fiber_new_xc("blocker", blocker_fiber_f);
+	fiber_set_joinable(blocker, true);
+	fiber_start(blocker);
+	while (!pm_atomic_load(&blocker_is_running))
+		fiber_sleep(0.001);
+
+	enum coio_lane lanes[] = {
+		COIO_LANE_BULK, COIO_LANE_NORMAL, COIO_LANE_HIGH,
+	};
+	struct fiber *fibers[lengthof(lanes)];
+	for (size_t i = 0; i < lengthof(lanes); i++) {
+		fibers[i] = fiber_new_xc("lane", lane_fiber_f);
+		fiber_set_joinable(fibers[i], true);
+		fiber_start(fibers[i], (int)lanes[i]);
+	}
+	pm_atomic_store(&blocker_is_released, true);
+	is(fiber_join(blocker), 0, "blocker");
+	int rc = 0;
+	for (size_t i = 0; i < lengthof(lanes); i++)
+		rc |= fiber_join(fibers[i]);
+	is(rc, 0, "lane tasks");
+	ok(lane_order_len == 3 && lane_order[0] == COIO_LANE_HIGH &&
+	   lane_order[1] == COIO_LANE_NORMAL &&
+	   lane_order[2] == COIO_LANE_BULK,
+	   "tasks are run in the order of lane priority");
+
+	struct coio_lane_stat stat[coio_lane_MAX];
+	coio_pool_stat(stat);
+	ok(stat[COIO_LANE_HIGH].count == stat_before[COIO_LANE_HIGH].count + 1 &&
+	   stat[COIO_LANE_NORMAL].count ==
+	   stat_before[COIO_LANE_NORMAL].count + 2 &&
+	   stat[COIO_LANE_BULK].count == stat_before[COIO_LANE_BULK].count + 1,
+	   "task count stat");
+	ok(stat[COIO_LANE_BULK].wait_max > 0 &&
+	   stat[COIO_LANE_NORMAL].exec_max > 0, "latency stat");
+
+	coio_set_worker_count(COIO_WORKER_COUNT_DEFAULT);
+	check_plan();
+	footer();
+}
+
+static ssize_t
+sleep_f(va_list ap)
+{
+	usleep(va_arg(ap, int));
+	return 0;
+}
+
+static int
+sleep_fiber_f(va_list ap)
+{
+	int usec = va_arg(ap, int);
+	return coio_call(sleep_f, usec);
+}
+
+static void
+test_concurrent_calls(void)
+{
+	header();
+	plan(1);
+
+	/*
+	 * Tasks are pushed to the workers in round-robin, so
+	 * short tasks queued behind long ones have to be stolen
+	 * by other workers to complete first.
+	 */
+	enum { FIBER_COUNT = 64 };
+	struct fiber *fibers[FIBER_COUNT];
+	for (int i = 0; i < FIBER_COUNT; i++) {
+		fibers[i] = fiber_new_xc("sleep", sleep_fiber_f);
+		fiber_set_joinable(fibers[i], true);
+		fiber_start(fibers[i], i % 8 == 0 ? 10000 : 10);
+	}
+	int rc = 0;
+	for (int i = 0; i < FIBER_COUNT; i++)
+		rc |= fiber_join(fibers[i]);
+	is(rc, 0, "concurrent calls");
+
+	check_plan();
+	footer();
+}
+
 static int
 main_f(va_list ap)
 {
@@ -301,9 +449,12 @@ main_f(va_list ap)
 
 	test_getaddrinfo();
 	test_connect();
+	test_lanes();
+	test_concurrent_calls();
 
 	read_write_test();
 
+	coio_shutdown();
 	ev_break(loop(), EVBREAK_ALL);
 	return 0;
 }
@@ -537,7 +537,7 @@ static void
 fiber_test_leak_modes()
 {
 	say_logger_init("log.txt", S_ERROR,
-			/* nonblock =*/ 0, "plain");
+			/* nonblock =*/ 0, "plain", NULL);
 
 	/*
 	 * Run two times even when ENABLE_BACKTRACE is not defined as
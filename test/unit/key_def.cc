@@ -1397,10 +1397,83 @@ test_key_def_find_by_fieldno(void)
 	check_plan();
 }
 
+/**
+ * Checks comparison of tuples by a key part of each field type: the
+ * result must match tuple_compare_field().
+ */
+static void
+test_tuple_compare_field_types(bool is_nullable)
+{
+	struct {
+		const char *type;
+		struct tuple *lt;
+		struct tuple *gt;
+	} cases[] = {
+		{"unsigned", test_tuple_new("[%u%u]", 0, 1),
+			     test_tuple_new("[%u%u]", 0, 2)},
+		{"uint8", test_tuple_new("[%u%u]", 0, 10),
+			  test_tuple_new("[%u%u]", 0, 200)},
+		{"integer", test_tuple_new("[%u%d]", 0, -2),
+			    test_tuple_new("[%u%u]", 0, 1)},
+		{"int64", test_tuple_new("[%u%d]", 0, -5),
+			  test_tuple_new("[%u%d]", 0, -4)},
+		{"number", test_tuple_new("[%u%f]", 0, 1.5),
+			   test_tuple_new("[%u%u]", 0, 2)},
+		{"double", test_tuple_new("[%u%lf]", 0, -1.0),
+			   test_tuple_new("[%u%lf]", 0, 0.5)},
+		{"boolean", test_tuple_new("[%u%b]", 0, false),
+			    test_tuple_new("[%u%b]", 0, true)},
+		{"string", test_tuple_new("[%u%s]", 0, "abc"),
+			   test_tuple_new("[%u%s]", 0, "abd")},
+		{"scalar", test_tuple_new("[%u%u]", 0, 100),
+			   test_tuple_new("[%u%s]", 0, "a")},
+	};
+	plan(lengthof(cases) * 2 + (is_nullable ? lengthof(cases) : 0));
+	header();
+
+	struct tuple *null_tuple = test_tuple_new("[%uNIL]", 0);
+	for (size_t i = 0; i < lengthof(cases); i++) {
+		struct tuple *lt = cases[i].lt;
+		struct tuple *gt = cases[i].gt;
+		struct key_def *key_def = test_key_def_new(
+			"[{%s%u%s%s%s%b}]", "field", 1, "type", cases[i].type,
+			"is_nullable", is_nullable);
+		int expected = tuple_compare_field(tuple_field(lt, 1),
+						   tuple_field(gt, 1),
+						   key_def->parts[0].type,
+						   NULL);
+		fail_unless(expected < 0);
+		ok(tuple_compare(lt, HINT_NONE, gt, HINT_NONE, key_def) < 0 &&
+		   tuple_compare(gt, HINT_NONE, lt, HINT_NONE, key_def) > 0 &&
+		   tuple_compare(lt, HINT_NONE, lt, HINT_NONE, key_def) == 0,
+		   "tuple_compare(%s, %s), type %s", tuple_str(lt),
+		   tuple_str(gt), cases[i].type);
+		const char *key = tuple_field(gt, 1);
+		ok(tuple_compare_with_key(lt, HINT_NONE, key, 1, HINT_NONE,
+					  key_def) < 0,
+		   "tuple_compare_with_key(%s, %s), type %s", tuple_str(lt),
+		   tuple_str(gt), cases[i].type);
+		if (is_nullable) {
+			ok(tuple_compare(null_tuple, HINT_NONE, lt, HINT_NONE,
+					 key_def) < 0,
+			   "tuple_compare(%s, %s), type %s",
+			   tuple_str(null_tuple), tuple_str(lt),
+			   cases[i].type);
+		}
+		key_def_delete(key_def);
+		tuple_delete(lt);
+		tuple_delete(gt);
+	}
+	tuple_delete(null_tuple);
+
+	footer();
+	check_plan();
+}
+
 static int
 test_main(void)
 {
-	plan(51);
+	plan(53);
 	header();
 
 	test_func_compare();
@@ -1454,6 +1527,8 @@ test_main(void)
 	test_key_compare_singlepart(false, true);
 	test_key_compare_singlepart(false, false);
 	test_key_def_find_by_fieldno();
+	test_tuple_compare_field_types(false);
+	test_tuple_compare_field_types(true);
 
 	footer();
 	return check_plan();
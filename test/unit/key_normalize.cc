@@ -0,0 +1,433 @@
+#include <math.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "coll/coll.h"
+#include "coll/coll_def.h"
+#include "core/datetime.h"
+#include "core/decimal.h"
+#include "fiber.h"
+#include "key_def.h"
+#include "key_normalize.h"
+#include "memory.h"
+#include "mp_datetime.h"
+#include "mp_decimal.h"
+#include "mp_uuid.h"
+#include "msgpuck.h"
+#include "small/region.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "tuple_compare.h"
+#include "tt_uuid.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+/** Encoded values in ascending order, except for equal neighbours. */
+static std::vector<std::string> values;
+/** Encoded decimals in ascending order. */
+static std::vector<std::string> decimals;
+
+static void
+add_value(const char *data, const char *end)
+{
+	values.push_back(std::string(data, end - data));
+}
+
+static void
+add_decimal(const char *str)
+{
+	decimal_t dec;
+	fail_if(decimal_from_string(&dec, str) == NULL);
+	char buf[64];
+	char *end = mp_encode_decimal(buf, &dec);
+	decimals.push_back(std::string(buf, end - buf));
+}
+
+static void
+init_values(void)
+{
+	char buf[64];
+	char *end;
+	end = mp_encode_nil(buf);
+	add_value(buf, end);
+	end = mp_encode_bool(buf, false);
+	add_value(buf, end);
+	end = mp_encode_bool(buf, true);
+	add_value(buf, end);
+	end = mp_encode_double(buf, -INFINITY);
+	add_value(buf, end);
+	end = mp_encode_double(buf, -ldexp(1, 64));
+	add_value(buf, end);
+	end = mp_encode_int(buf, INT64_MIN);
+	add_value(buf, end);
+	end = mp_encode_double(buf, -ldexp(1, 63));
+	add_value(buf, end);
+	end = mp_encode_int(buf, -1000000);
+	add_value(buf, end);
+	end = mp_encode_float(buf, -100.5);
+	add_value(buf, end);
+	end = mp_encode_int(buf, -100);
+	add_value(buf, end);
+	end = mp_encode_double(buf, -100);
+	add_value(buf, end);
+	end = mp_encode_int(buf, -1);
+	add_value(buf, end);
+	end = mp_encode_double(buf, -1e-10);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, 0);
+	add_value(buf, end);
+	end = mp_encode_double(buf, 0);
+	add_value(buf, end);
+	end = mp_encode_double(buf, 1e-10);
+	add_value(buf, end);
+	end = mp_encode_double(buf, 0.5);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, 1);
+	add_value(buf, end);
+	end = mp_encode_float(buf, 1.5);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, 10);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, 11);
+	add_value(buf, end);
+	end = mp_encode_double(buf, 1e15);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, (UINT64_C(1) << 53) + 1);
+	add_value(buf, end);
+	end = mp_encode_double(buf, ldexp(1, 53) + 2);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, INT64_MAX);
+	add_value(buf, end);
+	end = mp_encode_double(buf, ldexp(1, 63));
+	add_value(buf, end);
+	end = mp_encode_uint(buf, UINT64_C(1) << 63);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, (UINT64_C(1) << 63) + 1);
+	add_value(buf, end);
+	end = mp_encode_uint(buf, UINT64_MAX);
+	add_value(buf, end);
+	end = mp_encode_double(buf, ldexp(1, 64));
+	add_value(buf, end);
+	end = mp_encode_double(buf, ldexp(1, 100));
+	add_value(buf, end);
+	end = mp_encode_double(buf, 1e300);
+	add_value(buf, end);
+	end = mp_encode_double(buf, INFINITY);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "", 0);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "\0", 1);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "\0\0", 2);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "\0a", 2);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "a", 1);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "a\0", 2);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "ab", 2);
+	add_value(buf, end);
+	end = mp_encode_str(buf, "\xff", 1);
+	add_value(buf, end);
+	end = mp_encode_bin(buf, "", 0);
+	add_value(buf, end);
+	end = mp_encode_bin(buf, "\0", 1);
+	add_value(buf, end);
+	end = mp_encode_bin(buf, "abc", 3);
+	add_value(buf, end);
+	struct tt_uuid uuid;
+	fail_if(tt_uuid_from_string("00000000-0000-0000-0000-000000000001",
+				    &uuid) != 0);
+	end = mp_encode_uuid(buf, &uuid);
+	add_value(buf, end);
+	fail_if(tt_uuid_from_string("f0000000-0000-0000-0000-000000000000",
+				    &uuid) != 0);
+	end = mp_encode_uuid(buf, &uuid);
+	add_value(buf, end);
+	struct datetime date;
+	memset(&date, 0, sizeof(date));
+	date.epoch = -100;
+	date.nsec = 5;
+	end = mp_encode_datetime(buf, &date);
+	add_value(buf, end);
+	date.epoch = 0;
+	date.nsec = 0;
+	end = mp_encode_datetime(buf, &date);
+	add_value(buf, end);
+	date.nsec = 1;
+	end = mp_encode_datetime(buf, &date);
+	add_value(buf, end);
+	date.epoch = 1700000000;
+	end = mp_encode_datetime(buf, &date);
+	add_value(buf, end);
+
+	add_decimal("-1000000000000000000000000.5");
+	add_decimal("-1.5");
+	add_decimal("-0.001");
+	add_decimal("0.00");
+	add_decimal("0.1");
+	add_decimal("0.10000000000000000555");
+	add_decimal("1.0");
+	add_decimal("11");
+	add_decimal("11.000000000000000000000000000000000001");
+	add_decimal("1e37");
+}
+
+/** Creates a tuple out of encoded fields. */
+static struct tuple *
+test_tuple_new(const std::string &a, const std::string &b)
+{
+	std::string data(1, '\x92');
+	data += a;
+	data += b;
+	struct tuple *tuple = tuple_new(tuple_format_runtime, data.data(),
+					data.data() + data.size());
+	fail_if(tuple == NULL);
+	return tuple;
+}
+
+static struct key_def *
+test_key_def_new(enum field_type type, enum sort_order order_a,
+		 enum sort_order order_b)
+{
+	struct key_part_def parts[2];
+	for (uint32_t i = 0; i < 2; i++) {
+		parts[i] = key_part_def_default;
+		parts[i].fieldno = i;
+		parts[i].type = type;
+		parts[i].is_nullable = true;
+		parts[i].sort_order = i == 0 ? order_a : order_b;
+	}
+	struct key_def *def = key_def_new(parts, 2, 0);
+	fail_if(def == NULL);
+	return def;
+}
+
+static int
+sign(int r)
+{
+	return r > 0 ? 1 : r < 0 ? -1 : 0;
+}
+
+/**
+ * Checks that memcmp() of normalized keys orders all pairs of tuples
+ * built from the given values like tuple_compare() does and that
+ * a normalized partial key is a prefix of the normalized tuple key.
+ */
+static void
+test_check_order(struct key_def *def, const std::vector<std::string> &vals,
+		 const char *name)
+{
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	std::vector<struct tuple *> tuples;
+	std::vector<std::string> keys;
+	for (size_t i = 0; i < vals.size(); i++) {
+		struct tuple *tuple =
+			test_tuple_new(vals[i], vals[vals.size() - i - 1]);
+		tuple_ref(tuple);
+		tuples.push_back(tuple);
+		uint32_t size;
+		char *key = tuple_normalize_key(tuple, def, MULTIKEY_NONE,
+						region, &size);
+		fail_if(key == NULL);
+		keys.push_back(std::string(key, size));
+	}
+	int mismatch = 0;
+	for (size_t i = 0; i < tuples.size(); i++) {
+		for (size_t j = 0; j < tuples.size(); j++) {
+			int expected = sign(tuple_compare(tuples[i], HINT_NONE,
+							  tuples[j], HINT_NONE,
+							  def));
+			int r = sign(normalized_key_compare(
+				keys[i].data(), keys[i].size(),
+				keys[j].data(), keys[j].size()));
+			if (expected == 0)
+				r = keys[i] == keys[j] ? 0 : 2;
+			if (r != expected)
+				mismatch++;
+		}
+	}
+	is(mismatch, 0, "%s: tuple order", name);
+	mismatch = 0;
+	for (size_t i = 0; i < tuples.size(); i++) {
+		uint32_t size;
+		char *key = key_normalize(vals[i].data(), 1, def, region,
+					  &size);
+		fail_if(key == NULL);
+		if (size > keys[i].size() ||
+		    memcmp(key, keys[i].data(), size) != 0)
+			mismatch++;
+	}
+	is(mismatch, 0, "%s: partial key is a prefix", name);
+	for (struct tuple *tuple : tuples)
+		tuple_unref(tuple);
+	region_truncate(region, region_svp);
+}
+
+static void
+test_scalar(void)
+{
+	plan(6);
+	header();
+
+	struct key_def *def;
+	def = test_key_def_new(FIELD_TYPE_SCALAR, SORT_ORDER_ASC,
+			       SORT_ORDER_ASC);
+	test_check_order(def, values, "asc, asc");
+	key_def_delete(def);
+	def = test_key_def_new(FIELD_TYPE_SCALAR, SORT_ORDER_DESC,
+			       SORT_ORDER_ASC);
+	test_check_order(def, values, "desc, asc");
+	key_def_delete(def);
+	def = test_key_def_new(FIELD_TYPE_SCALAR, SORT_ORDER_ASC,
+			       SORT_ORDER_DESC);
+	test_check_order(def, values, "asc, desc");
+	key_def_delete(def);
+
+	footer();
+	check_plan();
+}
+
+static void
+test_decimal(void)
+{
+	plan(4);
+	header();
+
+	struct key_def *def;
+	def = test_key_def_new(FIELD_TYPE_DECIMAL, SORT_ORDER_ASC,
+			       SORT_ORDER_ASC);
+	test_check_order(def, decimals, "decimal asc, asc");
+	key_def_delete(def);
+	def = test_key_def_new(FIELD_TYPE_DECIMAL, SORT_ORDER_DESC,
+			       SORT_ORDER_ASC);
+	test_check_order(def, decimals, "decimal desc, asc");
+	key_def_delete(def);
+
+	footer();
+	check_plan();
+}
+
+/**
+ * Checks that keys which may need a double to be compared with
+ * a decimal aren't normalized.
+ */
+static void
+test_double_decimal(void)
+{
+	plan(4);
+	header();
+
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	char buf[64];
+	char *end = mp_encode_double(buf, 0.1);
+	std::string dbl(buf, end - buf);
+	const std::string &dec = decimals[4];
+	uint32_t size;
+
+	struct key_def *def = test_key_def_new(FIELD_TYPE_SCALAR,
+					       SORT_ORDER_ASC, SORT_ORDER_ASC);
+	struct tuple *tuple = test_tuple_new(dbl, dec);
+	tuple_ref(tuple);
+	is(tuple_normalize_key(tuple, def, MULTIKEY_NONE, region, &size),
+	   NULL, "scalar tuple with a decimal");
+	tuple_unref(tuple);
+	ok(key_normalize(dbl.data(), 1, def, region, &size) != NULL,
+	   "scalar key with a double");
+	is(key_normalize(dec.data(), 1, def, region, &size), NULL,
+	   "scalar key with a decimal");
+	key_def_delete(def);
+
+	def = test_key_def_new(FIELD_TYPE_DECIMAL, SORT_ORDER_ASC,
+			       SORT_ORDER_ASC);
+	is(key_normalize(dbl.data(), 1, def, region, &size), NULL,
+	   "decimal key with a double");
+	key_def_delete(def);
+	region_truncate(region, region_svp);
+
+	footer();
+	check_plan();
+}
+
+static void
+test_collation(void)
+{
+	plan(2);
+	header();
+
+	struct coll_def coll_def;
+	memset(&coll_def, 0, sizeof(coll_def));
+	snprintf(coll_def.locale, sizeof(coll_def.locale), "%s", "ru_RU");
+	coll_def.type = COLL_TYPE_ICU;
+	coll_def.icu.strength = COLL_ICU_STRENGTH_PRIMARY;
+	struct coll *coll = coll_new(&coll_def);
+	fail_if(coll == NULL);
+
+	std::vector<std::string> vals;
+	const char *strs[] = {
+		"", "a", "A", "ab", "Б", "бб", "е", "ё", "Ё", "ЕЕЕЕ", "и",
+	};
+	for (const char *s : strs) {
+		char buf[64];
+		char *end = mp_encode_str0(buf, s);
+		vals.push_back(std::string(buf, end - buf));
+	}
+	/* A long string to check sort key buffer growth. */
+	std::string long_str;
+	for (int i = 0; i < 1000; i++)
+		long_str += "Ж";
+	char buf[8];
+	char *end = mp_encode_strl(buf, long_str.size());
+	vals.push_back(std::string(buf, end - buf) + long_str);
+
+	struct key_def *def = test_key_def_new(FIELD_TYPE_STRING,
+					       SORT_ORDER_ASC, SORT_ORDER_DESC);
+	for (uint32_t i = 0; i < def->part_count; i++)
+		def->parts[i].coll = coll;
+	key_def_set_compare_func(def);
+	test_check_order(def, vals, "ru_RU primary");
+	key_def_delete(def);
+	coll_unref(coll);
+
+	footer();
+	check_plan();
+}
+
+static int
+test_main(void)
+{
+	plan(4);
+	header();
+
+	init_values();
+	test_scalar();
+	test_decimal();
+	test_double_decimal();
+	test_collation();
+
+	footer();
+	return check_plan();
+}
+
+int
+main(void)
+{
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	coll_init();
+	tuple_init(NULL);
+
+	int rc = test_main();
+
+	tuple_free();
+	coll_free();
+	fiber_free();
+	memory_free();
+	return rc;
+}
@@ -583,7 +583,8 @@ test_main()
 int
 main()
 {
-	say_logger_init("/dev/null", S_INFO, /*nonblock=*/true, "plain");
+	say_logger_init("/dev/null", S_INFO, /*nonblock=*/true, "plain",
+			NULL);
 	clock_lowres_signal_init();
 	memory_init();
 	fiber_init(fiber_c_invoke);
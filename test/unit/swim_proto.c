@@ -257,7 +257,7 @@ main()
 	int fd = open("log.txt", O_TRUNC);
 	if (fd != -1)
 		close(fd);
-	say_logger_init("log.txt", 6, 1, "plain");
+	say_logger_init("log.txt", 6, 1, "plain", NULL);
 
 	swim_test_member_def();
 	swim_test_meta();
@@ -866,7 +866,7 @@ swim_run_test(const char *log_file, fiber_func test)
 	int fd = open(log_file, O_TRUNC);
 	if (fd != -1)
 		close(fd);
-	say_logger_init(log_file, 5, 1, "plain");
+	say_logger_init(log_file, 5, 1, "plain", NULL);
 	/*
 	 * Print the seed to be able to reproduce a bug with the
 	 * same seed.
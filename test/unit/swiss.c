@@ -0,0 +1,363 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "trivia/util.h"
+
+#define UNIT_TAP_COMPATIBLE 1
+#include "unit.h"
+
+static const size_t extent_size = 1024;
+
+struct data {
+	int key;
+	int val;
+};
+
+static inline uint32_t
+hash(int key)
+{
+	/* Spread keys over groups and control bytes. */
+	return (uint32_t)key * 2654435761u;
+}
+
+static bool
+equal(struct data a, struct data b)
+{
+	return a.key == b.key;
+}
+
+static bool
+equal_key(struct data a, int b)
+{
+	return a.key == b;
+}
+
+#define SWISS_NAME
+#define SWISS_DATA_TYPE struct data
+#define SWISS_KEY_TYPE int
+#define SWISS_CMP_ARG_TYPE void *
+#define SWISS_EQUAL(a, b, arg) equal(a, b)
+#define SWISS_EQUAL_KEY(a, b, arg) equal_key(a, b)
+#include "salad/swiss.h"
+
+static void *
+alloc_extent(void *ctx)
+{
+	(void)ctx;
+	return xmalloc(extent_size);
+}
+
+static void
+free_extent(void *ctx, void *p)
+{
+	(void)ctx;
+	free(p);
+}
+
+static void
+swiss_do_create(struct swiss_core *ht)
+{
+	swiss_create(ht, NULL, extent_size, alloc_extent, free_extent,
+		     NULL, NULL);
+}
+
+static void
+swiss_do_insert(struct swiss_core *ht, int key, int val)
+{
+	struct data data = {key, val};
+	fail_if(swiss_insert(ht, hash(key), data) == swiss_end);
+}
+
+static void
+swiss_do_delete(struct swiss_core *ht, int key)
+{
+	uint32_t slot = swiss_find_key(ht, hash(key), key);
+	fail_if(slot == swiss_end);
+	fail_if(swiss_delete(ht, slot) != 0);
+}
+
+static void
+test_basic(void)
+{
+	plan(7);
+	header();
+
+	struct swiss_core ht;
+	swiss_do_create(&ht);
+	is(swiss_find_key(&ht, hash(1), 1), swiss_end, "empty table lookup");
+	is(swiss_random(&ht, 1), swiss_end, "empty table random");
+
+	for (int i = 0; i < 10000; i++)
+		swiss_do_insert(&ht, i, i * 2);
+	is(swiss_count(&ht), 10000, "count after insert");
+	is(swiss_selfcheck(&ht), 0, "selfcheck after insert");
+
+	bool success = true;
+	for (int i = 0; i < 20000; i++) {
+		uint32_t slot = swiss_find_key(&ht, hash(i), i);
+		if (i < 10000) {
+			if (slot == swiss_end ||
+			    swiss_get(&ht, slot).val != i * 2)
+				success = false;
+		} else if (slot != swiss_end) {
+			success = false;
+		}
+	}
+	ok(success, "lookup by key");
+
+	for (int i = 0; i < 10000; i++) {
+		if (i % 3 != 0)
+			swiss_do_delete(&ht, i);
+		struct data data = {i, i * 3}, old;
+		if (i % 3 == 0 &&
+		    swiss_replace(&ht, hash(i), data, &old) == swiss_end)
+			success = false;
+	}
+	for (int i = 10000; i < 30000; i++) {
+		swiss_do_insert(&ht, i, i * 3);
+		if (i % 2 == 0)
+			swiss_do_delete(&ht, i);
+	}
+	is(swiss_selfcheck(&ht), 0, "selfcheck after delete");
+
+	for (int i = 0; i < 30000; i++) {
+		struct data data = {i, 0};
+		uint32_t slot = swiss_find(&ht, hash(i), data);
+		bool exists = i < 10000 ? i % 3 == 0 : i % 2 != 0;
+		if (exists != (slot != swiss_end) ||
+		    (exists && swiss_get(&ht, slot).val != i * 3))
+			success = false;
+	}
+	ok(success, "lookup by value after delete");
+
+	swiss_destroy(&ht);
+
+	footer();
+	check_plan();
+}
+
+static void
+test_reserve(void)
+{
+	plan(3);
+	header();
+
+	struct swiss_core ht;
+	swiss_do_create(&ht);
+	is(swiss_reserve(&ht, 1000), 0, "reserve");
+	uint32_t group_count = ht.common.group_count;
+	for (int i = 0; i < 1000; i++)
+		swiss_do_insert(&ht, i, i);
+	is(ht.common.group_count, group_count, "no rehash after reserve");
+	is(swiss_selfcheck(&ht), 0, "selfcheck");
+	swiss_destroy(&ht);
+
+	footer();
+	check_plan();
+}
+
+static void
+test_view(void)
+{
+	plan(6);
+	header();
+
+	struct swiss_core ht;
+	swiss_do_create(&ht);
+
+	struct swiss_view empty_view;
+	swiss_view_create(&empty_view, &ht);
+
+	for (int i = 0; i < 1000; i++) {
+		if (i % 3 == 0)
+			swiss_do_insert(&ht, i, i * 2);
+	}
+
+	struct swiss_view view;
+	swiss_view_create(&view, &ht);
+
+	/* Update the table so that it's rehashed a few times. */
+	for (int i = 0; i < 10000; i++) {
+		if (i < 1000 && i % 6 == 0)
+			swiss_do_delete(&ht, i);
+		if (i % 3 != 0)
+			swiss_do_insert(&ht, i, i * 4);
+	}
+	struct data data = {3, 0}, old;
+	fail_if(swiss_replace(&ht, hash(3), data, &old) == swiss_end);
+
+	is(swiss_view_count(&empty_view), 0, "empty view count");
+	is(swiss_view_count(&view), 334, "view count");
+
+	bool success = true;
+	bool seen[1000] = {false};
+	struct swiss_iterator it;
+	swiss_view_iterator_begin(&view, &it);
+	for (struct data *p = swiss_view_iterator_get_and_next(&view, &it);
+	     p != NULL; p = swiss_view_iterator_get_and_next(&view, &it)) {
+		if (p->val != p->key * 2)
+			success = false;
+		if (p->key < 0 || p->key >= 1000) {
+			success = false;
+		} else if (seen[p->key]) {
+			success = false;
+		} else {
+			seen[p->key] = true;
+		}
+	}
+	for (int i = 0; i < 1000; i++) {
+		if (seen[i] != (i % 3 == 0))
+			success = false;
+	}
+	ok(success, "view full scan");
+
+	success = true;
+	for (int i = 0; i < 1000; i++) {
+		swiss_view_iterator_key(&view, &it, hash(i), i);
+		struct data *p = swiss_view_iterator_get_and_next(&view, &it);
+		if (i % 3 == 0) {
+			if (p == NULL || p->key != i || p->val != i * 2)
+				success = false;
+		} else {
+			if (p != NULL)
+				success = false;
+		}
+	}
+	ok(success, "view point lookup");
+
+	success = true;
+	for (int i = 0; i < 10000; i++) {
+		uint32_t slot = swiss_find_key(&ht, hash(i), i);
+		bool exists = i % 3 != 0 || (i < 1000 ? i % 6 != 0 : false);
+		if (exists != (slot != swiss_end))
+			success = false;
+	}
+	ok(success, "table lookup");
+	is(swiss_selfcheck(&ht), 0, "selfcheck");
+
+	swiss_view_destroy(&empty_view);
+	swiss_destroy(&ht);
+	/* The view must outlive the table. */
+	swiss_view_destroy(&view);
+
+	footer();
+	check_plan();
+}
+
+static void
+test_incremental_rehash(void)
+{
+	plan(7);
+	header();
+
+	enum { KEY_COUNT = 20000 };
+	static bool exists[KEY_COUNT];
+	memset(exists, 0, sizeof(exists));
+	struct swiss_core ht;
+	swiss_do_create(&ht);
+	struct swiss_view view;
+	uint32_t view_count = 0;
+	bool bounded = true;
+	bool rehashed = false;
+	bool consistent = true;
+	for (int i = 0; i < KEY_COUNT; i++) {
+		struct swiss_common prev = ht.common;
+		bool was_allocating = ht.new_storage != NULL;
+		uint32_t alloc_left = ht.new_group_count - ht.new_alloc_count;
+		swiss_do_insert(&ht, i, i);
+		exists[i] = true;
+		/*
+		 * An insertion allocates or moves at most SWISS_REHASH_STEP
+		 * groups, the table is never rehashed at once.
+		 */
+		if (ht.common.group_count != prev.group_count &&
+		    prev.group_count != 0 &&
+		    (was_allocating ? alloc_left : ht.common.group_count) >
+		    SWISS_REHASH_STEP)
+			bounded = false;
+		if (prev.old_storage != NULL &&
+		    (ht.common.old_storage != NULL ?
+		     ht.common.rehash_pos - prev.rehash_pos :
+		     prev.old_group_count - prev.rehash_pos) >
+		    SWISS_REHASH_STEP)
+			bounded = false;
+		if (ht.common.old_storage == NULL)
+			continue;
+		rehashed = true;
+		/* Update and check the table while values are being moved. */
+		if (i % 3 == 0) {
+			swiss_do_delete(&ht, i / 2);
+			exists[i / 2] = false;
+		}
+		struct data data = {i / 5, -i / 5}, old;
+		if (exists[i / 5] &&
+		    swiss_replace(&ht, hash(i / 5), data, &old) == swiss_end)
+			consistent = false;
+		for (int key = i / 4; key < i / 4 + 16; key++) {
+			uint32_t slot = swiss_find_key(&ht, hash(key), key);
+			if (exists[key] != (slot != swiss_end) ||
+			    (exists[key] && swiss_get(&ht, slot).key != key))
+				consistent = false;
+		}
+		if (swiss_selfcheck(&ht) != 0)
+			consistent = false;
+		if (view_count == 0 && i > 1000) {
+			swiss_view_create(&view, &ht);
+			view_count = swiss_view_count(&view);
+		}
+	}
+	ok(bounded, "insertion does bounded rehash work");
+	ok(rehashed, "table was rehashed");
+	ok(consistent, "table is consistent while rehashing");
+	is(swiss_selfcheck(&ht), 0, "selfcheck");
+
+	bool success = true;
+	uint32_t count = 0;
+	struct swiss_iterator it;
+	swiss_iterator_begin(&ht, &it);
+	for (struct data *p = swiss_iterator_get_and_next(&ht, &it);
+	     p != NULL; p = swiss_iterator_get_and_next(&ht, &it)) {
+		if (p->key < 0 || p->key >= KEY_COUNT || !exists[p->key])
+			success = false;
+		count++;
+	}
+	ok(success && count == swiss_count(&ht), "full scan");
+
+	fail_if(view_count == 0);
+	success = true;
+	count = 0;
+	swiss_view_iterator_begin(&view, &it);
+	for (struct data *p = swiss_view_iterator_get_and_next(&view, &it);
+	     p != NULL; p = swiss_view_iterator_get_and_next(&view, &it)) {
+		struct swiss_iterator key_it;
+		swiss_view_iterator_key(&view, &key_it, hash(p->key), p->key);
+		struct data *found =
+			swiss_view_iterator_get_and_next(&view, &key_it);
+		if (found == NULL || found->val != p->val)
+			success = false;
+		count++;
+	}
+	ok(success && count == view_count, "view scan");
+	swiss_destroy(&ht);
+	/* The view must outlive the table. */
+	is(swiss_view_count(&view), view_count, "view count");
+	swiss_view_destroy(&view);
+
+	footer();
+	check_plan();
+}
+
+int
+main(void)
+{
+	plan(4);
+	header();
+
+	test_basic();
+	test_reserve();
+	test_view();
+	test_incremental_rehash();
+
+	footer();
+	return check_plan();
+}
@@ -0,0 +1,158 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    cg.server = server:new()
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        if box.space.test2 ~= nil then
+            box.space.test2:drop()
+        end
+    end)
+end)
+
+g.test_bulk_load = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}})
+        s:create_index('nk', {parts = {3, 'string'}, unique = false})
+        local bl = s:bulk_load()
+        for i = 1, 100 do
+            bl:add({i, 1000 - i, 'x' .. (i % 10)})
+        end
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support DML on a space that is being " ..
+            "bulk loaded", s.insert, s, {1000, 1000, 'x'})
+        t.assert_equals(s:count(), 0)
+        bl:commit()
+        t.assert_equals(s:count(), 100)
+        t.assert_equals(s.index.pk:select({10}), {{10, 990, 'x0'}})
+        t.assert_equals(s.index.sk:select({990}), {{10, 990, 'x0'}})
+        t.assert_equals(s.index.nk:count({'x5'}), 10)
+        t.assert_equals(s.index.sk:select({}, {limit = 1}),
+                        {{100, 900, 'x0'}})
+        s:insert({1000, 1000, 'x'})
+        t.assert_equals(s:count(), 101)
+        box.snapshot()
+    end)
+    cg.server:restart()
+    cg.server:exec(function()
+        local s = box.space.test
+        t.assert_equals(s:count(), 101)
+        t.assert_equals(s.index.sk:get({990}), {10, 990, 'x0'})
+        t.assert_equals(s.index.nk:count({'x5'}), 10)
+    end)
+end
+
+g.test_bulk_load_chunked = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        -- Disable auto-compaction.
+        s:create_index('pk', {run_count_per_level = 100})
+        s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+        local bl = s:bulk_load({memory = 1024})
+        for i = 1, 1000 do
+            bl:add({i, i % 7})
+        end
+        bl:commit()
+        t.assert_equals(s:count(), 1000)
+        t.assert_gt(s.index.pk:stat().run_count, 1)
+        t.assert_equals(s.index.sk:count({3}), 143)
+    end)
+end
+
+g.test_bulk_load_errors = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:create_index('sk', {parts = {2, 'unsigned'}})
+        local bl = s:bulk_load()
+        bl:add({2, 2})
+        t.assert_error_msg_contains(
+            "Duplicate key exists in unique index \"pk\"", bl.add, bl, {2, 3})
+        t.assert_error_msg_content_equals(
+            "Illegal parameters, bulk load tuples must be sorted " ..
+            "by primary key", bl.add, bl, {1, 3})
+        t.assert_error_msg_contains(
+            "Tuple field 2 required by space format is missing",
+            bl.add, bl, {3})
+        bl:add({3, 2})
+        t.assert_error_msg_contains(
+            "Duplicate key exists in unique index \"sk\"", bl.commit, bl)
+        t.assert_error_msg_content_equals(
+            "Illegal parameters, bulk load is closed", bl.add, bl, {4, 4})
+        t.assert_equals(s:count(), 0)
+
+        -- The space is writable after the bulk load is closed.
+        bl = s:bulk_load()
+        bl:add({1, 1})
+        bl:close()
+        t.assert_equals(s:count(), 0)
+        s:insert({1, 1})
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support bulk load into a non-empty space",
+            s.bulk_load, s)
+
+        local m = box.schema.create_space('test_memtx')
+        m:create_index('pk')
+        t.assert_error_msg_content_equals(
+            "memtx does not support bulk load", m.bulk_load, m)
+        m:drop()
+    end)
+end
+
+-- Read views opened before a bulk load is committed don't see the loaded
+-- data: the commit waits for them to be closed.
+g.test_bulk_load_read_view = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.create_space('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        local s2 = box.schema.create_space('test2', {engine = 'vinyl'})
+        s2:create_index('pk')
+        s2:insert({1})
+        local bl = s:bulk_load()
+        for i = 1, 10 do
+            bl:add({i})
+        end
+        -- Send the transaction to a read view.
+        box.begin()
+        s2:get(1)
+        fiber.create(function() s2:replace({1, 1}) end)
+        t.helpers.retrying({}, function()
+            t.assert_equals(s2:get(1), {1})
+            t.assert_equals(box.stat.vinyl().tx.read_views, 1)
+        end)
+        local f = fiber.new(function() bl:commit() end)
+        f:set_joinable(true)
+        fiber.sleep(0.1)
+        t.assert_equals(f:status(), 'suspended')
+        t.assert_equals(s:select(), {})
+        box.commit()
+        t.assert_equals({f:join()}, {true})
+        t.assert_equals(s:count(), 10)
+
+        s2:truncate()
+        bl = s2:bulk_load()
+        bl:add({1})
+        box.begin()
+        t.assert_error_msg_content_equals(
+            "Vinyl does not support bulk load commit in a transaction",
+            bl.commit, bl)
+        box.commit()
+        t.assert_equals(s2:count(), 0)
+    end)
+end
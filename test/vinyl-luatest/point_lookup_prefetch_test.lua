@@ -0,0 +1,178 @@
+local server = require('luatest.server')
+local t = require('luatest')
+
+local g = t.group()
+
+g.before_all(function(cg)
+    t.tarantool.skip_if_not_debug()
+    cg.server = server:new({
+        box_cfg = {
+            -- Disable cache to force reads from disk.
+            vinyl_cache = 0,
+            -- Let page reads submitted to different runs run in parallel.
+            vinyl_read_threads = 4,
+        },
+    })
+    cg.server:start()
+end)
+
+g.after_all(function(cg)
+    cg.server:drop()
+end)
+
+g.after_each(function(cg)
+    cg.server:exec(function()
+        if box.space.test ~= nil then
+            box.space.test:drop()
+        end
+        box.error.injection.set('ERRINJ_VY_POINT_LOOKUP_DELAY', false)
+        box.error.injection.set('ERRINJ_VY_READ_PAGE_TIMEOUT', 0)
+    end)
+end)
+
+-- A point lookup that has to read several runs reads them concurrently.
+g.test_prefetch_hit = function(cg)
+    cg.server:exec(function()
+        local clock = require('clock')
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {run_count_per_level = 100})
+        -- Every run stores a statement for the key that isn't terminal
+        -- so the lookup has to read a page from each of them.
+        s:replace({1, 0})
+        box.snapshot()
+        for _ = 1, 3 do
+            s:upsert({1, 0}, {{'+', 2, 1}})
+            box.snapshot()
+        end
+        t.assert_equals(s.index.pk:stat().run_count, 4)
+        local stat = s.index.pk:stat().disk.iterator
+        local timeout = 0.5
+        box.error.injection.set('ERRINJ_VY_READ_PAGE_TIMEOUT', timeout)
+        local start = clock.monotonic()
+        t.assert_equals(s:get(1), {1, 3})
+        local elapsed = clock.monotonic() - start
+        box.error.injection.set('ERRINJ_VY_READ_PAGE_TIMEOUT', 0)
+        local new_stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(new_stat.read.pages - stat.read.pages, 4)
+        -- Reading the runs one by one would take 4 timeouts.
+        t.assert_lt(elapsed, 3 * timeout)
+    end)
+end
+
+-- A prefetched page that doesn't contain the key is read in vain but
+-- doesn't affect the lookup result. A run which bloom filter doesn't
+-- have the key isn't read at all.
+g.test_prefetch_miss = function(cg)
+    cg.server:exec(function()
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {
+            run_count_per_level = 100,
+            bloom_fpr = 0.001,
+        })
+        s:create_index('sk', {
+            parts = {{2, 'unsigned'}},
+            run_count_per_level = 100,
+            bloom_fpr = 1,
+        })
+        -- The key 5 is within the key range of every run.
+        s:replace({1, 1})
+        s:replace({10, 10})
+        box.snapshot()
+        s:replace({2, 2})
+        s:replace({9, 9})
+        box.snapshot()
+
+        -- Bloom filters are disabled, all the runs are read.
+        local stat = s.index.sk:stat().disk.iterator
+        t.assert_equals(s.index.sk:get(5), nil)
+        local new_stat = s.index.sk:stat().disk.iterator
+        t.assert_equals(new_stat.read.pages - stat.read.pages, 2)
+
+        -- Bloom filters filter out all the runs, nothing is read.
+        stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(s:get(5), nil)
+        new_stat = s.index.pk:stat().disk.iterator
+        t.assert_equals(new_stat.read.pages - stat.read.pages, 0)
+        t.assert_equals(new_stat.bloom.hit - stat.bloom.hit, 2)
+
+        -- The newest run stores a terminal statement for the key,
+        -- the reads submitted to the older runs are abandoned.
+        s:replace({5, 5})
+        box.snapshot()
+        s:replace({5, 50})
+        box.snapshot()
+        stat = s.index.sk:stat().disk.iterator
+        t.assert_equals(s.index.sk:get(5), nil)
+        new_stat = s.index.sk:stat().disk.iterator
+        t.assert_equals(new_stat.read.pages - stat.read.pages, 1)
+        t.assert_equals(s.index.sk:get(50), {5, 50})
+    end)
+end
+
+-- Runs may be dumped and compacted while page reads submitted by
+-- a point lookup are in progress.
+g.test_prefetch_vs_dump_and_compaction = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {run_count_per_level = 100})
+        s:replace({1, 0})
+        box.snapshot()
+        for _ = 1, 2 do
+            s:upsert({1, 0}, {{'+', 2, 1}})
+            box.snapshot()
+        end
+
+        -- Block the lookup after it has submitted page reads.
+        box.error.injection.set('ERRINJ_VY_POINT_LOOKUP_DELAY', true)
+        local result
+        local f = fiber.new(function()
+            result = s:get(1)
+        end)
+        f:set_joinable(true)
+        fiber.yield()
+        -- Dump a new run while the lookup is in progress. The lookup
+        -- must notice it and restart.
+        s:upsert({1, 0}, {{'+', 2, 1}})
+        box.snapshot()
+        -- Compaction can't complete while the lookup pins the slices.
+        s.index.pk:compact()
+        fiber.sleep(0.1)
+        box.error.injection.set('ERRINJ_VY_POINT_LOOKUP_DELAY', false)
+        t.assert_equals({f:join()}, {true})
+        t.assert_equals(result, {1, 3})
+        t.helpers.retrying({}, function()
+            t.assert_equals(s.index.pk:stat().run_count, 1)
+        end)
+        t.assert_equals(s:get(1), {1, 3})
+    end)
+end
+
+-- Reads abandoned by a lookup may outlive the runs they read.
+g.test_abandoned_prefetch_vs_drop = function(cg)
+    cg.server:exec(function()
+        local fiber = require('fiber')
+        local s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk', {run_count_per_level = 100})
+        -- There are more runs than reader threads so reads of the
+        -- older runs are queued behind the read of the newest one.
+        for i = 1, 8 do
+            s:replace({1, i})
+            box.snapshot()
+        end
+        local timeout = 0.1
+        box.error.injection.set('ERRINJ_VY_READ_PAGE_TIMEOUT', timeout)
+        -- Only the newest run is needed, the other reads are abandoned.
+        t.assert_equals(s:get(1), {1, 8})
+        -- Drop the runs while the abandoned reads are in progress.
+        s:drop()
+        box.snapshot()
+        fiber.sleep(2 * timeout)
+        box.error.injection.set('ERRINJ_VY_READ_PAGE_TIMEOUT', 0)
+        s = box.schema.space.create('test', {engine = 'vinyl'})
+        s:create_index('pk')
+        s:replace({1, 1})
+        box.snapshot()
+        t.assert_equals(s:get(1), {1, 1})
+    end)
+end